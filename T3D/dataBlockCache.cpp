@@ -0,0 +1,333 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "T3D/dataBlockCache.h"
+
+#include "console/simDatablock.h"
+#include "core/stream/bitStream.h"
+#include "core/stream/fileStream.h"
+#include "core/util/endian.h"
+#include "core/crc.h"
+#include "sim/netConnection.h"
+
+// Cache file layout, all values little endian:
+//
+//    U32   tag ('DBC1')
+//    U32   version
+//    U32   entry count
+//    U32   blob size in bytes
+//    entry count * { U32 id, U32 classId, U32 hash, U32 blobOffset, U32 numBits }
+//    blob, padded with DataPadding zero bytes
+//
+// The padding keeps BitStream::readBits(), which touches one byte past
+// the last one it returns, inside the mapped view.
+
+static const U32 DataBlockCacheTag = makeFourCCTag( 'D', 'B', 'C', '1' );
+
+enum
+{
+   HeaderWords = 4,
+   EntryWords = 5,
+   DataPadding = 4,
+   MaxPackedDataBlockSize = 16384,
+};
+
+/// Server side memo of a datablock's packed hash.
+struct DataBlockHashMemo
+{
+   SimDataBlock *object;
+   S32 modifiedKey;
+   U32 netClassGroup;
+   U32 hash;
+   bool valid;
+
+   DataBlockHashMemo()
+      :  object( NULL ),
+         modifiedKey( 0 ),
+         netClassGroup( 0 ),
+         hash( 0 ),
+         valid( false )
+   {
+   }
+};
+
+static inline U32 readCacheWord( const U8 *ptr )
+{
+   U32 value;
+   dMemcpy( &value, ptr, sizeof( U32 ) );
+   return convertLEndianToHost( value );
+}
+
+//-----------------------------------------------------------------------------
+
+DataBlockCache::DataBlockCache()
+{
+   VECTOR_SET_ASSOCIATION( mEntries );
+   VECTOR_SET_ASSOCIATION( mRecordedBits );
+}
+
+DataBlockCache::~DataBlockCache()
+{
+   clear();
+}
+
+void DataBlockCache::clear()
+{
+   for ( U32 i = 0; i < mRecordedBits.size(); i++ )
+      delete [] mRecordedBits[i];
+
+   mRecordedBits.clear();
+   mEntries.clear();
+   mIndex.clear();
+   mFile.close();
+}
+
+bool DataBlockCache::load( const char *filename )
+{
+   clear();
+
+   if ( !filename || !filename[0] )
+      return false;
+
+   if ( !mFile.open( filename ) )
+      return false;
+
+   const U8 *data = mFile.getData();
+   const U32 size = mFile.getSize();
+
+   if ( size < HeaderWords * sizeof( U32 ) ||
+        readCacheWord( data ) != DataBlockCacheTag ||
+        readCacheWord( data + 4 ) != FileVersion )
+   {
+      Con::warnf( "DataBlockCache::load - '%s' is not a valid datablock cache.", filename );
+      mFile.close();
+      return false;
+   }
+
+   const U32 count = readCacheWord( data + 8 );
+   const U32 blobSize = readCacheWord( data + 12 );
+
+   // The count is checked first so the index size can't wrap, and the
+   // other sizes are compared by subtraction for the same reason.
+   bool valid = count <= DataBlockObjectIdLast - DataBlockObjectIdFirst + 1;
+   const U32 indexSize = valid ? count * EntryWords * sizeof( U32 ) : 0;
+   const U32 blobStart = HeaderWords * sizeof( U32 ) + indexSize;
+
+   valid = valid && 
+      blobStart <= size && 
+      size - blobStart >= DataPadding &&
+      blobSize <= size - blobStart - DataPadding;
+
+   if ( !valid )
+   {
+      Con::warnf( "DataBlockCache::load - '%s' is truncated.", filename );
+      mFile.close();
+      return false;
+   }
+
+   const U8 *blob = data + blobStart;
+   const U8 *ptr = data + HeaderWords * sizeof( U32 );
+
+   mEntries.reserve( count );
+   for ( U32 i = 0; i < count; i++, ptr += EntryWords * sizeof( U32 ) )
+   {
+      Entry entry;
+      entry.id = readCacheWord( ptr );
+      entry.classId = readCacheWord( ptr + 4 );
+      entry.hash = readCacheWord( ptr + 8 );
+      const U32 offset = readCacheWord( ptr + 12 );
+      entry.numBits = readCacheWord( ptr + 16 );
+      entry.bits = blob + offset;
+
+      const U32 numBytes = ( entry.numBits >> 3 ) + ( ( entry.numBits & 7 ) ? 1 : 0 );
+
+      // Don't trust the stored hash, a damaged blob would otherwise
+      // be sent as a match for the server's datablock.
+      if ( offset > blobSize || numBytes > blobSize - offset ||
+           entry.id < DataBlockObjectIdFirst || entry.id > DataBlockObjectIdLast ||
+           computeHash( entry.classId, entry.bits, entry.numBits ) != entry.hash )
+      {
+         Con::warnf( "DataBlockCache::load - '%s' has a corrupt index.", filename );
+         clear();
+         return false;
+      }
+
+      mIndex[entry.id] = mEntries.size();
+      mEntries.push_back( entry );
+   }
+
+   return true;
+}
+
+bool DataBlockCache::save( const char *filename )
+{
+   if ( !filename || !filename[0] )
+      return false;
+
+   // Gather everything into memory first; the entries may point into
+   // the mapping of the very file we are about to overwrite.
+   Vector<U8> blob;
+   Vector<U32> offsets;
+   offsets.setSize( mEntries.size() );
+
+   for ( U32 i = 0; i < mEntries.size(); i++ )
+   {
+      const Entry &entry = mEntries[i];
+      const U32 numBytes = ( entry.numBits + 7 ) >> 3;
+
+      offsets[i] = blob.size();
+      blob.setSize( blob.size() + numBytes );
+      dMemcpy( blob.address() + offsets[i], entry.bits, numBytes );
+   }
+
+   Vector<Entry> entries = mEntries;
+   for ( U32 i = 0; i < entries.size(); i++ )
+      entries[i].bits = NULL;
+
+   clear();
+
+   FileStream stream;
+   if ( !stream.open( filename, Torque::FS::File::Write ) )
+   {
+      Con::errorf( "DataBlockCache::save - failed to open '%s' for writing.", filename );
+      return false;
+   }
+
+   stream.write( DataBlockCacheTag );
+   stream.write( (U32)FileVersion );
+   stream.write( (U32)entries.size() );
+   stream.write( (U32)blob.size() );
+
+   for ( U32 i = 0; i < entries.size(); i++ )
+   {
+      stream.write( (U32)entries[i].id );
+      stream.write( (U32)entries[i].classId );
+      stream.write( entries[i].hash );
+      stream.write( offsets[i] );
+      stream.write( entries[i].numBits );
+   }
+
+   if ( blob.size() )
+      stream.write( blob.size(), blob.address() );
+
+   for ( U32 i = 0; i < DataPadding; i++ )
+      stream.write( (U8)0 );
+
+   stream.close();
+
+   // Remap so the session can keep using the cache.
+   return load( filename );
+}
+
+const DataBlockCache::Entry* DataBlockCache::find( SimObjectId id ) const
+{
+   Map<SimObjectId, U32>::ConstIterator iter = mIndex.find( id );
+   if ( iter == mIndex.end() )
+      return NULL;
+
+   return &mEntries[iter->value];
+}
+
+void DataBlockCache::record( SimObjectId id, S32 classId, const U8 *bits, U32 numBits )
+{
+   const U32 numBytes = ( numBits + 7 ) >> 3;
+
+   U8 *copy = new U8[numBytes + DataPadding];
+   dMemcpy( copy, bits, numBytes );
+   dMemset( copy + numBytes, 0, DataPadding );
+   if ( numBits & 7 )
+      copy[numBytes - 1] &= ( 1 << ( numBits & 7 ) ) - 1;
+
+   mRecordedBits.push_back( copy );
+
+   Entry entry;
+   entry.id = id;
+   entry.classId = classId;
+   entry.hash = computeHash( classId, copy, numBits );
+   entry.numBits = numBits;
+   entry.bits = copy;
+
+   Map<SimObjectId, U32>::Iterator iter = mIndex.find( id );
+   if ( iter != mIndex.end() )
+      mEntries[iter->value] = entry;
+   else
+   {
+      mIndex[id] = mEntries.size();
+      mEntries.push_back( entry );
+   }
+}
+
+SimDataBlock* DataBlockCache::createDataBlock( const Entry &entry, NetConnection *conn ) const
+{
+   SimObject *ptr = (SimObject *) ConsoleObject::create( conn->getNetClassGroup(), NetClassTypeDataBlock, entry.classId );
+   SimDataBlock *obj = dynamic_cast<SimDataBlock*>( ptr );
+   if ( !obj )
+   {
+      delete ptr;
+      return NULL;
+   }
+
+   // The bits are only ever read, so handing the stream the mapped
+   // (read only) memory is safe.
+   BitStream stream( const_cast<U8*>( entry.bits ), ( entry.numBits + 7 ) >> 3 );
+   obj->unpackData( &stream );
+
+   if ( !stream.isValid() || stream.getCurPos() != entry.numBits )
+   {
+      Con::warnf( "DataBlockCache - cached '%s' (%d) did not unpack cleanly.", obj->getClassName(), entry.id );
+      delete obj;
+      return NULL;
+   }
+
+   return obj;
+}
+
+U32 DataBlockCache::computeHash( S32 classId, const U8 *bits, U32 numBits )
+{
+   U32 crc = CRC::calculateCRC( &classId, sizeof( classId ) );
+   crc = CRC::calculateCRC( &numBits, sizeof( numBits ), crc );
+
+   const U32 wholeBytes = numBits >> 3;
+   crc = CRC::calculateCRC( bits, wholeBytes, crc );
+
+   if ( numBits & 7 )
+   {
+      U8 last = bits[wholeBytes] & ( ( 1 << ( numBits & 7 ) ) - 1 );
+      crc = CRC::calculateCRC( &last, 1, crc );
+   }
+
+   return crc;
+}
+
+bool DataBlockCache::getDataBlockHash( SimDataBlock *db, NetConnection *conn, U32 &outHash )
+{
+   static Map<SimObjectId, DataBlockHashMemo> smHashes;
+
+   DataBlockHashMemo &memo = smHashes[db->getId()];
+   if ( memo.object != db ||
+        memo.modifiedKey != db->getModifiedKey() ||
+        memo.netClassGroup != conn->getNetClassGroup() )
+   {
+      U8 buffer[MaxPackedDataBlockSize];
+      BitStream stream( buffer, sizeof( buffer ) );
+      db->packData( &stream );
+
+      memo.object = db;
+      memo.modifiedKey = db->getModifiedKey();
+      memo.netClassGroup = conn->getNetClassGroup();
+      memo.valid = stream.isValid() && stream.getPosition() <= sizeof( buffer );
+      memo.hash = 0;
+
+      if ( memo.valid )
+         memo.hash = computeHash( db->getClassId( conn->getNetClassGroup() ), buffer, stream.getCurPos() );
+      else
+         Con::warnf( "DataBlockCache - '%s' (%d) packs to more than %d bytes and won't be cached.",
+            db->getClassName(), db->getId(), MaxPackedDataBlockSize );
+   }
+
+   outHash = memo.hash;
+   return memo.valid;
+}
@@ -0,0 +1,104 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _DATABLOCKCACHE_H_
+#define _DATABLOCKCACHE_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _SIMBASE_H_
+#include "console/simBase.h"
+#endif
+#ifndef _VOLUME_H_
+#include "core/volume.h"
+#endif
+#ifndef _TDICTIONARY_H_
+#include "core/util/tDictionary.h"
+#endif
+
+class SimDataBlock;
+class NetConnection;
+
+/// Client side cache of packed datablocks.
+///
+/// Every block is stored in its packed network form together with a
+/// content hash of those bits.  On connect the client sends the server a
+/// manifest of (id, hash) pairs; the server then only transmits the blocks
+/// whose hash differs and sends short references for the rest, which the
+/// client unpacks straight out of this cache.
+///
+/// The cache file is memory mapped while loaded, so cached blocks are read
+/// without copying the file.  Blocks received during the session are kept
+/// in memory until save() merges them with the mapped entries.
+class DataBlockCache
+{
+public:
+
+   struct Entry
+   {
+      SimObjectId id;
+      S32 classId;
+      U32 hash;
+      U32 numBits;
+      const U8 *bits;
+   };
+
+   DataBlockCache();
+   ~DataBlockCache();
+
+   /// Map a cache file, replacing the current contents.
+   /// @return false if the file is missing or invalid; the cache is empty then.
+   bool load( const char *filename );
+
+   /// Write all entries out to a cache file.
+   bool save( const char *filename );
+
+   void clear();
+
+   U32 size() const { return mEntries.size(); }
+   const Entry& operator[]( U32 index ) const { return mEntries[index]; }
+
+   /// Returns true if blocks were recorded since the last load or save.
+   bool isDirty() const { return !mRecordedBits.empty(); }
+
+   /// Return the entry for the given datablock id, or NULL.
+   const Entry* find( SimObjectId id ) const;
+
+   /// Store the packed bits of a block received from the server.
+   void record( SimObjectId id, S32 classId, const U8 *bits, U32 numBits );
+
+   /// Create a new, unregistered datablock from a cached entry.
+   SimDataBlock* createDataBlock( const Entry &entry, NetConnection *conn ) const;
+
+   /// Hash the packed form of a datablock.  The last partial byte of @a bits
+   /// is masked, so the buffer may contain trailing garbage.
+   static U32 computeHash( S32 classId, const U8 *bits, U32 numBits );
+
+   /// Get the hash of a datablock as it would be packed for @a conn.
+   /// Hashes are memoized until the block's modified key changes.
+   /// @return false if the block packs larger than the hashing buffer; it
+   ///   can't be matched against the cache then and must be sent in full.
+   static bool getDataBlockHash( SimDataBlock *db, NetConnection *conn, U32 &outHash );
+
+protected:
+
+   enum
+   {
+      FileVersion = 1,
+   };
+
+   Torque::FS::FileView mFile;
+
+   Vector<Entry> mEntries;
+
+   /// Maps a datablock id to its index in mEntries.
+   Map<SimObjectId, U32> mIndex;
+
+   /// Bit buffers of recorded entries; owned by the cache.
+   Vector<U8*> mRecordedBits;
+};
+
+#endif // _DATABLOCKCACHE_H_
@@ -18,6 +18,12 @@
 #include "core/util/safeDelete.h"
 #include "T3D/camera.h"
 #include "core/stream/fileStream.h"
+#include "T3D/dataBlockCache.h"
+#include "platform/threads/threadPool.h"
+#include "platform/threads/threadSafeRefCount.h"
+#include "platform/threads/semaphore.h"
+#include "platform/platformIntrinsics.h"
+#include "core/volume.h"
 
 //----------------------------------------------------------------------------
 #define MAX_MOVE_PACKET_SENDS 4
@@ -35,7 +41,6 @@ Signal<void(F32)> GameConnection::smFovUpdate;
 Signal<void()>    GameConnection::smPlayingDemo;
 
 #ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
-StringTableEntry GameConnection::server_cache_filename = "";
 StringTableEntry GameConnection::client_cache_filename = "";
 bool GameConnection::server_cache_on = true;
 bool GameConnection::client_cache_on = true;
@@ -90,9 +95,11 @@ GameConnection::GameConnection()
    mFirstPerson = false;
    mUpdateFirstPerson = false;
 #ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
-   client_db_stream = new InfiniteBitStream;
-   server_cache_CRC = 0xffffffff;
+   mDataBlockCache = NULL;
+   mDataBlockBatchIndex = 0;
+   mDataBlockBatchesInFlight = 0;
 #endif // AFX CODE BLOCK (db-cache) >>
+   dMemset(&mDataBlockLoadStats, 0, sizeof(mDataBlockLoadStats));
 }
 
 GameConnection::~GameConnection()
@@ -102,7 +109,7 @@ GameConnection::~GameConnection()
       dFree(mConnectArgv[i]);
    dFree(mJoinPassword);
 #ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
-   delete client_db_stream;
+   delete mDataBlockCache;
 #endif // AFX CODE BLOCK (db-cache) >>
 }
 
@@ -163,6 +170,10 @@ void GameConnection::onConnectionEstablished(bool isInitiator)
       setIsConnectionToServer();
       mServerConnection = this;
       Con::printf("Connection established %d", getId());
+#ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
+      if (clientCacheEnabled() && !isLocalConnection())
+         sendDataBlockManifest();
+#endif // AFX CODE BLOCK (db-cache) >>
       Con::executef(this, "onConnectionAccepted");
    }
    else
@@ -1197,16 +1208,19 @@ void GameConnection::preloadNextDataBlock(bool hadNewFiles)
          AssertFatal(mDataBlockLoadList.size() == 0, "Error! Datablock save list should be empty!");
          sendConnectionMessage(DataBlocksDownloadDone, mDataBlockSequence);
 #ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
-		 // This should be the last of the datablocks. An argument of false
-		 // indicates that this is a client save.
-		 if (clientCacheEnabled())
-			 saveDatablockCache(false);
+         // This is the last of the datablocks; keep what we received.
+         if (mDataBlockCache && mDataBlockCache->isDirty())
+            mDataBlockCache->save(client_cache_filename);
 #endif // AFX CODE BLOCK (db-cache) >>
+         reportDataBlockLoadStats();
 //          gResourceManager->setMissingFileLogging(false);
          return;
       }
       mFilesWereDownloaded = hadNewFiles;
-      if(!object->preload(false, mErrorBuffer))
+      U64 preloadStart = Platform::getPerformanceCounter();
+      bool preloaded = object->preload(false, mErrorBuffer);
+      mDataBlockLoadStats.preloadTime += Platform::getPerformanceCounter() - preloadStart;
+      if(!preloaded)
       {
          mFilesWereDownloaded = false;
          // make sure there's an error message if necessary
@@ -1316,12 +1330,8 @@ ConsoleMethod( GameConnection, transmitDataBlocks, void, 3, 3, "(int sequence)")
     // Determine the size of the datablock group.
     const U32 iCount = pGroup->size();
 
-	// If this is the local client...
-#ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
-	if (GameConnection::getLocalClientConnection() == object && !GameConnection::serverCacheEnabled())
-#else
-	if (GameConnection::getLocalClientConnection() == object)
-#endif // AFX CODE BLOCK (db-cache) >>
+    // If this is the local client...
+    if (GameConnection::getLocalClientConnection() == object)
     {
         // Set up a pointer to the datablock.
         SimDataBlock* pDataBlock = 0;
@@ -1394,6 +1404,13 @@ ConsoleMethod( GameConnection, transmitDataBlocks, void, 3, 3, "(int sequence)")
         // Set the maximum datablock modified key value.
         object->setMaxDataBlockModifiedKey(iKey);
 
+#ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
+        // Send the remaining blocks in compressed batches, skipping
+        // any the client already holds in its cache.
+        object->startDataBlockBatches();
+        return;
+#endif // AFX CODE BLOCK (db-cache) >>
+
         // Get the minimum number of datablocks...
         const U32 iMax = getMin(i + DataBlockQueueCount, iCount);
 
@@ -1535,7 +1552,6 @@ void GameConnection::consoleInit()
    Con::addVariable("Pref::Net::LagThreshold", TypeS32, &mLagThresholdMS);
    // Con::addVariable("specialFog", TypeBool, &SceneGraph::useSpecial);
 #ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
-   Con::addVariable("$Pref::Server::DatablockCacheFilename",  TypeString,   &server_cache_filename);
    Con::addVariable("$pref::Client::DatablockCacheFilename",  TypeString,   &client_cache_filename);
    Con::addVariable("$Pref::Server::EnableDatablockCache",    TypeBool,     &server_cache_on);
    Con::addVariable("$pref::Client::EnableDatablockCache",    TypeBool,     &client_cache_on);
@@ -1655,395 +1671,328 @@ ConsoleMethod(GameConnection, setFirstPerson, void, 3, 3, "(bool firstPerson) Se
 
 #ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
 
-void GameConnection::tempDisableStringBuffering(BitStream* bs) const 
-{ 
-	//bs->setStringBuffer(0); 
-}
+void GameConnection::sendDataBlockManifest()
+{
+   if (!mDataBlockCache)
+      mDataBlockCache = new DataBlockCache;
 
-void GameConnection::restoreStringBuffering(BitStream* bs) const 
-{ 
-	//bs->setStringBuffer(curr_stringBuf); 
-}              
+   if (!mDataBlockCache->load(client_cache_filename))
+      return;
+
+   const U32 count = mDataBlockCache->size();
+   for (U32 i = 0; i < count; i += DataBlockManifestEvent::MaxEntries)
+   {
+      DataBlockManifestEvent *evt = new DataBlockManifestEvent;
+      const U32 end = getMin(i + DataBlockManifestEvent::MaxEntries, count);
+      for (U32 j = i; j < end; j++)
+         evt->addEntry((*mDataBlockCache)[j].id, (*mDataBlockCache)[j].hash);
+      postNetEvent(evt);
+   }
 
-// rewind to stream postion and then move raw bytes into client_db_stream
-// for caching purposes.
-void GameConnection::repackClientDatablock(BitStream* bstream, S32 start_pos)
+   Con::printf("Sent manifest of %d cached datablocks.", count);
+}
+
+bool GameConnection::clientHasDataBlock(SimObjectId id, U32 hash) const
 {
-	static U8 bit_buffer[Net::MaxPacketDataSize];
+   if (!server_cache_on)
+      return false;
 
-	if (!clientCacheEnabled() || !client_db_stream)
-		return;
+   Map<SimObjectId, U32>::ConstIterator iter = mClientDataBlockHashes.find(id);
+   return iter != mClientDataBlockHashes.end() && iter->value == hash;
+}
 
-	S32 cur_pos = bstream->getCurPos();
-	S32 n_bits = cur_pos - start_pos;
-	if (n_bits <= 0)
-		return;
+void GameConnection::startDataBlockBatches()
+{
+   mDataBlockBatchIndex = 0;
+   mDataBlockBatchesInFlight = 0;
 
-	bstream->setCurPos(start_pos);
-	bstream->readBits(n_bits, bit_buffer);
-	bstream->setCurPos(cur_pos);
+   // Keep a few batches in flight so the transfer isn't bound by the round trip.
+   for (U32 i = 0; i < DataBlockBatchWindow; i++)
+   {
+      if (!postNextDataBlockBatch())
+         break;
+   }
 
-	//S32 start_pos2 = client_db_stream->getCurPos();
-	client_db_stream->writeBits(n_bits, bit_buffer);
+   if (!mDataBlockBatchesInFlight)
+   {
+      setDataBlockModifiedKey(getMaxDataBlockModifiedKey());
+      sendConnectionMessage(DataBlocksDone, getDataBlockSequence());
+   }
 }
 
-#define CLIENT_CACHE_VERSION_CODE 4724110
-
-void GameConnection::saveDatablockCache(bool on_server)
+bool GameConnection::postNextDataBlockBatch()
 {
-	InfiniteBitStream bit_stream;
-	BitStream* bstream = 0;
+   if (mDataBlockBatchIndex >= Sim::getDataBlockGroup()->size())
+      return false;
 
-	if (on_server)
-	{
-		SimDataBlockGroup *g = Sim::getDataBlockGroup();
-
-		// find the first one we haven't sent:
-		U32 i, groupCount = g->size();
-		S32 key = this->getDataBlockModifiedKey();
-		for (i = 0; i < groupCount; i++)
-			if (((SimDataBlock*)(*g)[i])->getModifiedKey() > key)
-				break;
-
-		// nothing to save
-		if (i == groupCount) 
-			return;
-
-		bstream = &bit_stream;
-
-		for (;i < groupCount; i++) 
-		{
-			SimDataBlock* obj = (SimDataBlock*)(*g)[i];
-			GameConnection* gc = this;
-			NetConnection* conn = this;
-			SimObjectId id = obj->getId();
-
-			if (bstream->writeFlag(gc->getDataBlockModifiedKey() < obj->getModifiedKey()))        // A - flag
-			{
-				if (obj->getModifiedKey() > gc->getMaxDataBlockModifiedKey())
-					gc->setMaxDataBlockModifiedKey(obj->getModifiedKey());
-
-				bstream->writeInt(id - DataBlockObjectIdFirst,DataBlockObjectIdBitSize);            // B - int
-
-				S32 classId = obj->getClassId(conn->getNetClassGroup());
-				bstream->writeClassId(classId, NetClassTypeDataBlock, conn->getNetClassGroup());    // C - id
-				bstream->writeInt(i, DataBlockObjectIdBitSize);                                     // D - int
-				bstream->writeInt(groupCount, DataBlockObjectIdBitSize + 1);                        // E - int
-				obj->packData(bstream);
-			}
-		}
-	}
-	else
-	{
-		bstream = client_db_stream;
-	}
+   SimDataBlockBatchEvent *evt = new SimDataBlockBatchEvent(this, mDataBlockBatchIndex, getDataBlockSequence());
+   mDataBlockBatchIndex = evt->getNextIndex();
 
-	if (bstream->getPosition() <= 0)
-		return;
+   if (evt->isEmpty())
+   {
+      delete evt;
+      return false;
+   }
 
-	// zero out any leftover bits short of an even byte count
-	U32 n_leftover_bits = (bstream->getPosition()*8) - bstream->getCurPos();
-	if (n_leftover_bits >= 0 && n_leftover_bits <= 8)
-	{
-		// note - an unusual problem regarding setCurPos() results when there 
-		// are no leftover bytes. Adding a buffer byte in this case avoids the problem.
-		if (n_leftover_bits == 0)
-			n_leftover_bits = 8;
-		U8 bzero = 0;
-		bstream->writeBits(n_leftover_bits, &bzero);
-	}
+   mDataBlockBatchesInFlight++;
+   postNetEvent(evt);
+   return true;
+}
 
-	// this is where we actually save the file
-	const char* filename = (on_server) ? server_cache_filename : client_cache_filename;
-	if (filename && filename[0] != '\0')
-	{
-		FileStream f_stream;
-		if(!f_stream.open( filename, Torque::FS::File::Write ))
-		//if(!ResourceManager::get().openFileForWrite(f_stream,))
-		{
-			Con::printf("Failed to open file '%s'.", filename);
-			return;
-		}
-
-		U32 save_sz = bstream->getPosition();
-
-		if (!on_server)
-		{
-			f_stream.write((U32)CLIENT_CACHE_VERSION_CODE);
-			f_stream.write(save_sz);
-			f_stream.write(server_cache_CRC);
-			f_stream.write((U32)CLIENT_CACHE_VERSION_CODE);
-		}
-
-		f_stream.write(save_sz, bstream->getBuffer());
-
-		// zero out any leftover bytes short of a 4-byte multiple
-		while ((save_sz % 4) != 0)
-		{
-			f_stream.write((U8)0);
-			save_sz++;
-		}
-
-		f_stream.close();
-	}
+void GameConnection::onDataBlockBatchDelivered(U32 sequence)
+{
+   // Batches from an earlier transmission; a new one has been started.
+   if (sequence != getDataBlockSequence())
+      return;
+
+   mDataBlockBatchesInFlight--;
+   postNextDataBlockBatch();
 
-	if (!on_server)
-		client_db_stream->clear();
+   if (!mDataBlockBatchesInFlight)
+   {
+      setDataBlockModifiedKey(getMaxDataBlockModifiedKey());
+      sendConnectionMessage(DataBlocksDone, sequence);
+   }
 }
 
-static bool afx_saved_db_cache = false;
-static U32 afx_saved_db_cache_CRC = 0xffffffff;
+//----------------------------------------------------------------------------
+// Script functions of the old whole-file datablock cache.  The per-block
+// cache is validated and loaded by the engine during the datablock
+// download, so these are kept as no-ops for existing scripts.  The CRC
+// functions all report 0, so scripts comparing them see a match.
 
-void GameConnection::resetDatablockCache()
+ConsoleFunction(resetDatablockCache, void, 1, 1, "() Deprecated; the datablock cache needs no reset.")
 {
-	afx_saved_db_cache = false;
-	afx_saved_db_cache_CRC = 0xffffffff;
+   TORQUE_UNUSED(argc); TORQUE_UNUSED(argv);
 }
 
-ConsoleFunction(resetDatablockCache, void, 1, 1, "resetDatablockCache()")
+ConsoleFunction(isDatablockCacheSaved, bool, 1, 1, "() Deprecated; always returns true.")
 {
-	GameConnection::resetDatablockCache();
+   TORQUE_UNUSED(argc); TORQUE_UNUSED(argv);
+   return true;
 }
 
-ConsoleFunction(isDatablockCacheSaved, bool, 1, 1, "resetDatablockCache()")
+ConsoleFunction(getDatablockCacheCRC, S32, 1, 1, "() Deprecated; always returns 0.")
 {
-	return afx_saved_db_cache;
+   TORQUE_UNUSED(argc); TORQUE_UNUSED(argv);
+   return 0;
 }
 
-ConsoleFunction(getDatablockCacheCRC, S32, 1, 1, "getDatablockCacheCRC()")
+ConsoleFunction(extractDatablockCacheCRC, S32, 2, 2, "(filename) Deprecated; always returns 0.")
 {
-	return (S32)afx_saved_db_cache_CRC;
+   TORQUE_UNUSED(argc); TORQUE_UNUSED(argv);
+   return 0;
 }
 
-ConsoleFunction(extractDatablockCacheCRC, S32, 2, 2, "extractDatablockCacheCRC(filename)")
+ConsoleFunction(setDatablockCacheCRC, void, 2, 2, "(crc) Deprecated; does nothing.")
 {
-	FileStream f_stream;
-	if(!f_stream.open(argv[1], Torque::FS::File::Read))
-	{
-		Con::errorf("Failed to open file '%s'.", argv[1]);
-		return -1;
-	}
-
-	U32 stream_sz = f_stream.getStreamSize();
-	if (stream_sz < 4*32)
-	{
-		Con::errorf("File '%s' is not a valid datablock cache.", argv[1]);
-		f_stream.close();
-		return -1;
-	}
-
-	U32 pre_code; f_stream.read(&pre_code);
-	U32 save_sz; f_stream.read(&save_sz);
-	U32 crc_code; f_stream.read(&crc_code);
-	U32 post_code; f_stream.read(&post_code);
-
-	f_stream.close();
-
-	if (pre_code != post_code)
-	{
-		Con::errorf("File '%s' is not a valid datablock cache.", argv[1]);
-		return -1;
-	}
-
-	if (pre_code != (U32)CLIENT_CACHE_VERSION_CODE)
-	{
-		Con::errorf("Version of datablock cache file '%s' does not match version of running software.", argv[1]);
-		return -1;
-	}
-
-	return (S32)crc_code;
+   TORQUE_UNUSED(argc); TORQUE_UNUSED(argv);
 }
 
-ConsoleFunction(setDatablockCacheCRC, void, 2, 2, "setDatablockCacheCRC(crc)")
+ConsoleMethod(GameConnection, saveDatablockCache, void, 2, 2, "() Deprecated; the client cache is saved when the download completes.")
 {
-	GameConnection *conn = GameConnection::getConnectionToServer();
-	if(!conn)
-		return;
-
-	U32 crc_u = (U32)dAtoi(argv[1]);
-	conn->setServerCacheCRC(crc_u);
+   TORQUE_UNUSED(object); TORQUE_UNUSED(argc); TORQUE_UNUSED(argv);
 }
 
-ConsoleMethod( GameConnection, saveDatablockCache, void, 2, 2, "saveDatablockCache()")
+ConsoleMethod(GameConnection, loadDatablockCache, void, 2, 2, "() Deprecated; cached datablocks are loaded during the download.")
 {
-	if (GameConnection::serverCacheEnabled() && !afx_saved_db_cache)
-	{
-		// Save the datablocks to a cache file. An argument
-		// of true indicates that this is a server save.
-		object->saveDatablockCache(true);
-		afx_saved_db_cache = true;
-		afx_saved_db_cache_CRC = 0xffffffff;
-
-		const char* filename = object->serverCacheFilename();
-		if (filename && filename[0] != '\0')
-		{
-			U32 crcVal;
-			FileStream f_stream;
-			if(f_stream.open(filename, Torque::FS::File::Read))
-			{
-				afx_saved_db_cache_CRC = CRC::calculateCRCStream(&f_stream,crcVal);
-			}
-			else
-				Con::errorf("saveDatablockCache() failed to get CRC for file '%s'.", filename);\
-		}
-	}
+   TORQUE_UNUSED(object); TORQUE_UNUSED(argc); TORQUE_UNUSED(argv);
 }
 
-ConsoleMethod( GameConnection, loadDatablockCache, void, 2, 2, "loadDatablockCache()")
+ConsoleMethod(GameConnection, loadDatablockCache_Begin, bool, 2, 2, "() Deprecated; always returns false.")
 {
-	if (GameConnection::clientCacheEnabled())
-	{
-		object->loadDatablockCache();
-	}
+   TORQUE_UNUSED(object); TORQUE_UNUSED(argc); TORQUE_UNUSED(argv);
+   return false;
 }
 
-ConsoleMethod( GameConnection, loadDatablockCache_Begin, bool, 2, 2, "loadDatablockCache_Begin()")
+ConsoleMethod(GameConnection, loadDatablockCache_Continue, bool, 2, 2, "() Deprecated; always returns false.")
 {
-	if (GameConnection::clientCacheEnabled())
-	{
-		return object->loadDatablockCache_Begin();
-	}
-
-	return false;
+   TORQUE_UNUSED(object); TORQUE_UNUSED(argc); TORQUE_UNUSED(argv);
+   return false;
 }
 
-ConsoleMethod( GameConnection, loadDatablockCache_Continue, bool, 2, 2, "loadDatablockCache_Continue()")
+#endif // AFX CODE BLOCK (db-cache) >>
+
+//----------------------------------------------------------------------------
+
+/// The shared state of one file warm.  Workers and the main thread claim
+/// files until none are left, like the parallel scene prep.  Touches no
+/// engine state.
+struct DataBlockFileWarmJob : public ThreadSafeRefCount< DataBlockFileWarmJob >
 {
-	if (GameConnection::clientCacheEnabled())
-	{
-		return object->loadDatablockCache_Continue();
-	}
+   Vector<String> mPaths;
+   volatile U32 mNextPath;
 
-	return false;
-}
+   /// Released once for every file read.
+   Semaphore mFileDone;
 
-static char*        afx_db_load_buf = 0;
-static U32          afx_db_load_buf_sz = 0;
-static BitStream*   afx_db_load_bstream = 0;
+   DataBlockFileWarmJob()
+      : mNextPath( 0 ),
+        mFileDone( 0 )
+   {
+   }
 
-void GameConnection::loadDatablockCache()
-{
-	if (!loadDatablockCache_Begin())
-		return;
+   bool claimPath( U32 &outPath )
+   {
+      for ( ;; )
+      {
+         U32 next = mNextPath;
+         if ( next >= mPaths.size() )
+            return false;
 
-	while (loadDatablockCache_Continue())
-		;
-}
+         if ( dCompareAndSwap( mNextPath, next, next + 1 ) )
+         {
+            outPath = next;
+            return true;
+         }
+      }
+   }
 
-bool GameConnection::loadDatablockCache_Begin()
-{
-	if (!client_cache_filename || client_cache_filename[0] == '\0')
-	{
-		Con::errorf("No filename was specified for the client datablock cache.");
-		return false;
-	}
+   /// Reads files through a read-only mapping, so the pages end up
+   /// in the OS file cache, until there are none left.
+   void run()
+   {
+      U32 path;
+      while ( claimPath( path ) )
+      {
+         const void *data;
+         U32 size;
+         void *handle = Platform::mapFile( mPaths[path].c_str(), data, size );
+         if ( handle )
+         {
+            // Touch one byte per page.
+            const U8 *bytes = (const U8 *) data;
+            volatile U8 sum = 0;
+            for ( U32 i = 0; i < size; i += 4096 )
+               sum += bytes[i];
 
-	// open cache file
-	FileStream f_stream;
-	if(!f_stream.open(client_cache_filename, Torque::FS::File::Read))
-	{
-		Con::errorf("Failed to open file '%s'.", client_cache_filename);
-		return false;
-	}
+            Platform::unmapFile( handle );
+         }
 
-	// get file size
-	U32 stream_sz = f_stream.getStreamSize();
-	if (stream_sz <= 4*4)
-	{
-		Con::errorf("File '%s' is too small to be a valid datablock cache.", client_cache_filename);
-		f_stream.close();
-		return false;
-	}
+         mFileDone.release();
+      }
+   }
+};
 
-	// load header data
-	U32 pre_code; f_stream.read(&pre_code);
-	U32 save_sz; f_stream.read(&save_sz);
-	U32 crc_code; f_stream.read(&crc_code);
-	U32 post_code; f_stream.read(&post_code);
+struct DataBlockFileWarmItem : public ThreadPool::WorkItem
+{
+   typedef ThreadPool::WorkItem Parent;
 
-	// validate header info 
-	if (pre_code != post_code)
-	{
-		Con::errorf("File '%s' is not a valid datablock cache.", client_cache_filename);
-		f_stream.close();
-		return false;
-	}
-	if (pre_code != (U32)CLIENT_CACHE_VERSION_CODE)
-	{
-		Con::errorf("Version of datablock cache file '%s' does not match version of running software.", client_cache_filename);
-		f_stream.close();
-		return false;
-	}
+   ThreadSafeRef< DataBlockFileWarmJob > mJob;
 
-	// allocated the in-memory buffer
-	afx_db_load_buf_sz = stream_sz - (4*4);
-	afx_db_load_buf = new char[afx_db_load_buf_sz];
+   DataBlockFileWarmItem( DataBlockFileWarmJob *job )
+      : mJob( job ) {}
 
-	// load data from file into memory
-	if (!f_stream.read(stream_sz, afx_db_load_buf))
-	{
-		Con::errorf("Failed to read data from file '%s'.", client_cache_filename);
-		f_stream.close();
-		delete [] afx_db_load_buf;
-		afx_db_load_buf = 0;
-		afx_db_load_buf_sz = 0;
-		return false;
-	}
+protected:
+   virtual void execute()
+   {
+      mJob->run();
+   }
+};
 
-	// close file
-	f_stream.close();
+/// Resolve a datablock filename field to a native path, trying the usual
+/// texture extensions for extension-less image names.
+static bool resolveDataBlockFile( const char *value, String &outPath )
+{
+   static const char *sExtensions[] = { "", ".dds", ".png", ".jpg" };
 
-	// At this point we have the whole cache in memory
+   Torque::Path path( value );
+   const U32 numExtensions = path.getExtension().isEmpty() ? sizeof( sExtensions ) / sizeof( sExtensions[0] ) : 1;
 
-	// create a bitstream from the in-memory buffer
-	afx_db_load_bstream = new BitStream(afx_db_load_buf, afx_db_load_buf_sz);
+   for ( U32 i = 0; i < numExtensions; i++ )
+   {
+      Torque::Path candidate( String( value ) + sExtensions[i] );
+      if ( !Torque::FS::IsFile( candidate ) )
+         continue;
 
-	return true;
+      Torque::Path fsPath;
+      if ( !Torque::FS::GetFSPath( candidate, fsPath ) )
+         return false;
+
+      outPath = fsPath.getFullPath();
+      return true;
+   }
+
+   return false;
 }
 
-bool GameConnection::loadDatablockCache_Continue()
+void GameConnection::warmDataBlockFiles(const Vector<SimDataBlock*> &blocks)
 {
-	if (!afx_db_load_bstream)
-		return false;
+   if (!blocks.size())
+      return;
 
-	// prevent repacking of datablocks during load
-	BitStream* save_client_db_stream = client_db_stream;
-	client_db_stream = 0;
+   U64 start = Platform::getPerformanceCounter();
 
-	bool all_finished = false;
+   // Gather the files on this thread; the volume system isn't safe to
+   // use from the pool, so workers only ever see native paths.
+   ThreadSafeRef< DataBlockFileWarmJob > job( new DataBlockFileWarmJob );
+   Vector<String> &paths = job->mPaths;
+   Map<String, bool> seen;
+   for (U32 i = 0; i < blocks.size(); i++)
+   {
+      SimDataBlock *block = blocks[i];
+      const AbstractClassRep::FieldList &list = block->getFieldList();
 
-	// loop through at most 16 datablocks
-	BitStream *bstream = afx_db_load_bstream;
-	for (S32 i = 0; i < 16; i++)
-	{
-		S32 save_pos = bstream->getCurPos();
-		if (!bstream->readFlag())
-		{
-			all_finished = true;
-			break;
-		}
-		bstream->setCurPos(save_pos);
-		SimDataBlockEvent evt;
-		evt.unpack(this, bstream);
-		evt.process(this);
-	}
+      for (U32 j = 0; j < list.size(); j++)
+      {
+         const AbstractClassRep::Field &field = list[j];
+         if (field.type != TypeFilename && field.type != TypeStringFilename && field.type != TypeImageFilename)
+            continue;
+
+         StringTableEntry fieldName = StringTable->insert(field.pFieldname);
+         for (S32 k = 0; k < field.elementCount; k++)
+         {
+            char array[8];
+            dSprintf(array, sizeof(array), "%d", k);
+            const char *value = block->getDataField(fieldName, array);
+            if (!value || !value[0])
+               continue;
+
+            String path;
+            if (!resolveDataBlockFile(value, path) || seen.contains(path))
+               continue;
+
+            seen.insert(path, true);
+            paths.push_back(path);
+         }
+      }
+   }
 
-	client_db_stream = save_client_db_stream;
+   // The main thread reads files too, so only wake up as many
+   // workers as there are files left for them.
+   ThreadPool &pool = ThreadPool::GLOBAL();
+   const U32 numItems = paths.size() ? getMin(pool.getNumThreads(), U32(paths.size() - 1)) : 0;
+   for (U32 i = 0; i < numItems; i++)
+      pool.queueWorkItem(new DataBlockFileWarmItem(job));
 
-	if (all_finished)
-	{
-		delete afx_db_load_bstream;
-		afx_db_load_bstream = 0;
-		delete [] afx_db_load_buf;
-		afx_db_load_buf = 0;
-		afx_db_load_buf_sz = 0;
-		return false;
-	}
+   U64 queued = Platform::getPerformanceCounter();
+   mDataBlockLoadStats.warmQueueTime += queued - start;
 
-	return true;
+   // Join: preload() must not start before its files are resident.
+   job->run();
+   for (U32 i = 0; i < paths.size(); i++)
+      job->mFileDone.acquire();
+
+   mDataBlockLoadStats.warmJoinTime += Platform::getPerformanceCounter() - queued;
+   mDataBlockLoadStats.numFilesWarmed += paths.size();
+}
+
+void GameConnection::reportDataBlockLoadStats()
+{
+   const DataBlockLoadStats &stats = mDataBlockLoadStats;
+   if (stats.numReceived)
+   {
+      const F64 toMs = 1000.0 / F64(Platform::getPerformanceCounterFrequency());
+
+      Con::printf("Datablocks: %d received (%d from cache), %d files warmed", stats.numReceived, stats.numCached, stats.numFilesWarmed);
+      Con::printf("   unpack %.2f ms, register %.2f ms, file warm %.2f ms (join %.2f ms), preload %.2f ms",
+         stats.unpackTime * toMs, stats.registerTime * toMs,
+         stats.warmQueueTime * toMs, stats.warmJoinTime * toMs, stats.preloadTime * toMs);
+   }
+
+   dMemset(&mDataBlockLoadStats, 0, sizeof(mDataBlockLoadStats));
 }
 
-#endif // AFX CODE BLOCK (db-cache) >>
 
 ConsoleMethod(GameConnection, setSelectedObj, bool, 3, 4, "(object, [propagate_to_client])")
 {
@@ -2153,4 +2102,4 @@ void GameConnection::onDeleteNotify(SimObject* obj)
 		setSelectedObj(NULL);
 
 	Parent::onDeleteNotify(obj);
-}
\ No newline at end of file
+}
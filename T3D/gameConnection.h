@@ -24,14 +24,19 @@
 #ifndef _MOVELIST_H_
 #include "T3D/moveList.h"
 #endif
+#ifndef _TDICTIONARY_H_
+#include "core/util/tDictionary.h"
+#endif
 
 enum GameConnectionConstants
 {
    MaxClients = 126,
-   DataBlockQueueCount = 16
+   DataBlockQueueCount = 16,
+   DataBlockBatchWindow = 4
 };
 
 class SFXProfile;
+class DataBlockCache;
 class MatrixF;
 class MatrixF;
 class Point3F;
@@ -310,29 +315,66 @@ public:
    static Signal<void()> smPlayingDemo;
 #ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
   private:
-	  static StringTableEntry  server_cache_filename;
 	  static StringTableEntry  client_cache_filename;
 	  static bool   server_cache_on;
 	  static bool   client_cache_on;
-	  BitStream*    client_db_stream;
-	  //char*         curr_stringBuf;
-	  U32           server_cache_CRC;
+
+	  /// @name Datablock cache (client)
+	  /// @{
+	  DataBlockCache*  mDataBlockCache;
+	  /// @}
+
+	  /// @name Datablock cache (server)
+	  /// @{
+
+	  /// Content hashes of the datablocks the client reported in its manifest.
+	  Map<SimObjectId, U32>   mClientDataBlockHashes;
+	  U32           mDataBlockBatchIndex;
+	  U32           mDataBlockBatchesInFlight;
+	  /// @}
+
   public:
-	  void          repackClientDatablock(BitStream*, S32 start_pos);
-	  void          saveDatablockCache(bool on_server);
-	  void          loadDatablockCache();
-	  bool          loadDatablockCache_Begin();
-	  bool          loadDatablockCache_Continue();
-	  void          tempDisableStringBuffering(BitStream* bs) const;
-	  void          restoreStringBuffering(BitStream* bs) const;
-	  void          setServerCacheCRC(U32 crc) { server_cache_CRC = crc; }
-
-	  static void   resetDatablockCache();
+	  DataBlockCache* getDataBlockCache() { return mDataBlockCache; }
+	  void          sendDataBlockManifest();
+
+	  void          setClientDataBlockHash(SimObjectId id, U32 hash) { mClientDataBlockHashes[id] = hash; }
+	  bool          clientHasDataBlock(SimObjectId id, U32 hash) const;
+
+	  /// Begin streaming modified datablocks to a remote client in batches.
+	  void          startDataBlockBatches();
+	  bool          postNextDataBlockBatch();
+	  void          onDataBlockBatchDelivered(U32 sequence);
+
 	  static bool   serverCacheEnabled() { return server_cache_on; }
 	  static bool   clientCacheEnabled() { return client_cache_on; }
-	  static const char* serverCacheFilename() { return server_cache_filename; }
 	  static const char* clientCacheFilename() { return client_cache_filename; }
 #endif // AFX CODE BLOCK (db-cache) >>
+
+  public:
+	  /// Per-phase timings of receiving and preloading datablocks, reported
+	  /// once the download completes.
+	  struct DataBlockLoadStats
+	  {
+		  U32   numReceived;
+		  U32   numCached;
+		  U32   numFilesWarmed;
+		  U64   unpackTime;
+		  U64   registerTime;
+		  U64   warmQueueTime;
+		  U64   warmJoinTime;
+		  U64   preloadTime;
+	  };
+
+	  DataBlockLoadStats& getDataBlockLoadStats() { return mDataBlockLoadStats; }
+
+	  /// Read the files referenced by the given datablocks on the thread pool
+	  /// so that their preload() finds them in the OS file cache.  Returns once
+	  /// all reads have finished.
+	  void          warmDataBlockFiles(const Vector<SimDataBlock*> &blocks);
+
+  private:
+	  DataBlockLoadStats   mDataBlockLoadStats;
+	  void          reportDataBlockLoadStats();
 		private:   
 			SimObjectPtr<SceneObject> mRolloverObj;  
 			SimObjectPtr<SceneObject> mPreSelectedObj;  
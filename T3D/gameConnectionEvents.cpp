@@ -14,11 +14,16 @@
 #include "app/game.h"
 #include "T3D/gameConnection.h"
 #include "T3D/gameConnectionEvents.h"
+#include "T3D/dataBlockCache.h"
+#include "core/frameAllocator.h"
+#include "zlib/zlib.h"
 
 #define DebugChecksum 0xF00DBAAD
 
 //--------------------------------------------------------------------------
 IMPLEMENT_CO_CLIENTEVENT_V1(SimDataBlockEvent);
+IMPLEMENT_CO_CLIENTEVENT_V1(SimDataBlockBatchEvent);
+IMPLEMENT_CO_SERVEREVENT_V1(DataBlockManifestEvent);
 IMPLEMENT_CO_CLIENTEVENT_V1(Sim2DAudioEvent);
 IMPLEMENT_CO_CLIENTEVENT_V1(Sim3DAudioEvent);
 IMPLEMENT_CO_CLIENTEVENT_V1(SetMissionCRCEvent);
@@ -89,9 +94,6 @@ void SimDataBlockEvent::notifyDelivered(NetConnection *conn, bool )
 
 void SimDataBlockEvent::pack(NetConnection *conn, BitStream *bstream)
 {
-#ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
-	((GameConnection *)conn)->tempDisableStringBuffering(bstream);
-#endif // AFX CODE BLOCK (db-cache) >>
    SimDataBlock* obj;
    Sim::findObject(id,obj);
    GameConnection *gc = (GameConnection *) conn;
@@ -113,18 +115,10 @@ void SimDataBlockEvent::pack(NetConnection *conn, BitStream *bstream)
       bstream->writeInt(classId ^ DebugChecksum, 32);
 #endif
    }
-#ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
-   ((GameConnection *)conn)->restoreStringBuffering(bstream);
-#endif // AFX CODE BLOCK (db-cache) >>
 }
 
 void SimDataBlockEvent::unpack(NetConnection *cptr, BitStream *bstream)
 {
-#ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
-	// stash the stream position prior to unpacking
-	S32 start_pos = bstream->getCurPos();
-	((GameConnection *)cptr)->tempDisableStringBuffering(bstream);
-#endif // AFX CODE BLOCK (db-cache) >>
    if(bstream->readFlag())
    {
       mProcess = true;
@@ -154,11 +148,6 @@ void SimDataBlockEvent::unpack(NetConnection *cptr, BitStream *bstream)
 #endif
 
    }
-#ifdef AFX_CAP_DATABLOCK_CACHE // AFX CODE BLOCK (db-cache) <<
-   // rewind to stream position and then process raw bytes for caching
-   ((GameConnection *)cptr)->repackClientDatablock(bstream, start_pos);
-   ((GameConnection *)cptr)->restoreStringBuffering(bstream);
-#endif // AFX CODE BLOCK (db-cache) >>
 }
 
 void SimDataBlockEvent::write(NetConnection *cptr, BitStream *bstream)
@@ -174,6 +163,44 @@ void SimDataBlockEvent::write(NetConnection *cptr, BitStream *bstream)
    }
 }
 
+/// Apply a datablock received from the server.  If a block of the same class
+/// already exists under that id it is updated in place and preloaded; otherwise
+/// @a newObj is registered, ownership passes to the connection and the block
+/// is returned so the caller can queue it for preloading.
+static SimDataBlock* applyDataBlock(NetConnection *cptr, SimObjectId id, SimDataBlock *&newObj)
+{
+   SimDataBlock* obj = NULL;
+   String &errorBuffer = NetConnection::getErrorBuffer();
+
+   if( Sim::findObject( id,obj ) && dStrcmp( obj->getClassName(),newObj->getClassName() ) == 0 )
+   {
+      U8 buf[1500];
+      BitStream stream(buf, 1500);
+      newObj->packData(&stream);
+      stream.setPosition(0);
+      obj->unpackData(&stream);
+      obj->preload(false, errorBuffer);
+      return NULL;
+   }
+
+   if( obj != NULL )
+   {
+      Con::warnf( "A '%s' datablock with id: %d already existed. "
+                  "Clobbering it with new '%s' datablock from server.",
+                  obj->getClassName(), id, newObj->getClassName() );
+      obj->deleteObject();
+   }
+
+   if(!newObj->registerObject(id))
+      return NULL;
+
+   cptr->addObject(newObj);
+
+   SimDataBlock *registered = newObj;
+   newObj = NULL;
+   return registered;
+}
+
 void SimDataBlockEvent::process(NetConnection *cptr)
 {
    if(mProcess)
@@ -181,43 +208,325 @@ void SimDataBlockEvent::process(NetConnection *cptr)
       //call the console function to set the number of blocks to be sent
       Con::executef("onDataBlockObjectReceived", Con::getIntArg(mIndex), Con::getIntArg(mTotal));
 
-      SimDataBlock* obj = NULL;
-      String &errorBuffer = NetConnection::getErrorBuffer();
+      GameConnection *conn = dynamic_cast<GameConnection *>(cptr);
+      if(!conn)
+         return;
+
+      SimDataBlock *blk = applyDataBlock(cptr, id, mObj);
+      if(blk)
+         conn->preloadDataBlock(blk);
+   }
+}
+
+
+//----------------------------------------------------------------------------
+
+DataBlockManifestEvent::DataBlockManifestEvent()
+{
+   VECTOR_SET_ASSOCIATION(mIds);
+   VECTOR_SET_ASSOCIATION(mHashes);
+}
+
+void DataBlockManifestEvent::addEntry(SimObjectId id, U32 hash)
+{
+   AssertFatal(mIds.size() < MaxEntries, "DataBlockManifestEvent::addEntry - too many entries");
+   mIds.push_back(id);
+   mHashes.push_back(hash);
+}
+
+void DataBlockManifestEvent::pack(NetConnection *, BitStream *bstream)
+{
+   bstream->writeInt(mIds.size(), 7);
+   for(U32 i = 0; i < mIds.size(); i++)
+   {
+      bstream->writeInt(mIds[i] - DataBlockObjectIdFirst, DataBlockObjectIdBitSize);
+      bstream->write(mHashes[i]);
+   }
+}
+
+void DataBlockManifestEvent::write(NetConnection *cptr, BitStream *bstream)
+{
+   pack(cptr, bstream);
+}
+
+void DataBlockManifestEvent::unpack(NetConnection *, BitStream *bstream)
+{
+   U32 count = getMin(U32(bstream->readInt(7)), U32(MaxEntries));
+   mIds.setSize(count);
+   mHashes.setSize(count);
+   for(U32 i = 0; i < count; i++)
+   {
+      mIds[i] = bstream->readInt(DataBlockObjectIdBitSize) + DataBlockObjectIdFirst;
+      bstream->read(&mHashes[i]);
+   }
+}
+
+void DataBlockManifestEvent::process(NetConnection *cptr)
+{
+   GameConnection *conn = dynamic_cast<GameConnection *>(cptr);
+   if(!conn)
+      return;
+
+   for(U32 i = 0; i < mIds.size(); i++)
+      conn->setClientDataBlockHash(mIds[i], mHashes[i]);
+}
+
+
+//----------------------------------------------------------------------------
+
+SimDataBlockBatchEvent::SimDataBlockBatchEvent(GameConnection *conn, U32 startIndex, U32 missionSequence)
+{
+   VECTOR_SET_ASSOCIATION(mPayload);
+   VECTOR_SET_ASSOCIATION(mItems);
+   VECTOR_SET_ASSOCIATION(mFullIds);
+   VECTOR_SET_ASSOCIATION(mFullHashes);
+
+   mStartIndex = startIndex;
+   mNextIndex = startIndex;
+   mTotal = 0;
+   mMissionSequence = missionSequence;
+   mRawSize = 0;
+
+   if(!conn)
+      return;
+
+   mTotal = Sim::getDataBlockGroup()->size();
+
+   // Shrink the batch until it compresses into a single packet.  A lone
+   // block that still doesn't fit goes out on its own anyway, just as it
+   // would have in a SimDataBlockEvent.
+   U32 maxItems = MaxItems;
+   buildPayload(conn, maxItems);
+   while(mPayload.size() > MaxPayloadSize && maxItems > 1)
+   {
+      maxItems >>= 1;
+      buildPayload(conn, maxItems);
+   }
+
+   // The client caches the blocks sent in full, so a later block with
+   // the same hash can go out as a reference to them rather than to a
+   // stale manifest entry.
+   for(U32 i = 0; i < mFullIds.size(); i++)
+      conn->setClientDataBlockHash(mFullIds[i], mFullHashes[i]);
+}
+
+SimDataBlockBatchEvent::~SimDataBlockBatchEvent()
+{
+   for(U32 i = 0; i < mItems.size(); i++)
+      delete mItems[i].obj;
+}
+
+void SimDataBlockBatchEvent::buildPayload(GameConnection *conn, U32 maxItems)
+{
+   SimDataBlockGroup *g = Sim::getDataBlockGroup();
+   const S32 key = conn->getDataBlockModifiedKey();
+
+   InfiniteBitStream raw;
+   U32 numItems = 0;
+   U32 i = mStartIndex;
+
+   mFullIds.clear();
+   mFullHashes.clear();
+
+   for(; i < g->size() && numItems < maxItems && raw.getPosition() < MaxRawSize; i++)
+   {
+      SimDataBlock *obj = (SimDataBlock *) (*g)[i];
+      if(obj->getModifiedKey() <= key)
+         continue;
+
+      if(obj->getModifiedKey() > conn->getMaxDataBlockModifiedKey())
+         conn->setMaxDataBlockModifiedKey(obj->getModifiedKey());
+
+      S32 classId = obj->getClassId(conn->getNetClassGroup());
+      U32 hash;
+      const bool hashed = DataBlockCache::getDataBlockHash(obj, conn, hash);
+
+      raw.writeFlag(true);
+      raw.writeInt(obj->getId() - DataBlockObjectIdFirst, DataBlockObjectIdBitSize);
+      raw.writeClassId(classId, NetClassTypeDataBlock, conn->getNetClassGroup());
+      raw.writeInt(i, DataBlockObjectIdBitSize);
+
+      if(!raw.writeFlag(hashed && conn->clientHasDataBlock(obj->getId(), hash)))
+      {
+         obj->packData(&raw);
+         if(hashed)
+         {
+            mFullIds.push_back(obj->getId());
+            mFullHashes.push_back(hash);
+         }
+      }
+
+      numItems++;
+   }
+   raw.writeFlag(false);
+
+   mNextIndex = i;
+   mPayload.clear();
+   mRawSize = 0;
+
+   if(!numItems)
+      return;
+
+   mRawSize = raw.getPosition();
+
+   uLongf destLen = compressBound(mRawSize);
+   mPayload.setSize(destLen);
+   compress2((Bytef*)mPayload.address(), &destLen, (const Bytef*)raw.getBuffer(), mRawSize, 9);
+   mPayload.setSize(destLen);
+}
+
+void SimDataBlockBatchEvent::notifyDelivered(NetConnection *conn, bool)
+{
+   if(conn->isRemoved())
+      return;
+
+   GameConnection *gc = (GameConnection *) conn;
+   gc->onDataBlockBatchDelivered(mMissionSequence);
+}
+
+void SimDataBlockBatchEvent::pack(NetConnection *, BitStream *bstream)
+{
+   bstream->writeInt(mTotal, DataBlockObjectIdBitSize + 1);
+   // A lone oversized block may exceed 64k, so the sizes get full words.
+   bstream->write(mRawSize);
+   bstream->write(U32(mPayload.size()));
+   bstream->writeBits(mPayload.size() << 3, mPayload.address());
+}
+
+void SimDataBlockBatchEvent::write(NetConnection *cptr, BitStream *bstream)
+{
+   pack(cptr, bstream);
+}
+
+void SimDataBlockBatchEvent::unpack(NetConnection *cptr, BitStream *bstream)
+{
+   U64 start = Platform::getPerformanceCounter();
+
+   mTotal = bstream->readInt(DataBlockObjectIdBitSize + 1);
+   U32 payloadSize = 0;
+   bstream->read(&mRawSize);
+   bstream->read(&payloadSize);
+
+   // Don't let a bad packet make us allocate; the payload has to fit in the
+   // packet and zlib can't expand more than about 1032:1.
+   if(!bstream->isValid() ||
+      payloadSize > U32(bstream->getReadByteSize()) ||
+      mRawSize > payloadSize * 1032)
+   {
+      cptr->setLastError("Invalid packet in SimDataBlockBatchEvent::unpack()");
+      return;
+   }
+
+   mPayload.setSize(payloadSize);
+   bstream->readBits(payloadSize << 3, mPayload.address());
+
+   // Pad the raw buffer so the final readBits() stays inside it.
+   Vector<U8> raw;
+   raw.setSize(mRawSize + 4);
+   dMemset(raw.address(), 0, raw.size());
+
+   uLongf destLen = mRawSize;
+   if(!bstream->isValid() ||
+      uncompress((Bytef*)raw.address(), &destLen, (const Bytef*)mPayload.address(), payloadSize) != Z_OK ||
+      destLen != mRawSize)
+   {
+      cptr->setLastError("Invalid packet in SimDataBlockBatchEvent::unpack()");
+      return;
+   }
+   mPayload.clear();
+
+   GameConnection *conn = dynamic_cast<GameConnection *>(cptr);
+   DataBlockCache *cache = conn ? conn->getDataBlockCache() : NULL;
 
-      if( Sim::findObject( id,obj ) && dStrcmp( obj->getClassName(),mObj->getClassName() ) == 0 )
+   BitStream stream(raw.address(), mRawSize);
+   while(stream.readFlag())
+   {
+      Item item;
+      item.id = stream.readInt(DataBlockObjectIdBitSize) + DataBlockObjectIdFirst;
+      S32 classId = stream.readClassId(NetClassTypeDataBlock, cptr->getNetClassGroup());
+      item.index = stream.readInt(DataBlockObjectIdBitSize);
+      item.obj = NULL;
+
+      if(stream.readFlag())
       {
-         U8 buf[1500];
-         BitStream stream(buf, 1500);
-         mObj->packData(&stream);
-         stream.setPosition(0);
-         obj->unpackData(&stream);
-         obj->preload(false, errorBuffer);
+         const DataBlockCache::Entry *entry = cache ? cache->find(item.id) : NULL;
+         if(entry && entry->classId == classId)
+            item.obj = cache->createDataBlock(*entry, cptr);
+         if(!item.obj)
+         {
+            cptr->setLastError("Invalid packet in SimDataBlockBatchEvent::unpack() - missing cached datablock");
+            return;
+         }
+         if(conn)
+            conn->getDataBlockLoadStats().numCached++;
       }
       else
       {
-         if( obj != NULL )
+         SimObject* ptr = (SimObject *) ConsoleObject::create(cptr->getNetClassGroup(), NetClassTypeDataBlock, classId);
+         if((item.obj = dynamic_cast<SimDataBlock*>(ptr)) == NULL)
          {
-            Con::warnf( "A '%s' datablock with id: %d already existed. "
-                        "Clobbering it with new '%s' datablock from server.",
-                        obj->getClassName(), id, mObj->getClassName() );
-            obj->deleteObject();
+            delete ptr;
+            cptr->setLastError("Invalid packet in SimDataBlockBatchEvent::unpack()");
+            return;
          }
 
-         bool ret = mObj->registerObject(id);
+         U32 startPos = stream.getCurPos();
+         item.obj->unpackData(&stream);
 
-         if(ret)
+         if(cache)
          {
-            cptr->addObject(mObj);
-
-            GameConnection *conn = dynamic_cast<GameConnection *>(cptr);
-            if(conn)
-            {
-               conn->preloadDataBlock(mObj);
-               mObj = NULL;
-            }
+            U32 endPos = stream.getCurPos();
+            U32 numBits = endPos - startPos;
+
+            FrameTemp<U8> bits(((numBits + 7) >> 3) + 1);
+            stream.setCurPos(startPos);
+            stream.readBits(numBits, ~bits);
+            stream.setCurPos(endPos);
+
+            cache->record(item.id, classId, ~bits, numBits);
          }
       }
+
+      mItems.push_back(item);
    }
+
+   if(conn)
+   {
+      conn->getDataBlockLoadStats().numReceived += mItems.size();
+      conn->getDataBlockLoadStats().unpackTime += Platform::getPerformanceCounter() - start;
+   }
+}
+
+void SimDataBlockBatchEvent::process(NetConnection *cptr)
+{
+   GameConnection *conn = dynamic_cast<GameConnection *>(cptr);
+   if(!conn)
+      return;
+
+   GameConnection::DataBlockLoadStats &stats = conn->getDataBlockLoadStats();
+   U64 start = Platform::getPerformanceCounter();
+
+   Vector<SimDataBlock*> newBlocks;
+   for(U32 i = 0; i < mItems.size(); i++)
+   {
+      Item &item = mItems[i];
+
+      //call the console function to set the number of blocks to be sent
+      Con::executef("onDataBlockObjectReceived", Con::getIntArg(item.index), Con::getIntArg(mTotal));
+
+      SimDataBlock *blk = applyDataBlock(cptr, item.id, item.obj);
+      if(blk)
+         newBlocks.push_back(blk);
+   }
+
+   stats.registerTime += Platform::getPerformanceCounter() - start;
+
+   // Pull the files the new blocks reference into the OS cache on the
+   // thread pool, then run the preloads on this thread.
+   conn->warmDataBlockFiles(newBlocks);
+
+   for(U32 i = 0; i < newBlocks.size(); i++)
+      conn->preloadDataBlock(newBlocks[i]);
 }
 
 
@@ -40,6 +40,78 @@ class SimDataBlockEvent : public NetEvent
    DECLARE_CONOBJECT(SimDataBlockEvent);
 };
 
+//----------------------------------------------------------------------------
+// Sent by the client on connect: the ids and content hashes of the
+// datablocks it holds in its DataBlockCache.
+//----------------------------------------------------------------------------
+class DataBlockManifestEvent : public NetEvent
+{
+   Vector<SimObjectId> mIds;
+   Vector<U32> mHashes;
+  public:
+   enum { MaxEntries = 64 };
+
+   DataBlockManifestEvent();
+   void addEntry(SimObjectId id, U32 hash);
+   void pack(NetConnection *, BitStream *bstream);
+   void write(NetConnection *, BitStream *bstream);
+   void unpack(NetConnection *cptr, BitStream *bstream);
+   void process(NetConnection*);
+   DECLARE_CONOBJECT(DataBlockManifestEvent);
+};
+
+//----------------------------------------------------------------------------
+// Transmits a run of datablocks in one zlib compressed payload.  Blocks the
+// client already has in its cache with a matching hash are sent as bare
+// references and unpacked from the cache on the client.
+//----------------------------------------------------------------------------
+class SimDataBlockBatchEvent : public NetEvent
+{
+   struct Item
+   {
+      SimObjectId id;
+      SimDataBlock *obj;
+      U32 index;
+   };
+
+   U32 mStartIndex;
+   U32 mNextIndex;
+   U32 mTotal;
+   U32 mMissionSequence;
+   U32 mRawSize;
+   Vector<U8> mPayload;
+   Vector<Item> mItems;
+
+   /// The blocks of the payload which are sent in full, and their hashes.
+   Vector<SimObjectId> mFullIds;
+   Vector<U32> mFullHashes;
+
+   /// Pack up to maxItems blocks starting at mStartIndex into mPayload.
+   void buildPayload(GameConnection *conn, U32 maxItems);
+
+  public:
+   enum
+   {
+      MaxItems = 64,
+      MaxRawSize = 8192,      ///< Stop adding blocks once the raw payload is this large.
+      MaxPayloadSize = 1024,  ///< Compressed payload budget; keeps a batch within one packet.
+   };
+
+   ~SimDataBlockBatchEvent();
+   SimDataBlockBatchEvent(GameConnection *conn = NULL, U32 startIndex = 0, U32 missionSequence = 0);
+
+   /// Returns true if the batch contains no blocks to send.
+   bool isEmpty() const { return mPayload.empty(); }
+   U32 getNextIndex() const { return mNextIndex; }
+
+   void pack(NetConnection *, BitStream *bstream);
+   void write(NetConnection *, BitStream *bstream);
+   void unpack(NetConnection *cptr, BitStream *bstream);
+   void process(NetConnection*);
+   void notifyDelivered(NetConnection *, bool);
+   DECLARE_CONOBJECT(SimDataBlockBatchEvent);
+};
+
 class Sim2DAudioEvent: public NetEvent
 {
   private:
@@ -320,6 +320,7 @@ void GameRenderWorld()
 static void Process3D()
 {
    MATMGR->updateTime();
+   MATMGR->processPendingInits();
 }
 
 static void RegisterGameFunctions()
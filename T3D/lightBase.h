@@ -100,6 +100,10 @@ public:
    // SceneObject
    virtual void setTransform( const MatrixF &mat );
    virtual bool prepRenderImage( SceneState *state, const U32 stateKey, const U32, const bool );
+
+   /// The flare does its visibility test through the GFX device, so
+   /// only lights without one can be prepped on a worker.
+   virtual bool isPrepRenderImageThreadSafe() const { return mFlareData == NULL; }
    virtual void onMount( SceneObject *obj, S32 node );
    virtual void onUnmount( SceneObject *obj, S32 node );
    virtual void unmount();
@@ -64,6 +64,7 @@ class PhysicalZone : public SceneObject
                          const U32 stateKey,
                          const U32 startZone,
                          const bool modifyBaseState );
+   bool isPrepRenderImageThreadSafe() const { return true; }
 
    inline F32 getVelocityMod() const      { return mVelocityMod; }
    inline F32 getGravityMod()  const      { return mGravityMod;  }
@@ -62,6 +62,7 @@ public:
                          const U32 stateKey,
                          const U32 startZone, 
                          const bool modifyBaseState );
+   bool isPrepRenderImageThreadSafe() const { return true; }
 
    void resetParticles();
    void setRate( F32 rate );
@@ -156,6 +156,8 @@ PlayerData::PlayerData()
    shadowSize = 256;
    shadowProjectionDistance = 14.0f;
 
+   // Players keep their detail longer than props.
+   lodImportance = 2.0f;
 
    renderFirstPerson = true;
    pickupRadius = 0.0f;
@@ -15,6 +15,7 @@
 #include "core/stream/bitStream.h"
 #include "ts/tsPartInstance.h"
 #include "ts/tsShapeInstance.h"
+#include "ts/tsAnimateBatch.h"
 #include "sceneGraph/sceneGraph.h"
 #include "sceneGraph/sceneState.h"
 #include "T3D/fx/explosion.h"
@@ -101,6 +102,7 @@ ShapeBaseData::ShapeBaseData()
    firstPersonOnly( false ),
    useEyePoint( false ),
    reflectorDesc( NULL ),
+   lodImportance( 1.0f ),
    observeThroughObject( false ),
    computeCRC( false ),
    inheritEnergyFromMount( false ),
@@ -378,6 +380,7 @@ void ShapeBaseData::initPersistFields()
    addGroup("Render");
 
       addField( "shapeFile",      TypeFilename, Offset(shapeName,      ShapeBaseData) );
+      addField( "lodImportance",  TypeF32,      Offset(lodImportance,  ShapeBaseData) );
 
    endGroup("Render");
 
@@ -598,6 +601,7 @@ void ShapeBaseData::packData(BitStream* stream)
    stream->writeFlag(useEyePoint);
    
    stream->write(cubeDescName);
+   stream->write(lodImportance);
    //stream->write(reflectPriority);
    //stream->write(reflectMaxRateMs);
    //stream->write(reflectMinDist);
@@ -692,6 +696,7 @@ void ShapeBaseData::unpackData(BitStream* stream)
    useEyePoint = stream->readFlag();
 
    stream->read(&cubeDescName);
+   stream->read(&lodImportance);
    //stream->read(&reflectPriority);
    //stream->read(&reflectMaxRateMs);
    //stream->read(&reflectMinDist);
@@ -878,6 +883,7 @@ bool ShapeBase::onNewDataBlock( GameBaseData *dptr )
    if (bool(mDataBlock->mShape)) {
       delete mShapeInstance;
       mShapeInstance = new TSShapeInstance(mDataBlock->mShape, isClientObject());
+      mShapeInstance->setLODImportance(mDataBlock->lodImportance);
       if (isClientObject())
          mShapeInstance->cloneMaterialList();
 
@@ -2325,6 +2331,49 @@ bool ShapeBase::prepRenderImage( SceneState *state,
    return _prepRenderImage( state, stateKey, startZone, modifyBaseState, true, true );
 }
 
+void ShapeBase::prepAnimation( SceneState *state, TSAnimateBatch *batch )
+{
+   if ( !mShapeInstance || mMeshHidden.testAll() || mCubeReflector.isRendering() )
+      return;
+
+   if ( ( getDamageState() == Destroyed ) && ( !mDataBlock->renderWhenDestroyed ) )
+      return;
+
+   if ( !state->isObjectRendered(this) && !state->isReflectPass() )
+      return;
+
+   // Select the same detail _prepRenderImage() will, so
+   // that the shape is animated for the detail it renders.
+   if ( _isHighestDetailForced() )
+      mShapeInstance->setCurrentDetail( 0 );
+   else
+      mShapeInstance->setDetailFromDistance( state, _getDetailDistance( state ) );
+
+   batch->add( mShapeInstance );
+}
+
+bool ShapeBase::_isHighestDetailForced()
+{
+   GameConnection *con = GameConnection::getConnectionToServer();
+   ShapeBase *co = NULL;
+   if(con && ( (co = dynamic_cast<ShapeBase*>(con->getControlObject())) != NULL) )
+      return co == this || co->getObjectMount() == this;
+
+   return false;
+}
+
+F32 ShapeBase::_getDetailDistance( SceneState *state ) const
+{
+   Point3F cameraOffset = getWorldBox().getClosestPoint( state->getDiffuseCameraPosition() ) - state->getDiffuseCameraPosition();
+   F32 dist = cameraOffset.len();
+   if (dist < 0.01f)
+      dist = 0.01f;
+
+   F32 invScale = (1.0f/getMax(getMax(mObjScale.x,mObjScale.y),mObjScale.z));
+
+   return dist * invScale;
+}
+
 bool ShapeBase::_prepRenderImage(   SceneState *state, 
                                     const U32 stateKey,
                                     const U32 startZone, 
@@ -2364,35 +2413,21 @@ bool ShapeBase::_prepRenderImage(   SceneState *state,
 
    // We force all the shapes to use the highest detail
    // if we're the control object or mounted.
-   bool forceHighestDetail = false;
-   {
-      GameConnection *con = GameConnection::getConnectionToServer();
-      ShapeBase *co = NULL;
-      if(con && ( (co = dynamic_cast<ShapeBase*>(con->getControlObject())) != NULL) )
-      {
-         if(co == this || co->getObjectMount() == this)
-            forceHighestDetail = true;
-      }
-   }
+   const bool forceHighestDetail = _isHighestDetailForced();
 
    if ( state->isObjectRendered(this) || state->isReflectPass() )
    {
       mLastRenderFrame = sLastRenderFrame;
 
       // get shape detail...we might not even need to be drawn
-      Point3F cameraOffset = getWorldBox().getClosestPoint( state->getDiffuseCameraPosition() ) - state->getDiffuseCameraPosition();
-      F32 dist = cameraOffset.len();
-      if (dist < 0.01f)
-         dist = 0.01f;
-
-      F32 invScale = (1.0f/getMax(getMax(mObjScale.x,mObjScale.y),mObjScale.z));
+      const F32 dist = _getDetailDistance( state );
 
       if (mShapeInstance)
       {
          if ( forceHighestDetail )         
             mShapeInstance->setCurrentDetail( 0 );
          else
-            mShapeInstance->setDetailFromDistance( state, dist * invScale );
+            mShapeInstance->setDetailFromDistance( state, dist );
                                  
          mShapeInstance->animate();
       }
@@ -2416,7 +2451,7 @@ bool ShapeBase::_prepRenderImage(   SceneState *state,
                if ( forceHighestDetail )
                   image.shapeInstance->setCurrentDetail( 0 );
                else
-                  image.shapeInstance->setDetailFromDistance( state, dist * invScale );
+                  image.shapeInstance->setDetailFromDistance( state, dist );
 
                if (mCloakLevel == 0.0f && image.shapeInstance->hasSolid() && mFadeVal == 1.0f)
                {
@@ -404,6 +404,12 @@ public:
    String cubeDescName;
    ReflectorDesc *reflectorDesc;
 
+   /// How important the shape is when the LOD budget lowers the
+   /// detail of shapes, players should keep their detail longer
+   /// than props.
+   /// @see TSShapeInstance::setLODImportance
+   F32 lodImportance;
+
    /// @name Destruction
    ///
    /// Everyone likes to blow things up!
@@ -949,6 +955,15 @@ protected:
                            bool renderSelf, 
                            bool renderMountedImages );
 
+   /// Returns true if this is the control object or the
+   /// control object is mounted to it, which means the
+   /// shapes always render at the highest detail.
+   bool _isHighestDetailForced();
+
+   /// Returns the scaled distance used to select the
+   /// shape detail.
+   F32 _getDetailDistance( SceneState *state ) const;
+
    /// Renders the shape bounds as well as the 
    /// bounds of all mounted shape images.
    void _renderBoundingBox( ObjectRenderInst *ri, SceneState *state, BaseMatInstance* );
@@ -1540,6 +1555,9 @@ public:
    /// @see SceneObject
    virtual bool prepRenderImage(SceneState* state, const U32 stateKey, const U32 startZone, const bool modifyBaseZoneState);
 
+   /// @see SceneObject
+   virtual void prepAnimation( SceneState *state, TSAnimateBatch *batch );
+
    /// Used from ShapeBase::_prepRenderImage() to submit render 
    /// instances for the main shape or its mounted elements.
    virtual void prepBatchRender( SceneState *state, S32 mountedImageIndex );
@@ -1368,6 +1368,10 @@ void ShapeBase::setImage(  U32 imageSlot,
    image.state = &image.dataBlock->state[0];
    image.skinNameHandle = skinNameHandle;
    image.shapeInstance = new TSShapeInstance(image.dataBlock->shape, isClientObject());
+
+   // Mounted images are as important as the shape they're mounted to.
+   image.shapeInstance->setLODImportance(mDataBlock->lodImportance);
+
    if (isClientObject()) {
       if (image.shapeInstance) {
          image.shapeInstance->cloneMaterialList();
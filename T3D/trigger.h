@@ -104,6 +104,7 @@ class Trigger : public GameBase
                          const U32 stateKey,
                          const U32 startZone,
                          const bool modifyBaseState );
+   bool isPrepRenderImageThreadSafe() const { return true; }
 
    // GameBase
    bool onNewDataBlock(GameBaseData* dptr);
@@ -48,6 +48,8 @@ TSStatic::TSStatic()
 
    mAllowPlayerStep = true;
 
+   mOccluder = false;
+
    mConvexList = new Convex;
 
    mRenderNormalScalar = 0;
@@ -96,6 +98,7 @@ void TSStatic::initPersistFields()
    addGroup("Collision");
    addField( "collisionType",   TypeEnum, Offset( mCollisionType,   TSStatic ), 1, &gCollisionTypeTable );
    addField( "allowPlayerStep", TypeBool, Offset( mAllowPlayerStep, TSStatic ), "Allow a player to collide with this object.");
+   addField( "occluder", TypeBool, Offset( mOccluder, TSStatic ), "Use the collision mesh to hide the objects behind this one.");
    endGroup("Collision");
 
    addGroup("Debug");
@@ -221,6 +224,8 @@ void TSStatic::prepCollision()
    // Let the client know that the collision was updated
    setMaskBits( UpdateCollisionMask );
 
+   clearOccluderMesh();
+
    // Allow the ShapeInstance to prep its collision if it hasn't already
    if ( mShapeInstance )
       mShapeInstance->prepCollision();
@@ -492,6 +497,7 @@ U32 TSStatic::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
       stream->write( (U32)mCollisionType );
 
    stream->writeFlag(mAllowPlayerStep);
+   stream->writeFlag(mOccluder);
 
    stream->write( mRenderNormalScalar );
 
@@ -535,6 +541,7 @@ void TSStatic::unpackUpdate(NetConnection *con, BitStream *stream)
    }
 
    mAllowPlayerStep = stream->readFlag();
+   mOccluder = stream->readFlag();
 
    stream->read( &mRenderNormalScalar );
 
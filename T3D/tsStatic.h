@@ -130,6 +130,10 @@ public:
 
    bool mAllowPlayerStep;
 
+   /// If set the collision mesh is drawn into the software
+   /// occlusion buffer to hide the objects behind it.
+   bool mOccluder;
+
    PhysicsStatic *mPhysicsRep;
 
    F32 mRenderNormalScalar;
@@ -165,6 +169,10 @@ public:
 
    bool allowPlayerStep() const { return mAllowPlayerStep; }
 
+   /// Only real meshes are used as occluders, the bounds
+   /// are larger than the shape itself.
+   bool isOccluder() const { return mOccluder && ( mCollisionType == CollisionMesh || mCollisionType == VisibleMesh ); }
+
    Resource<TSShape> getShape() const { return mShape; }
 	StringTableEntry getShapeFileName() { return mShapeName; }
   
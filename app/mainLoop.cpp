@@ -41,6 +41,9 @@
 
 #include "util/sampler.h"
 #include "platform/threads/threadPool.h"
+#include "core/resourceManager.h"
+#include "ts/tsLastDetail.h"
+#include "ts/tsLODManager.h"
 
 #ifdef TORQUE_ENABLE_VFS
 #include "platform/platformVFS.h"
@@ -209,6 +212,7 @@ void StandardMainLoop::init()
    Con::setVariable( "defaultGame", StringTable->insert("scripts") );
 
    Con::addVariable( "_forceAllMainThread", TypeBool, &ThreadPool::getForceAllMainThread() );
+   Con::addVariable( "$pref::Resource::asyncLoadBudget", TypeS32, &ResourceManager::smAsyncLoadBudget );
 
 #if !defined( _XBOX ) && !defined( TORQUE_DEDICATED )
    initMessageBoxVars();
@@ -252,6 +256,9 @@ void StandardMainLoop::shutdown()
    // Shut down SFX before SIM so that it clears out any audio handles
    SFXSystem::destroy();
 
+   // Drop the background loads while the workers are still around.
+   ResourceManager::get().cancelAsyncLoads();
+
    GFXInit::cleanup();
 
    // Note: tho the SceneGraphs are created after the Manager, delete them after, rather
@@ -545,10 +552,23 @@ bool StandardMainLoop::doMainLoop()
       PROFILE_START(MainLoop);
       Sampler::beginFrame();
 
+      // Apply the shape LOD budget gathered during the last frame.
+      TSLODManager::beginFrame();
+
       if(!Process::processEvents())
          keepRunning = false;
 
       ThreadPool::processMainThreadWorkItems();
+      ResourceManager::get().processAsyncLoads();
+
+      // Upload the streamed texture mips and queue the next ones,
+      // then move the background imposter updates along.
+      if ( GFXDevice::devicePresent() )
+      {
+         TEXMGR->updateStreaming();
+         TSLastDetail::processUpdates();
+      }
+
       Sampler::endFrame();
       PROFILE_END_NAMED(MainLoop);
    }
@@ -22,6 +22,7 @@
 #include "console/stringStack.h"
 #include "util/messaging/message.h"
 #include "core/frameAllocator.h"
+#include "console/scriptProfiler.h"
 
 #ifndef TORQUE_TGB_ONLY
 #include "materials/materialDefinition.h"
@@ -487,9 +488,20 @@ const char *CodeBlock::exec(U32 ip, const char *functionName, Namespace *thisNam
    static S32 VAL_BUFFER_SIZE = 1024;
    FrameTemp<char> valBuffer( VAL_BUFFER_SIZE );
 
+#ifdef TORQUE_ENABLE_PROFILER
+   // The enabled flag is read once per exec() call so the check stays in a
+   // register.  The countdown itself is shared by all exec() calls so that
+   // short functions are sampled at the same rate as long ones.
+   const bool profileLines = ScriptProfiler::isEnabled();
+#endif
+
    for(;;)
    {
       U32 instruction = code[ip++];
+#ifdef TORQUE_ENABLE_PROFILER
+      if( profileLines && --ScriptProfiler::smLineSampleCountdown <= 0 )
+         ScriptProfiler::sampleLine( this, ip - 1 );
+#endif
 breakContinue:
       switch(instruction)
       {
@@ -1531,6 +1543,9 @@ breakContinue:
 
                break;
             }
+
+            SCRIPT_PROFILE_SCOPE( nsEntry );
+
             if(nsEntry->mType == Namespace::Entry::ConsoleFunctionType)
             {
                const char *ret = "";
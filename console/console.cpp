@@ -19,6 +19,7 @@
 #include "console/compiler.h"
 #include "console/stringStack.h"
 #include "console/ICallMethod.h"
+#include "console/scriptProfiler.h"
 #include <stdarg.h>
 #include "platform/threads/mutex.h"
 
@@ -307,6 +308,10 @@ void init()
    Con::addVariable( "Con::File", TypeString, &gCurrentFile );
    Con::addVariable( "Con::Root", TypeString, &gCurrentRoot );
 
+#ifdef TORQUE_ENABLE_PROFILER
+   addVariable( "Con::ScriptProfiler::lineSampleInterval", TypeS32, &ScriptProfiler::smLineSampleInterval );
+#endif
+
    // alwaysUseDebugOutput determines whether to send output to the platform's 
    // "debug" system.  see winConsole for an example.  
    // in ship builds we don't expose this variable to script
@@ -13,6 +13,7 @@
 #include "console/consoleInternal.h"
 #include "core/stream/fileStream.h"
 #include "console/compiler.h"
+#include "console/scriptProfiler.h"
 
 #define ST_INIT_SIZE 15
 
@@ -1078,6 +1079,8 @@ extern S32 executeBlock(StmtNode *block, ExprEvalState *state);
 
 const char *Namespace::Entry::execute(S32 argc, const char **argv, ExprEvalState *state)
 {
+   SCRIPT_PROFILE_SCOPE( this );
+
    if(mType == ConsoleFunctionType)
    {
       if(mFunctionOffset)
@@ -0,0 +1,369 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "console/scriptProfiler.h"
+
+#ifdef TORQUE_ENABLE_PROFILER
+
+#include "console/console.h"
+#include "console/codeBlock.h"
+#include "core/stream/fileStream.h"
+#include "core/tAlgorithm.h"
+
+bool ScriptProfiler::smEnabled = false;
+bool ScriptProfiler::smResetPending = false;
+S32 ScriptProfiler::smLineSampleInterval = 16;
+S32 ScriptProfiler::smLineSampleCountdown = 1;
+
+ScriptProfiler::CallNode *ScriptProfiler::smRoot = NULL;
+DataChunker *ScriptProfiler::smNodeChunker = NULL;
+Vector< ScriptProfiler::Frame > ScriptProfiler::smStack( __FILE__, __LINE__ );
+Map< CompoundKey< StringTableEntry, U32 >, ScriptProfiler::LineStats > ScriptProfiler::smLines;
+
+StringTableEntry ScriptProfiler::smLastSampleFile = NULL;
+U32 ScriptProfiler::smLastSampleLine = 0;
+U64 ScriptProfiler::smLastSampleTime = 0;
+
+//-----------------------------------------------------------------------------
+
+void ScriptProfiler::enable( bool enabled )
+{
+   if( enabled && !smRoot )
+      _reset();
+
+   if( enabled && !smEnabled )
+   {
+      smLastSampleFile = NULL;
+      smLastSampleTime = Platform::getPerformanceCounter();
+   }
+
+   smEnabled = enabled;
+}
+
+void ScriptProfiler::reset()
+{
+   if( smStack.empty() )
+      _reset();
+   else
+      smResetPending = true;
+}
+
+void ScriptProfiler::_reset()
+{
+   AssertFatal( smStack.empty(), "ScriptProfiler::_reset - cannot reset with calls in flight" );
+
+   if( !smNodeChunker )
+      smNodeChunker = new DataChunker;
+   else
+      smNodeChunker->freeBlocks();
+
+   smRoot = ( CallNode* ) smNodeChunker->alloc( sizeof( CallNode ) );
+   dMemset( smRoot, 0, sizeof( CallNode ) );
+
+   smLines.clear();
+   smLastSampleFile = NULL;
+   smLastSampleTime = Platform::getPerformanceCounter();
+   smResetPending = false;
+}
+
+//-----------------------------------------------------------------------------
+
+ScriptProfiler::CallNode* ScriptProfiler::_findOrCreateChild( CallNode *parent, StringTableEntry nsName, StringTableEntry fnName )
+{
+   CallNode *prev = NULL;
+   for( CallNode *walk = parent->mFirstChild; walk; prev = walk, walk = walk->mNextSibling )
+   {
+      if( walk->mFunction == fnName && walk->mNamespace == nsName )
+      {
+         // Move to front; callers tend to invoke the same callees repeatedly.
+         if( prev )
+         {
+            prev->mNextSibling = walk->mNextSibling;
+            walk->mNextSibling = parent->mFirstChild;
+            parent->mFirstChild = walk;
+         }
+         return walk;
+      }
+   }
+
+   CallNode *node = ( CallNode* ) smNodeChunker->alloc( sizeof( CallNode ) );
+   dMemset( node, 0, sizeof( CallNode ) );
+   node->mNamespace = nsName;
+   node->mFunction = fnName;
+   node->mParent = parent;
+   node->mNextSibling = parent->mFirstChild;
+   parent->mFirstChild = node;
+   return node;
+}
+
+void ScriptProfiler::enterFunction( Namespace::Entry *entry )
+{
+   CallNode *parent = smStack.empty() ? smRoot : smStack.last().mNode;
+
+   // Don't let runaway recursion blow up the call tree; such frames are
+   // accounted to their deepest recorded ancestor.
+   if( smStack.size() >= MaxStackDepth )
+   {
+      smStack.increment();
+      smStack.last().mNode = NULL;
+      return;
+   }
+
+   StringTableEntry nsName = entry->mNamespace ? entry->mNamespace->mName : NULL;
+
+   smStack.increment();
+   Frame &frame = smStack.last();
+   frame.mNode = _findOrCreateChild( parent, nsName, entry->mFunctionName );
+   frame.mSubTime = 0;
+   frame.mStartTime = Platform::getPerformanceCounter();
+}
+
+void ScriptProfiler::exitFunction()
+{
+   // Calls entered before a pending reset, or stack frames that were cut off
+   // by an earlier disable, may still arrive here.
+   if( smStack.empty() )
+      return;
+
+   Frame &frame = smStack.last();
+   if( frame.mNode )
+   {
+      const F64 elapsed = F64( Platform::getPerformanceCounter() - frame.mStartTime );
+
+      CallNode *node = frame.mNode;
+      node->mCallCount ++;
+      node->mTotalTime += elapsed;
+      node->mSubTime += frame.mSubTime;
+
+      if( smStack.size() > 1 )
+         smStack[ smStack.size() - 2 ].mSubTime += elapsed;
+   }
+
+   smStack.decrement();
+
+   if( smStack.empty() && smResetPending )
+      _reset();
+}
+
+void ScriptProfiler::sampleLine( CodeBlock *block, U32 ip )
+{
+   smLineSampleCountdown = getMax( smLineSampleInterval, 1 );
+
+   const U64 now = Platform::getPerformanceCounter();
+
+   // Time since the last sample is charged to the line we sampled then.
+   if( smLastSampleFile )
+   {
+      LineStats &stats = smLines[ CompoundKey< StringTableEntry, U32 >( smLastSampleFile, smLastSampleLine ) ];
+      stats.mSampleCount ++;
+      stats.mTime += F64( now - smLastSampleTime );
+   }
+
+   U32 line, instruction;
+   block->findBreakLine( ip, line, instruction );
+
+   smLastSampleFile = block->name ? block->name : StringTable->insert( "<eval>" );
+   smLastSampleLine = line;
+   smLastSampleTime = now;
+}
+
+U32 ScriptProfiler::getNumLineSamples()
+{
+   U32 count = 0;
+   for( Map< CompoundKey< StringTableEntry, U32 >, LineStats >::Iterator iter = smLines.begin(); iter != smLines.end(); ++ iter )
+      count += iter->value.mSampleCount;
+   return count;
+}
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+   struct FunctionStats
+   {
+      StringTableEntry mNamespace;
+      StringTableEntry mFunction;
+      U32 mCallCount;
+      F64 mTotalTime;
+      F64 mSelfTime;
+   };
+
+   struct LineRecord
+   {
+      StringTableEntry mFile;
+      U32 mLine;
+      U32 mSampleCount;
+      F64 mTime;
+   };
+
+   typedef Map< CompoundKey< const void*, const void* >, FunctionStats > FunctionStatsMap;
+
+   void gatherFunctionStats( ScriptProfiler::CallNode *node, FunctionStatsMap &map, Vector< ScriptProfiler::CallNode* > &path )
+   {
+      for( ScriptProfiler::CallNode *walk = node->mFirstChild; walk; walk = walk->mNextSibling )
+      {
+         FunctionStats &stats = map[ CompoundKey< const void*, const void* >( walk->mNamespace, walk->mFunction ) ];
+         stats.mNamespace = walk->mNamespace;
+         stats.mFunction = walk->mFunction;
+         stats.mCallCount += walk->mCallCount;
+         stats.mSelfTime += walk->mTotalTime - walk->mSubTime;
+
+         // Only count inclusive time for the outermost activation of a
+         // recursive function so it isn't counted more than once.
+         bool isRecursion = false;
+         for( U32 i = 0; i < path.size(); i ++ )
+            if( path[ i ]->mFunction == walk->mFunction && path[ i ]->mNamespace == walk->mNamespace )
+            {
+               isRecursion = true;
+               break;
+            }
+         if( !isRecursion )
+            stats.mTotalTime += walk->mTotalTime;
+
+         path.push_back( walk );
+         gatherFunctionStats( walk, map, path );
+         path.pop_back();
+      }
+   }
+
+   S32 QSORT_CALLBACK compareFunctionSelfTime( const void *a, const void *b )
+   {
+      const F64 timeA = ( ( const FunctionStats* ) a )->mSelfTime;
+      const F64 timeB = ( ( const FunctionStats* ) b )->mSelfTime;
+      return timeA < timeB ? 1 : ( timeA > timeB ? -1 : 0 );
+   }
+
+   S32 QSORT_CALLBACK compareLineTime( const void *a, const void *b )
+   {
+      const F64 timeA = ( ( const LineRecord* ) a )->mTime;
+      const F64 timeB = ( ( const LineRecord* ) b )->mTime;
+      return timeA < timeB ? 1 : ( timeA > timeB ? -1 : 0 );
+   }
+
+   String getFunctionName( StringTableEntry nsName, StringTableEntry fnName )
+   {
+      if( nsName )
+         return String::ToString( "%s::%s", nsName, fnName );
+      return String( fnName );
+   }
+}
+
+void ScriptProfiler::dumpToConsole()
+{
+   if( !smRoot )
+   {
+      Con::warnf( "ScriptProfiler::dumpToConsole - no data; use scriptProfilerEnable( true ) first" );
+      return;
+   }
+
+   const F64 ticksToMs = 1000.0 / F64( Platform::getPerformanceCounterFrequency() );
+
+   FunctionStatsMap map;
+   Vector< CallNode* > path;
+   gatherFunctionStats( smRoot, map, path );
+
+   Vector< FunctionStats > functions;
+   for( FunctionStatsMap::Iterator iter = map.begin(); iter != map.end(); ++ iter )
+      functions.push_back( iter->value );
+   dQsort( functions.address(), functions.size(), sizeof( FunctionStats ), compareFunctionSelfTime );
+
+   Con::printf( "Script Profiler Function Dump:" );
+   Con::printf( "  Self ms   Total ms    Calls  Name" );
+   for( U32 i = 0; i < functions.size(); i ++ )
+   {
+      const FunctionStats &stats = functions[ i ];
+      Con::printf( "%9.3f  %9.3f %8d  %s",
+         stats.mSelfTime * ticksToMs,
+         stats.mTotalTime * ticksToMs,
+         stats.mCallCount,
+         getFunctionName( stats.mNamespace, stats.mFunction ).c_str() );
+   }
+
+   Vector< LineRecord > lines;
+   for( Map< CompoundKey< StringTableEntry, U32 >, LineStats >::Iterator iter = smLines.begin(); iter != smLines.end(); ++ iter )
+   {
+      LineRecord record;
+      record.mFile = iter->key.key1;
+      record.mLine = iter->key.key2;
+      record.mSampleCount = iter->value.mSampleCount;
+      record.mTime = iter->value.mTime;
+      lines.push_back( record );
+   }
+   dQsort( lines.address(), lines.size(), sizeof( LineRecord ), compareLineTime );
+
+   Con::printf( "Script Profiler Line Dump (sampled every %d instructions):", smLineSampleInterval );
+   Con::printf( "       ms  Samples  Line" );
+   for( U32 i = 0; i < lines.size(); i ++ )
+      Con::printf( "%9.3f %8d  %s (%d)", lines[ i ].mTime * ticksToMs, lines[ i ].mSampleCount, lines[ i ].mFile, lines[ i ].mLine );
+}
+
+void ScriptProfiler::_writeCollapsed( CallNode *node, const String &path, Stream &stream )
+{
+   const F64 ticksToUs = 1000000.0 / F64( Platform::getPerformanceCounterFrequency() );
+
+   for( CallNode *walk = node->mFirstChild; walk; walk = walk->mNextSibling )
+   {
+      String name = getFunctionName( walk->mNamespace, walk->mFunction );
+      String childPath = path.isEmpty() ? name : path + ";" + name;
+
+      const U32 selfUs = U32( ( walk->mTotalTime - walk->mSubTime ) * ticksToUs );
+      if( selfUs )
+         stream.writeText( String::ToString( "%s %d\n", childPath.c_str(), selfUs ).c_str() );
+
+      _writeCollapsed( walk, childPath, stream );
+   }
+}
+
+bool ScriptProfiler::dumpToFile( const char *fileName )
+{
+   if( !smRoot )
+   {
+      Con::warnf( "ScriptProfiler::dumpToFile - no data; use scriptProfilerEnable( true ) first" );
+      return false;
+   }
+
+   FileStream fws;
+   if( !fws.open( fileName, Torque::FS::File::Write ) )
+   {
+      Con::errorf( "ScriptProfiler::dumpToFile - cannot open '%s' for writing", fileName );
+      return false;
+   }
+
+   _writeCollapsed( smRoot, String(), fws );
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunctionGroupBegin( ScriptProfiler, "Script profiler functionality." );
+
+ConsoleFunction( scriptProfilerEnable, void, 2, 2, "(bool enable) Start or stop recording script function and line times." )
+{
+   TORQUE_UNUSED( argc );
+   ScriptProfiler::enable( dAtob( argv[ 1 ] ) );
+}
+
+ConsoleFunction( scriptProfilerReset, void, 1, 1, "Clear all data gathered by the script profiler." )
+{
+   TORQUE_UNUSED( argc ); TORQUE_UNUSED( argv );
+   ScriptProfiler::reset();
+}
+
+ConsoleFunction( scriptProfilerDump, void, 1, 1, "Print per-function and per-line script profile data to the console." )
+{
+   TORQUE_UNUSED( argc ); TORQUE_UNUSED( argv );
+   ScriptProfiler::dumpToConsole();
+}
+
+ConsoleFunction( scriptProfilerDumpToFile, bool, 2, 2, "(string filename) Write the script call tree as collapsed stacks for flame graph tools." )
+{
+   TORQUE_UNUSED( argc );
+   return ScriptProfiler::dumpToFile( argv[ 1 ] );
+}
+
+ConsoleFunctionGroupEnd( ScriptProfiler );
+
+#endif // TORQUE_ENABLE_PROFILER
@@ -0,0 +1,178 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _SCRIPTPROFILER_H_
+#define _SCRIPTPROFILER_H_
+
+#ifndef _TORQUECONFIG_H_
+#include "torqueConfig.h"
+#endif
+
+#ifdef TORQUE_ENABLE_PROFILER
+
+#ifndef _CONSOLEINTERNAL_H_
+#include "console/consoleInternal.h"
+#endif
+#ifndef _TDICTIONARY_H_
+#include "core/util/tDictionary.h"
+#endif
+#ifndef _DATACHUNKER_H_
+#include "core/dataChunker.h"
+#endif
+
+class Stream;
+class CodeBlock;
+
+/// Profiler for script code running in the console VM.
+///
+/// Where the C++ Profiler only sees the time spent inside the interpreter as
+/// a whole, the ScriptProfiler records inclusive and exclusive time as well
+/// as call counts for every console function and method that is invoked
+/// (scripted or engine-defined) and samples the time spent on individual
+/// script source lines.
+///
+/// @code
+/// scriptProfilerEnable(bool enable);         // start/stop gathering data
+/// scriptProfilerReset();                     // clear all gathered data
+/// scriptProfilerDump();                      // print per-function and per-line stats to the console
+/// scriptProfilerDumpToFile(string filename); // write collapsed call stacks for flame graphs
+/// $Con::ScriptProfiler::lineSampleInterval   // VM instructions between line samples
+/// @endcode
+///
+/// When disabled, the cost to the VM is a test of a local flag per
+/// instruction and of a static flag per call.
+class ScriptProfiler
+{
+public:
+
+   /// A node in the call tree.  Call paths are kept so that the profile can
+   /// be written out as collapsed stacks.
+   struct CallNode
+   {
+      StringTableEntry mNamespace;
+      StringTableEntry mFunction;
+      CallNode *mParent;
+      CallNode *mFirstChild;
+      CallNode *mNextSibling;
+      U32 mCallCount;
+      F64 mTotalTime;
+      F64 mSubTime;
+   };
+
+   /// Sampled time spent on a single source line.
+   struct LineStats
+   {
+      U32 mSampleCount;
+      F64 mTime;
+
+      LineStats() : mSampleCount( 0 ), mTime( 0 ) {}
+   };
+
+protected:
+
+   struct Frame
+   {
+      CallNode *mNode;
+      U64 mStartTime;
+      F64 mSubTime;
+   };
+
+   enum
+   {
+      MaxStackDepth = 1024
+   };
+
+   static bool smEnabled;
+   static bool smResetPending;
+
+   static CallNode *smRoot;
+   static DataChunker *smNodeChunker;
+   static Vector< Frame > smStack;
+   static Map< CompoundKey< StringTableEntry, U32 >, LineStats > smLines;
+
+   static StringTableEntry smLastSampleFile;
+   static U32 smLastSampleLine;
+   static U64 smLastSampleTime;
+
+   static CallNode* _findOrCreateChild( CallNode *parent, StringTableEntry nsName, StringTableEntry fnName );
+   static void _reset();
+   static void _writeCollapsed( CallNode *node, const String &path, Stream &stream );
+
+public:
+
+   /// Number of VM instructions executed between two line samples.  Lower
+   /// values give more accurate line times at a higher profiling cost.
+   static S32 smLineSampleInterval;
+
+   /// Instructions left until the next line sample.  Decremented by the VM.
+   static S32 smLineSampleCountdown;
+
+   /// Return true if script calls are currently being recorded.
+   static bool isEnabled() { return smEnabled; }
+
+   /// Return the root of the call tree or NULL if nothing was recorded yet.
+   /// The root itself stands for no function; top-level calls are its children.
+   static const CallNode* getRoot() { return smRoot; }
+
+   /// Return the total number of line samples taken since the last reset.
+   static U32 getNumLineSamples();
+
+   /// Start or stop recording.  Calls already on the stack when profiling is
+   /// switched on are not recorded.
+   static void enable( bool enabled );
+
+   /// Clear all gathered data.  If called from within script, the reset is
+   /// performed once the script call stack has fully unwound.
+   static void reset();
+
+   /// Called by the VM when a console function is about to be invoked.
+   static void enterFunction( Namespace::Entry *entry );
+
+   /// Called by the VM when the last function passed to enterFunction returns.
+   static void exitFunction();
+
+   /// Called by the VM every smLineSampleInterval instructions.  Resets
+   /// smLineSampleCountdown.
+   static void sampleLine( CodeBlock *block, U32 ip );
+
+   /// Print per-function and per-line statistics to the console.
+   static void dumpToConsole();
+
+   /// Write the call tree in collapsed stack format ("a;b;c <microseconds>"
+   /// per line) as used by flame graph tools.
+   static bool dumpToFile( const char *fileName );
+};
+
+/// Records the enclosed console call with the ScriptProfiler if profiling
+/// was enabled on entry to the scope.
+class ScriptProfilerScope
+{
+   bool mActive;
+
+public:
+
+   ScriptProfilerScope( Namespace::Entry *entry )
+      : mActive( ScriptProfiler::isEnabled() )
+   {
+      if( mActive )
+         ScriptProfiler::enterFunction( entry );
+   }
+
+   ~ScriptProfilerScope()
+   {
+      if( mActive )
+         ScriptProfiler::exitFunction();
+   }
+};
+
+#define SCRIPT_PROFILE_SCOPE( entry ) ScriptProfilerScope scriptProfilerScopeObj( entry )
+
+#else
+
+#define SCRIPT_PROFILE_SCOPE( entry )
+
+#endif // TORQUE_ENABLE_PROFILER
+
+#endif // _SCRIPTPROFILER_H_
@@ -130,6 +130,10 @@ namespace Sim
    {
       return postEvent(findObject(objectName), evt, targetTime);
    }
+   /// Post count events which all fire at targetTime, taking the queue lock
+   /// once.  The ids of the events are stored in outSequences if given.
+   void postEvents(U32 count, SimObject *const *destObjects, SimEvent *const *events, SimTime targetTime, U32 *outSequences = NULL);
+
    inline U32 postCurrentEvent(SimObject*obj, SimEvent*evt)
    {
       return postEvent(obj,evt,getCurrentTime());
@@ -157,6 +161,15 @@ namespace Sim
 
    bool saveObject(SimObject *obj, const char *filename);
    SimObject *loadObjectStream(const char *filename);
+
+   /// Write root and, if it is a SimGroup, everything it contains to a
+   /// binary snapshot.  Common value fields are stored in native form.
+   bool saveSnapshot(SimObject *root, const char *filename);
+
+   /// Load a snapshot written by saveSnapshot() without going through the
+   /// script compiler.  The root is added to parent, or the RootGroup if
+   /// parent is NULL.
+   SimObject *loadSnapshot(const char *filename, SimGroup *parent = NULL);
 }
 
 //----------------------------------------------------------------------------
@@ -6,11 +6,433 @@
 #include "console/console.h"
 #include "console/consoleInternal.h"
 #include "platform/threads/semaphore.h"
+#include "platform/threads/mutex.h"
+#include "core/dataChunker.h"
 #include "console/simEvents.h"
 
 // Stupid globals not declared in a header
 extern ExprEvalState gEvalState;
 
+//-----------------------------------------------------------------------------
+// SimEvent pools
+//-----------------------------------------------------------------------------
+
+namespace
+{
+   enum
+   {
+      NumEventSizeClasses = 4,
+      SmallestEventSizeClass = 64,
+   };
+
+   /// Free lists for blocks of 64, 128, 256 and 512 bytes.  Events can be
+   /// posted from any thread, so the lists are guarded by a mutex.
+   struct SimEventPools
+   {
+      FreeListChunkerUntyped *mChunkers[NumEventSizeClasses];
+      Mutex mMutex;
+
+      SimEventPools()
+      {
+         for(U32 i = 0; i < NumEventSizeClasses; i++)
+            mChunkers[i] = new FreeListChunkerUntyped(SmallestEventSizeClass << i);
+      }
+
+      ~SimEventPools()
+      {
+         for(U32 i = 0; i < NumEventSizeClasses; i++)
+            delete mChunkers[i];
+      }
+   };
+
+   SimEventPools& getEventPools()
+   {
+      static SimEventPools sPools;
+      return sPools;
+   }
+
+   S32 getEventSizeClass(dsize_t size)
+   {
+      for(S32 i = 0; i < NumEventSizeClasses; i++)
+      {
+         if(size <= dsize_t(SmallestEventSizeClass << i))
+            return i;
+      }
+
+      return -1;
+   }
+}
+
+void* SimEvent::allocPooled(dsize_t size)
+{
+   S32 sizeClass = getEventSizeClass(size);
+   if(sizeClass < 0)
+      return dMalloc(size);
+
+   SimEventPools &pools = getEventPools();
+   pools.mMutex.lock();
+   void *ptr = pools.mChunkers[sizeClass]->alloc();
+   pools.mMutex.unlock();
+
+   return ptr;
+}
+
+void SimEvent::freePooled(void *ptr, dsize_t size)
+{
+   if(!ptr)
+      return;
+
+   S32 sizeClass = getEventSizeClass(size);
+   if(sizeClass < 0)
+   {
+      dFree(ptr);
+      return;
+   }
+
+   SimEventPools &pools = getEventPools();
+   pools.mMutex.lock();
+   pools.mChunkers[sizeClass]->free(ptr);
+   pools.mMutex.unlock();
+}
+
+#include "platform/tmm_off.h"
+
+void* SimEvent::operator new(size_t size)
+{
+   return allocPooled(size);
+}
+
+void SimEvent::operator delete(void *ptr, size_t size)
+{
+   freePooled(ptr, size);
+}
+
+void SimEvent::operator delete(void *ptr, const char*, const U32)
+{
+   // The size isn't passed here.  Every block allocPooled() hands out is at
+   // least as large as the smallest size class, so recycling it there is safe.
+   freePooled(ptr, SmallestEventSizeClass);
+}
+
+#include "platform/tmm_on.h"
+
+//-----------------------------------------------------------------------------
+// SimEventWheel
+//-----------------------------------------------------------------------------
+
+SimEventWheel::SimEventWheel()
+   : mCurrentTime(0),
+     mNumEvents(0)
+{
+   dMemset(mSlots, 0, sizeof(mSlots));
+   dMemset(mOccupied, 0, sizeof(mOccupied));
+
+   VECTOR_SET_ASSOCIATION(mIdTable);
+   mIdTable.setSize(256);
+   dMemset(mIdTable.address(), 0, mIdTable.size() * sizeof(SimEvent*));
+}
+
+SimEventWheel::~SimEventWheel()
+{
+   reset(0);
+}
+
+void SimEventWheel::reset(SimTime time)
+{
+   for(U32 level = 0; level < NumLevels; level++)
+   {
+      for(U32 index = 0; index < NumSlots; index++)
+      {
+         SimEvent *walk = mSlots[level][index].head;
+         while(walk)
+         {
+            SimEvent *temp = walk->nextEvent;
+            delete walk;
+            walk = temp;
+         }
+      }
+   }
+
+   dMemset(mSlots, 0, sizeof(mSlots));
+   dMemset(mOccupied, 0, sizeof(mOccupied));
+   dMemset(mIdTable.address(), 0, mIdTable.size() * sizeof(SimEvent*));
+
+   mCurrentTime = time;
+   mNumEvents = 0;
+}
+
+SimEventWheel::Slot& SimEventWheel::getSlot(SimTime time, U32 &outLevel, U32 &outIndex)
+{
+   if(time < mCurrentTime)
+      time = mCurrentTime;
+
+   // An event lives on the lowest level whose window it shares with the
+   // current time, so it only moves down a level when that window opens.
+   U32 diff = time ^ mCurrentTime;
+   U32 level = 0;
+   while(level < NumLevels - 1 && (diff >> (SlotBits * (level + 1))) != 0)
+      level++;
+
+   outLevel = level;
+   outIndex = (time >> (SlotBits * level)) & SlotMask;
+   return mSlots[level][outIndex];
+}
+
+void SimEventWheel::link(SimEvent *event, U32 level, U32 index)
+{
+   Slot &slot = mSlots[level][index];
+
+   // Append to keep events due at the same time in posting order.
+   event->nextEvent = NULL;
+   event->prevEvent = slot.tail;
+   if(slot.tail)
+      slot.tail->nextEvent = event;
+   else
+      slot.head = event;
+   slot.tail = event;
+
+   mOccupied[level][index >> 5] |= BIT(index & 31);
+}
+
+void SimEventWheel::unlink(SimEvent *event)
+{
+   U32 level, index;
+   Slot &slot = getSlot(event->time, level, index);
+
+   if(event->prevEvent)
+      event->prevEvent->nextEvent = event->nextEvent;
+   else
+      slot.head = event->nextEvent;
+
+   if(event->nextEvent)
+      event->nextEvent->prevEvent = event->prevEvent;
+   else
+      slot.tail = event->prevEvent;
+
+   if(!slot.head)
+      mOccupied[level][index >> 5] &= ~BIT(index & 31);
+
+   event->nextEvent = event->prevEvent = NULL;
+}
+
+void SimEventWheel::insert(SimEvent *event)
+{
+   if(event->time < mCurrentTime)
+      event->time = mCurrentTime;
+
+   U32 level, index;
+   getSlot(event->time, level, index);
+   link(event, level, index);
+   addId(event);
+   mNumEvents++;
+}
+
+void SimEventWheel::insert(SimEvent *const *events, U32 count, SimTime time)
+{
+   if(time < mCurrentTime)
+      time = mCurrentTime;
+
+   U32 level, index;
+   getSlot(time, level, index);
+
+   for(U32 i = 0; i < count; i++)
+   {
+      events[i]->time = time;
+      link(events[i], level, index);
+      addId(events[i]);
+      mNumEvents++;
+   }
+}
+
+void SimEventWheel::remove(SimEvent *event)
+{
+   unlink(event);
+   removeId(event);
+   mNumEvents--;
+}
+
+void SimEventWheel::removeObjectEvents(SimObject *object, Vector<SimEvent*> &outEvents)
+{
+   if(!mNumEvents)
+      return;
+
+   for(U32 i = 0; i < mIdTable.size(); )
+   {
+      SimEvent *event = mIdTable[i];
+      if(event && event->destObject == object)
+      {
+         // Removal can shift a later entry into this bucket, so look at
+         // it again before moving on.
+         remove(event);
+         outEvents.push_back(event);
+      }
+      else
+         i++;
+   }
+}
+
+void SimEventWheel::cascade()
+{
+   // Called whenever the current time enters a new level 0 window.  Each
+   // higher level whose window also just opened hands its slot down.
+   for(U32 level = 1; level < NumLevels; level++)
+   {
+      U32 index = (mCurrentTime >> (SlotBits * level)) & SlotMask;
+      Slot &slot = mSlots[level][index];
+
+      SimEvent *walk = slot.head;
+      slot.head = slot.tail = NULL;
+      mOccupied[level][index >> 5] &= ~BIT(index & 31);
+
+      while(walk)
+      {
+         SimEvent *next = walk->nextEvent;
+
+         U32 newLevel, newIndex;
+         getSlot(walk->time, newLevel, newIndex);
+         link(walk, newLevel, newIndex);
+
+         walk = next;
+      }
+
+      if(index != 0)
+         break;
+   }
+}
+
+SimEvent* SimEventWheel::popDue(SimTime targetTime)
+{
+   for(;;)
+   {
+      U32 index = mCurrentTime & SlotMask;
+      SimEvent *event = mSlots[0][index].head;
+      if(event)
+      {
+         remove(event);
+         return event;
+      }
+
+      if(mCurrentTime >= targetTime)
+         return NULL;
+
+      if(!mNumEvents)
+      {
+         mCurrentTime = targetTime;
+         return NULL;
+      }
+
+      // Skip to the next occupied slot of this window, if there is one.
+      U32 next = index + 1;
+      while(next < NumSlots)
+      {
+         U32 bits = mOccupied[0][next >> 5] >> (next & 31);
+         if(bits)
+         {
+            while(!(bits & 1))
+            {
+               bits >>= 1;
+               next++;
+            }
+            break;
+         }
+
+         next = (next | 31) + 1;
+      }
+
+      if(next < NumSlots)
+      {
+         mCurrentTime = getMin((mCurrentTime & ~SimTime(SlotMask)) + next, targetTime);
+         continue;
+      }
+
+      // Otherwise move into the next window and pull its events down.
+      SimTime windowEnd = mCurrentTime | SlotMask;
+      if(windowEnd >= targetTime || windowEnd == 0xFFFFFFFF)
+      {
+         mCurrentTime = targetTime;
+         return NULL;
+      }
+
+      mCurrentTime = windowEnd + 1;
+      cascade();
+   }
+}
+
+SimEvent* SimEventWheel::find(U32 sequenceCount) const
+{
+   const U32 mask = mIdTable.size() - 1;
+   for(U32 i = sequenceCount & mask; mIdTable[i]; i = (i + 1) & mask)
+   {
+      if(mIdTable[i]->sequenceCount == sequenceCount)
+         return mIdTable[i];
+   }
+
+   return NULL;
+}
+
+void SimEventWheel::addId(SimEvent *event)
+{
+   // Keep the table at most half full so probe runs stay short.
+   if((mNumEvents + 1) * 2 > mIdTable.size())
+      growIdTable();
+
+   const U32 mask = mIdTable.size() - 1;
+   U32 i = event->sequenceCount & mask;
+   while(mIdTable[i])
+      i = (i + 1) & mask;
+
+   mIdTable[i] = event;
+}
+
+void SimEventWheel::removeId(SimEvent *event)
+{
+   const U32 mask = mIdTable.size() - 1;
+   U32 i = event->sequenceCount & mask;
+   while(mIdTable[i] != event)
+   {
+      AssertFatal(mIdTable[i], "SimEventWheel::removeId - event is not in the table.");
+      i = (i + 1) & mask;
+   }
+
+   // Backward shift deletion: pull later entries of the probe run into
+   // the hole so lookups never need tombstones.
+   U32 hole = i;
+   for(U32 j = (i + 1) & mask; mIdTable[j]; j = (j + 1) & mask)
+   {
+      U32 home = mIdTable[j]->sequenceCount & mask;
+      if(((j - home) & mask) >= ((j - hole) & mask))
+      {
+         mIdTable[hole] = mIdTable[j];
+         hole = j;
+      }
+   }
+
+   mIdTable[hole] = NULL;
+}
+
+void SimEventWheel::growIdTable()
+{
+   Vector<SimEvent*> oldTable(mIdTable);
+
+   mIdTable.setSize(oldTable.size() * 2);
+   dMemset(mIdTable.address(), 0, mIdTable.size() * sizeof(SimEvent*));
+
+   const U32 mask = mIdTable.size() - 1;
+   for(U32 i = 0; i < oldTable.size(); i++)
+   {
+      if(!oldTable[i])
+         continue;
+
+      U32 j = oldTable[i]->sequenceCount & mask;
+      while(mIdTable[j])
+         j = (j + 1) & mask;
+
+      mIdTable[j] = oldTable[i];
+   }
+}
+
+//-----------------------------------------------------------------------------
+
 SimConsoleEvent::SimConsoleEvent(S32 argc, const char **argv, bool onObject)
 {
    mOnObject = onObject;
@@ -21,7 +443,10 @@ SimConsoleEvent::SimConsoleEvent(S32 argc, const char **argv, bool onObject)
       totalSize += dStrlen(argv[i]) + 1;
    totalSize += sizeof(char *) * argc;
 
-   mArgv = (char **) dMalloc(totalSize);
+   // Most schedule() calls have a handful of short arguments, which fit
+   // the event pools.
+   mArgvSize = totalSize;
+   mArgv = (char **) allocPooled(totalSize);
    char *argBase = (char *) &mArgv[argc];
 
    for(i = 0; i < argc; i++)
@@ -34,7 +459,7 @@ SimConsoleEvent::SimConsoleEvent(S32 argc, const char **argv, bool onObject)
 
 SimConsoleEvent::~SimConsoleEvent()
 {
-   dFree(mArgv);
+   freePooled(mArgv, mArgvSize);
 }
 
 void SimConsoleEvent::process(SimObject* object)
@@ -8,6 +8,12 @@
 #ifndef _SIMEVENTS_H_
 #define _SIMEVENTS_H_
 
+#ifndef _TVECTOR_H_
+#include "core/util/tVector.h"
+#endif
+
+#include "platform/tmm_off.h"
+
 // Forward Refs
 class SimObject;
 class Semaphore;
@@ -28,10 +34,14 @@ class Semaphore;
 ///     - The schedule() console function uses a subclass of
 ///       SimEvent called SimConsoleEvent to keep track of
 ///       scheduled events.
+///
+/// Events are allocated from size-classed free lists, so posting an event
+/// does not normally hit the system allocator.
 class SimEvent
 {
 public:
    SimEvent *nextEvent;     ///< Linked list details - pointer to next item in the list.
+   SimEvent *prevEvent;     ///< Linked list details - pointer to previous item in the list.
    SimTime startTime;       ///< When the event was posted.
    SimTime time;            ///< When the event is scheduled to occur.
    U32 sequenceCount;       ///< Unique ID. These are assigned sequentially based on order
@@ -57,6 +67,108 @@ public:
    ///
    /// @param   object  Object stored in destObject.
    virtual void process(SimObject *object)=0;
+
+   /// @name Pooled Allocation
+   /// @{
+
+   static void* operator new(size_t size);
+   static void* operator new(size_t size, const char*, const U32) { return operator new(size); }
+   static void operator delete(void *ptr, size_t size);
+
+   /// Matches the placement new above; only called if a constructor throws.
+   static void operator delete(void *ptr, const char*, const U32);
+
+   /// Allocate a block from the event pools.  Blocks larger than the
+   /// biggest size class come from the heap.
+   static void* allocPooled(dsize_t size);
+
+   /// Free a block from allocPooled().  Size must match the allocation.
+   static void freePooled(void *ptr, dsize_t size);
+
+   /// @}
+};
+
+/// Hierarchical timing wheel holding the pending events of the Sim.
+///
+/// Four levels of 256 one millisecond slots cover the full range of
+/// SimTime.  Posting, cancelling and looking up an event by its sequence
+/// number are constant time; events due at the same time are dispatched
+/// in the order they were posted.
+///
+/// The wheel is not thread safe; Sim guards it with its event queue mutex.
+class SimEventWheel
+{
+public:
+   enum
+   {
+      NumLevels = 4,
+      SlotBits = 8,
+      NumSlots = 1 << SlotBits,
+      SlotMask = NumSlots - 1,
+   };
+
+   SimEventWheel();
+   ~SimEventWheel();
+
+   /// Delete all pending events and restart the wheel at the given time.
+   void reset(SimTime time);
+
+   /// Current time of the wheel; no pending event is due before it.
+   SimTime getCurrentTime() const { return mCurrentTime; }
+
+   /// Number of pending events.
+   U32 size() const { return mNumEvents; }
+
+   /// Insert an event.  The event's time and sequenceCount must be set;
+   /// times in the past are treated as due now.
+   void insert(SimEvent *event);
+
+   /// Insert count events which all fire at the given time.  The slot is
+   /// resolved once for the whole batch.
+   void insert(SimEvent *const *events, U32 count, SimTime time);
+
+   /// Look up a pending event by sequence number.
+   SimEvent* find(U32 sequenceCount) const;
+
+   /// Unlink a pending event.  The caller owns it afterwards.
+   void remove(SimEvent *event);
+
+   /// Unlink every pending event destined for the object and append them
+   /// to outEvents.
+   void removeObjectEvents(SimObject *object, Vector<SimEvent*> &outEvents);
+
+   /// Unlink and return the next event due at or before targetTime,
+   /// advancing the wheel to its time.  Returns NULL, with the wheel at
+   /// targetTime, once nothing more is due.
+   SimEvent* popDue(SimTime targetTime);
+
+protected:
+
+   struct Slot
+   {
+      SimEvent *head;
+      SimEvent *tail;
+   };
+
+   Slot mSlots[NumLevels][NumSlots];
+
+   /// One bit per non-empty slot, used to skip idle stretches of level 0.
+   U32 mOccupied[NumLevels][NumSlots / 32];
+
+   SimTime mCurrentTime;
+   U32 mNumEvents;
+
+   /// Open addressed table of pending events keyed on sequenceCount.
+   Vector<SimEvent*> mIdTable;
+
+   Slot& getSlot(SimTime time, U32 &outLevel, U32 &outIndex);
+   void link(SimEvent *event, U32 level, U32 index);
+   void unlink(SimEvent *event);
+   void cascade();
+
+   void addId(SimEvent *event);
+   void removeId(SimEvent *event);
+   void growIdTable();
 };
 
 /// Implementation of schedule() function.
@@ -68,6 +180,7 @@ class SimConsoleEvent : public SimEvent
 protected:
    S32 mArgc;
    char **mArgv;
+   U32 mArgvSize;
    bool mOnObject;
 public:
 
@@ -113,4 +226,6 @@ public:
    virtual void process(SimObject *object);
 };
 
+#include "platform/tmm_on.h"
+
 #endif // _SIMEVENTS_H_
@@ -38,7 +38,7 @@ SimTime gCurrentTime;
 SimTime gTargetTime;
 
 void *gEventQueueMutex;
-SimEvent *gEventQueue;
+SimEventWheel *gEventQueue;
 U32 gEventSequence;
 
 //---------------------------------------------------------------------------
@@ -49,7 +49,7 @@ static void initEventQueue()
    gCurrentTime = 0;
    gTargetTime = 0;
    gEventSequence = 1;
-   gEventQueue = NULL;
+   gEventQueue = new SimEventWheel;
    gEventQueueMutex = Mutex::createMutex();
 }
 
@@ -57,17 +57,22 @@ static void shutdownEventQueue()
 {
    // Delete all pending events
    Mutex::lockMutex(gEventQueueMutex);
-   SimEvent *walk = gEventQueue;
-   while(walk)
-   {
-      SimEvent *temp = walk->nextEvent;
-      delete walk;
-      walk = temp;
-   }
+   SAFE_DELETE(gEventQueue);
    Mutex::unlockMutex(gEventQueueMutex);
    Mutex::destroyMutex(gEventQueueMutex);
 }
 
+static inline U32 nextEventSequence()
+{
+   U32 seq = gEventSequence++;
+
+   // Zero is InvalidEventId.
+   if(gEventSequence == 0)
+      gEventSequence = 1;
+
+   return seq;
+}
+
 //---------------------------------------------------------------------------
 // event post
 
@@ -94,20 +99,11 @@ U32 postEvent(SimObject *destObject, SimEvent* event,U32 time)
 
       return InvalidEventId;
    }
-   event->sequenceCount = gEventSequence++;
-   SimEvent **walk = &gEventQueue;
-   SimEvent *current;
-   
-   while((current = *walk) != NULL && (current->time < event->time))
-      walk = &(current->nextEvent);
-   
-   // [tom, 6/24/2005] This ensures that SimEvents are dispatched in the same order that they are posted.
+   event->sequenceCount = nextEventSequence();
+
+   // The wheel keeps events due at the same time in posting order.
    // This is needed to ensure Con::threadSafeExecute() executes script code in the correct order.
-   while((current = *walk) != NULL && (current->time == event->time))
-      walk = &(current->nextEvent);
-   
-   event->nextEvent = current;
-   *walk = event;
+   gEventQueue->insert(event);
 
    U32 seqCount = event->sequenceCount;
 
@@ -116,6 +112,30 @@ U32 postEvent(SimObject *destObject, SimEvent* event,U32 time)
    return seqCount;
 }
 
+void postEvents(U32 count, SimObject *const *destObjects, SimEvent *const *events, SimTime time, U32 *outSequences)
+{
+   AssertFatal(time >= getCurrentTime(), "Sim::postEvents: Cannot go back in time.");
+
+   Mutex::lockMutex(gEventQueueMutex);
+
+   for(U32 i = 0; i < count; i++)
+   {
+      AssertFatal(destObjects[i], "Destination object for event doesn't exist.");
+
+      SimEvent *event = events[i];
+      event->startTime = gCurrentTime;
+      event->destObject = destObjects[i];
+      event->sequenceCount = nextEventSequence();
+
+      if(outSequences)
+         outSequences[i] = event->sequenceCount;
+   }
+
+   gEventQueue->insert(events, count, time);
+
+   Mutex::unlockMutex(gEventQueueMutex);
+}
+
 //---------------------------------------------------------------------------
 // event cancellation
 
@@ -123,20 +143,11 @@ void cancelEvent(U32 eventSequence)
 {
    Mutex::lockMutex(gEventQueueMutex);
 
-   SimEvent **walk = &gEventQueue;
-   SimEvent *current;
-   
-   while((current = *walk) != NULL)
+   SimEvent *event = gEventQueue->find(eventSequence);
+   if(event)
    {
-      if(current->sequenceCount == eventSequence)
-      {
-         *walk = current->nextEvent;
-         delete current;
-         Mutex::unlockMutex(gEventQueueMutex);
-         return;
-      }
-      else
-         walk = &(current->nextEvent);
+      gEventQueue->remove(event);
+      delete event;
    }
 
    Mutex::unlockMutex(gEventQueueMutex);
@@ -146,19 +157,15 @@ static void cancelPendingEvents(SimObject *obj)
 {
    Mutex::lockMutex(gEventQueueMutex);
 
-   SimEvent **walk = &gEventQueue;
-   SimEvent *current;
-   
-   while((current = *walk) != NULL)
+   if(gEventQueue->size())
    {
-      if(current->destObject == obj)
-      {
-         *walk = current->nextEvent;
-         delete current;
-      }
-      else
-         walk = &(current->nextEvent);
+      Vector<SimEvent*> events;
+      gEventQueue->removeObjectEvents(obj, events);
+
+      for(U32 i = 0; i < events.size(); i++)
+         delete events[i];
    }
+
    Mutex::unlockMutex(gEventQueueMutex);
 }
 
@@ -168,48 +175,52 @@ static void cancelPendingEvents(SimObject *obj)
 bool isEventPending(U32 eventSequence)
 {
    Mutex::lockMutex(gEventQueueMutex);
-
-   for(SimEvent *walk = gEventQueue; walk; walk = walk->nextEvent)
-      if(walk->sequenceCount == eventSequence)
-      {
-         Mutex::unlockMutex(gEventQueueMutex);
-         return true;
-      }
+   bool pending = gEventQueue->find(eventSequence) != NULL;
    Mutex::unlockMutex(gEventQueueMutex);
-   return false;
+
+   return pending;
 }
 
 U32 getEventTimeLeft(U32 eventSequence)
 {
    Mutex::lockMutex(gEventQueueMutex);
 
-   for(SimEvent *walk = gEventQueue; walk; walk = walk->nextEvent)
-      if(walk->sequenceCount == eventSequence)
-      {
-         SimTime t = walk->time - getCurrentTime();
-         Mutex::unlockMutex(gEventQueueMutex);
-         return t;
-      }
+   SimTime t = 0;
+   SimEvent *event = gEventQueue->find(eventSequence);
+   if(event)
+      t = event->time - gCurrentTime;
 
    Mutex::unlockMutex(gEventQueueMutex);
 
-   return 0;   
+   return t;
 }
 
 U32 getScheduleDuration(U32 eventSequence)
 {
-   for(SimEvent *walk = gEventQueue; walk; walk = walk->nextEvent)
-      if(walk->sequenceCount == eventSequence)
-         return (walk->time-walk->startTime);
-   return 0;
+   Mutex::lockMutex(gEventQueueMutex);
+
+   SimTime t = 0;
+   SimEvent *event = gEventQueue->find(eventSequence);
+   if(event)
+      t = event->time - event->startTime;
+
+   Mutex::unlockMutex(gEventQueueMutex);
+
+   return t;
 }
 
 U32 getTimeSinceStart(U32 eventSequence)
 {
-   for(SimEvent *walk = gEventQueue; walk; walk = walk->nextEvent)
-      if(walk->sequenceCount == eventSequence)
-         return (getCurrentTime()-walk->startTime);
-   return 0;
+   Mutex::lockMutex(gEventQueueMutex);
+
+   SimTime t = 0;
+   SimEvent *event = gEventQueue->find(eventSequence);
+   if(event)
+      t = gCurrentTime - event->startTime;
+
+   Mutex::unlockMutex(gEventQueueMutex);
+
+   return t;
 }
 
 //---------------------------------------------------------------------------
@@ -221,10 +232,10 @@ void advanceToTime(SimTime targetTime)
 
    Mutex::lockMutex(gEventQueueMutex);
    gTargetTime = targetTime;
-   while(gEventQueue && gEventQueue->time <= targetTime)
+
+   SimEvent *event;
+   while((event = gEventQueue->popDue(targetTime)) != NULL)
    {
-      SimEvent *event = gEventQueue;
-      gEventQueue = gEventQueue->nextEvent;
       AssertFatal(event->time >= gCurrentTime,
 			"SimEventQueue::pop: Cannot go back in time (flux capacitor not installed - BJG).");
       gCurrentTime = event->time;
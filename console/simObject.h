@@ -473,6 +473,17 @@ public:
    virtual void onStaticModified(const char* slotName, const char*newValue = NULL); ///< Called when a static field is modified.
    virtual void onDynamicModified(const char* slotName, const char*newValue = NULL); ///< Called when a dynamic field is modified.
 
+   /// Returns true if prepareAdd() may be called from a worker thread.
+   ///
+   /// Bulk loaders such as Sim::loadSnapshot() call prepareAdd() on a
+   /// thread pool for objects that return true here.
+   virtual bool isPrepareAddThreadSafe() const { return false; }
+
+   /// Called after the fields are set but before the object is registered,
+   /// to do work onAdd() would otherwise do.  Must not touch the Sim
+   /// dictionaries or any other shared state.
+   virtual void prepareAdd() {}
+
    /// Called before any property of the object is changed in the world editor.
    ///
    /// The calling order here is:
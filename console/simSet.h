@@ -126,6 +126,9 @@ public:
 
    virtual void popObject();                ///< Remove an object from the end of the list.
 
+   /// Preallocate room for count objects.
+   void reserve(U32 count) { objectList.reserve(count); }
+
    void bringObjectToFront(SimObject* obj) { reOrder(obj, front()); }
    void pushObjectToBack(SimObject* obj) { reOrder(obj, NULL); }
 
@@ -0,0 +1,1014 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "console/simBase.h"
+
+#include "console/consoleTypes.h"
+#include "core/stream/fileStream.h"
+#include "core/util/endian.h"
+#include "core/util/tDictionary.h"
+#include "core/volume.h"
+#include "platform/threads/threadPool.h"
+#include "platform/threads/threadSafeRefCount.h"
+#include "platform/threads/semaphore.h"
+#include "platform/platformIntrinsics.h"
+
+// A snapshot is a binary image of a SimGroup hierarchy that can be loaded
+// without going through the script compiler.  Static fields of the common
+// value types are stored in their native in-memory form and copied
+// straight into the new objects; everything else is stored as text and
+// applied through setDataField() as the script loader would.
+//
+// File layout, all words little endian:
+//
+//    U32   tag ('SNP1')
+//    U32   version
+//    U32   native marker (SnapshotNativeMarker in host byte order)
+//    U32   string count, class count, object count
+//    string count * { U32 length, chars, NUL }
+//    class count * { U32 name, U32 field count,
+//                    field count * { U32 name, U32 type name, U32 encoding, U32 element size } }
+//    object count * { U32 class, S32 parent, U32 name, U32 static count, U32 static bytes,
+//                     U32 dynamic count, static block, dynamic count * { U32 slot, U32 value } }
+//
+// A static block entry is a U16 field index and a U16 element index
+// followed by either the raw field memory padded to four bytes or a U32
+// string index.  Objects are stored in pre-order so a parent always
+// precedes its children.
+//
+// Raw field memory is written in host byte order; the native marker lets
+// the loader reject snapshots written on a machine of the other endianness.
+
+static const U32 SnapshotTag = makeFourCCTag( 'S', 'N', 'P', '1' );
+static const U32 SnapshotVersion = 1;
+static const U32 SnapshotNativeMarker = 0x01020304;
+static const U32 SnapshotNoString = 0xFFFFFFFF;
+
+enum SnapshotEncoding
+{
+   SnapshotRaw,         ///< Native memory copied as is.
+   SnapshotString,      ///< StringTableEntry, case insensitive.
+   SnapshotCaseString,  ///< StringTableEntry, case sensitive.
+   SnapshotText,        ///< Applied through setDataField().
+   SnapshotEncodingCount
+};
+
+enum
+{
+   SnapshotHeaderWords = 6,
+   SnapshotObjectWords = 6,
+
+   /// Objects handed to each thread pool work item.
+   SnapshotChunkSize = 256,
+};
+
+/// Console types whose in-memory form is plain data and can be copied
+/// between objects without going through the type's setData().
+static const char *sSnapshotRawTypes[] =
+{
+   "TypeBool", "TypeS8", "TypeS32", "TypeBitMask32", "TypeF32",
+   "TypeEnum", "TypeModifiedEnum", "TypeColorI", "TypeColorF",
+   "TypePoint2I", "TypePoint2F", "TypePoint3F", "TypePoint4F",
+   "TypeRectI", "TypeRectF", "TypeMatrixPosition", "TypeMatrixRotation",
+   "TypeBox3F",
+};
+
+static U32 getSnapshotEncoding( const AbstractClassRep::Field &field )
+{
+   // Fields with a protected setter or a validator have side effects
+   // that only setDataField() will run.
+   if ( field.setDataFn != &defaultProtectedSetFn || field.validator )
+      return SnapshotText;
+
+   const char *typeName = ConsoleBaseType::getType( field.type )->getTypeName();
+
+   if ( dStrcmp( typeName, "TypeString" ) == 0 || dStrcmp( typeName, "TypeFilename" ) == 0 )
+      return SnapshotString;
+   if ( dStrcmp( typeName, "TypeCaseString" ) == 0 )
+      return SnapshotCaseString;
+
+   for ( U32 i = 0; i < sizeof( sSnapshotRawTypes ) / sizeof( sSnapshotRawTypes[0] ); i++ )
+   {
+      if ( dStrcmp( typeName, sSnapshotRawTypes[i] ) == 0 )
+         return SnapshotRaw;
+   }
+
+   return SnapshotText;
+}
+
+static inline void appendSnapshotWord( Vector<U8> &buffer, U32 value )
+{
+   value = convertHostToLEndian( value );
+
+   const U32 pos = buffer.size();
+   buffer.setSize( pos + sizeof( U32 ) );
+   dMemcpy( buffer.address() + pos, &value, sizeof( U32 ) );
+}
+
+static inline U32 readSnapshotWord( const U8 *ptr )
+{
+   U32 value;
+   dMemcpy( &value, ptr, sizeof( U32 ) );
+   return convertLEndianToHost( value );
+}
+
+//-----------------------------------------------------------------------------
+// Saving
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+struct SnapshotClass
+{
+   AbstractClassRep *rep;
+
+   /// Indices into rep->mFieldList of the fields that are saved.
+   Vector<U32> fields;
+   Vector<U32> encodings;
+};
+
+class SnapshotWriter
+{
+public:
+
+   SnapshotWriter();
+
+   bool write( SimObject *root, Stream &stream );
+
+protected:
+
+   Vector<const char*> mStrings;
+   Map<const char*, U32> mStringIndex;
+
+   Vector<SnapshotClass> mClasses;
+   Map<AbstractClassRep*, U32> mClassIndex;
+
+   Vector<U8> mObjectData;
+   U32 mNumObjects;
+
+   U32 addString( const char *str );
+   U32 addClass( AbstractClassRep *rep );
+   void addObject( SimObject *object, S32 parent );
+};
+
+SnapshotWriter::SnapshotWriter()
+   : mNumObjects( 0 )
+{
+   VECTOR_SET_ASSOCIATION( mStrings );
+   VECTOR_SET_ASSOCIATION( mClasses );
+   VECTOR_SET_ASSOCIATION( mObjectData );
+}
+
+U32 SnapshotWriter::addString( const char *str )
+{
+   if ( !str )
+      str = "";
+
+   // Intern case sensitively so that the map can key on the pointer.
+   StringTableEntry entry = StringTable->insert( str, true );
+
+   Map<const char*, U32>::Iterator iter = mStringIndex.find( entry );
+   if ( iter != mStringIndex.end() )
+      return iter->value;
+
+   const U32 index = mStrings.size();
+   mStrings.push_back( entry );
+   mStringIndex.insert( entry, index );
+   return index;
+}
+
+U32 SnapshotWriter::addClass( AbstractClassRep *rep )
+{
+   Map<AbstractClassRep*, U32>::Iterator iter = mClassIndex.find( rep );
+   if ( iter != mClassIndex.end() )
+      return iter->value;
+
+   SnapshotClass info;
+   info.rep = rep;
+
+   const AbstractClassRep::FieldList &list = rep->mFieldList;
+   for ( U32 i = 0; i < list.size(); i++ )
+   {
+      // Skip the special field types as they are not data.
+      if ( list[i].type >= AbstractClassRep::ARCFirstCustomField )
+         continue;
+
+      info.fields.push_back( i );
+      info.encodings.push_back( getSnapshotEncoding( list[i] ) );
+   }
+
+   const U32 index = mClasses.size();
+   mClasses.push_back( info );
+   mClassIndex.insert( rep, index );
+   return index;
+}
+
+void SnapshotWriter::addObject( SimObject *object, S32 parent )
+{
+   const U32 classIndex = addClass( object->getClassRep() );
+   const SnapshotClass &info = mClasses[classIndex];
+   const AbstractClassRep::FieldList &list = info.rep->mFieldList;
+
+   const S32 self = mNumObjects++;
+
+   // Header words are patched once the counts are known.
+   const U32 headerPos = mObjectData.size();
+   mObjectData.setSize( headerPos + SnapshotObjectWords * sizeof( U32 ) );
+
+   const U32 staticStart = mObjectData.size();
+   U32 numStatic = 0;
+
+   for ( U32 i = 0; i < info.fields.size(); i++ )
+   {
+      const AbstractClassRep::Field &field = list[info.fields[i]];
+      const U32 encoding = info.encodings[i];
+      const U32 elementSize = ConsoleBaseType::getType( field.type )->getTypeSize();
+      StringTableEntry fieldName = StringTable->insert( field.pFieldname );
+
+      for ( S32 j = 0; j < field.elementCount; j++ )
+      {
+         char array[8];
+         dSprintf( array, sizeof( array ), "%d", j );
+
+         const char *value = object->getDataField( fieldName, array );
+         if ( !value )
+            continue;
+
+         // Same filtering as SimObject::writeFields().
+         String valueCopy( value );
+         if ( !object->writeField( fieldName, valueCopy.c_str() ) )
+            continue;
+
+         const U32 entryPos = mObjectData.size();
+         const U16 ids[2] = { U16( i ), U16( j ) };
+         mObjectData.setSize( entryPos + sizeof( ids ) );
+         dMemcpy( mObjectData.address() + entryPos, ids, sizeof( ids ) );
+
+         if ( encoding == SnapshotRaw )
+         {
+            const U32 paddedSize = ( elementSize + 3 ) & ~3;
+            const U32 pos = mObjectData.size();
+            mObjectData.setSize( pos + paddedSize );
+            dMemset( mObjectData.address() + pos, 0, paddedSize );
+            dMemcpy( mObjectData.address() + pos, ( (const U8*)object ) + field.offset + j * elementSize, elementSize );
+         }
+         else
+            appendSnapshotWord( mObjectData, addString( valueCopy.c_str() ) );
+
+         numStatic++;
+      }
+   }
+
+   const U32 staticBytes = mObjectData.size() - staticStart;
+
+   U32 numDynamic = 0;
+   SimFieldDictionary *dictionary = object->getFieldDictionary();
+   if ( dictionary && object->getCanSaveDynamicFields( true ) )
+   {
+      for ( SimFieldDictionaryIterator itr( dictionary ); *itr; ++itr )
+      {
+         SimFieldDictionary::Entry *entry = *itr;
+         if ( !object->writeField( entry->slotName, entry->value ) )
+            continue;
+
+         appendSnapshotWord( mObjectData, addString( entry->slotName ) );
+         appendSnapshotWord( mObjectData, addString( entry->value ) );
+         numDynamic++;
+      }
+   }
+
+   const U32 header[SnapshotObjectWords] =
+   {
+      convertHostToLEndian( classIndex ),
+      convertHostToLEndian( U32( parent ) ),
+      convertHostToLEndian( object->getName() ? addString( object->getName() ) : SnapshotNoString ),
+      convertHostToLEndian( numStatic ),
+      convertHostToLEndian( staticBytes ),
+      convertHostToLEndian( numDynamic ),
+   };
+   dMemcpy( mObjectData.address() + headerPos, header, sizeof( header ) );
+
+   // Only groups own their children; plain sets merely reference them.
+   SimGroup *group = dynamic_cast<SimGroup*>( object );
+   if ( group )
+   {
+      for ( SimGroup::iterator itr = group->begin(); itr != group->end(); itr++ )
+         addObject( *itr, self );
+   }
+}
+
+bool SnapshotWriter::write( SimObject *root, Stream &stream )
+{
+   addObject( root, -1 );
+
+   // The class table references strings, so build it before writing.
+   Vector<U8> classData;
+   for ( U32 i = 0; i < mClasses.size(); i++ )
+   {
+      const SnapshotClass &info = mClasses[i];
+
+      appendSnapshotWord( classData, addString( info.rep->getClassName() ) );
+      appendSnapshotWord( classData, info.fields.size() );
+
+      for ( U32 j = 0; j < info.fields.size(); j++ )
+      {
+         const AbstractClassRep::Field &field = info.rep->mFieldList[info.fields[j]];
+         ConsoleBaseType *type = ConsoleBaseType::getType( field.type );
+
+         appendSnapshotWord( classData, addString( field.pFieldname ) );
+         appendSnapshotWord( classData, addString( type->getTypeName() ) );
+         appendSnapshotWord( classData, info.encodings[j] );
+         appendSnapshotWord( classData, type->getTypeSize() );
+      }
+   }
+
+   stream.write( SnapshotTag );
+   stream.write( SnapshotVersion );
+   stream.write( sizeof( SnapshotNativeMarker ), &SnapshotNativeMarker );
+   stream.write( (U32)mStrings.size() );
+   stream.write( (U32)mClasses.size() );
+   stream.write( mNumObjects );
+
+   for ( U32 i = 0; i < mStrings.size(); i++ )
+   {
+      const U32 length = dStrlen( mStrings[i] );
+      stream.write( length );
+      stream.write( length + 1, mStrings[i] );
+   }
+
+   if ( classData.size() )
+      stream.write( classData.size(), classData.address() );
+   if ( mObjectData.size() )
+      stream.write( mObjectData.size(), mObjectData.address() );
+
+   return stream.getStatus() == Stream::Ok;
+}
+
+//-----------------------------------------------------------------------------
+// Loading
+//-----------------------------------------------------------------------------
+
+struct SnapshotField
+{
+   const AbstractClassRep::Field *field;
+   StringTableEntry name;
+   U32 encoding;
+   U32 size;
+
+   /// True if the value can be copied straight into the object.
+   bool native;
+};
+
+struct SnapshotClassInfo
+{
+   AbstractClassRep *rep;
+   Vector<SnapshotField> fields;
+};
+
+struct SnapshotObject
+{
+   SimObject *object;
+   const SnapshotClassInfo *info;
+   S32 parent;
+   const char *name;
+   U32 numChildren;
+
+   U32 numStatic;
+   const U8 *staticData;
+   const U8 *staticEnd;
+
+   U32 numDynamic;
+   const U8 *dynamicData;
+};
+
+class SnapshotLoader
+{
+public:
+
+   SnapshotLoader();
+   ~SnapshotLoader();
+
+   SimObject* load( const char *filename, SimGroup *parent );
+
+   /// Copy the native fields of objects [start, end).  Thread safe.
+   void applyNativeFields( U32 start, U32 end );
+
+   /// Run SimObject::prepareAdd() on objects [start, end).  Thread safe.
+   void prepareObjects( U32 start, U32 end );
+
+protected:
+
+   Torque::FS::FileView mFile;
+   const U8 *mEnd;
+
+   Vector<const char*> mStrings;
+   Vector<SnapshotClassInfo> mClasses;
+   Vector<SnapshotObject> mObjects;
+
+   volatile U32 mNumErrors;
+
+   const char* getString( U32 index ) const
+   {
+      return index < mStrings.size() ? mStrings[index] : NULL;
+   }
+
+   bool readHeader( const char *filename, const U8 *&ptr, U32 &numStrings, U32 &numClasses, U32 &numObjects );
+   bool readStrings( const U8 *&ptr, U32 count );
+   bool readClasses( const U8 *&ptr, U32 count );
+   bool createObjects( const U8 *&ptr, U32 count );
+   void applyTextFields();
+   SimObject* registerObjects( SimGroup *parent );
+   void deleteObjects();
+};
+
+/// The shared state of one parallel pass over the objects.  Workers and
+/// the main thread claim chunks until none are left, like the parallel
+/// scene prep.  The loader is only touched while working on a claimed
+/// chunk, so a work item which starts late can't outlive it.
+class SnapshotJob : public ThreadSafeRefCount< SnapshotJob >
+{
+public:
+
+   enum Pass
+   {
+      ApplyNativeFields,
+      PrepareObjects,
+   };
+
+   SnapshotJob( SnapshotLoader *loader, Pass pass, U32 numObjects )
+      : mLoader( loader ),
+        mPass( pass ),
+        mNumObjects( numObjects ),
+        mNumChunks( ( numObjects + SnapshotChunkSize - 1 ) / SnapshotChunkSize ),
+        mNextChunk( 0 ),
+        mChunkDone( 0 )
+   {
+   }
+
+   U32 getNumChunks() const { return mNumChunks; }
+
+   /// Works on chunks until there are none left.
+   void run()
+   {
+      U32 chunk;
+      while ( claimChunk( chunk ) )
+      {
+         const U32 start = chunk * SnapshotChunkSize;
+         const U32 end = getMin( start + SnapshotChunkSize, mNumObjects );
+         if ( mPass == ApplyNativeFields )
+            mLoader->applyNativeFields( start, end );
+         else
+            mLoader->prepareObjects( start, end );
+
+         mChunkDone.release();
+      }
+   }
+
+   /// Runs the pass on the calling thread and the pool, and
+   /// returns once every chunk is done.
+   void runAndWait()
+   {
+      ThreadPool &pool = ThreadPool::GLOBAL();
+      const U32 numItems = mNumChunks ? getMin( pool.getNumThreads(), mNumChunks - 1 ) : 0;
+      for ( U32 i = 0; i < numItems; i++ )
+         pool.queueWorkItem( new WorkItem( this ) );
+
+      run();
+      for ( U32 i = 0; i < mNumChunks; i++ )
+         mChunkDone.acquire();
+   }
+
+protected:
+
+   class WorkItem : public ThreadPool::WorkItem
+   {
+   public:
+
+      typedef ThreadPool::WorkItem Parent;
+
+      WorkItem( SnapshotJob *job )
+         : mJob( job ) {}
+
+   protected:
+
+      ThreadSafeRef< SnapshotJob > mJob;
+
+      virtual void execute() { mJob->run(); }
+   };
+
+   SnapshotLoader *mLoader;
+   Pass mPass;
+   U32 mNumObjects;
+   U32 mNumChunks;
+   volatile U32 mNextChunk;
+
+   /// Released once for every finished chunk.
+   Semaphore mChunkDone;
+
+   bool claimChunk( U32 &outChunk )
+   {
+      for ( ;; )
+      {
+         U32 next = mNextChunk;
+         if ( next >= mNumChunks )
+            return false;
+
+         if ( dCompareAndSwap( mNextChunk, next, next + 1 ) )
+         {
+            outChunk = next;
+            return true;
+         }
+      }
+   }
+};
+
+SnapshotLoader::SnapshotLoader()
+   : mEnd( NULL ),
+     mNumErrors( 0 )
+{
+   VECTOR_SET_ASSOCIATION( mStrings );
+   VECTOR_SET_ASSOCIATION( mClasses );
+   VECTOR_SET_ASSOCIATION( mObjects );
+}
+
+SnapshotLoader::~SnapshotLoader()
+{
+   mFile.close();
+}
+
+bool SnapshotLoader::readHeader( const char *filename, const U8 *&ptr, U32 &numStrings, U32 &numClasses, U32 &numObjects )
+{
+   if ( !mFile.open( filename ) )
+   {
+      Con::errorf( "Sim::loadSnapshot - could not open '%s'.", filename );
+      return false;
+   }
+
+   ptr = mFile.getData();
+   mEnd = ptr + mFile.getSize();
+
+   if ( mFile.getSize() < SnapshotHeaderWords * sizeof( U32 ) ||
+        readSnapshotWord( ptr ) != SnapshotTag ||
+        readSnapshotWord( ptr + 4 ) != SnapshotVersion )
+   {
+      Con::errorf( "Sim::loadSnapshot - '%s' is not a snapshot.", filename );
+      return false;
+   }
+
+   U32 marker;
+   dMemcpy( &marker, ptr + 8, sizeof( marker ) );
+   if ( marker != SnapshotNativeMarker )
+   {
+      Con::errorf( "Sim::loadSnapshot - '%s' was written on a platform with a different byte order.", filename );
+      return false;
+   }
+
+   numStrings = readSnapshotWord( ptr + 12 );
+   numClasses = readSnapshotWord( ptr + 16 );
+   numObjects = readSnapshotWord( ptr + 20 );
+   ptr += SnapshotHeaderWords * sizeof( U32 );
+
+   return true;
+}
+
+bool SnapshotLoader::readStrings( const U8 *&ptr, U32 count )
+{
+   // Each string takes at least five bytes.
+   if ( count > U32( mEnd - ptr ) / 5 )
+      return false;
+
+   mStrings.setSize( count );
+   for ( U32 i = 0; i < count; i++ )
+   {
+      if ( mEnd - ptr < 4 )
+         return false;
+
+      const U32 length = readSnapshotWord( ptr );
+      ptr += 4;
+
+      if ( length >= U32( mEnd - ptr ) || ptr[length] != 0 )
+         return false;
+
+      // Point straight into the file view.
+      mStrings[i] = (const char *) ptr;
+      ptr += length + 1;
+   }
+
+   return true;
+}
+
+bool SnapshotLoader::readClasses( const U8 *&ptr, U32 count )
+{
+   if ( count > U32( mEnd - ptr ) / 8 )
+      return false;
+
+   mClasses.setSize( count );
+   for ( U32 i = 0; i < count; i++ )
+   {
+      if ( mEnd - ptr < 8 )
+         return false;
+
+      const char *className = getString( readSnapshotWord( ptr ) );
+      const U32 numFields = readSnapshotWord( ptr + 4 );
+      ptr += 8;
+
+      if ( !className || numFields > U32( mEnd - ptr ) / 16 )
+         return false;
+
+      SnapshotClassInfo &info = mClasses[i];
+      info.rep = AbstractClassRep::findClassRep( className );
+      if ( !info.rep )
+      {
+         Con::errorf( "Sim::loadSnapshot - unknown class '%s'.", className );
+         return false;
+      }
+
+      info.fields.setSize( numFields );
+      for ( U32 j = 0; j < numFields; j++, ptr += 16 )
+      {
+         SnapshotField &field = info.fields[j];
+         const char *fieldName = getString( readSnapshotWord( ptr ) );
+         const char *typeName = getString( readSnapshotWord( ptr + 4 ) );
+         field.encoding = readSnapshotWord( ptr + 8 );
+         field.size = readSnapshotWord( ptr + 12 );
+
+         if ( !fieldName || !typeName || field.encoding >= SnapshotEncodingCount )
+            return false;
+
+         field.name = StringTable->insert( fieldName );
+         field.field = info.rep->findField( field.name );
+         field.native = false;
+
+         // Only copy natively if the field still has the type, size and
+         // encoding it was saved with; otherwise fall back to text.
+         if ( field.field && field.encoding != SnapshotText )
+         {
+            ConsoleBaseType *type = ConsoleBaseType::getType( field.field->type );
+            field.native = dStrcmp( type->getTypeName(), typeName ) == 0 &&
+                           type->getTypeSize() == field.size &&
+                           getSnapshotEncoding( *field.field ) == field.encoding;
+         }
+
+         if ( field.encoding == SnapshotRaw && !field.native )
+            Con::warnf( "Sim::loadSnapshot - %s::%s has changed since the snapshot was saved and will be skipped.",
+               className, fieldName );
+      }
+   }
+
+   return true;
+}
+
+bool SnapshotLoader::createObjects( const U8 *&ptr, U32 count )
+{
+   if ( count == 0 || count > U32( mEnd - ptr ) / ( SnapshotObjectWords * sizeof( U32 ) ) )
+      return false;
+
+   mObjects.reserve( count );
+   for ( U32 i = 0; i < count; i++ )
+   {
+      if ( U32( mEnd - ptr ) < SnapshotObjectWords * sizeof( U32 ) )
+         return false;
+
+      const U32 classIndex = readSnapshotWord( ptr );
+      const S32 parent = S32( readSnapshotWord( ptr + 4 ) );
+      const U32 nameIndex = readSnapshotWord( ptr + 8 );
+
+      SnapshotObject entry;
+      entry.object = NULL;
+      entry.parent = parent;
+      entry.name = nameIndex == SnapshotNoString ? NULL : getString( nameIndex );
+      entry.numChildren = 0;
+      entry.numStatic = readSnapshotWord( ptr + 12 );
+      const U32 staticBytes = readSnapshotWord( ptr + 16 );
+      entry.numDynamic = readSnapshotWord( ptr + 20 );
+      ptr += SnapshotObjectWords * sizeof( U32 );
+
+      if ( classIndex >= mClasses.size() ||
+           ( nameIndex != SnapshotNoString && !entry.name ) ||
+           ( i == 0 ) != ( parent < 0 ) || parent >= S32( i ) ||
+           staticBytes > U32( mEnd - ptr ) ||
+           entry.numDynamic > ( U32( mEnd - ptr ) - staticBytes ) / 8 )
+         return false;
+
+      entry.info = &mClasses[classIndex];
+      entry.staticData = ptr;
+      entry.staticEnd = ptr + staticBytes;
+      entry.dynamicData = entry.staticEnd;
+      ptr = entry.dynamicData + entry.numDynamic * 8;
+
+      // Only groups were descended into when saving.
+      if ( parent >= 0 )
+      {
+         if ( !dynamic_cast<SimGroup*>( mObjects[parent].object ) )
+            return false;
+
+         mObjects[parent].numChildren++;
+      }
+
+      // The class rep was resolved once per class; go through it
+      // directly rather than looking up the name per object.
+      ConsoleObject *conObj = entry.info->rep->create();
+      entry.object = dynamic_cast<SimObject*>( conObj );
+      if ( !entry.object )
+      {
+         Con::errorf( "Sim::loadSnapshot - class '%s' is not a SimObject.", entry.info->rep->getClassName() );
+         delete conObj;
+         return false;
+      }
+
+      mObjects.push_back( entry );
+   }
+
+   return true;
+}
+
+void SnapshotLoader::applyNativeFields( U32 start, U32 end )
+{
+   for ( U32 i = start; i < end; i++ )
+   {
+      const SnapshotObject &entry = mObjects[i];
+      const Vector<SnapshotField> &fields = entry.info->fields;
+      U8 *base = (U8 *) entry.object;
+
+      const U8 *ptr = entry.staticData;
+      for ( U32 j = 0; j < entry.numStatic; j++ )
+      {
+         if ( entry.staticEnd - ptr < 4 )
+         {
+            dFetchAndAdd( mNumErrors, 1 );
+            break;
+         }
+
+         U16 ids[2];
+         dMemcpy( ids, ptr, sizeof( ids ) );
+         ptr += sizeof( ids );
+
+         if ( ids[0] >= fields.size() )
+         {
+            dFetchAndAdd( mNumErrors, 1 );
+            break;
+         }
+
+         const SnapshotField &field = fields[ids[0]];
+         const U32 dataSize = field.encoding == SnapshotRaw ? ( field.size + 3 ) & ~3 : 4;
+         if ( U32( entry.staticEnd - ptr ) < dataSize )
+         {
+            dFetchAndAdd( mNumErrors, 1 );
+            break;
+         }
+
+         const U8 *data = ptr;
+         ptr += dataSize;
+
+         if ( !field.native || ids[1] >= field.field->elementCount )
+            continue;
+
+         U8 *dptr = base + field.field->offset + ids[1] * field.size;
+
+         if ( field.encoding == SnapshotRaw )
+            dMemcpy( dptr, data, field.size );
+         else
+         {
+            const char *value = getString( readSnapshotWord( data ) );
+            if ( !value )
+            {
+               dFetchAndAdd( mNumErrors, 1 );
+               break;
+            }
+
+            *( (const char **) dptr ) = StringTable->insert( value, field.encoding == SnapshotCaseString );
+         }
+      }
+   }
+}
+
+void SnapshotLoader::applyTextFields()
+{
+   for ( U32 i = 0; i < mObjects.size(); i++ )
+   {
+      const SnapshotObject &entry = mObjects[i];
+      const Vector<SnapshotField> &fields = entry.info->fields;
+
+      // The native pass has already validated the static block.
+      const U8 *ptr = entry.staticData;
+      for ( U32 j = 0; j < entry.numStatic; j++ )
+      {
+         U16 ids[2];
+         dMemcpy( ids, ptr, sizeof( ids ) );
+         ptr += sizeof( ids );
+
+         const SnapshotField &field = fields[ids[0]];
+         if ( field.encoding == SnapshotRaw )
+         {
+            ptr += ( field.size + 3 ) & ~3;
+            continue;
+         }
+
+         const char *value = getString( readSnapshotWord( ptr ) );
+         ptr += 4;
+
+         if ( field.native )
+            continue;
+
+         if ( !value )
+         {
+            mNumErrors++;
+            return;
+         }
+
+         char array[8];
+         dSprintf( array, sizeof( array ), "%d", ids[1] );
+         entry.object->setDataField( field.name, array, value );
+      }
+
+      ptr = entry.dynamicData;
+      for ( U32 j = 0; j < entry.numDynamic; j++, ptr += 8 )
+      {
+         const char *slotName = getString( readSnapshotWord( ptr ) );
+         const char *value = getString( readSnapshotWord( ptr + 4 ) );
+         if ( !slotName || !value )
+         {
+            mNumErrors++;
+            return;
+         }
+
+         entry.object->setDataField( StringTable->insert( slotName ), NULL, value );
+      }
+   }
+}
+
+void SnapshotLoader::prepareObjects( U32 start, U32 end )
+{
+   for ( U32 i = start; i < end; i++ )
+   {
+      SimObject *object = mObjects[i].object;
+      if ( object->isPrepareAddThreadSafe() )
+         object->prepareAdd();
+   }
+}
+
+SimObject* SnapshotLoader::registerObjects( SimGroup *parent )
+{
+   // Registration touches the global dictionaries, so it stays on the
+   // main thread.  Pre-order guarantees a parent is registered before its
+   // children are added to it.
+   for ( U32 i = 0; i < mObjects.size(); i++ )
+   {
+      SnapshotObject &entry = mObjects[i];
+
+      SimGroup *group = entry.parent < 0 ? parent : static_cast<SimGroup*>( mObjects[entry.parent].object );
+      if ( !group )
+      {
+         // The parent failed to register; drop the subtree.
+         delete entry.object;
+         entry.object = NULL;
+         continue;
+      }
+
+      const bool registered = entry.name ? entry.object->registerObject( entry.name ) : entry.object->registerObject();
+      if ( !registered )
+      {
+         Con::warnf( "Sim::loadSnapshot - failed to register %s '%s'.",
+            entry.info->rep->getClassName(), entry.name ? entry.name : "" );
+
+         delete entry.object;
+         entry.object = NULL;
+         continue;
+      }
+
+      if ( entry.numChildren )
+         static_cast<SimGroup*>( entry.object )->reserve( entry.numChildren );
+
+      group->addObject( entry.object );
+   }
+
+   return mObjects[0].object;
+}
+
+void SnapshotLoader::deleteObjects()
+{
+   for ( U32 i = 0; i < mObjects.size(); i++ )
+      delete mObjects[i].object;
+
+   mObjects.clear();
+}
+
+SimObject* SnapshotLoader::load( const char *filename, SimGroup *parent )
+{
+   const U64 start = Platform::getPerformanceCounter();
+
+   const U8 *ptr;
+   U32 numStrings, numClasses, numObjects;
+   if ( !readHeader( filename, ptr, numStrings, numClasses, numObjects ) )
+      return NULL;
+
+   if ( !readStrings( ptr, numStrings ) ||
+        !readClasses( ptr, numClasses ) ||
+        !createObjects( ptr, numObjects ) )
+   {
+      Con::errorf( "Sim::loadSnapshot - '%s' is corrupt.", filename );
+      deleteObjects();
+      return NULL;
+   }
+
+   const U64 created = Platform::getPerformanceCounter();
+
+   ThreadSafeRef< SnapshotJob > fieldJob( new SnapshotJob( this, SnapshotJob::ApplyNativeFields, mObjects.size() ) );
+   fieldJob->runAndWait();
+
+   if ( mNumErrors == 0 )
+      applyTextFields();
+
+   if ( mNumErrors )
+   {
+      Con::errorf( "Sim::loadSnapshot - '%s' has a corrupt object record.", filename );
+      deleteObjects();
+      return NULL;
+   }
+
+   const U64 fieldsApplied = Platform::getPerformanceCounter();
+
+   ThreadSafeRef< SnapshotJob > prepareJob( new SnapshotJob( this, SnapshotJob::PrepareObjects, mObjects.size() ) );
+   prepareJob->runAndWait();
+
+   const U64 prepared = Platform::getPerformanceCounter();
+
+   SimObject *root = registerObjects( parent );
+
+   const U64 end = Platform::getPerformanceCounter();
+   const F64 toMs = 1000.0 / F64( Platform::getPerformanceCounterFrequency() );
+
+   Con::printf( "Sim::loadSnapshot - %d objects from '%s' in %.2f ms", mObjects.size(), filename, ( end - start ) * toMs );
+   Con::printf( "   create %.2f ms, fields %.2f ms, prepare %.2f ms, register %.2f ms",
+      ( created - start ) * toMs, ( fieldsApplied - created ) * toMs,
+      ( prepared - fieldsApplied ) * toMs, ( end - prepared ) * toMs );
+
+   return root;
+}
+
+} // anonymous namespace
+
+//-----------------------------------------------------------------------------
+// Sim Functions
+//-----------------------------------------------------------------------------
+
+namespace Sim
+{
+
+bool saveSnapshot(SimObject *root, const char *filename)
+{
+   FileStream *stream;
+   if((stream = FileStream::createAndOpen( filename, Torque::FS::File::Write )) == NULL)
+      return false;
+
+   SnapshotWriter writer;
+   bool ret = writer.write(root, *stream);
+   delete stream;
+
+   return ret;
+}
+
+SimObject *loadSnapshot(const char *filename, SimGroup *parent)
+{
+   SnapshotLoader loader;
+   return loader.load(filename, parent ? parent : Sim::getRootGroup());
+}
+
+} // end namespace Sim
+
+//-----------------------------------------------------------------------------
+// Console Functions
+//-----------------------------------------------------------------------------
+
+ConsoleFunction(saveSnapshot, bool, 3, 3, "(object, filename)\n"
+                "Write the object and, if it is a SimGroup, everything it contains "
+                "to a binary snapshot that loadSnapshot() can restore without the script compiler.")
+{
+   SimObject *obj = Sim::findObject(argv[1]);
+   if(obj == NULL)
+   {
+      Con::errorf("saveSnapshot - could not find object '%s'.", argv[1]);
+      return false;
+   }
+
+   return Sim::saveSnapshot(obj, argv[2]);
+}
+
+ConsoleFunction(loadSnapshot, S32, 2, 3, "(filename, [parentGroup])\n"
+                "Load a snapshot written by saveSnapshot() and add its root to parentGroup, "
+                "or the RootGroup if none is given.  Returns the root object's id or 0.")
+{
+   SimGroup *parent = NULL;
+   if(argc > 2 && !Sim::findObject(argv[2], parent))
+   {
+      Con::errorf("loadSnapshot - '%s' is not a SimGroup.", argv[2]);
+      return 0;
+   }
+
+   SimObject *obj = Sim::loadSnapshot(argv[1], parent);
+   return obj ? obj->getId() : 0;
+}
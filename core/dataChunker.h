@@ -107,6 +107,10 @@ public:
    /// Use like so:  MyType* t = chunker.alloc<MyType>();
    template<typename T>
    T* alloc()  { return reinterpret_cast<T*>(DataChunker::alloc(S32(sizeof(T)))); }
+
+   /// Allocates space for count elements without constructing them.
+   template<typename T>
+   T* allocArray( U32 count )  { return reinterpret_cast<T*>(DataChunker::alloc(S32(sizeof(T) * count))); }
    void clear()  { freeBlocks(true); }
 };
 
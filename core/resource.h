@@ -167,6 +167,13 @@ protected:
    
    virtual void _triggerPostLoadSignal() {}
    virtual NotifyUnloadFn _getNotifyUnloadFn() { return ( NotifyUnloadFn ) NULL; }
+
+   // Used by ResourceManager::loadAsync() to create the
+   // resource on a worker thread and finish it on the main
+   // thread.  The derived resource handles these.
+   virtual bool _canCreateAsync() { return false; }
+   virtual void *_createAsync(const Torque::Path &path) { return NULL; }
+   virtual bool _finishAsync(const Torque::Path &path, void *resource) { return true; }
 };
 
 // This is a utility class used by resource manager.  Classes derived
@@ -233,6 +240,29 @@ public:
       return sUnloadSignal;
    }
 
+   typedef Delegate< bool( const Torque::Path&, T* ) > AsyncFinishFn;
+
+   /// Set this if create() may run on a worker thread, which lets
+   /// ResourceManager::loadAsync() create resources of this type off the
+   /// main thread.  Otherwise the worker only reads the file and the
+   /// resource is created on the main thread.
+   /// @see ResourceRegisterAsyncCreate
+   static bool& getAsyncCreate()
+   {
+      static bool sAsyncCreate = false;
+      return sAsyncCreate;
+   }
+
+   /// Called on the main thread for resources which were created on a
+   /// worker thread, before the post load signal.  This is the place for
+   /// work which needs the main thread, like creating device resources.
+   /// Returning false fails the load.
+   static AsyncFinishFn& getAsyncFinishFn()
+   {
+      static AsyncFinishFn sAsyncFinishFn;
+      return sAsyncFinishFn;
+   }
+
 private:
    T        *getResource() { return (T*)mResourceHeader->getResource(); }
    const T  *getResource() const { return (T*)mResourceHeader->getResource(); }
@@ -248,6 +278,14 @@ private:
    virtual void _triggerPostLoadSignal() { getPostLoadSignal().trigger( *this ); }
    virtual NotifyUnloadFn _getNotifyUnloadFn() { return ( NotifyUnloadFn ) &_notifyUnload; }
 
+   virtual bool _canCreateAsync() { return getAsyncCreate(); }
+   virtual void *_createAsync(const Torque::Path &path) { return create( path ); }
+   virtual bool _finishAsync(const Torque::Path &path, void *resource)
+   {
+      AsyncFinishFn &finish = getAsyncFinishFn();
+      return finish.empty() || finish( path, ( T* ) resource );
+   }
+
    // These are to be define by instantiated resources
    // No generic version is provided...however, since
    // base resources are instantiated by resource manager,
@@ -303,4 +341,20 @@ class ResourceRegisterUnloadSignal
       }
 };
 
+/// This template marks the create() of a resource type as safe
+/// to run on a worker thread, with an optional function to finish
+/// the resource on the main thread:
+///   static ResourceRegisterAsyncCreate<T> sgAsync( staticFinishFunction );
+template< class T >
+class ResourceRegisterAsyncCreate
+{
+   public:
+
+      ResourceRegisterAsyncCreate( typename Resource< T >::AsyncFinishFn finish = typename Resource< T >::AsyncFinishFn() )
+      {
+         Resource< T >::getAsyncCreate() = true;
+         Resource< T >::getAsyncFinishFn() = finish;
+      }
+};
+
 #endif // __RESOURCE_H__
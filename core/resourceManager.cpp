@@ -9,9 +9,16 @@
 #include "core/volume.h"
 #include "console/console.h"
 #include "core/util/autoPtr.h"
+#include "core/stream/fileStream.h"
+#include "platform/threads/threadPool.h"
+#include "platform/threads/thread.h"
+#include "platform/platformIntrinsics.h"
+#include "platform/profiler.h"
 
 static AutoPtr< ResourceManager > smInstance;
 
+U32 ResourceManager::smAsyncLoadBudget = 4;
+
 ResourceManager::ResourceManager()
 :  mIterSigFilter( U32_MAX )
 {
@@ -20,6 +27,7 @@ ResourceManager::ResourceManager()
 ResourceManager::~ResourceManager()
 {
    // TODO: Dump resources that have not been released?
+   cancelAsyncLoads();
 }
 
 ResourceManager &ResourceManager::get()
@@ -71,6 +79,237 @@ ResourceBase ResourceManager::find(const Torque::Path &path)
    return ResourceBase(header);
 }
 
+//-----------------------------------------------------------------------------
+
+ResourceLoadRequest::ResourceLoadRequest( const Torque::Path &path, ResourceBase *loader, const ResourceBase &placeholder, F32 priority )
+   :  mPath( path ),
+      mLoader( loader ),
+      mResource( NULL ),
+      mPlaceholder( placeholder ),
+      mCreated( NULL ),
+      mState( Loading ),
+      mCancelled( 0 ),
+      mPriority( priority )
+{
+}
+
+ResourceLoadRequest::~ResourceLoadRequest()
+{
+   AssertFatal( mState != Loading, "ResourceLoadRequest - Deleted while loading!" );
+   delete mLoader;
+}
+
+/// Creates the resource of a request on a worker thread.
+struct ResourceManager::AsyncLoadItem : public ThreadPool::WorkItem
+{
+   /// The manager keeps the request alive until we set
+   /// its state, so we don't hold a reference to it.
+   ResourceLoadRequest *mRequest;
+
+   AsyncLoadItem( ResourceLoadRequest *request )
+      : mRequest( request )
+   {
+   }
+
+   virtual ~AsyncLoadItem()
+   {
+      // Done here so that items dropped by the pool finish too.
+      ResourceManager::_setCreated( mRequest );
+   }
+
+   virtual F32 getPriority() { return mRequest->getPriority(); }
+
+   virtual bool isCancellationRequested() { return mRequest->isCancelled(); }
+
+   virtual void execute()
+   {
+      if ( !cancellationPoint() )
+         ResourceManager::_createAsync( mRequest );
+   }
+};
+
+ResourceLoadRequestRef ResourceManager::_loadAsync( const Torque::Path &path, ResourceBase *loader, const ResourceBase &placeholder, F32 priority )
+{
+   AssertFatal( ThreadManager::isMainThread(), "ResourceManager::loadAsync - Must be called from the main thread!" );
+
+   // Join a pending load of the same resource.
+   for ( U32 i=0; i < mAsyncLoads.size(); i++ )
+   {
+      if ( mAsyncLoads[i]->getPath() == path )
+      {
+         delete loader;
+         if ( priority > mAsyncLoads[i]->getPriority() )
+            mAsyncLoads[i]->setPriority( priority );
+         return mAsyncLoads[i];
+      }
+   }
+
+   ResourceLoadRequestRef request = new ResourceLoadRequest( path, loader, placeholder, priority );
+   request->mResource = load( path );
+
+   // It may be loaded already.
+   if ( request->mResource.mResourceHeader.getPointer()->getSignature() != 0 )
+   {
+      request->mState = ResourceLoadRequest::Loaded;
+      return request;
+   }
+
+   mAsyncLoads.push_back( request );
+   ThreadPool::GLOBAL().queueWorkItem( new AsyncLoadItem( request ) );
+
+   return request;
+}
+
+void ResourceManager::_createAsync( ResourceLoadRequest *request )
+{
+   PROFILE_SCOPE( ResourceManager_CreateAsync );
+
+   if ( request->mLoader->_canCreateAsync() )
+   {
+      request->mCreated = request->mLoader->_createAsync( request->mPath );
+      return;
+   }
+
+   // Read the file, so that creating the resource on
+   // the main thread doesn't wait on the disk.
+   FileStream stream;
+   if ( stream.open( request->mPath.getFullPath(), Torque::FS::File::Read ) )
+   {
+      U8 buffer[ 16 * 1024 ];
+      U32 remaining = stream.getStreamSize();
+      while ( remaining > 0 && !request->isCancelled() )
+      {
+         const U32 size = getMin( remaining, (U32)sizeof( buffer ) );
+         if ( !stream.read( size, buffer ) )
+            break;
+         remaining -= size;
+      }
+   }
+}
+
+void ResourceManager::_setCreated( ResourceLoadRequest *request )
+{
+   dCompareAndSwap( request->mState, (U32)ResourceLoadRequest::Loading, (U32)ResourceLoadRequest::Created );
+}
+
+void ResourceManager::_destroyAsync( ResourceLoadRequest *request )
+{
+   if ( !request->mCreated )
+      return;
+
+   // Let the holder delete it as the right type.
+   ResourceHolderBase *holder = request->mLoader->createHolder( request->mCreated );
+   holder->~ResourceHolderBase();
+   ResourceHolderBase::smHolderFactory.free( holder );
+
+   request->mCreated = NULL;
+}
+
+void ResourceManager::_finishAsync( ResourceLoadRequest *request )
+{
+   PROFILE_SCOPE( ResourceManager_FinishAsync );
+
+   AssertFatal( request->mState == ResourceLoadRequest::Created, "ResourceManager::_finishAsync - The request isn't created!" );
+
+   ResourceBase::Header *header = request->mResource.mResourceHeader.getPointer();
+
+   // It may have been loaded synchronously meanwhile.
+   if ( header->getSignature() != 0 )
+      _destroyAsync( request );
+   else
+   {
+      if (  request->mCreated &&
+            !request->mLoader->_finishAsync( request->mPath, request->mCreated ) )
+         _destroyAsync( request );
+
+      // Without a resource from the worker this
+      // creates it the same way load() does.
+      request->mLoader->assign( request->mResource, request->mCreated );
+      request->mCreated = NULL;
+   }
+
+   request->mState = header->getResource() ? ResourceLoadRequest::Loaded : ResourceLoadRequest::Failed;
+   request->mDoneSignal.trigger( request );
+}
+
+static S32 QSORT_CALLBACK _compareLoadPriority( const ResourceLoadRequestRef *a, const ResourceLoadRequestRef *b )
+{
+   const F32 diff = (*b)->getPriority() - (*a)->getPriority();
+   return diff > 0.0f ? 1 : ( diff < 0.0f ? -1 : 0 );
+}
+
+void ResourceManager::processAsyncLoads()
+{
+   if ( mAsyncLoads.empty() )
+      return;
+
+   PROFILE_SCOPE( ResourceManager_ProcessAsyncLoads );
+
+   mAsyncLoads.sort( _compareLoadPriority );
+
+   const U32 start = Platform::getRealMilliseconds();
+
+   for ( U32 i=0; i < mAsyncLoads.size(); )
+   {
+      ResourceLoadRequestRef request = mAsyncLoads[i];
+      if ( request->getState() != ResourceLoadRequest::Created )
+      {
+         i++;
+         continue;
+      }
+
+      _finishAsync( request.ptr() );
+      mAsyncLoads.erase( i );
+
+      if ( Platform::getRealMilliseconds() - start >= smAsyncLoadBudget )
+         break;
+   }
+}
+
+void ResourceManager::finishAsyncLoad( ResourceLoadRequest *request )
+{
+   if ( request->isDone() )
+      return;
+
+   while ( request->getState() == ResourceLoadRequest::Loading )
+   {
+      ThreadPool::processMainThreadWorkItems();
+      Platform::sleep( 0 );
+   }
+
+   _finishAsync( request );
+
+   for ( U32 i=0; i < mAsyncLoads.size(); i++ )
+   {
+      if ( mAsyncLoads[i] == request )
+      {
+         mAsyncLoads.erase( i );
+         break;
+      }
+   }
+}
+
+void ResourceManager::cancelAsyncLoads()
+{
+   for ( U32 i=0; i < mAsyncLoads.size(); i++ )
+      mAsyncLoads[i]->mCancelled = 1;
+
+   // The workers still use the requests, so wait for them.
+   for ( U32 i=0; i < mAsyncLoads.size(); i++ )
+   {
+      ResourceLoadRequest *request = mAsyncLoads[i].ptr();
+      while ( request->getState() == ResourceLoadRequest::Loading )
+         Platform::sleep( 1 );
+
+      _destroyAsync( request );
+      request->mState = ResourceLoadRequest::Failed;
+   }
+
+   mAsyncLoads.clear();
+}
+
+//-----------------------------------------------------------------------------
+
 #ifdef TORQUE_DEBUG
 void ResourceManager::dumpToConsole()
 {
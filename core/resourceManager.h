@@ -14,8 +14,97 @@
 #include "core/util/tDictionary.h"
 #endif
 
+#ifndef _TVECTOR_H_
+#include "core/util/tVector.h"
+#endif
+
+#ifndef _THREADSAFEREFCOUNT_H_
+#include "platform/threads/threadSafeRefCount.h"
+#endif
+
 using namespace Torque;
 
+
+/// Tracks a resource loaded with ResourceManager::loadAsync().
+///
+/// The request keeps the resource loaded.  Until the load is done
+/// getResource() returns the placeholder which was passed to loadAsync(),
+/// so the caller can hold on to it in place of the resource.
+class ResourceLoadRequest : public ThreadSafeRefCount< ResourceLoadRequest >
+{
+public:
+
+   enum State
+   {
+      /// Queued or being created on a worker thread.
+      Loading,
+
+      /// Waiting to be finished on the main thread.
+      Created,
+
+      Loaded,
+      Failed,
+   };
+
+   ResourceLoadRequest( const Torque::Path &path, ResourceBase *loader, const ResourceBase &placeholder, F32 priority );
+   ~ResourceLoadRequest();
+
+   const Torque::Path& getPath() const { return mPath; }
+
+   State getState() const { return (State)mState; }
+
+   /// Returns true once the load has succeeded or failed.
+   bool isDone() const { return mState == Loaded || mState == Failed; }
+
+   /// Returns true if the load was dropped by ResourceManager::cancelAsyncLoads().
+   bool isCancelled() const { return mCancelled != 0; }
+
+   /// Returns the resource once it is loaded and the placeholder until then.
+   const ResourceBase& getResource() const { return mState == Loaded ? mResource : mPlaceholder; }
+
+   /// Higher priorities are loaded and finished first.
+   F32 getPriority() const { return mPriority; }
+   void setPriority( F32 priority ) { mPriority = priority; }
+
+   /// Sets the priority from the distance to the camera, so
+   /// that the closest resources are loaded first.
+   void setPriorityFromDistance( F32 distance ) { setPriority( 1.0f / ( 1.0f + getMax( distance, 0.0f ) ) ); }
+
+   typedef Signal<void(ResourceLoadRequest*)> DoneSignal;
+
+   /// Triggered on the main thread when the load is finished.  It isn't
+   /// triggered for a request which is done when loadAsync() returns or
+   /// which is dropped by ResourceManager::cancelAsyncLoads().
+   DoneSignal& getDoneSignal() { return mDoneSignal; }
+
+protected:
+
+   friend class ResourceManager;
+
+   Torque::Path mPath;
+
+   /// A blank resource of the requested type, which
+   /// knows how to create it.
+   ResourceBase *mLoader;
+
+   /// Holds the header while loading and the resource afterwards.
+   ResourceBase mResource;
+
+   ResourceBase mPlaceholder;
+
+   /// The resource created on the worker thread if its type allows it.
+   void *mCreated;
+
+   volatile U32 mState;
+   volatile U32 mCancelled;
+   volatile F32 mPriority;
+
+   DoneSignal mDoneSignal;
+};
+
+typedef ThreadSafeRef< ResourceLoadRequest > ResourceLoadRequestRef;
+
+
 class ResourceManager
 {
 public:
@@ -25,6 +114,49 @@ public:
    ResourceBase load(const Torque::Path &path);
    ResourceBase find(const Torque::Path &path);
 
+   /// @name Async Loading
+   /// @{
+
+   /// Loads a resource in the background.  The resource is created on the
+   /// global thread pool if its type allows it, otherwise the worker only
+   /// reads the file and the resource is created on the main thread.  Either
+   /// way the main thread finishes it in processAsyncLoads(), which runs
+   /// once per frame within a time budget.
+   ///
+   /// If the resource is already loaded the request is done right away, and
+   /// a path which is already being loaded returns the pending request.
+   ///
+   /// @code
+   ///    ResourceLoadRequestRef request = ResourceManager::get().loadAsync< GBitmap >( path );
+   ///    ...
+   ///    if ( request->isDone() )
+   ///       Resource< GBitmap > bitmap = request->getResource();
+   /// @endcode
+   template< class T >
+   ResourceLoadRequestRef loadAsync( const Torque::Path &path, F32 priority = 1.0f, const ResourceBase &placeholder = ResourceBase( NULL ) )
+   {
+      return _loadAsync( path, new Resource< T >(), placeholder, priority );
+   }
+
+   /// Finishes the loads which are back from the workers, the ones with
+   /// the highest priority first, until smAsyncLoadBudget is used up.
+   void processAsyncLoads();
+
+   /// Waits for a request and finishes it now.
+   void finishAsyncLoad( ResourceLoadRequest *request );
+
+   /// Drops every pending load without finishing it.
+   void cancelAsyncLoads();
+
+   /// Returns the number of loads which are not done yet.
+   U32 getNumAsyncLoads() const { return mAsyncLoads.size(); }
+
+   /// The milliseconds processAsyncLoads() may take each frame.  At least
+   /// one load is finished per call.
+   static U32 smAsyncLoadBudget;
+
+   /// @}
+
    ResourceBase startResourceList( ResourceBase::Signature inSignature = U32_MAX );
    ResourceBase nextResource();
 
@@ -53,6 +185,25 @@ protected:
 
    void  notifiedFileChanged( const Torque::Path &path );
 
+   struct AsyncLoadItem;
+
+   ResourceLoadRequestRef _loadAsync( const Torque::Path &path, ResourceBase *loader, const ResourceBase &placeholder, F32 priority );
+
+   /// Called on a worker thread.
+   static void _createAsync( ResourceLoadRequest *request );
+
+   /// Called when the worker is done with the request.
+   static void _setCreated( ResourceLoadRequest *request );
+
+   void _finishAsync( ResourceLoadRequest *request );
+
+   /// Deletes a resource created for a request which isn't used.
+   static void _destroyAsync( ResourceLoadRequest *request );
+
+   /// The requests which are not done.  This keeps them alive
+   /// while the workers use them.
+   Vector< ResourceLoadRequestRef > mAsyncLoads;
+
    typedef HashTable<String,ResourceBase::Header*> ResourceHeaderMap;
 
    /// The map of resources.
@@ -5,6 +5,8 @@
 
 #include "core/strings/stringFunctions.h"
 #include "core/stringTable.h"
+#include "platform/platformIntrinsics.h"
+#include "console/console.h"
 
 _StringTable *_gStringTable = NULL;
 const U32 _StringTable::csm_stInitSize = 29;
@@ -21,62 +23,115 @@ U8   sgHashTable[256];
 
 void initTolowerTable()
 {
-   for (U32 i = 0; i < 256; i++) {
-      U8 c = dTolower(i);
-      sgHashTable[i] = c * c;
-   }
+   for (U32 i = 0; i < 256; i++)
+      sgHashTable[i] = dTolower(i);
 
    sgInitTable = false;
 }
 
-} // namespace {}
+/// Lower-case the ASCII letters in four packed characters at once.
+inline U32 foldWord( U32 w )
+{
+   const U32 heptets = w & 0x7F7F7F7F;
+   const U32 isAboveZ = heptets + 0x25252525; // high bit set for bytes > 'Z'
+   const U32 isAtLeastA = heptets + 0x3F3F3F3F; // high bit set for bytes >= 'A'
+   const U32 isUpper = ~w & ( isAtLeastA ^ isAboveZ ) & 0x80808080;
+   return w | ( isUpper >> 2 );
+}
 
-U32 _StringTable::hashString(const char* str)
+inline U32 rotl( U32 x, U32 r )
+{
+   return ( x << r ) | ( x >> ( 32 - r ) );
+}
+
+/// Murmur3-style hash over the case-folded bytes of str.
+U32 hashBytes( const char *str, U32 len )
 {
    if (sgInitTable)
       initTolowerTable();
 
-   if(!str) return -1;
+   const U32 c1 = 0xCC9E2D51;
+   const U32 c2 = 0x1B873593;
+
+   U32 h = len;
+   const U32 numWords = len >> 2;
+   for( U32 i = 0; i < numWords; ++ i, str += 4 )
+   {
+      U32 k;
+      dMemcpy( &k, str, 4 );
+      k = foldWord( k ) * c1;
+      k = rotl( k, 15 ) * c2;
+      h ^= k;
+      h = rotl( h, 13 ) * 5 + 0xE6546B64;
+   }
 
-   U32 ret = 0;
-   char c;
-   while((c = *str++) != 0) {
-      ret <<= 1;
-      ret ^= sgHashTable[static_cast<U32>(c)];
+   U32 k = 0;
+   switch( len & 3 )
+   {
+      case 3: k ^= U32( sgHashTable[ U8( str[ 2 ] ) ] ) << 16;
+      case 2: k ^= U32( sgHashTable[ U8( str[ 1 ] ) ] ) << 8;
+      case 1: k ^= U32( sgHashTable[ U8( str[ 0 ] ) ] );
+         k *= c1;
+         k = rotl( k, 15 ) * c2;
+         h ^= k;
    }
-   return ret;
+
+   h ^= h >> 16;
+   h *= 0x85EBCA6B;
+   h ^= h >> 13;
+   h *= 0xC2B2AE35;
+   h ^= h >> 16;
+   return h;
 }
 
-U32 _StringTable::hashStringn(const char* str, S32 len)
+/// Return the length of str, stopping at len characters.
+inline S32 clampLength( const char *str, S32 len )
 {
-   if (sgInitTable)
-      initTolowerTable();
+   S32 n = 0;
+   while( n < len && str[ n ] )
+      n ++;
+   return n;
+}
 
-   U32 ret = 0;
-   char c;
-   while((c = *str++) != 0 && len--) {
-      ret <<= 1;
-      ret ^= sgHashTable[static_cast<U32>(c)];
-   }
-   return ret;
+} // namespace {}
+
+U32 _StringTable::hashString(const char* str)
+{
+   if(!str) return -1;
+   return hashBytes( str, dStrlen( str ) );
+}
+
+U32 _StringTable::hashStringn(const char* str, S32 len)
+{
+   return hashBytes( str, clampLength( str, len ) );
 }
 
 //--------------------------------------
 _StringTable::_StringTable()
 {
-   buckets = (Node **) dMalloc(csm_stInitSize * sizeof(Node *));
-   for(U32 i = 0; i < csm_stInitSize; i++) {
-      buckets[i] = 0;
+   for( U32 i = 0; i < NumShards; i++ )
+   {
+      Shard &shard = mShards[ i ];
+      shard.table = _createTable( csm_stInitSize );
+      shard.epoch = 0;
+      shard.numReaders[ 0 ] = 0;
+      shard.numReaders[ 1 ] = 0;
+      shard.freeNodes = NULL;
+      shard.itemCount = 0;
+      shard.memUsage = sizeof( Table ) + csm_stInitSize * sizeof( Node* );
    }
-
-   numBuckets = csm_stInitSize;
-   itemCount = 0;
 }
 
 //--------------------------------------
 _StringTable::~_StringTable()
 {
-   dFree(buckets);
+   // Nodes and strings are owned by the shard mempools.
+   for( U32 i = 0; i < NumShards; i++ )
+   {
+      Table *table = mShards[ i ].table;
+      dFree( ( void* ) table->buckets );
+      delete table;
+   }
 }
 
 
@@ -98,6 +153,124 @@ void _StringTable::destroy()
 }
 
 
+//--------------------------------------
+_StringTable::Table* _StringTable::_createTable( U32 numBuckets )
+{
+   Table *table = new Table;
+   table->buckets = ( Node * volatile * ) dMalloc( numBuckets * sizeof( Node* ) );
+   table->numBuckets = numBuckets;
+
+   for( U32 i = 0; i < numBuckets; i++ )
+      table->buckets[ i ] = NULL;
+
+   return table;
+}
+
+//--------------------------------------
+U32 _StringTable::_enterShard( Shard &shard )
+{
+   while( true )
+   {
+      const U32 slot = shard.epoch & 1;
+      dFetchAndAdd( shard.numReaders[ slot ], 1 );
+
+      // If a resize advanced the epoch in between, it may already have
+      // found our slot empty; register again in the new slot.
+      if( ( shard.epoch & 1 ) == slot )
+         return slot;
+
+      dFetchAndAdd( shard.numReaders[ slot ], ( U32 ) -1 );
+   }
+}
+
+//--------------------------------------
+void _StringTable::_leaveShard( Shard &shard, U32 slot )
+{
+   dFetchAndAdd( shard.numReaders[ slot ], ( U32 ) -1 );
+}
+
+//--------------------------------------
+_StringTable::Node* _StringTable::_allocNode( Shard &shard )
+{
+   Node *node = shard.freeNodes;
+   if( node )
+      shard.freeNodes = node->next;
+   else
+   {
+      node = ( Node* ) shard.mempool.alloc( sizeof( Node ) );
+      shard.memUsage += sizeof( Node );
+   }
+   return node;
+}
+
+//--------------------------------------
+_StringTable::Node* _StringTable::_find( Table *table, const char *val, S32 len, U32 hash, bool caseSens )
+{
+   // New strings are added at the end of bucket lists so that case sens
+   // strings are always after their corresponding case insens strings.
+   Node *walk = table->buckets[ hash % table->numBuckets ];
+   while( walk )
+   {
+      if( walk->hash == hash && walk->len == len )
+      {
+         if( caseSens && !dStrncmp( walk->val, val, len ) )
+            return walk;
+         else if( !caseSens && !dStrnicmp( walk->val, val, len ) )
+            return walk;
+      }
+      walk = walk->next;
+   }
+   return NULL;
+}
+
+//--------------------------------------
+StringTableEntry _StringTable::_insert( const char *val, S32 len, U32 hash, bool caseSens )
+{
+   Shard &shard = _getShard( hash );
+
+   // Fast path; most inserts hit strings that are already interned.
+   StringTableEntry entry = _lookup( val, len, hash, caseSens );
+   if( entry )
+      return entry;
+
+   shard.mutex.lock();
+
+   // Look again now that we hold the lock; another thread may have added the
+   // string or grown the shard in the meantime.  Tables are only recycled
+   // under the lock so we don't need to enter the shard here.
+   Table *table = shard.table;
+   Node *node = _find( table, val, len, hash, caseSens );
+   if( node )
+   {
+      shard.mutex.unlock();
+      return node->val;
+   }
+
+   node = _allocNode( shard );
+   node->val = ( char* ) shard.mempool.alloc( len + 1 );
+   dMemcpy( node->val, val, len );
+   node->val[ len ] = 0;
+   node->hash = hash;
+   node->len = len;
+   node->next = NULL;
+
+   Node * volatile *walk = &table->buckets[ hash % table->numBuckets ];
+   while( *walk )
+      walk = &( *walk )->next;
+
+   // Publish the fully initialized node to lock-free readers.
+   dCompareAndSwap( *walk, ( Node* ) NULL, node );
+
+   shard.itemCount ++;
+   shard.memUsage += len + 1;
+
+   if( shard.itemCount > 2 * table->numBuckets )
+      _resizeShard( shard, 4 * table->numBuckets - 1 );
+
+   shard.mutex.unlock();
+   return node->val;
+}
+
 //--------------------------------------
 StringTableEntry _StringTable::insert(const char* _val, const bool caseSens)
 {
@@ -107,107 +280,174 @@ StringTableEntry _StringTable::insert(const char* _val, const bool caseSens)
       val = "";
    //-
 
-   Node **walk, *temp;
-   U32 key = hashString(val);
-   walk = &buckets[key % numBuckets];
-   while((temp = *walk) != NULL)   {
-      if(caseSens && !dStrcmp(temp->val, val))
-         return temp->val;
-      else if(!caseSens && !dStricmp(temp->val, val))
-         return temp->val;
-      walk = &(temp->next);
-   }
-   char *ret = 0;
-   if(!*walk) {
-      *walk = (Node *) mempool.alloc(sizeof(Node));
-      (*walk)->next = 0;
-      (*walk)->val = (char *) mempool.alloc(dStrlen(val) + 1);
-      dStrcpy((*walk)->val, val);
-      ret = (*walk)->val;
-      itemCount ++;
-   }
-   if(itemCount > 2 * numBuckets) {
-      resize(4 * numBuckets - 1);
-   }
-   return ret;
+   const S32 len = dStrlen( val );
+   return _insert( val, len, hashBytes( val, len ), caseSens );
 }
 
 //--------------------------------------
 StringTableEntry _StringTable::insertn(const char* src, S32 len, const bool  caseSens)
 {
-   char val[256];
-   AssertFatal(len < 255, "Invalid string to insertn");
-   dStrncpy(val, src, len);
-   val[len] = 0;
-   return insert(val, caseSens);
+   len = clampLength( src, len );
+   return _insert( src, len, hashBytes( src, len ), caseSens );
 }
 
 //--------------------------------------
 StringTableEntry _StringTable::lookup(const char* val, const bool  caseSens)
 {
-   Node **walk, *temp;
-   U32 key = hashString(val);
-   walk = &buckets[key % numBuckets];
-   while((temp = *walk) != NULL)   {
-      if(caseSens && !dStrcmp(temp->val, val))
-            return temp->val;
-      else if(!caseSens && !dStricmp(temp->val, val))
-         return temp->val;
-      walk = &(temp->next);
-   }
-   return NULL;
+   if( val == NULL )
+      val = "";
+
+   const S32 len = dStrlen( val );
+   return _lookup( val, len, hashBytes( val, len ), caseSens );
 }
 
 //--------------------------------------
 StringTableEntry _StringTable::lookupn(const char* val, S32 len, const bool  caseSens)
 {
-   Node **walk, *temp;
-   U32 key = hashStringn(val, len);
-   walk = &buckets[key % numBuckets];
-   while((temp = *walk) != NULL) {
-      if(caseSens && !dStrncmp(temp->val, val, len) && temp->val[len] == 0)
-         return temp->val;
-      else if(!caseSens && !dStrnicmp(temp->val, val, len) && temp->val[len] == 0)
-         return temp->val;
-      walk = &(temp->next);
-   }
-   return NULL;
+   len = clampLength( val, len );
+   return _lookup( val, len, hashBytes( val, len ), caseSens );
+}
+
+//--------------------------------------
+StringTableEntry _StringTable::_lookup( const char *val, S32 len, U32 hash, bool caseSens )
+{
+   Shard &shard = _getShard( hash );
+
+   const U32 slot = _enterShard( shard );
+   Node *node = _find( shard.table, val, len, hash, caseSens );
+   _leaveShard( shard, slot );
+
+   // Strings live in the mempool for the lifetime of the table so the
+   // entry stays valid after we have left the shard.
+   return node ? node->val : NULL;
 }
 
 //--------------------------------------
 void _StringTable::resize(const U32 newSize)
 {
-   Node *head = NULL, *walk, *temp;
-   U32 i;
-   // reverse individual bucket lists
-   // we do this because new strings are added at the end of bucket
-   // lists so that case sens strings are always after their
-   // corresponding case insens strings
+   const U32 shardSize = getMax( newSize / NumShards, csm_stInitSize );
+   for( U32 i = 0; i < NumShards; i++ )
+   {
+      Shard &shard = mShards[ i ];
+      shard.mutex.lock();
+      _resizeShard( shard, shardSize );
+      shard.mutex.unlock();
+   }
+}
 
-   for(i = 0; i < numBuckets; i++) {
-      walk = buckets[i];
-      while(walk)
+//--------------------------------------
+void _StringTable::_resizeShard( Shard &shard, U32 newSize )
+{
+   // Readers may be walking the current chains at any time, so we cannot relink
+   // nodes in place.  Build a fresh set of chains, keeping the relative order
+   // within each bucket, and swap the whole table in once it is complete.
+   // The caller holds the shard lock.
+
+   Table *oldTable = shard.table;
+   Table *newTable = _createTable( newSize );
+   Node **tails = ( Node** ) dMalloc( newSize * sizeof( Node* ) );
+   dMemset( tails, 0, newSize * sizeof( Node* ) );
+
+   for( U32 i = 0; i < oldTable->numBuckets; i++ )
+   {
+      for( Node *walk = oldTable->buckets[ i ]; walk; walk = walk->next )
       {
-         temp = walk->next;
-         walk->next = head;
-         head = walk;
-         walk = temp;
+         Node *node = _allocNode( shard );
+         node->val = walk->val;
+         node->hash = walk->hash;
+         node->len = walk->len;
+         node->next = NULL;
+
+         const U32 index = walk->hash % newSize;
+         if( tails[ index ] )
+            tails[ index ]->next = node;
+         else
+            newTable->buckets[ index ] = node;
+         tails[ index ] = node;
       }
    }
-   buckets = (Node **) dRealloc(buckets, newSize * sizeof(Node));
-   for(i = 0; i < newSize; i++) {
-      buckets[i] = 0;
+
+   dFree( tails );
+
+   dCompareAndSwap( shard.table, oldTable, newTable );
+
+   // Readers entering from now on register in the other slot.  Wait for the
+   // ones that may still be walking the old table to leave before recycling
+   // its nodes.
+   const U32 oldSlot = shard.epoch & 1;
+   dFetchAndAdd( shard.epoch, 1 );
+   while( shard.numReaders[ oldSlot ] )
+      Platform::sleep( 0 );
+
+   for( U32 i = 0; i < oldTable->numBuckets; i++ )
+   {
+      Node *walk = oldTable->buckets[ i ];
+      while( walk )
+      {
+         Node *next = walk->next;
+         walk->next = shard.freeNodes;
+         shard.freeNodes = walk;
+         walk = next;
+      }
    }
-   numBuckets = newSize;
-   walk = head;
-   while(walk) {
-      U32 key;
-      Node *temp = walk;
 
-      walk = walk->next;
-      key = hashString(temp->val);
-      temp->next = buckets[key % newSize];
-      buckets[key % newSize] = temp;
+   shard.memUsage += ( S32( newSize ) - S32( oldTable->numBuckets ) ) * sizeof( Node* );
+
+   dFree( ( void* ) oldTable->buckets );
+   delete oldTable;
+}
+
+//--------------------------------------
+void _StringTable::getStats( Stats &outStats )
+{
+   dMemset( &outStats, 0, sizeof( outStats ) );
+
+   U32 totalProbes = 0;
+   for( U32 i = 0; i < NumShards; i++ )
+   {
+      Shard &shard = mShards[ i ];
+      shard.mutex.lock();
+
+      Table *table = shard.table;
+      for( U32 n = 0; n < table->numBuckets; n++ )
+      {
+         U32 chainLength = 0;
+         for( Node *walk = table->buckets[ n ]; walk; walk = walk->next )
+         {
+            chainLength ++;
+            totalProbes += chainLength;
+         }
+
+         if( !chainLength )
+            outStats.numEmptyBuckets ++;
+         outStats.maxChainLength = getMax( outStats.maxChainLength, chainLength );
+      }
+
+      outStats.numItems += shard.itemCount;
+      outStats.numBuckets += table->numBuckets;
+      outStats.memUsage += shard.memUsage;
+
+      shard.mutex.unlock();
    }
+
+   if( outStats.numItems )
+      outStats.avgProbeLength = F32( totalProbes ) / F32( outStats.numItems );
 }
 
+//--------------------------------------
+void _StringTable::dumpStats()
+{
+   Stats stats;
+   getStats( stats );
+
+   Con::printf( "StringTable: %i strings in %i shards", stats.numItems, NumShards );
+   Con::printf( "   buckets: %i (%i empty), longest chain: %i, avg probe: %.2f",
+      stats.numBuckets, stats.numEmptyBuckets, stats.maxChainLength, stats.avgProbeLength );
+   Con::printf( "   memory: %i bytes", stats.memUsage );
+}
+
+ConsoleFunction( dumpStringTableStats, void, 1, 1, "Print memory and probe statistics of the global string table." )
+{
+   TORQUE_UNUSED( argc ); TORQUE_UNUSED( argv );
+   StringTable->dumpStats();
+}
@@ -12,6 +12,9 @@
 #ifndef _DATACHUNKER_H_
 #include "core/dataChunker.h"
 #endif
+#ifndef _PLATFORM_THREADS_MUTEX_H_
+#include "platform/threads/mutex.h"
+#endif
 
 
 //--------------------------------------
@@ -53,6 +56,10 @@
 ///  The scripting engine and the resource manager are the primary users of the
 ///  StringTable.
 ///
+/// The table is split into independently locked shards so that worker threads
+/// (resource loading, shader generation) can intern strings concurrently.
+/// Lookups of strings that are already in the table never take a lock.
+///
 /// @note Be aware that the StringTable NEVER DEALLOCATES memory, so be careful when you
 ///       add strings to it. If you carelessly add many strings, you will end up wasting
 ///       space.
@@ -63,16 +70,62 @@ private:
    /// @{
 
    /// This is internal to the _StringTable class.
+   ///
+   /// Nodes are immutable once they have been linked into a chain so that
+   /// lookups can walk chains without taking the shard lock.
    struct Node
    {
       char *val;
-      Node *next;
+      U32 hash;
+      U32 len;
+      Node * volatile next;
+   };
+
+   /// Bucket array of a single shard.  When a shard grows, a new Table is
+   /// built and published; the old one and its nodes are recycled once all
+   /// readers that may have seen it have left the shard.
+   struct Table
+   {
+      Node * volatile * buckets;
+      U32 numBuckets;
+   };
+
+   /// An independently locked partition of the string table.  The shard for
+   /// a string is selected from the upper bits of its hash.
+   ///
+   /// Lock-free readers register in the reader slot of the current epoch.
+   /// A resize advances the epoch and waits for the old slot to drain before
+   /// it recycles the previous table.
+   struct Shard
+   {
+      Table * volatile table;
+      volatile U32 epoch;
+      volatile U32 numReaders[ 2 ];
+      Node       *freeNodes;
+      U32         itemCount;
+      U32         memUsage;
+      DataChunker mempool;
+      Mutex       mutex;
+   };
+
+   enum
+   {
+      ShardBits = 4,
+      NumShards = 1 << ShardBits
    };
 
-   Node**      buckets;
-   U32         numBuckets;
-   U32         itemCount;
-   DataChunker mempool;
+   Shard mShards[ NumShards ];
+
+   Shard& _getShard( U32 hash ) { return mShards[ hash >> ( 32 - ShardBits ) ]; }
+
+   static Table* _createTable( U32 numBuckets );
+   static U32 _enterShard( Shard &shard );
+   static void _leaveShard( Shard &shard, U32 slot );
+   static Node* _allocNode( Shard &shard );
+   static Node* _find( Table *table, const char *val, S32 len, U32 hash, bool caseSens );
+   StringTableEntry _lookup( const char *val, S32 len, U32 hash, bool caseSens );
+   StringTableEntry _insert( const char *val, S32 len, U32 hash, bool caseSens );
+   void _resizeShard( Shard &shard, U32 newSize );
 
   protected:
    static const U32 csm_stInitSize;
@@ -83,6 +136,17 @@ private:
    /// @}
   public:
 
+   /// Statistics gathered by getStats().
+   struct Stats
+   {
+      U32 numItems;        ///< Number of unique strings in the table.
+      U32 numBuckets;      ///< Total number of buckets over all shards.
+      U32 numEmptyBuckets; ///< Buckets without any entries.
+      U32 maxChainLength;  ///< Length of the longest bucket chain.
+      F32 avgProbeLength;  ///< Average number of nodes visited by a successful lookup.
+      U32 memUsage;        ///< Bytes allocated for nodes, strings and bucket arrays.
+   };
+
    /// Initialize StringTable.
    ///
    /// This is called at program start to initialize the StringTable global.
@@ -96,6 +160,8 @@ private:
    /// Get a pointer from the string table, adding the string to the table
    /// if it was not already present.
    ///
+   /// This method may be called from any thread.
+   ///
    /// @param  string   String to check in the table (and add).
    /// @param  caseSens Determines whether case matters.
    StringTableEntry insert(const char *string, bool caseSens = false);
@@ -103,6 +169,8 @@ private:
    /// Get a pointer from the string table, adding the string to the table
    /// if it was not already present.
    ///
+   /// This method may be called from any thread.
+   ///
    /// @param  string   String to check in the table (and add).
    /// @param  len      Length of the string in bytes.
    /// @param  caseSens Determines whether case matters.
@@ -111,6 +179,8 @@ private:
    /// Get a pointer from the string table, NOT adding the string to the table
    /// if it was not already present.
    ///
+   /// This method may be called from any thread and does not lock.
+   ///
    /// @param  string   String to check in the table (but not add).
    /// @param  caseSens Determines whether case matters.
    StringTableEntry lookup(const char *string, bool caseSens = false);
@@ -118,6 +188,8 @@ private:
    /// Get a pointer from the string table, NOT adding the string to the table
    /// if it was not already present.
    ///
+   /// This method may be called from any thread and does not lock.
+   ///
    /// @param  string   String to check in the table (but not add).
    /// @param  len      Length of string in bytes.
    /// @param  caseSens Determines whether case matters.
@@ -131,7 +203,15 @@ private:
    /// @param newSize   Number of new items to allocate space for.
    void             resize(const U32 newSize);
 
+   /// Gather memory and probe statistics over all shards.
+   void getStats( Stats &outStats );
+
+   /// Print the statistics returned by getStats() to the console.
+   void dumpStats();
+
    /// Hash a string into a U32.
+   ///
+   /// The hash is case-insensitive and processes the string a word at a time.
    static U32 hashString(const char* in_pString);
 
    /// Hash a string of given length into a U32.
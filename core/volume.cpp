@@ -947,6 +947,73 @@ bool ReadFile(const Path &inPath, void *&outData, U32 &outSize, bool inNullTermi
    return true;
 }
 
+//-----------------------------------------------------------------------------
+
+FileView::FileView()
+   : mMapHandle( NULL ),
+     mBuffer( NULL ),
+     mData( NULL ),
+     mSize( 0 )
+{
+}
+
+FileView::~FileView()
+{
+   close();
+}
+
+bool FileView::open(const Path &inPath)
+{
+   close();
+
+   FileNode::Attributes attr;
+   if ( !GetFileAttributes( inPath, &attr ) || attr.size == 0 )
+      return false;
+
+   // Try mapping the backing file directly.  Volumes that don't live on
+   // the native file system (zips) hand back a path that either doesn't
+   // exist natively or shadows a different file, so verify the size.
+   Path fsPath;
+   if ( GetFSPath( inPath, fsPath ) )
+   {
+      const void *data;
+      U32 size;
+      mMapHandle = Platform::mapFile( fsPath.getFullPath(), data, size );
+      if ( mMapHandle && size == attr.size )
+      {
+         mData = static_cast<const U8*>( data );
+         mSize = size;
+         return true;
+      }
+
+      Platform::unmapFile( mMapHandle );
+      mMapHandle = NULL;
+   }
+
+   U32 size;
+   if ( !ReadFile( inPath, mBuffer, size ) || !mBuffer )
+      return false;
+
+   mData = static_cast<const U8*>( mBuffer );
+   mSize = size;
+   return true;
+}
+
+void FileView::close()
+{
+   if ( mMapHandle )
+      Platform::unmapFile( mMapHandle );
+
+   delete [] static_cast<char*>( mBuffer );
+
+   mMapHandle = NULL;
+   mBuffer = NULL;
+   mData = NULL;
+   mSize = 0;
+}
+
+//-----------------------------------------------------------------------------
+
 DirectoryRef OpenDirectory(const Path &path)
 {
    return sgMountSystem.openDirectory(path);
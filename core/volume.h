@@ -508,6 +508,43 @@ FileRef OpenFile(const Path &file, File::AccessMode mode);
 ///@return successful read?  If not, outData will be NULL and outSize will be 0
 bool  ReadFile(const Path &inPath, void *&outData, U32 &outSize, bool inNullTerminate = false );
 
+/// A read-only view of the entire contents of a file.
+///
+/// Files which live on a native volume are memory mapped so that the
+/// contents are paged in on demand and never copied.  Files on other
+/// volumes (zips, memory) fall back to ReadFile() into a heap buffer,
+/// so callers can always treat the data as one contiguous block.
+///@ingroup VolumeSystem
+class FileView
+{
+public:
+   FileView();
+   ~FileView();
+
+   /// Open a view of the file, closing any previous view.
+   ///@return false if the file does not exist or is empty
+   bool open(const Path &inPath);
+
+   /// Release the view.  Any pointers into the data become invalid.
+   void close();
+
+   const U8* getData() const { return mData; }
+   U32 getSize() const { return mSize; }
+
+   /// Returns true if the data is memory mapped rather than copied.
+   bool isMapped() const { return mMapHandle != NULL; }
+
+private:
+   // Not copyable.
+   FileView( const FileView& );
+   FileView& operator=( const FileView& );
+
+   void *mMapHandle;
+   void *mBuffer;
+   const U8 *mData;
+   U32 mSize;
+};
+
 /// Open a directory.
 /// If the directory exists a directory object will be returned even if the
 /// open operation fails.
@@ -16,6 +16,9 @@
 #include "gfx/D3D9/gfxD3D9QueryFence.h"
 #include "gfx/D3D9/gfxD3D9OcclusionQuery.h"
 #include "gfx/D3D9/gfxD3D9Shader.h"
+#include "gfx/gfxShaderCache.h"
+#include "gfx/genericConstBuffer.h"
+#include "core/util/safeDelete.h"
 #include "windowManager/platformWindow.h"
 #ifndef TORQUE_OS_XENON
 #  include "windowManager/win32/win32Window.h"
@@ -35,6 +38,7 @@ GFXD3D9Device::GFXD3D9Device( LPDIRECT3D9 d3d, U32 index )
    mD3DDevice = NULL;
    mCurrentOpenAllocVB = NULL;
    mCurrentVB = NULL;
+   mCurrentInstanceVB = NULL;
 
    mCurrentOpenAllocPB = NULL;
    mCurrentPB = NULL;
@@ -68,21 +72,40 @@ GFXD3D9Device::GFXD3D9Device( LPDIRECT3D9 d3d, U32 index )
 
    mCurrentConstBuffer = NULL;
 
+   // Sized for shader model 3, which has 256 float and 16 integer
+   // vector registers for vertex shaders and fewer for pixel shaders.
+   mVertexConstShadowF = new GenericConstBufferShadow( 256 * sizeof( Point4F ) );
+   mPixelConstShadowF = new GenericConstBufferShadow( 256 * sizeof( Point4F ) );
+   mVertexConstShadowI = new GenericConstBufferShadow( 16 * sizeof( Point4I ) );
+   mPixelConstShadowI = new GenericConstBufferShadow( 16 * sizeof( Point4I ) );
+
    mOcclusionQuerySupported = false;
 
    // Set up the Enum translation tables
    GFXD3D9EnumTranslate::init();
+
+   // Let the shader cache compile HLSL on worker threads.
+   GFXShaderCache::setPrecompiler( GFXShaderCache::PrecompileDelegate( &GFXD3D9Shader::_precompile ) );
 }
 
 //-----------------------------------------------------------------------------
 
 GFXD3D9Device::~GFXD3D9Device() 
 {
+   // The warm up compiles with D3DX so it has to finish first.
+   GFXShaderCache::stopWarmUp();
+   GFXShaderCache::setPrecompiler( GFXShaderCache::PrecompileDelegate() );
+
    // Release our refcount on the current stateblock object
    mCurrentStateBlock = NULL;
 
    releaseDefaultPoolResources();
 
+   SAFE_DELETE( mVertexConstShadowF );
+   SAFE_DELETE( mPixelConstShadowF );
+   SAFE_DELETE( mVertexConstShadowI );
+   SAFE_DELETE( mPixelConstShadowI );
+
    // Free the vertex declarations.
    VertexDeclMap::Iterator iter = mVertexDecls.begin();
    for ( ; iter != mVertexDecls.end(); iter++ )
@@ -385,6 +408,12 @@ void GFXD3D9Device::releaseDefaultPoolResources()
    mCurrentVertexBuffer = NULL;
    mVertexBufferDirty = true;
 
+   // The instance stream is usually volatile... drop it too.
+   mCurrentInstanceBuffer = NULL;
+   mInstanceCount = 0;
+   mCurrentInstanceVB = NULL;
+   mInstanceBufferDirty = true;
+
    // Release dynamic index buffer
    if( mDynamicPB != NULL )
    {
@@ -408,6 +437,14 @@ void GFXD3D9Device::releaseDefaultPoolResources()
    // Set global dirty state so the IB/PB and VB get reset
    mStateDirty = true;
 
+   // The reset clears the shader constants, so the next const
+   // buffer must upload everything.
+   mCurrentConstBuffer = NULL;
+   mVertexConstShadowF->invalidate();
+   mPixelConstShadowF->invalidate();
+   mVertexConstShadowI->invalidate();
+   mPixelConstShadowI->invalidate();
+
    // Walk the resource list and zombify everything.
    GFXResource *walk = mResourceListHead;
    while(walk)
@@ -548,12 +585,67 @@ void GFXD3D9Device::setVB( GFXVertexBuffer *buffer )
 
    mCurrentVB = static_cast<GFXD3D9VertexBuffer *>( buffer );
 
-   D3D9Assert( mD3DDevice->SetVertexDeclaration( mCurrentVB->decl ), "Failed to set vertex declaration" );
+   _setVertexDecl();
    D3D9Assert( mD3DDevice->SetStreamSource( 0, mCurrentVB->vb, 0, mCurrentVB->mVertexSize ), "Failed to set stream source" );
 }
 
 //-----------------------------------------------------------------------------
 
+bool GFXD3D9Device::supportsInstancing() const
+{
+#ifdef TORQUE_OS_XENON
+   return false;
+#else
+   // Stream frequency instancing is only guaranteed on SM 3.0 hardware.
+   return getPixelShaderVersion() >= 3.0f;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// This function should ONLY be called from GFXDevice::updateStates() !!!
+//-----------------------------------------------------------------------------
+void GFXD3D9Device::setInstanceBufferInternal( GFXVertexBuffer *buffer, U32 instanceCount )
+{
+#ifndef TORQUE_OS_XENON
+   mCurrentInstanceVB = static_cast<GFXD3D9VertexBuffer*>( buffer );
+
+   if ( mCurrentInstanceVB )
+   {
+      AssertFatal( mCurrentOpenAllocVB != mCurrentInstanceVB, "GFXD3D9Device::setInstanceBufferInternal - The instance buffer is still open for editing!" );
+
+      // Volatile buffers are sub-allocated from a shared buffer, so
+      // offset the stream to the start of our instances.
+      const U32 offset = mCurrentInstanceVB->mVolatileStart * mCurrentInstanceVB->mVertexSize;
+
+      D3D9Assert( mD3DDevice->SetStreamSource( 1, mCurrentInstanceVB->vb, offset, mCurrentInstanceVB->mVertexSize ), "Failed to set instance stream source" );
+      D3D9Assert( mD3DDevice->SetStreamSourceFreq( 0, D3DSTREAMSOURCE_INDEXEDDATA | instanceCount ), "Failed to set geometry stream frequency" );
+      D3D9Assert( mD3DDevice->SetStreamSourceFreq( 1, D3DSTREAMSOURCE_INSTANCEDATA | 1 ), "Failed to set instance stream frequency" );
+   }
+   else
+   {
+      D3D9Assert( mD3DDevice->SetStreamSourceFreq( 0, 1 ), "Failed to reset geometry stream frequency" );
+      D3D9Assert( mD3DDevice->SetStreamSourceFreq( 1, 1 ), "Failed to reset instance stream frequency" );
+      D3D9Assert( mD3DDevice->SetStreamSource( 1, NULL, 0, 0 ), "Failed to clear instance stream source" );
+   }
+
+   if ( mCurrentVB )
+      _setVertexDecl();
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void GFXD3D9Device::_setVertexDecl()
+{
+   IDirect3DVertexDeclaration9 *decl = mCurrentVB->decl;
+   if ( mCurrentInstanceVB )
+      decl = _getInstancedVertexDecl( mCurrentVB->mVertexFormat, mCurrentInstanceVB->mVertexFormat );
+
+   D3D9Assert( mD3DDevice->SetVertexDeclaration( decl ), "Failed to set vertex declaration" );
+}
+
+//-----------------------------------------------------------------------------
+
 void GFXD3D9Device::_setPrimitiveBuffer( GFXPrimitiveBuffer *buffer ) 
 {
    AssertFatal( mCurrentOpenAllocPB == NULL, "Calling setIndexBuffer() when a index buffer is still open for editing" );
@@ -575,6 +667,7 @@ void GFXD3D9Device::drawPrimitive( GFXPrimitiveType primType, U32 vertexStart, U
 
    AssertFatal( mCurrentOpenAllocVB == NULL, "Calling drawPrimitive() when a vertex buffer is still open for editing" );
    AssertFatal( mCurrentVB != NULL, "Trying to call draw primitive with no current vertex buffer, call setVertexBuffer()" );
+   AssertFatal( mInstanceCount == 0, "Instancing is only supported with indexed primitives, call drawIndexedPrimitive()" );
 
    D3D9Assert( mD3DDevice->DrawPrimitive( GFXD3D9PrimType[primType], mCurrentVB->mVolatileStart + vertexStart, primitiveCount ), "Failed to draw primitives" );  
    mDeviceStatistics.mDrawCalls++;
@@ -610,7 +703,7 @@ void GFXD3D9Device::drawIndexedPrimitive( GFXPrimitiveType primType,
       primitiveCount ), "Failed to draw indexed primitive" );
 
    mDeviceStatistics.mDrawCalls++;
-   mDeviceStatistics.mPolyCount += primitiveCount;
+   mDeviceStatistics.mPolyCount += primitiveCount * getMax( mInstanceCount, (U32)1 );
 }
 
 GFXShader* GFXD3D9Device::createShader()
@@ -780,31 +873,17 @@ void GFXD3D9Device::deallocVertexBuffer( GFXD3D9VertexBuffer *vertBuff )
    SAFE_RELEASE(vertBuff->vb);
 }
 
-void GFXD3D9Device::allocVertexDecl( GFXD3D9VertexBuffer *vertBuff )
+/// Fills in the D3D declaration elements for a vertex format
+/// reading from the given stream.  Returns the element count.
+static U32 _fillVertexElements( const GFXVertexFormat *vertexFormat, WORD stream, D3DVERTEXELEMENT9 *vd )
 {
-   PROFILE_SCOPE( GFXD3D9Device_AllocVertexDecl );
-
-   if ( vertBuff->decl )
-      return;
-
-   const GFXVertexFormat *vertexFormat = vertBuff->mVertexFormat;
-
-   // First check the map... you shouldn't allocate VBs very often
-   // if you want performance.  The map lookup should never become
-   // a performance bottleneck.
-   vertBuff->decl = mVertexDecls[vertexFormat->getDescription()];
-   if ( vertBuff->decl )
-      return;
-
-   // Setup the declaration struct.
    U32 elemCount = vertexFormat->getElementCount();
    U32 offset = 0;
-   D3DVERTEXELEMENT9 *vd = new D3DVERTEXELEMENT9[ elemCount + 1 ];
    for ( U32 i=0; i < elemCount; i++ )
    {
       const GFXVertexElement &element = vertexFormat->getElement( i );
 
-      vd[i].Stream = 0;
+      vd[i].Stream = stream;
       vd[i].Offset = offset;
       vd[i].Type = GFXD3D9DeclType[element.getType()];
       vd[i].Method = D3DDECLMETHOD_DEFAULT;
@@ -833,6 +912,30 @@ void GFXD3D9Device::allocVertexDecl( GFXD3D9VertexBuffer *vertBuff )
       offset += element.getSizeInBytes();
    }
 
+   return elemCount;
+}
+
+void GFXD3D9Device::allocVertexDecl( GFXD3D9VertexBuffer *vertBuff )
+{
+   PROFILE_SCOPE( GFXD3D9Device_AllocVertexDecl );
+
+   if ( vertBuff->decl )
+      return;
+
+   const GFXVertexFormat *vertexFormat = vertBuff->mVertexFormat;
+
+   // First check the map... you shouldn't allocate VBs very often
+   // if you want performance.  The map lookup should never become
+   // a performance bottleneck.
+   vertBuff->decl = mVertexDecls[vertexFormat->getDescription()];
+   if ( vertBuff->decl )
+      return;
+
+   // Setup the declaration struct.
+   U32 elemCount = vertexFormat->getElementCount();
+   D3DVERTEXELEMENT9 *vd = new D3DVERTEXELEMENT9[ elemCount + 1 ];
+   _fillVertexElements( vertexFormat, 0, vd );
+
    D3DVERTEXELEMENT9 declEnd = D3DDECL_END();
    vd[elemCount] = declEnd;
 
@@ -845,6 +948,35 @@ void GFXD3D9Device::allocVertexDecl( GFXD3D9VertexBuffer *vertBuff )
    mVertexDecls[vertexFormat->getDescription()] = vertBuff->decl;
 }
 
+IDirect3DVertexDeclaration9* GFXD3D9Device::_getInstancedVertexDecl(   const GFXVertexFormat *vertexFormat,
+                                                                     const GFXVertexFormat *instanceFormat )
+{
+   PROFILE_SCOPE( GFXD3D9Device_GetInstancedVertexDecl );
+
+   // The combined declarations live in the same cache as
+   // the regular ones and are released with them.
+   const String key = vertexFormat->getDescription() + "|" + instanceFormat->getDescription();
+   IDirect3DVertexDeclaration9 *&decl = mVertexDecls[key];
+   if ( decl )
+      return decl;
+
+   U32 vertCount = vertexFormat->getElementCount();
+   U32 instCount = instanceFormat->getElementCount();
+   D3DVERTEXELEMENT9 *vd = new D3DVERTEXELEMENT9[ vertCount + instCount + 1 ];
+   _fillVertexElements( vertexFormat, 0, vd );
+   _fillVertexElements( instanceFormat, 1, vd + vertCount );
+
+   D3DVERTEXELEMENT9 declEnd = D3DDECL_END();
+   vd[vertCount + instCount] = declEnd;
+
+   D3D9Assert( mD3DDevice->CreateVertexDeclaration( vd, &decl ), 
+      "GFXD3D9Device::_getInstancedVertexDecl - Failed to create vertex declaration!" );
+
+   delete[] vd;
+
+   return decl;
+}
+
 //-----------------------------------------------------------------------------
 // This function should ONLY be called from GFXDevice::updateStates() !!!
 //-----------------------------------------------------------------------------
@@ -68,6 +68,7 @@ struct D3DXFNTable
 #define GFXD3DX static_cast<GFXD3D9Device *>(GFX)->smD3DX 
 
 class GFXResource;
+class GenericConstBufferShadow;
 class GFXD3D9ShaderConstBuffer;
 
 //------------------------------------------------------------------------------
@@ -102,6 +103,10 @@ protected:
 
    GFXD3D9VertexBuffer *mCurrentOpenAllocVB;
    GFXD3D9VertexBuffer *mCurrentVB;
+
+   /// The per-instance stream bound to stream 1.
+   /// @see setInstanceBufferInternal
+   GFXD3D9VertexBuffer *mCurrentInstanceVB;
    void *mCurrentOpenAllocVertexData;
 
    static void initD3DXFnTable();
@@ -169,6 +174,17 @@ protected:
    /// Track the last const buffer we've used.  Used to notify new constant buffers that
    /// they should send all of their constants up
    StrongRefPtr<GFXD3D9ShaderConstBuffer> mCurrentConstBuffer;
+
+   /// @name Shader Constant Shadows
+   /// Copies of the constant registers on the device, so that switching
+   /// const buffers only uploads the constants which actually differ.
+   /// @{
+   GenericConstBufferShadow *mVertexConstShadowF;
+   GenericConstBufferShadow *mPixelConstShadowF;
+   GenericConstBufferShadow *mVertexConstShadowI;
+   GenericConstBufferShadow *mPixelConstShadowI;
+   /// @}
+
    /// Called by base GFXDevice to actually set a const buffer
    virtual void setShaderConstBufferInternal(GFXShaderConstBuffer* buffer);
 
@@ -248,6 +264,11 @@ public:
    // {
    void setVB( GFXVertexBuffer *buffer );
 
+   virtual bool supportsInstancing() const;
+
+   /// Called by base GFXDevice to bind the per-instance stream.
+   virtual void setInstanceBufferInternal( GFXVertexBuffer *buffer, U32 instanceCount );
+
    virtual GFXVertexBuffer* allocVertexBuffer(  U32 numVerts, 
                                                 const GFXVertexFormat *vertexFormat,
                                                 U32 vertSize,
@@ -256,6 +277,15 @@ public:
    virtual void deallocVertexBuffer( GFXD3D9VertexBuffer *vertBuff );
 
    void allocVertexDecl( GFXD3D9VertexBuffer *vertBuff );
+
+   /// Returns the cached declaration which reads the vertex format
+   /// from stream 0 and the instance format from stream 1.
+   IDirect3DVertexDeclaration9* _getInstancedVertexDecl(  const GFXVertexFormat *vertexFormat,
+                                                         const GFXVertexFormat *instanceFormat );
+
+   /// Sets the declaration for the current vertex buffer and
+   /// instance stream.
+   void _setVertexDecl();
    // }
 
    virtual U32 getMaxDynamicVerts() { return MAX_DYNAMIC_VERTS; }
@@ -267,6 +297,14 @@ public:
    // }
 
    virtual LPDIRECT3DDEVICE9 getDevice(){ return mD3DDevice; }
+
+   /// @name Shader Constant Shadows
+   /// @{
+   GenericConstBufferShadow* getVertexConstShadowF() { return mVertexConstShadowF; }
+   GenericConstBufferShadow* getPixelConstShadowF() { return mPixelConstShadowF; }
+   GenericConstBufferShadow* getVertexConstShadowI() { return mVertexConstShadowI; }
+   GenericConstBufferShadow* getPixelConstShadowI() { return mPixelConstShadowI; }
+   /// @}
    virtual LPDIRECT3D9 getD3D() { return mD3D; }
 
    /// Reset
@@ -6,8 +6,10 @@
 #include "gfx/D3D9/gfxD3D9Shader.h"
 #include "gfx/D3D9/gfxD3D9Device.h"
 
+#include "gfx/gfxShaderCache.h"
 #include "core/frameAllocator.h"
 #include "core/stream/fileStream.h"
+#include "core/util/hashFunction.h"
 #include "core/util/safeDelete.h"
 #include "console/console.h"
 
@@ -21,11 +23,32 @@ private:
    dsize_t mIncludeDataSize;
    Torque::Path mIncludeFileName;
 
+   /// The include data loaded during the current compile.
+   Vector<U8*> mAllocs;
+
+   /// The files included during the current compile.
+   Vector<GFXShaderCache::Dependency> mDependencies;
+
 public:
    Torque::Path   _pShaderFile;
 
-   _gfxD3DXInclude() : mIncludeData( NULL ), mIncludeDataSize( 0 ) {}
-   ~_gfxD3DXInclude() { /*SAFE_DELETE_ARRAY( mIncludeData );*/ }
+   /// If true a missing include fails the compile without asserting.
+   bool mQuiet;
+
+   _gfxD3DXInclude() : mIncludeData( NULL ), mIncludeDataSize( 0 ), mQuiet( false ) {}
+   ~_gfxD3DXInclude() { reset(); }
+
+   /// Returns the files included since the last reset.
+   const Vector<GFXShaderCache::Dependency>& getDependencies() const { return mDependencies; }
+
+   /// Frees the include data from the last compile.
+   void reset()
+   {
+      for ( U32 i=0; i < mAllocs.size(); i++ )
+         delete [] mAllocs[i];
+      mAllocs.clear();
+      mDependencies.clear();
+   }
 
    STDMETHOD(Close)(THIS_ LPCVOID pData);
 
@@ -40,7 +63,6 @@ public:
 };
 
 _gfxD3DXIncludeRef GFXD3D9Shader::smD3DXInclude = NULL;
-Vector<U8*> gIncludeAllocs( __FILE__, __LINE__ );
 
 HRESULT _gfxD3DXInclude::Open(THIS_ D3DXINCLUDE_TYPE IncludeType, LPCSTR pFileName, 
                               LPCVOID pParentData, LPCVOID *ppData, UINT *pBytes, 
@@ -58,14 +80,20 @@ HRESULT _gfxD3DXInclude::Open(THIS_ D3DXINCLUDE_TYPE IncludeType, LPCSTR pFileNa
 
       if ( !Torque::FS::ReadFile( path, (void *&)mIncludeData, mIncludeDataSize, true ) )
       {
-         AssertISV(false, avar( "Failed to open include '%s'.", pFileName));
+         AssertISV(mQuiet, avar( "Failed to open include '%s'.", pFileName));
          return E_FAIL;
       }
    }
 
    mIncludeFileName = path;
 
-   gIncludeAllocs.push_back(mIncludeData);
+   mAllocs.push_back(mIncludeData);
+
+   // Remember it so the shader cache can tell when it changes.
+   mDependencies.increment();
+   GFXShaderCache::Dependency &dep = mDependencies.last();
+   dep.path = path;
+   dep.hash = Torque::hash64( mIncludeData, mIncludeDataSize, 0 );
 
    *pBytes = mIncludeDataSize;
    *ppData = mIncludeData;
@@ -396,40 +424,39 @@ bool GFXD3D9ShaderConstBuffer::isDirty()
    if (mVertexConstBufferF)
       ret |= mVertexConstBufferF->isDirty();
    if (mVertexConstBufferI)
-      ret |= mVertexConstBufferF->isDirty();
+      ret |= mVertexConstBufferI->isDirty();
    if (mPixelConstBufferF)
       ret |= mPixelConstBufferF->isDirty();
    if (mPixelConstBufferI)
-      ret |= mPixelConstBufferF->isDirty();
+      ret |= mPixelConstBufferI->isDirty();
    return ret;
 }
 
 void GFXD3D9ShaderConstBuffer::activate(GFXD3D9ShaderConstBuffer* mPrevShaderBuffer)
 {
    PROFILE_SCOPE(GFXD3D9ShaderConstBuffer_activate);
-   // Ok, check for equal buffers, this can happen with materials that differ only by base texture
-   // and other fun cases.
+
+   GFXD3D9Device *device = static_cast<GFXD3D9Device *>(GFX);
+   GFXDeviceStatistics *stats = device->getDeviceStatistics();
+
+   // Another buffer may have overwritten our registers since we were last
+   // active, so compare our fields against what is really on the device.  This
+   // also catches materials that differ only by base texture and other fun cases.
    if (mPrevShaderBuffer != this)
    {
-      // If the previous buffer is dirty, than we can't compare against it, because it hasn't
-      // sent its contents to the card yet
-      if (mPrevShaderBuffer && (!mPrevShaderBuffer->isDirty()))
-      {
-         PROFILE_SCOPE(GFXD3D9ShaderConstBuffer_activate_dirty_check_1);
-         mVertexConstBufferF->setDirty(!mPrevShaderBuffer->mVertexConstBufferF->isEqual(mVertexConstBufferF));
-         mPixelConstBufferF->setDirty(!mPrevShaderBuffer->mPixelConstBufferF->isEqual(mPixelConstBufferF));
-         mVertexConstBufferI->setDirty(!mPrevShaderBuffer->mVertexConstBufferF->isEqual(mVertexConstBufferI));
-         mPixelConstBufferI->setDirty(!mPrevShaderBuffer->mPixelConstBufferF->isEqual(mPixelConstBufferI));
-      } else {
-         PROFILE_SCOPE(GFXD3D9ShaderConstBuffer_activate_dirty_check_2);
-         mVertexConstBufferF->setDirty(true);
-         mPixelConstBufferF->setDirty(true);
-         mVertexConstBufferI->setDirty(true);
-         mPixelConstBufferI->setDirty(true);
-      }      
+      PROFILE_SCOPE(GFXD3D9ShaderConstBuffer_activate_dirty_check);
+      mVertexConstBufferF->setDirtyFromShadow(*device->getVertexConstShadowF());
+      mPixelConstBufferF->setDirtyFromShadow(*device->getPixelConstShadowF());
+      mVertexConstBufferI->setDirtyFromShadow(*device->getVertexConstShadowI());
+      mPixelConstBufferI->setDirtyFromShadow(*device->getPixelConstShadowI());
    }
 
-   LPDIRECT3DDEVICE9 d = static_cast<GFXD3D9Device *>(GFX)->getDevice();
+   stats->mRedundantShaderConsts += mVertexConstBufferF->popRedundantCount();
+   stats->mRedundantShaderConsts += mPixelConstBufferF->popRedundantCount();
+   stats->mRedundantShaderConsts += mVertexConstBufferI->popRedundantCount();
+   stats->mRedundantShaderConsts += mPixelConstBufferI->popRedundantCount();
+
+   LPDIRECT3DDEVICE9 d = device->getDevice();
    // /16 is the number of float4 vectors
    const U32 bytesToFloat4 = 16;
    U32 start, bufferSize;      
@@ -437,34 +464,50 @@ void GFXD3D9ShaderConstBuffer::activate(GFXD3D9ShaderConstBuffer* mPrevShaderBuf
 
    if (mVertexConstBufferF->isDirty())
    {
+      stats->mShaderConstChanges += mVertexConstBufferF->getDirtyFieldCount();
       buf = mVertexConstBufferF->getDirtyBuffer(start, bufferSize);
       if (buf && bufferSize)
+      {
          d->SetVertexShaderConstantF(start / bytesToFloat4, (float*) buf, bufferSize / bytesToFloat4);
+         mVertexConstBufferF->updateShadow(*device->getVertexConstShadowF(), start, bufferSize);
+      }
       mVertexConstBufferF->setDirty(false);
    }
 
    if (mPixelConstBufferF->isDirty())    
    {
+      stats->mShaderConstChanges += mPixelConstBufferF->getDirtyFieldCount();
       buf = mPixelConstBufferF->getDirtyBuffer(start, bufferSize);
       if (buf && bufferSize)
+      {
          d->SetPixelShaderConstantF(start / bytesToFloat4, (float*) buf, bufferSize / bytesToFloat4);      
+         mPixelConstBufferF->updateShadow(*device->getPixelConstShadowF(), start, bufferSize);
+      }
       mPixelConstBufferF->setDirty(false);
    }
 
    const U32 bytesToInt4 = 16;
    if (mVertexConstBufferI->isDirty())
    {
+      stats->mShaderConstChanges += mVertexConstBufferI->getDirtyFieldCount();
       buf = mVertexConstBufferI->getDirtyBuffer(start, bufferSize);
       if (buf && bufferSize)
+      {
          d->SetVertexShaderConstantI(start / bytesToInt4, (int*) buf, bufferSize / bytesToInt4);
+         mVertexConstBufferI->updateShadow(*device->getVertexConstShadowI(), start, bufferSize);
+      }
       mVertexConstBufferI->setDirty(false);
    }
 
    if (mPixelConstBufferI->isDirty())    
    {
+      stats->mShaderConstChanges += mPixelConstBufferI->getDirtyFieldCount();
       buf = mPixelConstBufferI->getDirtyBuffer(start, bufferSize);
       if (buf && bufferSize)
+      {
          d->SetPixelShaderConstantI(start / bytesToInt4, (int*) buf, bufferSize / bytesToInt4);      
+         mPixelConstBufferI->updateShadow(*device->getPixelConstShadowI(), start, bufferSize);
+      }
       mPixelConstBufferI->setDirty(false);
    }
 }
@@ -547,42 +590,25 @@ bool GFXD3D9Shader::_init()
    SAFE_RELEASE(mVertShader);
    SAFE_RELEASE(mPixShader);
 
-   U32 mjVer = (U32)mFloor( mPixVersion );
-   U32 mnVer = (U32)( ( mPixVersion - F32( mjVer ) ) * 10.01f ); // 10.01 instead of 10.0 because of floating point issues
+   String vertTarget, pixTarget;
+   _getCompileTargets( mPixVersion, &vertTarget, &pixTarget );
 
-   String vertTarget = String::ToString("vs_%d_%d", mjVer, mnVer);
-   String pixTarget = String::ToString("ps_%d_%d", mjVer, mnVer);
+   // Create the macro array including the system wide macros.
+   Vector<GFXShaderMacro> macros;
+   macros.merge( smGlobalMacros );
+   macros.merge( mMacros );
 
-   // Adjust version for vertex shaders
-   if ( ( mPixVersion < 2.0f ) && ( mPixVersion > 1.101f ) )
-      vertTarget = "vs_1_1";      
+   Vector<GFXShaderMacro> allMacros;
+   _getCompileMacros( mPixVersion, macros, &allMacros );
 
-   // Create the macro array including the system wide macros.
-   const U32 macroCount = smGlobalMacros.size() + mMacros.size() + 3;
-   FrameTemp<D3DXMACRO> d3dXMacros( macroCount );
-   for ( U32 i=0; i < smGlobalMacros.size(); i++ )
+   FrameTemp<D3DXMACRO> d3dXMacros( allMacros.size() + 1 );
+   for ( U32 i=0; i < allMacros.size(); i++ )
    {
-      d3dXMacros[i].Name = smGlobalMacros[i].name.c_str();
-      d3dXMacros[i].Definition = smGlobalMacros[i].value.c_str();
+      d3dXMacros[i].Name = allMacros[i].name.c_str();
+      d3dXMacros[i].Definition = allMacros[i].value.c_str();
    }
-   for ( U32 i=0; i < mMacros.size(); i++ )
-   {
-      d3dXMacros[i+smGlobalMacros.size()].Name = mMacros[i].name.c_str();
-      d3dXMacros[i+smGlobalMacros.size()].Definition = mMacros[i].value.c_str();
-   }
-   String smVersion = String::ToString( mjVer * 10 + mnVer );
-   d3dXMacros[macroCount - 2].Name = "TORQUE_SM";
-   d3dXMacros[macroCount - 2].Definition = smVersion.c_str();
-   d3dXMacros[macroCount - 1].Name = NULL;
-   d3dXMacros[macroCount - 1].Definition = NULL;
-
-   // Provide HLSL shaders with an OS flag
-   d3dXMacros[macroCount - 3].Name = "TORQUE_OS_XENON";
-#ifdef TORQUE_OS_XENON
-   d3dXMacros[macroCount - 3].Definition = "1";
-#else
-   d3dXMacros[macroCount - 3].Definition = "0";
-#endif
+   d3dXMacros[allMacros.size()].Name = NULL;
+   d3dXMacros[allMacros.size()].Definition = NULL;
 
    if ( !mVertexConstBufferLayoutF )
       mVertexConstBufferLayoutF = new GFXD3D9ShaderBufferLayout();
@@ -661,19 +687,8 @@ bool GFXD3D9Shader::_init()
    return true;
 }
 
-bool GFXD3D9Shader::_compileShader( const Torque::Path &filePath, 
-                                    const String& target,                                  
-                                    const D3DXMACRO *defines, 
-                                    GenericConstBufferLayout* bufferLayoutF, 
-                                    GenericConstBufferLayout* bufferLayoutI,
-                                    Vector<GFXShaderConstDesc> &samplerDescriptions )
+U32 GFXD3D9Shader::_getCompileFlags( const String &target )
 {
-   PROFILE_SCOPE( GFXD3D9Shader_CompileShader );
-
-   HRESULT res = D3DERR_INVALIDCALL;
-   LPD3DXBUFFER code = NULL;
-   LPD3DXBUFFER errorBuff = NULL;
-
 #ifdef TORQUE_DEBUG
    U32 flags = D3DXSHADER_DEBUG;
 #else
@@ -701,6 +716,159 @@ bool GFXD3D9Shader::_compileShader( const Torque::Path &filePath,
 #error This version of the DirectX SDK is too old. Please install a newer version of the DirectX SDK: http://msdn.microsoft.com/en-us/directx/default.aspx
 #endif
 
+   return flags;
+}
+
+void GFXD3D9Shader::_getCompileTargets( F32 pixVersion, String *outVertTarget, String *outPixTarget )
+{
+   U32 mjVer = (U32)mFloor( pixVersion );
+   U32 mnVer = (U32)( ( pixVersion - F32( mjVer ) ) * 10.01f ); // 10.01 instead of 10.0 because of floating point issues
+
+   *outVertTarget = String::ToString("vs_%d_%d", mjVer, mnVer);
+   *outPixTarget = String::ToString("ps_%d_%d", mjVer, mnVer);
+
+   // Adjust version for vertex shaders
+   if ( ( pixVersion < 2.0f ) && ( pixVersion > 1.101f ) )
+      *outVertTarget = "vs_1_1";      
+}
+
+void GFXD3D9Shader::_getCompileMacros( F32 pixVersion, const Vector<GFXShaderMacro> &macros, Vector<GFXShaderMacro> *outMacros )
+{
+   U32 mjVer = (U32)mFloor( pixVersion );
+   U32 mnVer = (U32)( ( pixVersion - F32( mjVer ) ) * 10.01f );
+
+   outMacros->merge( macros );
+
+   // Provide HLSL shaders with an OS flag
+   outMacros->increment();
+   outMacros->last().name = "TORQUE_OS_XENON";
+#ifdef TORQUE_OS_XENON
+   outMacros->last().value = "1";
+#else
+   outMacros->last().value = "0";
+#endif
+
+   outMacros->increment();
+   outMacros->last().name = "TORQUE_SM";
+   outMacros->last().value = String::ToString( mjVer * 10 + mnVer );
+}
+
+HRESULT GFXD3D9Shader::_compileHLSL(   const char *source,
+                                       U32 sourceSize,
+                                       const String &target,
+                                       const D3DXMACRO *defines,
+                                       _gfxD3DXInclude *include,
+                                       LPD3DXBUFFER *outCode,
+                                       LPD3DXBUFFER *outErrors,
+                                       ID3DXConstantTable **outTable )
+{
+   const U32 flags = _getCompileFlags( target );
+
+   // Everything besides the source that changes the compiled code.
+   String description = String::ToString( "%s %x %d", target.c_str(), flags, D3DX_SDK_VERSION );
+   for ( const D3DXMACRO *macro = defines; macro && macro->Name; macro++ )
+      description += String::ToString( " %s=%s", macro->Name, macro->Definition ? macro->Definition : "" );
+
+   const U64 key = GFXShaderCache::computeKey( description, source, sourceSize );
+
+   Vector<U8> cached;
+   if ( GFXShaderCache::load( key, cached ) )
+   {
+      HRESULT res = GFXD3DX.D3DXCreateBuffer( cached.size(), outCode );
+      if ( res == D3D_OK )
+      {
+         dMemcpy( (*outCode)->GetBufferPointer(), cached.address(), cached.size() );
+
+         if ( outTable )
+            res = GFXD3DX.D3DXGetShaderConstantTable( (DWORD*)(*outCode)->GetBufferPointer(), outTable );
+
+         if ( res == D3D_OK )
+            return res;
+      }
+
+      // Something is wrong with the entry, so compile it again.
+      SAFE_RELEASE( *outCode );
+   }
+
+   HRESULT res = GFXD3DX.D3DXCompileShader( source, sourceSize, defines, include, "main", 
+      target, flags, outCode, outErrors, outTable );
+
+   if ( res == D3D_OK && *outCode )
+      GFXShaderCache::store( key, include->getDependencies(), (*outCode)->GetBufferPointer(), (*outCode)->GetBufferSize() );
+
+   // Wipe our allocations from this compile.
+   include->reset();
+
+   return res;
+}
+
+bool GFXD3D9Shader::_precompile( const Torque::Path &filePath, bool isVertex, F32 pixVersion, const Vector<GFXShaderMacro> &macros )
+{
+   PROFILE_SCOPE( GFXD3D9Shader_Precompile );
+
+   if ( !GFXD3DX.isLoaded || !filePath.getExtension().equal( "hlsl", String::NoCase ) )
+      return false;
+
+   String vertTarget, pixTarget;
+   _getCompileTargets( pixVersion, &vertTarget, &pixTarget );
+
+   Vector<GFXShaderMacro> allMacros;
+   _getCompileMacros( pixVersion, macros, &allMacros );
+
+   // The frame allocator isn't thread safe, so no FrameTemp here.
+   Vector<D3DXMACRO> d3dXMacros( allMacros.size() + 1 );
+   d3dXMacros.setSize( allMacros.size() + 1 );
+   for ( U32 i=0; i < allMacros.size(); i++ )
+   {
+      d3dXMacros[i].Name = allMacros[i].name.c_str();
+      d3dXMacros[i].Definition = allMacros[i].value.c_str();
+   }
+   d3dXMacros.last().Name = NULL;
+   d3dXMacros.last().Definition = NULL;
+
+   // This must build the exact same source as _compileShader
+   // or the key will never match.
+   void *data;
+   U32 size;
+   if ( !Torque::FS::ReadFile( filePath, data, size ) || !data )
+      return false;
+
+   Torque::Path realPath;
+   if ( !FS::GetFSPath( filePath, realPath ) )
+      realPath = filePath;
+
+   String source = String::ToString( "#line 1 \"%s\"\r\n", realPath.getFullPath().c_str() );
+   source += String( (const char*)data, size );
+   delete [] (char*)data;
+
+   // Each worker needs its own include handler.
+   _gfxD3DXInclude include;
+   include._pShaderFile = filePath;
+   include.mQuiet = true;
+
+   LPD3DXBUFFER code = NULL;
+   LPD3DXBUFFER errors = NULL;
+   HRESULT res = _compileHLSL( source.c_str(), source.length(), isVertex ? vertTarget : pixTarget, d3dXMacros.address(), &include, &code, &errors, NULL );
+
+   SAFE_RELEASE( code );
+   SAFE_RELEASE( errors );
+
+   return res == D3D_OK;
+}
+
+bool GFXD3D9Shader::_compileShader( const Torque::Path &filePath, 
+                                    const String& target,                                  
+                                    const D3DXMACRO *defines, 
+                                    GenericConstBufferLayout* bufferLayoutF, 
+                                    GenericConstBufferLayout* bufferLayoutI,
+                                    Vector<GFXShaderConstDesc> &samplerDescriptions )
+{
+   PROFILE_SCOPE( GFXD3D9Shader_CompileShader );
+
+   HRESULT res = D3DERR_INVALIDCALL;
+   LPD3DXBUFFER code = NULL;
+   LPD3DXBUFFER errorBuff = NULL;
+
    ID3DXConstantTable* table = NULL;
 
    static String sHLSLStr( "hlsl" );
@@ -744,8 +912,7 @@ bool GFXD3D9Shader::_compileShader( const Torque::Path &filePath,
       dStrncpy( buffer, linePragma.c_str(), linePragmaLen );
       s.read( bufSize, buffer + linePragmaLen );
 
-      res = GFXD3DX.D3DXCompileShader( buffer, bufSize + linePragmaLen, defines, smD3DXInclude, "main", 
-         target, flags, &code, &errorBuff, &table );
+      res = _compileHLSL( buffer, bufSize + linePragmaLen, target, defines, smD3DXInclude, &code, &errorBuff, &table );
    }
 
    // Is it a precompiled obj shader?
@@ -793,13 +960,6 @@ bool GFXD3D9Shader::_compileShader( const Torque::Path &filePath,
    }
    */
 
-   // Wipe our allocations from this compile.
-   while (gIncludeAllocs.size())
-   {
-      delete [] gIncludeAllocs.last();
-      gIncludeAllocs.pop_back();
-   }
-
    if ( res != D3D_OK && smLogErrors )
       Con::errorf( "GFXD3D9Shader::_compileShader - Error compiling shader: %s: %s (%x)", 
          DXGetErrorStringA(res), DXGetErrorDescriptionA(res), res );
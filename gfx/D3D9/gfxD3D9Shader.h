@@ -212,6 +212,31 @@ protected:
    /// Vector of descriptions (consolidated for the getShaderConstDesc call)
    Vector<GFXShaderConstDesc> mShaderConsts;
    
+   /// Returns the D3DX compile flags for a target.
+   static U32 _getCompileFlags( const String &target );
+
+   /// Returns the vertex and pixel shader targets for a pixel shader version.
+   static void _getCompileTargets( F32 pixVersion, String *outVertTarget, String *outPixTarget );
+
+   /// Adds the macros which every shader is compiled with.
+   static void _getCompileMacros( F32 pixVersion, const Vector<GFXShaderMacro> &macros, Vector<GFXShaderMacro> *outMacros );
+
+   /// Compiles HLSL source through the shader cache.  This doesn't touch
+   /// the device, so it can be called from any thread as long as every
+   /// thread uses its own include handler.
+   static HRESULT _compileHLSL(  const char *source,
+                                 U32 sourceSize,
+                                 const String &target,
+                                 const D3DXMACRO *defines,
+                                 _gfxD3DXInclude *include,
+                                 LPD3DXBUFFER *outCode,
+                                 LPD3DXBUFFER *outErrors,
+                                 ID3DXConstantTable **outTable );
+
+   /// Compiles a shader stage into the shader cache.
+   /// @see GFXShaderCache::PrecompileDelegate
+   static bool _precompile( const Torque::Path &filePath, bool isVertex, F32 pixVersion, const Vector<GFXShaderMacro> &macros );
+
    // These two functions are used when compiling shaders from hlsl
    virtual bool _compileShader( const Torque::Path &filePath, 
                                 const String &target, 
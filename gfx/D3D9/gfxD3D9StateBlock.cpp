@@ -13,6 +13,7 @@ GFXD3D9StateBlock::GFXD3D9StateBlock(const GFXStateBlockDesc& desc, LPDIRECT3DDE
 
    mDesc = desc;
    mCachedHashValue = desc.getHashValue();
+   mDescriptor.set( mDesc );
    mD3DDevice = d3dDevice;
 
    // Color writes
@@ -68,56 +69,71 @@ void GFXD3D9StateBlock::activate(GFXD3D9StateBlock* oldState)
                         mD3DDevice->SetRenderState(y, z)
 #endif
 
-   // Blending
-   SD(blendEnable, D3DRS_ALPHABLENDENABLE);
-   SDD(blendSrc, D3DRS_SRCBLEND, GFXD3D9Blend[mDesc.blendSrc]);
-   SDD(blendDest, D3DRS_DESTBLEND, GFXD3D9Blend[mDesc.blendDest]);
-   SDD(blendOp, D3DRS_BLENDOP, GFXD3D9BlendOp[mDesc.blendOp]);
-
-   // Separate alpha blending
-   SD(separateAlphaBlendEnable, D3DRS_SEPARATEALPHABLENDENABLE);
-   SDD(separateAlphaBlendSrc, D3DRS_SRCBLENDALPHA, GFXD3D9Blend[mDesc.separateAlphaBlendSrc]);
-   SDD(separateAlphaBlendDest, D3DRS_DESTBLENDALPHA, GFXD3D9Blend[mDesc.separateAlphaBlendDest]);
-   SDD(separateAlphaBlendOp, D3DRS_BLENDOPALPHA, GFXD3D9BlendOp[mDesc.separateAlphaBlendOp]);
+   // Each group of states is skipped entirely if its precomputed
+   // descriptor matches the old state, otherwise the states within
+   // the group are diffed one by one.
+   if ( !oldState || oldState->mDescriptor.blend != mDescriptor.blend )
+   {
+      // Blending
+      SD(blendEnable, D3DRS_ALPHABLENDENABLE);
+      SDD(blendSrc, D3DRS_SRCBLEND, GFXD3D9Blend[mDesc.blendSrc]);
+      SDD(blendDest, D3DRS_DESTBLEND, GFXD3D9Blend[mDesc.blendDest]);
+      SDD(blendOp, D3DRS_BLENDOP, GFXD3D9BlendOp[mDesc.blendOp]);
+
+      // Separate alpha blending
+      SD(separateAlphaBlendEnable, D3DRS_SEPARATEALPHABLENDENABLE);
+      SDD(separateAlphaBlendSrc, D3DRS_SRCBLENDALPHA, GFXD3D9Blend[mDesc.separateAlphaBlendSrc]);
+      SDD(separateAlphaBlendDest, D3DRS_DESTBLENDALPHA, GFXD3D9Blend[mDesc.separateAlphaBlendDest]);
+      SDD(separateAlphaBlendOp, D3DRS_BLENDOPALPHA, GFXD3D9BlendOp[mDesc.separateAlphaBlendOp]);
+
+      // Alpha test
+      SD(alphaTestEnable, D3DRS_ALPHATESTENABLE);
+      SDD(alphaTestFunc, D3DRS_ALPHAFUNC, GFXD3D9CmpFunc[mDesc.alphaTestFunc]);
+      SD(alphaTestRef, D3DRS_ALPHAREF);
+
+      // Color writes
+      if ((oldState == NULL) || (mColorMask != oldState->mColorMask))
+         mD3DDevice->SetRenderState(D3DRS_COLORWRITEENABLE, mColorMask);
+
+      // Culling
+      SDD(cullMode, D3DRS_CULLMODE, GFXD3D9CullMode[mDesc.cullMode]);
+
+      // Fill mode
+      SDD(fillMode, D3DRS_FILLMODE, GFXD3D9FillMode[mDesc.fillMode]);
+   }
 
-   // Alpha test
-   SD(alphaTestEnable, D3DRS_ALPHATESTENABLE);
-   SDD(alphaTestFunc, D3DRS_ALPHAFUNC, GFXD3D9CmpFunc[mDesc.alphaTestFunc]);
-   SD(alphaTestRef, D3DRS_ALPHAREF);
+   if ( !oldState || oldState->mDescriptor.depthStencil != mDescriptor.depthStencil )
+   {
+      // Depth
+      SD(zEnable, D3DRS_ZENABLE);   
+      SD(zWriteEnable, D3DRS_ZWRITEENABLE);
+      SDD(zFunc, D3DRS_ZFUNC, GFXD3D9CmpFunc[mDesc.zFunc]);   
+      if ((!oldState) || (mZBias != oldState->mZBias))
+         mD3DDevice->SetRenderState(D3DRS_DEPTHBIAS, mZBias);
+      if ((!oldState) || (mZSlopeBias != oldState->mZSlopeBias))
+         mD3DDevice->SetRenderState(D3DRS_SLOPESCALEDEPTHBIAS, mZSlopeBias);
+
+      // Stencil
+      SD(stencilEnable, D3DRS_STENCILENABLE);
+      SDD(stencilFailOp, D3DRS_STENCILFAIL, GFXD3D9StencilOp[mDesc.stencilFailOp]);
+      SDD(stencilZFailOp, D3DRS_STENCILZFAIL, GFXD3D9StencilOp[mDesc.stencilZFailOp]);
+      SDD(stencilPassOp, D3DRS_STENCILPASS, GFXD3D9StencilOp[mDesc.stencilPassOp]);
+      SDD(stencilFunc, D3DRS_STENCILFUNC, GFXD3D9CmpFunc[mDesc.stencilFunc]);
+      SD(stencilRef, D3DRS_STENCILREF);
+      SD(stencilMask, D3DRS_STENCILMASK);
+      SD(stencilWriteMask, D3DRS_STENCILWRITEMASK);
+   }
 
-   // Color writes
-   if ((oldState == NULL) || (mColorMask != oldState->mColorMask))
-      mD3DDevice->SetRenderState(D3DRS_COLORWRITEENABLE, mColorMask);
-
-   // Culling
-   SDD(cullMode, D3DRS_CULLMODE, GFXD3D9CullMode[mDesc.cullMode]);
-
-   // Depth
-   SD(zEnable, D3DRS_ZENABLE);   
-   SD(zWriteEnable, D3DRS_ZWRITEENABLE);
-   SDD(zFunc, D3DRS_ZFUNC, GFXD3D9CmpFunc[mDesc.zFunc]);   
-   if ((!oldState) || (mZBias != oldState->mZBias))
-      mD3DDevice->SetRenderState(D3DRS_DEPTHBIAS, mZBias);
-   if ((!oldState) || (mZSlopeBias != oldState->mZSlopeBias))
-      mD3DDevice->SetRenderState(D3DRS_SLOPESCALEDEPTHBIAS, mZSlopeBias);
-
-   // Stencil
-   SD(stencilEnable, D3DRS_STENCILENABLE);
-   SDD(stencilFailOp, D3DRS_STENCILFAIL, GFXD3D9StencilOp[mDesc.stencilFailOp]);
-   SDD(stencilZFailOp, D3DRS_STENCILZFAIL, GFXD3D9StencilOp[mDesc.stencilZFailOp]);
-   SDD(stencilPassOp, D3DRS_STENCILPASS, GFXD3D9StencilOp[mDesc.stencilPassOp]);
-   SDD(stencilFunc, D3DRS_STENCILFUNC, GFXD3D9CmpFunc[mDesc.stencilFunc]);
-   SD(stencilRef, D3DRS_STENCILREF);
-   SD(stencilMask, D3DRS_STENCILMASK);
-   SD(stencilWriteMask, D3DRS_STENCILWRITEMASK);
-   SDD(fillMode, D3DRS_FILLMODE, GFXD3D9FillMode[mDesc.fillMode]);
 #if !defined(TORQUE_OS_XENON)
-   SD(ffLighting, D3DRS_LIGHTING);
-   SD(vertexColorEnable, D3DRS_COLORVERTEX);
-
-   static DWORD swzTemp;
-   getOwningDevice()->getDeviceSwizzle32()->ToBuffer( &swzTemp, &mDesc.textureFactor, sizeof(ColorI) );
-   SDD(textureFactor, D3DRS_TEXTUREFACTOR, swzTemp);
+   if ( !oldState || oldState->mDescriptor.fixedFunction != mDescriptor.fixedFunction )
+   {
+      SD(ffLighting, D3DRS_LIGHTING);
+      SD(vertexColorEnable, D3DRS_COLORVERTEX);
+
+      static DWORD swzTemp;
+      getOwningDevice()->getDeviceSwizzle32()->ToBuffer( &swzTemp, &mDesc.textureFactor, sizeof(ColorI) );
+      SDD(textureFactor, D3DRS_TEXTUREFACTOR, swzTemp);
+   }
 #endif
 #undef SD
 #undef SDD
@@ -138,6 +154,9 @@ void GFXD3D9StateBlock::activate(GFXD3D9StateBlock* oldState)
                         mD3DDevice->SetTextureStageState(i, y, z)
    for ( U32 i = 0; i < 8; i++ )
    {   
+      if ( oldState && oldState->mDescriptor.samplers[i] == mDescriptor.samplers[i] )
+         continue;
+
       TSS(textureColorOp, D3DTSS_COLOROP, GFXD3D9TextureOp[mDesc.samplers[i].textureColorOp]);
       TSS(colorArg1, D3DTSS_COLORARG1, mDesc.samplers[i].colorArg1);
       TSS(colorArg2, D3DTSS_COLORARG2, mDesc.samplers[i].colorArg2);
@@ -161,6 +180,9 @@ void GFXD3D9StateBlock::activate(GFXD3D9StateBlock* oldState)
 #endif
    for ( U32 i = 0; i < getOwningDevice()->getNumSamplers(); i++ )
    {      
+      if ( oldState && oldState->mDescriptor.samplers[i] == mDescriptor.samplers[i] )
+         continue;
+
       SS(minFilter, D3DSAMP_MINFILTER, GFXD3D9TextureFilter[mDesc.samplers[i].minFilter]);
       SS(magFilter, D3DSAMP_MAGFILTER, GFXD3D9TextureFilter[mDesc.samplers[i].magFilter]);
       SS(mipFilter, D3DSAMP_MIPFILTER, GFXD3D9TextureFilter[mDesc.samplers[i].mipFilter]);
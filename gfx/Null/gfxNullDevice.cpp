@@ -209,11 +209,17 @@ void GFXNullPrimitiveBuffer::unlock()
 class GFXNullStateBlock : public GFXStateBlock
 {
 public:
+   GFXNullStateBlock( const GFXStateBlockDesc &desc )
+      : mDesc( desc )
+   {
+      mDescriptor.set( mDesc );
+   }
+
    /// Returns the hash value of the desc that created this block
-   virtual U32 getHashValue() const { return 0; };
+   virtual U32 getHashValue() const { return mDesc.getHashValue(); };
 
    /// Returns a GFXStateBlockDesc that this block represents
-   virtual const GFXStateBlockDesc& getDesc() const { return mDefaultDesc; }
+   virtual const GFXStateBlockDesc& getDesc() const { return mDesc; }
 
    //
    // GFXResource
@@ -222,7 +228,7 @@ public:
    /// When called the resource should restore all device sensitive information destroyed by zombify()
    virtual void resurrect() { }
 private:
-   GFXStateBlockDesc mDefaultDesc;
+   GFXStateBlockDesc mDesc;
 };
 
 //
@@ -260,6 +266,31 @@ GFXPrimitiveBuffer *GFXNullDevice::allocPrimitiveBuffer( U32 numIndices, U32 num
    return new GFXNullPrimitiveBuffer(GFX, numIndices, numPrimitives, bufferType);
 }
 
+void GFXNullDevice::drawPrimitive( GFXPrimitiveType primType, U32 vertexStart, U32 primitiveCount )
+{
+   if ( mStateDirty )
+      updateStates();
+
+   // Nothing is drawn, but keep the statistics so that
+   // batching can be measured without a real device.
+   mDeviceStatistics.mDrawCalls++;
+   mDeviceStatistics.mPolyCount += primitiveCount;
+}
+
+void GFXNullDevice::drawIndexedPrimitive( GFXPrimitiveType primType, 
+                                          U32 startVertex, 
+                                          U32 minIndex, 
+                                          U32 numVerts, 
+                                          U32 startIndex, 
+                                          U32 primitiveCount )
+{
+   if ( mStateDirty )
+      updateStates();
+
+   mDeviceStatistics.mDrawCalls++;
+   mDeviceStatistics.mPolyCount += primitiveCount * getMax( mInstanceCount, (U32)1 );
+}
+
 GFXCubemap* GFXNullDevice::createCubemap()
 { 
    return new GFXNullCubemap(); 
@@ -297,7 +328,7 @@ void GFXNullDevice::init( const GFXVideoMode &mode, PlatformWindow *window )
 
 GFXStateBlockRef GFXNullDevice::createStateBlockInternal(const GFXStateBlockDesc& desc)
 {
-   return new GFXNullStateBlock();
+   return new GFXNullStateBlock( desc );
 }
 
 //
@@ -6,6 +6,11 @@
 #include "gfx/bitmap/bitmapUtils.h"
 
 #include "platform/platform.h"
+#include "math/mMathFn.h"
+
+#if defined(TORQUE_CPU_X86)
+#include <emmintrin.h>
+#endif
 
 
 void bitmapExtrude5551_c(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth)
@@ -162,6 +167,335 @@ void (*bitmapExtrudeRGB)(const void *srcMip, void *mip, U32 srcHeight, U32 srcWi
 void (*bitmapExtrudeRGBA)(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth) = bitmapExtrudeRGBA_c;
 
 
+//--------------------------------------------------------------------------
+
+enum
+{
+   /// The taps of the Kaiser mip filter.  Destination pixel x
+   /// is filtered from source pixels 2x - 3 through 2x + 4.
+   KaiserTaps = 8,
+};
+
+static F64 _besselI0( F64 x )
+{
+   // The power series converges quickly for the small arguments used here.
+   const F64 q = x * x * 0.25;
+   F64 sum = 1.0;
+   F64 term = 1.0;
+   for ( U32 k = 1; k < 24; k++ )
+   {
+      term *= q / F64( k * k );
+      sum += term;
+   }
+   return sum;
+}
+
+static void _getKaiserWeights( F32 *outWeights )
+{
+   // A sinc windowed over two destination pixels on each side, the
+   // same width and alpha as the Kaiser filter of the NVIDIA tools.
+   const F64 width = 2.0;
+   const F64 alpha = 4.0;
+
+   F64 weights[KaiserTaps];
+   F64 sum = 0.0;
+   for ( U32 i = 0; i < KaiserTaps; i++ )
+   {
+      // The distance from the destination pixel center in destination pixels.
+      const F64 x = ( F64( i ) - 3.5 ) * 0.5;
+      const F64 sinc = mSin( M_PI * x ) / ( M_PI * x );
+      const F64 t = x / width;
+      const F64 window = _besselI0( alpha * mSqrt( 1.0 - t * t ) ) / _besselI0( alpha );
+
+      weights[i] = sinc * window;
+      sum += weights[i];
+   }
+
+   for ( U32 i = 0; i < KaiserTaps; i++ )
+      outWeights[i] = F32( weights[i] / sum );
+}
+
+static inline U8 _roundKaiser( F32 value )
+{
+   return U8( mClampF( value, 0.0f, 255.0f ) + 0.5f );
+}
+
+void bitmapExtrudeRGBAKaiser_c(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth)
+{
+   F32 weights[KaiserTaps];
+   _getKaiserWeights( weights );
+
+   const U8 *src = (const U8 *) srcMip;
+   U8 *dst = (U8 *) mip;
+
+   const U32 width  = getMax( srcWidth  >> 1, U32( 1 ) );
+   const U32 height = getMax( srcHeight >> 1, U32( 1 ) );
+
+   // Filter the rows down to the destination width first.  The
+   // edges are clamped, as most of our mips don't wrap.
+   F32 *rows = new F32[ width * srcHeight * 4 ];
+   for ( U32 y = 0; y < srcHeight; y++ )
+   {
+      const U8 *srcRow = src + y * srcWidth * 4;
+      F32 *row = rows + y * width * 4;
+
+      for ( U32 x = 0; x < width; x++, row += 4 )
+      {
+         if ( srcWidth == 1 )
+         {
+            for ( U32 c = 0; c < 4; c++ )
+               row[c] = srcRow[c];
+            continue;
+         }
+
+         row[0] = row[1] = row[2] = row[3] = 0.0f;
+         for ( U32 t = 0; t < KaiserTaps; t++ )
+         {
+            const S32 sx = mClamp( S32( x * 2 + t ) - 3, 0, S32( srcWidth ) - 1 );
+            const U8 *pixel = srcRow + sx * 4;
+            for ( U32 c = 0; c < 4; c++ )
+               row[c] += weights[t] * F32( pixel[c] );
+         }
+      }
+   }
+
+   // Then the columns down to the destination height.
+   for ( U32 y = 0; y < height; y++ )
+   {
+      for ( U32 x = 0; x < width; x++ )
+      {
+         if ( srcHeight == 1 )
+         {
+            for ( U32 c = 0; c < 4; c++ )
+               *dst++ = _roundKaiser( rows[ x * 4 + c ] );
+            continue;
+         }
+
+         F32 sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+         for ( U32 t = 0; t < KaiserTaps; t++ )
+         {
+            const S32 sy = mClamp( S32( y * 2 + t ) - 3, 0, S32( srcHeight ) - 1 );
+            const F32 *pixel = rows + ( sy * width + x ) * 4;
+            for ( U32 c = 0; c < 4; c++ )
+               sum[c] += weights[t] * pixel[c];
+         }
+
+         for ( U32 c = 0; c < 4; c++ )
+            *dst++ = _roundKaiser( sum[c] );
+      }
+   }
+
+   delete [] rows;
+}
+
+void (*bitmapExtrudeRGBAKaiser)(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth) = bitmapExtrudeRGBAKaiser_c;
+
+
+//--------------------------------------------------------------------------
+// DXT1 and DXT5 blocks.
+//
+// The color endpoints are the corners of the RGB bounding box of the block,
+// inset by 1/16th to reduce the error of the interpolated colors, and each
+// pixel takes the palette entry nearest to its projection on the box
+// diagonal.  This is the same range fit squish does with kColourRangeFit,
+// but cheap enough for textures which are generated at runtime.
+
+/// The palette index of each quarter of the box diagonal, from the
+/// minimum to the maximum color.
+static const U8 sDXTColorIndex[4] = { 1, 3, 2, 0 };
+
+static inline U32 _packColor565( const U8 *color )
+{
+   return ( ( color[0] >> 3 ) << 11 ) | ( ( color[1] >> 2 ) << 5 ) | ( color[2] >> 3 );
+}
+
+static inline void _unpackColor565( U32 color, U8 *outColor )
+{
+   const U32 r = ( color >> 11 ) & 0x1F;
+   const U32 g = ( color >> 5 ) & 0x3F;
+   const U32 b = color & 0x1F;
+   outColor[0] = ( r << 3 ) | ( r >> 2 );
+   outColor[1] = ( g << 2 ) | ( g >> 4 );
+   outColor[2] = ( b << 3 ) | ( b >> 2 );
+   outColor[3] = 255;
+}
+
+/// Insets the bounding box of the block and returns the 5:6:5 endpoints
+/// along with the colors they expand to.
+static void _getDXTEndpoints( const U8 *minColor, const U8 *maxColor, U32 *outColor0, U32 *outColor1, U8 *outMax, U8 *outMin )
+{
+   U8 inMin[3], inMax[3];
+   for ( U32 c = 0; c < 3; c++ )
+   {
+      const U32 inset = ( maxColor[c] - minColor[c] ) >> 4;
+      inMin[c] = minColor[c] + inset;
+      inMax[c] = maxColor[c] - inset;
+   }
+
+   // The maximum is never less than the minimum, so color0 >= color1
+   // and we only get the three color mode of DXT1 when they're equal,
+   // in which case every pixel uses color1 anyway.
+   *outColor0 = _packColor565( inMax );
+   *outColor1 = _packColor565( inMin );
+   _unpackColor565( *outColor0, outMax );
+   _unpackColor565( *outColor1, outMin );
+}
+
+static void _writeDXTColorBlock( U32 color0, U32 color1, U32 indices, U8 *dst )
+{
+   dst[0] = color0 & 0xFF;
+   dst[1] = color0 >> 8;
+   dst[2] = color1 & 0xFF;
+   dst[3] = color1 >> 8;
+   dst[4] = indices & 0xFF;
+   dst[5] = ( indices >> 8 ) & 0xFF;
+   dst[6] = ( indices >> 16 ) & 0xFF;
+   dst[7] = indices >> 24;
+}
+
+/// Writes the DXT5 alpha block for the 4x4 pixels at src.
+static void _compressDXTAlphaBlock( const U8 *src, U32 srcPitch, U32 minAlpha, U32 maxAlpha, U8 *dst )
+{
+   // Alpha0 is the maximum, which selects the eight value mode
+   // with alpha1 at index 1 and six steps towards alpha0.
+   const U32 range = maxAlpha - minAlpha;
+   U64 indices = 0;
+   if ( range > 0 )
+   {
+      for ( U32 i = 0; i < 16; i++ )
+      {
+         const U32 alpha = src[ ( i >> 2 ) * srcPitch + ( i & 3 ) * 4 + 3 ];
+         const U32 step = ( ( alpha - minAlpha ) * 14 + range ) / ( range * 2 );
+         const U32 index = step == 0 ? 1 : ( step == 7 ? 0 : 8 - step );
+         indices |= U64( index ) << ( i * 3 );
+      }
+   }
+
+   dst[0] = maxAlpha;
+   dst[1] = minAlpha;
+   for ( U32 i = 0; i < 6; i++ )
+      dst[ 2 + i ] = U8( indices >> ( i * 8 ) );
+}
+
+static void _compressDXTBlock_c( const U8 *src, U32 srcPitch, U8 *dst, bool dxt5 )
+{
+   U8 minColor[4] = { 255, 255, 255, 255 };
+   U8 maxColor[4] = { 0, 0, 0, 0 };
+   for ( U32 y = 0; y < 4; y++ )
+   {
+      const U8 *pixel = src + y * srcPitch;
+      for ( U32 x = 0; x < 16; x++ )
+      {
+         minColor[ x & 3 ] = getMin( minColor[ x & 3 ], pixel[x] );
+         maxColor[ x & 3 ] = getMax( maxColor[ x & 3 ], pixel[x] );
+      }
+   }
+
+   if ( dxt5 )
+   {
+      _compressDXTAlphaBlock( src, srcPitch, minColor[3], maxColor[3], dst );
+      dst += 8;
+   }
+
+   U32 color0, color1;
+   U8 end0[4], end1[4];
+   _getDXTEndpoints( minColor, maxColor, &color0, &color1, end0, end1 );
+
+   const S32 axis[3] = { end0[0] - end1[0], end0[1] - end1[1], end0[2] - end1[2] };
+   const S32 lenSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+   U32 indices = 0;
+   for ( U32 i = 0; i < 16; i++ )
+   {
+      const U8 *pixel = src + ( i >> 2 ) * srcPitch + ( i & 3 ) * 4;
+      const S32 dot6 = 6 * (  ( pixel[0] - end1[0] ) * axis[0] +
+                              ( pixel[1] - end1[1] ) * axis[1] +
+                              ( pixel[2] - end1[2] ) * axis[2] );
+
+      const U32 step = ( dot6 > lenSq ) + ( dot6 > lenSq * 3 ) + ( dot6 > lenSq * 5 );
+      indices |= U32( sDXTColorIndex[step] ) << ( i * 2 );
+   }
+
+   _writeDXTColorBlock( color0, color1, indices, dst );
+}
+
+void bitmapCompressDXTRow_c(const U8 *src, U32 srcPitch, U32 numBlocks, U8 *dst, bool dxt5)
+{
+   const U32 blockSize = dxt5 ? 16 : 8;
+   for ( U32 i = 0; i < numBlocks; i++ )
+      _compressDXTBlock_c( src + i * 16, srcPitch, dst + i * blockSize, dxt5 );
+}
+
+void (*bitmapCompressDXTRow)(const U8 *src, U32 srcPitch, U32 numBlocks, U8 *dst, bool dxt5) = bitmapCompressDXTRow_c;
+
+static void _decompressDXTBlock( const U8 *src, U8 *dst, U32 dstPitch, bool dxt5 )
+{
+   U8 alphas[8];
+   U64 alphaIndices = 0;
+   if ( dxt5 )
+   {
+      alphas[0] = src[0];
+      alphas[1] = src[1];
+      if ( alphas[0] > alphas[1] )
+      {
+         for ( U32 i = 1; i < 7; i++ )
+            alphas[ i + 1 ] = ( ( 7 - i ) * alphas[0] + i * alphas[1] ) / 7;
+      }
+      else
+      {
+         for ( U32 i = 1; i < 5; i++ )
+            alphas[ i + 1 ] = ( ( 5 - i ) * alphas[0] + i * alphas[1] ) / 5;
+         alphas[6] = 0;
+         alphas[7] = 255;
+      }
+
+      for ( U32 i = 0; i < 6; i++ )
+         alphaIndices |= U64( src[ 2 + i ] ) << ( i * 8 );
+
+      src += 8;
+   }
+
+   const U32 color0 = src[0] | ( src[1] << 8 );
+   const U32 color1 = src[2] | ( src[3] << 8 );
+   const U32 indices = src[4] | ( src[5] << 8 ) | ( src[6] << 16 ) | ( U32( src[7] ) << 24 );
+
+   U8 palette[4][4];
+   _unpackColor565( color0, palette[0] );
+   _unpackColor565( color1, palette[1] );
+   for ( U32 c = 0; c < 4; c++ )
+   {
+      // DXT5 always uses four colors.
+      if ( color0 > color1 || dxt5 )
+      {
+         palette[2][c] = ( 2 * palette[0][c] + palette[1][c] ) / 3;
+         palette[3][c] = ( palette[0][c] + 2 * palette[1][c] ) / 3;
+      }
+      else
+      {
+         palette[2][c] = ( palette[0][c] + palette[1][c] ) / 2;
+         palette[3][c] = 0;
+      }
+   }
+
+   for ( U32 i = 0; i < 16; i++ )
+   {
+      U8 *pixel = dst + ( i >> 2 ) * dstPitch + ( i & 3 ) * 4;
+      dMemcpy( pixel, palette[ ( indices >> ( i * 2 ) ) & 3 ], 4 );
+      if ( dxt5 )
+         pixel[3] = alphas[ ( alphaIndices >> ( i * 3 ) ) & 7 ];
+   }
+}
+
+void bitmapDecompressDXTRow_c(const U8 *src, U32 numBlocks, U8 *dst, U32 dstPitch, bool dxt5)
+{
+   const U32 blockSize = dxt5 ? 16 : 8;
+   for ( U32 i = 0; i < numBlocks; i++ )
+      _decompressDXTBlock( src + i * blockSize, dst + i * 16, dstPitch, dxt5 );
+}
+
+void (*bitmapDecompressDXTRow)(const U8 *src, U32 numBlocks, U8 *dst, U32 dstPitch, bool dxt5) = bitmapDecompressDXTRow_c;
+
+
 //--------------------------------------------------------------------------
 
 void bitmapConvertRGB_to_1555_c(U8 *src, U32 pixels)
@@ -265,3 +599,252 @@ void bitmapConvertA8_to_RGBA_c( U8 **src, U32 pixels )
 }
 
 void (*bitmapConvertA8_to_RGBA)( U8 **src, U32 pixels ) = bitmapConvertA8_to_RGBA_c;
+
+//--------------------------------------------------------------------------
+// SSE2 versions.
+
+#if defined(TORQUE_CPU_X86)
+
+static void bitmapExtrudeRGBA_sse2(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth)
+{
+   // Leave the narrow mips to the C version.
+   if ( srcWidth < 8 )
+   {
+      bitmapExtrudeRGBA_c( srcMip, mip, srcHeight, srcWidth );
+      return;
+   }
+
+   const U8 *src = (const U8 *) srcMip;
+   U8 *dst = (U8 *) mip;
+   const U32 stride = srcHeight != 1 ? srcWidth * 4 : 0;
+
+   const U32 width  = srcWidth >> 1;
+   const U32 height = getMax( srcHeight >> 1, U32( 1 ) );
+
+   const __m128i zero = _mm_setzero_si128();
+   const __m128i round = _mm_set1_epi16( 2 );
+
+   for ( U32 y = 0; y < height; y++ )
+   {
+      const U8 *row0 = src + y * 2 * srcWidth * 4;
+      const U8 *row1 = row0 + stride;
+      U8 *dstRow = dst + y * width * 4;
+
+      // Four destination pixels from eight source pixels at a time.
+      U32 x = 0;
+      for ( ; x + 4 <= width; x += 4 )
+      {
+         const __m128i a = _mm_loadu_si128( (const __m128i *)( row0 + x * 8 ) );
+         const __m128i b = _mm_loadu_si128( (const __m128i *)( row0 + x * 8 + 16 ) );
+         const __m128i c = _mm_loadu_si128( (const __m128i *)( row1 + x * 8 ) );
+         const __m128i d = _mm_loadu_si128( (const __m128i *)( row1 + x * 8 + 16 ) );
+
+         // Add the two rows, two pixels of 16 bit channels per register...
+         const __m128i p01 = _mm_add_epi16( _mm_unpacklo_epi8( a, zero ), _mm_unpacklo_epi8( c, zero ) );
+         const __m128i p23 = _mm_add_epi16( _mm_unpackhi_epi8( a, zero ), _mm_unpackhi_epi8( c, zero ) );
+         const __m128i p45 = _mm_add_epi16( _mm_unpacklo_epi8( b, zero ), _mm_unpacklo_epi8( d, zero ) );
+         const __m128i p67 = _mm_add_epi16( _mm_unpackhi_epi8( b, zero ), _mm_unpackhi_epi8( d, zero ) );
+
+         // ...then the neighbouring pixels.
+         __m128i lo = _mm_add_epi16( _mm_unpacklo_epi64( p01, p23 ), _mm_unpackhi_epi64( p01, p23 ) );
+         __m128i hi = _mm_add_epi16( _mm_unpacklo_epi64( p45, p67 ), _mm_unpackhi_epi64( p45, p67 ) );
+         lo = _mm_srli_epi16( _mm_add_epi16( lo, round ), 2 );
+         hi = _mm_srli_epi16( _mm_add_epi16( hi, round ), 2 );
+
+         _mm_storeu_si128( (__m128i *)( dstRow + x * 4 ), _mm_packus_epi16( lo, hi ) );
+      }
+
+      for ( ; x < width; x++ )
+      {
+         for ( U32 ch = 0; ch < 4; ch++ )
+         {
+            const U32 i = x * 8 + ch;
+            dstRow[ x * 4 + ch ] = ( U32( row0[i] ) + U32( row0[i+4] ) + U32( row1[i] ) + U32( row1[i+4] ) + 2 ) >> 2;
+         }
+      }
+   }
+}
+
+static inline __m128 _loadPixelSSE2( const U8 *pixel, const __m128i &zero )
+{
+   U32 bits;
+   dMemcpy( &bits, pixel, 4 );
+   const __m128i p = _mm_cvtsi32_si128( bits );
+   return _mm_cvtepi32_ps( _mm_unpacklo_epi16( _mm_unpacklo_epi8( p, zero ), zero ) );
+}
+
+static inline void _storeKaiserSSE2( U8 *dst, __m128 value, const __m128 &maxValue, const __m128 &half )
+{
+   // Clamp and truncate like _roundKaiser.
+   value = _mm_add_ps( _mm_min_ps( _mm_max_ps( value, _mm_setzero_ps() ), maxValue ), half );
+   const __m128i channels = _mm_cvttps_epi32( value );
+   const __m128i packed = _mm_packus_epi16( _mm_packs_epi32( channels, channels ), channels );
+   const U32 bits = _mm_cvtsi128_si32( packed );
+   dMemcpy( dst, &bits, 4 );
+}
+
+static void bitmapExtrudeRGBAKaiser_sse2(const void *srcMip, void *mip, U32 srcHeight, U32 srcWidth)
+{
+   // The one pixel wide or high mips are just copies in one
+   // direction, leave them to the C version.
+   if ( srcWidth == 1 || srcHeight == 1 )
+   {
+      bitmapExtrudeRGBAKaiser_c( srcMip, mip, srcHeight, srcWidth );
+      return;
+   }
+
+   F32 weights[KaiserTaps];
+   _getKaiserWeights( weights );
+
+   __m128 splat[KaiserTaps];
+   for ( U32 t = 0; t < KaiserTaps; t++ )
+      splat[t] = _mm_set1_ps( weights[t] );
+
+   const U8 *src = (const U8 *) srcMip;
+   U8 *dst = (U8 *) mip;
+
+   const U32 width  = srcWidth  >> 1;
+   const U32 height = srcHeight >> 1;
+
+   const __m128i zero = _mm_setzero_si128();
+   const __m128 maxValue = _mm_set1_ps( 255.0f );
+   const __m128 half = _mm_set1_ps( 0.5f );
+
+   // Each pixel is one register of four float channels.
+   F32 *rows = new F32[ width * srcHeight * 4 ];
+   for ( U32 y = 0; y < srcHeight; y++ )
+   {
+      const U8 *srcRow = src + y * srcWidth * 4;
+      F32 *row = rows + y * width * 4;
+
+      for ( U32 x = 0; x < width; x++ )
+      {
+         __m128 sum = _mm_setzero_ps();
+         for ( U32 t = 0; t < KaiserTaps; t++ )
+         {
+            const S32 sx = mClamp( S32( x * 2 + t ) - 3, 0, S32( srcWidth ) - 1 );
+            sum = _mm_add_ps( sum, _mm_mul_ps( splat[t], _loadPixelSSE2( srcRow + sx * 4, zero ) ) );
+         }
+         _mm_storeu_ps( row + x * 4, sum );
+      }
+   }
+
+   for ( U32 y = 0; y < height; y++ )
+   {
+      const F32 *taps[KaiserTaps];
+      for ( U32 t = 0; t < KaiserTaps; t++ )
+         taps[t] = rows + mClamp( S32( y * 2 + t ) - 3, 0, S32( srcHeight ) - 1 ) * width * 4;
+
+      for ( U32 x = 0; x < width; x++ )
+      {
+         __m128 sum = _mm_setzero_ps();
+         for ( U32 t = 0; t < KaiserTaps; t++ )
+            sum = _mm_add_ps( sum, _mm_mul_ps( splat[t], _mm_loadu_ps( taps[t] + x * 4 ) ) );
+
+         _storeKaiserSSE2( dst, sum, maxValue, half );
+         dst += 4;
+      }
+   }
+
+   delete [] rows;
+}
+
+static void _compressDXTBlock_sse2( const U8 *src, U32 srcPitch, U8 *dst, bool dxt5 )
+{
+   const __m128i zero = _mm_setzero_si128();
+
+   __m128i rows[4];
+   for ( U32 y = 0; y < 4; y++ )
+      rows[y] = _mm_loadu_si128( (const __m128i *)( src + y * srcPitch ) );
+
+   // Reduce the 16 pixels to the minimum and maximum of each channel.
+   __m128i minColor = _mm_min_epu8( _mm_min_epu8( rows[0], rows[1] ), _mm_min_epu8( rows[2], rows[3] ) );
+   __m128i maxColor = _mm_max_epu8( _mm_max_epu8( rows[0], rows[1] ), _mm_max_epu8( rows[2], rows[3] ) );
+   minColor = _mm_min_epu8( minColor, _mm_shuffle_epi32( minColor, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+   maxColor = _mm_max_epu8( maxColor, _mm_shuffle_epi32( maxColor, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+   minColor = _mm_min_epu8( minColor, _mm_shuffle_epi32( minColor, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+   maxColor = _mm_max_epu8( maxColor, _mm_shuffle_epi32( maxColor, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+
+   U8 minBytes[4], maxBytes[4];
+   const U32 minBits = _mm_cvtsi128_si32( minColor );
+   const U32 maxBits = _mm_cvtsi128_si32( maxColor );
+   dMemcpy( minBytes, &minBits, 4 );
+   dMemcpy( maxBytes, &maxBits, 4 );
+
+   if ( dxt5 )
+   {
+      _compressDXTAlphaBlock( src, srcPitch, minBytes[3], maxBytes[3], dst );
+      dst += 8;
+   }
+
+   U32 color0, color1;
+   U8 end0[4], end1[4];
+   _getDXTEndpoints( minBytes, maxBytes, &color0, &color1, end0, end1 );
+
+   const S16 axis[3] = { S16( end0[0] - end1[0] ), S16( end0[1] - end1[1] ), S16( end0[2] - end1[2] ) };
+   const S32 lenSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+   // Two pixels of 16 bit channels per register, the alpha is ignored.
+   const __m128i axisVec = _mm_set_epi16( 0, axis[2], axis[1], axis[0], 0, axis[2], axis[1], axis[0] );
+   const __m128i endVec = _mm_set_epi16( 0, end1[2], end1[1], end1[0], 0, end1[2], end1[1], end1[0] );
+   const __m128i limit1 = _mm_set1_epi32( lenSq );
+   const __m128i limit3 = _mm_set1_epi32( lenSq * 3 );
+   const __m128i limit5 = _mm_set1_epi32( lenSq * 5 );
+
+   __m128i steps[4];
+   for ( U32 y = 0; y < 4; y++ )
+   {
+      const __m128i lo = _mm_madd_epi16( _mm_sub_epi16( _mm_unpacklo_epi8( rows[y], zero ), endVec ), axisVec );
+      const __m128i hi = _mm_madd_epi16( _mm_sub_epi16( _mm_unpackhi_epi8( rows[y], zero ), endVec ), axisVec );
+
+      // The madd leaves red + green and blue for each pixel, add them.
+      const __m128i rg = _mm_castps_si128( _mm_shuffle_ps( _mm_castsi128_ps( lo ), _mm_castsi128_ps( hi ), _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+      const __m128i b = _mm_castps_si128( _mm_shuffle_ps( _mm_castsi128_ps( lo ), _mm_castsi128_ps( hi ), _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+      const __m128i dot = _mm_add_epi32( rg, b );
+      const __m128i dot6 = _mm_add_epi32( _mm_slli_epi32( dot, 2 ), _mm_slli_epi32( dot, 1 ) );
+
+      // The comparisons are -1 when true.
+      const __m128i passed = _mm_add_epi32( _mm_add_epi32( _mm_cmpgt_epi32( dot6, limit1 ), _mm_cmpgt_epi32( dot6, limit3 ) ), _mm_cmpgt_epi32( dot6, limit5 ) );
+      steps[y] = _mm_sub_epi32( zero, passed );
+   }
+
+   U8 step[16];
+   _mm_storeu_si128( (__m128i *)step, _mm_packs_epi16( _mm_packs_epi32( steps[0], steps[1] ), _mm_packs_epi32( steps[2], steps[3] ) ) );
+
+   U32 indices = 0;
+   for ( U32 i = 0; i < 16; i++ )
+      indices |= U32( sDXTColorIndex[ step[i] ] ) << ( i * 2 );
+
+   _writeDXTColorBlock( color0, color1, indices, dst );
+}
+
+static void bitmapCompressDXTRow_sse2(const U8 *src, U32 srcPitch, U32 numBlocks, U8 *dst, bool dxt5)
+{
+   const U32 blockSize = dxt5 ? 16 : 8;
+   for ( U32 i = 0; i < numBlocks; i++ )
+      _compressDXTBlock_sse2( src + i * 16, srcPitch, dst + i * blockSize, dxt5 );
+}
+
+#endif // TORQUE_CPU_X86
+
+
+//--------------------------------------------------------------------------
+
+void bitmapInstallLibrary_C()
+{
+   bitmapExtrude5551 = bitmapExtrude5551_c;
+   bitmapExtrudeRGB = bitmapExtrudeRGB_c;
+   bitmapExtrudeRGBA = bitmapExtrudeRGBA_c;
+   bitmapExtrudeRGBAKaiser = bitmapExtrudeRGBAKaiser_c;
+   bitmapCompressDXTRow = bitmapCompressDXTRow_c;
+   bitmapDecompressDXTRow = bitmapDecompressDXTRow_c;
+}
+
+void bitmapInstallLibrary_SSE2()
+{
+#if defined(TORQUE_CPU_X86)
+   bitmapExtrudeRGBA = bitmapExtrudeRGBA_sse2;
+   bitmapExtrudeRGBAKaiser = bitmapExtrudeRGBAKaiser_sse2;
+   bitmapCompressDXTRow = bitmapCompressDXTRow_sse2;
+#endif
+}
@@ -19,6 +19,26 @@ extern void (*bitmapConvertRGB_to_RGBX)( U8 **src, U32 pixels );
 extern void (*bitmapConvertRGBX_to_RGB)( U8 **src, U32 pixels );
 extern void (*bitmapConvertA8_to_RGBA)( U8 **src, U32 pixels );
 
+/// Halves an RGBA mip with an 8 tap Kaiser windowed sinc, which keeps
+/// more detail than the box filter of bitmapExtrudeRGBA.
+extern void (*bitmapExtrudeRGBAKaiser)(const void *srcMip, void *mip, U32 height, U32 width);
+
+/// Compresses a row of 4x4 RGBA blocks to DXT1 or DXT5.  The source
+/// is four rows of numBlocks * 4 pixels, srcPitch bytes apart.
+extern void (*bitmapCompressDXTRow)(const U8 *src, U32 srcPitch, U32 numBlocks, U8 *dst, bool dxt5);
+
+/// Decompresses a row of DXT1 or DXT5 blocks to four rows of RGBA
+/// pixels, dstPitch bytes apart.
+extern void (*bitmapDecompressDXTRow)(const U8 *src, U32 numBlocks, U8 *dst, U32 dstPitch, bool dxt5);
+
 void bitmapExtrudeRGB_c(const void *srcMip, void *mip, U32 height, U32 width);
 
+/// Installs the C versions of the bitmap functions.
+void bitmapInstallLibrary_C();
+
+/// Installs the SSE2 versions of the bitmap functions.  They produce
+/// the same results as the C versions, except for float rounding in
+/// the Kaiser filter.
+void bitmapInstallLibrary_SSE2();
+
 #endif //_BITMAPUTILS_H_
@@ -90,7 +90,11 @@ struct DDSFile
    void clear();
 
    /// Reads a DDS file from the stream.
-   bool read(Stream &s);
+   ///
+   /// The largest dropMips mip levels of a plain texture are skipped
+   /// over without reading them, and the file is read as if the first
+   /// mip left were the top one.  The smallest mip is always kept.
+   bool read(Stream &s, U32 dropMips = 0);
 
    /// Called from read() to read in the DDS header.
    bool readHeader(Stream &s);
@@ -436,7 +436,7 @@ bool DDSFile::readHeader(Stream &s)
    return true;
 }
 
-bool DDSFile::read(Stream &s)
+bool DDSFile::read(Stream &s, U32 dropMips)
 {
    if(!readHeader(s))
    {
@@ -460,16 +460,38 @@ bool DDSFile::read(Stream &s)
    {
       // It's a plain old texture.
 
+      // Skip past the mips we were asked to drop.
+      dropMips = mMipMapCount > 1 ? getMin( dropMips, mMipMapCount - 1 ) : 0;
+
+      U32 dropBytes = 0;
+      for ( U32 i=0; i < dropMips; i++ )
+         dropBytes += getSurfaceSize( mHeight, mWidth, i );
+
+      if ( dropBytes && !s.setPosition( s.getPosition() + dropBytes ) )
+      {
+         Con::errorf("DDSFile::read - failed to skip the dropped mips!");
+         return false;
+      }
+
       // First allocate a SurfaceData to stick this in.
       mSurfaces.push_back(new SurfaceData());
 
       // Load the main image.
-      mSurfaces.last()->readNextMip(this, s, mHeight, mWidth, 0);
+      mSurfaces.last()->readNextMip(this, s, mHeight, mWidth, dropMips);
 
       // Load however many mips there are.
-      for(S32 i=1; i<mMipMapCount; i++)
+      for(S32 i=dropMips+1; i<mMipMapCount; i++)
          mSurfaces.last()->readNextMip(this, s, mHeight, mWidth, i);
 
+      // Make the first mip we read the top one.
+      if ( dropMips > 0 )
+      {
+         mWidth = getWidth( dropMips );
+         mHeight = getHeight( dropMips );
+         mMipMapCount -= dropMips;
+         mPitchOrLinearSize = mFlags.test( LinearSizeFlag ) ? getSurfaceSize() : getPitch();
+      }
+
       // Ok, we're done.
    }
 
@@ -692,6 +714,10 @@ template<> ResourceBase::Signature  Resource<DDSFile>::signature()
    return MakeFourCC('D','D','S',' '); // Direct Draw Surface
 }
 
+// Reading the surfaces doesn't touch the device, so
+// ResourceManager::loadAsync() can do it on a worker thread.
+static ResourceRegisterAsyncCreate<DDSFile> sgAsyncDDSFiles;
+
 Resource<DDSFile> DDSFile::load( const Torque::Path &path )
 {   
    Resource<DDSFile> ret = ResourceManager::get().load( path );
@@ -1,6 +1,9 @@
 #include "squish/squish.h"
 #include "gfx/bitmap/ddsFile.h"
 #include "gfx/bitmap/ddsUtils.h"
+#include "gfx/bitmap/bitmapUtils.h"
+#include "platform/threads/threadPool.h"
+#include "platform/threads/semaphore.h"
 
 //------------------------------------------------------------------------------
 
@@ -91,4 +94,250 @@ void DDSUtil::swizzleDDS( DDSFile *srcDDS, const Swizzle<U8, 4> &swizzle )
    {
       swizzle.InPlace( srcDDS->mSurfaces.last()->mMips[i], srcDDS->getSurfaceSize( i ) );
    }
-}
\ No newline at end of file
+}
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+enum
+{
+   /// The block rows in each batch of a compression job.
+   DXTBatchRows = 16,
+};
+
+/// A run of block rows from one mip.
+struct DXTCompressBatch
+{
+   const U8 *src;
+   U8 *dst;
+   U32 width;
+   U32 height;
+   U32 startRow;
+   U32 endRow;
+};
+
+void compressDXTBatch( const DXTCompressBatch &batch, bool dxt5 )
+{
+   const U32 blocksWide = ( batch.width + 3 ) >> 2;
+   const U32 blockSize = dxt5 ? 16 : 8;
+   const U32 pitch = batch.width * 4;
+
+   // Mips which aren't a multiple of four pixels are
+   // padded by repeating the last row and column.
+   const bool padded = ( batch.width & 3 ) || ( batch.height & 3 );
+   const U32 paddedPitch = blocksWide * 16;
+   U8 *padding = padded ? new U8[ paddedPitch * 4 ] : NULL;
+
+   for ( U32 row = batch.startRow; row < batch.endRow; row++ )
+   {
+      const U8 *src = batch.src + row * 4 * pitch;
+      U32 srcPitch = pitch;
+
+      if ( padded )
+      {
+         for ( U32 y = 0; y < 4; y++ )
+         {
+            const U8 *srcRow = batch.src + getMin( row * 4 + y, batch.height - 1 ) * pitch;
+            for ( U32 x = 0; x < blocksWide * 4; x++ )
+               dMemcpy( padding + y * paddedPitch + x * 4, srcRow + getMin( x, batch.width - 1 ) * 4, 4 );
+         }
+
+         src = padding;
+         srcPitch = paddedPitch;
+      }
+
+      bitmapCompressDXTRow( src, srcPitch, blocksWide, batch.dst + row * blocksWide * blockSize, dxt5 );
+   }
+
+   delete [] padding;
+}
+
+struct DXTCompressJob : public ThreadSafeRefCount< DXTCompressJob >
+{
+   Vector<DXTCompressBatch> mBatches;
+   bool mDXT5;
+
+   volatile U32 mNextBatch;
+   Semaphore mBatchDone;
+
+   DXTCompressJob()
+      : mDXT5( false ),
+        mNextBatch( 0 ),
+        mBatchDone( 0 )
+   {
+   }
+
+   bool claimBatch( U32 &outBatch )
+   {
+      while ( true )
+      {
+         U32 next = mNextBatch;
+         if ( next >= mBatches.size() )
+            return false;
+
+         if ( dCompareAndSwap( mNextBatch, next, next + 1 ) )
+         {
+            outBatch = next;
+            return true;
+         }
+      }
+   }
+
+   void run()
+   {
+      U32 batch;
+      while ( claimBatch( batch ) )
+      {
+         compressDXTBatch( mBatches[ batch ], mDXT5 );
+         mBatchDone.release();
+      }
+   }
+};
+
+struct DXTCompressWorkItem : public ThreadPool::WorkItem
+{
+   typedef ThreadPool::WorkItem Parent;
+
+   ThreadSafeRef< DXTCompressJob > mJob;
+
+   DXTCompressWorkItem( DXTCompressJob *job )
+      : mJob( job ) {}
+
+protected:
+   virtual void execute()
+   {
+      mJob->run();
+   }
+};
+
+} // namespace {}
+
+bool DDSUtil::compressDDS( DDSFile *srcDDS, const GFXFormat dxtFormat )
+{
+   if( dxtFormat != GFXFormatDXT1 && dxtFormat != GFXFormatDXT5 )
+      return squishDDS( srcDDS, dxtFormat );
+
+   if( srcDDS->mBytesPerPixel != 4 )
+   {
+      AssertFatal( false, "DDSUtil::compressDDS - wants 32-bit source data" );
+      return false;
+   }
+
+   PROFILE_SCOPE( DDSUtil_compressDDS );
+
+   const bool dxt5 = dxtFormat == GFXFormatDXT5;
+   const U32 blockSize = dxt5 ? 16 : 8;
+
+   DDSFile::SurfaceData *srcSurface = srcDDS->mSurfaces.last();
+   DDSFile::SurfaceData *newSurface = new DDSFile::SurfaceData();
+
+   // Cut every mip into batches of block rows, the small mips
+   // at the end of the chain are a batch each.
+   ThreadSafeRef< DXTCompressJob > job( new DXTCompressJob );
+   job->mDXT5 = dxt5;
+
+   for( U32 i = 0; i < srcDDS->mMipMapCount; i++ )
+   {
+      const U32 width = srcDDS->getWidth( i );
+      const U32 height = srcDDS->getHeight( i );
+      const U32 blocksHigh = ( height + 3 ) >> 2;
+      const U32 mipSz = ( ( width + 3 ) >> 2 ) * blocksHigh * blockSize;
+
+      U8 *dstBits = new U8[mipSz];
+      newSurface->mMips.push_back( dstBits );
+
+      for( U32 row = 0; row < blocksHigh; row += DXTBatchRows )
+      {
+         job->mBatches.increment();
+         DXTCompressBatch &batch = job->mBatches.last();
+         batch.src = srcSurface->mMips[i];
+         batch.dst = dstBits;
+         batch.width = width;
+         batch.height = height;
+         batch.startRow = row;
+         batch.endRow = getMin( row + DXTBatchRows, blocksHigh );
+      }
+   }
+
+   // The calling thread works on the batches too, so only wake
+   // up as many workers as there are batches left for them.
+   ThreadPool &pool = ThreadPool::GLOBAL();
+   const U32 numBatches = job->mBatches.size();
+   const U32 numItems = getMin( pool.getNumThreads(), numBatches - 1 );
+   for( U32 i = 0; i < numItems; i++ )
+      pool.queueWorkItem( new DXTCompressWorkItem( job ) );
+
+   job->run();
+   for( U32 i = 0; i < numBatches; i++ )
+      job->mBatchDone.acquire();
+
+   srcDDS->mFormat = dxtFormat;
+   srcDDS->mFlags.set( DDSFile::CompressedData );
+
+   srcDDS->mSurfaces.pop_back();
+   delete srcSurface;
+   srcDDS->mSurfaces.push_back( newSurface );
+
+   return true;
+}
+
+//------------------------------------------------------------------------------
+
+bool DDSUtil::decompressDDS( DDSFile *srcDDS )
+{
+   if( srcDDS->mFormat != GFXFormatDXT1 && srcDDS->mFormat != GFXFormatDXT5 )
+      return false;
+
+   PROFILE_SCOPE( DDSUtil_decompressDDS );
+
+   const bool dxt5 = srcDDS->mFormat == GFXFormatDXT5;
+   const U32 blockSize = dxt5 ? 16 : 8;
+
+   for( U32 s = 0; s < srcDDS->mSurfaces.size(); s++ )
+   {
+      DDSFile::SurfaceData *surface = srcDDS->mSurfaces[s];
+
+      for( U32 i = 0; i < srcDDS->mMipMapCount; i++ )
+      {
+         const U32 width = srcDDS->getWidth( i );
+         const U32 height = srcDDS->getHeight( i );
+         const U32 blocksWide = ( width + 3 ) >> 2;
+         const U32 blocksHigh = ( height + 3 ) >> 2;
+
+         const U8 *srcBits = surface->mMips[i];
+         U8 *dstBits = new U8[ width * height * 4 ];
+
+         // Decode the blocks which hang over the edge of
+         // the small mips into a row of whole blocks first.
+         const bool padded = ( width & 3 ) || ( height & 3 );
+         U8 *padding = padded ? new U8[ blocksWide * 64 ] : NULL;
+
+         for( U32 row = 0; row < blocksHigh; row++ )
+         {
+            const U8 *srcRow = srcBits + row * blocksWide * blockSize;
+            if( !padded )
+            {
+               bitmapDecompressDXTRow( srcRow, blocksWide, dstBits + row * 4 * width * 4, width * 4, dxt5 );
+               continue;
+            }
+
+            bitmapDecompressDXTRow( srcRow, blocksWide, padding, blocksWide * 16, dxt5 );
+            for( U32 y = row * 4; y < getMin( row * 4 + 4, height ); y++ )
+               dMemcpy( dstBits + y * width * 4, padding + ( y - row * 4 ) * blocksWide * 16, width * 4 );
+         }
+
+         delete [] padding;
+         delete [] surface->mMips[i];
+         surface->mMips[i] = dstBits;
+      }
+   }
+
+   srcDDS->mFormat = GFXFormatR8G8B8A8;
+   srcDDS->mBytesPerPixel = 4;
+   srcDDS->mFlags.clear( DDSFile::CompressedData );
+   srcDDS->mFlags.set( DDSFile::RGBData );
+
+   return true;
+}
\ No newline at end of file
@@ -6,6 +6,16 @@ struct DDSFile;
 namespace DDSUtil
 {
    bool squishDDS( DDSFile *srcDDS, const GFXFormat dxtFormat );
+
+   /// Compresses a 32 bit DDS to DXT1 or DXT5 with the fast range fit of
+   /// bitmapCompressDXTRow, spreading the block rows over the thread pool.
+   /// It is meant for the textures we generate at runtime, the other DXT
+   /// formats go to squishDDS.
+   bool compressDDS( DDSFile *srcDDS, const GFXFormat dxtFormat );
+
+   /// Decompresses a DXT1 or DXT5 DDS to R8G8B8A8.  If false is returned
+   /// the DDS is not modified.
+   bool decompressDDS( DDSFile *srcDDS );
    void swizzleDDS( DDSFile *srcDDS, const Swizzle<U8, 4> &swizzle );
 };
 
@@ -280,7 +280,7 @@ void GBitmap::allocateBitmap(const U32 in_width, const U32 in_height, const bool
 }
 
 //--------------------------------------------------------------------------
-void GBitmap::extrudeMipLevels(bool clearBorders)
+void GBitmap::extrudeMipLevels(bool clearBorders, MipFilter filter)
 {
    if(mNumMipLevels == 1)
       allocateBitmap(getWidth(), getHeight(), true, getFormat());
@@ -304,8 +304,9 @@ void GBitmap::extrudeMipLevels(bool clearBorders)
       case GFXFormatR8G8B8A8:
       case GFXFormatR8G8B8X8:
       {
+         void (*extrude)(const void *, void *, U32, U32) = filter == MipFilterKaiser ? bitmapExtrudeRGBAKaiser : bitmapExtrudeRGBA;
          for(U32 i = 1; i < mNumMipLevels; i++)
-            bitmapExtrudeRGBA(getBits(i - 1), getWritableBits(i), getHeight(i-1), getWidth(i-1));
+            extrude(getBits(i - 1), getWritableBits(i), getHeight(i-1), getWidth(i-1));
          break;
       }
       
@@ -1044,6 +1045,10 @@ template<> ResourceBase::Signature  Resource<GBitmap>::signature()
    return MakeFourCC('b','i','t','m');
 }
 
+// Bitmaps are not registered with ResourceRegisterAsyncCreate.  The PNG
+// and JPEG readers use the global FrameAllocator, so ResourceManager::loadAsync()
+// only reads them ahead and creates them on the main thread.
+
 /// Load the given bitmap file.
 ///
 /// Important: Don't do something like this
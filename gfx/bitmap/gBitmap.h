@@ -42,6 +42,18 @@ public:
       c_maxMipLevels = 13 
    };
 
+   /// The filters extrudeMipLevels can build the mips with.
+   enum MipFilter
+   {
+      /// Averages each 2x2 block, which is fast but soft.
+      MipFilterBox,
+
+      /// A Kaiser windowed sinc, which keeps more of the detail.  Only
+      /// RGBA bitmaps use it, the other formats fall back to the box.
+      /// It reads past the 2x2 block, so don't use it on atlases.
+      MipFilterKaiser,
+   };
+
    struct Registration
    {
       /// The read function prototype.
@@ -97,7 +109,7 @@ public:
                        const bool in_extrudeMipLevels = false,
                        const GFXFormat in_format = GFXFormatR8G8B8 );
 
-   void extrudeMipLevels(bool clearBorders = false);
+   void extrudeMipLevels(bool clearBorders = false, MipFilter filter = MipFilterBox);
    void extrudeMipLevelsDetail();
 
    U32   getNumMipLevels() const { return mNumMipLevels; }
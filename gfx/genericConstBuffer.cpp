@@ -205,6 +205,63 @@ void GenericConstBufferLayout::clear()
    mTimesCleared++;
 }
 
+///
+/// GenericConstBufferShadow
+///
+GenericConstBufferShadow::GenericConstBufferShadow( U32 size )
+{
+   VECTOR_SET_ASSOCIATION( mValid );
+
+   mSize = size;
+   mData = new U8[mSize];
+   dMemset( mData, 0, mSize );
+
+   const U32 numRegisters = ( mSize + RegisterSize - 1 ) / RegisterSize;
+   mValid.setSize( ( numRegisters + 31 ) / 32 );
+   invalidate();
+}
+
+GenericConstBufferShadow::~GenericConstBufferShadow()
+{
+   delete [] mData;
+}
+
+void GenericConstBufferShadow::invalidate()
+{
+   for ( U32 i=0; i < mValid.size(); i++ )
+      mValid[i] = 0;
+}
+
+bool GenericConstBufferShadow::isEqual( U32 offset, U32 size, const U8 *data ) const
+{
+   if ( size == 0 || offset + size > mSize )
+      return false;
+
+   const U32 last = ( offset + size - 1 ) / RegisterSize;
+   for ( U32 reg = offset / RegisterSize; reg <= last; reg++ )
+   {
+      if ( !( mValid[reg >> 5] & ( 1U << ( reg & 31 ) ) ) )
+         return false;
+   }
+
+   return dMemcmp( mData + offset, data, size ) == 0;
+}
+
+void GenericConstBufferShadow::update( U32 offset, U32 size, const U8 *data )
+{
+   if ( size == 0 || offset >= mSize )
+      return;
+
+   size = getMin( size, mSize - offset );
+   dMemcpy( mData + offset, data, size );
+
+   // Only registers which are completely covered become valid.
+   const U32 first = ( offset + RegisterSize - 1 ) / RegisterSize;
+   const U32 end = ( offset + size ) / RegisterSize;
+   for ( U32 reg = first; reg < end; reg++ )
+      mValid[reg >> 5] |= 1U << ( reg & 31 );
+}
+
 ///
 /// GenericConstBuffer
 ///
@@ -213,6 +270,8 @@ GenericConstBuffer::GenericConstBuffer(GenericConstBufferLayout* layout)
    VECTOR_SET_ASSOCIATION( mDirtyFields );
    VECTOR_SET_ASSOCIATION( mHasData );
 
+   mRedundantCount = 0;
+
    if (layout)
    {
       mLayout = layout;
@@ -249,6 +308,8 @@ void GenericConstBuffer::internalSet(const GenericConstBufferLayout::ParamDesc&
       mDirtyFields[pd.index] = true;
       mHasData[pd.index] = true;
    }
+   else
+      mRedundantCount++;
 }
 
 void GenericConstBuffer::setDirty(bool dirty)
@@ -260,6 +321,47 @@ void GenericConstBuffer::setDirty(bool dirty)
    }
 }
 
+void GenericConstBuffer::setDirtyFromShadow(const GenericConstBufferShadow& shadow)
+{
+   PROFILE_SCOPE(GenericConstBuffer_setDirtyFromShadow);
+
+   mDirty = false;
+
+   static GenericConstBufferLayout::ParamDesc pd;
+
+   for (U32 i = 0; i < mDirtyFields.size(); i++)
+   {
+      mDirtyFields[i] = false;
+
+      if ( !mHasData[i] || !mLayout->getDesc(i, pd) )
+         continue;
+
+      if ( shadow.isEqual(pd.offset, pd.size, mBuffer + pd.offset) )
+         mRedundantCount++;
+      else
+      {
+         mDirtyFields[i] = true;
+         mDirty = true;
+      }
+   }
+}
+
+void GenericConstBuffer::updateShadow(GenericConstBufferShadow& shadow, const U32 start, const U32 size) const
+{
+   shadow.update(start, size, mBuffer + start);
+}
+
+U32 GenericConstBuffer::getDirtyFieldCount() const
+{
+   U32 count = 0;
+   for (U32 i = 0; i < mDirtyFields.size(); i++)
+   {
+      if ( isFieldDirty(i) )
+         count++;
+   }
+   return count;
+}
+
 /// This scans the fields and returns a pointer to the first dirty field
 /// and the length of the dirty bytes
 const U8* GenericConstBuffer::getDirtyBuffer(U32& start, U32& size)
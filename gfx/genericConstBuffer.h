@@ -112,6 +112,47 @@ protected:
    U32 mTimesCleared;
 };
 
+/// Mirrors the constant registers last uploaded to the device, so that a
+/// GenericConstBuffer which is activated after another one only needs to
+/// send the fields that differ from what the device already holds.
+///
+/// Validity is tracked per 16 byte register, which is the granularity
+/// all the devices upload constants at.
+class GenericConstBufferShadow
+{
+public:
+
+   enum { RegisterSize = 16 };
+
+   /// @param size The size of the register file in bytes.
+   GenericConstBufferShadow( U32 size );
+   ~GenericConstBufferShadow();
+
+   /// Forgets all the shadowed values, for example after a device
+   /// reset has cleared the real registers.
+   void invalidate();
+
+   /// Returns true if all the bytes in the range are known to be on
+   /// the device and are equal to data.
+   bool isEqual( U32 offset, U32 size, const U8 *data ) const;
+
+   /// Records data as uploaded to the device.
+   void update( U32 offset, U32 size, const U8 *data );
+
+   /// Returns the size of the register file in bytes.
+   U32 getSize() const { return mSize; }
+
+protected:
+
+   U8 *mData;
+
+   U32 mSize;
+
+   /// One bit per register which is set once the register has been
+   /// uploaded since the last invalidate().
+   Vector<U32> mValid;
+};
+
 /// This class will be used by other const buffers and the material system.  Takes a set of variable names and maps them to
 /// a section of memory.  Should this descend from GFXConstBuffer?  I don't know, we need two of them (one for vert, one for
 /// pixel shaders for D3D9, maybe it'd be useful in OpenGL?)
@@ -164,6 +205,21 @@ public:
    void setDirty(bool dirty);
    bool isDirty() const { return mDirty; }
 
+   /// Marks dirty only the fields which differ from the values the shadow
+   /// says are on the device.  Used instead of setDirty(true) when another
+   /// buffer has been active since this one was last uploaded.
+   void setDirtyFromShadow(const GenericConstBufferShadow& shadow);
+
+   /// Records the dirty range as uploaded in the shadow.
+   void updateShadow(GenericConstBufferShadow& shadow, const U32 start, const U32 size) const;
+
+   /// Returns the number of fields currently marked dirty.
+   U32 getDirtyFieldCount() const;
+
+   /// Returns the number of field sets that were filtered out as redundant
+   /// since the last call and resets the count.
+   U32 popRedundantCount() { U32 count = mRedundantCount; mRedundantCount = 0; return count; }
+
    /// Returns true if we hold the same data as buffer and have the same layout
    bool isEqual(GenericConstBuffer* buffer) const;
 
@@ -189,5 +245,8 @@ private:
    Vector<bool> mDirtyFields;
    Vector<bool> mHasData;
    bool mDirty;
+
+   /// Count of field sets filtered out since the last popRedundantCount().
+   U32 mRedundantCount;
 };
 #endif
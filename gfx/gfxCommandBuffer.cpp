@@ -0,0 +1,580 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "gfx/gfxCommandBuffer.h"
+
+#include "gfx/gfxDevice.h"
+#include "platform/profiler.h"
+
+
+namespace
+{
+   enum CommandType
+   {
+      CmdClear,
+      CmdSetStateBlock,
+      CmdSetShader,
+      CmdSetShaderConstBuffer,
+      CmdSetShaderConst,
+      CmdSetTexture,
+      CmdSetCubeTexture,
+      CmdSetVertexBuffer,
+      CmdSetPrimitiveBuffer,
+      CmdSetInstanceBuffer,
+      CmdSetWorldMatrix,
+      CmdSetViewMatrix,
+      CmdSetProjectionMatrix,
+      CmdDrawPrimitive,
+      CmdDrawIndexedPrimitive,
+   };
+
+   /// The types of recorded shader constants.
+   enum ConstType
+   {
+      ConstF32,
+      ConstPoint2F,
+      ConstPoint3F,
+      ConstPoint4F,
+      ConstPlaneF,
+      ConstColorF,
+      ConstS32,
+      ConstPoint2I,
+      ConstPoint3I,
+      ConstPoint4I,
+      ConstArrayF32,
+      ConstArrayPoint2F,
+      ConstArrayPoint3F,
+      ConstArrayPoint4F,
+      ConstArrayS32,
+      ConstArrayPoint2I,
+      ConstArrayPoint3I,
+      ConstArrayPoint4I,
+      ConstMatrix,
+      ConstMatrixArray,
+   };
+
+   /// Every command starts with this header.  The size
+   /// includes the header and any data following the command,
+   /// which for large constant arrays can be well over 64K.
+   struct CommandHeader
+   {
+      U32 type;
+      U32 size;
+   };
+
+   struct ClearCommand
+   {
+      CommandHeader header;
+      U32 flags;
+      ColorI color;
+      F32 z;
+      U32 stencil;
+   };
+
+   /// Used by all the commands which set a single object.
+   struct SetObjectCommand
+   {
+      CommandHeader header;
+      U32 param;
+      void *object;
+   };
+
+   struct SetMatrixCommand
+   {
+      CommandHeader header;
+      MatrixF mat;
+   };
+
+   struct DrawCommand
+   {
+      CommandHeader header;
+      U32 primType;
+      U32 vertexStart;
+      U32 primitiveCount;
+   };
+
+   struct DrawIndexedCommand
+   {
+      CommandHeader header;
+      U32 primType;
+      U32 startVertex;
+      U32 minIndex;
+      U32 numVerts;
+      U32 startIndex;
+      U32 primitiveCount;
+   };
+
+   /// The constant value follows this command at
+   /// the next CommandAlign boundary.
+   struct SetConstCommand
+   {
+      CommandHeader header;
+      U16 valueType;
+      U16 matrixType;
+      U32 count;
+      U32 elementSize;
+      GFXShaderConstBuffer *buffer;
+      GFXShaderConstHandle *handle;
+   };
+
+   /// All commands are padded to this and the buffer itself is
+   /// allocated on it, so the pointers in the commands and the
+   /// constant data, which some of the set methods read with SSE,
+   /// stay aligned however the buffers are appended.
+   const U32 CommandAlign = 16;
+
+   inline U32 alignCommandSize( U32 size )
+   {
+      return ( size + CommandAlign - 1 ) & ~( CommandAlign - 1 );
+   }
+
+   template<class T> inline void setConstArray( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const SetConstCommand *cmd, U8 *data )
+   {
+      const AlignedArray<T> arr( cmd->count, cmd->elementSize, data, false );
+      buffer->set( handle, arr );
+   }
+
+   /// Returns the constant data which follows the command.
+   inline U8* getConstData( const SetConstCommand *cmd )
+   {
+      return (U8*)cmd + alignCommandSize( sizeof( SetConstCommand ) );
+   }
+
+   void executeSetConst( const SetConstCommand *cmd )
+   {
+      U8 *data = getConstData( cmd );
+
+      GFXShaderConstBuffer *buffer = cmd->buffer;
+      GFXShaderConstHandle *handle = cmd->handle;
+
+      switch ( cmd->valueType )
+      {
+         case ConstF32:       buffer->set( handle, *(const F32*)data ); break;
+         case ConstPoint2F:   buffer->set( handle, *(const Point2F*)data ); break;
+         case ConstPoint3F:   buffer->set( handle, *(const Point3F*)data ); break;
+         case ConstPoint4F:   buffer->set( handle, *(const Point4F*)data ); break;
+         case ConstPlaneF:    buffer->set( handle, *(const PlaneF*)data ); break;
+         case ConstColorF:    buffer->set( handle, *(const ColorF*)data ); break;
+         case ConstS32:       buffer->set( handle, *(const S32*)data ); break;
+         case ConstPoint2I:   buffer->set( handle, *(const Point2I*)data ); break;
+         case ConstPoint3I:   buffer->set( handle, *(const Point3I*)data ); break;
+         case ConstPoint4I:   buffer->set( handle, *(const Point4I*)data ); break;
+
+         case ConstArrayF32:     setConstArray<F32>( buffer, handle, cmd, data ); break;
+         case ConstArrayPoint2F: setConstArray<Point2F>( buffer, handle, cmd, data ); break;
+         case ConstArrayPoint3F: setConstArray<Point3F>( buffer, handle, cmd, data ); break;
+         case ConstArrayPoint4F: setConstArray<Point4F>( buffer, handle, cmd, data ); break;
+         case ConstArrayS32:     setConstArray<S32>( buffer, handle, cmd, data ); break;
+         case ConstArrayPoint2I: setConstArray<Point2I>( buffer, handle, cmd, data ); break;
+         case ConstArrayPoint3I: setConstArray<Point3I>( buffer, handle, cmd, data ); break;
+         case ConstArrayPoint4I: setConstArray<Point4I>( buffer, handle, cmd, data ); break;
+
+         case ConstMatrix:
+            buffer->set( handle, *(const MatrixF*)data, (GFXShaderConstType)cmd->matrixType );
+            break;
+
+         case ConstMatrixArray:
+            buffer->set( handle, (const MatrixF*)data, cmd->count, (GFXShaderConstType)cmd->matrixType );
+            break;
+
+         default:
+            AssertFatal( false, "GFXCommandBuffer - Unknown shader constant type!" );
+            break;
+      }
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+GFXCommandBuffer::GFXCommandBuffer()
+   :  mBuffer( NULL ),
+      mSize( 0 ),
+      mCapacity( 0 ),
+      mCommandCount( 0 ),
+      mDrawCount( 0 )
+{
+}
+
+GFXCommandBuffer::~GFXCommandBuffer()
+{
+   if ( mBuffer )
+      dAligned_free( mBuffer );
+}
+
+void GFXCommandBuffer::reset()
+{
+   mSize = 0;
+   mCommandCount = 0;
+   mDrawCount = 0;
+}
+
+void* GFXCommandBuffer::_allocCommand( U32 size )
+{
+   size = alignCommandSize( size );
+
+   if ( mSize + size > mCapacity )
+      _reserve( getMax( mCapacity * 2, getMax( mSize + size, (U32)4096 ) ) );
+
+   void *cmd = mBuffer + mSize;
+   mSize += size;
+   mCommandCount++;
+   return cmd;
+}
+
+void GFXCommandBuffer::_reserve( U32 size )
+{
+   if ( size <= mCapacity )
+      return;
+
+   // There is no aligned realloc, so copy the
+   // recorded commands over by hand.
+   U8 *buffer = (U8*)dAligned_malloc( size, CommandAlign );
+   if ( mBuffer )
+   {
+      dMemcpy( buffer, mBuffer, mSize );
+      dAligned_free( mBuffer );
+   }
+
+   mBuffer = buffer;
+   mCapacity = size;
+}
+
+void GFXCommandBuffer::append( const GFXCommandBuffer &buffer )
+{
+   // Growing the buffer would free the source commands.
+   AssertFatal( &buffer != this, "GFXCommandBuffer::append - Cannot append a buffer to itself!" );
+
+   if ( buffer.mSize == 0 )
+      return;
+
+   if ( mSize + buffer.mSize > mCapacity )
+      _reserve( getMax( mCapacity * 2, mSize + buffer.mSize ) );
+
+   dMemcpy( mBuffer + mSize, buffer.mBuffer, buffer.mSize );
+   mSize += buffer.mSize;
+   mCommandCount += buffer.mCommandCount;
+   mDrawCount += buffer.mDrawCount;
+}
+
+//-----------------------------------------------------------------------------
+
+void GFXCommandBuffer::clear( U32 flags, ColorI color, F32 z, U32 stencil )
+{
+   ClearCommand *cmd = (ClearCommand*)_allocCommand( sizeof( ClearCommand ) );
+   cmd->header.type = CmdClear;
+   cmd->header.size = alignCommandSize( sizeof( ClearCommand ) );
+   cmd->flags = flags;
+   cmd->color = color;
+   cmd->z = z;
+   cmd->stencil = stencil;
+}
+
+/// Records one of the commands which take a single object.
+static inline void _setObject( SetObjectCommand *cmd, U32 type, U32 param, void *object )
+{
+   cmd->header.type = type;
+   cmd->header.size = alignCommandSize( sizeof( SetObjectCommand ) );
+   cmd->param = param;
+   cmd->object = object;
+}
+
+void GFXCommandBuffer::setStateBlock( GFXStateBlock *block )
+{
+   AssertFatal( block, "GFXCommandBuffer::setStateBlock - NULL state block!" );
+   _setObject( (SetObjectCommand*)_allocCommand( sizeof( SetObjectCommand ) ), CmdSetStateBlock, 0, block );
+}
+
+void GFXCommandBuffer::setShader( GFXShader *shader )
+{
+   _setObject( (SetObjectCommand*)_allocCommand( sizeof( SetObjectCommand ) ), CmdSetShader, 0, shader );
+}
+
+void GFXCommandBuffer::setShaderConstBuffer( GFXShaderConstBuffer *buffer )
+{
+   _setObject( (SetObjectCommand*)_allocCommand( sizeof( SetObjectCommand ) ), CmdSetShaderConstBuffer, 0, buffer );
+}
+
+void GFXCommandBuffer::setTexture( U32 stage, GFXTextureObject *texture )
+{
+   AssertFatal( stage < TEXTURE_STAGE_COUNT, "GFXCommandBuffer::setTexture - Out of range texture stage!" );
+   _setObject( (SetObjectCommand*)_allocCommand( sizeof( SetObjectCommand ) ), CmdSetTexture, stage, texture );
+}
+
+void GFXCommandBuffer::setCubeTexture( U32 stage, GFXCubemap *cubemap )
+{
+   AssertFatal( stage < TEXTURE_STAGE_COUNT, "GFXCommandBuffer::setCubeTexture - Out of range texture stage!" );
+   _setObject( (SetObjectCommand*)_allocCommand( sizeof( SetObjectCommand ) ), CmdSetCubeTexture, stage, cubemap );
+}
+
+void GFXCommandBuffer::setVertexBuffer( GFXVertexBuffer *buffer )
+{
+   _setObject( (SetObjectCommand*)_allocCommand( sizeof( SetObjectCommand ) ), CmdSetVertexBuffer, 0, buffer );
+}
+
+void GFXCommandBuffer::setPrimitiveBuffer( GFXPrimitiveBuffer *buffer )
+{
+   _setObject( (SetObjectCommand*)_allocCommand( sizeof( SetObjectCommand ) ), CmdSetPrimitiveBuffer, 0, buffer );
+}
+
+void GFXCommandBuffer::setInstanceBuffer( GFXVertexBuffer *buffer, U32 instanceCount )
+{
+   _setObject( (SetObjectCommand*)_allocCommand( sizeof( SetObjectCommand ) ), CmdSetInstanceBuffer, instanceCount, buffer );
+}
+
+/// Records one of the matrix commands.
+static inline void _setMatrix( SetMatrixCommand *cmd, U32 type, const MatrixF &mat )
+{
+   cmd->header.type = type;
+   cmd->header.size = alignCommandSize( sizeof( SetMatrixCommand ) );
+   cmd->mat = mat;
+}
+
+void GFXCommandBuffer::setWorldMatrix( const MatrixF &mat )
+{
+   _setMatrix( (SetMatrixCommand*)_allocCommand( sizeof( SetMatrixCommand ) ), CmdSetWorldMatrix, mat );
+}
+
+void GFXCommandBuffer::setViewMatrix( const MatrixF &mat )
+{
+   _setMatrix( (SetMatrixCommand*)_allocCommand( sizeof( SetMatrixCommand ) ), CmdSetViewMatrix, mat );
+}
+
+void GFXCommandBuffer::setProjectionMatrix( const MatrixF &mat )
+{
+   _setMatrix( (SetMatrixCommand*)_allocCommand( sizeof( SetMatrixCommand ) ), CmdSetProjectionMatrix, mat );
+}
+
+void GFXCommandBuffer::drawPrimitive( GFXPrimitiveType primType, U32 vertexStart, U32 primitiveCount )
+{
+   DrawCommand *cmd = (DrawCommand*)_allocCommand( sizeof( DrawCommand ) );
+   cmd->header.type = CmdDrawPrimitive;
+   cmd->header.size = alignCommandSize( sizeof( DrawCommand ) );
+   cmd->primType = primType;
+   cmd->vertexStart = vertexStart;
+   cmd->primitiveCount = primitiveCount;
+   mDrawCount++;
+}
+
+void GFXCommandBuffer::drawIndexedPrimitive(  GFXPrimitiveType primType,
+                                             U32 startVertex,
+                                             U32 minIndex,
+                                             U32 numVerts,
+                                             U32 startIndex,
+                                             U32 primitiveCount )
+{
+   DrawIndexedCommand *cmd = (DrawIndexedCommand*)_allocCommand( sizeof( DrawIndexedCommand ) );
+   cmd->header.type = CmdDrawIndexedPrimitive;
+   cmd->header.size = alignCommandSize( sizeof( DrawIndexedCommand ) );
+   cmd->primType = primType;
+   cmd->startVertex = startVertex;
+   cmd->minIndex = minIndex;
+   cmd->numVerts = numVerts;
+   cmd->startIndex = startIndex;
+   cmd->primitiveCount = primitiveCount;
+   mDrawCount++;
+}
+
+void GFXCommandBuffer::drawPrimitive( const GFXPrimitive &prim )
+{
+   drawIndexedPrimitive(   prim.type,
+                           prim.startVertex,
+                           prim.minIndex,
+                           prim.numVertices,
+                           prim.startIndex,
+                           prim.numPrimitives );
+}
+
+//-----------------------------------------------------------------------------
+
+void GFXCommandBuffer::_setShaderConst(   GFXShaderConstBuffer *buffer,
+                                          GFXShaderConstHandle *handle,
+                                          U32 valueType,
+                                          U32 count,
+                                          U32 elementSize,
+                                          U32 matrixType,
+                                          const void *data,
+                                          U32 dataSize )
+{
+   AssertFatal( buffer, "GFXCommandBuffer::setShaderConst - NULL const buffer!" );
+
+   if ( !handle || !handle->isValid() )
+      return;
+
+   const U32 size = alignCommandSize( sizeof( SetConstCommand ) ) + dataSize;
+   SetConstCommand *cmd = (SetConstCommand*)_allocCommand( size );
+   cmd->header.type = CmdSetShaderConst;
+   cmd->header.size = alignCommandSize( size );
+   cmd->valueType = valueType;
+   cmd->matrixType = matrixType;
+   cmd->count = count;
+   cmd->elementSize = elementSize;
+   cmd->buffer = buffer;
+   cmd->handle = handle;
+   dMemcpy( getConstData( cmd ), data, dataSize );
+}
+
+#define IMPLEMENT_SET_CONST( type, valueType ) \
+   void GFXCommandBuffer::setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const type &fv ) \
+   { \
+      _setShaderConst( buffer, handle, valueType, 1, sizeof( type ), 0, &fv, sizeof( type ) ); \
+   }
+
+#define IMPLEMENT_SET_CONST_ARRAY( type, valueType ) \
+   void GFXCommandBuffer::setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const AlignedArray<type> &fv ) \
+   { \
+      _setShaderConst( buffer, handle, valueType, fv.size(), fv.getElementSize(), 0, fv.getBuffer(), fv.size() * fv.getElementSize() ); \
+   }
+
+IMPLEMENT_SET_CONST( Point2F, ConstPoint2F )
+IMPLEMENT_SET_CONST( Point3F, ConstPoint3F )
+IMPLEMENT_SET_CONST( Point4F, ConstPoint4F )
+IMPLEMENT_SET_CONST( PlaneF, ConstPlaneF )
+IMPLEMENT_SET_CONST( ColorF, ConstColorF )
+IMPLEMENT_SET_CONST( Point2I, ConstPoint2I )
+IMPLEMENT_SET_CONST( Point3I, ConstPoint3I )
+IMPLEMENT_SET_CONST( Point4I, ConstPoint4I )
+
+IMPLEMENT_SET_CONST_ARRAY( F32, ConstArrayF32 )
+IMPLEMENT_SET_CONST_ARRAY( Point2F, ConstArrayPoint2F )
+IMPLEMENT_SET_CONST_ARRAY( Point3F, ConstArrayPoint3F )
+IMPLEMENT_SET_CONST_ARRAY( Point4F, ConstArrayPoint4F )
+IMPLEMENT_SET_CONST_ARRAY( S32, ConstArrayS32 )
+IMPLEMENT_SET_CONST_ARRAY( Point2I, ConstArrayPoint2I )
+IMPLEMENT_SET_CONST_ARRAY( Point3I, ConstArrayPoint3I )
+IMPLEMENT_SET_CONST_ARRAY( Point4I, ConstArrayPoint4I )
+
+#undef IMPLEMENT_SET_CONST
+#undef IMPLEMENT_SET_CONST_ARRAY
+
+void GFXCommandBuffer::setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const F32 f )
+{
+   _setShaderConst( buffer, handle, ConstF32, 1, sizeof( F32 ), 0, &f, sizeof( F32 ) );
+}
+
+void GFXCommandBuffer::setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const S32 f )
+{
+   _setShaderConst( buffer, handle, ConstS32, 1, sizeof( S32 ), 0, &f, sizeof( S32 ) );
+}
+
+void GFXCommandBuffer::setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const MatrixF &mat, const GFXShaderConstType matrixType )
+{
+   _setShaderConst( buffer, handle, ConstMatrix, 1, sizeof( MatrixF ), matrixType, &mat, sizeof( MatrixF ) );
+}
+
+void GFXCommandBuffer::setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const MatrixF *mat, const U32 arraySize, const GFXShaderConstType matrixType )
+{
+   _setShaderConst( buffer, handle, ConstMatrixArray, arraySize, sizeof( MatrixF ), matrixType, mat, arraySize * sizeof( MatrixF ) );
+}
+
+//-----------------------------------------------------------------------------
+
+void GFXCommandBuffer::execute( GFXDevice *device ) const
+{
+   PROFILE_SCOPE( GFXCommandBuffer_execute );
+
+   AssertFatal( device, "GFXCommandBuffer::execute - NULL device!" );
+
+   const U8 *ptr = mBuffer;
+   const U8 *end = mBuffer + mSize;
+
+   while ( ptr < end )
+   {
+      const CommandHeader *header = (const CommandHeader*)ptr;
+      AssertFatal( header->size > 0 && ptr + header->size <= end, "GFXCommandBuffer::execute - Corrupt command buffer!" );
+
+      switch ( header->type )
+      {
+         case CmdClear:
+         {
+            const ClearCommand *cmd = (const ClearCommand*)ptr;
+            device->clear( cmd->flags, cmd->color, cmd->z, cmd->stencil );
+            break;
+         }
+
+         case CmdSetStateBlock:
+            device->setStateBlock( (GFXStateBlock*)((const SetObjectCommand*)ptr)->object );
+            break;
+
+         case CmdSetShader:
+            device->setShader( (GFXShader*)((const SetObjectCommand*)ptr)->object );
+            break;
+
+         case CmdSetShaderConstBuffer:
+            device->setShaderConstBuffer( (GFXShaderConstBuffer*)((const SetObjectCommand*)ptr)->object );
+            break;
+
+         case CmdSetShaderConst:
+            executeSetConst( (const SetConstCommand*)ptr );
+            break;
+
+         case CmdSetTexture:
+         {
+            const SetObjectCommand *cmd = (const SetObjectCommand*)ptr;
+            device->setTexture( cmd->param, (GFXTextureObject*)cmd->object );
+            break;
+         }
+
+         case CmdSetCubeTexture:
+         {
+            const SetObjectCommand *cmd = (const SetObjectCommand*)ptr;
+            device->setCubeTexture( cmd->param, (GFXCubemap*)cmd->object );
+            break;
+         }
+
+         case CmdSetVertexBuffer:
+            device->setVertexBuffer( (GFXVertexBuffer*)((const SetObjectCommand*)ptr)->object );
+            break;
+
+         case CmdSetPrimitiveBuffer:
+            device->setPrimitiveBuffer( (GFXPrimitiveBuffer*)((const SetObjectCommand*)ptr)->object );
+            break;
+
+         case CmdSetInstanceBuffer:
+         {
+            const SetObjectCommand *cmd = (const SetObjectCommand*)ptr;
+            device->setInstanceBuffer( (GFXVertexBuffer*)cmd->object, cmd->param );
+            break;
+         }
+
+         case CmdSetWorldMatrix:
+            device->setWorldMatrix( ((const SetMatrixCommand*)ptr)->mat );
+            break;
+
+         case CmdSetViewMatrix:
+            device->setViewMatrix( ((const SetMatrixCommand*)ptr)->mat );
+            break;
+
+         case CmdSetProjectionMatrix:
+            device->setProjectionMatrix( ((const SetMatrixCommand*)ptr)->mat );
+            break;
+
+         case CmdDrawPrimitive:
+         {
+            const DrawCommand *cmd = (const DrawCommand*)ptr;
+            device->drawPrimitive( (GFXPrimitiveType)cmd->primType, cmd->vertexStart, cmd->primitiveCount );
+            break;
+         }
+
+         case CmdDrawIndexedPrimitive:
+         {
+            const DrawIndexedCommand *cmd = (const DrawIndexedCommand*)ptr;
+            device->drawIndexedPrimitive(   (GFXPrimitiveType)cmd->primType,
+                                             cmd->startVertex,
+                                             cmd->minIndex,
+                                             cmd->numVerts,
+                                             cmd->startIndex,
+                                             cmd->primitiveCount );
+            break;
+         }
+
+         default:
+            AssertFatal( false, "GFXCommandBuffer::execute - Unknown command!" );
+            break;
+      }
+
+      ptr += header->size;
+   }
+}
@@ -0,0 +1,197 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _GFXCOMMANDBUFFER_H_
+#define _GFXCOMMANDBUFFER_H_
+
+#ifndef _GFXENUMS_H_
+#include "gfx/gfxEnums.h"
+#endif
+#ifndef _GFXSHADER_H_
+#include "gfx/gfxShader.h"
+#endif
+#ifndef _COLOR_H_
+#include "core/color.h"
+#endif
+
+class GFXDevice;
+class GFXStateBlock;
+class GFXTextureObject;
+class GFXCubemap;
+class GFXVertexBuffer;
+class GFXPrimitiveBuffer;
+struct GFXPrimitive;
+
+
+/// Records GFX state, shader constant and draw calls into a compact linear
+/// buffer so they can be submitted to the device later.
+///
+/// Recording never touches the device, so any thread can fill a command
+/// buffer while the device thread is busy.  A single buffer must only be
+/// used by one thread at a time, but separate buffers can be recorded in
+/// parallel and then executed in order on the device thread.
+///
+/// The buffer stores raw pointers and does not take references, since the
+/// reference counts are not thread safe.  Everything passed in must stay
+/// alive until the buffer has been executed, which is always the case for
+/// objects owned by materials and render instances within a frame.  State
+/// blocks have to be created up front with GFXDevice::createStateBlock.
+///
+/// Shader constant values are copied at record time, so the same constant
+/// can be recorded with different values for every draw.
+///
+/// @code
+///   GFXCommandBuffer cmds;
+///   cmds.setStateBlock( mStateBlock );
+///   cmds.setShaderConstBuffer( mConsts );
+///   cmds.setShaderConst( mConsts, mColorSC, ColorF::RED );
+///   cmds.setVertexBuffer( mVB );
+///   cmds.drawPrimitive( GFXTriangleList, 0, 2 );
+///
+///   // Later on the device thread...
+///   cmds.execute( GFX );
+/// @endcode
+class GFXCommandBuffer
+{
+public:
+
+   GFXCommandBuffer();
+   ~GFXCommandBuffer();
+
+   /// @name Recording
+   /// These mirror the GFXDevice methods of the same name.
+   /// @{
+
+   void clear( U32 flags, ColorI color, F32 z, U32 stencil );
+
+   void setStateBlock( GFXStateBlock *block );
+
+   void setShader( GFXShader *shader );
+
+   void setShaderConstBuffer( GFXShaderConstBuffer *buffer );
+
+   void setTexture( U32 stage, GFXTextureObject *texture );
+
+   void setCubeTexture( U32 stage, GFXCubemap *cubemap );
+
+   void setVertexBuffer( GFXVertexBuffer *buffer );
+
+   void setPrimitiveBuffer( GFXPrimitiveBuffer *buffer );
+
+   void setInstanceBuffer( GFXVertexBuffer *buffer, U32 instanceCount );
+
+   void setWorldMatrix( const MatrixF &mat );
+
+   void setViewMatrix( const MatrixF &mat );
+
+   void setProjectionMatrix( const MatrixF &mat );
+
+   void drawPrimitive( GFXPrimitiveType primType, U32 vertexStart, U32 primitiveCount );
+
+   void drawIndexedPrimitive( GFXPrimitiveType primType,
+                              U32 startVertex,
+                              U32 minIndex,
+                              U32 numVerts,
+                              U32 startIndex,
+                              U32 primitiveCount );
+
+   void drawPrimitive( const GFXPrimitive &prim );
+
+   /// @}
+
+   /// @name Shader Constants
+   /// These mirror GFXShaderConstBuffer::set() and copy the value into the
+   /// command buffer.  Invalid handles are ignored.
+   /// @{
+
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const F32 f );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const Point2F &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const Point3F &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const Point4F &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const PlaneF &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const ColorF &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const S32 f );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const Point2I &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const Point3I &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const Point4I &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const AlignedArray<F32> &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const AlignedArray<Point2F> &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const AlignedArray<Point3F> &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const AlignedArray<Point4F> &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const AlignedArray<S32> &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const AlignedArray<Point2I> &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const AlignedArray<Point3I> &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const AlignedArray<Point4I> &fv );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const MatrixF &mat, const GFXShaderConstType matrixType = GFXSCT_Float4x4 );
+   void setShaderConst( GFXShaderConstBuffer *buffer, GFXShaderConstHandle *handle, const MatrixF *mat, const U32 arraySize, const GFXShaderConstType matrixType = GFXSCT_Float4x4 );
+
+   /// @}
+
+   /// Appends all the commands recorded in another buffer.  Use this
+   /// to merge buffers that were recorded in parallel.  The buffer
+   /// cannot be appended to itself.
+   void append( const GFXCommandBuffer &buffer );
+
+   /// Submits all the recorded commands to the device in the order they
+   /// were recorded.  Must be called from the device thread.  The commands
+   /// are kept, so the buffer can be executed more than once.
+   void execute( GFXDevice *device ) const;
+
+   /// Discards the recorded commands but keeps the memory for reuse.
+   void reset();
+
+   /// Returns true if nothing has been recorded.
+   bool isEmpty() const { return mCommandCount == 0; }
+
+   /// Returns the number of recorded commands.
+   U32 getCommandCount() const { return mCommandCount; }
+
+   /// Returns the number of draw commands recorded.
+   U32 getDrawCount() const { return mDrawCount; }
+
+   /// Returns the size of the recorded commands in bytes.
+   U32 getSize() const { return mSize; }
+
+protected:
+
+   /// Reserves space for a command of the given size at the end
+   /// of the buffer and returns a pointer to it.  The pointer is
+   /// only valid until the next command is recorded.
+   void* _allocCommand( U32 size );
+
+   /// Grows mBuffer to hold at least the given number of bytes.
+   void _reserve( U32 size );
+
+   /// Records a shader constant of the given type.
+   void _setShaderConst(   GFXShaderConstBuffer *buffer,
+                           GFXShaderConstHandle *handle,
+                           U32 valueType,
+                           U32 count,
+                           U32 elementSize,
+                           U32 matrixType,
+                           const void *data,
+                           U32 dataSize );
+
+   /// The recorded commands in a 16 byte aligned block.
+   U8 *mBuffer;
+
+   /// The size of the recorded commands in bytes.
+   U32 mSize;
+
+   /// The allocated size of mBuffer.
+   U32 mCapacity;
+
+   U32 mCommandCount;
+
+   U32 mDrawCount;
+
+private:
+
+   // Not copyable.
+   GFXCommandBuffer( const GFXCommandBuffer& );
+   GFXCommandBuffer& operator=( const GFXCommandBuffer& );
+};
+
+#endif // _GFXCOMMANDBUFFER_H_
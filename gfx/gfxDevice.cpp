@@ -15,6 +15,7 @@
 #include "gfx/gfxFontRenderBatcher.h"
 #include "gfx/gfxPrimitiveBuffer.h"
 #include "gfx/gfxShader.h"
+#include "gfx/gfxShaderCache.h"
 #include "gfx/gfxStateBlock.h"
 #include "gfx/screenshot.h"
 #include "gfx/gfxStringEnumTranslate.h"
@@ -37,6 +38,8 @@ void GFXDevice::initConsole()
 
    Con::addVariable( "$gfx::wireframe", TypeBool, &GFXDevice::smWireframe );
    Con::addVariable( "$gfx::disassembleAllShaders", TypeBool, &gDisassembleAllShaders );
+
+   GFXShaderCache::initConsole();
 }
 //-----------------------------------------------------------------------------
 
@@ -74,6 +77,10 @@ GFXDevice::GFXDevice()
    
    // Primitive buffer cache
    mPrimitiveBufferDirty = false;
+
+   // Instance buffer cache
+   mInstanceCount = 0;
+   mInstanceBufferDirty = false;
    mTexturesDirty = false;
    
    // Use of TEXTURE_STAGE_COUNT in initialization is okay [7/2/2007 Pat]
@@ -202,6 +209,7 @@ GFXDevice::~GFXDevice()
    // Clean up our current PB, if any.
    mCurrentPrimitiveBuffer = NULL;
    mCurrentVertexBuffer = NULL;
+   mCurrentInstanceBuffer = NULL;
 
    // Clear out our current texture references
    for (U32 i = 0; i < TEXTURE_STAGE_COUNT; i++)
@@ -287,6 +295,8 @@ void GFXDevice::setStateBlock(GFXStateBlock* block)
       mStateBlockDirty = true;
       mNewStateBlock = block;
    } else {
+      if ( !mStateBlockDirty )
+         mDeviceStatistics.mRedundantStateBlocks++;
       mStateBlockDirty = false;
       mNewStateBlock = mCurrentStateBlock;
    }
@@ -330,6 +340,9 @@ void GFXDevice::updateStates(bool forceSetAll /*=false*/)
       if(mCurrentVertexBuffer.isValid())
          mCurrentVertexBuffer->prepare();
 
+      setInstanceBufferInternal( mCurrentInstanceBuffer, mInstanceCount );
+      mInstanceBufferDirty = false;
+
       if( mCurrentPrimitiveBuffer.isValid() ) // This could be NULL when the device is initalizing
          mCurrentPrimitiveBuffer->prepare();
 
@@ -429,6 +442,14 @@ void GFXDevice::updateStates(bool forceSetAll /*=false*/)
          mCurrentVertexBuffer->prepare();
       mVertexBufferDirty = false;
    }
+
+   // Update the instance stream after the vertex buffer
+   // as the device may need to combine their declarations.
+   if( mInstanceBufferDirty )
+   {
+      setInstanceBufferInternal( mCurrentInstanceBuffer, mInstanceCount );
+      mInstanceBufferDirty = false;
+   }
    
    // Update primitive buffer
    //
@@ -448,7 +469,17 @@ void GFXDevice::updateStates(bool forceSetAll /*=false*/)
    // the texture is activated.
    if (mStateBlockDirty)
    {
-      setStateBlockInternal(mNewStateBlock, false);
+      // Different blocks can still describe the same device state, so
+      // only hand the block to the device if the descriptors differ.
+      if (  mCurrentStateBlock.isValid() &&
+            mCurrentStateBlock->getDescriptor() == mNewStateBlock->getDescriptor() )
+         mDeviceStatistics.mRedundantStateBlocks++;
+      else
+      {
+         setStateBlockInternal(mNewStateBlock, false);
+         mDeviceStatistics.mStateBlockChanges++;
+      }
+
       mCurrentStateBlock = mNewStateBlock;
       mStateBlockDirty = false;
    }
@@ -814,6 +845,15 @@ void GFXDevice::setTexture( U32 stage, GFXTextureObject *texture )
 {
    AssertFatal(stage < getNumSamplers(), "GFXDevice::setTexture - out of range stage!");
 
+   // Let the mip streaming know the texture is in use.
+   if ( texture && texture->isStreamed() )
+   {
+      GFXTextureStreamState *stream = texture->mStream;
+      const U32 frame = GFXTextureManager::getStreamingFrame();
+      stream->numBinds = stream->lastBound == frame ? stream->numBinds + 1 : 1;
+      stream->lastBound = frame;
+   }
+
    if (  mTexType[stage] == GFXTDT_Normal &&
          (  ( mTextureDirty[stage] && mNewTexture[stage].getPointer() == texture ) ||
             ( !mTextureDirty[stage] && mCurrentTexture[stage].getPointer() == texture ) ) )
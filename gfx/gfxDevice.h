@@ -523,6 +523,17 @@ protected:
    StrongRefPtr<GFXPrimitiveBuffer> mCurrentPrimitiveBuffer;
    bool mPrimitiveBufferDirty;
 
+   /// The per-instance stream and instance count.
+   /// @see setInstanceBuffer
+   StrongRefPtr<GFXVertexBuffer> mCurrentInstanceBuffer;
+   U32 mInstanceCount;
+   bool mInstanceBufferDirty;
+
+   /// Called from updateStates() to bind the stream set with
+   /// setInstanceBuffer().  Only devices which return true from
+   /// supportsInstancing() need to implement this.
+   virtual void setInstanceBufferInternal( GFXVertexBuffer *buffer, U32 instanceCount ) {}
+
    /// This allocates a primitive buffer and returns a pointer to the allocated buffer.
    /// A primitive buffer's type argument refers to the index data - the primitive data will
    /// always be preserved from call to call.
@@ -662,6 +673,22 @@ public:
 
    void setPrimitiveBuffer( GFXPrimitiveBuffer *buffer );
    void setVertexBuffer( GFXVertexBuffer *buffer );
+
+   /// Returns true if the device can draw indexed primitives
+   /// multiple times from a per-instance vertex stream.
+   /// @see setInstanceBuffer
+   virtual bool supportsInstancing() const { return false; }
+
+   /// Sets a second vertex stream whose elements advance once per
+   /// instance instead of once per vertex.  While it is set, indexed
+   /// draw calls render their primitives instanceCount times.  Pass
+   /// NULL to return to regular drawing.
+   /// @see supportsInstancing
+   void setInstanceBuffer( GFXVertexBuffer *buffer, U32 instanceCount );
+
+   /// Returns the instance count set with setInstanceBuffer or zero
+   /// if instancing is disabled.
+   U32 getInstanceCount() const { return mInstanceCount; }
    
    virtual void drawPrimitive( GFXPrimitiveType primType, U32 vertexStart, U32 primitiveCount ) = 0;
 
@@ -965,4 +992,20 @@ inline void GFXDevice::setVertexBuffer( GFXVertexBuffer *buffer )
    mStateDirty = true;
 }
 
+inline void GFXDevice::setInstanceBuffer( GFXVertexBuffer *buffer, U32 instanceCount )
+{
+   AssertFatal( !buffer || supportsInstancing(), "GFXDevice::setInstanceBuffer - This device does not support instancing!" );
+
+   if ( !buffer )
+      instanceCount = 0;
+
+   if ( buffer == mCurrentInstanceBuffer && instanceCount == mInstanceCount )
+      return;
+
+   mCurrentInstanceBuffer = buffer;
+   mInstanceCount = instanceCount;
+   mInstanceBufferDirty = true;
+   mStateDirty = true;
+}
+
 #endif // _GFXDEVICE_H_
@@ -19,6 +19,10 @@ void GFXDeviceStatistics::setPrefix(const String& prefix)
    vnPolyCount = prefix + "polyCount";
    vnDrawCalls = prefix + "drawCalls";
    vnRenderTargetChanges = prefix + "renderTargetChanges";
+   vnStateBlockChanges = prefix + "stateBlockChanges";
+   vnRedundantStateBlocks = prefix + "redundantStateBlocks";
+   vnShaderConstChanges = prefix + "shaderConstChanges";
+   vnRedundantShaderConsts = prefix + "redundantShaderConsts";
 }
 
 /// Clear stats
@@ -27,6 +31,10 @@ void GFXDeviceStatistics::clear()
    mPolyCount = 0;
    mDrawCalls = 0;
    mRenderTargetChanges = 0;
+   mStateBlockChanges = 0;
+   mRedundantStateBlocks = 0;
+   mShaderConstChanges = 0;
+   mRedundantShaderConsts = 0;
 }
 
 /// Copy from source (should just be a memcpy, but that may change later) used in 
@@ -37,6 +45,10 @@ void GFXDeviceStatistics::start(GFXDeviceStatistics * source)
    mPolyCount = source->mPolyCount;
    mDrawCalls = source->mDrawCalls;
    mRenderTargetChanges = source->mRenderTargetChanges;
+   mStateBlockChanges = source->mStateBlockChanges;
+   mRedundantStateBlocks = source->mRedundantStateBlocks;
+   mShaderConstChanges = source->mShaderConstChanges;
+   mRedundantShaderConsts = source->mRedundantShaderConsts;
 }
 
 /// Used with start to get a subset of stats on a device.  Basically will do
@@ -46,6 +58,10 @@ void GFXDeviceStatistics::end(GFXDeviceStatistics * source)
    mPolyCount = source->mPolyCount - mPolyCount;
    mDrawCalls = source->mDrawCalls - mDrawCalls;
    mRenderTargetChanges = source->mRenderTargetChanges - mRenderTargetChanges;   
+   mStateBlockChanges = source->mStateBlockChanges - mStateBlockChanges;
+   mRedundantStateBlocks = source->mRedundantStateBlocks - mRedundantStateBlocks;
+   mShaderConstChanges = source->mShaderConstChanges - mShaderConstChanges;
+   mRedundantShaderConsts = source->mRedundantShaderConsts - mRedundantShaderConsts;
 }
 
 /// Exports the stats to the console
@@ -54,4 +70,8 @@ void GFXDeviceStatistics::exportToConsole()
    Con::setIntVariable(vnPolyCount, mPolyCount);
    Con::setIntVariable(vnDrawCalls, mDrawCalls);
    Con::setIntVariable(vnRenderTargetChanges, mRenderTargetChanges);
+   Con::setIntVariable(vnStateBlockChanges, mStateBlockChanges);
+   Con::setIntVariable(vnRedundantStateBlocks, mRedundantStateBlocks);
+   Con::setIntVariable(vnShaderConstChanges, mShaderConstChanges);
+   Con::setIntVariable(vnRedundantShaderConsts, mRedundantShaderConsts);
 }
\ No newline at end of file
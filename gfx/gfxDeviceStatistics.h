@@ -18,6 +18,20 @@ public:
    S32 mDrawCalls;
    S32 mRenderTargetChanges;
 
+   /// State blocks which were sent to the device.
+   S32 mStateBlockChanges;
+
+   /// State block sets which were filtered out because the
+   /// device already had the same state.
+   S32 mRedundantStateBlocks;
+
+   /// Shader constants which were uploaded to the device.
+   S32 mShaderConstChanges;
+
+   /// Shader constant sets which were filtered out because the
+   /// value was unchanged or already on the device.
+   S32 mRedundantShaderConsts;
+
    GFXDeviceStatistics();
 
    void setPrefix(const String& prefix);
@@ -40,6 +54,10 @@ private:
    String vnPolyCount;
    String vnDrawCalls;
    String vnRenderTargetChanges;
+   String vnStateBlockChanges;
+   String vnRedundantStateBlocks;
+   String vnShaderConstChanges;
+   String vnRedundantShaderConsts;
 };
 
 #endif
\ No newline at end of file
@@ -211,6 +211,10 @@ public:
    /// @see addGlobalMacro
    static bool removeGlobalMacro( const String &name );
 
+   /// Returns the global shader macros.
+   /// @see addGlobalMacro
+   static const Vector<GFXShaderMacro>& getGlobalMacros() { return smGlobalMacros; }
+
    /// Toggle logging for shader errors.
    static void setLogging( bool logErrors,
                            bool logWarning ) 
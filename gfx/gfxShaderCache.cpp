@@ -0,0 +1,451 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "gfx/gfxShaderCache.h"
+
+#include "gfx/gfxShader.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "core/stream/fileStream.h"
+#include "core/strings/stringUnit.h"
+#include "core/util/fourcc.h"
+#include "core/util/hashFunction.h"
+#include "core/volume.h"
+#include "platform/platformIntrinsics.h"
+#include "platform/threads/threadPool.h"
+#include "platform/threads/thread.h"
+
+
+bool GFXShaderCache::smEnabled = true;
+String GFXShaderCache::smCachePath;
+Vector<GFXShaderCache::ManifestEntry> GFXShaderCache::smManifest;
+GFXShaderCache::PrecompileDelegate GFXShaderCache::smPrecompiler;
+volatile U32 GFXShaderCache::smPendingWarmUps = 0;
+volatile U32 GFXShaderCache::smCancelWarmUp = 0;
+volatile U32 GFXShaderCache::smHits = 0;
+volatile U32 GFXShaderCache::smMisses = 0;
+volatile U32 GFXShaderCache::smAsyncCompiles = 0;
+
+/// The file tag for cache entries.
+static const U32 sCacheEntryTag = MakeFourCC( 't', 's', 'c', 'e' );
+
+/// Bump this when the entry format changes.
+static const U32 sCacheEntryVersion = 1;
+
+/// The file name of the manifest within the cache directory.
+static const char *sManifestFileName = "shaderCache.manifest";
+
+
+void GFXShaderCache::initConsole()
+{
+   Con::addVariable( "$pref::video::shaderCache", TypeBool, &smEnabled );
+   Con::addVariable( "$pref::video::shaderCachePath", TypeRealString, &smCachePath );
+}
+
+Torque::Path GFXShaderCache::getCachePath()
+{
+   // By default the cache lives with the generated shaders.
+   if ( smCachePath.isEmpty() )
+      return Torque::Path( "shadergen:/" );
+
+   return Torque::Path( smCachePath + "/" );
+}
+
+U64 GFXShaderCache::computeKey( const String &description, const void *source, U32 sourceSize )
+{
+   U64 key = Torque::hash64( (const U8*)description.c_str(), description.length(), sCacheEntryVersion );
+   return Torque::hash64( (const U8*)source, sourceSize, key );
+}
+
+U64 GFXShaderCache::hashFile( const Torque::Path &path )
+{
+   void *data;
+   U32 size;
+   if ( !Torque::FS::ReadFile( path, data, size ) || !data )
+      return 0;
+
+   const U64 hash = Torque::hash64( (const U8*)data, size, 0 );
+   delete [] (char*)data;
+
+   // Zero means missing, so make sure we never return it.
+   return hash ? hash : 1;
+}
+
+/// Returns the path of the entry for a key.
+static Torque::Path _getEntryPath( U64 key )
+{
+   Torque::Path path( GFXShaderCache::getCachePath() );
+   path.setFileName( String::ToString( "%08x%08x", (U32)( key >> 32 ), (U32)( key & 0xFFFFFFFF ) ) );
+   path.setExtension( "tsc" );
+   return path;
+}
+
+bool GFXShaderCache::load( U64 key, Vector<U8> &outData )
+{
+   PROFILE_SCOPE( GFXShaderCache_Load );
+
+   if ( !smEnabled )
+      return false;
+
+   FileStream stream;
+   if ( !stream.open( _getEntryPath( key ), Torque::FS::File::Read ) )
+   {
+      dFetchAndAdd( smMisses, 1 );
+      return false;
+   }
+
+   bool valid = false;
+
+   U32 tag, version, depCount;
+   U64 storedKey;
+   if (  stream.read( &tag ) && tag == sCacheEntryTag &&
+         stream.read( &version ) && version == sCacheEntryVersion &&
+         stream.read( &storedKey ) && storedKey == key &&
+         stream.read( &depCount ) )
+   {
+      valid = true;
+
+      // Any change to an included file invalidates the entry.
+      for ( U32 i=0; valid && i < depCount; i++ )
+      {
+         String path;
+         U64 hash;
+         stream.read( &path );
+         valid = stream.read( &hash ) && hashFile( path ) == hash;
+      }
+
+      // The payload must fill the rest of the file exactly, so a bad
+      // size is rejected before we allocate for it.
+      U32 size;
+      U64 dataHash;
+      if (  valid && stream.read( &size ) && stream.read( &dataHash ) && size > 0 &&
+            size == stream.getStreamSize() - stream.getPosition() )
+      {
+         outData.setSize( size );
+         valid =  stream.read( size, outData.address() ) &&
+                  Torque::hash64( outData.address(), size, 0 ) == dataHash;
+      }
+      else
+         valid = false;
+   }
+
+   if ( !valid )
+   {
+      outData.clear();
+      dFetchAndAdd( smMisses, 1 );
+      return false;
+   }
+
+   dFetchAndAdd( smHits, 1 );
+   return true;
+}
+
+bool GFXShaderCache::store( U64 key, const Vector<Dependency> &dependencies, const void *data, U32 size )
+{
+   PROFILE_SCOPE( GFXShaderCache_Store );
+
+   if ( !smEnabled || !data || size == 0 )
+      return false;
+
+   // The entry is written to a temporary file and then moved into
+   // place, so a load never sees a partially written entry.  Workers
+   // may store the same key at once, so the name includes the thread.
+   const Torque::Path path = _getEntryPath( key );
+   Torque::Path tempPath( path );
+   tempPath.setFileName( path.getFileName() + String::ToString( ".%x", ThreadManager::getCurrentThreadId() ) );
+   tempPath.setExtension( "tmp" );
+
+   FileStream stream;
+   if ( !stream.open( tempPath, Torque::FS::File::Write ) )
+      return false;
+
+   stream.write( sCacheEntryTag );
+   stream.write( sCacheEntryVersion );
+   stream.write( key );
+
+   stream.write( (U32)dependencies.size() );
+   for ( U32 i=0; i < dependencies.size(); i++ )
+   {
+      stream.write( dependencies[i].path.getFullPath() );
+      stream.write( dependencies[i].hash );
+   }
+
+   stream.write( size );
+   stream.write( Torque::hash64( (const U8*)data, size, 0 ) );
+   const bool written = stream.write( size, data ) && stream.getStatus() == Stream::Ok;
+   stream.close();
+
+   if ( !written )
+   {
+      Torque::FS::Remove( tempPath );
+      return false;
+   }
+
+   // Not every platform can rename over an existing file.
+   Torque::FS::Remove( path );
+   if ( !Torque::FS::Rename( tempPath, path ) )
+   {
+      Torque::FS::Remove( tempPath );
+      return false;
+   }
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+// Manifest
+//-----------------------------------------------------------------------------
+
+const GFXShaderCache::ManifestEntry* GFXShaderCache::findInManifest( const String &key )
+{
+   for ( U32 i=0; i < smManifest.size(); i++ )
+   {
+      if ( smManifest[i].key == key )
+         return &smManifest[i];
+   }
+
+   return NULL;
+}
+
+void GFXShaderCache::addToManifest( const ManifestEntry &entry )
+{
+   if ( !smEnabled )
+      return;
+
+   bool found = false;
+   for ( U32 i=0; i < smManifest.size(); i++ )
+   {
+      if ( smManifest[i].key == entry.key )
+      {
+         smManifest[i] = entry;
+         found = true;
+         break;
+      }
+   }
+
+   if ( !found )
+      smManifest.push_back( entry );
+
+   // Append it so that we never rewrite the whole file.  When
+   // loading the last entry for a key wins.
+   Torque::Path path( getCachePath() );
+   path.setFileName( sManifestFileName );
+
+   FileStream stream;
+   if ( stream.open( path, Torque::FS::File::WriteAppend ) )
+      _writeManifestEntry( stream, entry );
+}
+
+void GFXShaderCache::loadManifest()
+{
+   PROFILE_SCOPE( GFXShaderCache_LoadManifest );
+
+   smManifest.clear();
+
+   if ( !smEnabled )
+      return;
+
+   Torque::Path path( getCachePath() );
+   path.setFileName( sManifestFileName );
+
+   void *data;
+   U32 size;
+   if ( !Torque::FS::ReadFile( path, data, size, true ) || !data )
+      return;
+
+   const char *line = (const char*)data;
+   while ( *line )
+   {
+      const char *end = dStrchr( line, '\n' );
+      if ( !end )
+         end = line + dStrlen( line );
+
+      ManifestEntry entry;
+      const bool valid = _readManifestEntry( String( line, end - line ), &entry );
+      line = *end ? end + 1 : end;
+
+      if ( !valid )
+         continue;
+
+      // Later entries replace earlier ones.
+      bool found = false;
+      for ( U32 j=0; j < smManifest.size(); j++ )
+      {
+         if ( smManifest[j].key == entry.key )
+         {
+            smManifest[j] = entry;
+            found = true;
+            break;
+         }
+      }
+
+      if ( !found )
+         smManifest.push_back( entry );
+   }
+
+   delete [] (char*)data;
+}
+
+void GFXShaderCache::clearManifest()
+{
+   smManifest.clear();
+}
+
+void GFXShaderCache::_writeManifestEntry( Stream &stream, const ManifestEntry &entry )
+{
+   String macros;
+   GFXShaderMacro::stringize( entry.macros, &macros );
+
+   String line = String::ToString( "%s\t%g\t%s\t%s\t%08x%08x\t%08x%08x\t%s\n",
+      entry.key.c_str(),
+      entry.pixVersion,
+      entry.vertFile.getFullPath().c_str(),
+      entry.pixFile.getFullPath().c_str(),
+      (U32)( entry.vertHash >> 32 ), (U32)( entry.vertHash & 0xFFFFFFFF ),
+      (U32)( entry.pixHash >> 32 ), (U32)( entry.pixHash & 0xFFFFFFFF ),
+      macros.c_str() );
+
+   stream.write( line.length(), line.c_str() );
+}
+
+bool GFXShaderCache::_readManifestEntry( const String &line, ManifestEntry *outEntry )
+{
+   const char *text = line.c_str();
+   if ( StringUnit::getUnitCount( text, "\t\r" ) < 6 )
+      return false;
+
+   outEntry->key = StringUnit::getUnit( text, 0, "\t\r" );
+   outEntry->pixVersion = dAtof( StringUnit::getUnit( text, 1, "\t\r" ) );
+   outEntry->vertFile = String( StringUnit::getUnit( text, 2, "\t\r" ) );
+   outEntry->pixFile = String( StringUnit::getUnit( text, 3, "\t\r" ) );
+
+   U32 high, low;
+   if ( dSscanf( StringUnit::getUnit( text, 4, "\t\r" ), "%8x%8x", &high, &low ) != 2 )
+      return false;
+   outEntry->vertHash = ( (U64)high << 32 ) | low;
+
+   if ( dSscanf( StringUnit::getUnit( text, 5, "\t\r" ), "%8x%8x", &high, &low ) != 2 )
+      return false;
+   outEntry->pixHash = ( (U64)high << 32 ) | low;
+
+   // The macros are stored as "NAME=VALUE;NAME;".
+   outEntry->macros.clear();
+   const String macros = StringUnit::getUnit( text, 6, "\t\r" );
+   const U32 macroCount = StringUnit::getUnitCount( macros, ";" );
+   for ( U32 i=0; i < macroCount; i++ )
+   {
+      const String macro = StringUnit::getUnit( macros, i, ";" );
+      outEntry->macros.increment();
+      GFXShaderMacro &out = outEntry->macros.last();
+      out.name = StringUnit::getUnit( macro, 0, "=" );
+      out.value = StringUnit::getUnit( macro, 1, "=" );
+   }
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+// Warm Up
+//-----------------------------------------------------------------------------
+
+/// Compiles both stages of a manifest entry into the cache.
+struct GFXShaderCache::CompileItem : public ThreadPool::WorkItem
+{
+   ManifestEntry mEntry;
+
+   /// Only set for async compiles.
+   AsyncCompileRef mAsync;
+
+   CompileItem( const ManifestEntry &entry, AsyncCompile *async = NULL )
+      : mEntry( entry ),
+        mAsync( async )
+   {
+      // The global macros are merged in here, as the workers
+      // cannot read them while the main thread changes them.
+      mEntry.macros.clear();
+      mEntry.macros.merge( GFXShader::getGlobalMacros() );
+      mEntry.macros.merge( entry.macros );
+
+      dFetchAndAdd( smPendingWarmUps, 1 );
+   }
+
+   virtual ~CompileItem()
+   {
+      // Done here so that items dropped by the pool are counted too.
+      if ( mAsync )
+      {
+         dFetchAndAdd( smAsyncCompiles, 1 );
+         mAsync->done = 1;
+      }
+
+      dFetchAndAdd( smPendingWarmUps, (U32)-1 );
+   }
+
+   virtual F32 getPriority()
+   {
+      // Something is waiting to render with an async compile.
+      return mAsync ? 2.0f : 1.0f;
+   }
+
+protected:
+
+   virtual void execute()
+   {
+      if ( smCancelWarmUp || smPrecompiler.empty() )
+         return;
+
+      // Skip shaders whose generated source is gone or has changed
+      // since they were added, the next run will add them again.
+      if (  hashFile( mEntry.vertFile ) != mEntry.vertHash ||
+            hashFile( mEntry.pixFile ) != mEntry.pixHash )
+         return;
+
+      smPrecompiler( mEntry.vertFile, true, mEntry.pixVersion, mEntry.macros );
+
+      if ( !smCancelWarmUp )
+         smPrecompiler( mEntry.pixFile, false, mEntry.pixVersion, mEntry.macros );
+   }
+};
+
+void GFXShaderCache::startWarmUp()
+{
+   if ( !smEnabled || smPrecompiler.empty() || smManifest.empty() )
+      return;
+
+   Con::printf( "GFXShaderCache: Warming up %d shaders.", smManifest.size() );
+
+   smCancelWarmUp = 0;
+
+   for ( U32 i=0; i < smManifest.size(); i++ )
+      ThreadPool::GLOBAL().queueWorkItem( new CompileItem( smManifest[i] ) );
+}
+
+GFXShaderCache::AsyncCompileRef GFXShaderCache::compileAsync( const ManifestEntry &entry )
+{
+   AssertFatal( canCompileAsync(), "GFXShaderCache::compileAsync - Async compiles are not available!" );
+
+   AsyncCompileRef async = new AsyncCompile;
+   ThreadPool::GLOBAL().queueWorkItem( new CompileItem( entry, async ) );
+   return async;
+}
+
+void GFXShaderCache::stopWarmUp()
+{
+   if ( smPendingWarmUps == 0 )
+      return;
+
+   smCancelWarmUp = 1;
+
+   // The items left in the queue return right away now, but
+   // we have to wait for those which are already compiling.
+   while ( smPendingWarmUps > 0 )
+   {
+      ThreadPool::processMainThreadWorkItems();
+      Platform::sleep( 1 );
+   }
+
+   smCancelWarmUp = 0;
+}
@@ -0,0 +1,207 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _GFXSHADERCACHE_H_
+#define _GFXSHADERCACHE_H_
+
+#ifndef _GFXSTRUCTS_H_
+#include "gfx/gfxStructs.h"
+#endif
+#ifndef _PATH_H_
+#include "core/util/path.h"
+#endif
+#ifndef _UTIL_DELEGATE_H_
+#include "core/util/delegate.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/util/tVector.h"
+#endif
+#ifndef _THREADSAFEREFCOUNT_H_
+#include "platform/threads/threadSafeRefCount.h"
+#endif
+
+class Stream;
+
+
+/// A persistent, content addressed cache of compiled shader programs.
+///
+/// Compiled programs are stored on disk under a key which is a hash of
+/// the shader source, the compile target, the macros and the device
+/// profile.  Every entry also records the files that were included
+/// during the compile along with a hash of their contents, so an entry
+/// is rejected when any of its includes change.  Entries are written to
+/// a temporary file and renamed into place, and the payload size and
+/// hash are checked on load, so a partially written file is never used.
+///
+/// The cache also keeps a manifest of the shaders that ShaderGen has
+/// created.  At startup the manifest is used to warm the cache on the
+/// thread pool, so that the shaders a level needs are usually already
+/// compiled by the time the level loads.
+///
+/// Single shaders can also be compiled on the thread pool with
+/// compileAsync(), which lets materials keep rendering while their
+/// shaders are compiled.
+///
+/// Loading and storing entries is thread safe.  The manifest must only
+/// be used from the main thread.
+///
+/// @see GFXShaderCache::setPrecompiler
+class GFXShaderCache
+{
+public:
+
+   /// A file which was included by a cached program.
+   struct Dependency
+   {
+      Torque::Path path;
+      U64 hash;
+   };
+
+   /// A shader permutation created by ShaderGen.
+   struct ManifestEntry
+   {
+      /// The ShaderGen cache key which is also the file name.
+      String key;
+
+      Torque::Path vertFile;
+      Torque::Path pixFile;
+      F32 pixVersion;
+      Vector<GFXShaderMacro> macros;
+
+      /// The hashes of the generated source files.
+      U64 vertHash;
+      U64 pixHash;
+   };
+
+   /// Compiles one stage of a shader into the cache.  This is called from
+   /// worker threads, so it must not touch the device.  The macros already
+   /// include the global shader macros.
+   typedef Delegate<bool( const Torque::Path &file, bool isVertex, F32 pixVersion, const Vector<GFXShaderMacro> &macros )> PrecompileDelegate;
+
+   /// Tracks a compile queued with compileAsync().
+   struct AsyncCompile : public ThreadSafeRefCount< AsyncCompile >
+   {
+      /// Set once both stages have been compiled or the
+      /// compile was dropped.
+      volatile U32 done;
+
+      AsyncCompile() : done( 0 ) {}
+
+      bool isDone() const { return done != 0; }
+   };
+
+   typedef ThreadSafeRef< AsyncCompile > AsyncCompileRef;
+
+   static void initConsole();
+
+   /// Returns true if the cache is enabled.
+   static bool isEnabled() { return smEnabled; }
+
+   /// Returns the directory the cache is stored in.
+   static Torque::Path getCachePath();
+
+   /// Returns the key for a program.
+   /// @param description  Everything besides the source which changes the
+   ///                     compiled output... the target, macros and flags.
+   static U64 computeKey( const String &description, const void *source, U32 sourceSize );
+
+   /// Returns a hash of the file contents or zero if it cannot be read.
+   static U64 hashFile( const Torque::Path &path );
+
+   /// Loads a compiled program from the cache.  Returns false if there is
+   /// no entry for the key or the entry is out of date.
+   static bool load( U64 key, Vector<U8> &outData );
+
+   /// Stores a compiled program in the cache.
+   static bool store( U64 key, const Vector<Dependency> &dependencies, const void *data, U32 size );
+
+   /// @name Manifest
+   /// @{
+
+   /// Returns the manifest entry for a ShaderGen key or NULL.
+   static const ManifestEntry* findInManifest( const String &key );
+
+   /// Adds or replaces a manifest entry and appends it to the file.
+   static void addToManifest( const ManifestEntry &entry );
+
+   /// Reads the manifest from the cache directory.
+   static void loadManifest();
+
+   /// Drops the in memory manifest.
+   static void clearManifest();
+
+   /// @}
+
+   /// @name Warm Up
+   /// @{
+
+   /// Sets the device specific compiler used to warm up the cache.
+   static void setPrecompiler( const PrecompileDelegate &precompiler ) { smPrecompiler = precompiler; }
+
+   /// Queues every shader in the manifest to be compiled into the cache
+   /// on the thread pool.
+   static void startWarmUp();
+
+   /// Cancels the warm up which hasn't started yet and waits for the
+   /// rest of it to finish.  This must be called before the device
+   /// that registered the precompiler is destroyed.
+   static void stopWarmUp();
+
+   /// Returns the number of warm up and async compile 
+   /// items which have not finished.
+   static U32 getPendingWarmUps() { return smPendingWarmUps; }
+
+   /// @}
+
+   /// @name Async Compiles
+   /// @{
+
+   /// Returns true if compileAsync() can be used with the current device.
+   static bool canCompileAsync() { return smEnabled && !smPrecompiler.empty(); }
+
+   /// Queues both stages of a shader to be compiled into the cache on
+   /// the thread pool ahead of any warm up.  Once it is done creating 
+   /// the shader will find the compiled programs in the cache.
+   /// @see canCompileAsync
+   static AsyncCompileRef compileAsync( const ManifestEntry &entry );
+
+   /// Returns the number of async compiles which have finished.
+   static U32 getAsyncCompileCount() { return smAsyncCompiles; }
+
+   /// @}
+
+   /// @name Statistics
+   /// @{
+
+   static U32 getHitCount() { return smHits; }
+   static U32 getMissCount() { return smMisses; }
+
+   /// @}
+
+protected:
+
+   struct CompileItem;
+
+   static void _writeManifestEntry( Stream &stream, const ManifestEntry &entry );
+   static bool _readManifestEntry( const String &line, ManifestEntry *outEntry );
+
+   /// Set from $pref::video::shaderCache.
+   static bool smEnabled;
+
+   /// Set from $pref::video::shaderCachePath.
+   static String smCachePath;
+
+   static Vector<ManifestEntry> smManifest;
+
+   static PrecompileDelegate smPrecompiler;
+
+   static volatile U32 smPendingWarmUps;
+   static volatile U32 smCancelWarmUp;
+   static volatile U32 smHits;
+   static volatile U32 smMisses;
+   static volatile U32 smAsyncCompiles;
+};
+
+#endif // _GFXSHADERCACHE_H_
@@ -4,6 +4,7 @@
 //-----------------------------------------------------------------------------
 #include "gfx/gfxStateBlock.h"
 #include "core/crc.h"
+#include "core/util/hashFunction.h"
 #include "gfx/gfxDevice.h"
 #include "core/strings/stringFunctions.h"
 #include "gfx/gfxStringEnumTranslate.h"
@@ -256,6 +257,86 @@ void GFXStateBlockDesc::setColorWrites( bool red, bool green, bool blue, bool al
    colorWriteAlpha = alpha;
 }
 
+///
+/// GFXStateBlockDescriptor
+///
+GFXStateBlockDescriptor::GFXStateBlockDescriptor()
+{
+   blend = 0;
+   depthStencil = 0;
+   fixedFunction = 0;
+   dMemset( samplers, 0, sizeof( samplers ) );
+   all = 0;
+}
+
+static inline U32 _floatBits( F32 f )
+{
+   return *((U32*)&f);
+}
+
+static inline U64 _hashValues( const U32 *values, U32 count )
+{
+   return Torque::hash64( (const U8*)values, count * sizeof( U32 ), 0 );
+}
+
+void GFXStateBlockDescriptor::set( const GFXStateBlockDesc &desc )
+{
+   // The values are copied into arrays first so that padding
+   // between the desc members never ends up in the hash.
+   const U32 blendValues[] = 
+   {
+      desc.blendEnable, desc.blendSrc, desc.blendDest, desc.blendOp,
+      desc.separateAlphaBlendEnable, desc.separateAlphaBlendSrc, 
+      desc.separateAlphaBlendDest, desc.separateAlphaBlendOp,
+      desc.alphaTestEnable, (U32)desc.alphaTestRef, desc.alphaTestFunc,
+      desc.colorWriteRed, desc.colorWriteGreen, desc.colorWriteBlue, desc.colorWriteAlpha,
+      desc.cullMode, desc.fillMode
+   };
+   blend = _hashValues( blendValues, sizeof( blendValues ) / sizeof( U32 ) );
+
+   const U32 depthValues[] = 
+   {
+      desc.zEnable, desc.zWriteEnable, desc.zFunc, 
+      _floatBits( desc.zBias ), _floatBits( desc.zSlopeBias ),
+      desc.stencilEnable, desc.stencilFailOp, desc.stencilZFailOp, desc.stencilPassOp, 
+      desc.stencilFunc, desc.stencilRef, desc.stencilMask, desc.stencilWriteMask
+   };
+   depthStencil = _hashValues( depthValues, sizeof( depthValues ) / sizeof( U32 ) );
+
+   const U32 ffValues[] = 
+   {
+      desc.ffLighting, desc.vertexColorEnable, 
+      (U32)desc.textureFactor.red, (U32)desc.textureFactor.green, 
+      (U32)desc.textureFactor.blue, (U32)desc.textureFactor.alpha
+   };
+   fixedFunction = _hashValues( ffValues, sizeof( ffValues ) / sizeof( U32 ) );
+
+   U64 combined[TEXTURE_STAGE_COUNT + 3];
+   for ( U32 i=0; i < TEXTURE_STAGE_COUNT; i++ )
+   {
+      const GFXSamplerStateDesc &s = desc.samplers[i];
+      const U32 samplerValues[] = 
+      {
+         s.addressModeU, s.addressModeV, s.addressModeW,
+         s.magFilter, s.minFilter, s.mipFilter,
+         s.maxAnisotropy, _floatBits( s.mipLODBias ),
+         s.textureColorOp, s.colorArg1, s.colorArg2, s.colorArg3,
+         s.alphaOp, s.alphaArg1, s.alphaArg2, s.alphaArg3,
+         s.resultArg, s.textureTransform
+      };
+      samplers[i] = _hashValues( samplerValues, sizeof( samplerValues ) / sizeof( U32 ) );
+      combined[i] = samplers[i];
+   }
+
+   combined[TEXTURE_STAGE_COUNT] = blend;
+   combined[TEXTURE_STAGE_COUNT + 1] = depthStencil;
+   combined[TEXTURE_STAGE_COUNT + 2] = fixedFunction;
+   all = Torque::hash64( (const U8*)combined, sizeof( combined ), 0 );
+}
+
+///
+/// GFXSamplerStateDesc
+///
 GFXSamplerStateDesc::GFXSamplerStateDesc()
 {
    textureColorOp = GFXTOPDisable;
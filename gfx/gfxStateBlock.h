@@ -183,6 +183,39 @@ struct GFXStateBlockDesc
    void setColorWrites( bool red, bool green, bool blue, bool alpha );
 };
 
+/// Precomputed 64-bit descriptors for the state groups of a GFXStateBlockDesc.
+///
+/// The descriptors are built from the field values, not the raw memory of the
+/// description, so two descriptions which set the same device state always
+/// produce the same descriptors.  Devices compare these when switching blocks
+/// to skip whole groups of states that did not change.
+struct GFXStateBlockDescriptor
+{
+   /// Blending, separate alpha blending, alpha test, color writes,
+   /// culling and fill mode.
+   U64 blend;
+
+   /// Depth and stencil states.
+   U64 depthStencil;
+
+   /// Fixed function lighting, vertex colors and the texture factor.
+   U64 fixedFunction;
+
+   /// One descriptor per sampler, covering the sampler and stage states.
+   U64 samplers[TEXTURE_STAGE_COUNT];
+
+   /// Combination of all the group descriptors.
+   U64 all;
+
+   GFXStateBlockDescriptor();
+
+   /// Builds the descriptors from the description.
+   void set( const GFXStateBlockDesc &desc );
+
+   bool operator ==( const GFXStateBlockDescriptor &d ) const { return all == d.all; }
+   bool operator !=( const GFXStateBlockDescriptor &d ) const { return all != d.all; }
+};
+
 class GFXStateBlock : public StrongRefBase, public GFXResource
 {
 public:
@@ -194,8 +227,16 @@ public:
    /// Returns a GFXStateBlockDesc that this block represents
    virtual const GFXStateBlockDesc& getDesc() const = 0;
 
+   /// Returns the precomputed descriptors of this block's desc.
+   const GFXStateBlockDescriptor& getDescriptor() const { return mDescriptor; }
+
    /// Default implementation for GFXResource::describeSelf   
    virtual const String describeSelf() const;
+
+protected:
+
+   /// Derived classes must fill this in from the desc they were created with.
+   GFXStateBlockDescriptor mDescriptor;
 };
 
 typedef StrongRefPtr<GFXStateBlock> GFXStateBlockRef;
@@ -13,7 +13,11 @@
 #include "core/resourceManager.h"
 #include "core/volume.h"
 #include "core/util/dxt5nmSwizzle.h"
+#include "core/stream/fileStream.h"
 #include "console/consoleTypes.h"
+#include "gfx/gfxFormatUtils.h"
+#include "platform/threads/threadPool.h"
+#include "platform/platformIntrinsics.h"
 
 /// Threshold of total VRAM under which we start scaling textures down...
 ///
@@ -34,6 +38,14 @@ static S32 gTextureReductionLevel = 1;
 
 GFXTextureManager::EventSignal GFXTextureManager::smEventSignal;
 
+bool GFXTextureManager::smStreamingEnabled = true;
+S32 GFXTextureManager::smStreamingBudget = 256;
+S32 GFXTextureManager::smStreamingMinSize = 64;
+S32 GFXTextureManager::smStreamingUploadsPerFrame = 4;
+S32 GFXTextureManager::smStreamingMaxLoads = 8;
+F32 GFXTextureManager::smStreamingTexelScale = 1.0f;
+U32 GFXTextureManager::smStreamingFrame = 0;
+
 //-----------------------------------------------------------------------------
 
 void GFXTextureManager::init()
@@ -41,6 +53,13 @@ void GFXTextureManager::init()
    Con::addVariable("pref::TextureManager::scaleThreshold",    TypeS32, &gTextureScaleThreshold);
    Con::addVariable("pref::TextureManager::qualityMode",       TypeS32, &gTextureQualityMode);
    Con::addVariable("pref::TextureManager::reductionLevel",    TypeS32, &gTextureReductionLevel);
+
+   Con::addVariable("pref::TextureManager::streaming",         TypeBool, &smStreamingEnabled);
+   Con::addVariable("pref::TextureManager::streamingBudget",   TypeS32, &smStreamingBudget);
+   Con::addVariable("pref::TextureManager::streamingMinSize",  TypeS32, &smStreamingMinSize);
+   Con::addVariable("pref::TextureManager::streamingUploadsPerFrame", TypeS32, &smStreamingUploadsPerFrame);
+   Con::addVariable("pref::TextureManager::streamingMaxLoads", TypeS32, &smStreamingMaxLoads);
+   Con::addVariable("pref::TextureManager::streamingTexelScale", TypeF32, &smStreamingTexelScale);
 }
 
 GFXTextureManager::GFXTextureManager()
@@ -55,6 +74,9 @@ GFXTextureManager::GFXTextureManager()
       mHashTable[i] = NULL;
 
    mValidTextureQualityInfo = false;
+
+   mStreamUpgrades = 0;
+   mStreamEvictions = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -676,11 +698,17 @@ GFXTextureObject *GFXTextureManager::createTexture( const Torque::Path &path, GF
       // Check for DDS
       if( correctPath.getExtension() == sDDSExt )
       {
-         Resource<DDSFile> dds = DDSFile::load( correctPath );
-         if( dds != NULL )
+         retTexObj = _createStreamedTexture( correctPath, profile );
+         if ( retTexObj )
+            realPath = correctPath;
+         else
          {
-            realPath = dds.getPath();
-            retTexObj = createTexture( dds, profile, false );
+            Resource<DDSFile> dds = DDSFile::load( correctPath );
+            if( dds != NULL )
+            {
+               realPath = dds.getPath();
+               retTexObj = createTexture( dds, profile, false );
+            }
          }
       }
       else // Let GBitmap take care of it
@@ -708,11 +736,17 @@ GFXTextureObject *GFXTextureManager::createTexture( const Torque::Path &path, GF
 
       if( Torque::FS::IsFile( tryDDSPath ) )
       {
-         Resource<DDSFile> dds = DDSFile::load( tryDDSPath );
-         if( dds != NULL )
+         retTexObj = _createStreamedTexture( tryDDSPath, profile );
+         if ( retTexObj )
+            realPath = tryDDSPath;
+         else
          {
-            realPath = dds.getPath();
-            retTexObj = createTexture( dds, profile, false );
+            Resource<DDSFile> dds = DDSFile::load( tryDDSPath );
+            if( dds != NULL )
+            {
+               realPath = dds.getPath();
+               retTexObj = createTexture( dds, profile, false );
+            }
          }
       }
       
@@ -998,6 +1032,9 @@ void GFXTextureManager::deleteTexture( GFXTextureObject *texture )
    if ( !texPath.isEmpty() )
       FS::RemoveChangeNotification( texPath, this, &GFXTextureManager::_onFileChanged );
 
+   if ( texture->isStreamed() )
+      _removeStreamedTexture( texture );
+
    GFXTextureProfile::updateStatsForDeletion(texture);
 
    freeTexture( texture );
@@ -1135,6 +1172,14 @@ void GFXTextureManager::_onFileChanged( const Torque::Path &path )
 
    Con::errorf( "[GFXTextureManager::_onFileChanged] : File changed [%s]", path.getFullPath().c_str() );
 
+   // Streamed textures reload the mips they have.
+   if ( obj->isStreamed() )
+   {
+      if ( !obj->mStream->pending )
+         _queueStreamLoad( obj, obj->mStream->skipMips );
+      return;
+   }
+
    static const String sDDSExt( "dds" );
    if ( path.getExtension() == sDDSExt )
    {
@@ -1150,6 +1195,466 @@ void GFXTextureManager::_onFileChanged( const Torque::Path &path )
    }
 }
 
+//-----------------------------------------------------------------------------
+// Mip streaming
+//-----------------------------------------------------------------------------
+
+/// A load of the mips of a streamed texture.  Only the main thread
+/// touches the texture, the worker just reads the file.
+struct GFXTextureManager::StreamLoad : public ThreadSafeRefCount< StreamLoad >
+{
+   /// The texture or NULL if it was deleted while loading.
+   GFXTextureObject *mTexture;
+
+   Torque::Path mPath;
+   U32 mSkipMips;
+
+   /// The size of the top mip of the load, so that a file
+   /// which changed since the texture was created is ignored.
+   U32 mWidth;
+   U32 mHeight;
+
+   /// The mips read by the worker or NULL if the read failed.
+   DDSFile *mDDS;
+
+   /// Set once the worker is done with the load.
+   volatile U32 mDone;
+
+   StreamLoad( GFXTextureObject *texture, U32 skipMips )
+      :  mTexture( texture ),
+         mPath( texture->getPath() ),
+         mSkipMips( skipMips ),
+         mWidth( getMax( texture->mStream->width >> skipMips, (U32)1 ) ),
+         mHeight( getMax( texture->mStream->height >> skipMips, (U32)1 ) ),
+         mDDS( NULL ),
+         mDone( 0 )
+   {
+   }
+
+   ~StreamLoad()
+   {
+      delete mDDS;
+   }
+
+   bool isDone() const { return mDone != 0; }
+
+   void read()
+   {
+      FileStream stream;
+      if ( !stream.open( mPath, Torque::FS::File::Read ) )
+         return;
+
+      DDSFile *dds = new DDSFile;
+      if ( dds->read( stream, mSkipMips ) && dds->getWidth() == mWidth && dds->getHeight() == mHeight )
+         mDDS = dds;
+      else
+         delete dds;
+   }
+};
+
+struct GFXTextureManager::StreamLoadItem : public ThreadPool::WorkItem
+{
+   StreamLoadRef mLoad;
+
+   StreamLoadItem( StreamLoad *load )
+      : mLoad( load )
+   {
+   }
+
+   virtual ~StreamLoadItem()
+   {
+      // Done here so that items dropped by the pool finish too.
+      dCompareAndSwap( mLoad->mDone, 0, 1 );
+   }
+
+   virtual void execute()
+   {
+      if ( !cancellationPoint() )
+         mLoad->read();
+   }
+};
+
+/// A texture to queue a streamed mip load for.
+struct GFXStreamCandidate
+{
+   GFXTextureObject *texture;
+   U32 skipMips;
+
+   /// The candidates are sorted by this, largest first.
+   U32 key;
+};
+
+static S32 QSORT_CALLBACK _compareStreamCandidates( const GFXStreamCandidate *a, const GFXStreamCandidate *b )
+{
+   if ( a->key == b->key )
+      return 0;
+
+   return a->key > b->key ? -1 : 1;
+}
+
+GFXTextureObject* GFXTextureManager::_createStreamedTexture( const Torque::Path &path, GFXTextureProfile *profile )
+{
+   if (  !smStreamingEnabled || 
+         !profile->canDownscale() || 
+         profile->noMip() ||
+         profile->doStoreBitmap() ||
+         profile->isDynamic() ||
+         profile->isRenderTarget() ||
+         profile->isSystemMemory() )
+      return NULL;
+
+   FileStream stream;
+   if ( !stream.open( path, Torque::FS::File::Read ) )
+      return NULL;
+
+   // Look at the header to see how much we can skip.
+   DDSFile header;
+   if (  !header.readHeader( stream ) ||
+         header.mFlags.test( DDSFile::CubeMapFlag | DDSFile::VolumeFlag ) ||
+         header.mMipMapCount < 2 ||
+         !isPow2( header.mWidth ) ||
+         !isPow2( header.mHeight ) )
+      return NULL;
+
+   U32 maxSkipMips = 0;
+   while (  maxSkipMips + 1 < header.mMipMapCount &&
+            getMax( header.getWidth( maxSkipMips ), header.getHeight( maxSkipMips ) ) > (U32)getMax( smStreamingMinSize, 1 ) )
+      maxSkipMips++;
+
+   // Small textures are loaded whole.
+   if ( maxSkipMips == 0 )
+      return NULL;
+
+   stream.setPosition( 0 );
+
+   DDSFile *dds = new DDSFile;
+   if ( !dds->read( stream, maxSkipMips ) )
+   {
+      delete dds;
+      return NULL;
+   }
+
+   dds->mSourcePath = path;
+   dds->mCacheString = Torque::Path::Join( path.getRoot(), ':', path.getPath() );
+   dds->mCacheString = Torque::Path::Join( dds->mCacheString, '/', path.getFileName() );
+
+   GFXTextureObject *texture = createTexture( dds, profile, true );
+   if ( !texture )
+      return NULL;
+
+   GFXTextureStreamState *state = new GFXTextureStreamState;
+   state->width = header.mWidth;
+   state->height = header.mHeight;
+   state->mipLevels = header.mMipMapCount;
+   state->skipMips = maxSkipMips;
+   state->minSkipMips = getMin( getBitmapScalePower( profile ), maxSkipMips );
+   state->maxSkipMips = maxSkipMips;
+   state->wantSkipMips = maxSkipMips;
+   state->lastRequest = smStreamingFrame - 1;
+   state->lastBound = smStreamingFrame - 1;
+   state->numRequests = 0;
+   state->numBinds = 0;
+   state->pendingSkipMips = maxSkipMips;
+   state->pending = false;
+
+   texture->mStream = state;
+   mStreamedTextures.push_back( texture );
+
+   return texture;
+}
+
+void GFXTextureManager::_removeStreamedTexture( GFXTextureObject *texture )
+{
+   mStreamedTextures.remove( texture );
+
+   for ( U32 i=0; i < mStreamLoads.size(); i++ )
+   {
+      if ( mStreamLoads[i]->mTexture == texture )
+         mStreamLoads[i]->mTexture = NULL;
+   }
+}
+
+void GFXTextureManager::requestTextureDetail( GFXTextureObject *texture, F32 pixelSize )
+{
+   GFXTextureStreamState *stream = texture ? texture->mStream : NULL;
+   if ( !stream )
+      return;
+
+   // Skip the mips which are larger than the footprint.
+   const F32 texels = getMax( pixelSize * smStreamingTexelScale, 1.0f );
+   const U32 size = getMax( stream->width, stream->height );
+
+   U32 skipMips = 0;
+   while ( skipMips < stream->maxSkipMips && F32( size >> ( skipMips + 1 ) ) >= texels )
+      skipMips++;
+
+   if ( stream->lastRequest != smStreamingFrame )
+   {
+      stream->lastRequest = smStreamingFrame;
+      stream->wantSkipMips = skipMips;
+      stream->numRequests = 1;
+   }
+   else
+   {
+      stream->wantSkipMips = getMin( stream->wantSkipMips, skipMips );
+      stream->numRequests++;
+   }
+}
+
+U32 GFXTextureManager::_getStreamedSize( const GFXTextureObject *texture, U32 skipMips )
+{
+   const GFXTextureStreamState *stream = texture->mStream;
+   const bool compressed = GFXFormatInfo( texture->mFormat ).isCompressed();
+   const U32 blockSize = texture->mFormat == GFXFormatDXT1 ? 8 : 16;
+   const F32 bytesPerPixel = GFXDevice::formatByteSize( texture->mFormat );
+
+   U32 bytes = 0;
+   for ( U32 i=skipMips; i < stream->mipLevels; i++ )
+   {
+      const U32 width = getMax( stream->width >> i, (U32)1 );
+      const U32 height = getMax( stream->height >> i, (U32)1 );
+
+      if ( compressed )
+         bytes += getMax( width / 4, (U32)1 ) * getMax( height / 4, (U32)1 ) * blockSize;
+      else
+         bytes += (U32)( width * height * bytesPerPixel );
+   }
+
+   return bytes;
+}
+
+void GFXTextureManager::_queueStreamLoad( GFXTextureObject *texture, U32 skipMips )
+{
+   GFXTextureStreamState *stream = texture->mStream;
+   stream->pending = true;
+   stream->pendingSkipMips = skipMips;
+
+   StreamLoad *load = new StreamLoad( texture, skipMips );
+   mStreamLoads.push_back( load );
+   ThreadPool::GLOBAL().queueWorkItem( new StreamLoadItem( load ) );
+}
+
+U32 GFXTextureManager::_finishStreamLoads()
+{
+   const U32 maxUploads = getMax( smStreamingUploadsPerFrame, 1 );
+   U32 uploads = 0;
+
+   for ( U32 i=0; i < mStreamLoads.size(); )
+   {
+      StreamLoad *load = mStreamLoads[i].ptr();
+      if ( !load->isDone() || uploads >= maxUploads )
+      {
+         i++;
+         continue;
+      }
+
+      GFXTextureObject *texture = load->mTexture;
+      if ( texture )
+      {
+         GFXTextureStreamState *stream = texture->mStream;
+         stream->pending = false;
+
+         if ( load->mDDS )
+         {
+            PROFILE_SCOPE( GFXTextureManager_UploadStreamedMips );
+
+            load->mDDS->mSourcePath = load->mPath;
+            load->mDDS->mCacheString = texture->mTextureLookupName;
+
+            // The texture is recreated in place, so the
+            // handles to it see the new mips.
+            GFXTextureProfile::updateStatsForDeletion( texture );
+            if ( _createTexture( load->mDDS, texture->mProfile, false, texture ) )
+               stream->skipMips = load->mSkipMips;
+            GFXTextureProfile::updateStatsForCreation( texture );
+
+            uploads++;
+         }
+         else
+            Con::warnf( "GFXTextureManager::updateStreaming - Failed to load the mips of '%s'.", load->mPath.getFullPath().c_str() );
+      }
+
+      mStreamLoads.erase_fast( i );
+   }
+
+   return uploads;
+}
+
+U32 GFXTextureManager::_evictStreamMips( U32 bytes )
+{
+   PROFILE_SCOPE( GFXTextureManager_EvictStreamMips );
+
+   const U32 frame = smStreamingFrame;
+
+   // Find the textures which weren't used this frame
+   // and still have mips to drop.
+   Vector<GFXStreamCandidate> candidates;
+   for ( U32 i=0; i < mStreamedTextures.size(); i++ )
+   {
+      GFXTextureObject *texture = mStreamedTextures[i];
+      const GFXTextureStreamState *stream = texture->mStream;
+      if ( stream->pending || stream->skipMips >= stream->maxSkipMips )
+         continue;
+
+      // The frames since it was last used.
+      const U32 age = getMin( frame - stream->lastRequest, frame - stream->lastBound );
+      if ( age == 0 )
+         continue;
+
+      candidates.increment();
+      candidates.last().texture = texture;
+      candidates.last().skipMips = stream->skipMips + 1;
+      candidates.last().key = age;
+   }
+
+   // The least recently used go first.  The evictions aren't held
+   // back by the load limit, otherwise we could stay over budget.
+   candidates.sort( _compareStreamCandidates );
+
+   U32 freed = 0;
+   for ( U32 i=0; i < candidates.size() && freed < bytes; i++ )
+   {
+      GFXTextureObject *texture = candidates[i].texture;
+      freed += _getStreamedSize( texture, texture->mStream->skipMips ) - _getStreamedSize( texture, candidates[i].skipMips );
+
+      _queueStreamLoad( texture, candidates[i].skipMips );
+      mStreamEvictions++;
+   }
+
+   return freed;
+}
+
+void GFXTextureManager::updateStreaming()
+{
+   PROFILE_SCOPE( GFXTextureManager_UpdateStreaming );
+
+   _finishStreamLoads();
+
+   if ( smStreamingEnabled && !mStreamedTextures.empty() )
+   {
+      const U32 frame = smStreamingFrame;
+      const U32 budget = getMin( getMax( smStreamingBudget, 0 ), 4095 ) * 1024 * 1024;
+      const U32 maxLoads = getMax( smStreamingMaxLoads, 1 );
+
+      // Total up the resident mips, with the pending loads at the
+      // size they will have, and find the textures which want
+      // more mips than they have.
+      U32 resident = 0;
+      Vector<GFXStreamCandidate> upgrades;
+
+      for ( U32 i=0; i < mStreamedTextures.size(); i++ )
+      {
+         GFXTextureObject *texture = mStreamedTextures[i];
+         const GFXTextureStreamState *stream = texture->mStream;
+
+         resident += _getStreamedSize( texture, stream->pending ? stream->pendingSkipMips : stream->skipMips );
+
+         if ( stream->pending )
+            continue;
+
+         // A use without a footprint request, like a GUI bitmap
+         // or a material which doesn't request, wants the full
+         // detail whatever the requests this frame asked for.
+         U32 wantSkipMips;
+         if (  stream->lastBound == frame &&
+               ( stream->lastRequest != frame || stream->numBinds > stream->numRequests ) )
+            wantSkipMips = 0;
+         else if ( stream->lastRequest == frame )
+            wantSkipMips = stream->wantSkipMips;
+         else
+            continue;
+
+         wantSkipMips = getMax( wantSkipMips, stream->minSkipMips );
+         if ( wantSkipMips >= stream->skipMips )
+            continue;
+
+         upgrades.increment();
+         upgrades.last().texture = texture;
+         upgrades.last().skipMips = wantSkipMips;
+         upgrades.last().key = stream->skipMips - wantSkipMips;
+      }
+
+      // Load the largest jumps in detail first.
+      upgrades.sort( _compareStreamCandidates );
+
+      for ( U32 i=0; i < upgrades.size() && mStreamLoads.size() < maxLoads; i++ )
+      {
+         GFXTextureObject *texture = upgrades[i].texture;
+         const U32 extra = _getStreamedSize( texture, upgrades[i].skipMips ) - _getStreamedSize( texture, texture->mStream->skipMips );
+
+         if ( budget && resident + extra > budget )
+         {
+            resident -= _evictStreamMips( resident + extra - budget );
+
+            // The rest wait until there is room.
+            if ( resident + extra > budget || mStreamLoads.size() >= maxLoads )
+               break;
+         }
+
+         _queueStreamLoad( texture, upgrades[i].skipMips );
+         resident += extra;
+         mStreamUpgrades++;
+      }
+
+      // Get back under a lowered budget.
+      if ( budget && resident > budget )
+         _evictStreamMips( resident - budget );
+   }
+
+   // The requests from now on are for the next frame.
+   smStreamingFrame++;
+}
+
+void GFXTextureManager::getStreamingStats( StreamingStats *outStats ) const
+{
+   outStats->numTextures = mStreamedTextures.size();
+   outStats->residentBytes = 0;
+   outStats->budgetBytes = getMin( getMax( smStreamingBudget, 0 ), 4095 ) * 1024 * 1024;
+   outStats->numPendingLoads = mStreamLoads.size();
+   outStats->pendingBytes = 0;
+   outStats->numUpgrades = mStreamUpgrades;
+   outStats->numEvictions = mStreamEvictions;
+
+   for ( U32 i=0; i < mStreamedTextures.size(); i++ )
+      outStats->residentBytes += _getStreamedSize( mStreamedTextures[i], mStreamedTextures[i]->mStream->skipMips );
+
+   for ( U32 i=0; i < mStreamLoads.size(); i++ )
+   {
+      const StreamLoad *load = mStreamLoads[i].ptr();
+      if ( load->mTexture )
+         outStats->pendingBytes += _getStreamedSize( load->mTexture, load->mSkipMips );
+   }
+}
+
+void GFXTextureManager::dumpStreaming() const
+{
+   for ( U32 i=0; i < mStreamedTextures.size(); i++ )
+   {
+      const GFXTextureObject *texture = mStreamedTextures[i];
+      const GFXTextureStreamState *stream = texture->mStream;
+
+      Con::printf( "   %s: %dx%d of %dx%d, %d of %d mips%s", 
+         texture->getPath().c_str(),
+         getMax( stream->width >> stream->skipMips, (U32)1 ),
+         getMax( stream->height >> stream->skipMips, (U32)1 ),
+         stream->width, stream->height,
+         stream->mipLevels - stream->skipMips, stream->mipLevels,
+         stream->pending ? " (loading)" : "" );
+   }
+
+   StreamingStats stats;
+   getStreamingStats( &stats );
+
+   Con::printf( "Streamed textures: %d, resident %.2f MB, budget %.2f MB, %d loads pending %.2f MB, %d upgrades, %d evictions",
+      stats.numTextures,
+      stats.residentBytes / ( 1024.0f * 1024.0f ),
+      stats.budgetBytes / ( 1024.0f * 1024.0f ),
+      stats.numPendingLoads,
+      stats.pendingBytes / ( 1024.0f * 1024.0f ),
+      stats.numUpgrades,
+      stats.numEvictions );
+}
+
 ConsoleFunctionGroupBegin( TextureManagment , "Texture mananagement functions.");
 
 ConsoleFunction( flushTextureCache, void, 1, 1, 
@@ -1171,4 +1676,35 @@ ConsoleFunction( cleanupTexturePool, void, 1, 1,
    TEXMGR->cleanupPool();
 }
 
+ConsoleFunction( getTextureStreamingStats, const char*, 1, 1, 
+   "Returns the texture mip streaming statistics as \"textures residentMB budgetMB pendingLoads pendingMB upgrades evictions\".")
+{
+   if ( !GFX || !TEXMGR )
+      return "";
+
+   GFXTextureManager::StreamingStats stats;
+   TEXMGR->getStreamingStats( &stats );
+
+   char *ret = Con::getReturnBuffer( 128 );
+   dSprintf( ret, 128, "%d %.2f %.2f %d %.2f %d %d",
+      stats.numTextures,
+      stats.residentBytes / ( 1024.0f * 1024.0f ),
+      stats.budgetBytes / ( 1024.0f * 1024.0f ),
+      stats.numPendingLoads,
+      stats.pendingBytes / ( 1024.0f * 1024.0f ),
+      stats.numUpgrades,
+      stats.numEvictions );
+
+   return ret;
+}
+
+ConsoleFunction( dumpTextureStreaming, void, 1, 1, 
+   "Prints the resident mips of the streamed textures.")
+{
+   if ( !GFX || !TEXMGR )
+      return;
+
+   TEXMGR->dumpStreaming();
+}
+
 ConsoleFunctionGroupEnd( TextureManagment );
@@ -24,6 +24,9 @@
 #ifndef _TSIGNAL_H_
 #include "core/util/tSignal.h"
 #endif
+#ifndef _THREADSAFEREFCOUNT_H_
+#include "platform/threads/threadSafeRefCount.h"
+#endif
 
 
 namespace Torque
@@ -130,6 +133,81 @@ public:
 
    /// @}
 
+   /// @name Mip Streaming
+   ///
+   /// DDS textures loaded from a file only load their smallest mips at
+   /// first.  While rendering the materials report how large on screen
+   /// their textures are, and once per frame updateStreaming() loads the
+   /// mips that footprint needs on a worker thread and uploads them.
+   /// A texture which is set on the device without a footprint report
+   /// is streamed up to its full size.
+   ///
+   /// When the streamed textures go over the budget the top mip of the
+   /// least recently used ones is dropped to make room.
+   /// @{
+
+   /// Set if DDS textures stream their mips.
+   static bool smStreamingEnabled;
+
+   /// The video memory in megabytes the streamed textures may use or
+   /// zero for no limit.
+   static S32 smStreamingBudget;
+
+   /// The largest top mip a streamed texture is first loaded with.
+   static S32 smStreamingMinSize;
+
+   /// The number of streamed mip loads uploaded per frame.
+   static S32 smStreamingUploadsPerFrame;
+
+   /// The number of streamed mip loads in flight.
+   static S32 smStreamingMaxLoads;
+
+   /// The texels wanted per pixel of screen footprint.
+   static F32 smStreamingTexelScale;
+
+   /// The streaming statistics.
+   struct StreamingStats
+   {
+      /// The number of textures which stream their mips.
+      U32 numTextures;
+
+      /// The estimated video memory of the resident mips.
+      U32 residentBytes;
+
+      /// The budget in bytes or zero without a budget.
+      U32 budgetBytes;
+
+      /// The number of mip loads in flight or waiting to upload.
+      U32 numPendingLoads;
+
+      /// The bytes the pending loads read.
+      U32 pendingBytes;
+
+      /// The number of loads queued to raise or drop the resident
+      /// mips since the texture manager was created.
+      U32 numUpgrades;
+      U32 numEvictions;
+   };
+
+   /// Records that the texture covers pixelSize pixels on screen
+   /// this frame, which sets the mips it will stream in.
+   static void requestTextureDetail( GFXTextureObject *texture, F32 pixelSize );
+
+   /// Returns the frame number footprint requests are made for.
+   static U32 getStreamingFrame() { return smStreamingFrame; }
+
+   /// Uploads the mips loaded since the last call and queues the loads
+   /// for the footprints requested this frame.  Called once per frame.
+   void updateStreaming();
+
+   /// Fills in the current streaming statistics.
+   void getStreamingStats( StreamingStats *outStats ) const;
+
+   /// Prints the residency of every streamed texture to the console.
+   void dumpStreaming() const;
+
+   /// @}
+
 protected:
 
    //-----------------------------------------------------------------------
@@ -162,6 +240,48 @@ protected:
    /// All the allocated texture pool textures.
    TexturePoolMap mTexturePool;
 
+   /// @name Mip Streaming
+   /// @{
+
+   struct StreamLoad;
+   struct StreamLoadItem;
+   typedef ThreadSafeRef<StreamLoad> StreamLoadRef;
+
+   /// The counter requests are made for.
+   static U32 smStreamingFrame;
+
+   /// The textures which stream their mips.
+   Vector<GFXTextureObject*> mStreamedTextures;
+
+   /// The mip loads in flight or waiting to upload.
+   Vector<StreamLoadRef> mStreamLoads;
+
+   U32 mStreamUpgrades;
+   U32 mStreamEvictions;
+
+   /// Creates a texture which streams its mips or returns NULL
+   /// if the file or profile isn't suited for streaming.
+   GFXTextureObject* _createStreamedTexture( const Torque::Path &path, GFXTextureProfile *profile );
+
+   /// Removes a texture which is being deleted from the streaming.
+   void _removeStreamedTexture( GFXTextureObject *texture );
+
+   /// Queues a load of the texture skipping the top skipMips mips.
+   void _queueStreamLoad( GFXTextureObject *texture, U32 skipMips );
+
+   /// Uploads the finished loads and returns the number uploaded.
+   U32 _finishStreamLoads();
+
+   /// Drops the top mip of the least recently used textures until
+   /// the bytes are freed and returns the bytes freed.
+   U32 _evictStreamMips( U32 bytes );
+
+   /// Returns the estimated video memory of the streamed
+   /// texture when skipping the top skipMips mips.
+   static U32 _getStreamedSize( const GFXTextureObject *texture, U32 skipMips );
+
+   /// @}
+
    //-----------------------------------------------------------------------
    // Protected methods
    //-----------------------------------------------------------------------
@@ -69,6 +69,7 @@ GFXTextureObject::GFXTextureObject(GFXDevice *aDevice, GFXTextureProfile *aProfi
 
    mBitmap = NULL;
    mDDS    = NULL;
+   mStream = NULL;
    
    mFormat = GFXFormatR8G8B8;
 
@@ -149,6 +150,7 @@ void GFXTextureObject::kill()
    // Delete the stored bitmap.
    SAFE_DELETE(mBitmap)
    SAFE_DELETE(mDDS);
+   SAFE_DELETE(mStream);
 
    // Clean up linked list
    if(mNext)
@@ -53,6 +53,49 @@ struct GFXLockedRect
 };
 
 
+/// The mip streaming state of a texture loaded from a DDS file.
+///
+/// Mips are counted from the top of the file, so skipping two mips of
+/// a 1024x1024 file leaves a 256x256 texture resident.
+///
+/// @see GFXTextureManager::updateStreaming
+struct GFXTextureStreamState
+{
+   /// The size and mip count of the file.
+   U32 width;
+   U32 height;
+   U32 mipLevels;
+
+   /// The number of top mips which are not resident.
+   U32 skipMips;
+
+   /// The fewest mips we skip, set by the texture reduction level.
+   U32 minSkipMips;
+
+   /// The skip of the initial load, evictions never go past it.
+   U32 maxSkipMips;
+
+   /// The fewest skipped mips requested during the last request frame.
+   U32 wantSkipMips;
+
+   /// The streaming frame of the last footprint request.
+   U32 lastRequest;
+
+   /// The streaming frame the texture was last set on the device.
+   U32 lastBound;
+
+   /// The footprint requests made during the lastRequest frame
+   /// and the binds during the lastBound frame.  More binds than
+   /// requests means something used it without a footprint.
+   U32 numRequests;
+   U32 numBinds;
+
+   /// The skip of the load in flight if pending is set.
+   U32 pendingSkipMips;
+   bool pending;
+};
+
+
 class GFXTextureObject : public StrongRefBase, public GFXResource
 {
    public:
@@ -104,6 +147,10 @@ class GFXTextureObject : public StrongRefBase, public GFXResource
       GFXTextureProfile *mProfile;
       GFXFormat          mFormat;
 
+      /// The mip streaming state or NULL if the
+      /// texture is fully loaded.
+      GFXTextureStreamState *mStream;
+
 
       GFXTextureObject(GFXDevice * aDevice, GFXTextureProfile *profile);
       virtual ~GFXTextureObject();
@@ -123,6 +170,9 @@ class GFXTextureObject : public StrongRefBase, public GFXResource
       /// Returns true if this texture is a render target.
       bool isRenderTarget() const { return mProfile->isRenderTarget(); }
 
+      /// Returns true if the texture streams its mips.
+      bool isStreamed() const { return mStream != NULL; }
+
       /// Returns the file path to the texture if
       /// it was loaded from disk.
       const String& getPath() const { return mPath; }
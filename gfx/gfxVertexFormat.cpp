@@ -17,6 +17,8 @@ const String GFXSemantic::TANGENT = String( "TANGENT" ).intern();
 const String GFXSemantic::TANGENTW = String( "TANGENTW" ).intern();
 const String GFXSemantic::COLOR = String( "COLOR" ).intern();
 const String GFXSemantic::TEXCOORD = String( "TEXCOORD" ).intern();
+const String GFXSemantic::BLENDINDICES = String( "BLENDINDICES" ).intern();
+const String GFXSemantic::BLENDWEIGHT = String( "BLENDWEIGHT" ).intern();
 
 
 
@@ -49,7 +51,8 @@ GFXVertexFormat::GFXVertexFormat()
    :  mDirty( true ),
       mHasColor( false ),
       mHasNormalAndTangent( false ),
-      mTexCoordCount( 0 )
+      mTexCoordCount( 0 ),
+      mHasBlendIndices( false )
 {
    VECTOR_SET_ASSOCIATION( mElements );
 }
@@ -101,6 +104,14 @@ U32 GFXVertexFormat::getTexCoordCount() const
    return mTexCoordCount;
 }
 
+bool GFXVertexFormat::hasBlendIndices() const
+{
+   if ( mDirty )
+      const_cast<GFXVertexFormat*>(this)->_updateDirty();
+
+   return mHasBlendIndices;
+}
+
 bool GFXVertexFormat::isEqual( const GFXVertexFormat &format ) const
 {
    return getDescription().equal( format.getDescription(), String::NoCase );
@@ -115,6 +126,8 @@ void GFXVertexFormat::_updateDirty()
    mHasColor = false;
 
    bool hasNormal = false;
+   bool hasBlendIndices = false;
+   bool hasBlendWeight = false;
    bool hasTangent = false;
 
    mDescription.clear();
@@ -135,9 +148,14 @@ void GFXVertexFormat::_updateDirty()
          mHasColor = true;
       else if ( element.isSemantic( GFXSemantic::TEXCOORD ) )
          ++mTexCoordCount;
+      else if ( element.isSemantic( GFXSemantic::BLENDINDICES ) )
+         hasBlendIndices = true;
+      else if ( element.isSemantic( GFXSemantic::BLENDWEIGHT ) )
+         hasBlendWeight = true;
    }
 
    mHasNormalAndTangent = hasNormal && hasTangent;
+   mHasBlendIndices = hasBlendIndices && hasBlendWeight;
 
    // Make sure the hash is created here once
    // so that it can be used in comparisions later.
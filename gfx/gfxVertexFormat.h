@@ -28,6 +28,11 @@ struct GFXSemantic
    static const String TANGENTW;
    static const String COLOR;
    static const String TEXCOORD;
+
+   /// The bone indices and weights used for skinning in
+   /// the vertex shader.  These are bound as texcoords.
+   static const String BLENDINDICES;
+   static const String BLENDWEIGHT;
 };
 
 
@@ -141,6 +146,10 @@ public:
    /// counting the number of "TEXCOORD" semantics.
    U32 getTexCoordCount() const;
 
+   /// Returns true if there are bone indices and 
+   /// weights for skinning in the vertex format.
+   bool hasBlendIndices() const;
+
    /// Returns true if these two formats are equal.
    bool isEqual( const GFXVertexFormat &format ) const;
 
@@ -171,6 +180,10 @@ protected:
    /// number of "TEXCOORD" semantics.
    U32 mTexCoordCount;
 
+   /// Is true if there are blend indices and 
+   /// weights in the vertex format.
+   bool mHasBlendIndices;
+
    /// The a string which uniquely identifies
    /// this vertex format.
    String mDescription;
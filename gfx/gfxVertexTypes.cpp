@@ -25,6 +25,15 @@ GFXImplementVertexFormat( GFXVertexPTT )
    addElement( GFXSemantic::TEXCOORD, GFXDeclType_Float2, 1 );
 }
 
+GFXImplementVertexFormat( GFXVertexInstanceTransform )
+{
+   // These are not TEXCOORD semantics so that they are not counted
+   // as texture coords when added to the vertex format of a mesh.
+   addElement( "INSTTRANS0", GFXDeclType_Float4, 8 );
+   addElement( "INSTTRANS1", GFXDeclType_Float4, 9 );
+   addElement( "INSTTRANS2", GFXDeclType_Float4, 10 );
+}
+
 GFXImplementVertexFormat( GFXVertexPTTT )
 {
    addElement( GFXSemantic::POSITION, GFXDeclType_Float3 );
@@ -18,6 +18,9 @@
 #ifndef _MPOINT3_H_
 #include "math/mPoint3.h"
 #endif
+#ifndef _MPOINT4_H_
+#include "math/mPoint4.h"
+#endif
 
 // Disable warning 'structure was padded due to __declspec(align())'
 // It's worth noting, though, that GPUs are heavily cache dependent and using
@@ -139,6 +142,17 @@ GFXDeclareVertexFormat( GFXVertexPNTTB )
    Point2F texCoord2;
 };
 
+/// The per-instance stream used for hardware instancing.  It holds
+/// the first three rows of the object to world transform which are
+/// bound to the shader as TEXCOORD 8 thru 10.
+/// @see GFXDevice::setInstanceBuffer
+GFXDeclareVertexFormat( GFXVertexInstanceTransform )
+{
+   Point4F row0;
+   Point4F row1;
+   Point4F row2;
+};
+
 /*
 DEFINE_VERT( GFXVertexPNTB,
             GFXVertexFlagXYZ | GFXVertexFlagNormal | GFXVertexFlagTextureCount2 | 
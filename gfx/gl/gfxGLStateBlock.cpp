@@ -14,6 +14,7 @@ GFXGLStateBlock::GFXGLStateBlock(const GFXStateBlockDesc& desc) :
    mDesc(desc),
    mCachedHashValue(desc.getHashValue())
 {
+   mDescriptor.set( mDesc );
 }
 
 GFXGLStateBlock::~GFXGLStateBlock()
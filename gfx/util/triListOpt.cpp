@@ -2,6 +2,7 @@
 #include "core/frameAllocator.h"
 #include "platform/profiler.h"
 #include "math/mMathFn.h"
+#include "math/mPoint3.h"
 
 namespace TriListOpt
 {
@@ -192,6 +193,258 @@ void OptimizeTriangleOrdering(const dsize_t numVerts, const dsize_t numIndices,
    // FrameTemp will call destructInPlace to clean up vertex lists
 }
 
+//------------------------------------------------------------------------------
+
+/// Simulates a FIFO vertex cache with a timestamp per vertex.  A vertex
+/// is in the cache if fewer than cacheSize misses have happened since
+/// it was last loaded.
+class FIFOCacheModel
+{
+   U32 *mTimeStamps;
+   U32 mTime;
+   U32 mCacheSize;
+
+public:
+
+   FIFOCacheModel(U32 *timeStamps, const dsize_t numVerts, const U32 cacheSize)
+      : mTimeStamps(timeStamps), mTime(cacheSize + 1), mCacheSize(cacheSize)
+   {
+      dMemset(mTimeStamps, 0, numVerts * sizeof(U32));
+   }
+
+   /// Returns true if the vertex had to be loaded.
+   bool useVertex(const U32 vIdx)
+   {
+      if(mTime - mTimeStamps[vIdx] <= mCacheSize)
+         return false;
+
+      mTimeStamps[vIdx] = mTime++;
+      return true;
+   }
+
+   /// Returns the number of misses for the triangle.
+   U32 useTriangle(const IndexType *tri)
+   {
+      return U32(useVertex(tri[0])) + U32(useVertex(tri[1])) + U32(useVertex(tri[2]));
+   }
+
+   /// Empties the cache.
+   void flush() { mTime += mCacheSize + 1; }
+};
+
+void CalcCacheStats(const dsize_t numVerts, const dsize_t numIndices, const IndexType *indices, CacheStats *outStats, const U32 cacheSize)
+{
+   outStats->acmr = 0.0f;
+   outStats->atvr = 0.0f;
+
+   const U32 numTris = numIndices / 3;
+   if(numTris == 0 || numVerts == 0)
+      return;
+
+   FrameTemp<U32> timeStamps(numVerts);
+   FIFOCacheModel cache(~timeStamps, numVerts, cacheSize);
+
+   FrameTemp<bool> referenced(numVerts);
+   dMemset(~referenced, 0, numVerts * sizeof(bool));
+
+   U32 misses = 0;
+   U32 numReferenced = 0;
+   for(U32 i = 0; i < numTris * 3; i++)
+   {
+      AssertFatal(indices[i] < numVerts, "Out of range index.");
+      if(cache.useVertex(indices[i]))
+         misses++;
+
+      if(!referenced[indices[i]])
+      {
+         referenced[indices[i]] = true;
+         numReferenced++;
+      }
+   }
+
+   outStats->acmr = F32(misses) / F32(numTris);
+   outStats->atvr = F32(misses) / F32(numReferenced);
+}
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+   struct Cluster
+   {
+      U32 start;
+      U32 numTris;
+      F32 sortKey;
+   };
+
+   S32 QSORT_CALLBACK compareClusters(const void *a, const void *b)
+   {
+      const F32 keyA = ((const Cluster *)a)->sortKey;
+      const F32 keyB = ((const Cluster *)b)->sortKey;
+
+      // Sort by key, outward facing first, and keep the
+      // original order otherwise so the result is stable.
+      if(keyA != keyB)
+         return keyA > keyB ? -1 : 1;
+      return S32(((const Cluster *)a)->start) - S32(((const Cluster *)b)->start);
+   }
+}
+
+void OptimizeOverdraw(const dsize_t numVerts, const dsize_t numIndices, IndexType *indices, const Point3F *positions, const F32 threshold)
+{
+   PROFILE_SCOPE(TriListOpt_OptimizeOverdraw);
+
+   const U32 numTris = numIndices / 3;
+   if(numTris < 2 || numVerts == 0)
+      return;
+
+   CacheStats stats;
+   CalcCacheStats(numVerts, numIndices, indices, &stats);
+   const F32 maxClusterACMR = stats.acmr * threshold;
+
+   //
+   // Step 1: Split the list into clusters.  A cluster ends where a 
+   // triangle misses on all its vertices, which is a boundary the
+   // cache optimization already made, or as soon as the cluster is
+   // about as cache efficient as the whole list.
+   //
+   Vector<Cluster> clusters;
+   {
+      FrameTemp<U32> timeStamps(numVerts);
+      FIFOCacheModel cache(~timeStamps, numVerts, DefaultFIFOCacheSize);
+
+      U32 start = 0;
+      U32 clusterMisses = 0;
+      for(U32 tri = 0; tri < numTris; tri++)
+      {
+         const U32 misses = cache.useTriangle(indices + tri * 3);
+         if(misses == 3 && tri > start)
+         {
+            Cluster c = { start, tri - start, 0.0f };
+            clusters.push_back(c);
+            start = tri;
+            clusterMisses = 0;
+         }
+
+         clusterMisses += misses;
+         if(F32(clusterMisses) <= maxClusterACMR * F32(tri - start + 1))
+         {
+            Cluster c = { start, tri - start + 1, 0.0f };
+            clusters.push_back(c);
+            start = tri + 1;
+            clusterMisses = 0;
+            cache.flush();
+         }
+      }
+
+      if(start < numTris)
+      {
+         Cluster c = { start, numTris - start, 0.0f };
+         clusters.push_back(c);
+      }
+   }
+
+   if(clusters.size() < 2)
+      return;
+
+   //
+   // Step 2: Sort the clusters by how much they face away from the
+   // center of the mesh.  Those facing out are most likely to be in
+   // front of the rest of the mesh, so they are drawn first.
+   //
+   FrameTemp<Point3F> centroids(clusters.size());
+   FrameTemp<Point3F> normals(clusters.size());
+
+   Point3F meshCentroid(0.0f, 0.0f, 0.0f);
+   F32 meshArea = 0.0f;
+   for(U32 i = 0; i < clusters.size(); i++)
+   {
+      Point3F centroid(0.0f, 0.0f, 0.0f);
+      Point3F normal(0.0f, 0.0f, 0.0f);
+      F32 area = 0.0f;
+
+      const IndexType *tri = indices + clusters[i].start * 3;
+      for(U32 j = 0; j < clusters[i].numTris; j++, tri += 3)
+      {
+         const Point3F &p0 = positions[tri[0]];
+         const Point3F &p1 = positions[tri[1]];
+         const Point3F &p2 = positions[tri[2]];
+
+         const Point3F triNormal = mCross(p1 - p0, p2 - p0);
+         const F32 triArea = triNormal.len();
+
+         centroid += (p0 + p1 + p2) * triArea;
+         normal += triNormal;
+         area += triArea;
+      }
+
+      meshCentroid += centroid;
+      meshArea += area;
+
+      centroids[i] = area > 0.0f ? centroid / (area * 3.0f) : positions[indices[clusters[i].start * 3]];
+      normals[i] = normal;
+   }
+
+   if(meshArea > 0.0f)
+      meshCentroid /= meshArea * 3.0f;
+
+   for(U32 i = 0; i < clusters.size(); i++)
+   {
+      Point3F normal = normals[i];
+      if(normal.lenSquared() > 0.0f)
+         normal.normalize();
+
+      clusters[i].sortKey = mDot(centroids[i] - meshCentroid, normal);
+   }
+
+   dQsort(clusters.address(), clusters.size(), sizeof(Cluster), compareClusters);
+
+   //
+   // Step 3: Write out the clusters in their new order.
+   //
+   FrameTemp<IndexType> sorted(numTris * 3);
+   IndexType *out = ~sorted;
+   for(U32 i = 0; i < clusters.size(); i++)
+   {
+      const U32 count = clusters[i].numTris * 3;
+      dMemcpy(out, indices + clusters[i].start * 3, count * sizeof(IndexType));
+      out += count;
+   }
+
+   dMemcpy(indices, ~sorted, numTris * 3 * sizeof(IndexType));
+}
+
+//------------------------------------------------------------------------------
+
+U32 OptimizeVertexFetch(const dsize_t numVerts, const dsize_t numIndices, IndexType *indices, U32 *outRemap)
+{
+   PROFILE_SCOPE(TriListOpt_OptimizeVertexFetch);
+
+   dMemset(outRemap, 0xFF, numVerts * sizeof(U32));
+
+   U32 nextVert = 0;
+   for(U32 i = 0; i < numIndices; i++)
+   {
+      AssertFatal(indices[i] < numVerts, "Out of range index.");
+
+      U32 &remap = outRemap[indices[i]];
+      if(remap == U32_MAX)
+         remap = nextVert++;
+
+      indices[i] = remap;
+   }
+
+   // Unused vertices go at the end in their original order.
+   const U32 numUsed = nextVert;
+   for(U32 v = 0; v < numVerts; v++)
+   {
+      if(outRemap[v] == U32_MAX)
+         outRemap[v] = nextVert++;
+   }
+
+   return numUsed;
+}
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 
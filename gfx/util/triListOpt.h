@@ -3,12 +3,30 @@
 
 #include "core/util/tVector.h"
 
+class Point3F;
+
 namespace TriListOpt
 {
    typedef U32 IndexType;
 
    const U32 MaxSizeVertexCache = 32;
 
+   /// The size of the FIFO cache used to measure and cluster the
+   /// triangles, which is about the post transform cache of most GPUs.
+   const U32 DefaultFIFOCacheSize = 16;
+
+   /// The vertex cache efficiency of a triangle list.
+   struct CacheStats
+   {
+      /// Average cache miss ratio, the vertices transformed per triangle.
+      /// 0.5 is the best possible and 3 the worst.
+      F32 acmr;
+
+      /// Average transform to vertex ratio, the times each referenced 
+      /// vertex is transformed.  1 is the best possible.
+      F32 atvr;
+   };
+
    struct VertData
    {
       S32 cachePosition;
@@ -64,6 +82,36 @@ namespace TriListOpt
    /// @note Both 'indices' and 'outIndices' can point to the same memory.
    void OptimizeTriangleOrdering(const dsize_t numVerts, const dsize_t numIndices, const U32 *indices, IndexType *outIndices);
 
+   /// Reorders a triangle list which was optimized with OptimizeTriangleOrdering
+   /// so that the parts of the mesh facing out from its center draw first,
+   /// which reduces overdraw.  The list is split into clusters at the points 
+   /// where starting over with an empty vertex cache costs little, and the 
+   /// clusters are sorted by how much they face away from the center.  This
+   /// is the clustering of Sander, Nehab and Barczak's "Fast Triangle 
+   /// Reordering for Vertex Locality and Reduced Overdraw".
+   ///
+   /// @param   numVerts Number of vertices indexed by the 'indices'
+   /// @param numIndices Number of elements in 'indices'
+   /// @param    indices The index buffer which is reordered in place
+   /// @param  positions The vertex positions
+   /// @param  threshold How much worse than the whole list the vertex cache 
+   ///                   efficiency of a cluster may be at a split
+   void OptimizeOverdraw(const dsize_t numVerts, const dsize_t numIndices, IndexType *indices, const Point3F *positions, const F32 threshold = 1.05f);
+
+   /// Renumbers the vertices in the order the indices first use them so
+   /// that vertex fetches walk the vertex buffer front to back.  Vertices
+   /// which aren't referenced are moved to the end.
+   ///
+   /// @param   numVerts Number of vertices indexed by the 'indices'
+   /// @param numIndices Number of elements in 'indices'
+   /// @param    indices The index buffer which is renumbered in place
+   /// @param   outRemap Receives numVerts entries, the new index of each vertex
+   /// @return The number of vertices referenced by the indices.
+   U32 OptimizeVertexFetch(const dsize_t numVerts, const dsize_t numIndices, IndexType *indices, U32 *outRemap);
+
+   /// Measures the vertex cache efficiency of a triangle list with a FIFO cache.
+   void CalcCacheStats(const dsize_t numVerts, const dsize_t numIndices, const IndexType *indices, CacheStats *outStats, const U32 cacheSize = DefaultFIFOCacheSize);
+
    namespace FindVertexScore
    {
       const F32 CacheDecayPower = 1.5f;
@@ -66,6 +66,7 @@ InteriorInstance::InteriorInstance()
 
    mShowTerrainInside = false;
    mSmoothLighting = false;
+   mOccluder = false;
 
    mSkinBase = StringTable->insert("base");
    mAudioProfile = 0;
@@ -140,6 +141,7 @@ void InteriorInstance::initPersistFields()
    addGroup("Misc"); 
    addField("showTerrainInside", TypeBool,                  Offset(mShowTerrainInside, InteriorInstance));
    addField("smoothLighting", TypeBool,                  Offset(mSmoothLighting, InteriorInstance));
+   addField("occluder", TypeBool,                  Offset(mOccluder, InteriorInstance), "Use the collision hull to hide the objects behind this one.  Off by default since the hull includes non-rendered brushes and glass.");
    endGroup("Misc");
 
    Parent::initPersistFields();
@@ -152,6 +154,7 @@ void InteriorInstance::consoleInit()
    Con::addVariable("pref::Interior::VertexLighting", TypeBool, &Interior::smUseVertexLighting);
    Con::addVariable("pref::Interior::TexturedFog", TypeBool, &Interior::smUseTexturedFog);
    Con::addVariable("pref::Interior::lockArrays", TypeBool, &Interior::smLockArrays);
+   Con::addVariable("pref::Interior::optimizeMeshes", TypeBool, &InteriorSimpleMesh::smOptimizeBuffers);
 
    Con::addVariable("pref::Interior::detailAdjust", TypeF32, &InteriorInstance::smDetailModification);
 
@@ -420,6 +423,8 @@ bool InteriorInstance::loadInterior()
 
 void InteriorInstance::unloadInterior()
 {
+   clearOccluderMesh();
+
    mConvexList->nukeList();
    delete mConvexList;
    mConvexList = new Convex;
@@ -1061,6 +1066,7 @@ U32 InteriorInstance::packUpdate(NetConnection* c, U32 mask, BitStream* stream)
       stream->writeString(mInteriorFileName);
       stream->writeFlag(mShowTerrainInside);
       stream->writeFlag(mSmoothLighting);
+      stream->writeFlag(mOccluder);
 
       // Write the transform (do _not_ use writeAffineTransform.  Since this is a static
       //  object, the transform must be RIGHT THE *&)*$&^ ON or it will goof up the
@@ -1140,6 +1146,9 @@ void InteriorInstance::unpackUpdate(NetConnection* c, BitStream* stream)
       //Smooth lighting flag
       mSmoothLighting = stream->readFlag();
 
+      // Occluder flag
+      mOccluder = stream->readFlag();
+
       // Transform
       mathRead(*stream, &temp);
       mathRead(*stream, &tempScale);
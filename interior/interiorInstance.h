@@ -78,6 +78,11 @@ class InteriorInstance : public SceneObject
    /// This returns true if the interior should be lit with smooth lighting (slower)
    bool useSmoothLighting() {return(mSmoothLighting);}
 
+   /// The collision hull is drawn into the software occlusion buffer
+   /// only when the occluder field is set, as the hull also holds clip
+   /// brushes and translucent surfaces.
+   bool isOccluder() const { return mOccluder; }
+
    /// This sets the alarm mode of the interior.
    /// @param   alarm   If true the interior will be in an alarm state next frame
    void setAlarmMode(const bool alarm);
@@ -186,6 +191,7 @@ class InteriorInstance : public SceneObject
 
    bool                                 mShowTerrainInside;    ///< Enables or disables terrain showing through the interior
    bool                                 mSmoothLighting;       ///< Enables or disables doing the longer smooth lighting calculations
+   bool                                 mOccluder;             ///< Enables or disables hiding objects behind the interior hull
    SFXProfile *                       mAudioProfile;         ///< Audio profile
    SFXEnvironment *                   mAudioEnvironment;     ///< Audio environment
    S32                                  mForcedDetailLevel;    ///< Forced LOD, if -1 auto LOD
@@ -13,10 +13,13 @@
 #include "materials/materialManager.h"
 #include "sceneGraph/sceneGraph.h"
 #include "sceneGraph/sceneState.h"
+#include "gfx/util/triListOpt.h"
 
 Vector<MeshRenderInst *> g_renderInstList;
 Vector<MeshRenderInst *> *InteriorSimpleMesh::renderInstList = &g_renderInstList;//new Vector<MeshRenderInst *>();
 
+bool InteriorSimpleMesh::smOptimizeBuffers = true;
+
 
 // Checks for polygon level collision with given planes
 U32 _whichSide(PlaneF pln, Point3F* verts)
@@ -468,6 +471,42 @@ void InteriorSimpleMesh::buildBuffers()
 
    AssertFatal((oldcount == newcount), "Invalid primitive pack.");
 
+   // optimize the triangle lists for the vertex cache and overdraw,
+   // then renumber the vertices in the order the triangles use them
+   Vector<U32> vertOrder;
+   if(smOptimizeBuffers && packedIndices.size() > 0)
+   {
+      Vector<U32> optIndices;
+      optIndices.setSize(packedIndices.size());
+      for(U32 i=0; i<packedIndices.size(); i++)
+         optIndices[i] = packedIndices[i];
+
+      Vector<U32> tmpIndices;
+      tmpIndices.setSize(packedIndices.size());
+      for(U32 i=0; i<packedPrimitives.size(); i++)
+      {
+         const primitive &prim = packedPrimitives[i];
+         if(prim.count < 3)
+            continue;
+
+         U32 *primIndices = optIndices.address() + prim.start;
+         TriListOpt::OptimizeTriangleOrdering(verts.size(), prim.count, primIndices, tmpIndices.address());
+         dCopyArray(primIndices, tmpIndices.address(), prim.count);
+         TriListOpt::OptimizeOverdraw(verts.size(), prim.count, primIndices, verts.address());
+      }
+
+      Vector<U32> remap;
+      remap.setSize(verts.size());
+      TriListOpt::OptimizeVertexFetch(verts.size(), optIndices.size(), optIndices.address(), remap.address());
+
+      vertOrder.setSize(verts.size());
+      for(U32 i=0; i<remap.size(); i++)
+         vertOrder[remap[i]] = i;
+
+      for(U32 i=0; i<optIndices.size(); i++)
+         packedIndices[i] = (U16)optIndices[i];
+   }
+
    // build the GFX buffers...
    Vector<GFXPrimitive> packedprims;
    packedprims.setSize(packedPrimitives.size());
@@ -503,14 +542,15 @@ void InteriorSimpleMesh::buildBuffers()
    for(U32 i=0; i<packedverts.size(); i++)
    {
       GFXVertexPNTTB &v = packedverts[i];
+      const U32 src = vertOrder.empty() ? i : vertOrder[i];
 
-      trans.mulP(verts[i], &v.point);
-      trans.mulV(norms[i], &v.normal);
-      trans.mulV(tang[i], &v.T);
-      trans.mulV(binorm[i], &v.B);
+      trans.mulP(verts[src], &v.point);
+      trans.mulV(norms[src], &v.normal);
+      trans.mulV(tang[src], &v.T);
+      trans.mulV(binorm[src], &v.B);
 
-      v.texCoord = diffuseUVs[i];
-      v.texCoord2 = lightmapUVs[i];
+      v.texCoord = diffuseUVs[src];
+      v.texCoord2 = lightmapUVs[src];
 
       v.T = v.T - v.normal * mDot(v.normal, v.T);
       v.T.normalize();
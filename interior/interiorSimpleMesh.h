@@ -116,6 +116,10 @@ public:
    GFXVertexBufferHandle<GFXVertexPNTTB> vertBuff;
    GFXPrimitiveBufferHandle primBuff;
    void buildBuffers();
+
+   /// Optimize the triangle and vertex order of the buffers for the
+   /// vertex cache and overdraw, since the exporter writes strips.
+   static bool smOptimizeBuffers;
    void buildTangent(U32 i0, U32 i1, U32 i2, Vector<Point3F> &tang, Vector<Point3F> &binorm);
    void packPrimitive(primitive &primnew, const primitive &primold, Vector<U16> &indicesnew,
       bool flipped, Vector<Point3F> &tang, Vector<Point3F> &binorm);
@@ -90,6 +90,7 @@ private:
    // Rendering
   protected:
    bool prepRenderImage(SceneState *state, const U32 stateKey, const U32 startZone, const bool modifyBaseZoneState);
+   bool isPrepRenderImageThreadSafe() const { return true; }
    void renderObject(SceneState *state);
    void renderShadowVolumes(SceneState *state);
 
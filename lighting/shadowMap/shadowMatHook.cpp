@@ -33,6 +33,7 @@ void ShadowMaterialHook::init( BaseMatInstance *inMat )
    features.addFeature( MFT_DiffuseMap );
    features.addFeature( MFT_TexAnim );
    features.addFeature( MFT_AlphaTest );
+   features.addFeature( MFT_HardwareSkinning );
 
    Material *shadowMat = (Material*)inMat->getMaterial();
    if ( dynamic_cast<CustomMaterial*>( shadowMat ) )
@@ -160,8 +160,18 @@ public:
 
    virtual const GFXVertexFormat* getVertexFormat() const = 0;
 
+   /// Returns true if this renders with a placeholder while its
+   /// shaders are compiling.  The active features are those of the
+   /// placeholder until this clears.
+   virtual bool isPending() const { return false; }
+
    virtual void dumpShaderInfo() const = 0;
 
+   /// Tells the mip streaming of the material textures that they
+   /// cover about pixelSize pixels on screen this frame.
+   /// @see GFXTextureManager::requestTextureDetail
+   virtual void requestTextureDetail( F32 pixelSize ) = 0;
+
    ///
    MatFeaturesDelegate& getFeaturesDelegate() { return mFeaturesDelegate; }
 
@@ -75,6 +75,9 @@ MatInstParameters::MatInstParameters(MaterialParameters* matParams)
 
 void MatInstParameters::loadParameters(ProcessedMaterial* pmat)
 {
+   if (mOwnParameters)
+      SAFE_DELETE(mParameters);
+
    mOwnParameters = true; 
    mParameters = pmat->allocMaterialParameters();
 }
@@ -227,6 +230,7 @@ void MatInstance::construct()
    mMatNameStr = "Unknown";
    mActiveParameters = NULL;
    mDefaultParameters = NULL;
+   mIsPending = false;
 
    MATMGR->_track(this);
 }
@@ -241,6 +245,9 @@ MatInstance::~MatInstance()
    for (U32 i = 0; i < mCurrentHandles.size(); i++)
       SAFE_DELETE(mCurrentHandles[i]);   
 
+   if ( mIsPending )
+      MATMGR->_removePendingInit(this);
+
    MATMGR->_untrack(this);
 }
 
@@ -291,6 +298,14 @@ bool MatInstance::processMaterial()
 
    SAFE_DELETE(mDefaultParameters);
 
+   if ( mIsPending )
+   {
+      MATMGR->_removePendingInit( this );
+      mIsPending = false;
+   }
+
+   bool asyncShaders = false;
+
    if( dynamic_cast<CustomMaterial*>(mMaterial) )
    {
       F32 pixVersion = GFX->getPixelShaderVersion();
@@ -313,23 +328,41 @@ bool MatInstance::processMaterial()
          mProcessedMaterial = new ProcessedCustomMaterial(*mMaterial);
    }
    else if(GFX->getPixelShaderVersion() > 0.001)
+   {
       mProcessedMaterial = getShaderMaterial();
+      asyncShaders = MaterialManager::isAsyncInitEnabled();
+   }
    else
       mProcessedMaterial = new ProcessedFFMaterial(*mMaterial);
 
    if (mProcessedMaterial)
    {
       mProcessedMaterial->addStateBlockDesc( mUserDefinedState );
-      mProcessedMaterial->setShaderMacros( mUserMacros );
-
-      FeatureSet features( mFeatureList );
-      features.exclude( MATMGR->getExclusionFeatures() );
       
-      if( !mProcessedMaterial->init(features, mVertexFormat, mFeaturesDelegate) )
+      if( !_initProcessedMaterial( mProcessedMaterial, asyncShaders ) )
       {
-         Con::errorf( "Failed to initialize material '%s'", getMaterial()->getName() );
+         const bool pending = mProcessedMaterial->isPending();
          SAFE_DELETE( mProcessedMaterial );
-         return false;
+
+         // If the shaders are compiling then render with a placeholder
+         // until the material manager can swap in the real material.
+         if ( pending )
+         {
+            mProcessedMaterial = getPlaceholderMaterial();
+            if ( _initProcessedMaterial( mProcessedMaterial, false ) )
+            {
+               mIsPending = true;
+               MATMGR->_addPendingInit( this );
+            }
+            else
+               SAFE_DELETE( mProcessedMaterial );
+         }
+
+         if ( !mProcessedMaterial )
+         {
+            Con::errorf( "Failed to initialize material '%s'", getMaterial()->getName() );
+            return false;
+         }
       }
 
       mDefaultParameters = new MatInstParameters(mProcessedMaterial->getDefaultMaterialParameters());
@@ -346,6 +379,67 @@ ProcessedMaterial* MatInstance::getShaderMaterial()
    return new ProcessedShaderMaterial(*mMaterial);
 }
 
+ProcessedMaterial* MatInstance::getPlaceholderMaterial()
+{
+   ProcessedMaterial *pmat = new ProcessedFFMaterial(*mMaterial);
+   pmat->addStateBlockDesc( mUserDefinedState );
+   return pmat;
+}
+
+bool MatInstance::_initProcessedMaterial( ProcessedMaterial *pmat, bool asyncShaders )
+{
+   pmat->setShaderMacros( mUserMacros );
+   pmat->setAsyncShaders( asyncShaders );
+
+   FeatureSet features( mFeatureList );
+   features.exclude( MATMGR->getExclusionFeatures() );
+
+   return pmat->init( features, mVertexFormat, mFeaturesDelegate );
+}
+
+bool MatInstance::_finishPendingInit()
+{
+   AssertFatal( mIsPending, "MatInstance::_finishPendingInit - This isn't pending!" );
+
+   ProcessedMaterial *pmat = getShaderMaterial();
+   pmat->addStateBlockDesc( mUserDefinedState );
+
+   if ( !_initProcessedMaterial( pmat, true ) )
+   {
+      const bool pending = pmat->isPending();
+      delete pmat;
+      if ( pending )
+         return false;
+
+      // Keep the placeholder as it's better than nothing.
+      Con::errorf( "Failed to initialize material '%s'", getMaterial()->getName() );
+      mIsPending = false;
+      return true;
+   }
+
+   ProcessedMaterial *placeholder = mProcessedMaterial;
+   MatInstParameters *placeholderParams = mDefaultParameters;
+
+   mProcessedMaterial = pmat;
+   mDefaultParameters = new MatInstParameters( pmat->getDefaultMaterialParameters() );
+   if ( mActiveParameters == placeholderParams )
+      mActiveParameters = mDefaultParameters;
+
+   // Point the handles and parameters given 
+   // out so far to the new material.
+   for (U32 i = 0; i < mCurrentHandles.size(); i++)
+      mCurrentHandles[i]->loadHandle(mProcessedMaterial);
+
+   for (U32 i = 0; i < mCurrentParameters.size(); i++)
+      mCurrentParameters[i]->loadParameters(mProcessedMaterial);
+
+   delete placeholderParams;
+   delete placeholder;
+
+   mIsPending = false;
+   return true;
+}
+
 void MatInstance::addStateBlockDesc(const GFXStateBlockDesc& desc)
 {   
    mUserDefinedState = desc;
@@ -493,3 +587,9 @@ void MatInstance::dumpShaderInfo() const
 
    mProcessedMaterial->dumpMaterialInfo();
 }
+
+void MatInstance::requestTextureDetail( F32 pixelSize )
+{
+   if ( mProcessedMaterial )
+      mProcessedMaterial->requestTextureDetail( pixelSize );
+}
@@ -56,12 +56,16 @@ public:
    virtual const FeatureSet& getFeatures() const;
    virtual const FeatureSet& getRequestedFeatures() const { return mFeatureList; }
    virtual void dumpShaderInfo() const;
+   virtual void requestTextureDetail( F32 pixelSize );
 
    ProcessedMaterial *getProcessedMaterial() const { return mProcessedMaterial; }
 
+   virtual bool isPending() const { return mIsPending; }
+
 protected:
 
    friend class Material;
+   friend class MaterialManager;
 
    /// Create a material instance by reference to a Material.
    MatInstance( Material &mat );
@@ -69,6 +73,18 @@ protected:
    virtual bool processMaterial();
    virtual ProcessedMaterial* getShaderMaterial();
 
+   /// Returns the cheap material which is rendered while 
+   /// the shaders of the real one are compiling.
+   virtual ProcessedMaterial* getPlaceholderMaterial();
+
+   /// Sets the features, macros and shader mode and inits it.
+   bool _initProcessedMaterial( ProcessedMaterial *pmat, bool asyncShaders );
+
+   /// Swaps in the real material if its shaders are done compiling.
+   /// Returns false if this is still pending.
+   /// @see MaterialManager::processPendingInits
+   bool _finishPendingInit();
+
    Material* mMaterial;
    ProcessedMaterial* mProcessedMaterial;
 
@@ -89,6 +105,10 @@ protected:
    Vector<MatInstParameters*> mCurrentParameters;
    MatInstParameters* mActiveParameters;
    MatInstParameters* mDefaultParameters;
+
+   /// @see isPending
+   bool mIsPending;
+
 private:
    void construct();  
 };
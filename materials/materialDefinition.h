@@ -105,11 +105,13 @@ public:
 
    class StageData
    {
-   protected:
+   public:
 
       ///
       typedef HashTable<const FeatureType*,GFXTexHandle> TextureTable;
 
+   protected:
+
       /// The sparse table of textures by feature index.
       /// @see getTex
       /// @see setTex
@@ -181,6 +183,9 @@ public:
          return result;
       }
 
+      /// Returns the table of textures by feature type.
+      const TextureTable& getTextures() const { return mTextures; }
+
       /// Returns the stage cubemap.
       GFXCubemap* getCubemap() const { return mCubemap; }
 
@@ -56,4 +56,6 @@ ImplementFeatureType( MFT_NormalsOut, MFG_PreLighting, 1.0f, false );
 ImplementFeatureType( MFT_LightbufferMRT, MFG_PreLighting, 1.0f, false );
 ImplementFeatureType( MFT_RenderTarget1_Zero, MFG_PreTexture, 1.0f, false );
 
-ImplementFeatureType( MFT_Foliage, MFG_PreTransform, 1.0f, false );
\ No newline at end of file
+ImplementFeatureType( MFT_Foliage, MFG_PreTransform, 1.0f, false );
+ImplementFeatureType( MFT_UseInstancing, MFG_PreTransform, 2.0f, false );
+ImplementFeatureType( MFT_HardwareSkinning, MFG_PreTransform, 0.5f, true );
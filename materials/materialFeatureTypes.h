@@ -152,5 +152,16 @@ DeclareFeatureType( MFT_RenderTarget1_Zero );
 
 DeclareFeatureType( MFT_Foliage );
 
+/// This feature transforms the vertex into world space using the
+/// per-instance transform stream for hardware instancing.
+/// @see GFXVertexInstanceTransform
+DeclareFeatureType( MFT_UseInstancing );
+
+/// This feature blends the vertex by the bone palette in 
+/// SceneGraphData using the bone indices and weights in 
+/// the vertex format.
+/// @see GFXSemantic::BLENDINDICES
+DeclareFeatureType( MFT_HardwareSkinning );
+
 
 #endif // _MATERIALFEATURETYPES_H_
@@ -11,11 +11,16 @@
 #include "lighting/lightManager.h"
 #include "core/util/safeDelete.h"
 #include "shaderGen/shaderGen.h"
+#include "gfx/gfxShaderCache.h"
+#include "console/consoleTypes.h"
 
+bool MaterialManager::smAsyncInit = true;
+F32 MaterialManager::smAsyncInitBudgetMS = 2.0f;
 
 MaterialManager::MaterialManager()
 {
    VECTOR_SET_ASSOCIATION( mMatInstanceList );
+   VECTOR_SET_ASSOCIATION( mPendingInits );
 
    mDt = 0.0f; 
    mAccumTime = 0.0f; 
@@ -31,6 +36,12 @@ MaterialManager::MaterialManager()
    mMaterialSet = NULL;
 
    mUsingPrePass = false;
+
+   mCompletedInits = 0;
+   mLastAsyncCompileCount = 0;
+
+   Con::addVariable( "$pref::Materials::asyncInit", TypeBool, &smAsyncInit );
+   Con::addVariable( "$pref::Materials::asyncInitBudgetMS", TypeF32, &smAsyncInitBudgetMS );
 }
 
 MaterialManager::~MaterialManager()
@@ -333,6 +344,56 @@ void MaterialManager::_untrack( MatInstance *matInstance )
    mMatInstanceList.remove( matInstance );
 }
 
+void MaterialManager::_addPendingInit( MatInstance *matInstance )
+{
+   mPendingInits.push_back( matInstance );
+}
+
+void MaterialManager::_removePendingInit( MatInstance *matInstance )
+{
+   mPendingInits.remove( matInstance );
+}
+
+void MaterialManager::processPendingInits()
+{
+   if ( mPendingInits.empty() )
+      return;
+
+   // Nothing can be ready until another compile finishes.
+   const U32 compileCount = GFXShaderCache::getAsyncCompileCount();
+   if ( compileCount == mLastAsyncCompileCount )
+      return;
+
+   PROFILE_SCOPE( MaterialManager_ProcessPendingInits );
+
+   const U64 budget = U64( smAsyncInitBudgetMS * F64( Platform::getPerformanceCounterFrequency() ) / 1000.0 );
+   const U64 start = Platform::getPerformanceCounter();
+
+   // The instances which are still pending go to the back 
+   // so that the budget doesn't starve the rest of them.
+   const U32 count = mPendingInits.size();
+   U32 i = 0;
+   for ( ; i < count; i++ )
+   {
+      // Always finish at least one.
+      if ( i > 0 && Platform::getPerformanceCounter() - start > budget )
+         break;
+
+      MatInstance *inst = mPendingInits.first();
+      mPendingInits.pop_front();
+
+      if ( inst->_finishPendingInit() )
+         mCompletedInits++;
+      else
+         mPendingInits.push_back( inst );
+   }
+
+   // Only skip the next frames once all of them have 
+   // been checked against this compile count.
+   if ( i == count )
+      mLastAsyncCompileCount = compileCount;
+}
+
 void MaterialManager::recalcFeaturesFromPrefs()
 {
    mDefaultFeatures.clear();
@@ -394,6 +455,18 @@ ConsoleFunction( dumpMaterialInstances, void, 1, 1,
    MATMGR->dumpMaterialInstances();
 }
 
+ConsoleFunction( getMaterialInitStats, const char*, 1, 1, 
+   "Returns the number of pending material instances, the number of completed ones and "
+   "the number of shaders compiling on the thread pool as a space separated string." )
+{
+   char *ret = Con::getReturnBuffer( 64 );
+   dSprintf( ret, 64, "%d %d %d", 
+      MATMGR->getPendingInitCount(),
+      MATMGR->getCompletedInitCount(),
+      SHADERGEN->getPendingShaderCount() );
+   return ret;
+}
+
 ConsoleFunction( getMapEntry, const char *, 2, 2, 
    "getMapEntry( String ) Returns the material name via the materialList mapTo entry" )
 {
@@ -83,6 +83,21 @@ public:
    /// the active materials instances.
    void flushAndReInitInstances();
 
+   /// Swaps in the real materials of the instances which were rendering
+   /// with a placeholder once their shaders are compiled.  This is called
+   /// once per frame and stays within $pref::Materials::asyncInitBudgetMS.
+   void processPendingInits();
+
+   /// Returns true if new material instances should
+   /// compile their shaders on the thread pool.
+   static bool isAsyncInitEnabled() { return smAsyncInit; }
+
+   /// Returns the number of instances rendering with a placeholder.
+   U32 getPendingInitCount() const { return mPendingInits.size(); }
+
+   /// Returns the number of placeholders which have been swapped out.
+   U32 getCompletedInitCount() const { return mCompletedInits; }
+
    // Flush the instance
    void flushInstance( BaseMaterialDefinition *target );
    /// Re-initializes the material instances for a specific target material.   
@@ -94,6 +109,8 @@ protected:
    friend class MatInstance;
    void _track(MatInstance*);
    void _untrack(MatInstance*);
+   void _addPendingInit(MatInstance*);
+   void _removePendingInit(MatInstance*);
 
    /// @see LightManager::smActivateSignal
    void _onLMActivate( const char *lm, bool activate );
@@ -103,6 +120,21 @@ protected:
    SimSet* mMaterialSet;
    Vector<BaseMatInstance*> mMatInstanceList;
 
+   /// The instances rendering with a placeholder.
+   Vector<MatInstance*> mPendingInits;
+
+   U32 mCompletedInits;
+
+   /// The async shader compile count when the pending
+   /// instances were last all checked.
+   U32 mLastAsyncCompileCount;
+
+   /// Set from $pref::Materials::asyncInit.
+   static bool smAsyncInit;
+
+   /// Set from $pref::Materials::asyncInitBudgetMS.
+   static F32 smAsyncInitBudgetMS;
+
    /// The default material features.
    FeatureSet mDefaultFeatures;
 
@@ -13,7 +13,11 @@
 #include "materials/materialManager.h"
 #include "sceneGraph/sceneState.h"
 #include "gfx/gfxPrimitiveBuffer.h"
+#include "gfx/gfxTextureManager.h"
 #include "gfx/sim/cubemapData.h"
+#include "gfx/bitmap/gBitmap.h"
+#include "core/resourceManager.h"
+#include "core/volume.h"
 
 
 //-----------------------------------------------------------------------------
@@ -51,6 +55,8 @@ ProcessedMaterial::ProcessedMaterial()
    mCurrentParams( NULL ),
    mHasSetStageData( false ),
    mHasGlow( false ),   
+   mAsyncShaders( false ),
+   mPending( false ),
    mMaxStages( 0 ),
    mVertexFormat( NULL )
 {
@@ -59,6 +65,9 @@ ProcessedMaterial::ProcessedMaterial()
 
 ProcessedMaterial::~ProcessedMaterial()
 {
+   for ( U32 i=0; i < mPendingTextures.size(); i++ )
+      mPendingTextures[i].request->getDoneSignal().remove( this, &ProcessedMaterial::_onBitmapLoaded );
+
    for_each( mPasses.begin(), mPasses.end(), delete_pointer() );
 }
 
@@ -124,6 +133,17 @@ GFXTexHandle ProcessedMaterial::_createTexture( const char* filename, GFXTexture
    return GFXTexHandle( _getTexturePath(filename), profile, avar("%s() - NA (line %d)", __FUNCTION__, __LINE__) );
 }
 
+void ProcessedMaterial::requestTextureDetail( F32 pixelSize )
+{
+   for ( U32 i=0; i < mMaxStages; i++ )
+   {
+      const Material::StageData::TextureTable &textures = mStages[i].getTextures();
+      Material::StageData::TextureTable::ConstIterator iter = textures.begin();
+      for ( ; iter != textures.end(); iter++ )
+         GFXTextureManager::requestTextureDetail( iter->value.getPointer(), pixelSize );
+   }
+}
+
 void ProcessedMaterial::addStateBlockDesc(const GFXStateBlockDesc& sb)
 {
    mUserDefined = sb;
@@ -294,6 +314,76 @@ void ProcessedMaterial::_setRenderState(  const SceneState *state,
 }
 
 
+GFXTexHandle ProcessedMaterial::_createStageTexture( U32 stage, const FeatureType &type, const String &filename, GFXTextureProfile *profile )
+{
+   // DDS files are streamed by the texture manager and names
+   // without an extension are resolved by GBitmap::load(), so
+   // only the plain bitmap files are loaded in the background.
+   const Torque::Path path( _getTexturePath( filename ) );
+   if (  path.getExtension().isEmpty() ||
+         path.getExtension().equal( "dds", String::NoCase ) ||
+         !Torque::FS::IsFile( path ) )
+      return _createTexture( filename, profile );
+
+   ResourceLoadRequestRef request = ResourceManager::get().loadAsync<GBitmap>( path );
+   if ( request->isDone() )
+      return _createTexture( filename, profile );
+
+   // Stand in with a flat texture, so that the stage still gets
+   // its features, until ResourceManager::processAsyncLoads()
+   // finishes the bitmap and _onBitmapLoaded() swaps it in.
+   GBitmap bmp( 2, 2, false, GFXFormatR8G8B8A8 );
+   bmp.fill( profile == &GFXDefaultStaticNormalMapProfile ? ColorI( 128, 128, 255 ) : ColorI::ONE );
+
+   PendingTexture pending;
+   pending.stage = stage;
+   pending.type = &type;
+   pending.filename = filename;
+   pending.profile = profile;
+   pending.placeholder.set( &bmp, profile, false, avar("%s() - NA (line %d)", __FUNCTION__, __LINE__) );
+   pending.request = request;
+   mPendingTextures.push_back( pending );
+
+   request->getDoneSignal().notify( this, &ProcessedMaterial::_onBitmapLoaded );
+
+   return pending.placeholder;
+}
+
+void ProcessedMaterial::_onBitmapLoaded( ResourceLoadRequest *request )
+{
+   for ( U32 i=0; i < mPendingTextures.size(); )
+   {
+      const PendingTexture &pending = mPendingTextures[i];
+      if ( pending.request != request )
+      {
+         i++;
+         continue;
+      }
+
+      GFXTexHandle tex;
+      if ( request->getState() == ResourceLoadRequest::Loaded )
+         tex = _createTexture( pending.filename, pending.profile );
+
+      if ( !tex )
+         mMaterial->logError("Failed to load texture %s for stage %i", _getTexturePath(pending.filename).c_str(), pending.stage);
+      else
+      {
+         // The passes hold their own copy of the stage textures.
+         mStages[pending.stage].setTex( *pending.type, tex );
+         for ( U32 j=0; j < mPasses.size(); j++ )
+         {
+            for ( U32 k=0; k < Material::MAX_TEX_PER_PASS; k++ )
+            {
+               if ( mPasses[j]->mTexSlot[k].texObject.getPointer() == pending.placeholder.getPointer() )
+                  mPasses[j]->mTexSlot[k].texObject = tex;
+            }
+         }
+      }
+
+      mPendingTextures.erase( i );
+   }
+}
+
 void ProcessedMaterial::_setStageData()
 {
    // Only do this once
@@ -309,13 +399,13 @@ void ProcessedMaterial::_setStageData()
       // DiffuseMap
       if( mMaterial->mDiffuseMapFilename[i].isNotEmpty() )
       {
-         mStages[i].setTex( MFT_DiffuseMap, _createTexture( mMaterial->mDiffuseMapFilename[i], &GFXDefaultStaticDiffuseProfile ) );
+         mStages[i].setTex( MFT_DiffuseMap, _createStageTexture( i, MFT_DiffuseMap, mMaterial->mDiffuseMapFilename[i], &GFXDefaultStaticDiffuseProfile ) );
          if(!mStages[i].getTex( MFT_DiffuseMap ))
             mMaterial->logError("Failed to load diffuse map %s for stage %i", _getTexturePath(mMaterial->mDiffuseMapFilename[i]).c_str(), i);
       }
       else if( mMaterial->mBaseTexFilename[i].isNotEmpty() )
       {
-         mStages[i].setTex( MFT_DiffuseMap, _createTexture( mMaterial->mBaseTexFilename[i], &GFXDefaultStaticDiffuseProfile ) );
+         mStages[i].setTex( MFT_DiffuseMap, _createStageTexture( i, MFT_DiffuseMap, mMaterial->mBaseTexFilename[i], &GFXDefaultStaticDiffuseProfile ) );
          if(!mStages[i].getTex( MFT_DiffuseMap ))
             mMaterial->logError("Failed to load diffuse map %s for stage %i", _getTexturePath(mMaterial->mBaseTexFilename[i]).c_str(), i);
       }
@@ -323,13 +413,13 @@ void ProcessedMaterial::_setStageData()
       // OverlayMap
       if( mMaterial->mOverlayMapFilename[i].isNotEmpty() )
       {
-         mStages[i].setTex( MFT_OverlayMap, _createTexture( mMaterial->mOverlayMapFilename[i], &GFXDefaultStaticDiffuseProfile ) );
+         mStages[i].setTex( MFT_OverlayMap, _createStageTexture( i, MFT_OverlayMap, mMaterial->mOverlayMapFilename[i], &GFXDefaultStaticDiffuseProfile ) );
          if(!mStages[i].getTex( MFT_OverlayMap ))
             mMaterial->logError("Failed to load overlay map %s for stage %i", _getTexturePath(mMaterial->mOverlayMapFilename[i]).c_str(), i);
       }
       else if( mMaterial->mOverlayTexFilename[i].isNotEmpty() )
       {
-         mStages[i].setTex( MFT_OverlayMap, _createTexture( mMaterial->mOverlayTexFilename[i], &GFXDefaultStaticDiffuseProfile ) );
+         mStages[i].setTex( MFT_OverlayMap, _createStageTexture( i, MFT_OverlayMap, mMaterial->mOverlayTexFilename[i], &GFXDefaultStaticDiffuseProfile ) );
          if(!mStages[i].getTex( MFT_OverlayMap ))
             mMaterial->logError("Failed to load overlay map %s for stage %i", _getTexturePath(mMaterial->mOverlayTexFilename[i]).c_str(), i);
       }
@@ -337,7 +427,7 @@ void ProcessedMaterial::_setStageData()
       // LightMap
       if( mMaterial->mLightMapFilename[i].isNotEmpty() )
       {
-         mStages[i].setTex( MFT_LightMap, _createTexture( mMaterial->mLightMapFilename[i], &GFXDefaultStaticDiffuseProfile ) );
+         mStages[i].setTex( MFT_LightMap, _createStageTexture( i, MFT_LightMap, mMaterial->mLightMapFilename[i], &GFXDefaultStaticDiffuseProfile ) );
          if(!mStages[i].getTex( MFT_LightMap ))
             mMaterial->logError("Failed to load light map %s for stage %i", _getTexturePath(mMaterial->mLightMapFilename[i]).c_str(), i);
       }
@@ -345,7 +435,7 @@ void ProcessedMaterial::_setStageData()
       // ToneMap
       if( mMaterial->mToneMapFilename[i].isNotEmpty() )
       {
-         mStages[i].setTex( MFT_ToneMap, _createTexture( mMaterial->mToneMapFilename[i], &GFXDefaultStaticDiffuseProfile ) );
+         mStages[i].setTex( MFT_ToneMap, _createStageTexture( i, MFT_ToneMap, mMaterial->mToneMapFilename[i], &GFXDefaultStaticDiffuseProfile ) );
          if(!mStages[i].getTex( MFT_ToneMap ))
             mMaterial->logError("Failed to load tone map %s for stage %i", _getTexturePath(mMaterial->mToneMapFilename[i]).c_str(), i);
       }
@@ -353,13 +443,13 @@ void ProcessedMaterial::_setStageData()
       // DetailMap
       if( mMaterial->mDetailMapFilename[i].isNotEmpty() )
       {
-         mStages[i].setTex( MFT_DetailMap, _createTexture( mMaterial->mDetailMapFilename[i], &GFXDefaultStaticDiffuseProfile ) );
+         mStages[i].setTex( MFT_DetailMap, _createStageTexture( i, MFT_DetailMap, mMaterial->mDetailMapFilename[i], &GFXDefaultStaticDiffuseProfile ) );
          if(!mStages[i].getTex( MFT_DetailMap ))
             mMaterial->logError("Failed to load detail map %s for stage %i", _getTexturePath(mMaterial->mDetailMapFilename[i]).c_str(), i);
       }
       else if( mMaterial->mDetailTexFilename[i].isNotEmpty() )
       {
-         mStages[i].setTex( MFT_DetailMap, _createTexture( mMaterial->mDetailTexFilename[i], &GFXDefaultStaticDiffuseProfile ) );
+         mStages[i].setTex( MFT_DetailMap, _createStageTexture( i, MFT_DetailMap, mMaterial->mDetailTexFilename[i], &GFXDefaultStaticDiffuseProfile ) );
          if(!mStages[i].getTex( MFT_DetailMap ))
             mMaterial->logError("Failed to load detail map %s for stage %i", _getTexturePath(mMaterial->mDetailTexFilename[i]).c_str(), i);
       }
@@ -367,18 +457,19 @@ void ProcessedMaterial::_setStageData()
       // NormalMap
       if( mMaterial->mNormalMapFilename[i].isNotEmpty() )
       {
-         mStages[i].setTex( MFT_NormalMap, _createTexture( mMaterial->mNormalMapFilename[i], &GFXDefaultStaticNormalMapProfile ) );
+         mStages[i].setTex( MFT_NormalMap, _createStageTexture( i, MFT_NormalMap, mMaterial->mNormalMapFilename[i], &GFXDefaultStaticNormalMapProfile ) );
          if(!mStages[i].getTex( MFT_NormalMap ))
             mMaterial->logError("Failed to load normal map %s for stage %i", _getTexturePath(mMaterial->mNormalMapFilename[i]).c_str(), i);
       }
       else if( mMaterial->mBumpTexFilename[i].isNotEmpty() )
       {
-         mStages[i].setTex( MFT_NormalMap, _createTexture( mMaterial->mBumpTexFilename[i], &GFXDefaultStaticNormalMapProfile ) );
+         mStages[i].setTex( MFT_NormalMap, _createStageTexture( i, MFT_NormalMap, mMaterial->mBumpTexFilename[i], &GFXDefaultStaticNormalMapProfile ) );
          if(!mStages[i].getTex( MFT_NormalMap ))
             mMaterial->logError("Failed to load normal map %s for stage %i", _getTexturePath(mMaterial->mBumpTexFilename[i]).c_str(), i);
       }
 
-      // SpecularMap
+      // SpecularMap, which isn't loaded in the background as the 
+      // shader checks its alpha channel for a gloss map.
       if( mMaterial->mSpecularMapFilename[i].isNotEmpty() )
       {
          mStages[i].setTex( MFT_SpecularMap, _createTexture( mMaterial->mSpecularMapFilename[i], &GFXDefaultStaticDiffuseProfile ) );
@@ -389,13 +480,13 @@ void ProcessedMaterial::_setStageData()
       // EnironmentMap
       if( mMaterial->mEnvMapFilename[i].isNotEmpty() )
       {
-         mStages[i].setTex( MFT_EnvMap, _createTexture( mMaterial->mEnvMapFilename[i], &GFXDefaultStaticDiffuseProfile ) );
+         mStages[i].setTex( MFT_EnvMap, _createStageTexture( i, MFT_EnvMap, mMaterial->mEnvMapFilename[i], &GFXDefaultStaticDiffuseProfile ) );
          if(!mStages[i].getTex( MFT_EnvMap ))
             mMaterial->logError("Failed to load environment map %s for stage %i", _getTexturePath(mMaterial->mEnvMapFilename[i]).c_str(), i);
       }
       else if( mMaterial->mEnvTexFilename[i].isNotEmpty() )
       {
-         mStages[i].setTex( MFT_EnvMap, _createTexture( mMaterial->mEnvTexFilename[i], &GFXDefaultStaticDiffuseProfile ) );
+         mStages[i].setTex( MFT_EnvMap, _createStageTexture( i, MFT_EnvMap, mMaterial->mEnvTexFilename[i], &GFXDefaultStaticDiffuseProfile ) );
          if(!mStages[i].getTex( MFT_EnvMap ))
             mMaterial->logError("Failed to load environment map %s for stage %i", _getTexturePath(mMaterial->mEnvTexFilename[i]).c_str(), i);
       }
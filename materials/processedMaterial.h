@@ -14,6 +14,9 @@
 #ifndef _MATTEXTURETARGET_H_
 #include "materials/matTextureTarget.h"
 #endif
+#ifndef _RESOURCEMANAGER_H_
+#include "core/resourceManager.h"
+#endif
 
 class ShaderFeature;
 class MaterialParameters;
@@ -123,6 +126,15 @@ public:
                         const GFXVertexFormat *vertexFormat,
                         const MatFeaturesDelegate &featuresDelegate ) = 0;
 
+   /// If set, init() doesn't wait for shaders which need to be compiled.
+   /// They are compiled on the thread pool instead and init() fails with
+   /// isPending() set until they are all done.
+   void setAsyncShaders( bool async ) { mAsyncShaders = async; }
+
+   /// Returns true if the last init() failed because
+   /// shaders are still compiling.
+   bool isPending() const { return mPending; }
+
    /// Sets up the given pass.  Returns true if the pass was set up, false if there was an error or if
    /// the specified pass is out of bounds.
    virtual bool setupPass(SceneState *, const SceneGraphData& sgData, U32 pass) = 0;
@@ -181,6 +193,10 @@ public:
    /// Dump shader info, or FF texture info?
    virtual void dumpMaterialInfo() { }
 
+   /// Passes the screen footprint to the mip streaming of the stage textures.
+   /// @see BaseMatInstance::requestTextureDetail
+   void requestTextureDetail( F32 pixelSize );
+
    /// Returns the source material.
    Material* getMaterial() const { return mMaterial; }
 
@@ -207,6 +223,12 @@ protected:
    /// If we glow
    bool mHasGlow;
 
+   /// @see setAsyncShaders
+   bool mAsyncShaders;
+
+   /// @see isPending
+   bool mPending;
+
    /// Number of stages (not to be confused with number of passes)
    U32 mMaxStages;
 
@@ -224,6 +246,29 @@ protected:
    /// Loads all the textures for all of the stages in the Material
    virtual void _setStageData();
 
+   /// A stage texture whose bitmap is still loading.  The stage
+   /// and the passes use the placeholder until it is done.
+   struct PendingTexture
+   {
+      U32 stage;
+      const FeatureType *type;
+      String filename;
+      GFXTextureProfile *profile;
+      GFXTexHandle placeholder;
+      ResourceLoadRequestRef request;
+   };
+
+   /// @see _createStageTexture
+   Vector<PendingTexture> mPendingTextures;
+
+   /// Returns the texture for a stage.  Plain bitmap files are loaded
+   /// with ResourceManager::loadAsync() and a placeholder is returned
+   /// until the bitmap is loaded.
+   GFXTexHandle _createStageTexture( U32 stage, const FeatureType &type, const String &filename, GFXTextureProfile *profile );
+
+   /// Swaps the textures loaded by the request in for their placeholders.
+   void _onBitmapLoaded( ResourceLoadRequest *request );
+
    /// Sets the blend state for rendering   
    void _setBlendState(Material::BlendOp blendOp, GFXStateBlockDesc& desc );
 
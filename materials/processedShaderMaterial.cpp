@@ -131,6 +131,7 @@ bool ProcessedShaderMaterial::init( const FeatureSet &features,
    mMaxStages = getNumStages(); 
    mVertexFormat = vertexFormat;
    mFeatures.clear();
+   mPending = false;
 
    for( U32 i=0; i<mMaxStages; i++ )
    {
@@ -149,6 +150,10 @@ bool ProcessedShaderMaterial::init( const FeatureSet &features,
             return false;
    }
 
+   // We can't finish until all the shaders are compiled.
+   if ( mPending )
+      return false;
+
    _initRenderPassDataStateBlocks();
    _initMaterialParameters();
    mDefaultParameters =  allocMaterialParameters();
@@ -472,7 +477,18 @@ bool ProcessedShaderMaterial::_addPass( ShaderRenderPassData &rpd,
 
    // Generate shader
    GFXShader::setLogging( true, true );
-   rpd.shader = SHADERGEN->getShader( rpd.mFeatureData, mVertexFormat, &mUserMacros );
+   bool pending = false;
+   rpd.shader = SHADERGEN->getShader( rpd.mFeatureData, mVertexFormat, &mUserMacros, mAsyncShaders ? &pending : NULL );
+   if ( pending )
+   {
+      // Keep going so that the shaders of 
+      // the other passes get queued too.
+      mPending = true;
+      rpd.reset();
+      texIndex = 0;
+      return true;
+   }
+
    if( !rpd.shader )
       return false;
    rpd.shaderHandles.init( rpd.shader );   
@@ -42,6 +42,14 @@ struct SceneGraphData
    F32 fogHeightFalloff;
    ColorF fogColor;
 
+   enum
+   {
+      /// The most bone transforms which can be passed
+      /// to the hardware skinning feature.
+      /// @see MFT_HardwareSkinning
+      MaxBoneTransforms = 48,
+   };
+
    /// The special bin types.
    enum BinType
    {
@@ -77,6 +85,13 @@ struct SceneGraphData
    /// features.
    void *materialHint;
 
+   /// The bone palette for hardware skinning or NULL
+   /// if the vertices are already in object space.
+   const MatrixF *boneTransforms;
+
+   /// The number of matrices in boneTransforms.
+   U32 boneCount;
+
    //-----------------------------------------------------------------------
    // Constructor
    //-----------------------------------------------------------------------
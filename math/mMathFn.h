@@ -78,6 +78,18 @@ extern U32 (*mSolveQuartic)(F32 a, F32 b, F32 c, F32 d, F32 e, F32* x);
 // Note that the plane list provided MUST match the one in Frustum
 extern bool (*m_planeF_intersect_box3F)(const F32 *planes, const F32 *bounds);
 
+/// Culls a structure of arrays bounds list against several frustums at once.
+///
+/// @param planes       Frustum::PlaneCount planes (x, y, z, d) per frustum.
+/// @param numFrustums  The number of frustums, at most 32.
+/// @param bounds       Ten 16 byte aligned streams of count floats: the box
+///                     min x, y, z, the box max x, y, z, then the sphere
+///                     center x, y, z and radius.
+/// @param count        The number of entries, which must be a multiple of 4.
+/// @param outMasks     Receives a mask per entry with bit f set if the entry
+///                     is inside frustum f.
+extern void (*m_planeF_cull_SoA)(const F32 *planes, const U32 numFrustums, const F32 *const *bounds, const U32 count, U32 *outMasks);
+
 extern S32 mRandI(S32 i1, S32 i2); // random # from i1 to i2 inclusive
 extern F32 mRandF(F32 f1, F32 f2); // random # from f1 to f2 inclusive
 extern F32 mRandF();               // random # from 0.0 to 1.0 inclusive
@@ -6,6 +6,11 @@
 #include "math/mMathFn.h"
 #include "math/mPlane.h"
 #include "math/mMatrix.h"
+#include "math/util/frustum.h"
+
+#if defined(TORQUE_CPU_X86)
+#include <xmmintrin.h>
+#endif
 
 
 #if defined(TORQUE_SUPPORTS_VC_INLINE_X86_ASM)
@@ -354,6 +359,91 @@ void SSE_MatrixF_x_MatrixF_Aligned(const F32 *matA, const F32 *matB, F32 *result
 
 #endif
 
+#if defined(TORQUE_CPU_X86)
+
+/// Four entries per iteration.  The box vertex to test is picked from the
+/// plane normal signs once per plane, so the loop is straight mul/add/cmp
+/// and only needs SSE1.
+void SSE_PlaneF_Cull_SoA(const F32 *planes, const U32 numFrustums, const F32 *const *bounds, const U32 count, U32 *outMasks)
+{
+   AssertFatal( ( count & 3 ) == 0, "SSE_PlaneF_Cull_SoA - The count must be a multiple of 4!" );
+   AssertFatal( numFrustums <= 32, "SSE_PlaneF_Cull_SoA - Too many frustums!" );
+
+   const U32 numPlanes = numFrustums * Frustum::PlaneCount;
+
+   // Splat the planes and the box vertex selects up front.
+   __m128 splat[ 32 * Frustum::PlaneCount * 7 ];
+   for ( U32 p = 0; p < numPlanes; p++ )
+   {
+      const F32 *pl = planes + p * 4;
+      __m128 *s = splat + p * 7;
+
+      s[0] = _mm_set1_ps( pl[0] );
+      s[1] = _mm_set1_ps( pl[1] );
+      s[2] = _mm_set1_ps( pl[2] );
+      s[3] = _mm_set1_ps( pl[3] );
+      s[4] = _mm_cmpgt_ps( s[0], _mm_setzero_ps() );
+      s[5] = _mm_cmpgt_ps( s[1], _mm_setzero_ps() );
+      s[6] = _mm_cmpgt_ps( s[2], _mm_setzero_ps() );
+   }
+
+   U32 frustumBits[ 32 * 4 ];
+   for ( U32 f = 0; f < numFrustums; f++ )
+      frustumBits[ f * 4 ] = frustumBits[ f * 4 + 1 ] = frustumBits[ f * 4 + 2 ] = frustumBits[ f * 4 + 3 ] = 1 << f;
+
+   const __m128 zero = _mm_setzero_ps();
+
+   for ( U32 i = 0; i < count; i += 4 )
+   {
+      const __m128 minX = _mm_load_ps( bounds[0] + i );
+      const __m128 minY = _mm_load_ps( bounds[1] + i );
+      const __m128 minZ = _mm_load_ps( bounds[2] + i );
+      const __m128 maxX = _mm_load_ps( bounds[3] + i );
+      const __m128 maxY = _mm_load_ps( bounds[4] + i );
+      const __m128 maxZ = _mm_load_ps( bounds[5] + i );
+      const __m128 cX = _mm_load_ps( bounds[6] + i );
+      const __m128 cY = _mm_load_ps( bounds[7] + i );
+      const __m128 cZ = _mm_load_ps( bounds[8] + i );
+      const __m128 negRadius = _mm_sub_ps( zero, _mm_load_ps( bounds[9] + i ) );
+
+      __m128 mask = zero;
+
+      const __m128 *s = splat;
+      for ( U32 f = 0; f < numFrustums; f++ )
+      {
+         __m128 inside = _mm_cmpeq_ps( zero, zero );
+
+         for ( U32 p = 0; p < Frustum::PlaneCount; p++, s += 7 )
+         {
+            const __m128 bx = _mm_or_ps( _mm_and_ps( s[4], maxX ), _mm_andnot_ps( s[4], minX ) );
+            const __m128 by = _mm_or_ps( _mm_and_ps( s[5], maxY ), _mm_andnot_ps( s[5], minY ) );
+            const __m128 bz = _mm_or_ps( _mm_and_ps( s[6], maxZ ), _mm_andnot_ps( s[6], minZ ) );
+
+            __m128 boxDot = _mm_add_ps( _mm_add_ps( _mm_mul_ps( s[0], bx ), _mm_mul_ps( s[1], by ) ), 
+                                        _mm_add_ps( _mm_mul_ps( s[2], bz ), s[3] ) );
+            __m128 sphereDot = _mm_add_ps( _mm_add_ps( _mm_mul_ps( s[0], cX ), _mm_mul_ps( s[1], cY ) ), 
+                                           _mm_add_ps( _mm_mul_ps( s[2], cZ ), s[3] ) );
+
+            inside = _mm_and_ps( inside, _mm_cmpgt_ps( boxDot, zero ) );
+            inside = _mm_and_ps( inside, _mm_cmpge_ps( sphereDot, negRadius ) );
+
+            // All four are out of this frustum.
+            if ( _mm_movemask_ps( inside ) == 0 )
+            {
+               s += 7 * ( Frustum::PlaneCount - p );
+               break;
+            }
+         }
+
+         mask = _mm_or_ps( mask, _mm_and_ps( inside, _mm_loadu_ps( reinterpret_cast<const F32*>( frustumBits + f * 4 ) ) ) );
+      }
+
+      _mm_storeu_ps( reinterpret_cast<F32*>( outMasks + i ), mask );
+   }
+}
+
+#endif
+
 void mInstall_Library_SSE()
 {
 #if defined(ADD_SSE_FN)
@@ -362,4 +452,8 @@ void mInstall_Library_SSE()
    // m_matF_x_point3F = Athlon_MatrixF_x_Point3F;
    // m_matF_x_vectorF = Athlon_MatrixF_x_VectorF;
 #endif
+
+#if defined(TORQUE_CPU_X86)
+   m_planeF_cull_SoA       = SSE_PlaneF_Cull_SoA;
+#endif
 }
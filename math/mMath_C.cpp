@@ -859,6 +859,43 @@ bool m_planeF_intersect_box3F_C(const F32 *planes, const F32 *box)
    return true;
 }
 
+void m_planeF_cull_SoA_C(const F32 *planes, const U32 numFrustums, const F32 *const *bounds, const U32 count, U32 *outMasks)
+{
+   const F32 *minX = bounds[0], *minY = bounds[1], *minZ = bounds[2];
+   const F32 *maxX = bounds[3], *maxY = bounds[4], *maxZ = bounds[5];
+   const F32 *cX = bounds[6], *cY = bounds[7], *cZ = bounds[8], *radius = bounds[9];
+
+   for ( U32 i = 0; i < count; i++ )
+   {
+      U32 mask = 0;
+
+      const F32 *plane = planes;
+      for ( U32 f = 0; f < numFrustums; f++, plane += Frustum::PlaneCount * 4 )
+      {
+         bool inside = true;
+         for ( U32 p = 0; inside && p < Frustum::PlaneCount; p++ )
+         {
+            const F32 *pl = plane + p * 4;
+
+            // Same tests as m_planeF_intersect_box3F and
+            // Frustum::sphereInFrustum.
+            F32 boxDot =   pl[0] * ( pl[0] > 0.0f ? maxX[i] : minX[i] ) +
+                           pl[1] * ( pl[1] > 0.0f ? maxY[i] : minY[i] ) +
+                           pl[2] * ( pl[2] > 0.0f ? maxZ[i] : minZ[i] );
+
+            F32 sphereDot = pl[0] * cX[i] + pl[1] * cY[i] + pl[2] * cZ[i] + pl[3];
+
+            inside = boxDot > -pl[3] && sphereDot >= -radius[i];
+         }
+
+         if ( inside )
+            mask |= 1 << f;
+      }
+
+      outMasks[i] = mask;
+   }
+}
+
 //------------------------------------------------------------------------------
 // Math function pointer declarations
 
@@ -911,6 +948,7 @@ void (*m_matF_x_point4F)(const F32 *m, const F32 *p, F32 *presult) = m_matF_x_po
 void (*m_matF_x_scale_x_planeF)(const F32 *m, const F32* s, const F32 *p, F32 *presult) = m_matF_x_scale_x_planeF_C;
 void (*m_matF_x_box3F)(const F32 *m, F32 *min, F32 *max)    = m_matF_x_box3F_C;
 bool (*m_planeF_intersect_box3F)(const F32 *planes, const F32 *bounds) = m_planeF_intersect_box3F_C;
+void (*m_planeF_cull_SoA)(const F32 *planes, const U32 numFrustums, const F32 *const *bounds, const U32 count, U32 *outMasks) = m_planeF_cull_SoA_C;
 
 //------------------------------------------------------------------------------
 void mInstallLibrary_C()
@@ -954,5 +992,6 @@ void mInstallLibrary_C()
    m_matF_x_scale_x_planeF = m_matF_x_scale_x_planeF_C;
    m_matF_x_box3F          = m_matF_x_box3F_C;
    m_planeF_intersect_box3F = m_planeF_intersect_box3F_C;
+   m_planeF_cull_SoA       = m_planeF_cull_SoA_C;
 }
 
@@ -164,6 +164,14 @@ namespace Platform
    /// @see PlatformTimer
    U32 getRealMilliseconds();
 
+   /// Returns the current value of the highest resolution monotonic counter
+   /// available on the platform.  Use getPerformanceCounterFrequency() to
+   /// convert counter deltas to seconds.
+   U64 getPerformanceCounter();
+
+   /// Returns the number of getPerformanceCounter() ticks per second.
+   U64 getPerformanceCounterFrequency();
+
    void advanceTime(U32 delta);
    S32 getBackgroundSleepTime();
 
@@ -262,6 +270,19 @@ namespace Platform
    bool getFileTimes(const char *filePath, FileTime *createTime, FileTime *modifyTime);
    bool isFile(const char *pFilePath);
    S32  getFileSize(const char *pFilePath);
+
+   /// Map a file read-only into the address space of the process.
+   ///
+   /// @param pFilePath  Native path of the file to map.
+   /// @param outData    Receives the start of the mapped view.
+   /// @param outSize    Receives the size of the mapped view in bytes.
+   /// @return An opaque handle to hand back to unmapFile(), or NULL if
+   ///   the file could not be mapped (missing, empty, or unsupported).
+   void* mapFile(const char *pFilePath, const void *&outData, U32 &outSize);
+
+   /// Release a mapping returned by mapFile().
+   void  unmapFile(void *handle);
+
    bool isDirectory(const char *pDirPath);
    bool isSubDirectory(const char *pParent, const char *pDir);
 
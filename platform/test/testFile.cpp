@@ -87,6 +87,35 @@ CreateUnitTest(CheckFileTouchAndTime, "File/TouchAndTime")
    }
 };
 
+CreateUnitTest(CheckFileMapping, "File/Mapping")
+{
+   void run()
+   {
+      const char data[] = "Mapped file contents.";
+
+      File f;
+      f.open("testMapping.file", File::Write);
+      f.write(sizeof(data), data);
+      f.close();
+
+      const void *mapped;
+      U32 size;
+      void *handle = Platform::mapFile("testMapping.file", mapped, size);
+      test(handle != NULL, "Failed to map a file we just wrote.");
+      if(handle)
+      {
+         test(size == sizeof(data), "Mapped size doesn't match the file size.");
+         test(dMemcmp(mapped, data, sizeof(data)) == 0, "Mapped contents don't match what we wrote.");
+         Platform::unmapFile(handle);
+      }
+
+      test(Platform::mapFile("testMapping.doesNotExist", mapped, size) == NULL, "Mapping a missing file should fail.");
+      test(mapped == NULL && size == 0, "Failed mapping should clear the outputs.");
+
+      dFileDelete("testMapping.file");
+   }
+};
+
 // Mac has no implementations for these functions, so we 'def it out for now.
 #if 0
 CreateUnitTest(CheckVolumes, "File/Volumes")
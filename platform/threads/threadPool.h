@@ -353,6 +353,12 @@ class ThreadPool
          return smForceAllMainThread;
       }
 
+      /// Return the number of worker threads spawned by the pool.
+      U32 getNumThreads() const
+      {
+         return mNumThreads;
+      }
+
       /// Return the global thread pool singleton.
       static ThreadPool& GLOBAL()
       {
@@ -13,6 +13,9 @@ extern void mInstallLibrary_C();
 extern void mInstallLibrary_Vec();
 extern void mInstall_Library_SSE();
 
+extern void bitmapInstallLibrary_C();
+extern void bitmapInstallLibrary_SSE2();
+
 static MRandomLCG sgPlatRandom;
 
 U32 Platform::getMathControlState()
@@ -79,6 +82,7 @@ void Math::init(U32 properties)
    Con::printf("Math Init:");
    Con::printf("   Installing Standard C extensions");
    mInstallLibrary_C();
+   bitmapInstallLibrary_C();
    
    #if defined(__VEC__)
    if (properties & CPU_PROP_ALTIVEC)
@@ -93,6 +97,11 @@ void Math::init(U32 properties)
       Con::printf( "   Installing SSE extensions" );
       mInstall_Library_SSE();
    }
+   if( properties & CPU_PROP_SSE2 )
+   {
+      Con::printf( "   Installing SSE2 bitmap extensions" );
+      bitmapInstallLibrary_SSE2();
+   }
    #endif
    
    Con::printf(" ");
@@ -77,6 +77,18 @@ U32 Platform::getRealMilliseconds()
    return ret;
 }   
 
+U64 Platform::getPerformanceCounter()
+{
+   UnsignedWide t;
+   Microseconds( &t );
+   return ( U64( t.hi ) << 32 ) | t.lo;
+}
+
+U64 Platform::getPerformanceCounterFrequency()
+{
+   return 1000000;
+}
+
 U32 Platform::getVirtualMilliseconds()
 {
    return sgCurrentTime;   
@@ -979,6 +979,80 @@ S32 Platform::getFileSize(const char *pFilePath)
    return findData.nFileSizeLow;
 }
 
+//--------------------------------------
+struct WinFileMapping
+{
+   HANDLE   file;
+   HANDLE   mapping;
+   void*    view;
+};
+
+void* Platform::mapFile(const char *pFilePath, const void *&outData, U32 &outSize)
+{
+   outData = NULL;
+   outSize = 0;
+
+   if (!pFilePath || !*pFilePath)
+      return NULL;
+
+   TempAlloc< TCHAR > buf( dStrlen( pFilePath ) + 1 );
+
+#ifdef UNICODE
+   convertUTF8toUTF16( pFilePath, buf, buf.size );
+#else
+   dStrcpy( buf, pFilePath );
+#endif
+   backslash( buf );
+
+   HANDLE file = CreateFile(buf, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+   if (file == INVALID_HANDLE_VALUE)
+      return NULL;
+
+   DWORD size = GetFileSize(file, NULL);
+   if (size == 0 || size == INVALID_FILE_SIZE)
+   {
+      CloseHandle(file);
+      return NULL;
+   }
+
+   HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+   if (!mapping)
+   {
+      CloseHandle(file);
+      return NULL;
+   }
+
+   void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+   if (!view)
+   {
+      CloseHandle(mapping);
+      CloseHandle(file);
+      return NULL;
+   }
+
+   WinFileMapping *handle = new WinFileMapping;
+   handle->file = file;
+   handle->mapping = mapping;
+   handle->view = view;
+
+   outData = view;
+   outSize = size;
+   return handle;
+}
+
+//--------------------------------------
+void Platform::unmapFile(void *handle)
+{
+   if (!handle)
+      return;
+
+   WinFileMapping *mapping = (WinFileMapping*)handle;
+   UnmapViewOfFile(mapping->view);
+   CloseHandle(mapping->mapping);
+   CloseHandle(mapping->file);
+   delete mapping;
+}
+
 
 //--------------------------------------
 bool Platform::isDirectory(const char *pDirPath)
@@ -14,6 +14,9 @@ extern void mInstallLibrary_ASM();
 extern void mInstall_AMD_Math();
 extern void mInstall_Library_SSE();
 
+extern void bitmapInstallLibrary_C();
+extern void bitmapInstallLibrary_SSE2();
+
 //--------------------------------------
 ConsoleFunction( mathInit, void, 1, 10, "( ... )"
                 "Install the math library with specified extensions.\n\n"
@@ -80,6 +83,7 @@ void Math::init(U32 properties)
    Con::printf("Math Init:");
    Con::printf("   Installing Standard C extensions");
    mInstallLibrary_C();
+   bitmapInstallLibrary_C();
 
    Con::printf("   Installing Assembly extensions");
    mInstallLibrary_ASM();
@@ -105,6 +109,12 @@ void Math::init(U32 properties)
       mInstall_Library_SSE();
    }
 
+   if (properties & CPU_PROP_SSE2)
+   {
+      Con::printf("   Installing SSE2 bitmap extensions");
+      bitmapInstallLibrary_SSE2();
+   }
+
    Con::printf(" ");
 }
 
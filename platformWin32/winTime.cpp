@@ -139,6 +139,20 @@ U32 Platform::getRealMilliseconds()
    return GetTickCount();
 }
 
+U64 Platform::getPerformanceCounter()
+{
+   LARGE_INTEGER counter;
+   QueryPerformanceCounter( &counter );
+   return counter.QuadPart;
+}
+
+U64 Platform::getPerformanceCounterFrequency()
+{
+   LARGE_INTEGER frequency;
+   QueryPerformanceFrequency( &frequency );
+   return frequency.QuadPart;
+}
+
 U32 Platform::getVirtualMilliseconds()
 {
    return winState.currentTime;
@@ -51,6 +51,7 @@
  #include <sys/stat.h>
  #include <unistd.h>
  #include <fcntl.h>
+ #include <sys/mman.h>
  #include <errno.h>
  #include <stdlib.h>
 
@@ -985,6 +986,61 @@ bool dPathCopy(const char *fromName, const char *toName, bool nooverwrite)
    return -1;
  }
 
+ //-----------------------------------------------------------------------------
+ struct PosixFileMapping
+ {
+    void*    addr;
+    size_t   size;
+ };
+
+ void* Platform::mapFile(const char *pFilePath, const void *&outData, U32 &outSize)
+ {
+    outData = NULL;
+    outSize = 0;
+
+    if (!pFilePath || !*pFilePath)
+       return NULL;
+
+    int fd = open(pFilePath, O_RDONLY);
+    if (fd < 0)
+       return NULL;
+
+    struct stat fStat;
+    if (fstat(fd, &fStat) < 0 || (fStat.st_mode & S_IFMT) != S_IFREG || fStat.st_size == 0)
+    {
+       close(fd);
+       return NULL;
+    }
+
+    void *addr = mmap(NULL, fStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping holds its own reference to the file.
+    close(fd);
+
+    if (addr == MAP_FAILED)
+       return NULL;
+
+    PosixFileMapping *mapping = new PosixFileMapping;
+    mapping->addr = addr;
+    mapping->size = fStat.st_size;
+
+    outData = addr;
+    outSize = (U32)fStat.st_size;
+    return mapping;
+ }
+
+ //-----------------------------------------------------------------------------
+ void Platform::unmapFile(void *handle)
+ {
+    if (!handle)
+       return;
+
+    PosixFileMapping *mapping = (PosixFileMapping*)handle;
+    munmap(mapping->addr, mapping->size);
+    delete mapping;
+ }
+
+
  //-----------------------------------------------------------------------------
  bool Platform::isDirectory(const char *pDirPath)
  {
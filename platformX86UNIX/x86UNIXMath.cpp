@@ -16,6 +16,9 @@ extern void mInstallLibrary_ASM();
 extern void mInstall_AMD_Math();
 extern void mInstall_Library_SSE();
 
+extern void bitmapInstallLibrary_C();
+extern void bitmapInstallLibrary_SSE2();
+
 
 //--------------------------------------
 ConsoleFunction( MathInit, void, 1, 10, "(detect|C|FPU|MMX|3DNOW|SSE|...)")
@@ -73,6 +76,7 @@ void Math::init(U32 properties)
    Con::printf("Math Init:");
    Con::printf("   Installing Standard C extensions");
    mInstallLibrary_C();
+   bitmapInstallLibrary_C();
 
    Con::printf("   Installing Assembly extensions");
    mInstallLibrary_ASM();
@@ -98,6 +102,12 @@ void Math::init(U32 properties)
       Con::printf("   Installing SSE extensions");
       mInstall_Library_SSE();
    }
+
+   if (properties & CPU_PROP_SSE2)
+   {
+      Con::printf("   Installing SSE2 bitmap extensions");
+      bitmapInstallLibrary_SSE2();
+   }
 #endif //mwerks>2.4
 
    Con::printf(" ");
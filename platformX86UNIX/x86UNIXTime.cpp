@@ -68,6 +68,20 @@ U32 Platform::getRealMilliseconds()
    return x86UNIXGetTickCount();
 }
 
+U64 Platform::getPerformanceCounter()
+{
+   // CLOCK_MONOTONIC isn't affected by changes to the system time,
+   // unlike gettimeofday.
+   struct timespec t;
+   clock_gettime( CLOCK_MONOTONIC, &t );
+   return U64( t.tv_sec ) * 1000000000 + t.tv_nsec;
+}
+
+U64 Platform::getPerformanceCounterFrequency()
+{
+   return 1000000000;
+}
+
 U32 Platform::getVirtualMilliseconds()
 {
    return sgCurrentTime;
@@ -115,24 +129,22 @@ static U32 sg_secsOffset  = 0;
 //--------------------------------------
 U32 x86UNIXGetTickCount()
 {
-   // TODO: What happens when crossing a day boundary?
-   //
-   timeval t;
+   timespec t;
 
    if (sg_initialized == false) {
       sg_initialized = true;
 
-      gettimeofday(&t, NULL);
+      clock_gettime(CLOCK_MONOTONIC, &t);
       sg_secsOffset = t.tv_sec;
    }
 
-   gettimeofday(&t, NULL);
+   clock_gettime(CLOCK_MONOTONIC, &t);
 
    U32 secs  = t.tv_sec - sg_secsOffset;
-   U32 uSecs = t.tv_usec;
+   U32 nSecs = t.tv_nsec;
 
    // Make granularity 1 ms
-   return (secs * 1000) + (uSecs / 1000);
+   return (secs * 1000) + (nSecs / 1000000);
 }
 
 
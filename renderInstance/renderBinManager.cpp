@@ -10,6 +10,17 @@
 
 IMPLEMENT_CONOBJECT(RenderBinManager);
 
+static const EnumTable::Enums gSortOrderEnums[] =
+{
+   { RenderBinManager::SortKeys, "Keys" },
+   { RenderBinManager::SortMaterialMajor, "MaterialMajor" },
+   { RenderBinManager::SortFrontToBack, "FrontToBack" },
+};
+
+static const EnumTable gSortOrderTable(
+   sizeof( gSortOrderEnums ) / sizeof( EnumTable::Enums ),
+   gSortOrderEnums );
+
 //-----------------------------------------------------------------------------
 // RenderBinManager
 //-----------------------------------------------------------------------------
@@ -17,20 +28,24 @@ RenderBinManager::RenderBinManager()
 {
    VECTOR_SET_ASSOCIATION( mElementList );
    mElementList.reserve( 2048 );
+   VECTOR_SET_ASSOCIATION( mSortScratch );
    mRenderInstType = RenderPassManager::RIT_Custom;
    mRenderOrder = 1.0f;
    mProcessAddOrder = 1.0f;
    mParentManager = NULL;
+   mSortOrder = SortKeys;
 }
 
 RenderBinManager::RenderBinManager(const RenderInstType& ritype, F32 renderOrder, F32 processAddOrder)
 {
    VECTOR_SET_ASSOCIATION( mElementList );
    mElementList.reserve( 2048 );
+   VECTOR_SET_ASSOCIATION( mSortScratch );
    mRenderInstType = ritype;
    mRenderOrder = renderOrder;
    mProcessAddOrder = processAddOrder;
    mParentManager = NULL;
+   mSortOrder = SortKeys;
 }
 
 void RenderBinManager::initPersistFields()
@@ -38,6 +53,7 @@ void RenderBinManager::initPersistFields()
    addField("binType", TypeRealString, Offset(mRenderInstType.mName, RenderBinManager));
    addField("renderOrder", TypeF32, Offset(mRenderOrder, RenderBinManager));
    addField("processAddOrder", TypeF32, Offset(mProcessAddOrder, RenderBinManager));
+   addField("sortOrder", TypeEnum, Offset(mSortOrder, RenderBinManager), 1, &gSortOrderTable);
 
    Parent::initPersistFields();
 }
@@ -89,7 +105,113 @@ void RenderBinManager::clear()
 //-----------------------------------------------------------------------------
 void RenderBinManager::sort()
 {
-   dQsort( mElementList.address(), mElementList.size(), sizeof(MainSortElem), cmpKeyFunc);
+   PROFILE_SCOPE( RenderBinManager_sort );
+
+   const U32 count = mElementList.size();
+   if ( count < 2 )
+      return;
+
+   // Generate the keys while checking if the elements were
+   // added in order... which is common for coherent scenes.
+   bool isSorted = true;
+   U64 lastKey = 0;
+   for ( U32 i=0; i < count; i++ )
+   {
+      MainSortElem &elem = mElementList[i];
+      elem.sortKey = getSortKey( elem );
+      isSorted &= elem.sortKey >= lastKey;
+      lastKey = elem.sortKey;
+   }
+
+   if ( isSorted )
+      return;
+
+   mSortScratch.setSize( count );
+   radixSort( mElementList.address(), mSortScratch.address(), count );
+}
+
+void RenderBinManager::radixSort( MainSortElem *elems, MainSortElem *scratch, U32 count )
+{
+   // Gather the histograms for all 8 bytes in one pass.
+   U32 counts[8][256];
+   dMemset( counts, 0, sizeof( counts ) );
+   for ( U32 i=0; i < count; i++ )
+   {
+      U64 key = elems[i].sortKey;
+      for ( U32 b=0; b < 8; b++, key >>= 8 )
+         counts[b][ key & 0xFF ]++;
+   }
+
+   MainSortElem *src = elems;
+   MainSortElem *dst = scratch;
+
+   for ( U32 b=0; b < 8; b++ )
+   {
+      U32 *bucket = counts[b];
+      const U32 shift = b * 8;
+
+      // Skip the pass if every key has the same byte... the
+      // pointer hashes rarely use all the upper bytes.
+      if ( bucket[ ( src[0].sortKey >> shift ) & 0xFF ] == count )
+         continue;
+
+      // Turn the counts into offsets.
+      U32 offset = 0;
+      for ( U32 i=0; i < 256; i++ )
+      {
+         const U32 num = bucket[i];
+         bucket[i] = offset;
+         offset += num;
+      }
+
+      for ( U32 i=0; i < count; i++ )
+         dst[ bucket[ ( src[i].sortKey >> shift ) & 0xFF ]++ ] = src[i];
+
+      MainSortElem *temp = src;
+      src = dst;
+      dst = temp;
+   }
+
+   if ( src != elems )
+      dMemcpy( elems, src, sizeof( MainSortElem ) * count );
+}
+
+/// Reduces a pointer or key to the given number of bits.  Collisions
+/// only cost a state change, so a multiplicative hash is good enough.
+static inline U64 _hashKeyBits( U32 key, U32 bits )
+{
+   return ( key * 2654435761U ) >> ( 32 - bits );
+}
+
+U64 RenderBinManager::getSortKey( const MainSortElem &elem ) const
+{
+   if ( mSortOrder == SortKeys )
+   {
+      // Flipping the sign bit gives the same order as the signed
+      // compare in cmpKeyFunc... inverting key makes it descending.
+      const U32 major = ~( elem.key ^ 0x80000000 );
+      const U32 minor = elem.key2 ^ 0x80000000;
+      return ( U64( major ) << 32 ) | minor;
+   }
+
+   RenderInst *inst = elem.inst;
+
+   // Positive floats sort correctly as integers, so the upper
+   // bits of the distance are a cheap logarithmic depth.
+   const U64 depth = ( *((U32*)&inst->sortDistSq) >> 15 ) & 0xFFFF;
+
+   U64 lightmap = 0;
+   if ( getMaterial( inst ) )
+      lightmap = _hashKeyBits( (U32)static_cast<MeshRenderInst*>( inst )->lightmap, 8 );
+
+   const U64 state = ( _hashKeyBits( elem.key, 24 ) << 24 ) | 
+                     ( _hashKeyBits( elem.key2, 16 ) << 8 ) | 
+                     lightmap;
+
+   if ( mSortOrder == SortFrontToBack )
+      return ( depth << 48 ) | state;
+
+   return ( state << 16 ) | depth;
 }
 
 //-----------------------------------------------------------------------------
@@ -124,6 +246,9 @@ void RenderBinManager::setupSGData( MeshRenderInst *ri, SceneGraphData &data )
    data.visibility = ri->visibility;
 
    data.materialHint = ri->materialHint;
+
+   data.boneTransforms = ri->boneTransforms;
+   data.boneCount = ri->boneCount;
 }
 
 ConsoleMethod(RenderBinManager, getBinType, const char*, 2, 2, "Returns the type of manager.")
@@ -37,6 +37,28 @@ public:
       RenderInst *inst;
       U32 key;
       U32 key2;
+
+      /// The packed key the bin is sorted on which
+      /// is generated from the others in sort().
+      /// @see getSortKey
+      U64 sortKey;
+   };
+
+   /// The criteria packed into the 64bit sort key.
+   /// @see getSortKey
+   enum SortOrder
+   {
+      /// Sorts on key descending then key2 ascending which
+      /// is what bins that override the keys expect.
+      SortKeys,
+
+      /// Sorts on material, vertex buffer and lightmap 
+      /// to minimize state changes then front to back.
+      SortMaterialMajor,
+
+      /// Sorts front to back first then by material, vertex
+      /// buffer and lightmap to maximize early z rejection.
+      SortFrontToBack,
    };
 
    // Returned by AddInst below
@@ -71,6 +93,13 @@ public:
    /// QSort callback function
    static S32 FN_CDECL cmpKeyFunc(const void* p1, const void* p2);
 
+   /// Sorts the elements by sortKey with an LSD radix sort.  The
+   /// scratch buffer must hold count elements.
+   static void radixSort( MainSortElem *elems, MainSortElem *scratch, U32 count );
+
+   SortOrder getSortOrder() const { return mSortOrder; }
+   void setSortOrder( SortOrder order ) { mSortOrder = order; }
+
    DECLARE_CONOBJECT(RenderBinManager);
    static void initPersistFields();
 
@@ -85,6 +114,16 @@ protected:
 
    MaterialOverrideDelegate mMatOverrideDelegate;
 
+   /// The criteria the elements are sorted on.
+   SortOrder mSortOrder;
+
+   /// The scratch buffer used by the radix sort.
+   Vector< MainSortElem > mSortScratch;
+
+   /// Packs the sort criteria of the element into a single
+   /// key based on the sort order of this bin.
+   virtual U64 getSortKey( const MainSortElem &elem ) const;
+
    virtual void setupSGData(MeshRenderInst *ri, SceneGraphData &data );
    virtual bool newPassNeeded(BaseMatInstance* currMatInst, MeshRenderInst* ri);
    BaseMatInstance* getMaterial(RenderInst* inst) const;
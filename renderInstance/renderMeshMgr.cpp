@@ -15,20 +15,85 @@
 #include "sceneGraph/sceneState.h"
 #include "gfx/gfxDebugEvent.h"
 #include "math/util/matrixSet.h"
+#include "materials/materialFeatureTypes.h"
+#include "materials/baseMaterialDefinition.h"
+#include "core/util/safeDelete.h"
 
 //**************************************************************************
 // RenderMeshMgr
 //**************************************************************************
 IMPLEMENT_CONOBJECT(RenderMeshMgr);
 
+const MatInstanceHookType RenderMeshMgr::InstancingMaterialHook::Type( "Instancing" );
+
+RenderMeshMgr::InstancingMaterialHook::InstancingMaterialHook( BaseMatInstance *matInst )
+   :  mInstancingMatInst( NULL ),
+      mChecked( false )
+{
+   // Append the instance stream to the vertex format so 
+   // that the shader declares the transform inputs.
+   mInstancingFormat = *matInst->getVertexFormat();
+   const GFXVertexFormat *instFormat = getGFXVertexFormat<GFXVertexInstanceTransform>();
+   for ( U32 i=0; i < instFormat->getElementCount(); i++ )
+   {
+      const GFXVertexElement &element = instFormat->getElement( i );
+      mInstancingFormat.addElement( element.getSemantic(), element.getType(), element.getSemanticIndex() );
+   }
+
+   FeatureSet features( matInst->getRequestedFeatures() );
+   features.addFeature( MFT_UseInstancing );
+
+   mInstancingMatInst = matInst->getMaterial()->createMatInstance();
+   mInstancingMatInst->init( features, &mInstancingFormat );
+
+   if ( !mInstancingMatInst->isValid() )
+      SAFE_DELETE( mInstancingMatInst );
+}
+
+BaseMatInstance* RenderMeshMgr::InstancingMaterialHook::getMatInstance()
+{
+   if ( !mChecked && mInstancingMatInst )
+   {
+      // The placeholder has none of the requested features, 
+      // so wait for the real material before checking them.
+      if ( mInstancingMatInst->isPending() )
+         return NULL;
+
+      // Only batch with a material whose shader does the instancing,
+      // otherwise every instance would draw with the first transform.
+      if ( !mInstancingMatInst->getFeatures()[ MFT_UseInstancing ] )
+         SAFE_DELETE( mInstancingMatInst );
+
+      mChecked = true;
+   }
+
+   return mInstancingMatInst;
+}
+
+RenderMeshMgr::InstancingMaterialHook::~InstancingMaterialHook()
+{
+   SAFE_DELETE( mInstancingMatInst );
+}
+
 RenderMeshMgr::RenderMeshMgr()
 : RenderBinManager(RenderPassManager::RIT_Mesh, 1.0f, 1.0f)
 {
+   construct();
 }
 
 RenderMeshMgr::RenderMeshMgr(RenderInstType riType, F32 renderOrder, F32 processAddOrder)
    : RenderBinManager(riType, renderOrder, processAddOrder)
 {
+   construct();
+}
+
+void RenderMeshMgr::construct()
+{
+   // Keep state changes to a minimum.
+   mSortOrder = SortMaterialMajor;
+
+   mEnableInstancing = false;
+   mInstancingMinBatch = 4;
 }
 
 void RenderMeshMgr::init()
@@ -48,6 +113,9 @@ void RenderMeshMgr::init()
 
 void RenderMeshMgr::initPersistFields()
 {
+   addField("enableInstancing", TypeBool, Offset(mEnableInstancing, RenderMeshMgr));
+   addField("instancingMinBatch", TypeS32, Offset(mInstancingMinBatch, RenderMeshMgr));
+
    Parent::initPersistFields();
 }
 
@@ -153,6 +221,21 @@ void RenderMeshMgr::render(SceneState * state)
       if( !mat )
          mat = MATMGR->getWarningMatInstance();
 
+      // Try to draw a run of identical instances in one call.
+      if ( mEnableInstancing )
+      {
+         U32 count = _renderInstanced( state, mat, j, sgData );
+         if ( count > 0 )
+         {
+            // The material passes reset the cached stages.
+            lastLM = NULL;
+            lastCubemap = NULL;
+            lastReflectTex = NULL;
+
+            j += count;
+            continue;
+         }
+      }
 
       U32 matListEnd = j;
       lastMiscTex = sgData.miscTex;
@@ -238,3 +321,101 @@ void RenderMeshMgr::render(SceneState * state)
    }
 }
 
+
+//-----------------------------------------------------------------------------
+// instancing
+//-----------------------------------------------------------------------------
+bool RenderMeshMgr::_canInstance( const MeshRenderInst *a, const MeshRenderInst *b )
+{
+   // Everything but the object transform has to match as
+   // the whole batch shares one material setup.
+   return   a->matInst == b->matInst &&
+            a->vertBuff->getPointer() == b->vertBuff->getPointer() &&
+            a->primBuff->getPointer() == b->primBuff->getPointer() &&
+            a->prim == b->prim &&
+            ( a->prim || a->primBuffIndex == b->primBuffIndex ) &&
+            a->worldToCamera == b->worldToCamera &&
+            a->projection == b->projection &&
+            a->visibility == b->visibility &&
+            a->materialHint == b->materialHint &&
+            a->lightmap == b->lightmap &&
+            a->fogTex == b->fogTex &&
+            a->backBuffTex == b->backBuffTex &&
+            a->reflectTex == b->reflectTex &&
+            a->miscTex == b->miscTex &&
+            a->cubemap == b->cubemap &&
+            !a->boneTransforms && !b->boneTransforms &&
+            dMemcmp( a->lights, b->lights, sizeof( a->lights ) ) == 0;
+}
+
+U32 RenderMeshMgr::_renderInstanced(   SceneState *state, 
+                                       BaseMatInstance *mat, 
+                                       U32 start, 
+                                       SceneGraphData &sgData )
+{
+   if ( !GFX->supportsInstancing() )
+      return 0;
+
+   MeshRenderInst *ri = static_cast<MeshRenderInst*>(mElementList[start].inst);
+
+   // Find the length of the run.
+   const U32 maxCount = getMin( U32(mElementList.size()) - start, GFX->getMaxDynamicVerts() );
+   U32 count = 1;
+   while (  count < maxCount &&
+            _canInstance( ri, static_cast<MeshRenderInst*>(mElementList[start + count].inst) ) )
+      count++;
+
+   if ( count < (U32)getMax( mInstancingMinBatch, 2 ) )
+      return 0;
+
+   InstancingMaterialHook *hook = mat->getHook<InstancingMaterialHook>();
+   if ( !hook )
+   {
+      hook = new InstancingMaterialHook( mat );
+      mat->addHook( hook );
+   }
+
+   BaseMatInstance *instMat = hook->getMatInstance();
+   if ( !instMat )
+      return 0;
+
+   PROFILE_SCOPE(RenderMeshMgr_renderInstanced);
+
+   // Fill the instance stream with the object transforms.
+   mInstanceVB.set( GFX, count, GFXBufferTypeVolatile );
+   GFXVertexInstanceTransform *inst = mInstanceVB.lock();
+   for ( U32 i=0; i < count; i++ )
+   {
+      const MatrixF &objToWorld = *static_cast<MeshRenderInst*>(mElementList[start + i].inst)->objectToWorld;
+      objToWorld.getRow( 0, &inst[i].row0 );
+      objToWorld.getRow( 1, &inst[i].row1 );
+      objToWorld.getRow( 2, &inst[i].row2 );
+   }
+   mInstanceVB.unlock();
+
+   // The shader moves the vertices into world space, so 
+   // the object transform of the batch is the identity.
+   MatrixSet &matrixSet = getParentManager()->getMatrixSet();
+   sgData.objTrans = MatrixF::Identity;
+
+   while ( instMat->setupPass( state, sgData ) )
+   {
+      matrixSet.setWorld( MatrixF::Identity );
+      matrixSet.setView( *ri->worldToCamera );
+      matrixSet.setProjection( *ri->projection );
+      instMat->setTransforms( matrixSet, state );
+
+      instMat->setSceneInfo( state, sgData );
+      instMat->setBuffers( ri->vertBuff, ri->primBuff );
+      GFX->setInstanceBuffer( mInstanceVB.getPointer(), count );
+
+      if ( ri->prim )
+         GFX->drawPrimitive( *ri->prim );
+      else
+         GFX->drawPrimitive( ri->primBuffIndex );
+   }
+
+   GFX->setInstanceBuffer( NULL, 0 );
+
+   return count;
+}
@@ -8,6 +8,12 @@
 #ifndef _RENDERBINMANAGER_H_
 #include "renderInstance/renderBinManager.h"
 #endif
+#ifndef _MATINSTANCEHOOK_H_
+#include "materials/matInstanceHook.h"
+#endif
+#ifndef _GFXVERTEXTYPES_H_
+#include "gfx/gfxVertexTypes.h"
+#endif
 
 //**************************************************************************
 // RenderMeshMgr
@@ -31,6 +37,62 @@ protected:
    GFXStateBlockRef mNormalSB;
    GFXStateBlockRef mReflectSB;
 
+   /// The hook which holds the hardware instancing
+   /// variant of a material instance.
+   class InstancingMaterialHook : public MatInstanceHook
+   {
+   public:
+
+      InstancingMaterialHook( BaseMatInstance *matInst );
+      virtual ~InstancingMaterialHook();
+
+      /// Returns the instancing material or NULL if the material
+      /// cannot be instanced or its shaders are still compiling.
+      BaseMatInstance* getMatInstance();
+
+      virtual const MatInstanceHookType& getType() const { return Type; }
+
+      /// Our material hook type.
+      static const MatInstanceHookType Type;
+
+   protected:
+
+      /// The vertex format of the source material with
+      /// the instance stream elements appended.
+      GFXVertexFormat mInstancingFormat;
+
+      BaseMatInstance *mInstancingMatInst;
+
+      /// Set once the features of the real material 
+      /// have been checked for instancing support.
+      bool mChecked;
+   };
+
+   /// If true consecutive instances with the same material,
+   /// buffers and scene data are drawn in a single call.
+   bool mEnableInstancing;
+
+   /// The smallest run of matching instances which is
+   /// drawn with instancing.
+   S32 mInstancingMinBatch;
+
+   /// The volatile per-instance transform stream.
+   GFXVertexBufferHandle<GFXVertexInstanceTransform> mInstanceVB;
+
+   /// Returns true if the two instances can be drawn in
+   /// the same instanced draw call.
+   static bool _canInstance( const MeshRenderInst *a, const MeshRenderInst *b );
+
+   /// Draws the run of instances in the element list beginning
+   /// at start with a single instanced draw call per pass.
+   ///
+   /// @return Returns the number of instances drawn or zero if 
+   /// the run could not be instanced.
+   U32 _renderInstanced(   SceneState *state, 
+                           BaseMatInstance *mat, 
+                           U32 start, 
+                           SceneGraphData &sgData );
+
    void construct();
 };
 
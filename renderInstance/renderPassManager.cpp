@@ -22,6 +22,9 @@
 #include "renderInstance/renderTerrainMgr.h"
 #include "core/util/safeDelete.h"
 #include "math/util/matrixSet.h"
+#include "platform/threads/thread.h"
+#include "platform/platformTLS.h"
+#include "console/consoleTypes.h"
 
 //const String IRenderable3D::InterfaceName("Render3D");
 const F32 RenderPassManager::PROCESSADD_NONE = -1e30f;
@@ -43,6 +46,12 @@ const RenderInstType RenderPassManager::RIT_Custom("Custom");
 const RenderInstType RenderPassManager::RIT_Particle("Particle");
 const RenderInstType RenderPassManager::RIT_Occluder("Occluder");
 
+bool RenderPassManager::smParallelPrep = true;
+S32 RenderPassManager::smParallelPrepBatchSize = 32;
+
+/// The PrepSlot bound to each thread.
+static ThreadStorage sBoundPrepSlot;
+
 
 //*****************************************************************************
 // RenderInstance
@@ -97,6 +106,8 @@ RenderPassManager::RenderBinEventSignal& RenderPassManager::getRenderBinSignal()
 
 void RenderPassManager::initPersistFields()
 {
+   Con::addVariable( "$RenderPassManager::parallelPrep", TypeBool, &smParallelPrep );
+   Con::addVariable( "$RenderPassManager::parallelPrepBatchSize", TypeS32, &smParallelPrepBatchSize );
 }
 
 RenderPassManager::RenderPassManager()
@@ -104,6 +115,10 @@ RenderPassManager::RenderPassManager()
    mSceneManager = NULL;
    VECTOR_SET_ASSOCIATION( mRenderBins );
    VECTOR_SET_ASSOCIATION( mAddBins );
+   VECTOR_SET_ASSOCIATION( mPrepSlots );
+
+   mNumPrepSlots = 0;
+   mParallelPrep = false;
 
 #ifndef TORQUE_SHIPPING
    mAddInstCount = 0;
@@ -119,6 +134,9 @@ RenderPassManager::~RenderPassManager()
 {
    dAligned_free(mMatrixSet);
 
+   for ( U32 i=0; i < mPrepSlots.size(); i++ )
+      delete mPrepSlots[i];
+
    // Any bins left need to be deleted.
    for ( U32 i=0; i<mRenderBins.size(); i++ )
    {
@@ -205,6 +223,18 @@ void RenderPassManager::addInst( RenderInst *inst )
 {
    AssertFatal(inst != NULL, "doh, null instance");
 
+   // Workers only queue the instance, endParallelPrep() adds it
+   // to the bins from the main thread.
+   if ( mParallelPrep )
+   {
+      PrepSlot *slot = _findPrepSlot();
+      if ( slot )
+      {
+         slot->insts.push_back( inst );
+         return;
+      }
+   }
+
    PROFILE_SCOPE(SceneRenderPassManager_addInst);
 
    #ifndef TORQUE_SHIPPING
@@ -253,6 +283,67 @@ void RenderPassManager::addInst( RenderInst *inst )
    //AssertFatal(bHandled, "Instance without a render manager!");
 }
 
+void RenderPassManager::beginParallelPrep( U32 numSlots )
+{
+   AssertFatal( !mParallelPrep, "RenderPassManager::beginParallelPrep() - Already open!" );
+
+   while ( mPrepSlots.size() < numSlots )
+   {
+      PrepSlot *slot = new PrepSlot;
+      slot->pass = this;
+      slot->bound = false;
+      mPrepSlots.push_back( slot );
+   }
+
+   mNumPrepSlots = numSlots;
+   mParallelPrep = true;
+}
+
+void RenderPassManager::bindPrepSlot( U32 slot )
+{
+   AssertFatal( mParallelPrep && slot < mNumPrepSlots, "RenderPassManager::bindPrepSlot() - Bad slot!" );
+   AssertFatal( !mPrepSlots[slot]->bound, "RenderPassManager::bindPrepSlot() - Slot is already bound!" );
+
+   mPrepSlots[slot]->bound = true;
+   sBoundPrepSlot.set( mPrepSlots[slot] );
+}
+
+void RenderPassManager::unbindPrepSlot( U32 slot )
+{
+   AssertFatal( slot < mNumPrepSlots, "RenderPassManager::unbindPrepSlot() - Bad slot!" );
+   AssertFatal( sBoundPrepSlot.get() == mPrepSlots[slot], "RenderPassManager::unbindPrepSlot() - Slot is bound to another thread!" );
+
+   mPrepSlots[slot]->bound = false;
+   sBoundPrepSlot.set( NULL );
+}
+
+RenderPassManager::PrepSlot* RenderPassManager::_findPrepSlot() const
+{
+   PrepSlot *slot = (PrepSlot*)sBoundPrepSlot.get();
+   return slot && slot->pass == this ? slot : NULL;
+}
+
+void RenderPassManager::endParallelPrep()
+{
+   PROFILE_SCOPE( RenderPassManager_EndParallelPrep );
+
+   AssertFatal( mParallelPrep, "RenderPassManager::endParallelPrep() - Not open!" );
+   mParallelPrep = false;
+
+   for ( U32 i=0; i < mNumPrepSlots; i++ )
+   {
+      PrepSlot *slot = mPrepSlots[i];
+      AssertFatal( !slot->bound, "RenderPassManager::endParallelPrep() - Slot is still bound!" );
+
+      for ( U32 j=0; j < slot->insts.size(); j++ )
+         addInst( slot->insts[j] );
+
+      slot->insts.clear();
+   }
+
+   mNumPrepSlots = 0;
+}
+
 void RenderPassManager::sort()
 {
    PROFILE_SCOPE( RenderPassManager_Sort );
@@ -269,8 +360,13 @@ void RenderPassManager::clear()
 {
    PROFILE_SCOPE( RenderPassManager_Clear );
 
+   AssertFatal( !mParallelPrep, "RenderPassManager::clear() - Parallel prep is still open!" );
+
    mChunker.clear();
 
+   for ( U32 i=0; i < mPrepSlots.size(); i++ )
+      mPrepSlots[i]->chunker.clear();
+
    for (Vector<RenderBinManager *>::iterator itr = mRenderBins.begin();
       itr != mRenderBins.end(); itr++)
    {
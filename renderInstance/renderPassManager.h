@@ -100,7 +100,7 @@ public:
    template <typename T>
    T* allocInst()
    {
-      T* inst = mChunker.alloc<T>();
+      T* inst = _getChunker().alloc<T>();
       inst->clear();
       return inst;
    }
@@ -108,11 +108,14 @@ public:
    /// Allocate a matrix, valid until ::clear called.
    MatrixF* allocUniqueXform(const MatrixF& data) 
    { 
-      MatrixF *r = mChunker.alloc<MatrixF>(); 
+      MatrixF *r = _getChunker().alloc<MatrixF>(); 
       *r = data; 
       return r; 
    }
 
+   /// Allocate an uninitialized array of matrices, valid until ::clear called.
+   MatrixF* allocUniqueXforms( U32 count ) { return _getChunker().allocArray<MatrixF>( count ); }
+
    enum SharedTransformType
    {
       View,
@@ -127,7 +130,41 @@ public:
 
    /// Allocate a GFXPrimitive object which will remain valid 
    /// until the pass manager is cleared.
-   GFXPrimitive* allocPrim() { return mChunker.alloc<GFXPrimitive>(); }
+   GFXPrimitive* allocPrim() { return _getChunker().alloc<GFXPrimitive>(); }
+   /// @}
+
+   /// @name Parallel prep interface
+   ///
+   /// While a parallel prep is open prepRenderImage() may run on worker
+   /// threads.  A worker binds a prep slot which gives it a private chunker
+   /// and instance list, so allocInst() and addInst() need no locking.  The
+   /// slots are added to the bins in slot order by endParallelPrep(), which
+   /// keeps the bin contents independent of thread scheduling.
+   ///
+   /// Unbound threads, including the main thread, allocate and add as usual.
+   /// @{
+
+   /// Opens a parallel prep with the given number of slots.  Main thread only.
+   void beginParallelPrep( U32 numSlots );
+
+   /// Routes allocations and adds from the calling thread to the slot.
+   void bindPrepSlot( U32 slot );
+
+   /// Releases the slot bound with bindPrepSlot().
+   void unbindPrepSlot( U32 slot );
+
+   /// Closes the parallel prep and adds the slot instances to the bins.
+   void endParallelPrep();
+
+   /// Returns true between beginParallelPrep() and endParallelPrep().
+   bool isParallelPrep() const { return mParallelPrep; }
+
+   /// Enables the parallel prepRenderImage stage in the scene traversal.
+   static bool smParallelPrep;
+
+   /// The number of objects handed to a worker at a time.
+   static S32 smParallelPrepBatchSize;
+
    /// @}
 
    /// Add a RenderInstance to the list
@@ -230,6 +267,41 @@ protected:
 
    #endif
 
+   /// Per thread allocation state for a parallel prep.
+   struct PrepSlot
+   {
+      /// The pass which owns the slot.
+      RenderPassManager *pass;
+
+      /// Set while a thread is bound to the slot.
+      volatile bool bound;
+
+      MultiTypedChunker chunker;
+
+      /// Instances added while bound, in submission order.
+      Vector<RenderInst*> insts;
+   };
+
+   Vector<PrepSlot*> mPrepSlots;
+   U32 mNumPrepSlots;
+   bool mParallelPrep;
+
+   /// Returns the slot of this pass bound to the calling thread or NULL.
+   PrepSlot* _findPrepSlot() const;
+
+   /// Returns the chunker allocations should come from on this thread.
+   MultiTypedChunker& _getChunker()
+   {
+      if ( mParallelPrep )
+      {
+         PrepSlot *slot = _findPrepSlot();
+         if ( slot )
+            return slot->chunker;
+      }
+
+      return mChunker;
+   }
+
    /// Do a sorted insert into a vector, renderOrder bool controls which test we run for insertion.
    void _insertSort(Vector<RenderBinManager*>& list, RenderBinManager* mgr, bool renderOrder);
 };
@@ -332,6 +404,13 @@ struct MeshRenderInst : public RenderInst
    /// features.
    void *materialHint;
 
+   /// The bone palette for hardware skinning or NULL.
+   /// @see SceneGraphData::boneTransforms
+   const MatrixF *boneTransforms;
+
+   /// The number of matrices in boneTransforms.
+   U32 boneCount;
+
    /// The lights we pass to the material for this 
    /// mesh in order light importance.
    LightInfo* lights[8];
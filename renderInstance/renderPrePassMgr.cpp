@@ -583,6 +583,19 @@ ProcessedMaterial* PrePassMatInstance::getShaderMaterial()
    return new ProcessedPrePassMaterial(*mMaterial, mPrePassMgr);
 }
 
+ProcessedMaterial* PrePassMatInstance::getPlaceholderMaterial()
+{
+   // The fixed function output isn't valid prepass data, so
+   // only fill the depth until the prepass shaders are ready.
+   ProcessedMaterial *pmat = Parent::getPlaceholderMaterial();
+
+   GFXStateBlockDesc desc( mUserDefinedState );
+   desc.setColorWrites( false, false, false, false );
+   pmat->addStateBlockDesc( desc );
+
+   return pmat;
+}
+
 bool PrePassMatInstance::init( const FeatureSet &features,
                                const GFXVertexFormat *vertexFormat )
 {
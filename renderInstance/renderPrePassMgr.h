@@ -116,6 +116,7 @@ public:
 
 protected:      
    virtual ProcessedMaterial* getShaderMaterial();
+   virtual ProcessedMaterial* getPlaceholderMaterial();
 
    const RenderPrePassMgr *mPrePassMgr;
 };
@@ -0,0 +1,162 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "sceneGraph/sceneCullBounds.h"
+
+#include "sceneGraph/sceneObject.h"
+#include "math/util/frustum.h"
+#include "math/mMathFn.h"
+#include "platform/profiler.h"
+
+
+SceneCullBounds::SceneCullBounds()
+   :  mData( NULL ),
+      mMasks( NULL ),
+      mCapacity( 0 )
+{
+   VECTOR_SET_ASSOCIATION( mObjects );
+}
+
+SceneCullBounds::~SceneCullBounds()
+{
+   for ( U32 i = 0; i < mObjects.size(); i++ )
+      mObjects[i]->mCullIndex = 0xFFFFFFFF;
+
+   dAligned_free( mData );
+   dAligned_free( mMasks );
+}
+
+void SceneCullBounds::_grow( U32 capacity )
+{
+   capacity = getMax( ( capacity + 3 ) & ~3, mCapacity * 2 );
+
+   F32 *data = (F32*)dAligned_malloc( capacity * StreamCount * sizeof( F32 ), 16 );
+   dMemset( data, 0, capacity * StreamCount * sizeof( F32 ) );
+
+   for ( U32 i = 0; mData && i < StreamCount; i++ )
+      dMemcpy( data + i * capacity, _getStream( i ), mCapacity * sizeof( F32 ) );
+
+   dAligned_free( mData );
+   dAligned_free( mMasks );
+
+   mData = data;
+   mMasks = (U32*)dAligned_malloc( capacity * sizeof( U32 ), 16 );
+   dMemset( mMasks, 0, capacity * sizeof( U32 ) );
+   mCapacity = capacity;
+}
+
+void SceneCullBounds::_write( U32 index, SceneObject *obj )
+{
+   // The sphere is rebuilt from the zone box since some
+   // objects return a zone box larger than their world box.
+   const Box3F &box = obj->getZoneBox();
+   SphereF sphere;
+   box.getCenter( &sphere.center );
+   sphere.radius = ( box.maxExtents - sphere.center ).len();
+
+   _getStream( MinX )[index] = box.minExtents.x;
+   _getStream( MinY )[index] = box.minExtents.y;
+   _getStream( MinZ )[index] = box.minExtents.z;
+   _getStream( MaxX )[index] = box.maxExtents.x;
+   _getStream( MaxY )[index] = box.maxExtents.y;
+   _getStream( MaxZ )[index] = box.maxExtents.z;
+   _getStream( CenterX )[index] = sphere.center.x;
+   _getStream( CenterY )[index] = sphere.center.y;
+   _getStream( CenterZ )[index] = sphere.center.z;
+   _getStream( Radius )[index] = sphere.radius;
+}
+
+void SceneCullBounds::_clear( U32 index )
+{
+   for ( U32 i = 0; i < StreamCount; i++ )
+      _getStream( i )[index] = 0.0f;
+
+   mMasks[index] = 0;
+}
+
+void SceneCullBounds::insert( SceneObject *obj )
+{
+   AssertFatal( obj->mCullIndex == 0xFFFFFFFF, "SceneCullBounds::insert() - Object is already inserted!" );
+
+   const U32 index = mObjects.size();
+   if ( index >= mCapacity )
+      _grow( index + 1 );
+
+   mObjects.push_back( obj );
+   obj->mCullIndex = index;
+   _write( index, obj );
+}
+
+void SceneCullBounds::remove( SceneObject *obj )
+{
+   const U32 index = obj->mCullIndex;
+   if ( index == 0xFFFFFFFF )
+      return;
+
+   AssertFatal( mObjects[index] == obj, "SceneCullBounds::remove() - Object index is stale!" );
+
+   const U32 last = mObjects.size() - 1;
+   if ( index != last )
+   {
+      SceneObject *moved = mObjects[last];
+      mObjects[index] = moved;
+      moved->mCullIndex = index;
+
+      for ( U32 i = 0; i < StreamCount; i++ )
+         _getStream( i )[index] = _getStream( i )[last];
+
+      mMasks[index] = mMasks[last];
+   }
+
+   _clear( last );
+   mObjects.pop_back();
+   obj->mCullIndex = 0xFFFFFFFF;
+}
+
+void SceneCullBounds::update( SceneObject *obj )
+{
+   if ( obj->mCullIndex != 0xFFFFFFFF )
+      _write( obj->mCullIndex, obj );
+}
+
+void SceneCullBounds::cull( const Frustum *const *frustums, U32 numFrustums )
+{
+   PROFILE_SCOPE( SceneCullBounds_Cull );
+
+   AssertFatal( numFrustums <= MaxFrustums, "SceneCullBounds::cull() - Too many frustums!" );
+
+   if ( mObjects.empty() )
+      return;
+
+   F32 planes[ MaxFrustums * Frustum::PlaneCount * 4 ];
+   for ( U32 f = 0; f < numFrustums; f++ )
+   {
+      const PlaneF *src = frustums[f]->getPlanes();
+      F32 *dst = planes + f * Frustum::PlaneCount * 4;
+
+      for ( U32 p = 0; p < Frustum::PlaneCount; p++ )
+      {
+         dst[ p * 4 + 0 ] = src[p].x;
+         dst[ p * 4 + 1 ] = src[p].y;
+         dst[ p * 4 + 2 ] = src[p].z;
+         dst[ p * 4 + 3 ] = src[p].d;
+      }
+   }
+
+   const F32 *streams[ StreamCount ];
+   for ( U32 i = 0; i < StreamCount; i++ )
+      streams[i] = _getStream( i );
+
+   // The padding entries are zeroed so they are safe to test.
+   const U32 count = ( mObjects.size() + 3 ) & ~3;
+   m_planeF_cull_SoA( planes, numFrustums, streams, count, mMasks );
+}
+
+bool SceneCullBounds::isVisible( const SceneObject *obj, U32 frustum ) const
+{
+   AssertFatal( obj->mCullIndex < mObjects.size(), "SceneCullBounds::isVisible() - Object isn't inserted!" );
+   return mMasks[ obj->mCullIndex ] & ( 1 << frustum );
+}
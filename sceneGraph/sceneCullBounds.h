@@ -0,0 +1,93 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _SCENECULLBOUNDS_H_
+#define _SCENECULLBOUNDS_H_
+
+#ifndef _TVECTOR_H_
+#include "core/util/tVector.h"
+#endif
+
+class SceneObject;
+class Frustum;
+
+
+/// Keeps the world boxes and spheres of the scene objects in flat, aligned
+/// structure of arrays form so that the whole scene can be culled with
+/// m_planeF_cull_SoA instead of chasing SceneObject pointers.
+///
+/// The SceneGraph inserts objects when they're added to the scene and
+/// updates their entry whenever they are rezoned, which happens on every
+/// transform change.
+///
+/// @see SceneGraph::getCullBounds
+class SceneCullBounds
+{
+public:
+
+   /// The most frustums cull() can handle in one pass.
+   enum { MaxFrustums = 32 };
+
+   SceneCullBounds();
+   ~SceneCullBounds();
+
+   /// Adds the object and copies its current bounds.
+   void insert( SceneObject *obj );
+
+   /// Removes the object by moving the last entry into its slot.
+   void remove( SceneObject *obj );
+
+   /// Copies the current zone box of the object and the
+   /// sphere around it.
+   void update( SceneObject *obj );
+
+   /// Tests every entry against the frustums in one pass.  Bit f of
+   /// an entry's mask is set if it is inside frustums[f].
+   void cull( const Frustum *const *frustums, U32 numFrustums );
+
+   /// Returns true if the object was inside the frustum at the last cull().
+   bool isVisible( const SceneObject *obj, U32 frustum ) const;
+
+   /// Returns the visibility masks from the last cull().
+   const U32* getMasks() const { return mMasks; }
+
+   U32 getCount() const { return mObjects.size(); }
+
+   SceneObject* getObject( U32 index ) const { return mObjects[index]; }
+
+protected:
+
+   /// The streams in the order m_planeF_cull_SoA expects them.
+   enum
+   {
+      MinX, MinY, MinZ,
+      MaxX, MaxY, MaxZ,
+      CenterX, CenterY, CenterZ,
+      Radius,
+
+      StreamCount
+   };
+
+   Vector<SceneObject*> mObjects;
+
+   /// All the streams in one aligned block, mCapacity floats each.
+   F32 *mData;
+
+   /// Entry masks written by cull().
+   U32 *mMasks;
+
+   /// The allocated entries per stream, always a multiple of 4.
+   U32 mCapacity;
+
+   F32* _getStream( U32 stream ) const { return mData + stream * mCapacity; }
+
+   void _grow( U32 capacity );
+
+   void _write( U32 index, SceneObject *obj );
+
+   void _clear( U32 index );
+};
+
+#endif // _SCENECULLBOUNDS_H_
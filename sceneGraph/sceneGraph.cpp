@@ -19,10 +19,13 @@
 #include "core/util/swizzle.h"
 #include "gfx/gfxDevice.h"
 #include "gfx/bitmap/gBitmap.h"
+#include "console/consoleTypes.h"
+#include "sceneGraph/sceneOcclusionBuffer.h"
 
 
 const U32 SceneGraph::csmMaxTraversalDepth = 4;
 U32 SceneGraph::smStateKey = 0;
+bool SceneGraph::smBatchCull = true;
 SceneGraph* gClientSceneGraph = NULL;
 SceneGraph* gServerSceneGraph = NULL;
 const U32 SceneGraph::csmRefPoolBlockSize = 4096;
@@ -38,12 +41,26 @@ SceneGraph::SceneGraph( bool isClient )
    mLightManager = NULL;
 
    mSceneState = NULL;
+   mPrepList = NULL;
+   mOcclusionBuffer = NULL;
 
    mCurrZoneEnd        = 0;
    mNumActiveZones     = 0;
 
    mIsClient = isClient;
 
+   if ( mIsClient )
+   {
+      Con::addVariable( "$SceneGraph::batchCull", TypeBool, &smBatchCull );
+
+      Con::addVariable( "$SceneGraph::occlusionCull", TypeBool, &SceneOcclusionBuffer::smEnabled );
+      Con::addVariable( "$SceneGraph::maxOccluderTriangles", TypeS32, &SceneOcclusionBuffer::smMaxTriangles );
+      Con::addVariable( "$OcclusionStats::occluders", TypeS32, &SceneOcclusionBuffer::smNumOccluders );
+      Con::addVariable( "$OcclusionStats::triangles", TypeS32, &SceneOcclusionBuffer::smNumTriangles );
+      Con::addVariable( "$OcclusionStats::tested", TypeS32, &SceneOcclusionBuffer::smNumTested );
+      Con::addVariable( "$OcclusionStats::culled", TypeS32, &SceneOcclusionBuffer::smNumCulled );
+   }
+
    mFogData.density = 0.0f;
    mFogData.densityOffset = 0.0f;
    mFogData.atmosphereHeight = 0.0f;
@@ -81,6 +98,8 @@ SceneGraph::~SceneGraph()
    
    if (mLightManager)
       mLightManager->deactivate();   
+
+   SAFE_DELETE( mOcclusionBuffer );
 }
 
 void SceneGraph::addRefPoolBlock()
@@ -604,6 +623,8 @@ void SceneGraph::rezoneObject(SceneObject* obj)
    AssertFatal(obj->mSceneManager != NULL && obj->mSceneManager == this, "Error, bad or no scenemanager here!");
    PROFILE_START(SG_Rezone);
 
+   mCullBounds.update(obj);
+
    if (obj->mZoneRefHead != NULL) 
    {
       // Remove the object from the zone lists...
@@ -733,6 +754,10 @@ void SceneGraph::zoneInsert(SceneObject* obj)
    PROFILE_START(SG_ZoneInsert);
    AssertFatal(obj->mNumCurrZones == 0, "Error, already entered into zone list...");
 
+   // The bounds get filled in by rezoneObject().
+   if ( mIsClient && obj->mCullIndex == 0xFFFFFFFF )
+      mCullBounds.insert(obj);
+
    rezoneObject(obj);
 
    if (obj->isManagingZones()) {
@@ -766,6 +791,8 @@ void SceneGraph::zoneRemove(SceneObject* obj)
    PROFILE_START(SG_ZoneRemove);
    obj->mNumCurrZones = 0;
 
+   mCullBounds.remove(obj);
+
    // Remove the object from the zone lists...
    SceneObjectRef* walk = obj->mZoneRefHead;
    while (walk) {
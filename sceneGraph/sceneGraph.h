@@ -22,12 +22,16 @@
 #ifndef _FOGSTRUCTS_H_
 #include "sceneGraph/fogStructs.h"
 #endif
+#ifndef _SCENECULLBOUNDS_H_
+#include "sceneGraph/sceneCullBounds.h"
+#endif
 
 class LightManager;
 class SceneGraph;
 class SceneState;
 class NetConnection;
 class RenderPassManager;
+class SceneOcclusionBuffer;
 class TerrainBlock;
 
 
@@ -232,6 +236,10 @@ class SceneGraph
    // Returns the current active light manager.
    LightManager* getLightManager();
 
+   /// Returns the bounds used for batch frustum culling.  Only
+   /// the client scene graph fills this in.
+   SceneCullBounds& getCullBounds() { return mCullBounds; }
+
    /// Finds the light manager by name and activates it.
    bool setLightManager( const char *lmName );
 
@@ -295,6 +303,38 @@ protected:
 
    void treeTraverseVisit(SceneObject*, SceneState*, const U32);
 
+   /// Culls the objects against the terrain and the occlusion buffer, if
+   /// one is passed, and calls prepRenderImage on the survivors.  With
+   /// RenderPassManager::smParallelPrep this is spread over the thread
+   /// pool; objects that aren't thread safe are prepped on the main
+   /// thread afterwards in list order.
+   void _prepRenderImages( SceneState *state, 
+                           const U32 stateKey, 
+                           const Vector<SceneObject*> &objects,
+                           const SceneOcclusionBuffer *occlusion );
+
+   /// Draws the occluders among the objects into the occlusion buffer
+   /// nearest first.  Returns NULL if there is nothing to test against.
+   const SceneOcclusionBuffer* _renderOccluders( SceneState *state, const Vector<SceneObject*> &objects );
+
+   /// The software depth buffer used by the camera view.
+   SceneOcclusionBuffer *mOcclusionBuffer;
+
+   /// Objects waiting for _prepRenderImages() during a traversal or
+   /// NULL to prep each object as soon as it is visited.
+   Vector<SceneObject*> *mPrepList;
+
+   /// The flat bounds of every zoned object in the client scene.
+   SceneCullBounds mCullBounds;
+
+public:
+
+   /// If true the diffuse traversal culls the whole scene against the
+   /// camera frustum with SceneCullBounds before querying the container.
+   static bool smBatchCull;
+
+protected:
+
    void compactZonesCheck();
    bool alreadyManagingZones(SceneObject*) const;
 
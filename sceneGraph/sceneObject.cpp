@@ -14,6 +14,8 @@
 #include "gfx/bitmap/gBitmap.h"
 #include "sim/netConnection.h"
 #include "math/util/frustum.h"
+#include "collision/concretePolyList.h"
+#include "sceneGraph/sceneOcclusionBuffer.h"
 
 
 IMPLEMENT_CONOBJECT(SceneObject);
@@ -355,6 +357,7 @@ SceneObject::SceneObject()
    mTypeMask = DefaultObjectType;
    mCollisionCount = 0;
    mGlobalBounds = false;
+   mAddPrepared = false;
 
    mObjScale.set(1,1,1);
    mObjToWorld.identity();
@@ -363,6 +366,8 @@ SceneObject::SceneObject()
    mObjBox      = Box3F(Point3F(0, 0, 0), Point3F(0, 0, 0));
    mWorldBox    = Box3F(Point3F(0, 0, 0), Point3F(0, 0, 0));
    mWorldSphere = SphereF(Point3F(0, 0, 0), 0);
+   mCullIndex = 0xFFFFFFFF;
+   mOccluderMesh = NULL;
 
    mRenderObjToWorld.identity();
    mRenderWorldToObj.identity();
@@ -401,6 +406,8 @@ SceneObject::~SceneObject()
    AssertFatal(mZoneRefHead == NULL && mBinRefHead == NULL,
                "Error, still linked in reference lists!");
 
+   clearOccluderMesh();
+
    unlink();   
 }
 
@@ -429,6 +436,52 @@ bool SceneObject::buildRenderedPolyList(AbstractPolyList* polyList, const Box3F
    return buildPolyList(polyList, box, sphere);
 }
 
+void SceneObject::buildOccluderMesh( OccluderMesh *mesh )
+{
+   ConcretePolyList polyList;
+   if ( !buildPolyList( &polyList, getWorldBox(), getWorldSphere() ) )
+      return;
+
+   mesh->verts = polyList.mVertexList;
+
+   // The polys are convex so just fan them out, winding
+   // the triangles to face along the poly plane.
+   for ( U32 i = 0; i < polyList.mPolyList.size(); i++ )
+   {
+      const ConcretePolyList::Poly &poly = polyList.mPolyList[i];
+      const U32 *idx = polyList.mIndexList.address() + poly.vertexStart;
+
+      for ( U32 j = 2; j < poly.vertexCount; j++ )
+      {
+         const Point3F &v0 = mesh->verts[ idx[0] ];
+         const Point3F normal = mCross( mesh->verts[ idx[ j - 1 ] ] - v0, mesh->verts[ idx[j] ] - v0 );
+         const bool flip = mDot( normal, poly.plane ) < 0.0f;
+
+         mesh->indices.push_back( idx[0] );
+         mesh->indices.push_back( idx[ flip ? j : j - 1 ] );
+         mesh->indices.push_back( idx[ flip ? j - 1 : j ] );
+      }
+   }
+}
+
+const OccluderMesh* SceneObject::getOccluderMesh()
+{
+   if ( !mOccluderMesh )
+   {
+      PROFILE_SCOPE( SceneObject_BuildOccluderMesh );
+
+      mOccluderMesh = new OccluderMesh;
+      buildOccluderMesh( mOccluderMesh );
+   }
+
+   return mOccluderMesh;
+}
+
+void SceneObject::clearOccluderMesh()
+{
+   SAFE_DELETE( mOccluderMesh );
+}
+
 bool SceneObject::castRay(const Point3F&, const Point3F&, RayInfo*)
 {
    return false;
@@ -563,8 +616,13 @@ bool SceneObject::onAdd()
    if (Parent::onAdd() == false)
       return false;
 
-   mWorldToObj = mObjToWorld;
-   mWorldToObj.affineInverse();
+   if (!mAddPrepared)
+   {
+      mWorldToObj = mObjToWorld;
+      mWorldToObj.affineInverse();
+   }
+   mAddPrepared = false;
+
    resetWorldBox();
 
    setRenderTransform(mObjToWorld);
@@ -574,6 +632,13 @@ bool SceneObject::onAdd()
    return true;
 }
 
+void SceneObject::prepareAdd()
+{
+   mWorldToObj = mObjToWorld;
+   mWorldToObj.affineInverse();
+   mAddPrepared = true;
+}
+
 void SceneObject::addToScene()
 {
    if(isClientObject())
@@ -624,6 +689,7 @@ void SceneObject::setTransform(const MatrixF& mat)
    mWorldToObj.affineInverse();
 
    resetWorldBox();
+   clearOccluderMesh();
 
    if (mSceneManager != NULL && mNumCurrZones != 0) 
    {
@@ -42,6 +42,8 @@ class Convex;
 class LightInfo;
 class Frustum;
 struct ObjectRenderInst;
+struct OccluderMesh;
+class TSAnimateBatch;
 
 //--------------------------------------------------------------------------
 
@@ -262,6 +264,7 @@ class SceneObject : public NetObject, public LightReceiver, public Container::Li
    friend class Container;
    friend class SceneGraph;
    friend class SceneState;
+   friend class SceneCullBounds;
 
    //-------------------------------------- Public constants
 public:
@@ -361,6 +364,10 @@ public:
    /// Returns the bounding sphere for this object in world coordinates
    const SphereF& getWorldSphere() const   { return mWorldSphere; }
 
+   /// Returns the entry in the SceneCullBounds of the scene graph or
+   /// 0xFFFFFFFF if the object isn't in it.
+   U32 getCullIndex() const { return mCullIndex; }
+
    /// Returns the center of the bounding box in world coordinates
    Point3F        getBoxCenter() const     { return (mWorldBox.minExtents + mWorldBox.maxExtents) * 0.5f; }
 
@@ -585,6 +592,38 @@ public:
                                  const U32 startZone,
                                  const bool modifyBaseZoneState = false);
 
+   /// Returns true if prepRenderImage() may run on a worker thread during
+   /// a parallel scene traversal.  The object may then only touch its own
+   /// state and submit through SceneState::getRenderPass(); no GFX, light
+   /// manager or other shared engine state.
+   ///
+   /// @see RenderPassManager::smParallelPrep
+   virtual bool isPrepRenderImageThreadSafe() const { return false; }
+
+   /// Called on the main thread before prepRenderImage() to queue the
+   /// shapes which will be animated during the prep.  The batch is run
+   /// on the thread pool before any object is prepped.
+   ///
+   /// @see TSAnimateBatch
+   virtual void prepAnimation( SceneState *state, TSAnimateBatch *batch ) {}
+
+   /// Returns true if the object is solid enough to hide the objects
+   /// behind it in the software occlusion buffer.
+   ///
+   /// @see SceneOcclusionBuffer
+   virtual bool isOccluder() const { return false; }
+
+   /// Fills in world space triangles which lie on or inside the visible
+   /// surface of the object.  By default this is the buildPolyList()
+   /// geometry inside the world box.
+   virtual void buildOccluderMesh( OccluderMesh *mesh );
+
+   /// Returns the occluder mesh, building it on first use.
+   const OccluderMesh* getOccluderMesh();
+
+   /// Drops the cached occluder mesh so that it gets rebuilt.
+   void clearOccluderMesh();
+
    /// Adds object to the client or server container depending on the object
    void addToScene();
 
@@ -600,6 +639,10 @@ protected:
    bool onAdd();
    void onRemove();
 
+   /// The inverse transform is computed ahead of onAdd() when bulk loading.
+   bool isPrepareAddThreadSafe() const { return true; }
+   void prepareAdd();
+
    // Overrideables
 protected:
    /// Called when this is added to the SceneGraph.
@@ -768,6 +811,7 @@ protected:
    Box3F   mObjBox;       ///< Bounding box in object space
    Box3F   mWorldBox;     ///< Bounding box in world space
    SphereF mWorldSphere;  ///< Bounding sphere in world space
+   U32     mCullIndex;    ///< Entry in the scene graph's SceneCullBounds or 0xFFFFFFFF
 
    MatrixF mRenderObjToWorld;    ///< Render matrix to transform object space to world space
    MatrixF mRenderWorldToObj;    ///< Render matrix to transform world space to object space
@@ -825,6 +869,9 @@ protected:
 
    bool mGlobalBounds;
 
+   /// Set by prepareAdd() once mWorldToObj is valid.
+   bool mAddPrepared;
+
 public:
    const bool isGlobalBounds() const
    {
@@ -867,6 +914,8 @@ protected:
    SceneState*    mLastState;       ///< Last SceneState that was used to render this object.
    U32            mLastStateKey;    ///< Last state key that was used to render this object.
 
+   OccluderMesh*  mOccluderMesh;    ///< Cached world space occluder triangles or NULL.
+
    /// @}
 
    /// @name Persist and console
@@ -0,0 +1,479 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "sceneGraph/sceneOcclusionBuffer.h"
+
+#include "math/util/frustum.h"
+#include "math/mPoint4.h"
+#include "platform/threads/threadPool.h"
+#include "platform/profiler.h"
+
+#if defined(TORQUE_CPU_X86)
+#include <xmmintrin.h>
+#endif
+
+
+bool SceneOcclusionBuffer::smEnabled = true;
+S32 SceneOcclusionBuffer::smMaxTriangles = 16384;
+S32 SceneOcclusionBuffer::smNumOccluders = 0;
+S32 SceneOcclusionBuffer::smNumTriangles = 0;
+S32 SceneOcclusionBuffer::smNumTested = 0;
+S32 SceneOcclusionBuffer::smNumCulled = 0;
+
+
+SceneOcclusionBuffer::SceneOcclusionBuffer()
+{
+   VECTOR_SET_ASSOCIATION( mTriangles );
+
+   mDepth = (F32*)dAligned_malloc( Width * Height * sizeof( F32 ), 16 );
+   for ( U32 i = 0; i < Width * Height; i++ )
+      mDepth[i] = 1.0f;
+   for ( U32 i = 0; i < TilesX * TilesY; i++ )
+      mTileDepth[i] = 1.0f;
+
+   mWorldToClip.identity();
+   mCameraPos.zero();
+
+   #if defined(TORQUE_CPU_X86)
+   mUseSSE = Platform::SystemInfo.processor.properties & CPU_PROP_SSE;
+   #else
+   mUseSSE = false;
+   #endif
+}
+
+SceneOcclusionBuffer::~SceneOcclusionBuffer()
+{
+   dAligned_free( mDepth );
+}
+
+bool SceneOcclusionBuffer::begin( const Frustum &frustum )
+{
+   mTriangles.clear();
+
+   smNumOccluders = 0;
+   smNumTriangles = 0;
+   smNumTested = 0;
+   smNumCulled = 0;
+
+   if ( frustum.isOrtho() )
+      return false;
+
+   MatrixF worldToCamera = frustum.getTransform();
+   worldToCamera.inverse();
+   frustum.getProjectionMatrix( &mWorldToClip );
+   mWorldToClip.mul( worldToCamera );
+
+   mCameraPos = frustum.getPosition();
+
+   return true;
+}
+
+bool SceneOcclusionBuffer::addOccluder( const OccluderMesh &mesh )
+{
+   if ( smNumTriangles >= smMaxTriangles )
+      return false;
+
+   smNumOccluders++;
+
+   const U32 numVerts = mesh.verts.size();
+   if ( numVerts == 0 )
+      return true;
+
+   // Project all the vertices up front since most are shared.
+   Vector<Point4F> clip;
+   clip.setSize( numVerts );
+
+   for ( U32 i = 0; i < numVerts; i++ )
+   {
+      clip[i].set( mesh.verts[i].x, mesh.verts[i].y, mesh.verts[i].z, 1.0f );
+      mWorldToClip.mul( clip[i] );
+   }
+
+   const U32 *idx = mesh.indices.address();
+   const U32 *endIdx = idx + mesh.indices.size();
+   for ( ; idx < endIdx; idx += 3 )
+   {
+      // Skip the back faces.  Only the front of a closed
+      // occluder can be seen, and a back face of an open one
+      // like a wall seen from behind hides nothing we can see.
+      const Point3F &v0 = mesh.verts[ idx[0] ];
+      const Point3F normal = mCross( mesh.verts[ idx[1] ] - v0, mesh.verts[ idx[2] ] - v0 );
+      if ( mDot( normal, mCameraPos - v0 ) <= 0.0f )
+         continue;
+
+      const Point4F &a = clip[ idx[0] ];
+      const Point4F &b = clip[ idx[1] ];
+      const Point4F &c = clip[ idx[2] ];
+
+      // Reject the triangles entirely outside one of the
+      // clip planes before doing any more work on them.
+      if (  ( a.z < 0.0f && b.z < 0.0f && c.z < 0.0f ) ||
+            ( a.z > a.w && b.z > b.w && c.z > c.w ) ||
+            ( a.x < -a.w && b.x < -b.w && c.x < -c.w ) ||
+            ( a.x > a.w && b.x > b.w && c.x > c.w ) ||
+            ( a.y < -a.w && b.y < -b.w && c.y < -c.w ) ||
+            ( a.y > a.w && b.y > b.w && c.y > c.w ) )
+         continue;
+
+      _addClippedTriangle( a, b, c );
+
+      if ( ++smNumTriangles >= smMaxTriangles )
+         return false;
+   }
+
+   return true;
+}
+
+void SceneOcclusionBuffer::_addClippedTriangle( const Point4F &a, const Point4F &b, const Point4F &c )
+{
+   const Point4F *in[3] = { &a, &b, &c };
+
+   // Clip against the near plane which leaves at most a quad.
+   Point4F out[4];
+   U32 numOut = 0;
+
+   for ( U32 i = 0; i < 3; i++ )
+   {
+      const Point4F &cur = *in[i];
+      const Point4F &next = *in[ ( i + 1 ) % 3 ];
+
+      const bool curInside = cur.z >= 0.0f;
+      const bool nextInside = next.z >= 0.0f;
+
+      if ( curInside )
+         out[ numOut++ ] = cur;
+
+      if ( curInside != nextInside )
+      {
+         const F32 t = cur.z / ( cur.z - next.z );
+         out[ numOut++ ].interpolate( cur, next, t );
+      }
+   }
+
+   for ( U32 i = 2; i < numOut; i++ )
+   {
+      const Point4F tri[3] = { out[0], out[ i - 1 ], out[i] };
+      _addScreenTriangle( tri );
+   }
+}
+
+void SceneOcclusionBuffer::_addScreenTriangle( const Point4F *verts )
+{
+   F32 x[3], y[3], z[3];
+   for ( U32 i = 0; i < 3; i++ )
+   {
+      const F32 invW = 1.0f / verts[i].w;
+      x[i] = ( verts[i].x * invW * 0.5f + 0.5f ) * F32( Width );
+      y[i] = ( 0.5f - verts[i].y * invW * 0.5f ) * F32( Height );
+      z[i] = verts[i].z * invW;
+   }
+
+   F32 area = ( x[1] - x[0] ) * ( y[2] - y[0] ) - ( x[2] - x[0] ) * ( y[1] - y[0] );
+   if ( mFabs( area ) < 0.0001f )
+      return;
+
+   // Only front faces get here, but their screen winding depends
+   // on the handedness of the projection, so order the vertices
+   // to keep the edge tests positive either way.
+   const U32 order[3] = { 0, area > 0.0f ? 1 : 2, area > 0.0f ? 2 : 1 };
+
+   mTriangles.increment();
+   Triangle &tri = mTriangles.last();
+
+   // The depth gradient doesn't depend on the winding.
+   const F32 invArea = 1.0f / area;
+   tri.z0 = z[0];
+   tri.dzdx = ( ( z[1] - z[0] ) * ( y[2] - y[0] ) - ( z[2] - z[0] ) * ( y[1] - y[0] ) ) * invArea;
+   tri.dzdy = ( ( z[2] - z[0] ) * ( x[1] - x[0] ) - ( z[1] - z[0] ) * ( x[2] - x[0] ) ) * invArea;
+
+   for ( U32 i = 0; i < 3; i++ )
+   {
+      tri.x[i] = x[ order[i] ];
+      tri.y[i] = y[ order[i] ];
+   }
+
+   tri.minX = getMax( (S32)mFloor( getMin( getMin( x[0], x[1] ), x[2] ) ), 0 );
+   tri.maxX = getMin( (S32)mCeil( getMax( getMax( x[0], x[1] ), x[2] ) ), (S32)Width - 1 );
+   tri.minY = getMax( (S32)mFloor( getMin( getMin( y[0], y[1] ), y[2] ) ), 0 );
+   tri.maxY = getMin( (S32)mCeil( getMax( getMax( y[0], y[1] ), y[2] ) ), (S32)Height - 1 );
+
+   if ( tri.minX > tri.maxX || tri.minY > tri.maxY )
+   {
+      mTriangles.decrement();
+      return;
+   }
+}
+
+void SceneOcclusionBuffer::_rasterizeTriangle( const Triangle &tri, S32 minY, S32 maxY )
+{
+   // The edge functions and their steps.  An edge is positive
+   // on the side facing the vertex across from it.
+   F32 edgeDx[3], edgeDy[3], edgeC[3];
+   for ( U32 i = 0; i < 3; i++ )
+   {
+      const U32 j = ( i + 1 ) % 3;
+      edgeDx[i] = tri.y[i] - tri.y[j];
+      edgeDy[i] = tri.x[j] - tri.x[i];
+      edgeC[i] = -( edgeDx[i] * tri.x[i] + edgeDy[i] * tri.y[i] );
+   }
+
+   // Start on a 4 pixel boundary so that rows can be
+   // filled with aligned 4 wide stores.
+   const S32 startX = tri.minX & ~3;
+   const F32 px = F32( startX ) + 0.5f;
+
+   for ( S32 y = minY; y <= maxY; y++ )
+   {
+      const F32 py = F32( y ) + 0.5f;
+
+      F32 e0 = edgeDx[0] * px + edgeDy[0] * py + edgeC[0];
+      F32 e1 = edgeDx[1] * px + edgeDy[1] * py + edgeC[1];
+      F32 e2 = edgeDx[2] * px + edgeDy[2] * py + edgeC[2];
+      F32 z = tri.z0 + tri.dzdx * ( px - tri.x[0] ) + tri.dzdy * ( py - tri.y[0] );
+
+      F32 *row = mDepth + y * Width;
+      S32 x = startX;
+
+      #if defined(TORQUE_CPU_X86)
+      if ( mUseSSE )
+      {
+         const __m128 steps = _mm_set_ps( 3.0f, 2.0f, 1.0f, 0.0f );
+         const __m128 zero = _mm_setzero_ps();
+
+         __m128 ve0 = _mm_add_ps( _mm_set1_ps( e0 ), _mm_mul_ps( _mm_set1_ps( edgeDx[0] ), steps ) );
+         __m128 ve1 = _mm_add_ps( _mm_set1_ps( e1 ), _mm_mul_ps( _mm_set1_ps( edgeDx[1] ), steps ) );
+         __m128 ve2 = _mm_add_ps( _mm_set1_ps( e2 ), _mm_mul_ps( _mm_set1_ps( edgeDx[2] ), steps ) );
+         __m128 vz = _mm_add_ps( _mm_set1_ps( z ), _mm_mul_ps( _mm_set1_ps( tri.dzdx ), steps ) );
+
+         const __m128 step0 = _mm_set1_ps( edgeDx[0] * 4.0f );
+         const __m128 step1 = _mm_set1_ps( edgeDx[1] * 4.0f );
+         const __m128 step2 = _mm_set1_ps( edgeDx[2] * 4.0f );
+         const __m128 stepZ = _mm_set1_ps( tri.dzdx * 4.0f );
+
+         for ( ; x <= tri.maxX; x += 4 )
+         {
+            __m128 inside = _mm_and_ps( _mm_cmpge_ps( ve0, zero ), _mm_cmpge_ps( ve1, zero ) );
+            inside = _mm_and_ps( inside, _mm_cmpge_ps( ve2, zero ) );
+
+            if ( _mm_movemask_ps( inside ) )
+            {
+               const __m128 old = _mm_load_ps( row + x );
+               const __m128 depth = _mm_min_ps( old, vz );
+               _mm_store_ps( row + x, _mm_or_ps( _mm_and_ps( inside, depth ), _mm_andnot_ps( inside, old ) ) );
+            }
+
+            ve0 = _mm_add_ps( ve0, step0 );
+            ve1 = _mm_add_ps( ve1, step1 );
+            ve2 = _mm_add_ps( ve2, step2 );
+            vz = _mm_add_ps( vz, stepZ );
+         }
+
+         continue;
+      }
+      #endif
+
+      for ( ; x <= tri.maxX; x++ )
+      {
+         if ( e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f && z < row[x] )
+            row[x] = z;
+
+         e0 += edgeDx[0];
+         e1 += edgeDx[1];
+         e2 += edgeDx[2];
+         z += tri.dzdx;
+      }
+   }
+}
+
+void SceneOcclusionBuffer::_updateTileDepths( U32 band )
+{
+   const U32 startTileY = band * BandHeight / TileSize;
+   const U32 endTileY = startTileY + BandHeight / TileSize;
+
+   for ( U32 ty = startTileY; ty < endTileY; ty++ )
+   {
+      for ( U32 tx = 0; tx < TilesX; tx++ )
+      {
+         F32 farthest = 0.0f;
+
+         const F32 *row = mDepth + ty * TileSize * Width + tx * TileSize;
+         for ( U32 y = 0; y < TileSize; y++, row += Width )
+         {
+            for ( U32 x = 0; x < TileSize; x++ )
+               farthest = getMax( farthest, row[x] );
+         }
+
+         mTileDepth[ ty * TilesX + tx ] = farthest;
+      }
+   }
+}
+
+void SceneOcclusionBuffer::rasterizeBand( U32 band )
+{
+   const S32 bandMinY = band * BandHeight;
+   const S32 bandMaxY = bandMinY + BandHeight - 1;
+
+   F32 *depth = mDepth + bandMinY * Width;
+   for ( U32 i = 0; i < BandHeight * Width; i++ )
+      depth[i] = 1.0f;
+
+   for ( U32 i = 0; i < mTriangles.size(); i++ )
+   {
+      const Triangle &tri = mTriangles[i];
+      if ( tri.maxY < bandMinY || tri.minY > bandMaxY )
+         continue;
+
+      _rasterizeTriangle( tri, getMax( tri.minY, bandMinY ), getMin( tri.maxY, bandMaxY ) );
+   }
+
+   _updateTileDepths( band );
+}
+
+namespace {
+
+/// Spreads the bands of one rasterize() over the thread pool.  Like
+/// the parallel scene prep the main thread claims bands too, and the
+/// job is reference counted so late work items find nothing to do.
+struct OcclusionRasterJob : public ThreadSafeRefCount< OcclusionRasterJob >
+{
+   SceneOcclusionBuffer *mBuffer;
+
+   volatile U32 mNextBand;
+
+   /// Released once for every finished band.
+   Semaphore mBandDone;
+
+   OcclusionRasterJob( SceneOcclusionBuffer *buffer )
+      : mBuffer( buffer ),
+        mNextBand( 0 ),
+        mBandDone( 0 )
+   {
+   }
+
+   void run()
+   {
+      for ( ;; )
+      {
+         U32 band = mNextBand;
+         if ( band >= SceneOcclusionBuffer::NumBands )
+            return;
+
+         if ( !dCompareAndSwap( mNextBand, band, band + 1 ) )
+            continue;
+
+         mBuffer->rasterizeBand( band );
+         mBandDone.release();
+      }
+   }
+};
+
+struct OcclusionRasterWorkItem : public ThreadPool::WorkItem
+{
+   typedef ThreadPool::WorkItem Parent;
+
+   ThreadSafeRef< OcclusionRasterJob > mJob;
+
+   OcclusionRasterWorkItem( OcclusionRasterJob *job )
+      : mJob( job ) {}
+
+protected:
+   virtual void execute()
+   {
+      mJob->run();
+   }
+};
+
+} // namespace {}
+
+void SceneOcclusionBuffer::rasterize()
+{
+   PROFILE_SCOPE( SceneOcclusionBuffer_Rasterize );
+
+   ThreadPool &pool = ThreadPool::GLOBAL();
+
+   // Small frames aren't worth waking up the workers for.
+   if ( pool.getNumThreads() == 0 || mTriangles.size() < 256 )
+   {
+      for ( U32 i = 0; i < NumBands; i++ )
+         rasterizeBand( i );
+      return;
+   }
+
+   ThreadSafeRef< OcclusionRasterJob > job( new OcclusionRasterJob( this ) );
+
+   const U32 numItems = getMin( pool.getNumThreads(), (U32)NumBands - 1 );
+   for ( U32 i = 0; i < numItems; i++ )
+      pool.queueWorkItem( new OcclusionRasterWorkItem( job ) );
+
+   job->run();
+   for ( U32 i = 0; i < NumBands; i++ )
+      job->mBandDone.acquire();
+}
+
+bool SceneOcclusionBuffer::isOccluded( const Box3F &box ) const
+{
+   F32 minX = F32_MAX, minY = F32_MAX, nearest = F32_MAX;
+   F32 maxX = -F32_MAX, maxY = -F32_MAX;
+
+   for ( U32 i = 0; i < 8; i++ )
+   {
+      Point4F corner(   ( i & 1 ) ? box.maxExtents.x : box.minExtents.x,
+                        ( i & 2 ) ? box.maxExtents.y : box.minExtents.y,
+                        ( i & 4 ) ? box.maxExtents.z : box.minExtents.z,
+                        1.0f );
+      mWorldToClip.mul( corner );
+
+      // Anything reaching in front of the near plane is visible.
+      if ( corner.z < 0.0f )
+         return false;
+
+      const F32 invW = 1.0f / corner.w;
+      const F32 x = ( corner.x * invW * 0.5f + 0.5f ) * F32( Width );
+      const F32 y = ( 0.5f - corner.y * invW * 0.5f ) * F32( Height );
+
+      minX = getMin( minX, x );
+      maxX = getMax( maxX, x );
+      minY = getMin( minY, y );
+      maxY = getMax( maxY, y );
+      nearest = getMin( nearest, corner.z * invW );
+   }
+
+   // Every pixel the box touches has to be tested.
+   const S32 x0 = getMax( (S32)mFloor( minX ), 0 );
+   const S32 x1 = getMin( (S32)mFloor( maxX ), (S32)Width - 1 );
+   const S32 y0 = getMax( (S32)mFloor( minY ), 0 );
+   const S32 y1 = getMin( (S32)mFloor( maxY ), (S32)Height - 1 );
+
+   if ( x0 > x1 || y0 > y1 || nearest >= 1.0f )
+      return false;
+
+   for ( S32 ty = y0 / TileSize; ty <= y1 / TileSize; ty++ )
+   {
+      for ( S32 tx = x0 / TileSize; tx <= x1 / TileSize; tx++ )
+      {
+         // Most tiles are entirely in front of the box.
+         if ( nearest > mTileDepth[ ty * TilesX + tx ] )
+            continue;
+
+         const S32 px0 = getMax( x0, tx * (S32)TileSize );
+         const S32 px1 = getMin( x1, tx * (S32)TileSize + (S32)TileSize - 1 );
+         const S32 py0 = getMax( y0, ty * (S32)TileSize );
+         const S32 py1 = getMin( y1, ty * (S32)TileSize + (S32)TileSize - 1 );
+
+         for ( S32 y = py0; y <= py1; y++ )
+         {
+            const F32 *row = mDepth + y * Width;
+            for ( S32 x = px0; x <= px1; x++ )
+            {
+               if ( nearest <= row[x] )
+                  return false;
+            }
+         }
+      }
+   }
+
+   return true;
+}
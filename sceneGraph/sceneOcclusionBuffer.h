@@ -0,0 +1,157 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _SCENEOCCLUSIONBUFFER_H_
+#define _SCENEOCCLUSIONBUFFER_H_
+
+#ifndef _TVECTOR_H_
+#include "core/util/tVector.h"
+#endif
+#ifndef _MMATRIX_H_
+#include "math/mMatrix.h"
+#endif
+#ifndef _MBOX_H_
+#include "math/mBox.h"
+#endif
+
+class Frustum;
+
+
+/// World space triangles which lie on or inside the visible surface of
+/// an occluder.
+///
+/// The triangles are wound so that ( v1 - v0 ) x ( v2 - v0 ) points out
+/// of the surface.  Back faces are culled against the camera position.
+///
+/// @see SceneObject::buildOccluderMesh
+struct OccluderMesh
+{
+   Vector<Point3F> verts;
+
+   /// Three indices per triangle.
+   Vector<U32> indices;
+
+   U32 getTriangleCount() const { return indices.size() / 3; }
+};
+
+
+/// A low resolution software depth buffer which the scene traversal fills
+/// with the occluders in view and then tests the other objects against
+/// before prepRenderImage is called on them.
+///
+/// Occluders are rasterized in horizontal bands on the thread pool with
+/// SSE when the CPU supports it.  Each band then reduces its tiles to the
+/// farthest depth, which lets most tests finish without touching the
+/// individual pixels.
+///
+/// The depth stored is the post projection z, so 0 is the near plane and
+/// 1 is the far plane.
+class SceneOcclusionBuffer
+{
+public:
+
+   enum
+   {
+      Width = 256,
+      Height = 128,
+
+      /// The size of the hierarchical depth tiles in pixels.
+      TileSize = 8,
+      TilesX = Width / TileSize,
+      TilesY = Height / TileSize,
+
+      /// The rows rasterized by one job.
+      BandHeight = 16,
+      NumBands = Height / BandHeight,
+   };
+
+   /// Enables the software occlusion culling in the scene traversal.
+   static bool smEnabled;
+
+   /// The most occluder triangles rasterized per frame.  Occluders
+   /// are added nearest first until this is reached.
+   static S32 smMaxTriangles;
+
+   /// @name Statistics
+   /// The counts from the last frame, exposed as $OcclusionStats::*.
+   /// @{
+   static S32 smNumOccluders;
+   static S32 smNumTriangles;
+   static S32 smNumTested;
+   static S32 smNumCulled;
+   /// @}
+
+   SceneOcclusionBuffer();
+   ~SceneOcclusionBuffer();
+
+   /// Clears the buffer and sets up the projection from a perspective
+   /// frustum.  Returns false for orthographic frustums which aren't
+   /// supported.
+   bool begin( const Frustum &frustum );
+
+   /// Projects and clips the triangles of the mesh.  Returns false
+   /// once the triangle budget is used up.
+   bool addOccluder( const OccluderMesh &mesh );
+
+   /// Rasterizes the occluders added since begin() and builds the
+   /// tile depths.  After this the buffer can be tested from any thread.
+   void rasterize();
+
+   /// Returns true if the whole box is behind the occluders.  Boxes
+   /// which cross the near plane or lie off screen are never occluded.
+   bool isOccluded( const Box3F &box ) const;
+
+   /// Returns the depth of a pixel for debugging and tests.
+   F32 getDepth( U32 x, U32 y ) const { return mDepth[ y * Width + x ]; }
+
+   /// Rasterizes a single band.  This is public for the job
+   /// which spreads the bands over the thread pool.
+   void rasterizeBand( U32 band );
+
+protected:
+
+   /// A projected triangle with the raster setup done once
+   /// for all the bands it touches.
+   struct Triangle
+   {
+      F32 x[3];
+      F32 y[3];
+
+      /// The depth at x[0], y[0] and its screen space gradient.
+      F32 z0;
+      F32 dzdx;
+      F32 dzdy;
+
+      /// The pixel bounds of the triangle.
+      S32 minX, maxX;
+      S32 minY, maxY;
+   };
+
+   Vector<Triangle> mTriangles;
+
+   MatrixF mWorldToClip;
+
+   /// The camera position used to cull back facing occluder triangles.
+   Point3F mCameraPos;
+
+   /// Width * Height depths in an aligned block.
+   F32 *mDepth;
+
+   /// The farthest depth of each tile.
+   F32 mTileDepth[ TilesX * TilesY ];
+
+   /// Set if rasterizeBand() may use SSE.
+   bool mUseSSE;
+
+   void _addClippedTriangle( const Point4F &a, const Point4F &b, const Point4F &c );
+
+   void _addScreenTriangle( const Point4F *verts );
+
+   void _rasterizeTriangle( const Triangle &tri, S32 minY, S32 maxY );
+
+   void _updateTileDepths( U32 band );
+};
+
+#endif // _SCENEOCCLUSIONBUFFER_H_
@@ -34,6 +34,16 @@ void SceneState::setupClipPlanes( ZoneState *rState )
    rState->clipPlanesValid = true;
 }
 
+void SceneState::setupAllClipPlanes()
+{
+   for ( U32 i = 0; i < mZoneStates.size(); i++ )
+   {
+      ZoneState &rState = mZoneStates[i];
+      if ( rState.render && !rState.clipPlanesValid )
+         setupClipPlanes( &rState );
+   }
+}
+
 
 SceneState::SceneState( SceneState *parent,
                         SceneGraph *mgr,
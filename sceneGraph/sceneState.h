@@ -73,6 +73,11 @@ public:
    /// @param   zone   ZoneState to initalize clipping to
    void setupClipPlanes( ZoneState *zone );
 
+   /// Sets up the clipping planes of every rendered zone up front, after
+   /// which isObjectRendered() no longer writes to the zone states and
+   /// can be called from several threads at once.
+   void setupAllClipPlanes();
+
    /// Used to represent a portal which inserts a transformation into the scene.
    struct TransformPortal {
       SceneObject* owner;
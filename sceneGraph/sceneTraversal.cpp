@@ -12,6 +12,11 @@
 #include "gfx/gfxDevice.h"
 #include "T3D/gameConnection.h"
 #include "interior/interiorInstance.h"
+#include "renderInstance/renderPassManager.h"
+#include "platform/threads/threadPool.h"
+#include "sceneGraph/sceneOcclusionBuffer.h"
+#include "ts/tsAnimateBatch.h"
+#include "platform/profiler.h"
 
 namespace {
 
@@ -23,15 +28,18 @@ public:
    Box3F mBox;
    Frustum mFrustum;
 
+   /// The batch culled bounds or NULL to test each object.
+   const SceneCullBounds *mCullBounds;
+
    SceneState *mState;
    Vector<SceneObject*> mList;
 
    void insertObject(SceneObject* obj);
-   void setupClipPlanes(SceneState*);
+   void setupClipPlanes(SceneState*, bool batchCull);
 };
 
 // MM/JF: Added for mirrorSubObject fix.
-void PotentialRenderList::setupClipPlanes(SceneState* state)
+void PotentialRenderList::setupClipPlanes(SceneState* state, bool batchCull)
 {
    mState = state;
 
@@ -54,13 +62,38 @@ void PotentialRenderList::setupClipPlanes(SceneState* state)
       mFrustum.invert();
 
    mBox = mFrustum.getBounds();
+
+   // Cull the whole scene against the frustum in one pass so
+   // that insertObject() only needs to look up the result.
+   mCullBounds = NULL;
+   if ( batchCull )
+   {
+      SceneCullBounds &bounds = gClientSceneGraph->getCullBounds();
+      const Frustum *frustum = &mFrustum;
+      bounds.cull( &frustum, 1 );
+      mCullBounds = &bounds;
+   }
 }
 
 void PotentialRenderList::insertObject(SceneObject* obj)
 {
    // Check to see if we need to render always.
-   if (  obj->isGlobalBounds() || 
-         mFrustum.intersects( obj->getZoneBox() ) )
+   if ( obj->isGlobalBounds() )
+   {
+      mList.push_back(obj);
+      return;
+   }
+
+   // Zone managers can be inserted between cull passes, so
+   // anything without an entry is tested directly.
+   if (  mCullBounds && 
+         !obj->isManagingZones() &&
+         obj->getCullIndex() != 0xFFFFFFFF )
+   {
+      if ( mCullBounds->isVisible( obj, 0 ) )
+         mList.push_back(obj);
+   }
+   else if ( mFrustum.intersects( obj->getZoneBox() ) )
       mList.push_back(obj);
 }
 
@@ -141,8 +174,14 @@ void SceneGraph::_buildSceneTree(   SceneState *state,
    // Ok.  Now we have renderimages for anything north of the object in the
    //  tree.  Create the query polytope, and clip it to the bounding box of
    //  the traversalRoot object.
+   // Only the camera view is batch culled.  Shadow maps and portal
+   // views are traversed many times a frame and each only sees part
+   // of the scene, so culling every object for each of them would
+   // cost more than the per-object tests of their container query.
+   const bool batchCull = SceneGraph::smBatchCull && currDepth == 1 && state->isDiffusePass();
+
    PotentialRenderList prl;
-   prl.setupClipPlanes(state);
+   prl.setupClipPlanes(state, batchCull);
 
    // We only have to clip the mBox field
    AssertFatal(prl.mBox.isOverlapped(pTraversalRoot->getZoneBox()),
@@ -179,10 +218,25 @@ void SceneGraph::_buildSceneTree(   SceneState *state,
       }
    }
 
+   // Only the camera view is occlusion culled, portal views
+   // and the other passes use different projections.
+   const SceneOcclusionBuffer *occlusion = NULL;
+   if ( SceneOcclusionBuffer::smEnabled && currDepth == 1 && state->isDiffusePass() )
+      occlusion = _renderOccluders( state, prl.mList );
+
+   // Zone managers are prepped as the traversal reaches them, the
+   // rest of the objects are collected and prepped in one go.
+   Vector<SceneObject*> prepList;
+   prepList.reserve( prl.mList.size() );
+   mPrepList = &prepList;
+
    for (i = 0; i < prl.mList.size(); i++)
       if( prl.mList[i]->getTraversalState() == SceneObject::Pending )
          treeTraverseVisit(prl.mList[i], state, smStateKey);
 
+   mPrepList = NULL;
+   _prepRenderImages( state, smStateKey, prepList, occlusion );
+
    if (  currDepth < csmMaxTraversalDepth && 
          state->mTransformPortals.size() != 0 ) 
    {
@@ -266,6 +320,8 @@ bool terrCheck(TerrainBlock* pBlock,
                SceneObject*  pObj,
                const Point3F camPos);
 
+static bool isTerrainOccluded(TerrainBlock *terrain, SceneObject *obj, const Point3F &camPos);
+
 void SceneGraph::treeTraverseVisit(SceneObject* obj,
                                    SceneState*  state,
                                    const U32    stateKey)
@@ -296,33 +352,351 @@ void SceneGraph::treeTraverseVisit(SceneObject* obj,
 
    obj->setTraversalState( SceneObject::Done );
 
+   // Objects in a zone must be prepped after its manager has set up
+   // the zone state, so only non-managers can be deferred.
+   if ( mPrepList && !obj->isManagingZones() )
+   {
+      mPrepList->push_back( obj );
+      PROFILE_END();
+      return;
+   }
+
+   if (isTerrainOccluded(getCurrentTerrain(), obj, state->getCameraPosition()))
+   {
+      PROFILE_END();
+      return;
+   }
+
+   PROFILE_START(treeTraverseVisit_prepRenderImage);
+   obj->prepRenderImage(state, stateKey, 0xFFFFFFFF);
+   PROFILE_END();
+
+   PROFILE_END();
+}
+
+//----------------------------------------------------------------------------
+
+/// Returns true if the object is hidden by the terrain.
+static bool isTerrainOccluded( TerrainBlock *terrain, SceneObject *obj, const Point3F &camPos )
+{
    // Cull it, but not if it's too low or there's no terrain to occlude against, or if it's global...
-   if (getCurrentTerrain() != NULL && obj->getZoneBox().minExtents.x > -1e5 && !obj->isGlobalBounds())
+   if ( !terrain || obj->getZoneBox().minExtents.x <= -1e5 || obj->isGlobalBounds() )
+      return false;
+
+   // Only objects that are entirely outside are tested.
+   for ( U32 i = 0; i < obj->getNumCurrZones(); i++ )
+   {
+      if ( obj->getCurrZone( i ) != 0 )
+         return false;
+   }
+
+   return terrCheck( terrain, obj, camPos );
+}
+
+/// Returns true if the object is hidden by the occluders.  Counts the
+/// objects that were actually tested.
+static bool isOcclusionCulled( const SceneOcclusionBuffer *occlusion, SceneObject *obj, U32 &numTested )
+{
+   // The occluders are skipped so that they can't end
+   // up hidden behind their own triangles.
+   if ( !occlusion || obj->isOccluder() || obj->isGlobalBounds() )
+      return false;
+
+   numTested++;
+   return occlusion->isOccluded( obj->getZoneBox() );
+}
+
+namespace {
+
+struct OccluderSortEntry
+{
+   SceneObject *obj;
+   F32 sqDist;
+};
+
+static S32 QSORT_CALLBACK cmpOccluderDist( const void *a, const void *b )
+{
+   const F32 distA = ( (const OccluderSortEntry*)a )->sqDist;
+   const F32 distB = ( (const OccluderSortEntry*)b )->sqDist;
+   return distA < distB ? -1 : ( distA > distB ? 1 : 0 );
+}
+
+} // namespace {}
+
+const SceneOcclusionBuffer* SceneGraph::_renderOccluders( SceneState *state, const Vector<SceneObject*> &objects )
+{
+   PROFILE_SCOPE( SceneGraph_renderOccluders );
+
+   const Point3F &camPos = state->getCameraPosition();
+
+   Vector<OccluderSortEntry> occluders;
+   for ( U32 i = 0; i < objects.size(); i++ )
+   {
+      SceneObject *obj = objects[i];
+      if ( !obj->isOccluder() )
+         continue;
+
+      occluders.increment();
+      occluders.last().obj = obj;
+      occluders.last().sqDist = obj->getZoneBox().getSqDistanceToPoint( camPos );
+   }
+
+   if ( occluders.empty() )
+      return NULL;
+
+   if ( !mOcclusionBuffer )
+      mOcclusionBuffer = new SceneOcclusionBuffer;
+
+   if ( !mOcclusionBuffer->begin( state->getFrustum() ) )
+      return NULL;
+
+   // The nearest occluders hide the most, so they go in
+   // first in case we run out of triangle budget.
+   dQsort( occluders.address(), occluders.size(), sizeof( OccluderSortEntry ), cmpOccluderDist );
+
+   for ( U32 i = 0; i < occluders.size(); i++ )
+   {
+      if ( !mOcclusionBuffer->addOccluder( *occluders[i].obj->getOccluderMesh() ) )
+         break;
+   }
+
+   mOcclusionBuffer->rasterize();
+
+   return mOcclusionBuffer;
+}
+
+namespace {
+
+/// The shared state of one parallel prep.  Workers and the main thread
+/// claim batches of objects from it until none are left.  It is reference
+/// counted so that a work item which only starts after the main thread
+/// has moved on finds no batch and exits without touching the objects.
+struct PrepRenderJob : public ThreadSafeRefCount< PrepRenderJob >
+{
+   SceneState *mState;
+   U32 mStateKey;
+   TerrainBlock *mTerrain;
+   Point3F mCamPos;
+   RenderPassManager *mPass;
+   const SceneOcclusionBuffer *mOcclusion;
+
+   /// The occlusion statistics summed over all batches.
+   volatile U32 mNumTested;
+   volatile U32 mNumCulled;
+
+   SceneObject *const *mObjects;
+   U32 mNumObjects;
+   
+   /// Set for the objects left to prep on the main thread.
+   bool *mMainThreadPrep;
+
+   U32 mBatchSize;
+   U32 mNumBatches;
+   volatile U32 mNextBatch;
+
+   /// Released once for every finished batch.
+   Semaphore mBatchDone;
+
+   PrepRenderJob()
+      : mNumTested( 0 ),
+        mNumCulled( 0 ),
+        mNextBatch( 0 ),
+        mBatchDone( 0 )
+   {
+   }
+
+   bool claimBatch( U32 &outBatch )
+   {
+      for ( ;; )
+      {
+         U32 next = mNextBatch;
+         if ( next >= mNumBatches )
+            return false;
+
+         if ( dCompareAndSwap( mNextBatch, next, next + 1 ) )
+         {
+            outBatch = next;
+            return true;
+         }
+      }
+   }
+
+   void run()
    {
-      bool doTerrCheck = true;
-      SceneObjectRef* pRef = obj->mZoneRefHead;
-      while (pRef != NULL)
+      U32 batch;
+      while ( claimBatch( batch ) )
       {
-         if (pRef->zone != 0)
+         mPass->bindPrepSlot( batch );
+
+         U32 numTested = 0;
+         U32 numCulled = 0;
+
+         const U32 start = batch * mBatchSize;
+         const U32 end = getMin( start + mBatchSize, mNumObjects );
+         for ( U32 i = start; i < end; i++ )
          {
-            doTerrCheck = false;
-            break;
+            SceneObject *obj = mObjects[i];
+            bool prep = !isTerrainOccluded( mTerrain, obj, mCamPos );
+
+            if ( prep && isOcclusionCulled( mOcclusion, obj, numTested ) )
+            {
+               numCulled++;
+               prep = false;
+            }
+
+            if ( prep && obj->isPrepRenderImageThreadSafe() )
+            {
+               obj->prepRenderImage( mState, mStateKey, 0xFFFFFFFF );
+               prep = false;
+            }
+
+            mMainThreadPrep[i] = prep;
          }
-         pRef = pRef->nextInObj;
+
+         mPass->unbindPrepSlot( batch );
+
+         if ( numTested )
+         {
+            dFetchAndAdd( mNumTested, numTested );
+            dFetchAndAdd( mNumCulled, numCulled );
+         }
+
+         mBatchDone.release();
       }
+   }
+};
+
+struct PrepRenderWorkItem : public ThreadPool::WorkItem
+{
+   typedef ThreadPool::WorkItem Parent;
+
+   ThreadSafeRef< PrepRenderJob > mJob;
+
+   PrepRenderWorkItem( PrepRenderJob *job )
+      : mJob( job ) {}
+
+protected:
+   virtual void execute()
+   {
+      mJob->run();
+   }
+};
 
-      if (doTerrCheck == true && terrCheck(getCurrentTerrain(), obj, state->getCameraPosition()) == true)
+} // namespace {}
+
+void SceneGraph::_prepRenderImages(   SceneState *state, 
+                                       const U32 stateKey, 
+                                       const Vector<SceneObject*> &objects,
+                                       const SceneOcclusionBuffer *occlusion )
+{
+   PROFILE_SCOPE( SceneGraph_prepRenderImages );
+
+   TerrainBlock *terrain = getCurrentTerrain();
+   const Point3F &camPos = state->getCameraPosition();
+
+   // Animate the shapes up front so that their node
+   // transforms are evaluated on the thread pool.
+   if ( TSAnimateBatch::smParallel )
+   {
+      static TSAnimateBatch sAnimateBatch;
+
+      PROFILE_START(SceneGraph_prepAnimation);
+      for ( U32 i = 0; i < objects.size(); i++ )
+         objects[i]->prepAnimation( state, &sAnimateBatch );
+      sAnimateBatch.run();
+      PROFILE_END();
+   }
+
+   ThreadPool &pool = ThreadPool::GLOBAL();
+   const U32 batchSize = getMax( RenderPassManager::smParallelPrepBatchSize, 1 );
+   const U32 numBatches = ( objects.size() + batchSize - 1 ) / batchSize;
+
+   if (  !RenderPassManager::smParallelPrep ||
+         numBatches < 2 ||
+         pool.getNumThreads() == 0 )
+   {
+      U32 numTested = 0;
+      U32 numCulled = 0;
+
+      for ( U32 i = 0; i < objects.size(); i++ )
       {
+         if ( isTerrainOccluded( terrain, objects[i], camPos ) )
+            continue;
+
+         if ( isOcclusionCulled( occlusion, objects[i], numTested ) )
+         {
+            numCulled++;
+            continue;
+         }
+
+         PROFILE_START(treeTraverseVisit_prepRenderImage);
+         objects[i]->prepRenderImage( state, stateKey, 0xFFFFFFFF );
          PROFILE_END();
-         return;
       }
+
+      if ( occlusion )
+      {
+         SceneOcclusionBuffer::smNumTested = numTested;
+         SceneOcclusionBuffer::smNumCulled = numCulled;
+      }
+
+      return;
    }
 
-   PROFILE_START(treeTraverseVisit_prepRenderImage);
-   obj->prepRenderImage(state, stateKey, 0xFFFFFFFF);
+   RenderPassManager *pass = state->getRenderPass();
+
+   // Objects which prep on the workers call isObjectRendered(),
+   // which would otherwise set up the zone clip planes lazily.
+   state->setupAllClipPlanes();
+
+   Vector<bool> mainThreadPrep;
+   mainThreadPrep.setSize( objects.size() );
+
+   ThreadSafeRef< PrepRenderJob > job( new PrepRenderJob );
+   job->mState = state;
+   job->mStateKey = stateKey;
+   job->mTerrain = terrain;
+   job->mCamPos = camPos;
+   job->mPass = pass;
+   job->mOcclusion = occlusion;
+   job->mObjects = objects.address();
+   job->mNumObjects = objects.size();
+   job->mMainThreadPrep = mainThreadPrep.address();
+   job->mBatchSize = batchSize;
+   job->mNumBatches = numBatches;
+
+   pass->beginParallelPrep( numBatches );
+
+   // The main thread works on the batches too, so only wake
+   // up as many workers as there are batches left for them.
+   const U32 numItems = getMin( pool.getNumThreads(), numBatches - 1 );
+   for ( U32 i = 0; i < numItems; i++ )
+      pool.queueWorkItem( new PrepRenderWorkItem( job ) );
+
+   PROFILE_START(SceneGraph_prepRenderImages_Parallel);
+   job->run();
+   for ( U32 i = 0; i < numBatches; i++ )
+      job->mBatchDone.acquire();
    PROFILE_END();
 
-   PROFILE_END();
+   pass->endParallelPrep();
+
+   if ( occlusion )
+   {
+      SceneOcclusionBuffer::smNumTested = job->mNumTested;
+      SceneOcclusionBuffer::smNumCulled = job->mNumCulled;
+   }
+
+   // Finish the objects that have to be prepped on the main thread.
+   for ( U32 i = 0; i < objects.size(); i++ )
+   {
+      if ( mainThreadPrep[i] )
+      {
+         PROFILE_START(treeTraverseVisit_prepRenderImage);
+         objects[i]->prepRenderImage( state, stateKey, 0xFFFFFFFF );
+         PROFILE_END();
+      }
+   }
 }
 
 bool terrCheck(TerrainBlock* pBlock,
@@ -95,6 +95,7 @@ class Marker : public SceneObject
    // Rendering
   protected:
    bool prepRenderImage(SceneState *state, const U32 stateKey, const U32 startZone, const bool modifyBaseZoneState);
+   bool isPrepRenderImageThreadSafe() const { return true; }
    void renderObject(ObjectRenderInst *ri, SceneState *state, BaseMatInstance* overrideMat);
 
   protected:
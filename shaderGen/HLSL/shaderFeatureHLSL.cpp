@@ -13,6 +13,7 @@
 #include "materials/matInstance.h"
 #include "materials/processedMaterial.h"
 #include "materials/materialFeatureTypes.h"
+#include "materials/sceneData.h"
 #include "core/util/autoPtr.h"
 
 #include "lighting/advanced/advancedLightBinManager.h"
@@ -1852,4 +1853,153 @@ void FoliageFeatureHLSL::processVert( Vector<ShaderComponent*> &componentList,
 void FoliageFeatureHLSL::determineFeature( Material *material, const GFXVertexFormat *vertexFormat, U32 stageNum, const FeatureType &type, const FeatureSet &features, MaterialFeatureData *outFeatureData )
 {      
    outFeatureData->features.addFeature( type );
-}
\ No newline at end of file
+}
+
+//****************************************************************************
+// InstancingFeatureHLSL
+//****************************************************************************
+
+void InstancingFeatureHLSL::processVert( Vector<ShaderComponent*> &componentList, 
+                                         const MaterialFeatureData &fd )
+{
+   // The transform rows are named by the vertex input
+   // connector from the GFXVertexInstanceTransform semantics.
+   Var *row0 = (Var*)LangElement::find( "tcINSTTRANS0" );
+   Var *row1 = (Var*)LangElement::find( "tcINSTTRANS1" );
+   Var *row2 = (Var*)LangElement::find( "tcINSTTRANS2" );
+   if ( !row0 || !row1 || !row2 )
+   {
+      output = NULL;
+      return;
+   }
+
+   Var *inPosition = (Var*)LangElement::find( "inPosition" );
+   if ( !inPosition )
+      inPosition = (Var*)LangElement::find( "position" );
+
+   MultiLine *meta = new MultiLine;
+
+   Var *instTrans = new Var;
+   instTrans->setType( "float3x4" );
+   instTrans->setName( "instTrans" );
+   LangElement *instTransDecl = new DecOp( instTrans );
+   meta->addStatement( new GenOp( "   @ = float3x4( @, @, @ );\r\n", instTransDecl, row0, row1, row2 ) );
+
+   // Everything after this point sees a world space vertex 
+   // which is why the batch is rendered with an identity 
+   // object transform.
+   meta->addStatement( new GenOp( "   @.xyz = mul( @, float4( @.xyz, 1 ) );\r\n", inPosition, instTrans, inPosition ) );
+
+   const char *tangentFrame[] = { "normal", "T", "B" };
+   for ( U32 i=0; i < 3; i++ )
+   {
+      Var *vec = (Var*)LangElement::find( tangentFrame[i] );
+      if ( vec )
+         meta->addStatement( new GenOp( "   @ = normalize( mul( (float3x3)@, @ ) );\r\n", vec, instTrans, vec ) );
+   }
+
+   output = meta;
+}
+
+void InstancingFeatureHLSL::determineFeature( Material *material, const GFXVertexFormat *vertexFormat, U32 stageNum, const FeatureType &type, const FeatureSet &features, MaterialFeatureData *outFeatureData )
+{
+   // This is only ever enabled by request and is
+   // filtered out again if it wasn't requested.
+   outFeatureData->features.addFeature( type );
+}
+
+//****************************************************************************
+// HardwareSkinningFeatureHLSL
+//****************************************************************************
+
+/// Uploads the bone palette from the scene data.
+class HardwareSkinningConstHandles : public ShaderFeatureConstHandles
+{
+public:
+
+   GFXShaderConstHandle *mBoneTransformsSC;
+
+   HardwareSkinningConstHandles( GFXShader *shader )
+   {
+      mBoneTransformsSC = shader->getShaderConstHandle( ShaderGenVars::boneTransforms );
+   }
+
+   virtual void setConsts( SceneState *state, 
+                           const SceneGraphData &sgData,
+                           GFXShaderConstBuffer *buffer )
+   {
+      if ( !mBoneTransformsSC->isValid() )
+         return;
+
+      // Without a palette the vertices are already in object space and
+      // bound to the first bone, as with the static meshes of a skinned
+      // shape, so the identity transform leaves them alone.
+      if ( sgData.boneTransforms )
+         buffer->set( mBoneTransformsSC, sgData.boneTransforms, getMin( sgData.boneCount, (U32)SceneGraphData::MaxBoneTransforms ), GFXSCT_Float4x4 );
+      else
+         buffer->set( mBoneTransformsSC, MatrixF::Identity, GFXSCT_Float4x4 );
+   }
+};
+
+void HardwareSkinningFeatureHLSL::processVert( Vector<ShaderComponent*> &componentList, 
+                                               const MaterialFeatureData &fd )
+{
+   // The indices and weights are named by the vertex
+   // input connector from the GFXSemantic names.
+   Var *indices = (Var*)LangElement::find( "tcBLENDINDICES" );
+   Var *weights = (Var*)LangElement::find( "tcBLENDWEIGHT" );
+   if ( !indices || !weights )
+   {
+      output = NULL;
+      return;
+   }
+
+   Var *inPosition = (Var*)LangElement::find( "inPosition" );
+   if ( !inPosition )
+      inPosition = (Var*)LangElement::find( "position" );
+
+   Var *boneTransforms = new Var;
+   boneTransforms->setType( "float4x4" );
+   boneTransforms->setName( "boneTransforms" );
+   boneTransforms->uniform = true;
+   boneTransforms->constSortPos = cspPrimitive;
+   boneTransforms->arraySize = SceneGraphData::MaxBoneTransforms;
+
+   MultiLine *meta = new MultiLine;
+
+   Var *skinTrans = new Var;
+   skinTrans->setType( "float4x4" );
+   skinTrans->setName( "skinTrans" );
+   LangElement *skinTransDecl = new DecOp( skinTrans );
+
+   // Blend the bones by their weights.  Unused weights are zero.
+   meta->addStatement( new GenOp( "   @ = @[ (int)@.x ] * @.x;\r\n", skinTransDecl, boneTransforms, indices, weights ) );
+   meta->addStatement( new GenOp( "   @ += @[ (int)@.y ] * @.y;\r\n", skinTrans, boneTransforms, indices, weights ) );
+   meta->addStatement( new GenOp( "   @ += @[ (int)@.z ] * @.z;\r\n", skinTrans, boneTransforms, indices, weights ) );
+   meta->addStatement( new GenOp( "   @ += @[ (int)@.w ] * @.w;\r\n", skinTrans, boneTransforms, indices, weights ) );
+
+   // Everything after this point sees the skinned vertex
+   // in object space just like with CPU skinning.
+   meta->addStatement( new GenOp( "   @.xyz = mul( @, float4( @.xyz, 1 ) ).xyz;\r\n", inPosition, skinTrans, inPosition ) );
+
+   const char *tangentFrame[] = { "normal", "T", "B" };
+   for ( U32 i=0; i < 3; i++ )
+   {
+      Var *vec = (Var*)LangElement::find( tangentFrame[i] );
+      if ( vec )
+         meta->addStatement( new GenOp( "   @ = normalize( mul( (float3x3)@, @ ) );\r\n", vec, skinTrans, vec ) );
+   }
+
+   output = meta;
+}
+
+void HardwareSkinningFeatureHLSL::determineFeature( Material *material, const GFXVertexFormat *vertexFormat, U32 stageNum, const FeatureType &type, const FeatureSet &features, MaterialFeatureData *outFeatureData )
+{
+   if ( vertexFormat->hasBlendIndices() )
+      outFeatureData->features.addFeature( type );
+}
+
+ShaderFeatureConstHandles* HardwareSkinningFeatureHLSL::createConstHandles( GFXShader *shader )
+{
+   return new HardwareSkinningConstHandles( shader );
+}
@@ -540,4 +540,54 @@ public:
                                   MaterialFeatureData *outFeatureData );
 };
 
+/// Moves the input vertex into world space using the per-instance
+/// transform stream so that a batch of instances can be drawn with
+/// an identity object transform.
+/// @see GFXVertexInstanceTransform
+class InstancingFeatureHLSL : public ShaderFeatureHLSL
+{
+public:
+
+   virtual void processVert( Vector<ShaderComponent*> &componentList,
+      const MaterialFeatureData &fd );
+
+   virtual String getName()
+   {
+      return "Hardware Instancing";
+   }
+
+   virtual void determineFeature( Material *material, 
+                                  const GFXVertexFormat *vertexFormat,
+                                  U32 stageNum,
+                                  const FeatureType &type,
+                                  const FeatureSet &features,
+                                  MaterialFeatureData *outFeatureData );
+};
+
+/// Blends the vertex position, normal and tangent by the 
+/// bone palette using the bone indices and weights in the
+/// vertex format.
+/// @see MFT_HardwareSkinning
+class HardwareSkinningFeatureHLSL : public ShaderFeatureHLSL
+{
+public:
+
+   virtual void processVert( Vector<ShaderComponent*> &componentList,
+      const MaterialFeatureData &fd );
+
+   virtual String getName()
+   {
+      return "Hardware Skinning";
+   }
+
+   virtual void determineFeature( Material *material, 
+                                  const GFXVertexFormat *vertexFormat,
+                                  U32 stageNum,
+                                  const FeatureType &type,
+                                  const FeatureSet &features,
+                                  MaterialFeatureData *outFeatureData );
+
+   virtual ShaderFeatureConstHandles* createConstHandles( GFXShader *shader );
+};
+
 #endif // _SHADERGEN_HLSL_SHADERFEATUREHLSL_H_
@@ -75,6 +75,8 @@ void ShaderGenHLSLInit::initShaderGen( ShaderGen *shaderGen )
    FEATUREMGR->registerFeature( MFT_IsSinglePassParaboloid, new NamedFeatureHLSL( "Single Pass Paraboloid" ) );
 
    FEATUREMGR->registerFeature( MFT_Foliage, new FoliageFeatureHLSL );
+   FEATUREMGR->registerFeature( MFT_UseInstancing, new InstancingFeatureHLSL );
+   FEATUREMGR->registerFeature( MFT_HardwareSkinning, new HardwareSkinningFeatureHLSL );
 }
 
 static ShaderGenHLSLInit p_HLSLInit;
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include "shaderGen/featureMgr.h"
 #include "shaderGen/shaderOp.h"
 #include "gfx/gfxDevice.h"
+#include "gfx/gfxShaderCache.h"
 #include "core/memVolume.h"
 
 
@@ -98,6 +99,10 @@ void ShaderGen::initShaderGen()
 
    // Delete the auto-generated conditioner include file.
    Torque::FS::Remove( "shadergen:/" + ConditionerFeature::ConditionerIncludeFileName );
+
+   // Start compiling the shaders used in previous runs.
+   GFXShaderCache::loadManifest();
+   GFXShaderCache::startWarmUp();
 }
 
 void ShaderGen::generateShader( const MaterialFeatureData &featureData,
@@ -130,7 +135,8 @@ void ShaderGen::generateShader( const MaterialFeatureData &featureData,
    // this needs to change - need to optimize down to ps v.1.1
    *pixVersion = GFX->getPixelShaderVersion();
    
-   if ( !Con::getBoolVariable( "ShaderGen::GenNewShaders", true ) )
+   if (  !Con::getBoolVariable( "ShaderGen::GenNewShaders", true ) ||
+         _hasCachedSource( cacheName, vertShaderName, pixShaderName ) )
    {
       // If we are not regenerating the shader we will return here.
       // But we must fill in the shader macros first!
@@ -175,6 +181,60 @@ void ShaderGen::generateShader( const MaterialFeatureData &featureData,
    LangElement::deleteElements();
 }
 
+bool ShaderGen::_hasCachedSource( const String &cacheKey, const char *vertFile, const char *pixFile )
+{
+   // Only shipping builds reuse by default, as the source
+   // is stale as soon as a shader feature changes.
+#ifdef TORQUE_SHIPPING
+   const bool reuseDefault = true;
+#else
+   const bool reuseDefault = false;
+#endif
+
+   if (  !GFXShaderCache::isEnabled() ||
+         !Con::getBoolVariable( "ShaderGen::ReuseCachedShaders", reuseDefault ) )
+      return false;
+
+   return _isInManifest( cacheKey, vertFile, pixFile );
+}
+
+bool ShaderGen::_isInManifest( const String &cacheKey, const char *vertFile, const char *pixFile )
+{
+   const GFXShaderCache::ManifestEntry *entry = GFXShaderCache::findInManifest( cacheKey );
+   if ( !entry || entry->vertHash == 0 || entry->pixHash == 0 )
+      return false;
+
+   return   GFXShaderCache::hashFile( vertFile ) == entry->vertHash &&
+            GFXShaderCache::hashFile( pixFile ) == entry->pixHash;
+}
+
+void ShaderGen::_addToManifest( const String &cacheKey, const char *vertFile, const char *pixFile, F32 pixVersion, const Vector<GFXShaderMacro> &macros )
+{
+   if ( !GFXShaderCache::isEnabled() )
+      return;
+
+   GFXShaderCache::ManifestEntry entry;
+   entry.key = cacheKey;
+   entry.vertFile = Torque::Path( vertFile );
+   entry.pixFile = Torque::Path( pixFile );
+   entry.pixVersion = pixVersion;
+   entry.macros = macros;
+   entry.vertHash = GFXShaderCache::hashFile( vertFile );
+   entry.pixHash = GFXShaderCache::hashFile( pixFile );
+
+   if ( entry.vertHash == 0 || entry.pixHash == 0 )
+      return;
+
+   // Skip it if nothing changed since the last run.
+   const GFXShaderCache::ManifestEntry *existing = GFXShaderCache::findInManifest( cacheKey );
+   if (  existing && 
+         existing->vertHash == entry.vertHash && 
+         existing->pixHash == entry.pixHash )
+      return;
+
+   GFXShaderCache::addToManifest( entry );
+}
+
 void ShaderGen::_init()
 {
    _createComponents();
@@ -407,15 +467,18 @@ void ShaderGen::_printPixShader( Stream &stream )
    mPrinter->printPixelShaderCloser(stream);
 }
 
-GFXShader* ShaderGen::getShader( const MaterialFeatureData &featureData, const GFXVertexFormat *vertexFormat, const Vector<GFXShaderMacro> *macros )
+GFXShader* ShaderGen::getShader( const MaterialFeatureData &featureData, const GFXVertexFormat *vertexFormat, const Vector<GFXShaderMacro> *macros, bool *outPending )
 {
    PROFILE_SCOPE( ShaderGen_GetShader );
 
    const FeatureSet &features = featureData.codify();
 
    // Build a description string from the features
-   // and vertex format combination ( and macros ).
+   // and vertex format combination ( and macros ).  The
+   // device type and shader model are included so that
+   // the generated files can be cached between runs.
    String shaderDescription = vertexFormat->getDescription() + features.getDescription();
+   shaderDescription += String::ToString( "%d %.1f", GFX->getAdapterType(), GFX->getPixelShaderVersion() );
    if ( macros && !macros->empty() )
    {
       String macroStr;
@@ -439,15 +502,63 @@ GFXShader* ShaderGen::getShader( const MaterialFeatureData &featureData, const G
    if ( match )
       return match;
 
-   // if not, then create it
    char vertFile[256];
    char pixFile[256];
    F32  pixVersion;
-
    Vector<GFXShaderMacro> shaderMacros;
-   if ( macros )
-      shaderMacros.merge( *macros );
-   generateShader( featureData, vertFile, pixFile, &pixVersion, vertexFormat, cacheKey, shaderMacros );
+
+   PendingShaderMap::Iterator pending = mPendingShaders.find( cacheKey );
+   if ( pending != mPendingShaders.end() )
+   {
+      // If the compile isn't done yet then keep waiting.  A caller
+      // which can't wait just compiles it again itself.
+      if ( outPending && !pending->value.compile->isDone() )
+      {
+         *outPending = true;
+         return NULL;
+      }
+
+      // The source was generated when the compile was queued.
+      const GFXShaderCache::ManifestEntry &entry = pending->value.entry;
+      dStrncpy( vertFile, entry.vertFile.getFullPath().c_str(), sizeof( vertFile ) );
+      dStrncpy( pixFile, entry.pixFile.getFullPath().c_str(), sizeof( pixFile ) );
+      vertFile[ sizeof( vertFile ) - 1 ] = 0;
+      pixFile[ sizeof( pixFile ) - 1 ] = 0;
+      pixVersion = entry.pixVersion;
+      shaderMacros = entry.macros;
+
+      mPendingShaders.erase( pending );
+   }
+   else
+   {
+      // if not, then create it
+      if ( macros )
+         shaderMacros.merge( *macros );
+      generateShader( featureData, vertFile, pixFile, &pixVersion, vertexFormat, cacheKey, shaderMacros );
+
+      // Compile it on the thread pool if the caller can wait.  Only
+      // the compile is moved off the main thread, as generating
+      // the source uses the state of this singleton.  If this exact
+      // source was compiled by a previous run then the programs are
+      // in the disk cache and creating it now is only a load.
+      if (  outPending && 
+            GFXShaderCache::canCompileAsync() &&
+            !_isInManifest( cacheKey, vertFile, pixFile ) )
+      {
+         PendingShader &newPending = mPendingShaders[cacheKey];
+         newPending.entry.key = cacheKey;
+         newPending.entry.vertFile = Torque::Path( vertFile );
+         newPending.entry.pixFile = Torque::Path( pixFile );
+         newPending.entry.pixVersion = pixVersion;
+         newPending.entry.macros = shaderMacros;
+         newPending.entry.vertHash = GFXShaderCache::hashFile( newPending.entry.vertFile );
+         newPending.entry.pixHash = GFXShaderCache::hashFile( newPending.entry.pixFile );
+         newPending.compile = GFXShaderCache::compileAsync( newPending.entry );
+
+         *outPending = true;
+         return NULL;
+      }
+   }
 
    GFXShader *shader = GFX->createShader();
    if ( !shader->init( vertFile, pixFile, pixVersion, shaderMacros ) )
@@ -461,6 +572,9 @@ GFXShader* ShaderGen::getShader( const MaterialFeatureData &featureData, const G
    shader->mVertexFormat = vertexFormat;
    mProcShaders[cacheKey] = shader;
 
+   // Remember it so the next run can warm it up.
+   _addToManifest( cacheKey, vertFile, pixFile, pixVersion, shaderMacros );
+
    return shader;
 }
 
@@ -469,4 +583,8 @@ void ShaderGen::flushProceduralShaders()
    // The shaders are reference counted, so we
    // just need to clear the map.
    mProcShaders.clear();  
+
+   // The source of the pending shaders is stale now.  Their
+   // compiles still finish, but nothing will wait for them.
+   mPendingShaders.clear();
 }
@@ -26,6 +26,9 @@
 #ifndef _VOLUME_H_
 #include "core/volume.h"
 #endif
+#ifndef _GFXSHADERCACHE_H_
+#include "gfx/gfxShaderCache.h"
+#endif
 
 
 /// Base class used by shaderGen to be API agnostic.  Subclasses implement the various methods
@@ -135,7 +138,15 @@ public:
                         Vector<GFXShaderMacro> &macros );
 
    // Returns a shader that implements the features listed by dat.
-   GFXShader* getShader( const MaterialFeatureData &dat, const GFXVertexFormat *vertexFormat, const Vector<GFXShaderMacro> *macros );
+   //
+   // If outPending is passed and the shader needs to be compiled, the
+   // compile is queued on the thread pool and NULL is returned with
+   // outPending set.  Calling it again returns the shader once the
+   // compile is done.
+   GFXShader* getShader( const MaterialFeatureData &dat, const GFXVertexFormat *vertexFormat, const Vector<GFXShaderMacro> *macros, bool *outPending = NULL );
+
+   /// Returns the number of shaders compiling on the thread pool.
+   U32 getPendingShaderCount() const { return mPendingShaders.size(); }
 
    // This will delete all of the procedural shaders that we have.  Used to regenerate shaders when
    // the ShaderFeatures have changed (due to lighting system change, or new plugin)
@@ -174,6 +185,17 @@ protected:
    typedef Map<String, GFXShaderRef> ShaderMap;
    ShaderMap mProcShaders;
 
+   /// A generated shader which is compiling on the thread pool.
+   struct PendingShader
+   {
+      GFXShaderCache::ManifestEntry entry;
+      GFXShaderCache::AsyncCompileRef compile;
+   };
+
+   /// Map of cache string -> shaders which are compiling.
+   typedef Map<String, PendingShader> PendingShaderMap;
+   PendingShaderMap mPendingShaders;
+
    ShaderGen();
 
    bool _handleGFXEvent(GFXDevice::GFXDeviceEventType event);
@@ -200,6 +222,17 @@ protected:
 
    void _processVertFeatures( Vector<GFXShaderMacro> &macros, bool macrosOnly = false );
    void _printVertShader( Stream &stream );
+
+   /// Returns true if the shader files for the key were generated by a
+   /// previous run and haven't been changed since.
+   bool _hasCachedSource( const String &cacheKey, const char *vertFile, const char *pixFile );
+
+   /// Returns true if the manifest has an entry for the key with 
+   /// the same source, so its programs are likely in the disk cache.
+   bool _isInManifest( const String &cacheKey, const char *vertFile, const char *pixFile );
+
+   /// Adds a new shader to the shader cache manifest.
+   void _addToManifest( const String &cacheKey, const char *vertFile, const char *pixFile, F32 pixVersion, const Vector<GFXShaderMacro> &macros );
 };
 
 
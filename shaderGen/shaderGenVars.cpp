@@ -30,6 +30,7 @@ const String ShaderGenVars::texMat("$texMat");
 const String ShaderGenVars::accumTime("$accumTime");
 const String ShaderGenVars::minnaertConstant("$minnaertConstant");
 const String ShaderGenVars::subSurfaceParams("$subSurfaceParams");
+const String ShaderGenVars::boneTransforms("$boneTransforms");
 
 const String ShaderGenVars::lightPosition("$inLightPos");
 const String ShaderGenVars::lightDiffuse("$inLightColor"); 
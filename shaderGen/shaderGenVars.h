@@ -39,6 +39,7 @@ struct ShaderGenVars
    const static String accumTime;
    const static String minnaertConstant;
    const static String subSurfaceParams;
+   const static String boneTransforms;
 
    // Lighting parameters used by the default
    // RTLighting shader feature.
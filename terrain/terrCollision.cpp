@@ -570,22 +570,16 @@ bool TerrainBlock::buildPolyList(AbstractPolyList* polyList, const Box3F &box, c
 
 //----------------------------------------------------------------------------
 
-static F32 calcInterceptV(F32 vStart, F32 invDeltaV, F32 intercept)
+/// A zero invDeltaV marks a ray parallel to the axis, which never
+/// crosses an intercept.
+static inline F32 calcIntercept(F32 vStart, F32 invDeltaV, F32 intercept)
 {
-   return (intercept - vStart) * invDeltaV;
-}
+   if (invDeltaV == 0)
+      return MAX_FLOAT;
 
-static F32 calcInterceptNone(F32, F32, F32)
-{
-   return MAX_FLOAT;
+   return (intercept - vStart) * invDeltaV;
 }
 
-static F32 (*calcInterceptX)(F32, F32, F32);
-static F32 (*calcInterceptY)(F32, F32, F32);
-
-static U32 lineCount;
-static Point3F lineStart, lineEnd;
-
 bool TerrainBlock::castRay(const Point3F &start, const Point3F &end, RayInfo *info)
 {
    if ( !castRayI(start, end, info, false) )
@@ -604,10 +598,8 @@ bool TerrainBlock::castRay(const Point3F &start, const Point3F &end, RayInfo *in
 
 bool TerrainBlock::castRayI(const Point3F &start, const Point3F &end, RayInfo *info, bool collideEmpty)
 {
-   lineCount = 0;
-   lineStart = start;
-   lineEnd = end;
-
+   // No static state in here; the scene traversal casts
+   // occlusion rays from several threads at once.
    info->object = this;
 
    if(start.x == end.x && start.y == end.y)
@@ -640,14 +632,12 @@ bool TerrainBlock::castRayI(const Point3F &start, const Point3F &end, RayInfo *i
    F32 invDeltaX;
    if(pEnd.x == pStart.x)
    {
-      calcInterceptX = calcInterceptNone;
       invDeltaX = 0;
       dx = 0;
    }
    else
    {
       invDeltaX = 1 / (pEnd.x - pStart.x);
-      calcInterceptX = calcInterceptV;
       if(pEnd.x < pStart.x)
          dx = -1;
       else
@@ -657,14 +647,12 @@ bool TerrainBlock::castRayI(const Point3F &start, const Point3F &end, RayInfo *i
    F32 invDeltaY;
    if(pEnd.y == pStart.y)
    {
-      calcInterceptY = calcInterceptNone;
       invDeltaY = 0;
       dy = 0;
    }
    else
    {
       invDeltaY = 1 / (pEnd.y - pStart.y);
-      calcInterceptY = calcInterceptV;
       if(pEnd.y < pStart.y)
          dy = -1;
       else
@@ -677,8 +665,8 @@ bool TerrainBlock::castRayI(const Point3F &start, const Point3F &end, RayInfo *i
    F32 startT = 0;
    for(;;)
    {
-      F32 nextXInt = calcInterceptX(pStart.x, invDeltaX, (F32)(blockX + (dx == 1)));
-      F32 nextYInt = calcInterceptY(pStart.y, invDeltaY, (F32)(blockY + (dy == 1)));
+      F32 nextXInt = calcIntercept(pStart.x, invDeltaX, (F32)(blockX + (dx == 1)));
+      F32 nextYInt = calcIntercept(pStart.y, invDeltaY, (F32)(blockY + (dy == 1)));
 
       F32 intersectT = 1;
 
@@ -729,6 +717,9 @@ struct TerrLOSStackNode
    U32 level;
 };
 
+/// Enough for a 2^MaxGridLevels square heightmap.
+static const U32 MaxGridLevels = 16;
+
 bool TerrainBlock::castRayBlock( const Point3F &pStart, 
                                  const Point3F &pEnd, 
                                  const Point2I &aBlockPos, 
@@ -746,8 +737,8 @@ bool TerrainBlock::castRayBlock( const Point3F &pStart,
 
    F32 invBlockSize = 1 / F32( BlockSquareWidth );
 
-   static Vector<TerrLOSStackNode> stack;
-   stack.setSize( GridLevels * 3 + 1 );
+   TerrLOSStackNode stack[ MaxGridLevels * 3 + 1 ];
+   AssertFatal( GridLevels <= MaxGridLevels, "TerrainBlock::castRayBlock() - Too many grid levels!" );
    U32 stackSize = 1;
 
    stack[0].startT = aStartT;
@@ -760,7 +751,7 @@ bool TerrainBlock::castRayBlock( const Point3F &pStart,
 
    while(stackSize--)
    {
-      TerrLOSStackNode *sn = stack.address() + stackSize;
+      TerrLOSStackNode *sn = stack + stackSize;
       U32 level  = sn->level;
       F32 startT = sn->startT;
       F32 endT   = sn->endT;
@@ -869,9 +860,9 @@ bool TerrainBlock::castRayBlock( const Point3F &pStart,
       }
       int subSqWidth = 1 << (level - 1);
       F32 xIntercept = (blockPos.x + subSqWidth) * invBlockSize;
-      F32 xInt = calcInterceptX(pStart.x, invDeltaX, xIntercept);
+      F32 xInt = calcIntercept(pStart.x, invDeltaX, xIntercept);
       F32 yIntercept = (blockPos.y + subSqWidth) * invBlockSize;
-      F32 yInt = calcInterceptY(pStart.y, invDeltaY, yIntercept);
+      F32 yInt = calcIntercept(pStart.y, invDeltaY, yIntercept);
 
       F32 startX = startT * (pEnd.x - pStart.x) + pStart.x;
       F32 startY = startT * (pEnd.y - pStart.y) + pStart.y;
@@ -28,6 +28,7 @@
 #include "core/resourceManager.h"
 #include "T3D/physics/physicsPlugin.h"
 #include "T3D/physics/physicsStatic.h"
+#include "sceneGraph/sceneOcclusionBuffer.h"
 
 
 using namespace Torque;
@@ -231,6 +232,7 @@ void TerrainBlock::setFile( Resource<TerrainFile> terr )
 {
    mFile = terr;
    mTerrFileName = terr.getPath();
+   clearOccluderMesh();
 }
 
 bool TerrainBlock::save(const char *filename)
@@ -322,6 +324,8 @@ void TerrainBlock::updateGrid( const Point2I &minPt, const Point2I &maxPt, bool
       // Which is currently the case.
       _updateBounds();
 
+      clearOccluderMesh();
+
       smUpdateSignal.trigger( HeightmapUpdate, this, minPt, maxPt );
 
       // Tell the terrain cell that the height changed.
@@ -879,6 +883,78 @@ void TerrainBlock::setScale( const VectorF &scale )
    Parent::setScale( VectorF::One );   
 }
 
+void TerrainBlock::buildOccluderMesh( OccluderMesh *mesh )
+{
+   if ( !mFile )
+      return;
+
+   // Pick the grid map level which gives us at
+   // most 32x32 cells across the block.
+   const U32 maxCells = 32;
+   U32 level = 0;
+   while ( ( mFile->mSize >> level ) > maxCells && level < mFile->mGridLevels )
+      level++;
+
+   const U32 cells = mFile->mSize >> level;
+   const U32 cellSquares = 1 << level;
+   const U32 rowVerts = cells + 1;
+
+   // Each corner takes the lowest height of the cells around it, so
+   // the cells slope between heights that are all below the terrain.
+   Vector<F32> heights;
+   heights.setSize( rowVerts * rowVerts );
+   for ( U32 i = 0; i < heights.size(); i++ )
+      heights[i] = F32_MAX;
+
+   Vector<bool> solid;
+   solid.setSize( cells * cells );
+
+   for ( U32 y = 0; y < cells; y++ )
+   {
+      for ( U32 x = 0; x < cells; x++ )
+      {
+         const TerrainSquare *sq = mFile->findSquare( level, x * cellSquares, y * cellSquares );
+         solid[ y * cells + x ] = !( sq->flags & ( TerrainSquare::Empty | TerrainSquare::HasEmpty ) );
+
+         const F32 height = fixedToFloat( sq->minHeight );
+         F32 *corner = &heights[ y * rowVerts + x ];
+         corner[0] = getMin( corner[0], height );
+         corner[1] = getMin( corner[1], height );
+         corner[ rowVerts ] = getMin( corner[ rowVerts ], height );
+         corner[ rowVerts + 1 ] = getMin( corner[ rowVerts + 1 ], height );
+      }
+   }
+
+   const F32 cellSize = mSquareSize * F32( cellSquares );
+   mesh->verts.setSize( rowVerts * rowVerts );
+   for ( U32 y = 0; y < rowVerts; y++ )
+   {
+      for ( U32 x = 0; x < rowVerts; x++ )
+      {
+         Point3F &vert = mesh->verts[ y * rowVerts + x ];
+         vert.set( F32( x ) * cellSize, F32( y ) * cellSize, heights[ y * rowVerts + x ] );
+         mObjToWorld.mulP( vert );
+      }
+   }
+
+   for ( U32 y = 0; y < cells; y++ )
+   {
+      for ( U32 x = 0; x < cells; x++ )
+      {
+         if ( !solid[ y * cells + x ] )
+            continue;
+
+         const U32 v = y * rowVerts + x;
+         mesh->indices.push_back( v );
+         mesh->indices.push_back( v + 1 );
+         mesh->indices.push_back( v + rowVerts + 1 );
+         mesh->indices.push_back( v );
+         mesh->indices.push_back( v + rowVerts + 1 );
+         mesh->indices.push_back( v + rowVerts );
+      }
+   }
+}
+
 void TerrainBlock::initPersistFields()
 {
    addGroup( "Media" );
@@ -363,6 +363,12 @@ public:
 
    bool prepRenderImage  ( SceneState *state, const U32 stateKey, const U32 startZone, const bool modifyBaseZoneState=false);
 
+   /// The terrain is always solid enough to occlude.
+   bool isOccluder() const { return true; }
+
+   /// Builds a coarse grid which stays under the real surface.
+   void buildOccluderMesh( OccluderMesh *mesh );
+
    void buildConvex(const Box3F& box,Convex* convex);
    bool buildPolyList(AbstractPolyList* polyList, const Box3F &box, const SphereF &sphere);
    bool castRay(const Point3F &start, const Point3F &end, RayInfo* info);
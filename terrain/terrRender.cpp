@@ -288,10 +288,12 @@ void TerrainBlock::_updateBaseTexture( bool writeToCache )
          }
          */
 
-         blendBmp.extrudeMipLevels();
+         // The base texture is seen from a distance, so its mips
+         // use the sharper Kaiser filter.
+         blendBmp.extrudeMipLevels( false, GBitmap::MipFilterKaiser );
 
          DDSFile *blendDDS = DDSFile::createDDSFileFromGBitmap( &blendBmp );
-         DDSUtil::squishDDS( blendDDS, GFXFormatDXT1 );
+         DDSUtil::compressDDS( blendDDS, GFXFormatDXT1 );
 
          // Write result to file stream
          blendDDS->write( fs );
@@ -0,0 +1,18 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSANIMATEINTRINSICS_ARCH_H_
+#define _TSANIMATEINTRINSICS_ARCH_H_
+
+#if defined(TORQUE_CPU_X86)
+# // x86 CPU family implementations
+extern void lerp_Quat16_SoA_SSE2(const S16 * __restrict key1, const S16 * __restrict key2, const dsize_t stride, const dsize_t count, const F32 t, const S32 * __restrict outIdx, QuatF * __restrict out);
+extern void lerp_Point3F_SoA_SSE(const F32 * __restrict key1, const F32 * __restrict key2, const dsize_t stride, const dsize_t count, const F32 t, const S32 * __restrict outIdx, Point3F * __restrict out);
+#
+#else
+# // Other CPU types go here...
+#endif
+
+#endif // _TSANIMATEINTRINSICS_ARCH_H_
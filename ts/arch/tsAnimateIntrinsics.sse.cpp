@@ -0,0 +1,131 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+#include "platform/platform.h"
+#include "ts/tsTransform.h"
+
+#if defined(TORQUE_CPU_X86)
+#include "ts/tsAnimateIntrinsics.h"
+#include <emmintrin.h>
+
+// Decodes four S16 values into floats.
+static inline __m128 _decodeS16x4(const S16 * __restrict ptr)
+{
+   __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(ptr));
+
+   // Sign extend into the upper half of each 32 bit lane.
+   v = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+   return _mm_cvtepi32_ps(v);
+}
+
+void lerp_Quat16_SoA_SSE2(const S16 * __restrict key1, 
+                          const S16 * __restrict key2,
+                          const dsize_t stride,
+                          const dsize_t count,
+                          const F32 t,
+                          const S32 * __restrict outIdx,
+                          QuatF * __restrict out)
+{
+   // These match TSTransform::interpolate operation for operation
+   // so that the results are the same as the C version.
+   const __m128 vMax = _mm_set1_ps(F32(Quat16::MAX_VAL));
+   const __m128 vT = _mm_set1_ps(t);
+   const __m128 vSign = _mm_set1_ps(-0.0f);
+   const __m128 vZero = _mm_setzero_ps();
+   const __m128 vSplit = _mm_set1_ps(0.857f);
+
+   const __m128 vLoA = _mm_set1_ps(0.699368f);
+   const __m128 vLoB = _mm_set1_ps(-1.819985f);
+   const __m128 vLoC = _mm_set1_ps(2.126369f);
+   const __m128 vHiA = _mm_set1_ps(0.454012f);
+   const __m128 vHiB = _mm_set1_ps(-1.403517f);
+   const __m128 vHiC = _mm_set1_ps(1.949542f);
+
+   for(dsize_t i = 0; i < count; i += 4)
+   {
+      // decode
+      __m128 x1 = _mm_div_ps(_decodeS16x4(key1 + i), vMax);
+      __m128 y1 = _mm_div_ps(_decodeS16x4(key1 + i + stride), vMax);
+      __m128 z1 = _mm_div_ps(_decodeS16x4(key1 + i + stride * 2), vMax);
+      __m128 w1 = _mm_div_ps(_decodeS16x4(key1 + i + stride * 3), vMax);
+
+      const __m128 x2 = _mm_div_ps(_decodeS16x4(key2 + i), vMax);
+      const __m128 y2 = _mm_div_ps(_decodeS16x4(key2 + i + stride), vMax);
+      const __m128 z2 = _mm_div_ps(_decodeS16x4(key2 + i + stride * 2), vMax);
+      const __m128 w2 = _mm_div_ps(_decodeS16x4(key2 + i + stride * 3), vMax);
+
+      // flip the first quaternion if they are more than 90 degrees apart
+      __m128 dot = _mm_add_ps(_mm_mul_ps(x1, x2), _mm_mul_ps(y1, y2));
+      dot = _mm_add_ps(dot, _mm_mul_ps(z1, z2));
+      dot = _mm_add_ps(dot, _mm_mul_ps(w1, w2));
+
+      const __m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, vZero), vSign);
+      x1 = _mm_xor_ps(x1, flip);
+      y1 = _mm_xor_ps(y1, flip);
+      z1 = _mm_xor_ps(z1, flip);
+      w1 = _mm_xor_ps(w1, flip);
+
+      // interpolate
+      x1 = _mm_add_ps(x1, _mm_mul_ps(vT, _mm_sub_ps(x2, x1)));
+      y1 = _mm_add_ps(y1, _mm_mul_ps(vT, _mm_sub_ps(y2, y1)));
+      z1 = _mm_add_ps(z1, _mm_mul_ps(vT, _mm_sub_ps(z2, z1)));
+      w1 = _mm_add_ps(w1, _mm_mul_ps(vT, _mm_sub_ps(w2, w1)));
+
+      // renormalize with the polynomial 1/sqrt
+      __m128 dist2 = _mm_add_ps(_mm_mul_ps(x1, x1), _mm_mul_ps(y1, y1));
+      dist2 = _mm_add_ps(dist2, _mm_mul_ps(z1, z1));
+      dist2 = _mm_add_ps(dist2, _mm_mul_ps(w1, w1));
+
+      const __m128 lo = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(vLoA, dist2), vLoB), dist2), vLoC);
+      const __m128 hi = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(vHiA, dist2), vHiB), dist2), vHiC);
+      const __m128 useLo = _mm_cmplt_ps(dist2, vSplit);
+      const __m128 oneOverL = _mm_or_ps(_mm_and_ps(useLo, lo), _mm_andnot_ps(useLo, hi));
+
+      x1 = _mm_mul_ps(x1, oneOverL);
+      y1 = _mm_mul_ps(y1, oneOverL);
+      z1 = _mm_mul_ps(z1, oneOverL);
+      w1 = _mm_mul_ps(w1, oneOverL);
+
+      // back to one quaternion per register
+      _MM_TRANSPOSE4_PS(x1, y1, z1, w1);
+
+      const dsize_t num = getMin(count - i, dsize_t(4));
+      _mm_storeu_ps(&out[outIdx[i]].x, x1);
+      if(num > 1) _mm_storeu_ps(&out[outIdx[i + 1]].x, y1);
+      if(num > 2) _mm_storeu_ps(&out[outIdx[i + 2]].x, z1);
+      if(num > 3) _mm_storeu_ps(&out[outIdx[i + 3]].x, w1);
+   }
+}
+
+//------------------------------------------------------------------------------
+
+void lerp_Point3F_SoA_SSE(const F32 * __restrict key1, 
+                          const F32 * __restrict key2,
+                          const dsize_t stride,
+                          const dsize_t count,
+                          const F32 t,
+                          const S32 * __restrict outIdx,
+                          Point3F * __restrict out)
+{
+   const __m128 vT = _mm_set1_ps(t);
+
+   F32 x[4], y[4], z[4];
+
+   for(dsize_t i = 0; i < count; i += 4)
+   {
+      const __m128 x1 = _mm_loadu_ps(key1 + i);
+      const __m128 y1 = _mm_loadu_ps(key1 + i + stride);
+      const __m128 z1 = _mm_loadu_ps(key1 + i + stride * 2);
+
+      _mm_storeu_ps(x, _mm_add_ps(x1, _mm_mul_ps(vT, _mm_sub_ps(_mm_loadu_ps(key2 + i), x1))));
+      _mm_storeu_ps(y, _mm_add_ps(y1, _mm_mul_ps(vT, _mm_sub_ps(_mm_loadu_ps(key2 + i + stride), y1))));
+      _mm_storeu_ps(z, _mm_add_ps(z1, _mm_mul_ps(vT, _mm_sub_ps(_mm_loadu_ps(key2 + i + stride * 2), z1))));
+
+      const dsize_t num = getMin(count - i, dsize_t(4));
+      for(dsize_t j = 0; j < num; j++)
+         out[outIdx[i + j]].set(x[j], y[j], z[j]);
+   }
+}
+
+#endif // TORQUE_CPU_X86
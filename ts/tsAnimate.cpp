@@ -49,10 +49,12 @@ void TSShapeInstance::animateNodes(S32 ss)
       mNodeTransforms.setSize(mShape->nodes.size());
 
    // temporary storage for node transforms
-   smNodeCurrentRotations.setSize(mShape->nodes.size());
-   smNodeCurrentTranslations.setSize(mShape->nodes.size());
-   smRotationThreads.setSize(mShape->nodes.size());
-   smTranslationThreads.setSize(mShape->nodes.size());
+   mScratch->nodeCurrentRotations.setSize(mShape->nodes.size());
+   mScratch->nodeCurrentTranslations.setSize(mShape->nodes.size());
+   mScratch->rotationThreads.setSize(mShape->nodes.size());
+   mScratch->translationThreads.setSize(mShape->nodes.size());
+   mScratch->sampledRotations.setSize(mShape->nodes.size());
+   mScratch->sampledTranslations.setSize(mShape->nodes.size());
 
    TSIntegerSet rotBeenSet;
    TSIntegerSet tranBeenSet;
@@ -98,13 +100,13 @@ void TSShapeInstance::animateNodes(S32 ss)
    {
       if (rotBeenSet.test(i))
       {
-         mShape->defaultRotations[i].getQuatF(&smNodeCurrentRotations[i]);
-         smRotationThreads[i] = NULL;
+         mShape->defaultRotations[i].getQuatF(&mScratch->nodeCurrentRotations[i]);
+         mScratch->rotationThreads[i] = NULL;
       }
       if (tranBeenSet.test(i))
       {
-         smNodeCurrentTranslations[i] = mShape->defaultTranslations[i];
-         smTranslationThreads[i] = NULL;
+         mScratch->nodeCurrentTranslations[i] = mShape->defaultTranslations[i];
+         mScratch->translationThreads[i] = NULL;
       }
    }
 
@@ -124,6 +126,10 @@ void TSShapeInstance::animateNodes(S32 ss)
    {
       TSThread * th = mThreadList[i];
 
+      // sample all the tracks of the sequence at once
+      mShape->sampleRotations(*th->getSequence(),th->keyNum1,th->keyNum2,th->keyPos,mScratch->sampledRotations.address());
+      mShape->sampleTranslations(*th->getSequence(),th->keyNum1,th->keyNum2,th->keyPos,mScratch->sampledTranslations.address());
+
       j=0;
       start = th->getSequence()->rotationMatters.start();
       end   = b;
@@ -134,12 +140,9 @@ void TSShapeInstance::animateNodes(S32 ss)
             continue;
          if (!rotBeenSet.test(nodeIndex))
          {
-            QuatF q1,q2;
-            mShape->getRotation(*th->getSequence(),th->keyNum1,j,&q1);
-            mShape->getRotation(*th->getSequence(),th->keyNum2,j,&q2);
-            TSTransform::interpolate(q1,q2,th->keyPos,&smNodeCurrentRotations[nodeIndex]);
+            mScratch->nodeCurrentRotations[nodeIndex] = mScratch->sampledRotations[j];
             rotBeenSet.set(nodeIndex);
-            smRotationThreads[nodeIndex] = th;
+            mScratch->rotationThreads[nodeIndex] = th;
          }
       }
 
@@ -156,10 +159,8 @@ void TSShapeInstance::animateNodes(S32 ss)
                handleMaskedPositionNode(th,nodeIndex,j);
             else
             {
-               const Point3F & p1 = mShape->getTranslation(*th->getSequence(),th->keyNum1,j);
-               const Point3F & p2 = mShape->getTranslation(*th->getSequence(),th->keyNum2,j);
-               TSTransform::interpolate(p1,p2,th->keyPos,&smNodeCurrentTranslations[nodeIndex]);
-               smTranslationThreads[nodeIndex] = th;
+               mScratch->nodeCurrentTranslations[nodeIndex] = mScratch->sampledTranslations[j];
+               mScratch->translationThreads[nodeIndex] = th;
             }
             tranBeenSet.set(nodeIndex);
          }
@@ -174,12 +175,12 @@ void TSShapeInstance::animateNodes(S32 ss)
       handleTransitionNodes(a,b);
 
    // @todo: Need to update TSShapeInstances when the number of nodes changes.....
-   mNodeTransforms.setSize(smNodeCurrentRotations.size());
+   mNodeTransforms.setSize(mScratch->nodeCurrentRotations.size());
 
    // compute transforms
    for (i=a; i<b; i++)
       if (!mHandsOffNodes.test(i))
-         TSTransform::setMatrix(smNodeCurrentRotations[i],smNodeCurrentTranslations[i],&mNodeTransforms[i]);
+         TSTransform::setMatrix(mScratch->nodeCurrentRotations[i],mScratch->nodeCurrentTranslations[i],&mNodeTransforms[i]);
 
    // add scale onto transforms
    if (scaleCurrentlyAnimated())
@@ -196,11 +197,12 @@ void TSShapeInstance::animateNodes(S32 ss)
          mNodeCallbacks[i].callback->setNodeTransform(this, nodeIndex, mNodeTransforms[nodeIndex]);
    }
 
-   // handle blend sequences
+   // handle blend sequences, unless we're too small for them to matter
+   bool skipBlends = mCurrentPixelSize>=0.0f && mCurrentPixelSize<smAnimBlendPixelSize;
    for (i=firstBlend; i<mThreadList.size(); i++)
    {
       TSThread * th = mThreadList[i];
-      if (th->blendDisabled)
+      if (th->blendDisabled || skipBlends)
          continue;
 
       handleBlendSequence(th,a,b);
@@ -223,37 +225,37 @@ void TSShapeInstance::handleDefaultScale(S32 a, S32 b, TSIntegerSet & scaleBeenS
    // set default scale values (i.e., identity) and do any initialization
    // relating to animated scale (since scale normally not animated)
 
-   smScaleThreads.setSize(mShape->nodes.size());
+   mScratch->scaleThreads.setSize(mShape->nodes.size());
    scaleBeenSet.takeAway(mCallbackNodes);
    scaleBeenSet.takeAway(mHandsOffNodes);
    if (animatesUniformScale())
    {
-      smNodeCurrentUniformScales.setSize(mShape->nodes.size());
+      mScratch->nodeCurrentUniformScales.setSize(mShape->nodes.size());
       for (S32 i=a; i<b; i++)
          if (scaleBeenSet.test(i))
          {
-            smNodeCurrentUniformScales[i] = 1.0f;
-            smScaleThreads[i] = NULL;
+            mScratch->nodeCurrentUniformScales[i] = 1.0f;
+            mScratch->scaleThreads[i] = NULL;
          }
    }
    else if (animatesAlignedScale())
    {
-      smNodeCurrentAlignedScales.setSize(mShape->nodes.size());
+      mScratch->nodeCurrentAlignedScales.setSize(mShape->nodes.size());
       for (S32 i=a; i<b; i++)
          if (scaleBeenSet.test(i))
          {
-            smNodeCurrentAlignedScales[i].set(1.0f,1.0f,1.0f);
-            smScaleThreads[i] = NULL;
+            mScratch->nodeCurrentAlignedScales[i].set(1.0f,1.0f,1.0f);
+            mScratch->scaleThreads[i] = NULL;
          }
    }
    else
    {
-      smNodeCurrentArbitraryScales.setSize(mShape->nodes.size());
+      mScratch->nodeCurrentArbitraryScales.setSize(mShape->nodes.size());
       for (S32 i=a; i<b; i++)
          if (scaleBeenSet.test(i))
          {
-            smNodeCurrentArbitraryScales[i].identity();
-            smScaleThreads[i] = NULL;
+            mScratch->nodeCurrentArbitraryScales[i].identity();
+            mScratch->scaleThreads[i] = NULL;
          }
    }
 
@@ -271,7 +273,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
    {
       if (nodeIndex<a)
          continue;
-      TSThread * thread = smRotationThreads[nodeIndex];
+      TSThread * thread = mScratch->rotationThreads[nodeIndex];
       thread = thread && thread->transitionData.inTransition ? thread : NULL;
       if (!thread)
       {
@@ -289,7 +291,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
          AssertFatal(thread!=NULL,"TSShapeInstance::handleRotTransitionNodes (rotation)");
       }
       QuatF tmpQ;
-      TSTransform::interpolate(mNodeReferenceRotations[nodeIndex].getQuatF(&tmpQ),smNodeCurrentRotations[nodeIndex],thread->transitionData.pos,&smNodeCurrentRotations[nodeIndex]);
+      TSTransform::interpolate(mNodeReferenceRotations[nodeIndex].getQuatF(&tmpQ),mScratch->nodeCurrentRotations[nodeIndex],thread->transitionData.pos,&mScratch->nodeCurrentRotations[nodeIndex]);
    }
 
    // then translation
@@ -297,7 +299,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
    end   = b;
    for (nodeIndex=start; nodeIndex<end; mTransitionTranslationNodes.next(nodeIndex))
    {
-      TSThread * thread = smTranslationThreads[nodeIndex];
+      TSThread * thread = mScratch->translationThreads[nodeIndex];
       thread = thread && thread->transitionData.inTransition ? thread : NULL;
       if (!thread)
       {
@@ -314,7 +316,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
          }
          AssertFatal(thread!=NULL,"TSShapeInstance::handleTransitionNodes (translation).");
       }
-      Point3F & p = smNodeCurrentTranslations[nodeIndex];
+      Point3F & p = mScratch->nodeCurrentTranslations[nodeIndex];
       Point3F & p1 = mNodeReferenceTranslations[nodeIndex];
       Point3F & p2 = p;
       F32 k = thread->transitionData.pos;
@@ -330,7 +332,7 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
       end   = b;
       for (nodeIndex=start; nodeIndex<end; mTransitionScaleNodes.next(nodeIndex))
       {
-         TSThread * thread = smScaleThreads[nodeIndex];
+         TSThread * thread = mScratch->scaleThreads[nodeIndex];
          thread = thread && thread->transitionData.inTransition ? thread : NULL;
          if (!thread)
          {
@@ -348,14 +350,14 @@ void TSShapeInstance::handleTransitionNodes(S32 a, S32 b)
             AssertFatal(thread!=NULL,"TSShapeInstance::handleTransitionNodes (scale).");
          }
          if (animatesUniformScale())
-            smNodeCurrentUniformScales[nodeIndex] += thread->transitionData.pos * (mNodeReferenceUniformScales[nodeIndex]-smNodeCurrentUniformScales[nodeIndex]);
+            mScratch->nodeCurrentUniformScales[nodeIndex] += thread->transitionData.pos * (mNodeReferenceUniformScales[nodeIndex]-mScratch->nodeCurrentUniformScales[nodeIndex]);
          else if (animatesAlignedScale())
-            TSTransform::interpolate(mNodeReferenceScaleFactors[nodeIndex],smNodeCurrentAlignedScales[nodeIndex],thread->transitionData.pos,&smNodeCurrentAlignedScales[nodeIndex]);
+            TSTransform::interpolate(mNodeReferenceScaleFactors[nodeIndex],mScratch->nodeCurrentAlignedScales[nodeIndex],thread->transitionData.pos,&mScratch->nodeCurrentAlignedScales[nodeIndex]);
          else
          {
             QuatF q;
-            TSTransform::interpolate(mNodeReferenceScaleFactors[nodeIndex],smNodeCurrentArbitraryScales[nodeIndex].mScale,thread->transitionData.pos,&smNodeCurrentArbitraryScales[nodeIndex].mScale);
-            TSTransform::interpolate(mNodeReferenceArbitraryScaleRots[nodeIndex].getQuatF(&q),smNodeCurrentArbitraryScales[nodeIndex].mRotate,thread->transitionData.pos,&smNodeCurrentArbitraryScales[nodeIndex].mRotate);
+            TSTransform::interpolate(mNodeReferenceScaleFactors[nodeIndex],mScratch->nodeCurrentArbitraryScales[nodeIndex].mScale,thread->transitionData.pos,&mScratch->nodeCurrentArbitraryScales[nodeIndex].mScale);
+            TSTransform::interpolate(mNodeReferenceArbitraryScaleRots[nodeIndex].getQuatF(&q),mScratch->nodeCurrentArbitraryScales[nodeIndex].mRotate,thread->transitionData.pos,&mScratch->nodeCurrentArbitraryScales[nodeIndex].mRotate);
          }
       }
    }
@@ -367,19 +369,19 @@ void TSShapeInstance::handleNodeScale(S32 a, S32 b)
    {
       for (S32 i=a; i<b; i++)
          if (!mHandsOffNodes.test(i))
-            TSTransform::applyScale(smNodeCurrentUniformScales[i],&mNodeTransforms[i]);
+            TSTransform::applyScale(mScratch->nodeCurrentUniformScales[i],&mNodeTransforms[i]);
    }
    else if (animatesAlignedScale())
    {
       for (S32 i=a; i<b; i++)
          if (!mHandsOffNodes.test(i))
-            TSTransform::applyScale(smNodeCurrentAlignedScales[i],&mNodeTransforms[i]);
+            TSTransform::applyScale(mScratch->nodeCurrentAlignedScales[i],&mNodeTransforms[i]);
    }
    else
    {
       for (S32 i=a; i<b; i++)
          if (!mHandsOffNodes.test(i))
-            TSTransform::applyScale(smNodeCurrentArbitraryScales[i],&mNodeTransforms[i]);
+            TSTransform::applyScale(mScratch->nodeCurrentArbitraryScales[i],&mNodeTransforms[i]);
    }
 }
 
@@ -448,28 +450,28 @@ void TSShapeInstance::handleAnimatedScale(TSThread * thread, S32 a, S32 b, TSInt
          {
             case 0: // uniform -> uniform
             {
-               smNodeCurrentUniformScales[nodeIndex] = uniformScale;
+               mScratch->nodeCurrentUniformScales[nodeIndex] = uniformScale;
                break;
             }
             case 1: // uniform -> aligned
             case 4: // aligned -> aligned
-               smNodeCurrentAlignedScales[nodeIndex] = alignedScale;
+               mScratch->nodeCurrentAlignedScales[nodeIndex] = alignedScale;
                break;
             case 2: // uniform -> arbitrary
             case 5: // aligned -> arbitrary
             {
-               smNodeCurrentArbitraryScales[nodeIndex].identity();
-               smNodeCurrentArbitraryScales[nodeIndex].mScale = alignedScale;
+               mScratch->nodeCurrentArbitraryScales[nodeIndex].identity();
+               mScratch->nodeCurrentArbitraryScales[nodeIndex].mScale = alignedScale;
                break;
             }
             case 8: // arbitrary -> arbitary
             {
-               smNodeCurrentArbitraryScales[nodeIndex] = arbitraryScale;
+               mScratch->nodeCurrentArbitraryScales[nodeIndex] = arbitraryScale;
                break;
             }
             default: AssertFatal(0,"TSShapeInstance::handleAnimatedScale"); break;
          }
-         smScaleThreads[nodeIndex] = thread;
+         mScratch->scaleThreads[nodeIndex] = thread;
          scaleBeenSet.set(nodeIndex);
       }
    }
@@ -477,19 +479,16 @@ void TSShapeInstance::handleAnimatedScale(TSThread * thread, S32 a, S32 b, TSInt
 
 void TSShapeInstance::handleMaskedPositionNode(TSThread * th, S32 nodeIndex, S32 offset)
 {
-   const Point3F & p1 = mShape->getTranslation(*th->getSequence(),th->keyNum1,offset);
-   const Point3F & p2 = mShape->getTranslation(*th->getSequence(),th->keyNum2,offset);
-   Point3F p;
-   TSTransform::interpolate(p1,p2,th->keyPos,&p);
+   const Point3F & p = mScratch->sampledTranslations[offset];
 
    if (!mMaskPosXNodes.test(nodeIndex))
-      smNodeCurrentTranslations[nodeIndex].x = p.x;
+      mScratch->nodeCurrentTranslations[nodeIndex].x = p.x;
 
    if (!mMaskPosYNodes.test(nodeIndex))
-      smNodeCurrentTranslations[nodeIndex].y = p.y;
+      mScratch->nodeCurrentTranslations[nodeIndex].y = p.y;
 
    if (!mMaskPosZNodes.test(nodeIndex))
-      smNodeCurrentTranslations[nodeIndex].z = p.z;
+      mScratch->nodeCurrentTranslations[nodeIndex].z = p.z;
 }
 
 void TSShapeInstance::handleBlendSequence(TSThread * thread, S32 a, S32 b)
@@ -500,6 +499,9 @@ void TSShapeInstance::handleBlendSequence(TSThread * thread, S32 a, S32 b)
    TSIntegerSet nodeMatters = thread->getSequence()->translationMatters;
    nodeMatters.overlap(thread->getSequence()->rotationMatters);
    nodeMatters.overlap(thread->getSequence()->scaleMatters);
+
+   mShape->sampleRotations(*thread->getSequence(),thread->keyNum1,thread->keyNum2,thread->keyPos,mScratch->sampledRotations.address());
+   mShape->sampleTranslations(*thread->getSequence(),thread->keyNum1,thread->keyNum2,thread->keyPos,mScratch->sampledTranslations.address());
    S32 start = nodeMatters.start();
    S32 end   = b;
    for (S32 nodeIndex=start; nodeIndex<end; nodeMatters.next(nodeIndex))
@@ -519,22 +521,13 @@ void TSShapeInstance::handleBlendSequence(TSThread * thread, S32 a, S32 b)
       MatrixF mat(true);
       if (thread->getSequence()->rotationMatters.test(nodeIndex))
       {
-         QuatF q1,q2;
-         mShape->getRotation(*thread->getSequence(),thread->keyNum1,jrot,&q1);
-         mShape->getRotation(*thread->getSequence(),thread->keyNum2,jrot,&q2);
-         QuatF quat;
-         TSTransform::interpolate(q1,q2,thread->keyPos,&quat);
-         TSTransform::setMatrix(quat,&mat);
+         TSTransform::setMatrix(mScratch->sampledRotations[jrot],&mat);
          jrot++;
       }
 
       if (thread->getSequence()->translationMatters.test(nodeIndex))
       {
-         const Point3F & p1 = mShape->getTranslation(*thread->getSequence(),thread->keyNum1,jtrans);
-         const Point3F & p2 = mShape->getTranslation(*thread->getSequence(),thread->keyNum2,jtrans);
-         Point3F p;
-         TSTransform::interpolate(p1,p2,thread->keyPos,&p);
-         mat.setColumn(3,p);
+         mat.setColumn(3,mScratch->sampledTranslations[jtrans]);
          jtrans++;
       }
 
@@ -811,9 +804,17 @@ void TSShapeInstance::animate(S32 dl)
    if (dirtyFlags & IflDirty)
       animateIfls();
 
-   // animate nodes?
-   if (dirtyFlags & TransformDirty)
+   // animate nodes?  small shapes keep their last pose for a while,
+   // the threads still advance so the next update is at the right time.
+   U32 keepFlags = 0;
+   if (willAnimateNodes(dl))
+   {
       animateNodes(ss);
+      mLastNodeAnimateTime = Platform::getVirtualMilliseconds();
+   }
+   else if (dirtyFlags & TransformDirty)
+      keepFlags = TransformDirty;
+   mThrottleNextAnimate = false;
 
    // animate objects?
    if (dirtyFlags & VisDirty)
@@ -825,7 +826,141 @@ void TSShapeInstance::animate(S32 dl)
    if (dirtyFlags & MatFrameDirty)
       animateMatFrame(ss);
 
-   mDirtyFlags[ss] = 0;
+   // keep the transforms dirty if we skipped them
+   mDirtyFlags[ss] = keepFlags;
+}
+
+void TSShapeInstance::animate(S32 dl, AnimateScratch *scratch)
+{
+   mScratch = scratch;
+   animate(dl);
+   mScratch = &smScratch;
+}
+
+bool TSShapeInstance::needsAnimate(S32 dl) const
+{
+   if (dl<0 || dl>=mShape->details.size())
+      return false;
+
+   S32 ss = mShape->details[dl].subShapeNum;
+   return ss>=0 && mDirtyFlags[ss]!=0;
+}
+
+U32 TSShapeInstance::getAnimateInterval() const
+{
+   if (smAnimMaxInterval<=0)
+      return 0;
+
+   if (mThrottleNextAnimate)
+      return smAnimMaxInterval;
+
+   // unknown or big enough... animate every time
+   if (mCurrentPixelSize<0.0f || mCurrentPixelSize>=smAnimFullRatePixelSize)
+      return 0;
+
+   F32 k = 1.0f - mCurrentPixelSize / smAnimFullRatePixelSize;
+   return U32(k * smAnimMaxInterval);
+}
+
+bool TSShapeInstance::isNodeAnimationThrottled() const
+{
+   U32 interval = getAnimateInterval();
+   if (!interval)
+      return false;
+
+   return Platform::getVirtualMilliseconds() - mLastNodeAnimateTime < interval;
+}
+
+U32 TSShapeInstance::PoseKey::getHash() const
+{
+   U32 hash = U32(dsize_t(shape)) ^ (U32(dsize_t(sequence)) * 31);
+   hash = hash * 31 + ss;
+   hash = hash * 31 + keyNum1;
+   hash = hash * 31 + keyNum2;
+   hash = hash * 31 + keyStep;
+   return hash;
+}
+
+bool TSShapeInstance::willAnimateNodes(S32 dl) const
+{
+   if (!needsAnimate(dl))
+      return false;
+
+   U32 dirtyFlags = mDirtyFlags[mShape->details[dl].subShapeNum];
+   if (!(dirtyFlags & TransformDirty))
+      return false;
+
+   // a changed thread list is always shown right away
+   return (dirtyFlags & ThreadDirty) || !isNodeAnimationThrottled();
+}
+
+bool TSShapeInstance::PoseKey::operator ==( const PoseKey &key ) const
+{
+   return shape==key.shape && sequence==key.sequence && ss==key.ss &&
+          keyNum1==key.keyNum1 && keyNum2==key.keyNum2 && keyStep==key.keyStep;
+}
+
+bool TSShapeInstance::getPoseKey(S32 dl, S32 steps, PoseKey *outKey) const
+{
+   if (steps<=0 || dl<0 || dl>=mShape->details.size())
+      return false;
+
+   S32 ss = mShape->details[dl].subShapeNum;
+   if (ss<0)
+      return false;
+
+   // anything that makes the pose depend on more than
+   // the sequence and key position can't be shared
+   if (mThreadList.size()>1 || inTransition() || !mNodeCallbacks.empty())
+      return false;
+
+   S32 numNodes = mShape->nodes.size();
+   if (!mHandsOffNodes.testAll(numNodes) || !mCallbackNodes.testAll(numNodes) ||
+       !mMaskRotationNodes.testAll(numNodes) || !mMaskPosXNodes.testAll(numNodes) ||
+       !mMaskPosYNodes.testAll(numNodes) || !mMaskPosZNodes.testAll(numNodes))
+      return false;
+
+   outKey->shape = mShape;
+   outKey->ss = ss;
+
+   if (mThreadList.empty())
+   {
+      // the default pose
+      outKey->sequence = NULL;
+      outKey->keyNum1 = outKey->keyNum2 = outKey->keyStep = 0;
+      return true;
+   }
+
+   const TSThread *th = mThreadList[0];
+   if (th->getSequence()->isBlend())
+      return false;
+
+   outKey->sequence = th->getSequence();
+   outKey->keyNum1 = th->keyNum1;
+   outKey->keyNum2 = th->keyNum2;
+   outKey->keyStep = S32(th->keyPos * steps + 0.5f);
+   return true;
+}
+
+void TSShapeInstance::copyPose(const TSShapeInstance *src, S32 dl)
+{
+   AssertFatal(src->mShape==mShape, "TSShapeInstance::copyPose - instances of different shapes!");
+
+   S32 ss = mShape->details[dl].subShapeNum;
+   if (mDirtyFlags[ss] & TransformDirty)
+   {
+      if (mShape->nodes.size() > mNodeTransforms.size())
+         mNodeTransforms.setSize(mShape->nodes.size());
+
+      S32 a = mShape->subShapeFirstNode[ss];
+      S32 b = a + mShape->subShapeNumNodes[ss];
+      dMemcpy(mNodeTransforms.address() + a, src->mNodeTransforms.address() + a, (b - a) * sizeof(MatrixF));
+      mLastNodeAnimateTime = Platform::getVirtualMilliseconds();
+      mDirtyFlags[ss] &= ~TransformDirty;
+   }
+
+   // the rest is cheap
+   animate(dl);
 }
 
 void TSShapeInstance::animateNodeSubtrees(bool forceFull)
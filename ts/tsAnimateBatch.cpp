@@ -0,0 +1,382 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "ts/tsAnimateBatch.h"
+
+#include "ts/tsShapeInstance.h"
+#include "platform/threads/threadPool.h"
+#include "platform/threads/threadSafeRefCount.h"
+#include "platform/threads/semaphore.h"
+#include "platform/platformIntrinsics.h"
+#include "platform/profiler.h"
+
+
+bool TSAnimateBatch::smParallel = true;
+S32 TSAnimateBatch::smBatchSize = 8;
+S32 TSAnimateBatch::smNodeBudget = 0;
+S32 TSAnimateBatch::smPoseShareSteps = 8;
+
+S32 TSAnimateBatch::smNumAnimated = 0;
+S32 TSAnimateBatch::smNumThrottled = 0;
+S32 TSAnimateBatch::smNumShared = 0;
+S32 TSAnimateBatch::smNumNodes = 0;
+
+namespace {
+
+/// The workspaces of the worker threads.  They are kept around so
+/// the node vectors don't need to be reallocated every frame.
+Vector<TSShapeInstance::AnimateScratch*> sWorkerScratch;
+
+/// Used to sort the entries by their size on screen.
+struct SizeKey
+{
+   F32 size;
+   TSAnimateBatch::Entry *entry;
+};
+
+/// Used to find the entries with equal poses.
+struct PoseSortKey
+{
+   TSShapeInstance::PoseKey pose;
+   U32 hash;
+   U32 index;
+};
+
+Vector<SizeKey> sSizeKeys;
+Vector<PoseSortKey> sPoseKeys;
+Vector<S32> sLeaders;
+
+/// Sorts the biggest shapes first.
+S32 QSORT_CALLBACK _sizeKeyCmp( const SizeKey *a, const SizeKey *b )
+{
+   if ( a->size > b->size )
+      return -1;
+   else if ( a->size < b->size )
+      return 1;
+   return 0;
+}
+
+/// Sorts by hash and keeps the entry order within a hash.
+S32 QSORT_CALLBACK _poseKeyCmp( const PoseSortKey *a, const PoseSortKey *b )
+{
+   if ( a->hash != b->hash )
+      return a->hash < b->hash ? -1 : 1;
+   return S32( a->index ) - S32( b->index );
+}
+
+/// Returns the number of nodes animate() updates for the entry.
+S32 _getNumNodes( const TSAnimateBatch::Entry &entry )
+{
+   const TSShape *shape = entry.shape->getShape();
+   return shape->subShapeNumNodes[ shape->details[ entry.dl ].subShapeNum ];
+}
+
+void _addSizeKeys( Vector<TSAnimateBatch::Entry> &entries )
+{
+   for ( U32 i = 0; i < entries.size(); i++ )
+   {
+      TSAnimateBatch::Entry &entry = entries[i];
+      if ( !entry.shape->willAnimateNodes( entry.dl ) )
+         continue;
+
+      // A shape of unknown size counts as big.
+      const F32 size = entry.shape->getCurrentPixelSize();
+      sSizeKeys.increment();
+      sSizeKeys.last().size = size < 0.0f ? F32_MAX : size;
+      sSizeKeys.last().entry = &entry;
+   }
+}
+
+void _countStats( const Vector<TSAnimateBatch::Entry> &entries )
+{
+   for ( U32 i = 0; i < entries.size(); i++ )
+   {
+      const TSAnimateBatch::Entry &entry = entries[i];
+      const S32 ss = entry.shape->getShape()->details[ entry.dl ].subShapeNum;
+
+      if ( entry.shape->willAnimateNodes( entry.dl ) )
+      {
+         TSAnimateBatch::smNumAnimated++;
+         TSAnimateBatch::smNumNodes += _getNumNodes( entry );
+      }
+      else if ( entry.shape->mDirtyFlags[ss] & TSShapeInstance::TransformDirty )
+         TSAnimateBatch::smNumThrottled++;
+   }
+}
+
+/// The shared state of one run.  It works just like the parallel
+/// scene prep... workers and the main thread claim batches until
+/// none are left.
+struct AnimateJob : public ThreadSafeRefCount< AnimateJob >
+{
+   const TSAnimateBatch::Entry *mEntries;
+   U32 mNumEntries;
+
+   U32 mBatchSize;
+   U32 mNumBatches;
+   volatile U32 mNextBatch;
+
+   /// The next free entry in sWorkerScratch.
+   volatile U32 mNextScratch;
+
+   /// Released once for every finished batch.
+   Semaphore mBatchDone;
+
+   AnimateJob()
+      : mNextBatch( 0 ),
+        mNextScratch( 0 ),
+        mBatchDone( 0 )
+   {
+   }
+
+   bool claimBatch( U32 &outBatch )
+   {
+      for ( ;; )
+      {
+         U32 next = mNextBatch;
+         if ( next >= mNumBatches )
+            return false;
+
+         if ( dCompareAndSwap( mNextBatch, next, next + 1 ) )
+         {
+            outBatch = next;
+            return true;
+         }
+      }
+   }
+
+   TSShapeInstance::AnimateScratch* claimScratch()
+   {
+      for ( ;; )
+      {
+         U32 next = mNextScratch;
+         if ( dCompareAndSwap( mNextScratch, next, next + 1 ) )
+            return sWorkerScratch[ next ];
+      }
+   }
+
+   /// Animates batches until there are none left.  If scratch is
+   /// NULL a worker workspace is claimed with the first batch.
+   void run( TSShapeInstance::AnimateScratch *scratch )
+   {
+      U32 batch;
+      while ( claimBatch( batch ) )
+      {
+         if ( !scratch )
+            scratch = claimScratch();
+
+         const U32 start = batch * mBatchSize;
+         const U32 end = getMin( start + mBatchSize, mNumEntries );
+         for ( U32 i = start; i < end; i++ )
+            mEntries[i].shape->animate( mEntries[i].dl, scratch );
+
+         mBatchDone.release();
+      }
+   }
+};
+
+struct AnimateWorkItem : public ThreadPool::WorkItem
+{
+   typedef ThreadPool::WorkItem Parent;
+
+   ThreadSafeRef< AnimateJob > mJob;
+
+   AnimateWorkItem( AnimateJob *job )
+      : mJob( job ) {}
+
+protected:
+   virtual void execute()
+   {
+      mJob->run( NULL );
+   }
+};
+
+} // namespace {}
+
+
+TSAnimateBatch::TSAnimateBatch()
+{
+   VECTOR_SET_ASSOCIATION( mEntries );
+   VECTOR_SET_ASSOCIATION( mFollowers );
+   VECTOR_SET_ASSOCIATION( mMainThreadEntries );
+}
+
+void TSAnimateBatch::add( TSShapeInstance *shape, S32 dl )
+{
+   if ( !shape->needsAnimate( dl ) )
+      return;
+
+   Vector<Entry> &entries = shape->canAnimateOnWorker() ? mEntries : mMainThreadEntries;
+   entries.increment();
+   entries.last().shape = shape;
+   entries.last().dl = dl;
+}
+
+void TSAnimateBatch::add( TSShapeInstance *shape )
+{
+   add( shape, shape->getCurrentDetail() );
+}
+
+void TSAnimateBatch::_sharePoses()
+{
+   if ( smPoseShareSteps <= 0 )
+      return;
+
+   sPoseKeys.clear();
+   for ( U32 i = 0; i < mEntries.size(); i++ )
+   {
+      const Entry &entry = mEntries[i];
+
+      // Only shapes too small to animate every frame share
+      // poses as the rounded key position would show up close.
+      // Throttled shapes keep their old pose, so they can
+      // neither lead nor follow.
+      const F32 pixelSize = entry.shape->getCurrentPixelSize();
+      if (  pixelSize < 0.0f || 
+            pixelSize >= TSShapeInstance::smAnimFullRatePixelSize ||
+            !entry.shape->willAnimateNodes( entry.dl ) )
+         continue;
+
+      sPoseKeys.increment();
+      PoseSortKey &key = sPoseKeys.last();
+      if ( !entry.shape->getPoseKey( entry.dl, smPoseShareSteps, &key.pose ) )
+      {
+         sPoseKeys.decrement();
+         continue;
+      }
+
+      key.hash = key.pose.getHash();
+      key.index = i;
+   }
+
+   if ( sPoseKeys.size() < 2 )
+      return;
+
+   sPoseKeys.sort( _poseKeyCmp );
+
+   // The first entry with a pose leads, the
+   // following ones with an equal pose copy it.
+   sLeaders.setSize( mEntries.size() );
+   dMemset( sLeaders.address(), 0xFF, sLeaders.memSize() );
+
+   U32 runStart = 0;
+   for ( U32 i = 1; i < sPoseKeys.size(); i++ )
+   {
+      if ( sPoseKeys[i].hash != sPoseKeys[runStart].hash )
+      {
+         runStart = i;
+         continue;
+      }
+
+      for ( U32 j = runStart; j < i; j++ )
+      {
+         if (  sLeaders[ sPoseKeys[j].index ] == -1 &&
+               sPoseKeys[j].pose == sPoseKeys[i].pose )
+         {
+            sLeaders[ sPoseKeys[i].index ] = sPoseKeys[j].index;
+            break;
+         }
+      }
+   }
+
+   U32 numEntries = 0;
+   for ( U32 i = 0; i < mEntries.size(); i++ )
+   {
+      if ( sLeaders[i] == -1 )
+      {
+         mEntries[ numEntries++ ] = mEntries[i];
+         continue;
+      }
+
+      mFollowers.increment();
+      mFollowers.last().entry = mEntries[i];
+      mFollowers.last().leader = mEntries[ sLeaders[i] ].shape;
+   }
+   mEntries.setSize( numEntries );
+}
+
+void TSAnimateBatch::_applyBudget()
+{
+   if ( smNodeBudget <= 0 )
+      return;
+
+   sSizeKeys.clear();
+   _addSizeKeys( mEntries );
+   _addSizeKeys( mMainThreadEntries );
+   sSizeKeys.sort( _sizeKeyCmp );
+
+   S32 numNodes = 0;
+   for ( U32 i = 0; i < sSizeKeys.size(); i++ )
+   {
+      numNodes += _getNumNodes( *sSizeKeys[i].entry );
+      if ( numNodes > smNodeBudget )
+         sSizeKeys[i].entry->shape->throttleNextAnimate();
+   }
+}
+
+void TSAnimateBatch::run()
+{
+   PROFILE_SCOPE( TSAnimateBatch_run );
+
+   // The budget goes first.  _sharePoses() skips the shapes which
+   // won't animate their nodes, so a throttled shape can't lead and
+   // hand its stale pose to its followers.
+   _applyBudget();
+   _sharePoses();
+
+   smNumAnimated = 0;
+   smNumThrottled = 0;
+   smNumShared = mFollowers.size();
+   smNumNodes = 0;
+   _countStats( mEntries );
+   _countStats( mMainThreadEntries );
+
+   ThreadPool &pool = ThreadPool::GLOBAL();
+   const U32 batchSize = getMax( smBatchSize, 1 );
+   const U32 numBatches = ( mEntries.size() + batchSize - 1 ) / batchSize;
+
+   if (  !smParallel ||
+         numBatches < 2 ||
+         pool.getNumThreads() == 0 )
+   {
+      for ( U32 i = 0; i < mEntries.size(); i++ )
+         mEntries[i].shape->animate( mEntries[i].dl );
+   }
+   else
+   {
+      // The main thread works on the batches too, so only wake
+      // up as many workers as there are batches left for them.
+      const U32 numItems = getMin( pool.getNumThreads(), numBatches - 1 );
+      while ( sWorkerScratch.size() < numItems )
+         sWorkerScratch.push_back( new TSShapeInstance::AnimateScratch );
+
+      ThreadSafeRef< AnimateJob > job( new AnimateJob );
+      job->mEntries = mEntries.address();
+      job->mNumEntries = mEntries.size();
+      job->mBatchSize = batchSize;
+      job->mNumBatches = numBatches;
+
+      for ( U32 i = 0; i < numItems; i++ )
+         pool.queueWorkItem( new AnimateWorkItem( job ) );
+
+      PROFILE_START(TSAnimateBatch_run_Parallel);
+      job->run( &TSShapeInstance::smScratch );
+      for ( U32 i = 0; i < numBatches; i++ )
+         job->mBatchDone.acquire();
+      PROFILE_END();
+   }
+
+   // The leaders are done, so copy their poses.
+   for ( U32 i = 0; i < mFollowers.size(); i++ )
+      mFollowers[i].entry.shape->copyPose( mFollowers[i].leader, mFollowers[i].entry.dl );
+
+   for ( U32 i = 0; i < mMainThreadEntries.size(); i++ )
+      mMainThreadEntries[i].shape->animate( mMainThreadEntries[i].dl );
+
+   mEntries.clear();
+   mFollowers.clear();
+   mMainThreadEntries.clear();
+}
@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSANIMATEBATCH_H_
+#define _TSANIMATEBATCH_H_
+
+#ifndef _TVECTOR_H_
+#include "core/util/tVector.h"
+#endif
+
+class TSShapeInstance;
+
+
+/// Animates a set of shape instances on the thread pool.
+///
+/// The scene collects the shapes which are about to be rendered with
+/// add() and then animates them all at once with run().  The shapes are
+/// split into batches which are claimed by the workers and the main
+/// thread, each using its own TSShapeInstance::AnimateScratch, and run()
+/// only returns once every shape is done.  Animating a shape which is
+/// already up to date is a no-op, so the following prepRenderImage()
+/// finds the node transforms ready.
+///
+/// Shapes with node callbacks are animated on the main thread after
+/// the workers are done since the callbacks may touch anything.
+///
+/// Before animating, the batch applies the animation lod.  If the shapes
+/// have more nodes to animate than the node budget allows, the smallest
+/// ones are throttled.  Of the rest, shapes which are small on screen and
+/// share a pose, the same sequence at nearly the same key position, are
+/// animated once and the others copy the node transforms.
+///
+/// @see TSShapeInstance::getAnimateInterval
+/// A shape must not be added more than once per run().
+///
+/// @see SceneObject::prepAnimation
+class TSAnimateBatch
+{
+public:
+
+   /// A queued shape.
+   struct Entry
+   {
+      TSShapeInstance *shape;
+      S32 dl;
+   };
+
+   TSAnimateBatch();
+
+   /// Queues the shape to be animated at the detail level.  Shapes
+   /// that are already animated for the detail are skipped.
+   void add( TSShapeInstance *shape, S32 dl );
+
+   /// Queues the shape to be animated at its current detail level.
+   void add( TSShapeInstance *shape );
+
+   /// Returns the number of queued shapes.
+   U32 size() const { return mEntries.size() + mMainThreadEntries.size(); }
+
+   /// Animates all the queued shapes and empties the batch.
+   void run();
+
+   /// Set from $pref::TS::parallelAnimation.  When disabled the 
+   /// scene doesn't batch the animation at all.
+   static bool smParallel;
+
+   /// The number of shapes a thread animates at a time, set 
+   /// from $pref::TS::parallelAnimationBatchSize.
+   static S32 smBatchSize;
+
+   /// The most nodes to animate in one run() or zero for no
+   /// limit, set from $pref::TS::animNodeBudget.
+   static S32 smNodeBudget;
+
+   /// The number of key positions between two keyframes small 
+   /// shapes can share a pose at, set from $pref::TS::animPoseShareSteps.
+   /// Zero disables the pose sharing.
+   static S32 smPoseShareSteps;
+
+   /// @name Statistics
+   /// The counts of the last run(), exposed as $TSAnimateStats::*.
+   /// @{
+   static S32 smNumAnimated;
+   static S32 smNumThrottled;
+   static S32 smNumShared;
+   static S32 smNumNodes;
+   /// @}
+
+protected:
+
+   /// A shape which copies the pose of another.
+   struct Follower
+   {
+      Entry entry;
+      const TSShapeInstance *leader;
+   };
+
+   /// Throttles the smallest shapes which don't fit the node budget.
+   void _applyBudget();
+
+   /// Moves the shapes that can copy the pose of another
+   /// entry from mEntries to mFollowers.
+   void _sharePoses();
+
+   Vector<Entry> mEntries;
+
+   Vector<Follower> mFollowers;
+
+   /// The shapes with node callbacks.
+   Vector<Entry> mMainThreadEntries;
+};
+
+#endif // _TSANIMATEBATCH_H_
@@ -0,0 +1,93 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+#include "platform/platform.h"
+#include "core/util/tSignal.h"
+#include "ts/tsTransform.h"
+#include "ts/tsAnimateIntrinsics.h"
+#include "ts/arch/tsAnimateIntrinsics.arch.h"
+
+void (*lerp_Quat16_SoA)(const S16 * __restrict key1, const S16 * __restrict key2, const dsize_t stride, const dsize_t count, const F32 t, const S32 * __restrict outIdx, QuatF * __restrict out) = NULL;
+void (*lerp_Point3F_SoA)(const F32 * __restrict key1, const F32 * __restrict key2, const dsize_t stride, const dsize_t count, const F32 t, const S32 * __restrict outIdx, Point3F * __restrict out) = NULL;
+
+//------------------------------------------------------------------------------
+// Default C++ Implementations
+//------------------------------------------------------------------------------
+
+void lerp_Quat16_SoA_C(const S16 * __restrict key1, 
+                       const S16 * __restrict key2,
+                       const dsize_t stride,
+                       const dsize_t count,
+                       const F32 t,
+                       const S32 * __restrict outIdx,
+                       QuatF * __restrict out)
+{
+   Quat16 k1, k2;
+   QuatF q1, q2;
+
+   for(dsize_t i = 0; i < count; i++)
+   {
+      k1.x = key1[i];
+      k1.y = key1[i + stride];
+      k1.z = key1[i + stride * 2];
+      k1.w = key1[i + stride * 3];
+
+      k2.x = key2[i];
+      k2.y = key2[i + stride];
+      k2.z = key2[i + stride * 2];
+      k2.w = key2[i + stride * 3];
+
+      TSTransform::interpolate(k1.getQuatF(&q1), k2.getQuatF(&q2), t, &out[outIdx[i]]);
+   }
+}
+
+//------------------------------------------------------------------------------
+
+void lerp_Point3F_SoA_C(const F32 * __restrict key1, 
+                        const F32 * __restrict key2,
+                        const dsize_t stride,
+                        const dsize_t count,
+                        const F32 t,
+                        const S32 * __restrict outIdx,
+                        Point3F * __restrict out)
+{
+   for(dsize_t i = 0; i < count; i++)
+   {
+      const Point3F p1(key1[i], key1[i + stride], key1[i + stride * 2]);
+      const Point3F p2(key2[i], key2[i + stride], key2[i + stride * 2]);
+      TSTransform::interpolate(p1, p2, t, &out[outIdx[i]]);
+   }
+}
+
+//------------------------------------------------------------------------------
+// Automatic initializer
+//------------------------------------------------------------------------------
+
+class _TSAnimateIntrinsics_REG
+{
+public:
+   _TSAnimateIntrinsics_REG()
+   {
+      // Assign defaults (C++ versions)
+      lerp_Quat16_SoA = lerp_Quat16_SoA_C;
+      lerp_Point3F_SoA = lerp_Point3F_SoA_C;
+
+      // Register for this signal
+      Platform::SystemInfoReady.notify(this, &_TSAnimateIntrinsics_REG::setImplementation);
+   }
+
+   // Find the best implementation for the current CPU
+   void setImplementation()
+   {
+#if defined(TORQUE_CPU_X86)
+      if(Platform::SystemInfo.processor.properties & CPU_PROP_SSE)
+         lerp_Point3F_SoA = lerp_Point3F_SoA_SSE;
+
+      // Decoding the 16 bit keys needs the SSE2 integer instructions.
+      if(Platform::SystemInfo.processor.properties & CPU_PROP_SSE2)
+         lerp_Quat16_SoA = lerp_Quat16_SoA_SSE2;
+#endif
+   }
+};
+static _TSAnimateIntrinsics_REG _sTSAnimateIntrinsicsReg;
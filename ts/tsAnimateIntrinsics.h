@@ -0,0 +1,51 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSANIMATEINTRINSICS_H_
+#define _TSANIMATEINTRINSICS_H_
+
+class QuatF;
+class Point3F;
+
+/// Interpolates rotation tracks between two keyframes stored as 
+/// structure of arrays Quat16 data.  The results match interpolating 
+/// each track with TSTransform::interpolate.
+///
+/// @param key1   The x array of the first keyframe followed by its y, z and w arrays
+/// @param key2   The arrays of the second keyframe
+/// @param stride Number of tracks in each array, a multiple of four
+/// @param count  Number of tracks to interpolate, at most stride
+/// @param t      Interpolation factor between the keyframes
+/// @param outIdx For each track, the index to write it to in out
+/// @param out    Output rotations
+extern void (*lerp_Quat16_SoA)
+                     (const S16 * __restrict key1, 
+                      const S16 * __restrict key2,
+                      const dsize_t stride,
+                      const dsize_t count,
+                      const F32 t,
+                      const S32 * __restrict outIdx,
+                      QuatF * __restrict out);
+
+/// Interpolates translation tracks between two keyframes stored as
+/// structure of arrays data.
+///
+/// @param key1   The x array of the first keyframe followed by its y and z arrays
+/// @param key2   The arrays of the second keyframe
+/// @param stride Number of tracks in each array, a multiple of four
+/// @param count  Number of tracks to interpolate, at most stride
+/// @param t      Interpolation factor between the keyframes
+/// @param outIdx For each track, the index to write it to in out
+/// @param out    Output translations
+extern void (*lerp_Point3F_SoA)
+                     (const F32 * __restrict key1, 
+                      const F32 * __restrict key2,
+                      const dsize_t stride,
+                      const dsize_t count,
+                      const F32 t,
+                      const S32 * __restrict outIdx,
+                      Point3F * __restrict out);
+
+#endif
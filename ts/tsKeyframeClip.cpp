@@ -0,0 +1,193 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "ts/tsShape.h"
+#include "ts/tsAnimateIntrinsics.h"
+
+
+void TSShape::initKeyframeClips()
+{
+   keyframeClips.clear();
+
+   if (!smUseKeyframeClips)
+      return;
+
+   keyframeClips.setSize(sequences.size());
+
+   for (S32 i=0; i<sequences.size(); i++)
+   {
+      const Sequence & seq = sequences[i];
+      KeyframeClip & clip = keyframeClips[i];
+      clip.numRotTracks = 0;
+      clip.numTransTracks = 0;
+
+      if (seq.numKeyframes<=0)
+         continue;
+
+      // sort the rotation tracks into changing and constant ones
+      S32 numTracks = seq.rotationMatters.count();
+      for (S32 j=0; j<numTracks; j++)
+      {
+         const Quat16 * keys = &nodeRotations[seq.baseRotation + j*seq.numKeyframes];
+
+         bool constant = true;
+         for (S32 k=1; k<seq.numKeyframes && constant; k++)
+            constant = keys[k]==keys[0];
+
+         if (constant)
+         {
+            // interpolating a key with itself still renormalizes it,
+            // so store what interpolation would give
+            QuatF q;
+            keys[0].getQuatF(&q);
+            clip.constRotations.increment();
+            TSTransform::interpolate(q,q,0.0f,&clip.constRotations.last());
+            clip.constRotTracks.push_back(j);
+         }
+         else
+            clip.rotTracks.push_back(j);
+      }
+
+      // lay out the changing tracks... all the x values of a 
+      // keyframe, then the y values and so on
+      clip.numRotTracks = (clip.rotTracks.size() + 3) & ~3;
+      clip.rotations.setSize(seq.numKeyframes * clip.numRotTracks * 4);
+      for (S32 k=0; k<seq.numKeyframes; k++)
+      {
+         S16 * dest = &clip.rotations[k * clip.numRotTracks * 4];
+         for (S32 j=0; j<clip.numRotTracks; j++)
+         {
+            Quat16 key;
+            if (j<clip.rotTracks.size())
+               key = nodeRotations[seq.baseRotation + clip.rotTracks[j]*seq.numKeyframes + k];
+            else
+               key.identity();
+
+            dest[j] = key.x;
+            dest[j + clip.numRotTracks] = key.y;
+            dest[j + clip.numRotTracks * 2] = key.z;
+            dest[j + clip.numRotTracks * 3] = key.w;
+         }
+      }
+
+      // and the same for translations
+      numTracks = seq.translationMatters.count();
+      for (S32 j=0; j<numTracks; j++)
+      {
+         const Point3F * keys = &nodeTranslations[seq.baseTranslation + j*seq.numKeyframes];
+
+         bool constant = true;
+         for (S32 k=1; k<seq.numKeyframes && constant; k++)
+            constant = keys[k]==keys[0];
+
+         if (constant)
+         {
+            clip.constTranslations.push_back(keys[0]);
+            clip.constTransTracks.push_back(j);
+         }
+         else
+            clip.transTracks.push_back(j);
+      }
+
+      clip.numTransTracks = (clip.transTracks.size() + 3) & ~3;
+      clip.translations.setSize(seq.numKeyframes * clip.numTransTracks * 3);
+      for (S32 k=0; k<seq.numKeyframes; k++)
+      {
+         F32 * dest = &clip.translations[k * clip.numTransTracks * 3];
+         for (S32 j=0; j<clip.numTransTracks; j++)
+         {
+            Point3F key(0.0f,0.0f,0.0f);
+            if (j<clip.transTracks.size())
+               key = nodeTranslations[seq.baseTranslation + clip.transTracks[j]*seq.numKeyframes + k];
+
+            dest[j] = key.x;
+            dest[j + clip.numTransTracks] = key.y;
+            dest[j + clip.numTransTracks * 2] = key.z;
+         }
+      }
+   }
+}
+
+void TSShape::sampleRotations(const Sequence & seq, S32 keyNum1, S32 keyNum2, F32 t, QuatF * outRots) const
+{
+   if (keyframeClips.size()!=sequences.size())
+   {
+      // no clips...interpolate the tracks one at a time
+      S32 numTracks = seq.rotationMatters.count();
+      for (S32 j=0; j<numTracks; j++)
+      {
+         QuatF q1,q2;
+         getRotation(seq,keyNum1,j,&q1);
+         getRotation(seq,keyNum2,j,&q2);
+         TSTransform::interpolate(q1,q2,t,&outRots[j]);
+      }
+      return;
+   }
+
+   const KeyframeClip & clip = keyframeClips[S32(&seq - sequences.address())];
+
+   for (S32 j=0; j<clip.constRotTracks.size(); j++)
+      outRots[clip.constRotTracks[j]] = clip.constRotations[j];
+
+   if (clip.rotTracks.size())
+   {
+      const S32 keySize = clip.numRotTracks * 4;
+      lerp_Quat16_SoA(  &clip.rotations[keyNum1 * keySize], 
+                        &clip.rotations[keyNum2 * keySize], 
+                        clip.numRotTracks, 
+                        clip.rotTracks.size(), 
+                        t, 
+                        clip.rotTracks.address(), 
+                        outRots );
+   }
+}
+
+void TSShape::sampleTranslations(const Sequence & seq, S32 keyNum1, S32 keyNum2, F32 t, Point3F * outTrans) const
+{
+   if (keyframeClips.size()!=sequences.size())
+   {
+      // no clips...interpolate the tracks one at a time
+      S32 numTracks = seq.translationMatters.count();
+      for (S32 j=0; j<numTracks; j++)
+      {
+         const Point3F & p1 = getTranslation(seq,keyNum1,j);
+         const Point3F & p2 = getTranslation(seq,keyNum2,j);
+         TSTransform::interpolate(p1,p2,t,&outTrans[j]);
+      }
+      return;
+   }
+
+   const KeyframeClip & clip = keyframeClips[S32(&seq - sequences.address())];
+
+   for (S32 j=0; j<clip.constTransTracks.size(); j++)
+      outTrans[clip.constTransTracks[j]] = clip.constTranslations[j];
+
+   if (clip.transTracks.size())
+   {
+      const S32 keySize = clip.numTransTracks * 3;
+      lerp_Point3F_SoA( &clip.translations[keyNum1 * keySize], 
+                        &clip.translations[keyNum2 * keySize], 
+                        clip.numTransTracks, 
+                        clip.transTracks.size(), 
+                        t, 
+                        clip.transTracks.address(), 
+                        outTrans );
+   }
+}
+
+U32 TSShape::getKeyframeClipsSize() const
+{
+   U32 size = keyframeClips.memSize();
+   for (S32 i=0; i<keyframeClips.size(); i++)
+   {
+      const KeyframeClip & clip = keyframeClips[i];
+      size += clip.rotations.memSize() + clip.rotTracks.memSize();
+      size += clip.constRotations.memSize() + clip.constRotTracks.memSize();
+      size += clip.translations.memSize() + clip.transTracks.memSize();
+      size += clip.constTranslations.memSize() + clip.constTransTracks.memSize();
+   }
+   return size;
+}
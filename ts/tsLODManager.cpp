@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "ts/tsLODManager.h"
+
+#include "math/mMathFn.h"
+#include "platform/platformIntrinsics.h"
+#include "platform/profiler.h"
+
+
+S32 TSLODManager::smPolyBudget = 0;
+S32 TSLODManager::smDrawCallBudget = 0;
+F32 TSLODManager::smMinBudgetScale = 0.25f;
+F32 TSLODManager::smHysteresis = 0.1f;
+
+S32 TSLODManager::smNumShapes = 0;
+S32 TSLODManager::smNumPolys = 0;
+S32 TSLODManager::smNumDrawCalls = 0;
+S32 TSLODManager::smNumReduced = 0;
+F32 TSLODManager::smCutoff = 0.0f;
+
+volatile U32 TSLODManager::smBucketShapes[NumBuckets];
+volatile U32 TSLODManager::smBucketPolys[NumBuckets];
+volatile U32 TSLODManager::smBucketDrawCalls[NumBuckets];
+volatile U32 TSLODManager::smFrameReduced = 0;
+
+/// How much the cutoff falls in a frame once the scene is
+/// under the budget.  A little over 6 frames per octave.
+static const F32 sCutoffFalloff = 0.9f;
+
+
+U32 TSLODManager::_getBucket( F32 priority )
+{
+   // Two buckets per octave, 2 / ln( 2 ).
+   if ( priority <= 1.0f )
+      return 0;
+
+   const S32 bucket = (S32)( mLog( priority ) * 2.88539f );
+   return getMin( bucket, (S32)NumBuckets - 1 );
+}
+
+F32 TSLODManager::_getBucketPriority( U32 bucket )
+{
+   return mPow( 2.0f, bucket * 0.5f );
+}
+
+void TSLODManager::addShape( F32 priority, U32 numPolys, U32 numDrawCalls )
+{
+   const U32 bucket = _getBucket( priority );
+   dFetchAndAdd( smBucketShapes[bucket], 1 );
+   dFetchAndAdd( smBucketPolys[bucket], numPolys );
+   dFetchAndAdd( smBucketDrawCalls[bucket], numDrawCalls );
+
+   if ( priority < smCutoff )
+      dFetchAndAdd( smFrameReduced, 1 );
+}
+
+F32 TSLODManager::getBudgetPixelSize( F32 pixelSize, F32 importance )
+{
+   const F32 priority = pixelSize * importance;
+   if ( priority >= smCutoff )
+      return pixelSize;
+
+   // The further below the cutoff the more the detail drops.
+   return pixelSize * getMax( priority / smCutoff, smMinBudgetScale );
+}
+
+void TSLODManager::beginFrame()
+{
+   PROFILE_SCOPE( TSLODManager_BeginFrame );
+
+   U32 numShapes = 0;
+   U32 numPolys = 0;
+   U32 numDrawCalls = 0;
+   F32 target = 0.0f;
+
+   // Walk the shapes from the most important down until
+   // one of the budgets runs out.
+   for ( S32 i = NumBuckets - 1; i >= 0; i-- )
+   {
+      numShapes += smBucketShapes[i];
+      numPolys += smBucketPolys[i];
+      numDrawCalls += smBucketDrawCalls[i];
+
+      const bool overBudget = ( smPolyBudget > 0 && numPolys > (U32)smPolyBudget ) ||
+                              ( smDrawCallBudget > 0 && numDrawCalls > (U32)smDrawCallBudget );
+
+      if ( overBudget && target == 0.0f )
+         target = _getBucketPriority( i + 1 );
+
+      smBucketShapes[i] = 0;
+      smBucketPolys[i] = 0;
+      smBucketDrawCalls[i] = 0;
+   }
+
+   // Go up right away, but come down slowly so that the
+   // shapes don't thrash around the budget.
+   if ( target >= smCutoff )
+      smCutoff = target;
+   else
+   {
+      smCutoff = getMax( target, smCutoff * sCutoffFalloff );
+      if ( smCutoff < 1.0f )
+         smCutoff = 0.0f;
+   }
+
+   smNumShapes = numShapes;
+   smNumPolys = numPolys;
+   smNumDrawCalls = numDrawCalls;
+   smNumReduced = smFrameReduced;
+   smFrameReduced = 0;
+}
@@ -0,0 +1,102 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSLODMANAGER_H_
+#define _TSLODMANAGER_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+
+/// Keeps the shapes rendered in a frame within a polygon and draw call
+/// budget by lowering the detail of the least important ones.
+///
+/// Every shape rendered in the diffuse pass reports the cost of the detail
+/// it would render without the budget along with its priority, which is its
+/// size on screen in pixels scaled by its importance.  The shapes are gathered
+/// in a histogram of priorities, so reporting is cheap and thread safe.  At
+/// the start of the next frame the main loop calls beginFrame(), which walks
+/// the histogram from the most important shapes down and finds the priority
+/// at which the budget runs out.
+/// Shapes below that cutoff select their detail from a smaller pixel size the
+/// further below the cutoff they are.
+///
+/// The cutoff rises as soon as the scene goes over the budget, but falls
+/// slowly once it is under so that detail doesn't come and go every frame.
+/// TSShapeInstance also keeps its detail level until the pixel size moves
+/// past the detail's range by smHysteresis.
+///
+/// @see TSShapeInstance::setLODImportance
+class TSLODManager
+{
+public:
+
+   enum
+   {
+      /// The number of priority buckets.  Each bucket covers
+      /// half an octave of pixel sizes.
+      NumBuckets = 32,
+   };
+
+   /// Adds a shape rendered at a detail with the polygon and draw call
+   /// counts to the current frame.  This is thread safe.
+   static void addShape( F32 priority, U32 numPolys, U32 numDrawCalls );
+
+   /// Returns the pixel size a shape should select its detail from.
+   static F32 getBudgetPixelSize( F32 pixelSize, F32 importance );
+
+   /// Finds the budget cutoff from the shapes of the last frame
+   /// and starts gathering a new frame.
+   static void beginFrame();
+
+   /// The most polygons to render in the diffuse pass or zero for
+   /// no limit, set from $pref::TS::lodPolyBudget.
+   static S32 smPolyBudget;
+
+   /// The most shape draw calls in the diffuse pass or zero for
+   /// no limit, set from $pref::TS::lodDrawCallBudget.
+   static S32 smDrawCallBudget;
+
+   /// The smallest factor the budget scales a pixel size
+   /// by, set from $pref::TS::lodMinBudgetScale.
+   static F32 smMinBudgetScale;
+
+   /// How far past the range of its detail in pixels, as a fraction of
+   /// the detail size, a shape has to be before it switches detail.  Set
+   /// from $pref::TS::lodHysteresis.
+   static F32 smHysteresis;
+
+   /// @name Statistics
+   /// The totals of the last frame before the budget was
+   /// applied, exposed as $TSLODStats::*.
+   /// @{
+   static S32 smNumShapes;
+   static S32 smNumPolys;
+   static S32 smNumDrawCalls;
+   static S32 smNumReduced;
+   /// @}
+
+   /// The priority below which shapes are reduced or zero 
+   /// when under the budget, exposed as $TSLODStats::cutoff.
+   static F32 smCutoff;
+
+protected:
+
+   /// Returns the bucket of the priority.
+   static U32 _getBucket( F32 priority );
+
+   /// Returns the lowest priority of the bucket.
+   static F32 _getBucketPriority( U32 bucket );
+
+   static volatile U32 smBucketShapes[NumBuckets];
+   static volatile U32 smBucketPolys[NumBuckets];
+   static volatile U32 smBucketDrawCalls[NumBuckets];
+
+   /// The shapes of the current frame below the cutoff.
+   static volatile U32 smFrameReduced;
+};
+
+#endif // _TSLODMANAGER_H_
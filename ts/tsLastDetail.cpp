@@ -18,12 +18,20 @@
 #include "core/stream/fileStream.h"
 #include "util/imposterCapture.h"
 #include "core/resourceManager.h"
+#include "core/volume.h"
+#include "core/util/hashFunction.h"
+#include "platform/threads/threadPool.h"
 
 #include "gfx/bitmap/ddsFile.h"
 #include "gfx/bitmap/ddsUtils.h"
 
 
 Vector<TSLastDetail*> TSLastDetail::smLastDetails;
+Vector<TSLastDetail*> TSLastDetail::smUpdates;
+
+bool TSLastDetail::smLazyUpdate = true;
+S32 TSLastDetail::smCapturesPerFrame = 1;
+bool TSLastDetail::smBakeInBackground = true;
 
 
 GFX_ImplementTextureProfile(TSImposterDiffuseTexProfile, 
@@ -37,6 +45,238 @@ GFX_ImplementTextureProfile(TSImposterNormalMapTexProfile,
                             GFXTextureProfile::None);
 
 
+enum
+{
+   /// Bump this when the atlas layout or compression
+   /// changes to invalidate the imposter caches.
+   ImposterCacheVersion = 1,
+
+   /// Give ourselves plenty of room for high quality billboards.
+   MaxImposterTexSize = 2048,
+};
+
+/// Returns the smallest power of two atlas which fits the images.
+static Point2I _getAtlasSize( S32 dim, U32 count )
+{
+   Point2I texSize( MaxImposterTexSize, MaxImposterTexSize );
+   while ( true )
+   {
+      Point2I halfSize( texSize.x / 2, texSize.y / 2 );
+      U32 fit = ( halfSize.x / dim ) * ( halfSize.y / dim );
+      if ( fit < count )
+      {
+         // Try half of the height.
+         fit = ( texSize.x / dim ) * ( halfSize.y / dim );
+         if ( fit >= count )
+            texSize.y = halfSize.y;
+         break;
+      }
+
+      texSize = halfSize;
+   }
+
+   return texSize;
+}
+
+/// Returns the position of an image in the atlas, which
+/// is filled a row at a time.
+static Point2I _getAtlasPos( S32 dim, const Point2I &texSize, U32 index )
+{
+   const U32 perRow = texSize.x / dim;
+   return Point2I( ( index % perRow ) * dim, ( index / perRow ) * dim );
+}
+
+/// Reads a cached atlas or returns NULL if it doesn't exist.
+static DDSFile* _readImposterDDS( const String &path )
+{
+   if ( !Torque::FS::IsFile( path ) )
+      return NULL;
+
+   FileStream stream;
+   if ( !stream.open( path, Torque::FS::File::Read ) )
+      return NULL;
+
+   DDSFile *dds = new DDSFile;
+   if ( !dds->read( stream ) )
+   {
+      delete dds;
+      return NULL;
+   }
+
+   dds->mSourcePath = path;
+   dds->mCacheString = path;
+   return dds;
+}
+
+
+struct TSLastDetail::UpdateItem : public ThreadPool::WorkItem
+{
+   typedef ThreadPool::WorkItem Parent;
+
+   ThreadSafeRef< UpdateJob > mJob;
+
+   UpdateItem( UpdateJob *job )
+      : mJob( job ) {}
+
+   // The pool may drop the item without executing it, in
+   // which case processUpdates() queues the stage again.
+   ~UpdateItem() { mJob->mBusy = 0; }
+
+protected:
+   virtual void execute()
+   {
+      if ( mJob->mStage == UpdateJob::Lookup )
+         mJob->lookup();
+      else if ( mJob->mStage == UpdateJob::Bake )
+         mJob->bake();
+   }
+};
+
+
+TSLastDetail::UpdateJob::UpdateJob()
+   :  mStage( Lookup ),
+      mBusy( 0 ),
+      mForceUpdate( false ),
+      mDl( 0 ),
+      mDim( 0 ),
+      mNumEquatorSteps( 0 ),
+      mNumPolarSteps( 0 ),
+      mPolarAngle( 0.0f ),
+      mIncludePoles( false ),
+      mImposterDDS( NULL ),
+      mNormalsDDS( NULL )
+{
+}
+
+TSLastDetail::UpdateJob::~UpdateJob()
+{
+   for ( U32 i=0; i < mBitmaps.size(); i++ )
+      delete mBitmaps[i];
+   for ( U32 i=0; i < mNormalMaps.size(); i++ )
+      delete mNormalMaps[i];
+
+   delete mImposterDDS;
+   delete mNormalsDDS;
+}
+
+void TSLastDetail::UpdateJob::lookup()
+{
+   PROFILE_SCOPE( TSLastDetail_UpdateJob_Lookup );
+
+   // The cache is keyed by the contents of the shape
+   // and every setting which changes the images.
+   U64 key = 0;
+   void *data;
+   U32 size;
+   if ( Torque::FS::ReadFile( mShapePath, data, size ) && data )
+   {
+      key = Torque::hash64( (const U8*)data, size, 0 );
+      delete [] (char*)data;
+   }
+
+   U32 polarAngle;
+   dMemcpy( &polarAngle, &mPolarAngle, sizeof( polarAngle ) );
+
+   const U32 settings[] =
+   {
+      (U32)ImposterCacheVersion,
+      (U32)mDl,
+      (U32)mDim,
+      mNumEquatorSteps,
+      mNumPolarSteps,
+      polarAngle,
+      (U32)mIncludePoles,
+   };
+   key = Torque::hash64( (const U8*)settings, sizeof( settings ), key );
+
+   const String keyStr = String::ToString( "%08x%08x", (U32)( key >> 32 ), (U32)( key & 0xFFFFFFFF ) );
+   mImposterPath = mShapePath + "." + keyStr + ".imposter.dds";
+   mNormalsPath = mShapePath + "." + keyStr + ".imposter_normals.dds";
+
+   if ( !mForceUpdate )
+   {
+      mImposterDDS = _readImposterDDS( mImposterPath );
+      mNormalsDDS = _readImposterDDS( mNormalsPath );
+   }
+
+   if ( mImposterDDS && mNormalsDDS )
+   {
+      mStage = Done;
+      return;
+   }
+
+   SAFE_DELETE( mImposterDDS );
+   SAFE_DELETE( mNormalsDDS );
+   mStage = Capture;
+}
+
+void TSLastDetail::UpdateJob::bake()
+{
+   PROFILE_SCOPE( TSLastDetail_UpdateJob_Bake );
+
+   mStage = Done;
+   if ( mBitmaps.empty() || mBitmaps.size() != mNormalMaps.size() )
+      return;
+
+   // NOTE: If imposters start rendering wrong, look at the 
+   // D3DTexture lock for swapped xy coords!
+
+   // Combine the impostors into a single texture 
+   // to allow for batch rendering.
+   const Point2I texSize = _getAtlasSize( mDim, mBitmaps.size() );
+
+   // Prepare a new texture for compositing.
+   GFXFormat format = mBitmaps.first()->getFormat();
+   GBitmap destBmp( texSize.x, texSize.y, false, format );
+   dMemset( destBmp.getWritableBits(), 0, texSize.x * texSize.y * (S32)GFXDevice::formatByteSize( format ) );
+
+   format = mNormalMaps.first()->getFormat();
+   GBitmap destNormal( texSize.x, texSize.y, false, format );
+   dMemset( destNormal.getWritableBits(), 0, texSize.x * texSize.y * (S32)GFXDevice::formatByteSize( format ) );
+
+   // Ok... pack in bitmaps till we run out.
+   for ( U32 i=0; i < mBitmaps.size(); i++ )
+   {
+      const Point2I pos = _getAtlasPos( mDim, texSize, i );
+      destBmp.copyRect( mBitmaps[i], RectI( 0, 0, mDim, mDim ), pos );
+      destNormal.copyRect( mNormalMaps[i], RectI( 0, 0, mDim, mDim ), pos );
+   }
+
+   // The box filter only averages 2x2 blocks, so it keeps the 
+   // cells apart until they shrink to a texel.  The wider Kaiser
+   // filter bleeds the neighboring imposters into each other.
+   destBmp.extrudeMipLevels();
+   destNormal.extrudeMipLevels();
+
+   DDSFile *ddsDest = DDSFile::createDDSFileFromGBitmap( &destBmp );
+   DDSUtil::compressDDS( ddsDest, GFXFormatDXT5 );
+
+   DDSFile *ddsNormals = DDSFile::createDDSFileFromGBitmap( &destNormal );
+   DDSUtil::compressDDS( ddsNormals, GFXFormatDXT1 );
+
+   FileStream fs;
+   if ( fs.open( mImposterPath, Torque::FS::File::Write ) )
+      ddsDest->write( fs );
+
+   fs.close();
+
+   if ( fs.open( mNormalsPath, Torque::FS::File::Write ) )
+      ddsNormals->write( fs );
+
+   fs.close();
+
+   // TODO: Move the "fizzle" generation in the alpha layer to
+   // after mip extrusion and do it for each mip.  Currently
+   // the mip extrusion will muddy the fizzle values with the
+   // lower layers becoming uniform grey.
+
+   ddsDest->mCacheString = mImposterPath;
+   ddsNormals->mCacheString = mNormalsPath;
+   mImposterDDS = ddsDest;
+   mNormalsDDS = ddsNormals;
+}
+
+
 TSLastDetail::TSLastDetail(   TSShape *shape,
                               const String &cachePath,
                               U32 numEquatorSteps,
@@ -52,6 +292,7 @@ TSLastDetail::TSLastDetail(   TSShape *shape,
    mShape = shape;
    mDl = dl;
    mDim = dim;
+   mUpdateFailed = false;
 
    mCachePath = cachePath;
 
@@ -59,6 +300,33 @@ TSLastDetail::TSLastDetail(   TSShape *shape,
    smLastDetails.push_back( this );
 
    mRadius = mShape->radius;
+
+   // Loop till they fit.
+   S32 newDim = mDim;
+   while ( newDim > 1 )
+   {
+      S32 maxImposters = ( MaxImposterTexSize / newDim ) * ( MaxImposterTexSize / newDim );
+      if ( _getImageCount() <= maxImposters )
+         break;
+
+      // There are too many imposters to fit a single 
+      // texture, so we fail.  These imposters are for
+      // rendering small distant objects.  If you need
+      // a really high resolution imposter or many images
+      // around the equator and poles, maybe you need a
+      // custom solution.
+
+      newDim /= 2;
+   }
+
+   if ( newDim != mDim )
+   {
+      Con::printf( "TSLastDetail( '%s' ) - Detail dimensions too big! Reduced from %d to %d.", 
+         mCachePath.c_str(),
+         mDim, newDim );
+
+      mDim = newDim;
+   }
 }
 
 TSLastDetail::~TSLastDetail()
@@ -66,17 +334,32 @@ TSLastDetail::~TSLastDetail()
    mTexture.free();
    mNormalMap.free();
 
+   // Any update in progress finishes on its own.
+   smUpdates.remove( this );
+
    // Remove ourselves from the list.
    Vector<TSLastDetail*>::iterator iter = find( smLastDetails.begin(), smLastDetails.end(), this );
    smLastDetails.erase( iter );
 }
 
+U32 TSLastDetail::_getImageCount() const
+{
+   return ( ( 2 * mNumPolarSteps ) + 1 ) * mNumEquatorSteps + ( mIncludePoles ? 2 : 0 );
+}
+
 void TSLastDetail::render( const TSRenderState &rdata, F32 alpha )
 {
-   // If the texture isn't setup... we have nothing to render.
+   // If the texture isn't setup... we have nothing to render.  The
+   // shape instance normally draws a mesh detail in the meantime.
+   // @see TSShapeInstance::setCurrentDetail
    if ( mTexture.isNull() )
-      return;
+   {
+      // Start loading the imposter the first time it's needed.
+      if ( smLazyUpdate )
+         requestUpdate();
 
+      return;
+   }
    const MatrixF &mat = GFX->getWorldMatrix();
 
    // Post a render instance for this imposter... the special
@@ -109,103 +392,191 @@ void TSLastDetail::render( const TSRenderState &rdata, F32 alpha )
    renderPass->addInst( ri );   
 }
 
+TSLastDetail::UpdateJob* TSLastDetail::_createUpdateJob() const
+{
+   UpdateJob *job = new UpdateJob;
+   job->mShapePath = mCachePath;
+   job->mDl = mDl;
+   job->mDim = mDim;
+   job->mNumEquatorSteps = mNumEquatorSteps;
+   job->mNumPolarSteps = mNumPolarSteps;
+   job->mPolarAngle = mPolarAngle;
+   job->mIncludePoles = mIncludePoles;
+   return job;
+}
+
 void TSLastDetail::update( bool forceUpdate )
 {
    // This should never be called on a dedicated server or
    // anywhere else where we don't have a GFX device!
    AssertFatal( GFXDevice::devicePresent(), "TSLastDetail::update() - Cannot update without a GFX device!" );
 
+   // Drop any update in progress, it finishes on its own.
+   mUpdateJob = NULL;
+   smUpdates.remove( this );
+   mUpdateFailed = false;
+
    // Clear the texture first.
    mTexture.free();
    mNormalMap.free();
    mTextureUVs.clear();
 
-   String imposterDDSPath = mCachePath + ".imposter.dds";
-   String normalsDDSPath = mCachePath + ".imposter_normals.dds";
+   ThreadSafeRef< UpdateJob > job = _createUpdateJob();
+   job->mForceUpdate = forceUpdate;
+   job->lookup();
 
-   // Get the date/time for the dts, 
-   // and the imposter DDS and imposter
-   // normals DDS.
-   FileTime dtsTime = {0}, imposterTime = {0}, normalsTime = {0};
-   Platform::getFileTimes( mCachePath.c_str(), NULL, &dtsTime );
-   Platform::getFileTimes( imposterDDSPath.c_str(), NULL, &imposterTime );
-   Platform::getFileTimes( normalsDDSPath.c_str(), NULL, &normalsTime );
+   if ( job->mStage == UpdateJob::Capture )
+   {
+      _capture( job );
+      job->bake();
+   }
 
-   // If the binary is newer... load that.
-   if ( !forceUpdate && Platform::compareFileTimes( imposterTime, dtsTime ) >= 0 && Platform::compareFileTimes( normalsTime, dtsTime ) >= 0 )
+   _finishUpdate( job );
+}
+
+void TSLastDetail::requestUpdate()
+{
+   if ( !mTexture.isNull() || mUpdateJob || mUpdateFailed )
+      return;
+
+   if ( !GFXDevice::devicePresent() )
+      return;
+
+   mUpdateJob = _createUpdateJob();
+   smUpdates.push_back( this );
+
+   _runUpdateJob( mUpdateJob );
+}
+
+void TSLastDetail::_runUpdateJob( UpdateJob *job )
+{
+   if ( smBakeInBackground )
    {
-      Torque::Path imposterTPath( imposterDDSPath );
-      Torque::Path normalTPath( normalsDDSPath );
+      job->mBusy = 1;
+      ThreadPool::GLOBAL().queueWorkItem( new UpdateItem( job ) );
+   }
+   else if ( job->mStage == UpdateJob::Lookup )
+      job->lookup();
+   else if ( job->mStage == UpdateJob::Bake )
+      job->bake();
+}
+
+void TSLastDetail::processUpdates()
+{
+   if ( smUpdates.empty() || !GFXDevice::devicePresent() )
+      return;
+
+   PROFILE_SCOPE( TSLastDetail_ProcessUpdates );
+
+   S32 captures = 0;
+   bool sceneBegun = true;
+
+   for ( U32 i=0; i < smUpdates.size(); )
+   {
+      TSLastDetail *detail = smUpdates[i];
+      UpdateJob *job = detail->mUpdateJob;
 
-      bool imposterRet = mTexture.set( imposterDDSPath, &TSImposterDiffuseTexProfile, avar( "TSImposterDiffuseTexProfile %s() - (line %d)", __FUNCTION__, __LINE__ ) );
-      bool normalsRet = mNormalMap.set( normalsDDSPath, &TSImposterNormalMapTexProfile, avar( "TSImposterNormalMapTexProfile %s() - (line %d)", __FUNCTION__, __LINE__ ) );
+      // Wait for the thread pool.
+      if ( job->mBusy )
+      {
+         i++;
+         continue;
+      }
 
-      if ( imposterRet && normalsRet )
+      switch ( job->mStage )
       {
-         Resource<DDSFile> imposterDDS = ResourceManager::get().load( imposterTPath );
-      
-         Point2I texSize( imposterDDS->getWidth(), imposterDDS->getHeight() );
-
-         // TODO: This doesn't account for the mDim being reduced 
-         // to fix the maximum imposter texture size.  We should 
-         // probably calculate that first.
-
-         // Ok... pack in bitmaps till we run out.
-         for ( S32 y=0; y < texSize.y; )
-         {
-            for ( S32 x=0; x < texSize.x; )
+         case UpdateJob::Lookup:
+         case UpdateJob::Bake:
+
+            // The work item was dropped without running.
+            _runUpdateJob( job );
+            i++;
+            continue;
+
+         case UpdateJob::Capture:
+
+            if ( captures >= smCapturesPerFrame )
+            {
+               i++;
+               continue;
+            }
+
+            if ( sceneBegun && !GFX->canCurrentlyRender() )
             {
-               // Store the uv for later lookup.
-               RectF info;
-               info.point.set( (F32)x / (F32)texSize.x, (F32)y / (F32)texSize.y );
-               info.extent.set( (F32)mDim / (F32)texSize.x, (F32)mDim / (F32)texSize.y );
-               mTextureUVs.push_back( info );
-               
-               x += mDim;
+               sceneBegun = false;
+               GFX->beginScene();
             }
 
-            y += mDim;
-         }
-         return;
+            detail->_capture( job );
+            captures++;
+
+            job->mStage = UpdateJob::Bake;
+            _runUpdateJob( job );
+            i++;
+            continue;
+
+         case UpdateJob::Done:
+            break;
       }
+
+      if ( !detail->_finishUpdate( job ) )
+      {
+         Con::errorf( "TSLastDetail::processUpdates() - Failed to update the imposter for '%s'!", detail->mCachePath.c_str() );
+         detail->mUpdateFailed = true;
+      }
+
+      detail->mUpdateJob = NULL;
+      smUpdates.erase( i );
    }
 
-   // Give ourselves plenty of room for high quality billboards.
-   const S32 maxTexSize = 2048;
+   if ( !sceneBegun )
+      GFX->endScene();
+}
 
-   // Loop till they fit.
-   S32 newDim = mDim;
-   while ( true )
-   {
-      S32 maxImposters = ( maxTexSize / newDim ) * ( maxTexSize / newDim );
-      S32 imposterCount = ( ((2*mNumPolarSteps) + 1 ) * mNumEquatorSteps ) + ( mIncludePoles ? 2 : 0 );
-      if ( imposterCount <= maxImposters )
-         break;
+bool TSLastDetail::_finishUpdate( UpdateJob *job )
+{
+   if ( !job->mImposterDDS || !job->mNormalsDDS )
+      return false;
 
-      // There are too many imposters to fit a single 
-      // texture, so we fail.  These imposters are for
-      // rendering small distant objects.  If you need
-      // a really high resolution imposter or many images
-      // around the equator and poles, maybe you need a
-      // custom solution.
+   // The job keeps ownership of the DDS files.
+   bool imposterRet = mTexture.set( job->mImposterDDS, &TSImposterDiffuseTexProfile, false, avar( "TSImposterDiffuseTexProfile %s() - (line %d)", __FUNCTION__, __LINE__ ) );
+   bool normalsRet = mNormalMap.set( job->mNormalsDDS, &TSImposterNormalMapTexProfile, false, avar( "TSImposterNormalMapTexProfile %s() - (line %d)", __FUNCTION__, __LINE__ ) );
 
-      newDim /= 2;
+   if ( !imposterRet || !normalsRet )
+   {
+      mTexture.free();
+      mNormalMap.free();
+      return false;
    }
 
-   if ( newDim != mDim )
+   _setTextureUVs( Point2I( job->mImposterDDS->getWidth(), job->mImposterDDS->getHeight() ) );
+   return true;
+}
+
+void TSLastDetail::_setTextureUVs( const Point2I &texSize )
+{
+   mTextureUVs.clear();
+
+   const U32 count = _getImageCount();
+   for ( U32 i=0; i < count; i++ )
    {
-      Con::printf( "TSLastDetail::update( '%s' ) - Detail dimensions too big! Reduced from %d to %d.", 
-         mCachePath.c_str(),
-         mDim, newDim );
+      const Point2I pos = _getAtlasPos( mDim, texSize, i );
 
-      mDim = newDim;
+      // Store the uv for later lookup.
+      RectF info;
+      info.point.set( (F32)pos.x / (F32)texSize.x, (F32)pos.y / (F32)texSize.y );
+      info.extent.set( (F32)mDim / (F32)texSize.x, (F32)mDim / (F32)texSize.y );
+      mTextureUVs.push_back( info );
    }
+}
 
+void TSLastDetail::_capture( UpdateJob *job )
+{
    const F32 equatorStepSize = M_2PI_F / (F32) mNumEquatorSteps;
    const F32 polarStepSize = mNumPolarSteps>0 ? (0.5f * M_PI_F - mPolarAngle) / (F32)mNumPolarSteps : 0.0f;
 
-   Vector<GBitmap*> bitmaps;
-   Vector<GBitmap*> normalmaps;
+   Vector<GBitmap*> &bitmaps = job->mBitmaps;
+   Vector<GBitmap*> &normalmaps = job->mNormalMaps;
 
    PROFILE_START(TSLastDetail_snapshots);
 
@@ -297,143 +668,6 @@ void TSLastDetail::update( bool forceUpdate )
 
    PROFILE_END();
 
-   // NOTE: If imposters start rendering wrong, look at the 
-   // D3DTexture lock for swapped xy coords!
-
-   // Combine the impostors into a single texture 
-   // to allow for batch rendering.
-
-   // Figure out the optimal texture size.
-   Point2I texSize( maxTexSize, maxTexSize );
-   while ( true )
-   {
-      Point2I halfSize( texSize.x / 2, texSize.y / 2 );
-      U32 count = ( halfSize.x / mDim ) * ( halfSize.y / mDim );
-      if ( count < bitmaps.size() )
-      {
-         // Try half of the height.
-         count = ( texSize.x / mDim ) * ( halfSize.y / mDim );
-         if ( count >= bitmaps.size() )
-            texSize.y = halfSize.y;
-         break;
-      }
-
-      texSize = halfSize;
-   }
-
-   // Prepare a new texture for compositing.
-   GFXFormat format = bitmaps.first()->getFormat();
-   GBitmap destBmp( texSize.x, texSize.y, false, format );
-   dMemset( destBmp.getWritableBits(), 0, texSize.x * texSize.y * (S32)GFXDevice::formatByteSize( format ) );
-
-   format = normalmaps.first()->getFormat();
-   GBitmap destNormal( texSize.x, texSize.y, false, format );
-   dMemset( destNormal.getWritableBits(), 0, texSize.x * texSize.y * (S32)GFXDevice::formatByteSize( format ) );
-
-   // Ok... pack in bitmaps till we run out.
-   for ( S32 y=0; y < texSize.y; )
-   {
-      for ( S32 x=0; x < texSize.x; )
-      {
-         // Copy the next bitmap to the dest texture.
-         GBitmap* bmp = bitmaps.first();
-         bitmaps.pop_front();
-         destBmp.copyRect( bmp, RectI( 0, 0, mDim, mDim ), Point2I( x, y ) );
-         delete bmp;
-
-         // Copy the next normal to the dest texture.
-         GBitmap* normalmap = normalmaps.first();
-         normalmaps.pop_front();
-         destNormal.copyRect( normalmap, RectI( 0, 0, mDim, mDim ), Point2I( x, y ) );
-         delete normalmap;
-
-         // Store the uv for later lookup.
-         RectF info;
-         info.point.set( (F32)x / (F32)texSize.x, (F32)y / (F32)texSize.y );
-         info.extent.set( (F32)mDim / (F32)texSize.x, (F32)mDim / (F32)texSize.y );
-         mTextureUVs.push_back( info );
-
-         // Did we finish?
-         if ( bitmaps.empty() )
-            break;
-         
-         x += mDim;
-      }
-
-      // Did we finish?
-      if ( bitmaps.empty() )
-         break;
-
-      y += mDim;
-   }
-
-
-   /*
-   // Should we dump the images?
-   if ( Con::getBoolVariable( "$TSLastDetail::dumpImposters", false ) )
-   {
-      FileStream stream;
-      if ( stream.open( imposterPath, Torque::FS::File::Write  ) )
-         destBmp.writeBitmap( "png", stream );
-      stream.close();
-
-      if ( stream.open( normalsPath, Torque::FS::File::Write ) )
-         destNormal.writeBitmap( "png", stream );
-      stream.close();
-   }
-   */
-
-   // DEBUG: Some code to force usage of a test image.
-   //GBitmap* tempMap = GBitmap::load( "./forest/data/test1234.png" );
-   //tempMap->extrudeMipLevels();
-   //mTexture.set( tempMap, &GFXDefaultStaticDiffuseProfile, false );
-   //delete tempMap;
-
-   // TODO: Full mips with the current generator makes
-   // everything look a bit too soft.  The Nvidia DDS 
-   // plugin with point sampled mips looks pretty good 
-   // as it preserves alot more detail.
-   //
-   // Look into adding some sort of sharpen filter to mip
-   // generation in the future.
-   //
-   destBmp.extrudeMipLevels();
-   destNormal.extrudeMipLevels();
-
-   DDSFile *ddsDest = DDSFile::createDDSFileFromGBitmap( &destBmp );
-   DDSUtil::squishDDS( ddsDest, GFXFormatDXT5 );
-
-   DDSFile *ddsNormals = DDSFile::createDDSFileFromGBitmap( &destNormal );
-   DDSUtil::squishDDS( ddsNormals, GFXFormatDXT1 );
-
-   if ( 1 )
-   {
-      FileStream fs;
-      if ( fs.open( imposterDDSPath, Torque::FS::File::Write ) )
-         ddsDest->write( fs );
-
-      fs.close();
-
-      if ( fs.open( normalsDDSPath, Torque::FS::File::Write ) )
-         ddsNormals->write( fs );
-
-      fs.close();
-   }
-
-   // TODO: Move the "fizzle" generation in the alpha layer to
-   // after mip extrusion and do it for each mip.  Currently
-   // the mip extrusion will muddy the fizzle values with the
-   // lower layers becoming uniform grey.
-
-
-   // Prep the mips and copy the dest bmp to the texture.
-   
-   mTexture.set( imposterDDSPath, &TSImposterDiffuseTexProfile, avar( "TSImposterDiffuseTexProfile %s() - (line %d)", __FUNCTION__, __LINE__ ) );
-   mNormalMap.set( normalsDDSPath, &TSImposterNormalMapTexProfile, avar( "TSImposterNormalMapTexProfile %s() - (line %d)", __FUNCTION__, __LINE__ ) );
-
-   delete ddsDest;
-   delete ddsNormals;
-
    delete imposterCap;
 }
 
@@ -464,5 +698,3 @@ ConsoleFunction(tsUpdateImposterImages, void, 1, 2, "tsUpdateImposterImages( boo
    else
       TSLastDetail::updateImposterImages();
 }
-
-
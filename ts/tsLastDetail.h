@@ -27,6 +27,9 @@
 #ifndef _GFXTEXTUREHANDLE_H_
 #include "gfx/gfxTextureHandle.h"
 #endif
+#ifndef _THREADSAFEREFCOUNT_H_
+#include "platform/threads/threadSafeRefCount.h"
+#endif
 
 
 class TSShape;
@@ -35,6 +38,7 @@ class TSRenderState;
 class GBitmap;
 class TextureHandle;
 class SceneState;
+struct DDSFile;
 
 
 
@@ -60,10 +64,94 @@ GFX_DeclareTextureProfile(TSImposterNormalMapTexProfile);
 /// when the model is first loaded as to keep the realtime render as fast as possible.
 /// It also renders the model from a few different perspectives so that it would actually
 /// pass as a model instead of a silly old billboard.  In other words, this is an imposter.
+///
+/// The imposter images are cached next to the shape in DDS files named after a
+/// hash of the shape file and the imposter settings, so a changed shape or
+/// setting never picks up a stale cache.
+///
+/// With smLazyUpdate the images are only loaded or captured the first time the
+/// billboard detail is selected.  The update then runs as a pipeline driven by
+/// processUpdates() once a frame: the cache lookup runs on the thread pool, the
+/// capture needs the device so it runs on the main thread, and compositing the
+/// atlas, building its mips, DXT compressing it and writing the cache are back
+/// on the thread pool.  Until the update is done the shape instance draws its
+/// lowest mesh detail in place of the billboard.
 class TSLastDetail
 {
 protected:
 
+   /// The work of one update, which is handed between the
+   /// main thread and the thread pool.
+   struct UpdateJob : public ThreadSafeRefCount< UpdateJob >
+   {
+      enum Stage
+      {
+         /// Hashing the shape and reading the cache.
+         Lookup,
+
+         /// Waiting for the capture on the main thread.
+         Capture,
+
+         /// Building and writing the atlas.
+         Bake,
+
+         /// Waiting for the textures to be created.
+         Done,
+      };
+
+      UpdateJob();
+      ~UpdateJob();
+
+      Stage mStage;
+
+      /// Set while the job is queued on the thread pool.
+      volatile U32 mBusy;
+
+      /// If true the cache isn't read.
+      bool mForceUpdate;
+
+      /// The settings which go into the cache key.
+      String mShapePath;
+      S32 mDl;
+      S32 mDim;
+      U32 mNumEquatorSteps;
+      U32 mNumPolarSteps;
+      F32 mPolarAngle;
+      bool mIncludePoles;
+
+      String mImposterPath;
+      String mNormalsPath;
+
+      /// The captured images in atlas order.
+      Vector<GBitmap*> mBitmaps;
+      Vector<GBitmap*> mNormalMaps;
+
+      /// The atlases, either read from the cache or baked.
+      DDSFile *mImposterDDS;
+      DDSFile *mNormalsDDS;
+
+      /// Finds the cache files and reads them if they exist.  Moves
+      /// on to the capture stage if they don't.
+      void lookup();
+
+      /// Composites the captured images into the atlases, compresses
+      /// them and writes them to the cache.
+      void bake();
+   };
+
+   /// Runs the lookup and bake stages on the thread pool.
+   struct UpdateItem;
+
+   /// The update in progress or NULL.
+   ThreadSafeRef< UpdateJob > mUpdateJob;
+
+   /// Set when a background update fails, so that
+   /// it isn't retried on every render.
+   bool mUpdateFailed;
+
+   /// The details with an update in progress.
+   static Vector<TSLastDetail*> smUpdates;
+
    /// The shape which we're impostering.
    TSShape *mShape;
 
@@ -117,6 +205,27 @@ protected:
    /// objects in the system.
    static Vector<TSLastDetail*> smLastDetails;
 
+   /// Returns the number of images in the atlas.
+   U32 _getImageCount() const;
+
+   /// Returns a new job for an update of this detail.
+   UpdateJob* _createUpdateJob() const;
+
+   /// Renders the images of the job on the main thread.  It is
+   /// virtual so that a test can fill in the images without
+   /// rendering a shape.
+   virtual void _capture( UpdateJob *job );
+
+   /// Creates the textures from the atlases of the job.
+   bool _finishUpdate( UpdateJob *job );
+
+   /// Sets up the UVs of the images in an atlas of the given size.
+   void _setTextureUVs( const Point2I &texSize );
+
+   /// Runs the lookup or bake stage of the job, on the
+   /// thread pool if smBakeInBackground is set.
+   static void _runUpdateJob( UpdateJob *job );
+
 public:
 
    TSLastDetail(  TSShape *shape, 
@@ -128,7 +237,18 @@ public:
                   S32 dl, 
                   S32 dim );
 
-   ~TSLastDetail();
+   virtual ~TSLastDetail();
+
+   /// If true the imposters are loaded or captured in the background the
+   /// first time they render instead of when the shape loads.
+   static bool smLazyUpdate;
+
+   /// The most imposters captured in a frame by processUpdates().
+   static S32 smCapturesPerFrame;
+
+   /// If true the atlases are composited, compressed and written to
+   /// the cache on the thread pool.
+   static bool smBakeInBackground;
 
    /// Calls update on all TSLastDetail objects in the system.
    /// @see update()
@@ -145,6 +265,18 @@ public:
    ///
    void update( bool forceUpdate = false );
 
+   /// Starts a background update if the imposter isn't loaded yet and
+   /// no update is in progress.
+   /// @see smLazyUpdate
+   void requestUpdate();
+
+   /// Returns true if the imposter textures are loaded.
+   bool isLoaded() const { return !mTexture.isNull(); }
+
+   /// Moves the background updates along, call this once a frame
+   /// outside of rendering.
+   static void processUpdates();
+
    /// Internal function called from TSShapeInstance to 
    /// submit an imposter render instance.
    void render( const TSRenderState &rdata, F32 alpha );
@@ -27,6 +27,7 @@
 #include "materials/matInstance.h"
 #include "renderInstance/renderPassManager.h"
 #include "materials/customMaterialDefinition.h"
+#include "materials/materialFeatureTypes.h"
 #include "gfx/util/triListOpt.h"
 #include "util/triRayCheck.h"
 
@@ -63,6 +64,9 @@ bool TSMesh::smUseTriangles = false; // convert all primitives to triangle lists
 bool TSMesh::smUseOneStrip  = true; // join triangle strips into one long strip on load
 S32  TSMesh::smMinStripSize = 1;     // smallest number of _faces_ allowed per strip (all else put in tri list)
 bool TSMesh::smUseEncodedNormals = false;
+bool TSMesh::smOptimizeOnWrite = true;
+bool TSMesh::smOptimizeReport = false;
+bool TSMesh::smWriteSharedVerts = false;
 
 const F32 TSMesh::VISIBILITY_EPSILON = 0.0001f;
 
@@ -125,7 +129,12 @@ void TSMesh::render( TSMaterialList *materials,
    innerRender( materials, rdata, mVB, mPB );
 }
 
-void TSMesh::innerRender( TSMaterialList *materials, const TSRenderState &rdata, TSVertexBufferHandle &vb, GFXPrimitiveBufferHandle &pb )
+void TSMesh::innerRender( TSMaterialList *materials, 
+                          const TSRenderState &rdata, 
+                          TSVertexBufferHandle &vb, 
+                          GFXPrimitiveBufferHandle &pb,
+                          const MatrixF *boneTransforms,
+                          U32 boneCount )
 {
    PROFILE_SCOPE( TSMesh_InnerRender );
 
@@ -185,6 +194,9 @@ void TSMesh::innerRender( TSMaterialList *materials, const TSRenderState &rdata,
 
    coreRI->materialHint = rdata.getMaterialHint();
 
+   coreRI->boneTransforms = boneTransforms;
+   coreRI->boneCount = boneCount;
+
    // Let the light manager fill the RIs light
    // vector with the current best lights.
    gClientSceneGraph->getLightManager()->getBestLights( coreRI->lights, 8 );
@@ -1079,6 +1091,8 @@ TSMesh::TSMesh() : meshType( StandardMeshType )
    mHasColor = false;
 
    mNumVerts = 0;
+
+   dMemset( &mOptimizeStats, 0, sizeof( mOptimizeStats ) );
 }
 
 //-----------------------------------------------------
@@ -1126,11 +1140,7 @@ void TSSkinMesh::updateSkin( const Vector<MatrixF> &transforms, TSVertexBufferHa
 
    // set up bone transforms
    PROFILE_START(TSSkinMesh_UpdateTransforms);
-   for( int i=0; i<batchData.nodeIndex.size(); i++ )
-   {
-      S32 node = batchData.nodeIndex[i];
-      sBoneTransforms[i].mul( transforms[node], batchData.initialTransforms[i] );
-   }
+   computeBoneTransforms( transforms, sBoneTransforms.address() );
    const MatrixF * matrices = &sBoneTransforms[0];
    PROFILE_END();
 
@@ -1215,6 +1225,98 @@ void TSSkinMesh::updateSkin( const Vector<MatrixF> &transforms, TSVertexBufferHa
    }
 }
 
+void TSSkinMesh::computeBoneTransforms( const Vector<MatrixF> &transforms, MatrixF *outPalette ) const
+{
+   for( S32 i=0; i < batchData.nodeIndex.size(); i++ )
+   {
+      S32 node = batchData.nodeIndex[i];
+      outPalette[i].mul( transforms[node], batchData.initialTransforms[i] );
+   }
+}
+
+S32 TSSkinMesh::getMaxBonesPerVert() const
+{
+   // The influences are grouped by vertex.
+   S32 maxBones = 0;
+   S32 count = 0;
+   for( S32 i=0; i < vertexIndex.size(); i++ )
+   {
+      if ( i == 0 || vertexIndex[i] != vertexIndex[i-1] )
+         count = 0;
+
+      maxBones = getMax( maxBones, ++count );
+   }
+
+   return maxBones;
+}
+
+bool TSSkinMesh::canSkinInHardware() const
+{
+   return   batchData.nodeIndex.size() <= SceneGraphData::MaxBoneTransforms &&
+            getMaxBonesPerVert() <= MaxHardwareBonesPerVert;
+}
+
+void TSSkinMesh::_setSkinData( bool bindBones )
+{
+   AssertFatal( mVertexFormat->hasBlendIndices(), "TSSkinMesh::_setSkinData() - The vertex format has no blend elements!" );
+
+   for( U32 i=0; i < mNumVerts; i++ )
+   {
+      __TSMeshVertexSkin &skin = mVertexData.skin( i );
+      skin._indices.set( 0.0f, 0.0f, 0.0f, 0.0f );
+      skin._weights.set( 1.0f, 0.0f, 0.0f, 0.0f );
+   }
+
+   if ( !bindBones )
+      return;
+
+   S32 count = 0;
+   for( S32 i=0; i < vertexIndex.size(); i++ )
+   {
+      if ( i == 0 || vertexIndex[i] != vertexIndex[i-1] )
+         count = 0;
+
+      AssertFatal( count < MaxHardwareBonesPerVert, "TSSkinMesh::_setSkinData() - Too many bones for the vertex!" );
+
+      __TSMeshVertexSkin &skin = mVertexData.skin( vertexIndex[i] );
+      ( (F32*)&skin._indices )[count] = (F32)boneIndex[i];
+      ( (F32*)&skin._weights )[count] = weight[i];
+      count++;
+   }
+}
+
+void TSSkinMesh::createHardwareSkinVBIB()
+{
+   if ( mNumVerts == 0 || mVB.isValid() )
+      return;
+
+   // Fill the shared buffer before the CPU skinning can
+   // ever overwrite the bind pose in the vertex data.
+   _setSkinData( true );
+
+   // The shared buffer never changes, so make it static.
+   const bool dynamic = mDynamic;
+   mDynamic = false;
+   _createVBIB( mVB, mPB );
+   mDynamic = dynamic;
+
+   // The instance buffers are skinned on the CPU.
+   _setSkinData( false );
+}
+
+bool TSSkinMesh::_hasHardwareSkinMaterials( TSMaterialList *materials ) const
+{
+   for ( S32 i = 0; i < primitives.size(); i++ )
+   {
+      const U32 matIndex = primitives[i].matIndex & TSDrawPrimitive::MaterialMask;
+      BaseMatInstance *matInst = materials->getMaterialInst( matIndex );
+      if ( !matInst || !matInst->getFeatures()[ MFT_HardwareSkinning ] )
+         return false;
+   }
+
+   return true;
+}
+
 S32 QSORT_CALLBACK _sort_BatchedVertWeight( const void *a, const void *b )
 {
    // Sort by vertex index
@@ -1365,6 +1467,22 @@ void TSSkinMesh::render(   TSMaterialList *materials,
    if(!batchDataInitialized)
       createBatchData();
 
+   // If we have the shared buffer then let the vertex shader blend
+   // the skin.  Materials which cannot, like custom materials, fall
+   // back to skinning on the CPU.
+   if ( mVB.isValid() && _hasHardwareSkinMaterials( materials ) )
+   {
+      PROFILE_SCOPE( TSSkinMesh_HardwareSkin );
+
+      RenderPassManager *renderPass = rdata.getSceneState()->getRenderPass();
+      const U32 boneCount = batchData.nodeIndex.size();
+      MatrixF *boneTransforms = renderPass->allocUniqueXforms( boneCount );
+      computeBoneTransforms( transforms, boneTransforms );
+
+      innerRender( materials, rdata, mVB, mPB, boneTransforms, boneCount );
+      return;
+   }
+
    const bool vertsChanged = vertexBuffer.isNull() || vertexBuffer->mNumVerts != mNumVerts;
    const bool primsChanged = primitiveBuffer.isNull() || primitiveBuffer->mIndexCount != indices.size();
 
@@ -2447,6 +2565,114 @@ void TSMesh::assemble( bool skip )
       createTangents(verts, norms);
 }
 
+/// Copies the elements to the tsalloc buffer in the given
+/// order, or as they are if there is no order for them.
+template<class T>
+static void copyToBufferOrdered32( const Vector<T> &vec, const Vector<U32> &order )
+{
+   const S32 elemSize = sizeof( T ) / sizeof( S32 );
+   if ( order.size() != vec.size() )
+   {
+      tsalloc.copyToBuffer32( (S32*)vec.address(), elemSize * vec.size() );
+      return;
+   }
+
+   for ( S32 i = 0; i < order.size(); i++ )
+      tsalloc.copyToBuffer32( (S32*)&vec[ order[i] ], elemSize );
+}
+
+void TSMesh::_optimizeForWrite( Vector<U32> &outIndices, Vector<U32> &outVertOrder )
+{
+   outIndices = indices;
+   outVertOrder.clear();
+   dMemset( &mOptimizeStats, 0, sizeof( mOptimizeStats ) );
+
+   if ( !smOptimizeOnWrite || indices.empty() )
+      return;
+
+   U32 numVerts = 0;
+   for ( S32 i = 0; i < indices.size(); i++ )
+      numVerts = getMax( numVerts, indices[i] + 1 );
+
+   // Sorted meshes keep the order of their clusters.
+   const U32 type = getMeshType();
+   const bool sortOverdraw = ( type == StandardMeshType || type == SkinMeshType ) && numVerts <= (U32)verts.size();
+
+   // Only indexed triangle lists are reordered.
+   Vector<U32> triIndices;
+   for ( S32 i = 0; i < primitives.size(); i++ )
+   {
+      const TSDrawPrimitive &prim = primitives[i];
+      if ( ( prim.matIndex & TSDrawPrimitive::TypeMask ) != TSDrawPrimitive::Triangles ||
+           !( prim.matIndex & TSDrawPrimitive::Indexed ) ||
+           prim.numElements < 3 )
+         continue;
+
+      U32 *primIndices = outIndices.address() + prim.start;
+      for ( S32 j = 0; j < prim.numElements; j++ )
+         triIndices.push_back( primIndices[j] );
+
+      FrameTemp<TriListOpt::IndexType> tmpIdxs( prim.numElements );
+      TriListOpt::OptimizeTriangleOrdering( numVerts, prim.numElements, primIndices, ~tmpIdxs );
+      dCopyArray( primIndices, ~tmpIdxs, prim.numElements );
+
+      if ( sortOverdraw )
+         TriListOpt::OptimizeOverdraw( numVerts, prim.numElements, primIndices, verts.address() );
+   }
+
+   if ( triIndices.empty() )
+      return;
+
+   TriListOpt::CacheStats stats;
+   TriListOpt::CalcCacheStats( numVerts, triIndices.size(), triIndices.address(), &stats );
+   mOptimizeStats.numTris = triIndices.size() / 3;
+   mOptimizeStats.acmrBefore = stats.acmr;
+   mOptimizeStats.atvrBefore = stats.atvr;
+
+   triIndices.clear();
+   for ( S32 i = 0; i < primitives.size(); i++ )
+   {
+      const TSDrawPrimitive &prim = primitives[i];
+      if ( ( prim.matIndex & TSDrawPrimitive::TypeMask ) == TSDrawPrimitive::Triangles &&
+           ( prim.matIndex & TSDrawPrimitive::Indexed ) &&
+           prim.numElements >= 3 )
+      {
+         for ( S32 j = 0; j < prim.numElements; j++ )
+            triIndices.push_back( outIndices[ prim.start + j ] );
+      }
+   }
+
+   TriListOpt::CalcCacheStats( numVerts, triIndices.size(), triIndices.address(), &stats );
+   mOptimizeStats.acmrAfter = stats.acmr;
+   mOptimizeStats.atvrAfter = stats.atvr;
+
+   // The vertices can only be reordered if nothing but our own indices
+   // refer to them.  Skinned meshes are referenced by their vertex
+   // weights, and animated meshes have more than one set of vertices.
+   const S32 numAllVerts = verts.size();
+   if (  type != StandardMeshType ||
+         parentMesh >= 0 ||
+         smWriteSharedVerts ||
+         vertsPerFrame != numAllVerts ||
+         numVerts > (U32)numAllVerts ||
+         ( !tverts.empty() && tverts.size() != numAllVerts ) ||
+         ( !tverts2.empty() && tverts2.size() != numAllVerts ) ||
+         ( !colors.empty() && colors.size() != numAllVerts ) ||
+         ( !norms.empty() && norms.size() != numAllVerts ) ||
+         ( !encodedNorms.empty() && encodedNorms.size() != numAllVerts ) )
+      return;
+
+   Vector<U32> remap;
+   remap.setSize( numAllVerts );
+   TriListOpt::OptimizeVertexFetch( numAllVerts, outIndices.size(), outIndices.address(), remap.address() );
+
+   outVertOrder.setSize( numAllVerts );
+   for ( S32 i = 0; i < numAllVerts; i++ )
+      outVertOrder[ remap[i] ] = i;
+
+   mOptimizeStats.remapped = true;
+}
+
 void TSMesh::disassemble()
 {
    tsalloc.setGuard();
@@ -2485,32 +2711,38 @@ void TSMesh::disassemble()
       }
    }
 
+   // optimize triangle draw order and vertex order during disassemble,
+   // the vertices are written in the new order if there is one
+   Vector<U32> optIndices;
+   Vector<U32> vertOrder;
+   _optimizeForWrite( optIndices, vertOrder );
+
    // verts...
    tsalloc.set32( verts.size() );
    if ( parentMesh < 0 )
-      tsalloc.copyToBuffer32( (S32*)verts.address(), 3 * verts.size() ); // if no parent mesh, then save off our verts
+      copyToBufferOrdered32( verts, vertOrder ); // if no parent mesh, then save off our verts
 
    // tverts...
    tsalloc.set32( tverts.size() );
    if ( parentMesh < 0 )
-      tsalloc.copyToBuffer32( (S32*)tverts.address(), 2 * tverts.size() ); // if no parent mesh, then save off our tverts
+      copyToBufferOrdered32( tverts, vertOrder ); // if no parent mesh, then save off our tverts
 
    if (TSShape::smVersion > 25)
    {
       // tverts2...
       tsalloc.set32( tverts2.size() );
       if ( parentMesh < 0 )
-         tsalloc.copyToBuffer32( (S32*)tverts2.address(), 2 * tverts2.size() ); // if no parent mesh, then save off our tverts
+         copyToBufferOrdered32( tverts2, vertOrder ); // if no parent mesh, then save off our tverts
 
       // colors
       tsalloc.set32( colors.size() );
       if ( parentMesh < 0 )
-         tsalloc.copyToBuffer32( (S32*)colors.address(), colors.size() ); // if no parent mesh, then save off our tverts
+         copyToBufferOrdered32( colors, vertOrder ); // if no parent mesh, then save off our tverts
    }
 
    // norms...
    if ( parentMesh < 0 ) // if no parent mesh, then save off our norms
-      tsalloc.copyToBuffer32( (S32*)norms.address(), 3 * norms.size() ); // norms.size()==verts.size() or error...
+      copyToBufferOrdered32( norms, vertOrder ); // norms.size()==verts.size() or error...
 
    // encoded norms...
    if ( parentMesh < 0 )
@@ -2518,22 +2750,12 @@ void TSMesh::disassemble()
       // if no parent mesh, compute encoded normals and copy over
       for ( S32 i = 0; i < norms.size(); i++ )
       {
-         U8 normIdx = encodedNorms.size() ? encodedNorms[i] : encodeNormal( norms[i] );
+         const S32 idx = vertOrder.empty() ? i : vertOrder[i];
+         U8 normIdx = encodedNorms.size() ? encodedNorms[idx] : encodeNormal( norms[idx] );
          tsalloc.copyToBuffer8( (S8*)&normIdx, 1 );
       }
    }
 
-   // optimize triangle draw order during disassemble
-   FrameTemp<TriListOpt::IndexType> tmpIdxs(indices.size());
-   for ( S32 i = 0; i < primitives.size(); i++ )
-   {
-      const TSDrawPrimitive& prim = primitives[i];
-      TriListOpt::OptimizeTriangleOrdering(verts.size(), prim.numElements,
-         indices.address() + prim.start, tmpIdxs.address());
-      dCopyArray(indices.address() + prim.start, tmpIdxs.address(), 
-         prim.numElements);
-   }
-
    if (TSShape::smVersion > 25)
    {
       // primitives...
@@ -2541,8 +2763,8 @@ void TSMesh::disassemble()
       tsalloc.copyToBuffer32((S32*)primitives.address(),3*primitives.size());
 
       // indices...
-      tsalloc.set32(indices.size());
-      tsalloc.copyToBuffer32((S32*)indices.address(),indices.size());
+      tsalloc.set32(optIndices.size());
+      tsalloc.copyToBuffer32((S32*)optIndices.address(),optIndices.size());
    }
    else
    {
@@ -2559,10 +2781,10 @@ void TSMesh::disassemble()
       }
 
       // indices
-      tsalloc.set32(indices.size());
-      Vector<S16> s16_indices(indices.size());
-      for (S32 i=0; i<indices.size(); i++)
-         s16_indices.push_back((S16)indices[i]);
+      tsalloc.set32(optIndices.size());
+      Vector<S16> s16_indices(optIndices.size());
+      for (S32 i=0; i<optIndices.size(); i++)
+         s16_indices.push_back((S16)optIndices[i]);
       tsalloc.copyToBuffer16(s16_indices.address(), s16_indices.size());
    }
 
@@ -2848,6 +3070,8 @@ void TSMesh::convertToAlignedMeshData()
 {
    if(!mVertexData.isReady())
       _convertToAlignedMeshData(mVertexData, verts, norms);
+   else
+      _resizeAlignedMeshData();
 }
 
 
@@ -2855,6 +3079,37 @@ void TSSkinMesh::convertToAlignedMeshData()
 {
    if(!mVertexData.isReady())
       _convertToAlignedMeshData(mVertexData, batchData.initialVerts, batchData.initialNorms);
+   else
+      _resizeAlignedMeshData();
+}
+
+void TSMesh::_resizeAlignedMeshData()
+{
+   const dsize_t oldSize = mVertexData.vertSize();
+   if(mNumVerts == 0 || oldSize == mVertSize)
+      return;
+
+   // The layouts share their leading elements, so keep those
+   // and leave the rest zeroed like a fresh conversion does.
+   const bool hasSkinData = mVertexFormat && mVertexFormat->hasBlendIndices();
+   const dsize_t baseSize = hasSkinData ? mVertSize - sizeof(__TSMeshVertexSkin) : mVertSize;
+   const dsize_t copySize = getMin(oldSize, baseSize);
+
+   U8 *aligned_mem = reinterpret_cast<U8 *>(dAligned_malloc(mVertSize * mNumVerts, 16));
+   AssertFatal(aligned_mem, "Aligned malloc failed! Debug!");
+   dMemset(aligned_mem, 0, mVertSize * mNumVerts);
+
+   const U8 *src = reinterpret_cast<const U8 *>(mVertexData.address());
+   for(U32 i = 0; i < mNumVerts; i++)
+      dMemcpy(aligned_mem + i * mVertSize, src + i * oldSize, copySize);
+
+   mVertexData.set(aligned_mem, mVertSize, mNumVerts);
+
+   if(hasSkinData)
+   {
+      for(U32 i = 0; i < mNumVerts; i++)
+         mVertexData.skin(i)._weights.set(1.0f, 0.0f, 0.0f, 0.0f);
+   }
 }
 
 void TSMesh::_convertToAlignedMeshData( TSMeshVertexArray &vertexData, const Vector<Point3F> &_verts, const Vector<Point3F> &_norms )
@@ -2909,6 +3164,10 @@ void TSMesh::_convertToAlignedMeshData( TSMeshVertexArray &vertexData, const Vec
    dMemset(aligned_mem, 0, mNumVerts * mVertSize);
    vertexData.set(aligned_mem, mVertSize, mNumVerts);
 
+   // Bind every vertex to the first bone in case the mesh 
+   // is part of a shape which is skinned in hardware.
+   const bool hasSkinData = mVertexFormat && mVertexFormat->hasBlendIndices();
+
    for(U32 i = 0; i < mNumVerts; i++)
    {
       __TSMeshVertexBase &v = vertexData[i];
@@ -2922,6 +3181,8 @@ void TSMesh::_convertToAlignedMeshData( TSMeshVertexArray &vertexData, const Vec
          v.tvert2(tverts2[i]);
       if(mHasColor && i < colors.size())
          v.color(colors[i]);
+      if(hasSkinData)
+         vertexData.skin(i)._weights.set(1.0f, 0.0f, 0.0f, 0.0f);
    }
 
    // Now that the data is in the aligned struct, free the Vector memory
@@ -51,6 +51,8 @@ class TSShapeInstance;
 struct RayInfo;
 class ConvexFeature;
 class ShapeBase;
+class TSShapeImageWriter;
+class TSShapeImageReader;
 
 struct TSDrawPrimitive
 {
@@ -101,6 +103,10 @@ class TSMesh
    GFXPrimitiveBufferHandle mPB;
 
    void _convertToAlignedMeshData( TSMeshVertexArray &vertexData, const Vector<Point3F> &_verts, const Vector<Point3F> &_norms );
+
+   /// Moves the aligned vertex data to the current vertex size when it
+   /// was created with another one, like when read from a shape image.
+   void _resizeAlignedMeshData();
    void _createVBIB( TSVertexBufferHandle &vb, GFXPrimitiveBufferHandle &pb );
 
   public:
@@ -171,6 +177,15 @@ class TSMesh
       GFXVertexColor _color;
       F32 _tvert3;  // Unused, but needed for alignment purposes
    };
+
+   /// The bone indices and weights which are appended to every
+   /// vertex when the shape is skinned in the vertex shader.
+   /// @see TSShape::smUseHardwareSkinning
+   struct __TSMeshVertexSkin
+   {
+      Point4F _indices;
+      Point4F _weights;
+   };
 #pragma pack()
 
    struct TSMeshVertexArray
@@ -190,6 +205,9 @@ class TSMesh
       // Vector-like interface
       __TSMeshVertexBase &operator[](int idx) const { AssertFatal(idx < numElements, "Out of bounds access!"); return *reinterpret_cast<__TSMeshVertexBase *>(base + idx * vertSz); }
       __TSMeshVertexBase *address() const { return reinterpret_cast<__TSMeshVertexBase *>(base); }
+
+      // Don't call this unless the vertex format has the blend elements.
+      __TSMeshVertexSkin &skin(int idx) const { AssertFatal(idx < numElements, "Out of bounds access!"); return *reinterpret_cast<__TSMeshVertexSkin *>(base + (idx + 1) * vertSz - sizeof(__TSMeshVertexSkin)); }
       U32 size() const { return numElements; }
       dsize_t mem_size() const { return numElements * vertSz; }
       dsize_t vertSize() const { return vertSz; }
@@ -262,7 +280,12 @@ class TSMesh
                         TSVertexBufferHandle &vertexBuffer,
                         GFXPrimitiveBufferHandle &primitiveBuffer );
 
-   void innerRender( TSMaterialList *, const TSRenderState &data, TSVertexBufferHandle &vb, GFXPrimitiveBufferHandle &pb );
+   void innerRender( TSMaterialList *, 
+                     const TSRenderState &data, 
+                     TSVertexBufferHandle &vb, 
+                     GFXPrimitiveBufferHandle &pb,
+                     const MatrixF *boneTransforms = NULL,
+                     U32 boneCount = 0 );
 
    /// @}
 
@@ -305,7 +328,46 @@ class TSMesh
    static TSMesh* assembleMesh( U32 meshType, bool skip );
    virtual void disassemble();
 
+   /// The vertex cache efficiency of the triangle lists of the
+   /// mesh before and after it was last optimized for writing.
+   /// @see TriListOpt::CalcCacheStats
+   struct OptimizeStats
+   {
+      U32 numTris;
+      F32 acmrBefore;
+      F32 acmrAfter;
+      F32 atvrBefore;
+      F32 atvrAfter;
+
+      /// True if the vertices were reordered as well as the triangles.
+      bool remapped;
+   };
+
+   const OptimizeStats& getOptimizeStats() const { return mOptimizeStats; }
+
+protected:
+
+   OptimizeStats mOptimizeStats;
+
+   /// Returns the indices optimized for the vertex cache and overdraw and,
+   /// if the vertices can be reordered, the new vertex order where each
+   /// element is the old index of the vertex.  Otherwise outVertOrder is
+   /// left empty.
+   void _optimizeForWrite( Vector<U32> &outIndices, Vector<U32> &outVertOrder );
+
+public:
+
+   /// Writes and reads the mesh in a shape runtime image.
+   /// @see TSShapeImage
+   virtual void writeImage( TSShapeImageWriter &writer );
+   virtual void readImage( TSShapeImageReader &reader );
+
    void createVBIB();
+
+   /// Sets the vertex format and size which are shared by
+   /// all the meshes of a shape.
+   void setVertexFormat( const GFXVertexFormat *format, U32 vertSize ) { mVertexFormat = format; mVertSize = vertSize; }
+
    void createTangents(const Vector<Point3F> &_verts, const Vector<Point3F> &_norms);
    void findTangent( U32 index1, 
                      U32 index2, 
@@ -320,6 +382,17 @@ class TSMesh
    static S32  smMinStripSize;
    static bool smUseEncodedNormals;
 
+   /// Optimize the triangle and vertex order of the meshes when
+   /// a shape is written.  The meshes themselves are unchanged.
+   static bool smOptimizeOnWrite;
+
+   /// Print the vertex cache statistics of each mesh when a shape is written.
+   static bool smOptimizeReport;
+
+   /// Set by TSShape::disassembleShape if any mesh of the shape uses
+   /// the vertices of another, in which case they can't be reordered.
+   static bool smWriteSharedVerts;
+
    /// convert primitives on load...
    void convertToTris(const TSDrawPrimitive *primitivesIn, const S32 *indicesIn,
                       S32 numPrimIn, S32 & numPrimOut, S32 & numIndicesOut,
@@ -462,6 +535,39 @@ public:
    void createBatchData();
    virtual void convertToAlignedMeshData();
 
+   /// The most bones which can influence a vertex
+   /// when skinning in the vertex shader.
+   enum { MaxHardwareBonesPerVert = 4 };
+
+   /// Returns the most bones which influence a single vertex.
+   S32 getMaxBonesPerVert() const;
+
+   /// Returns true if the skin fits the limits for
+   /// skinning in the vertex shader.
+   bool canSkinInHardware() const;
+
+   /// Creates the shared vertex buffer with the bind pose and
+   /// the bone indices and weights for skinning in the vertex
+   /// shader.  The vertex format must have the blend elements.
+   void createHardwareSkinVBIB();
+
+   /// Fills the bone palette which is used to skin the mesh.
+   /// @param transforms   The node transforms of the shape instance.
+   /// @param outPalette   An array with a matrix for every bone.
+   void computeBoneTransforms( const Vector<MatrixF> &transforms, MatrixF *outPalette ) const;
+
+protected:
+
+   /// Sets the bone indices and weights in the vertex data.  If
+   /// bindBones is false every vertex is bound to the first bone
+   /// with a full weight, which is what the vertex shader needs
+   /// for vertices which were already skinned on the CPU.
+   void _setSkinData( bool bindBones );
+
+   /// Returns true if every material of the mesh blends 
+   /// the skin in the vertex shader.
+   bool _hasHardwareSkinMaterials( TSMaterialList *materials ) const;
+
 public:
    typedef TSMesh Parent;
 
@@ -496,6 +602,8 @@ public:
    /// persist methods...
    void assemble( bool skip );
    void disassemble();
+   void writeImage( TSShapeImageWriter &writer );
+   void readImage( TSShapeImageReader &reader );
 
    /// variables used during assembly (for skipping mesh detail levels
    /// on load and for sharing verts between meshes)
@@ -11,6 +11,8 @@
 #include "collision/convex.h"
 #include "materials/matInstance.h"
 #include "materials/materialManager.h"
+#include "materials/materialFeatureTypes.h"
+#include "shaderGen/featureMgr.h"
 #include "math/mathIO.h"
 #include "core/util/endian.h"
 #include "core/stream/fileStream.h"
@@ -37,6 +39,12 @@ F32 TSShape::smAlphaOutDefault = -1.0f;
 // always load last renderable detail)
 S32 TSShape::smNumSkipLoadDetails = 0;
 
+bool TSShape::smUseHardwareSkinning = true;
+
+bool TSShape::smUseKeyframeClips = true;
+
+bool TSShape::smUseImages = true;
+
 bool TSShape::smInitOnRead = true;
 
 
@@ -210,6 +218,30 @@ S32 TSShape::findDetail(S32 nameIndex) const
    return -1;
 }
 
+S32 TSShape::findDetailBySize(F32 pixelSize) const
+{
+   if ( pixelSize <= mSmallestVisibleSize )
+      return -1;
+
+   // scan shape for highest detail size smaller than us...
+   // shapes details are sorted from largest to smallest...
+   // a detail of size <= 0 means it isn't a renderable detail level (utility detail)
+   for (S32 i=0; i<details.size(); i++)
+   {
+      if ( pixelSize > details[i].size )
+         return i;
+
+      if ( i + 1 >= details.size() || details[i+1].size < 0 )
+      {
+         // We've run out of details and haven't found anything?
+         // Let's just grab this one.
+         return i;
+      }
+   }
+
+   return -1;
+}
+
 S32 TSShape::findSequence(S32 nameIndex) const
 {
    for (S32 i=0; i<sequences.size(); i++)
@@ -450,15 +482,18 @@ void TSShape::init()
       }
    }
 
+   mDetailDrawCalls.setSize(details.size());
    for (i=0; i<details.size(); i++)
    {
       S32 count = 0;
+      S32 drawCalls = 0;
       S32 ss = details[i].subShapeNum;
       S32 od = details[i].objectDetailNum;
       if (ss<0)
       {
          // billboard detail...
          count += 2;
+         mDetailDrawCalls[i] = 1;
          continue;
       }
       S32 start = subShapeFirstObject[ss];
@@ -470,9 +505,11 @@ void TSShape::init()
          {
             TSMesh * mesh = meshes[obj.startMeshIndex+od];
             count += mesh ? mesh->getNumPolys() : 0;
+            drawCalls += mesh ? mesh->primitives.size() : 0;
          }
       }
       details[i].polyCount = count;
+      mDetailDrawCalls[i] = drawCalls;
    }
 
    // Init the collision accelerator array.  Note that we don't compute the
@@ -497,6 +534,7 @@ void TSShape::init()
          detailCollisionAccelerators[dca] = NULL;
    }
 
+   initKeyframeClips();
    initVertexFeatures();
    initMaterialList();
 }
@@ -514,11 +552,13 @@ void TSShape::initVertexFeatures()
             (  mesh->getMeshType() == TSMesh::StandardMeshType ||
                mesh->getMeshType() == TSMesh::SkinMeshType ) )
       {
-         hasColors |= !mesh->colors.empty();
-         hasTexcoord2 |= !mesh->tverts2.empty();
+         hasColors |= mesh->mHasColor || !mesh->colors.empty();
+         hasTexcoord2 |= mesh->mHasTVert2 || !mesh->tverts2.empty();
       }
    }
 
+   const bool hardwareSkinning = canUseHardwareSkinning();
+
    mVertSize = ( hasTexcoord2 || hasColors ) ? sizeof(TSMesh::__TSMeshVertex_3xUVColor) : sizeof(TSMesh::__TSMeshVertexBase);
    mVertexFormat.clear();
   
@@ -536,6 +576,15 @@ void TSShape::initVertexFeatures()
       mVertexFormat.addElement( GFXSemantic::TEXCOORD, GFXDeclType_Float, 2 );
    }
 
+   // The bone indices and weights go last, so the 
+   // rest of the vertex layout doesn't change.
+   if ( hardwareSkinning )
+   {
+      mVertSize += sizeof(TSMesh::__TSMeshVertexSkin);
+      mVertexFormat.addElement( GFXSemantic::BLENDINDICES, GFXDeclType_Float4, 6 );
+      mVertexFormat.addElement( GFXSemantic::BLENDWEIGHT, GFXDeclType_Float4, 7 );
+   }
+
    // Go fix up meshes to include defaults for optional features
    // and initialize them if they're not a skin mesh.
    iter = meshes.begin();
@@ -548,16 +597,57 @@ void TSShape::initVertexFeatures()
          continue;
 
       // Set the flags.
-      mesh->mVertexFormat = &mVertexFormat;
-      mesh->mVertSize = mVertSize;
+      mesh->setVertexFormat( &mVertexFormat, mVertSize );
 
       // Create and fill aligned data structure
       mesh->convertToAlignedMeshData();
+   }
+
+   initVertexBuffers();
+}
+
+void TSShape::initVertexBuffers()
+{
+   const bool hardwareSkinning = mVertexFormat.hasBlendIndices();
+
+   Vector<TSMesh*>::iterator iter = meshes.begin();
+   for ( ; iter != meshes.end(); iter++ )
+   {
+      TSMesh *mesh = *iter;
+      if ( !mesh )
+         continue;
 
-      // Init the vertex buffer.
       if ( mesh->getMeshType() == TSMesh::StandardMeshType )
          mesh->createVBIB();
+      else if ( mesh->getMeshType() == TSMesh::SkinMeshType && hardwareSkinning )
+         static_cast<TSSkinMesh*>( mesh )->createHardwareSkinVBIB();
+   }
+}
+
+bool TSShape::canUseHardwareSkinning() const
+{
+   if (  !smUseHardwareSkinning ||
+         !GFXDevice::devicePresent() ||
+         GFX->getPixelShaderVersion() <= 0.0f ||
+         !FEATUREMGR->getByType( MFT_HardwareSkinning ) )
+      return false;
+
+   bool hasSkin = false;
+
+   Vector<TSMesh*>::const_iterator iter = meshes.begin();
+   for ( ; iter != meshes.end(); iter++ )
+   {
+      const TSMesh *mesh = *iter;
+      if ( !mesh || mesh->getMeshType() != TSMesh::SkinMeshType )
+         continue;
+
+      if ( !static_cast<const TSSkinMesh*>( mesh )->canSkinInHardware() )
+         return false;
+
+      hasSkin = true;
    }
+
+   return hasSkin;
 }
 
 void TSShape::setupBillboardDetails( const String &cachePath )
@@ -587,7 +677,9 @@ void TSShape::setupBillboardDetails( const String &cachePath )
                                                 det.bbDetailLevel,
                                                 det.bbDimension );
 
-      billboardDetails[i]->update();
+      // Otherwise the imposter is loaded the first time it renders.
+      if ( !TSLastDetail::smLazyUpdate )
+         billboardDetails[i]->update();
    }
 }
 
@@ -1313,6 +1405,15 @@ void TSShape::disassembleShape()
          // even if an empty mesh, it's a mesh...
          isMesh[objects[i].startMeshIndex+j]=true;
    }
+
+   // the meshes can only reorder their vertices if none are shared
+   TSMesh::smWriteSharedVerts = false;
+   for (i=0; i<numMeshes; i++)
+   {
+      if (isMesh[i] && meshes[i] && meshes[i]->parentMesh >= 0)
+         TSMesh::smWriteSharedVerts = true;
+   }
+
    for (i=0; i<numMeshes; i++)
    {
       TSMesh * mesh = NULL;
@@ -1326,6 +1427,24 @@ void TSShape::disassembleShape()
    delete [] isMesh;
    tsalloc.setGuard();
 
+   if (TSMesh::smOptimizeReport)
+   {
+      for (i=0; i<objects.size(); i++)
+      {
+         for (S32 j=0; j<objects[i].numMeshes; j++)
+         {
+            const TSMesh *mesh = meshes[objects[i].startMeshIndex+j];
+            if (!mesh || !mesh->getOptimizeStats().numTris)
+               continue;
+
+            const TSMesh::OptimizeStats &stats = mesh->getOptimizeStats();
+            Con::printf("TSShape::disassembleShape - %s detail %d: %d tris, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f%s",
+               getMeshName(i).c_str(), j, stats.numTris, stats.acmrBefore, stats.acmrAfter,
+               stats.atvrBefore, stats.atvrAfter, stats.remapped ? ", vertices reordered" : "");
+         }
+      }
+   }
+
    // names
    for (i=0; i<numNames; i++)
       tsalloc.copyToBuffer8((S8 *)(names[i].c_str()),names[i].length()+1);
@@ -1967,11 +2086,17 @@ void TSShape::readIflMaterials(const char* shapePath)
    mFlags |= IflInit;
 }
 
-template<> void *Resource<TSShape>::create(const Torque::Path &path)
+static Torque::Path _getShapeScriptPath(const Torque::Path &path)
 {
-   // Execute the shape script if it exists
    Torque::Path scriptPath(path);
    scriptPath.setExtension("cs");
+   return scriptPath;
+}
+
+static void _execShapeScript(const Torque::Path &path)
+{
+   // Execute the shape script if it exists
+   const Torque::Path scriptPath = _getShapeScriptPath(path);
 
    // Don't execute the script if we're already doing so!
    StringTableEntry currentScript = Platform::stripBasePath(CodeBlock::getCurrentCodeBlockFullPath());
@@ -1986,12 +2111,26 @@ template<> void *Resource<TSShape>::create(const Torque::Path &path)
          Con::setVariable("InstantGroup", instantGroup.c_str());
       }
    }
+}
+
+// Shapes are not registered with ResourceRegisterAsyncCreate.  The read
+// uses the global tsalloc and read version, and the shape script and the
+// Collada import use the console and Sim, so ResourceManager::loadAsync()
+// only reads them ahead and creates them on the main thread.
+template<> void *Resource<TSShape>::create(const Torque::Path &path)
+{
+   _execShapeScript(path);
 
    // Attempt to load the shape
    TSShape * ret = 0;
    bool readSuccess = false;
    const String extension = path.getExtension();
 
+   // Skip the parse if the runtime image is up to date.
+   ret = TSShape::loadImage( path );
+   if ( ret )
+      return ret;
+
    if ( extension.equal( "dts", String::NoCase ) )
    {
       FileStream stream;
@@ -2040,6 +2179,8 @@ template<> void *Resource<TSShape>::create(const Torque::Path &path)
       delete ret;
       ret = NULL;
    }
+   else
+      ret->saveImage( path );
 
    return ret;
 }
@@ -297,6 +297,46 @@ class TSShape
       ;
    /// @}
 
+   /// A sequence's rotation and translation keyframes arranged for
+   /// sampling all the tracks of a keyframe at once.
+   ///
+   /// The tracks which change are stored keyframe by keyframe with each
+   /// component in its own array, padded to a multiple of four tracks,
+   /// so that four tracks are decoded and interpolated per SIMD step.
+   /// Tracks which never change are stored once, already interpolated.
+   ///
+   /// The clips are built from the keyframe vectors in init().
+   ///
+   /// @see sampleRotations, sampleTranslations
+   struct KeyframeClip
+   {
+      /// The number of changing rotation tracks rounded up to a 
+      /// multiple of four.
+      S32 numRotTracks;
+
+      /// The x, y, z and w arrays of each keyframe in turn.
+      Vector<S16> rotations;
+
+      /// The track number of each changing rotation track.
+      Vector<S32> rotTracks;
+
+      Vector<QuatF> constRotations;
+      Vector<S32> constRotTracks;
+
+      /// The number of changing translation tracks rounded up to a 
+      /// multiple of four.
+      S32 numTransTracks;
+
+      /// The x, y and z arrays of each keyframe in turn.
+      Vector<F32> translations;
+
+      /// The track number of each changing translation track.
+      Vector<S32> transTracks;
+
+      Vector<Point3F> constTranslations;
+      Vector<S32> constTransTracks;
+   };
+
    /// @name Resizeable vectors
    /// @{
 
@@ -317,6 +357,10 @@ class TSShape
 
    /// @}
 
+   /// One for each sequence or empty if smUseKeyframeClips
+   /// was disabled when the shape was initialized.
+   Vector<KeyframeClip> keyframeClips;
+
    TSMaterialList * materialList;
 
    /// @name Bounding
@@ -333,6 +377,7 @@ class TSShape
    U32 mExporterVersion;
    F32 mSmallestVisibleSize;  ///< Computed at load time from details vector.
    S32 mSmallestVisibleDL;    ///< @see mSmallestVisibleSize
+   Vector<S32> mDetailDrawCalls; ///< The number of draw calls of each detail, computed at load time.
    S32 mReadVersion;          ///< File version that this shape was read from.
    U32 mFlags;                ///< hasTranslucancy, iflInit
    U32 data;                  ///< User-defined data storage.
@@ -365,6 +410,19 @@ class TSShape
    /// all detail meshes in the shape.
    void initVertexFeatures();
 
+   /// Creates the vertex buffers of the detail meshes.  This
+   /// is called from initVertexFeatures().
+   void initVertexBuffers();
+
+   /// Called from init() to build the keyframe clips.
+   /// @see KeyframeClip
+   void initKeyframeClips();
+
+   /// Returns true if the shape has skin meshes and they
+   /// can all be skinned in the vertex shader.
+   /// @see smUseHardwareSkinning
+   bool canUseHardwareSkinning() const;
+
    bool getSequencesConstructed() const { return mSequencesConstructed; }
    void setSequencesConstructed(const bool c) { mSequencesConstructed = c; }
 
@@ -381,6 +439,21 @@ class TSShape
    const ObjectState & getObjectState(const Sequence & seq, S32 keyframeNum, S32 objectNum) const;
    /// @}
 
+   /// @name Sample Animation
+   /// Interpolates every rotation or translation track of a sequence
+   /// between two keyframes, giving the same results as interpolating
+   /// each track with TSTransform.  The output is indexed by track
+   /// number, so it must hold an entry for every track.
+   /// @{
+
+   void sampleRotations(const Sequence & seq, S32 keyNum1, S32 keyNum2, F32 t, QuatF * outRots) const;
+   void sampleTranslations(const Sequence & seq, S32 keyNum1, S32 keyNum2, F32 t, Point3F * outTrans) const;
+
+   /// Returns the number of bytes used by the keyframe clips.
+   U32 getKeyframeClipsSize() const;
+
+   /// @}
+
    /// build LOS collision detail
    void computeAccelerator(S32 dl);
    bool buildConvexHull(S32 dl) const;
@@ -417,6 +490,10 @@ class TSShape
    S32 findDetail(S32 nameIndex) const;
    S32 findDetail(const String &name) const { return findDetail(findName(name)); }
 
+   /// Returns the detail level which renders at the pixel size,
+   /// or -1 if the shape isn't visible at that size.
+   S32 findDetailBySize(F32 pixelSize) const;
+
    S32 findSequence(S32 nameIndex) const;
    S32 findSequence(const String &name) const { return findSequence(findName(name)); }
 
@@ -457,6 +534,21 @@ class TSShape
    /// load one renderable detail if there is one)
    static S32 smNumSkipLoadDetails;
 
+   /// Skin meshes in the vertex shader using a bone palette
+   /// instead of on the CPU.  This only affects shapes which
+   /// are loaded after it is changed.
+   static bool smUseHardwareSkinning;
+
+   /// Build keyframe clips to sample the animation from.  This 
+   /// only affects shapes which are initialized after it is changed.
+   /// @see KeyframeClip
+   static bool smUseKeyframeClips;
+
+   /// Load shapes from their runtime image when it is up to date
+   /// and write one after loading a shape without it.
+   /// @see TSShapeImage
+   static bool smUseImages;
+
    /// by default we initialize shape when we read...
    static bool smInitOnRead;
 
@@ -487,6 +579,25 @@ class TSShape
    bool importSequences(Stream *, const String& sequencePath);
 
    void readIflMaterials(const char* shapePath);
+
+   /// Writes the shape as a runtime image.
+   /// @see TSShapeImage
+   bool writeImage(Stream *);
+
+   /// Reads the shape from a runtime image in memory.  Like read() 
+   /// the shape is initialized afterwards if smInitOnRead is set.
+   bool readImage(const void *data, U32 size);
+
+   /// Returns the path of the runtime image for a shape file, which
+   /// is the shape file name with the image extension appended.
+   static Torque::Path getImagePath(const Torque::Path &shapePath);
+
+   /// Loads a shape from its runtime image if the image is newer
+   /// than the shape file.  Returns NULL if it can't be used.
+   static TSShape* loadImage(const Torque::Path &shapePath);
+
+   /// Writes the runtime image of a shape loaded from shapePath.
+   bool saveImage(const Torque::Path &shapePath);
    /// @}
 
    /// @name Persist Helper Functions
@@ -1297,6 +1297,8 @@ bool TSShape::addSequence(const Torque::Path& path, const String& fromSeq,
    if (seq.iflMatters.testAll())
       seq.dirtyFlags |= TSShapeInstance::IflDirty;
 
+   initKeyframeClips();
+
    return true;
 }
 
@@ -1355,6 +1357,8 @@ bool TSShape::removeSequence(const String& name)
    // Remove the sequence name if it is no longer in use
    removeName(name);
 
+   initKeyframeClips();
+
    return true;
 }
 
@@ -1585,6 +1589,8 @@ bool TSShape::setSequenceBlend(const String& seqName, bool blend, const String&
       }
    }
 
+   initKeyframeClips();
+
    return true;
 }
 
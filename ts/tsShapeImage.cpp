@@ -0,0 +1,745 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "ts/tsShapeImage.h"
+
+#include "ts/tsShape.h"
+#include "ts/tsMesh.h"
+#include "ts/tsSortedMesh.h"
+#include "core/stream/fileStream.h"
+#include "core/stream/memStream.h"
+#include "core/util/fourcc.h"
+#include "core/volume.h"
+#include "console/console.h"
+#include "platform/profiler.h"
+
+
+const char *TSShapeImage::smExtension = "dtsi";
+
+U32 TSShapeImage::getSignature()
+{
+   return MakeFourCC( 'T', 'S', 'I', 'M' );
+}
+
+U32 TSShapeImage::getCurrentFlags()
+{
+   U32 flags = 0;
+   if ( TSMesh::smUseTriangles )
+      flags |= UseTriangles;
+   if ( TSMesh::smUseOneStrip )
+      flags |= UseOneStrip;
+   if ( TSMesh::smUseEncodedNormals )
+      flags |= UseEncodedNormals;
+   return flags;
+}
+
+static inline U32 _alignImageOffset( U32 offset )
+{
+   return ( offset + TSShapeImage::Alignment - 1 ) & ~( TSShapeImage::Alignment - 1 );
+}
+
+//-----------------------------------------------------------------------------
+
+TSShapeImageWriter::TSShapeImageWriter()
+{
+   VECTOR_SET_ASSOCIATION( mTables );
+   VECTOR_SET_ASSOCIATION( mData );
+}
+
+void TSShapeImageWriter::write( const void *data, U32 count, U32 elemSize )
+{
+   const U32 start = mData.size();
+   const U32 offset = _alignImageOffset( start );
+   const U32 size = count * elemSize;
+
+   // Zero the padding so that images are reproducible.
+   mData.setSize( offset + size );
+   dMemset( mData.address() + start, 0, offset - start );
+   if ( size )
+      dMemcpy( mData.address() + offset, data, size );
+
+   mTables.increment();
+   mTables.last().offset = offset;
+   mTables.last().count = count;
+   mTables.last().elemSize = elemSize;
+}
+
+bool TSShapeImageWriter::save( Stream &stream ) const
+{
+   const U32 dirSize = sizeof( TSShapeImage::Header ) + mTables.size() * sizeof( TSShapeImage::Table );
+
+   TSShapeImage::Header header;
+   header.signature = TSShapeImage::getSignature();
+   header.version = TSShapeImage::Version;
+   header.byteOrder = TSShapeImage::ByteOrderMark;
+   header.flags = TSShapeImage::getCurrentFlags();
+   header.numTables = mTables.size();
+   header.dataOffset = _alignImageOffset( dirSize );
+   header.dataSize = mData.size();
+
+   static const U8 padding[ TSShapeImage::Alignment ] = { 0 };
+
+   // Everything is written in native byte order, the
+   // byte order mark keeps other platforms from using it.
+   bool ok = stream.write( sizeof( header ), &header );
+   ok &= stream.write( mTables.size() * sizeof( TSShapeImage::Table ), mTables.address() );
+   ok &= stream.write( header.dataOffset - dirSize, padding );
+   ok &= stream.write( mData.size(), mData.address() );
+   return ok && stream.getStatus() == Stream::Ok;
+}
+
+//-----------------------------------------------------------------------------
+
+TSShapeImageReader::TSShapeImageReader()
+   :  mData( NULL ),
+      mTables( NULL ),
+      mNumTables( 0 ),
+      mDataSize( 0 ),
+      mNextTable( 0 ),
+      mOk( false )
+{
+}
+
+bool TSShapeImageReader::open( const void *data, U32 size )
+{
+   mOk = false;
+   mNextTable = 0;
+
+   if ( !data || size < sizeof( TSShapeImage::Header ) )
+      return false;
+
+   const TSShapeImage::Header *header = (const TSShapeImage::Header*)data;
+   if (  header->signature != TSShapeImage::getSignature() ||
+         header->version != TSShapeImage::Version ||
+         header->byteOrder != TSShapeImage::ByteOrderMark )
+      return false;
+
+   // The primitives and normals depend on the mesh load options.
+   if ( header->flags != TSShapeImage::getCurrentFlags() )
+      return false;
+
+   if ( header->numTables > ( size - sizeof( TSShapeImage::Header ) ) / sizeof( TSShapeImage::Table ) )
+      return false;
+
+   const U32 dirSize = sizeof( TSShapeImage::Header ) + header->numTables * sizeof( TSShapeImage::Table );
+   if (  header->dataOffset < dirSize ||
+         header->dataOffset > size ||
+         header->dataSize > size - header->dataOffset )
+      return false;
+
+   mTables = (const TSShapeImage::Table*)( header + 1 );
+   mNumTables = header->numTables;
+   mData = (const U8*)data + header->dataOffset;
+   mDataSize = header->dataSize;
+   mOk = true;
+
+   return true;
+}
+
+const void* TSShapeImageReader::read( U32 elemSize, U32 *outCount )
+{
+   *outCount = 0;
+
+   if ( !mOk || mNextTable >= mNumTables )
+   {
+      mOk = false;
+      return NULL;
+   }
+
+   const TSShapeImage::Table &table = mTables[ mNextTable++ ];
+   if (  table.elemSize != elemSize ||
+         table.offset > mDataSize ||
+         ( table.count > 0 && ( elemSize == 0 || table.count > ( mDataSize - table.offset ) / elemSize ) ) )
+   {
+      mOk = false;
+      return NULL;
+   }
+
+   *outCount = table.count;
+   return table.count > 0 ? mData + table.offset : NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+   /// The shape fields which aren't arrays.
+   struct ShapeRecord
+   {
+      F32 radius;
+      F32 tubeRadius;
+      Point3F center;
+      Box3F bounds;
+      F32 smallestVisibleSize;
+      S32 smallestVisibleDL;
+      U32 exporterVersion;
+      S32 readVersion;
+   };
+
+   /// The mesh fields which aren't arrays.
+   struct MeshRecord
+   {
+      U32 meshType;
+      S32 parentMesh;
+      S32 numFrames;
+      S32 numMatFrames;
+      S32 vertsPerFrame;
+      Box3F bounds;
+      Point3F center;
+      F32 radius;
+
+      /// The size of the interleaved vertices or zero if
+      /// the mesh still keeps the separate vertex arrays.
+      U32 vertSize;
+
+      U8 hasColor;
+      U8 hasTVert2;
+   };
+
+   struct SortedMeshRecord
+   {
+      U32 alwaysWriteDepth;
+   };
+}
+
+bool TSShape::writeImage( Stream *s )
+{
+   PROFILE_SCOPE( TSShape_WriteImage );
+
+   TSShapeImageWriter writer;
+
+   ShapeRecord record;
+   dMemset( &record, 0, sizeof( record ) );
+   record.radius = radius;
+   record.tubeRadius = tubeRadius;
+   record.center = center;
+   record.bounds = bounds;
+   record.smallestVisibleSize = mSmallestVisibleSize;
+   record.smallestVisibleDL = mSmallestVisibleDL;
+   record.exporterVersion = mExporterVersion;
+   record.readVersion = mReadVersion;
+   writer.writeRecord( record );
+
+   writer.write( nodes );
+   writer.write( objects );
+   writer.write( iflMaterials );
+   writer.write( objectStates );
+   writer.write( subShapeFirstNode );
+   writer.write( subShapeFirstObject );
+   writer.write( detailFirstSkin );
+   writer.write( subShapeNumNodes );
+   writer.write( subShapeNumObjects );
+   writer.write( details );
+   writer.write( defaultRotations );
+   writer.write( defaultTranslations );
+
+   writer.write( nodeRotations );
+   writer.write( nodeTranslations );
+   writer.write( nodeUniformScales );
+   writer.write( nodeAlignedScales );
+   writer.write( nodeArbitraryScaleRots );
+   writer.write( nodeArbitraryScaleFactors );
+   writer.write( groundRotations );
+   writer.write( groundTranslations );
+   writer.write( triggers );
+   writer.write( sequences );
+
+   // The names are packed into one table of null terminated strings.
+   Vector<char> nameData;
+   for ( S32 i=0; i < names.size(); i++ )
+   {
+      const U32 start = nameData.size();
+      const U32 length = names[i].length() + 1;
+      nameData.setSize( start + length );
+      dMemcpy( nameData.address() + start, names[i].c_str(), length );
+   }
+   writer.write( nameData );
+
+   // The material list is small and keeps its own format.
+   MemStream matStream( 1024 );
+   if ( materialList )
+      materialList->write( matStream );
+   writer.write( matStream.getBuffer(), matStream.getPosition(), 1 );
+
+   // The mesh types come first so the reader can
+   // allocate all the meshes in one block.
+   Vector<U32> meshTypes;
+   meshTypes.setSize( meshes.size() );
+   for ( S32 i=0; i < meshes.size(); i++ )
+   {
+      const TSMesh *mesh = meshes[i];
+      meshTypes[i] = ( mesh && mesh->getMeshType() != TSMesh::DecalMeshType ) ? mesh->getMeshType() : TSMesh::NullMeshType;
+   }
+   writer.write( meshTypes );
+
+   for ( S32 i=0; i < meshes.size(); i++ )
+   {
+      if ( meshTypes[i] != TSMesh::NullMeshType )
+         meshes[i]->writeImage( writer );
+   }
+
+   return writer.save( *s );
+}
+
+bool TSShape::readImage( const void *data, U32 size )
+{
+   PROFILE_SCOPE( TSShape_ReadImage );
+
+   AssertFatal( meshes.empty() && !mShapeData, "TSShape::readImage - The shape is already loaded!" );
+
+   TSShapeImageReader reader;
+   if ( !reader.open( data, size ) )
+      return false;
+
+   ShapeRecord record;
+   if ( !reader.readRecord( &record ) )
+      return false;
+
+   radius = record.radius;
+   tubeRadius = record.tubeRadius;
+   center = record.center;
+   bounds = record.bounds;
+   mSmallestVisibleSize = record.smallestVisibleSize;
+   mSmallestVisibleDL = record.smallestVisibleDL;
+   mExporterVersion = record.exporterVersion;
+   mReadVersion = record.readVersion;
+
+   reader.read( nodes );
+   reader.read( objects );
+   reader.read( iflMaterials );
+   reader.read( objectStates );
+   reader.read( subShapeFirstNode );
+   reader.read( subShapeFirstObject );
+   reader.read( detailFirstSkin );
+   reader.read( subShapeNumNodes );
+   reader.read( subShapeNumObjects );
+   reader.read( details );
+   reader.read( defaultRotations );
+   reader.read( defaultTranslations );
+
+   reader.read( nodeRotations );
+   reader.read( nodeTranslations );
+   reader.read( nodeUniformScales );
+   reader.read( nodeAlignedScales );
+   reader.read( nodeArbitraryScaleRots );
+   reader.read( nodeArbitraryScaleFactors );
+   reader.read( groundRotations );
+   reader.read( groundTranslations );
+   reader.read( triggers );
+   reader.read( sequences );
+
+   U32 nameSize;
+   const char *nameData = (const char*)reader.read( 1, &nameSize );
+   if ( !reader.isOk() || ( nameSize > 0 && nameData[ nameSize - 1 ] != 0 ) )
+      return false;
+
+   names.clear();
+   for ( U32 pos = 0; pos < nameSize; )
+   {
+      names.push_back( String( nameData + pos ) );
+      pos += names.last().length() + 1;
+   }
+
+   U32 matSize;
+   const void *matData = reader.read( 1, &matSize );
+   if ( !reader.isOk() )
+      return false;
+
+   delete materialList;
+   materialList = new TSMaterialList;
+   if ( matSize > 0 )
+   {
+      MemStream matStream( matSize, const_cast<void*>( matData ), true, false );
+      if ( !materialList->read( matStream ) )
+         return false;
+   }
+
+   Vector<U32> meshTypes;
+   if ( !reader.read( meshTypes ) )
+      return false;
+
+   // Like assembleShape() the meshes are constructed in
+   // one block which is freed along with the shape.
+   U32 blockSize = 0;
+   for ( S32 i=0; i < meshTypes.size(); i++ )
+   {
+      switch ( meshTypes[i] )
+      {
+         case TSMesh::StandardMeshType:   blockSize += _alignImageOffset( sizeof( TSMesh ) ); break;
+         case TSMesh::SkinMeshType:       blockSize += _alignImageOffset( sizeof( TSSkinMesh ) ); break;
+         case TSMesh::SortedMeshType:     blockSize += _alignImageOffset( sizeof( TSSortedMesh ) ); break;
+         case TSMesh::NullMeshType:       break;
+         default:                         return false;
+      }
+   }
+
+   mShapeData = blockSize > 0 ? new S8[ blockSize ] : NULL;
+   meshes.setSize( meshTypes.size() );
+
+   S8 *meshData = mShapeData;
+   for ( S32 i=0; i < meshTypes.size(); i++ )
+   {
+      TSMesh *mesh = NULL;
+      switch ( meshTypes[i] )
+      {
+         case TSMesh::StandardMeshType:
+            mesh = constructInPlace( (TSMesh*)meshData );
+            meshData += _alignImageOffset( sizeof( TSMesh ) );
+            break;
+
+         case TSMesh::SkinMeshType:
+            mesh = constructInPlace( (TSSkinMesh*)meshData );
+            meshData += _alignImageOffset( sizeof( TSSkinMesh ) );
+            break;
+
+         case TSMesh::SortedMeshType:
+            mesh = constructInPlace( (TSSortedMesh*)meshData );
+            meshData += _alignImageOffset( sizeof( TSSortedMesh ) );
+            break;
+      }
+
+      meshes[i] = mesh;
+      if ( mesh )
+         mesh->readImage( reader );
+   }
+
+   // Any damage leaves the meshes for the destructor.
+   if ( !reader.isOk() )
+      return false;
+
+   if ( smInitOnRead )
+      init();
+
+   return true;
+}
+
+Torque::Path TSShape::getImagePath( const Torque::Path &shapePath )
+{
+   // Keep the source extension so that foo.dts 
+   // and foo.dae don't share the same image.
+   Torque::Path imagePath( shapePath );
+   imagePath.setFileName( shapePath.getFileName() + "." + shapePath.getExtension() );
+   imagePath.setExtension( TSShapeImage::smExtension );
+   return imagePath;
+}
+
+TSShape* TSShape::loadImage( const Torque::Path &shapePath )
+{
+   // The image holds every detail, so it can't be used when
+   // details are skipped and isn't written for them either.
+   if ( !smUseImages || smNumSkipLoadDetails != 0 )
+      return NULL;
+
+   // A forced reimport must go through the loader.
+   if (  shapePath.getExtension().equal( "dae", String::NoCase ) &&
+         Con::getBoolVariable( "$collada::forceLoadDAE", false ) )
+      return NULL;
+
+   const Torque::Path imagePath = getImagePath( shapePath );
+   if (  !Torque::FS::IsFile( imagePath ) ||
+         Torque::FS::CompareModifiedTimes( imagePath, shapePath ) < 0 )
+      return NULL;
+
+   PROFILE_SCOPE( TSShape_LoadImage );
+
+   // Native files are mapped, so only the pages we
+   // copy from are ever read from the disk.
+   Torque::FS::FileView view;
+   if ( !view.open( imagePath ) )
+      return NULL;
+
+   TSShape *shape = new TSShape;
+   if ( !shape->readImage( view.getData(), view.getSize() ) )
+   {
+      Con::warnf( "TSShape::loadImage - Ignoring out of date image '%s'", imagePath.getFullPath().c_str() );
+      delete shape;
+      return NULL;
+   }
+
+   return shape;
+}
+
+bool TSShape::saveImage( const Torque::Path &shapePath )
+{
+   if ( !smUseImages || smNumSkipLoadDetails != 0 )
+      return false;
+
+   // The image is written next to its final name and then moved into
+   // place, so a crash never leaves a partial image that looks newer
+   // than the shape.
+   const Torque::Path imagePath = getImagePath( shapePath );
+   Torque::Path tempPath( imagePath );
+   tempPath.setExtension( imagePath.getExtension() + ".tmp" );
+
+   FileStream stream;
+   if ( !stream.open( tempPath.getFullPath(), Torque::FS::File::Write ) )
+      return false;
+
+   const bool written = writeImage( &stream );
+   stream.close();
+
+   if ( !written )
+   {
+      Torque::FS::Remove( tempPath );
+      return false;
+   }
+
+   // Not every platform can rename over an existing file.
+   Torque::FS::Remove( imagePath );
+   if ( !Torque::FS::Rename( tempPath, imagePath ) )
+   {
+      Torque::FS::Remove( tempPath );
+      return false;
+   }
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void TSMesh::writeImage( TSShapeImageWriter &writer )
+{
+   const bool interleaved = mVertexData.isReady();
+
+   // The bone indices and weights are set up again for
+   // the device, so only the shared part is kept.
+   U32 vertSize = 0;
+   if ( interleaved )
+   {
+      vertSize = mVertexData.vertSize();
+      if ( mVertexFormat && mVertexFormat->hasBlendIndices() )
+         vertSize -= sizeof( __TSMeshVertexSkin );
+   }
+
+   MeshRecord record;
+   dMemset( &record, 0, sizeof( record ) );
+   record.meshType = meshType;
+   record.parentMesh = parentMesh;
+   record.numFrames = numFrames;
+   record.numMatFrames = numMatFrames;
+   record.vertsPerFrame = vertsPerFrame;
+   record.bounds = mBounds;
+   record.center = mCenter;
+   record.radius = mRadius;
+   record.vertSize = vertSize;
+   record.hasColor = mHasColor;
+   record.hasTVert2 = mHasTVert2;
+   writer.writeRecord( record );
+
+   writer.write( primitives );
+   writer.write( indices );
+   writer.write( encodedNorms );
+
+   const U32 numVerts = interleaved ? mNumVerts : 0;
+   if ( !interleaved || vertSize == mVertexData.vertSize() )
+      writer.write( interleaved ? mVertexData.address() : NULL, numVerts, vertSize );
+   else
+   {
+      Vector<U8> vertData;
+      vertData.setSize( numVerts * vertSize );
+      const U8 *src = (const U8*)mVertexData.address();
+      for ( U32 i=0; i < numVerts; i++ )
+         dMemcpy( vertData.address() + i * vertSize, src + i * mVertexData.vertSize(), vertSize );
+      writer.write( vertData.address(), numVerts, vertSize );
+   }
+
+   // These are empty once the vertices are interleaved.
+   writer.write( verts );
+   writer.write( norms );
+   writer.write( tverts );
+   writer.write( tangents );
+   writer.write( tverts2 );
+   writer.write( colors );
+}
+
+void TSMesh::readImage( TSShapeImageReader &reader )
+{
+   MeshRecord record;
+   if ( !reader.readRecord( &record ) )
+      return;
+
+   meshType = record.meshType;
+   parentMesh = record.parentMesh;
+   numFrames = record.numFrames;
+   numMatFrames = record.numMatFrames;
+   vertsPerFrame = record.vertsPerFrame;
+   mBounds = record.bounds;
+   mCenter = record.center;
+   mRadius = record.radius;
+   mHasColor = record.hasColor;
+   mHasTVert2 = record.hasTVert2;
+
+   reader.read( primitives );
+   reader.read( indices );
+   reader.read( encodedNorms );
+
+   U32 numVerts;
+   const void *vertData = reader.read( record.vertSize, &numVerts );
+   if ( !reader.isOk() )
+      return;
+
+   // The vertex format is set up by TSShape::initVertexFeatures()
+   // which relays the vertices if the runtime layout differs.
+   mVertexFormat = NULL;
+   if ( record.vertSize > 0 )
+   {
+      void *aligned = numVerts > 0 ? dAligned_malloc( record.vertSize * numVerts, 16 ) : NULL;
+      if ( aligned )
+         dMemcpy( aligned, vertData, record.vertSize * numVerts );
+
+      mVertexData.set( aligned, record.vertSize, numVerts );
+      mVertexData.setReady( true );
+      mNumVerts = numVerts;
+      mVertSize = record.vertSize;
+   }
+
+   reader.read( verts );
+   reader.read( norms );
+   reader.read( tverts );
+   reader.read( tangents );
+   reader.read( tverts2 );
+   reader.read( colors );
+}
+
+void TSSkinMesh::writeImage( TSShapeImageWriter &writer )
+{
+   Parent::writeImage( writer );
+
+   writer.write( batchData.initialTransforms );
+   writer.write( batchData.initialVerts );
+   writer.write( batchData.initialNorms );
+   writer.write( batchData.nodeIndex );
+   writer.write( vertexIndex );
+   writer.write( boneIndex );
+   writer.write( weight );
+}
+
+void TSSkinMesh::readImage( TSShapeImageReader &reader )
+{
+   Parent::readImage( reader );
+
+   reader.read( batchData.initialTransforms );
+   reader.read( batchData.initialVerts );
+   reader.read( batchData.initialNorms );
+   reader.read( batchData.nodeIndex );
+   reader.read( vertexIndex );
+   reader.read( boneIndex );
+   reader.read( weight );
+}
+
+void TSSortedMesh::writeImage( TSShapeImageWriter &writer )
+{
+   Parent::writeImage( writer );
+
+   writer.write( clusters );
+   writer.write( startCluster );
+   writer.write( firstVerts );
+   writer.write( numVerts );
+   writer.write( firstTVerts );
+
+   SortedMeshRecord record;
+   record.alwaysWriteDepth = alwaysWriteDepth;
+   writer.writeRecord( record );
+}
+
+void TSSortedMesh::readImage( TSShapeImageReader &reader )
+{
+   Parent::readImage( reader );
+
+   reader.read( clusters );
+   reader.read( startCluster );
+   reader.read( firstVerts );
+   reader.read( numVerts );
+   reader.read( firstTVerts );
+
+   SortedMeshRecord record;
+   if ( reader.readRecord( &record ) )
+      alwaysWriteDepth = record.alwaysWriteDepth != 0;
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction( compareShapeImage, void, 2, 3, "( string shapePath, int iterations=10 )\n"
+   "Loads a DTS shape and its runtime image a number of times and prints "
+   "the file sizes and average load times of both." )
+{
+   const Torque::Path shapePath( argv[1] );
+   const S32 iterations = getMax( argc > 2 ? dAtoi( argv[2] ) : 10, 1 );
+
+   if ( !shapePath.getExtension().equal( "dts", String::NoCase ) )
+   {
+      Con::errorf( "compareShapeImage - '%s' is not a DTS shape", argv[1] );
+      return;
+   }
+
+   const bool oldUseImages = TSShape::smUseImages;
+   TSShape::smUseImages = true;
+
+   // Load the DTS the way the resource manager does.
+   F32 dtsTime = 0.0f;
+   for ( S32 i=0; i < iterations; i++ )
+   {
+      const U32 start = Platform::getRealMilliseconds();
+
+      FileStream stream;
+      TSShape *shape = NULL;
+      if ( stream.open( shapePath.getFullPath(), Torque::FS::File::Read ) )
+      {
+         shape = new TSShape;
+         if ( !shape->read( &stream ) )
+         {
+            delete shape;
+            shape = NULL;
+         }
+      }
+
+      dtsTime += Platform::getRealMilliseconds() - start;
+
+      if ( !shape )
+      {
+         Con::errorf( "compareShapeImage - Failed to load '%s'", argv[1] );
+         TSShape::smUseImages = oldUseImages;
+         return;
+      }
+
+      // Refresh the image from the first load.
+      if ( i == 0 && !shape->saveImage( shapePath ) )
+      {
+         Con::errorf( "compareShapeImage - Failed to write the image for '%s'", argv[1] );
+         delete shape;
+         TSShape::smUseImages = oldUseImages;
+         return;
+      }
+
+      delete shape;
+   }
+
+   F32 imageTime = 0.0f;
+   for ( S32 i=0; i < iterations; i++ )
+   {
+      const U32 start = Platform::getRealMilliseconds();
+      TSShape *shape = TSShape::loadImage( shapePath );
+      imageTime += Platform::getRealMilliseconds() - start;
+
+      if ( !shape )
+      {
+         Con::errorf( "compareShapeImage - Failed to load the image for '%s'", argv[1] );
+         TSShape::smUseImages = oldUseImages;
+         return;
+      }
+
+      delete shape;
+   }
+
+   TSShape::smUseImages = oldUseImages;
+
+   const U32 dtsSize = Platform::getFileSize( shapePath.getFullPath() );
+   const U32 imageSize = Platform::getFileSize( TSShape::getImagePath( shapePath ).getFullPath() );
+
+   Con::printf( "compareShapeImage - %s", argv[1] );
+   Con::printf( "   DTS:   %8d bytes  %8.2fms", dtsSize, dtsTime / iterations );
+   Con::printf( "   Image: %8d bytes  %8.2fms", imageSize, imageTime / iterations );
+}
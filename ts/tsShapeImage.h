@@ -0,0 +1,175 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSSHAPEIMAGE_H_
+#define _TSSHAPEIMAGE_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/util/tVector.h"
+#endif
+
+class Stream;
+
+
+/// The layout of a shape runtime image.
+///
+/// A runtime image holds a shape the way it is laid out in memory once
+/// it has been loaded, so that loading it is a series of block copies
+/// instead of a parse of the DTS stream.  The file is a header, a table
+/// directory and the table data.  Every table is an array of fixed size
+/// elements in native byte order starting on a 16 byte boundary.  The
+/// vertex tables hold the interleaved vertex layout which is uploaded
+/// to the GPU and the primitives are already converted, so nothing is
+/// expanded at load time.
+///
+/// The tables are written and read in the same order, much like the
+/// TSShapeAlloc buffers of the DTS format.  Each table records its element
+/// size, so an image written by a build with different structures is
+/// rejected and the shape is loaded from the DTS instead.
+///
+/// @see TSShape::writeImage
+/// @see TSShape::readImage
+class TSShapeImage
+{
+public:
+
+   enum
+   {
+      /// Bump this when the order or content of the tables changes.
+      Version = 1,
+
+      /// Written as is so that a foreign byte order is detected.
+      ByteOrderMark = 0x01020304,
+
+      /// The alignment of the table data.
+      Alignment = 16,
+   };
+
+   /// The mesh load options the image was written with.
+   enum Flags
+   {
+      UseTriangles      = BIT(0),
+      UseOneStrip       = BIT(1),
+      UseEncodedNormals = BIT(2),
+   };
+
+   struct Header
+   {
+      U32 signature;
+      U32 version;
+      U32 byteOrder;
+      U32 flags;
+      U32 numTables;
+
+      /// The offset of the table data from the start of the file.
+      U32 dataOffset;
+      U32 dataSize;
+   };
+
+   struct Table
+   {
+      /// The offset from the start of the table data.
+      U32 offset;
+      U32 count;
+      U32 elemSize;
+   };
+
+   /// The extension of image files, which are kept next to
+   /// the shape they were created from.
+   static const char *smExtension;
+
+   /// Returns the signature that starts every image.
+   static U32 getSignature();
+
+   /// Returns the flags for the current mesh load options.
+   static U32 getCurrentFlags();
+};
+
+
+/// Builds the tables of a shape image in memory.
+class TSShapeImageWriter
+{
+public:
+
+   TSShapeImageWriter();
+
+   /// Appends a table of count elements.
+   void write( const void *data, U32 count, U32 elemSize );
+
+   template<class T>
+   void write( const Vector<T> &vec ) { write( vec.address(), vec.size(), sizeof( T ) ); }
+
+   /// Appends a table holding a single structure.
+   template<class T>
+   void writeRecord( const T &record ) { write( &record, 1, sizeof( T ) ); }
+
+   /// Writes the image to the stream.
+   bool save( Stream &stream ) const;
+
+protected:
+
+   Vector<TSShapeImage::Table> mTables;
+   Vector<U8> mData;
+};
+
+
+/// Reads the tables of a shape image in the order they were written.
+///
+/// The reader doesn't copy the image, so the data must stay valid
+/// while reading.  Any error is sticky, once a table is missing or
+/// has the wrong element size every following read fails as well.
+class TSShapeImageReader
+{
+public:
+
+   TSShapeImageReader();
+
+   /// Checks the header and table directory.  Returns false if
+   /// the data isn't an image this build can read.
+   bool open( const void *data, U32 size );
+
+   /// Returns the next table or NULL if it is empty or on
+   /// an error.  Fails if the element size doesn't match.
+   const void* read( U32 elemSize, U32 *outCount );
+
+   /// Copies the next table into the vector.
+   template<class T>
+   bool read( Vector<T> &vec )
+   {
+      U32 count;
+      const void *data = read( sizeof( T ), &count );
+      vec.set( const_cast<void*>( data ), count );
+      return mOk;
+   }
+
+   /// Copies the next table, which must hold a single structure.
+   template<class T>
+   bool readRecord( T *outRecord )
+   {
+      U32 count;
+      const void *data = read( sizeof( T ), &count );
+      if ( count != 1 )
+         mOk = false;
+      if ( mOk )
+         dMemcpy( outRecord, data, sizeof( T ) );
+      return mOk;
+   }
+
+   bool isOk() const { return mOk; }
+
+protected:
+
+   const U8 *mData;
+   const TSShapeImage::Table *mTables;
+   U32 mNumTables;
+   U32 mDataSize;
+   U32 mNextTable;
+   bool mOk;
+};
+
+#endif // _TSSHAPEIMAGE_H_
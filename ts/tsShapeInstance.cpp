@@ -7,11 +7,14 @@
 #include "ts/tsShapeInstance.h"
 
 #include "ts/tsLastDetail.h"
+#include "ts/tsAnimateBatch.h"
+#include "ts/tsLODManager.h"
 #include "console/consoleTypes.h"
 #include "ts/tsDecal.h"
 #include "platform/profiler.h"
 #include "core/frameAllocator.h"
 #include "gfx/gfxDevice.h"
+#include "gfx/gfxTextureManager.h"
 #include "materials/materialManager.h"
 #include "materials/materialFeatureTypes.h"
 #include "materials/sceneData.h"
@@ -23,16 +26,11 @@
 F32                           TSShapeInstance::smDetailAdjust = 1.0f;
 F32                           TSShapeInstance::smSmallestVisiblePixelSize = -1.0f;
 S32                           TSShapeInstance::smNumSkipRenderDetails = 0;
+F32                           TSShapeInstance::smAnimFullRatePixelSize = 150.0f;
+S32                           TSShapeInstance::smAnimMaxInterval = 100;
+F32                           TSShapeInstance::smAnimBlendPixelSize = 50.0f;
 
-Vector<QuatF>                 TSShapeInstance::smNodeCurrentRotations(__FILE__, __LINE__);
-Vector<Point3F>               TSShapeInstance::smNodeCurrentTranslations(__FILE__, __LINE__);
-Vector<F32>                   TSShapeInstance::smNodeCurrentUniformScales(__FILE__, __LINE__);
-Vector<Point3F>               TSShapeInstance::smNodeCurrentAlignedScales(__FILE__, __LINE__);
-Vector<TSScale>               TSShapeInstance::smNodeCurrentArbitraryScales(__FILE__, __LINE__);
-
-Vector<TSThread*>             TSShapeInstance::smRotationThreads(__FILE__, __LINE__);
-Vector<TSThread*>             TSShapeInstance::smTranslationThreads(__FILE__, __LINE__);
-Vector<TSThread*>             TSShapeInstance::smScaleThreads(__FILE__, __LINE__);
+TSShapeInstance::AnimateScratch TSShapeInstance::smScratch;
 
 //-------------------------------------------------------------------------------------
 // constructors, destructors, initialization
@@ -91,6 +89,36 @@ void TSShapeInstance::init()
    Con::addVariable("$pref::TS::detailAdjust", TypeF32, &smDetailAdjust);
    Con::addVariable("$pref::TS::skipLoadDLs", TypeS32, &TSShape::smNumSkipLoadDetails);
    Con::addVariable("$pref::TS::skipRenderDLs", TypeS32, &smNumSkipRenderDetails);
+   Con::addVariable("$pref::TS::hardwareSkinning", TypeBool, &TSShape::smUseHardwareSkinning);
+   Con::addVariable("$pref::TS::keyframeClips", TypeBool, &TSShape::smUseKeyframeClips);
+   Con::addVariable("$pref::TS::shapeImages", TypeBool, &TSShape::smUseImages);
+   Con::addVariable("$pref::TS::parallelAnimation", TypeBool, &TSAnimateBatch::smParallel);
+   Con::addVariable("$pref::TS::parallelAnimationBatchSize", TypeS32, &TSAnimateBatch::smBatchSize);
+   Con::addVariable("$pref::TS::animFullRatePixelSize", TypeF32, &smAnimFullRatePixelSize);
+   Con::addVariable("$pref::TS::animMaxInterval", TypeS32, &smAnimMaxInterval);
+   Con::addVariable("$pref::TS::animBlendPixelSize", TypeF32, &smAnimBlendPixelSize);
+   Con::addVariable("$pref::TS::animNodeBudget", TypeS32, &TSAnimateBatch::smNodeBudget);
+   Con::addVariable("$pref::TS::animPoseShareSteps", TypeS32, &TSAnimateBatch::smPoseShareSteps);
+   Con::addVariable("$pref::TS::imposterLazyUpdate", TypeBool, &TSLastDetail::smLazyUpdate);
+   Con::addVariable("$pref::TS::imposterCapturesPerFrame", TypeS32, &TSLastDetail::smCapturesPerFrame);
+   Con::addVariable("$pref::TS::imposterBakeInBackground", TypeBool, &TSLastDetail::smBakeInBackground);
+   Con::addVariable("$pref::TS::lodPolyBudget", TypeS32, &TSLODManager::smPolyBudget);
+   Con::addVariable("$pref::TS::lodDrawCallBudget", TypeS32, &TSLODManager::smDrawCallBudget);
+   Con::addVariable("$pref::TS::lodMinBudgetScale", TypeF32, &TSLODManager::smMinBudgetScale);
+   Con::addVariable("$pref::TS::lodHysteresis", TypeF32, &TSLODManager::smHysteresis);
+   Con::addVariable("$pref::TS::optimizeMeshes", TypeBool, &TSMesh::smOptimizeOnWrite);
+   Con::addVariable("$pref::TS::optimizeMeshesReport", TypeBool, &TSMesh::smOptimizeReport);
+
+   Con::addVariable("$TSAnimateStats::animated", TypeS32, &TSAnimateBatch::smNumAnimated);
+   Con::addVariable("$TSAnimateStats::throttled", TypeS32, &TSAnimateBatch::smNumThrottled);
+   Con::addVariable("$TSAnimateStats::shared", TypeS32, &TSAnimateBatch::smNumShared);
+   Con::addVariable("$TSAnimateStats::nodes", TypeS32, &TSAnimateBatch::smNumNodes);
+
+   Con::addVariable("$TSLODStats::shapes", TypeS32, &TSLODManager::smNumShapes);
+   Con::addVariable("$TSLODStats::polys", TypeS32, &TSLODManager::smNumPolys);
+   Con::addVariable("$TSLODStats::drawCalls", TypeS32, &TSLODManager::smNumDrawCalls);
+   Con::addVariable("$TSLODStats::reduced", TypeS32, &TSLODManager::smNumReduced);
+   Con::addVariable("$TSLODStats::cutoff", TypeF32, &TSLODManager::smCutoff);
 }
 
 void TSShapeInstance::destroy()
@@ -105,8 +133,15 @@ void TSShapeInstance::buildInstanceData(TSShape * _shape, bool loadMaterials)
 
    debrisRefCount = 0;
 
+   mScratch = &smScratch;
+
    mCurrentDetailLevel = 0;
    mCurrentIntraDetailLevel = 1.0f;
+   mCurrentPixelSize = -1.0f;
+   mLODPixelSize = -1.0f;
+   mLODImportance = 1.0f;
+   mLastNodeAnimateTime = 0;
+   mThrottleNextAnimate = false;
 
    // all triggers off at start
    mTriggerStates = 0;
@@ -395,6 +430,32 @@ void TSShapeInstance::render( const TSRenderState &rdata )
 
    PROFILE_SCOPE( TSShapeInstance_Render );
 
+   // Report the cost of the detail we'd render without
+   // the budget so the budget doesn't chase itself.
+   if ( rdata.getSceneState() && rdata.getSceneState()->isDiffusePass() )
+   {
+      const bool budgeted = mLODPixelSize > 0.0f;
+      const S32 dl = budgeted ? mShape->findDetailBySize( mLODPixelSize ) : mCurrentDetailLevel;
+      if ( dl >= 0 )
+         TSLODManager::addShape( budgeted ? mLODPixelSize * mLODImportance : F32_MAX,
+                                 getMax( mShape->details[dl].polyCount, 0 ),
+                                 dl < mShape->mDetailDrawCalls.size() ? mShape->mDetailDrawCalls[dl] : 0 );
+   }
+
+   // Let the mip streaming know how large our textures are on screen.
+   if (  GFXTextureManager::smStreamingEnabled && 
+         mCurrentPixelSize > 0.0f && 
+         mMaterialList &&
+         ( !rdata.getSceneState() || !rdata.getSceneState()->isShadowPass() ) )
+   {
+      for ( U32 i=0; i < mMaterialList->size(); i++ )
+      {
+         BaseMatInstance *matInst = mMaterialList->getMaterialInst( i );
+         if ( matInst )
+            matInst->requestTextureDetail( mCurrentPixelSize );
+      }
+   }
+
    // alphaIn:  we start to alpha-in next detail level when intraDL > 1-alphaIn-alphaOut
    //           (finishing when intraDL = 1-alphaOut)
    // alphaOut: start to alpha-out this detail level when intraDL > 1-alphaOut
@@ -533,6 +594,8 @@ void TSShapeInstance::render( const TSRenderState &rdata, S32 dl, F32 intraDL )
 void TSShapeInstance::setCurrentDetail( S32 dl, F32 intraDL )
 {
    mCurrentDetailLevel = dl;
+   mCurrentPixelSize = -1.0f;
+   mLODPixelSize = -1.0f;
    mCurrentIntraDetailLevel = intraDL > 1.0f ? 1.0f : (intraDL < 0.0f ? 0.0f : intraDL);
 
    // restrict chosen detail level by cutoff value
@@ -542,6 +605,30 @@ void TSShapeInstance::setCurrentDetail( S32 dl, F32 intraDL )
       mCurrentDetailLevel = cutoff;
       mCurrentIntraDetailLevel = 1.0f;
    }
+
+   // Keep drawing the lowest mesh detail until the imposter is
+   // ready, otherwise the shape vanishes while it loads.
+   if (  mCurrentDetailLevel >= 0 && 
+         mShape->details[mCurrentDetailLevel].subShapeNum < 0 &&
+         mCurrentDetailLevel < mShape->billboardDetails.size() )
+   {
+      TSLastDetail *imposter = mShape->billboardDetails[mCurrentDetailLevel];
+      if ( imposter && !imposter->isLoaded() )
+      {
+         if ( TSLastDetail::smLazyUpdate )
+            imposter->requestUpdate();
+
+         S32 meshDL = mCurrentDetailLevel - 1;
+         while ( meshDL >= 0 && mShape->details[meshDL].subShapeNum < 0 )
+            meshDL--;
+
+         if ( meshDL >= 0 )
+         {
+            mCurrentDetailLevel = meshDL;
+            mCurrentIntraDetailLevel = 0.0f;
+         }
+      }
+   }
 }
 
 S32 TSShapeInstance::setDetailFromPosAndScale(  const SceneState *state,
@@ -562,6 +649,8 @@ S32 TSShapeInstance::setDetailFromDistance( const SceneState *state, F32 scaledD
    {
       mCurrentDetailLevel = getMin( 1, mShape->details.size() ) - 1;
       mCurrentIntraDetailLevel = 0.0f;
+      mCurrentPixelSize = -1.0f;
+      mLODPixelSize = -1.0f;
       return mCurrentDetailLevel;
    }
       
@@ -591,7 +680,11 @@ S32 TSShapeInstance::setDetailFromDistance( const SceneState *state, F32 scaledD
       // The pixel size of 1 meter at the input distance.
       F32 pixelRadius = state->projectRadius( scaledDistance, 1.0f ) * pixelScale;
       static const F32 smScreenError = 5.0f;
-      return setDetailFromScreenError( smScreenError / pixelRadius );
+      setDetailFromScreenError( smScreenError / pixelRadius );
+
+      // Keep the size for the animation lod.
+      mCurrentPixelSize = pixelRadius * mShape->radius;
+      return mCurrentDetailLevel;
    }
 
    F32 pixelRadius = state->projectRadius( scaledDistance, mShape->radius ) * pixelScale;
@@ -601,7 +694,15 @@ S32 TSShapeInstance::setDetailFromDistance( const SceneState *state, F32 scaledD
          adjustedPR <= mShape->mSmallestVisibleSize )
       adjustedPR = mShape->mSmallestVisibleSize + 0.01f;
 
-   return setDetailFromPixelSize( adjustedPR );
+   // Let the budget lower the detail, but not hide the shape.
+   F32 budgetPR = TSLODManager::getBudgetPixelSize( adjustedPR, mLODImportance );
+   if (  adjustedPR > mShape->mSmallestVisibleSize &&
+         budgetPR <= mShape->mSmallestVisibleSize )
+      budgetPR = mShape->mSmallestVisibleSize + 0.01f;
+
+   setDetailFromPixelSize( budgetPR );
+   mLODPixelSize = adjustedPR;
+   return mCurrentDetailLevel;
 }
 
 S32 TSShapeInstance::setDetailFromPixelSize( F32 pixelSize )
@@ -612,35 +713,23 @@ S32 TSShapeInstance::setDetailFromPixelSize( F32 pixelSize )
       // don't render...
       mCurrentDetailLevel=-1;
       mCurrentIntraDetailLevel = 0.0f;
+      mCurrentPixelSize = pixelSize;
+      mLODPixelSize = pixelSize;
       return -1;
    }
 
    // same detail level as last time?
-   // only search for detail level if the current one isn't the right one already
+   // only search for detail level if the current one isn't the right one already.
+   // The hysteresis widens the range of the current detail so that shapes
+   // sitting on a detail boundary don't pop back and forth.
+   const F32 lower = 1.0f - TSLODManager::smHysteresis;
+   const F32 upper = 1.0f + TSLODManager::smHysteresis;
    if (  mCurrentDetailLevel < 0 ||
-        (mCurrentDetailLevel == 0 && pixelSize <= mShape->details[0].size) ||
-        (mCurrentDetailLevel>0  && (pixelSize <= mShape->details[mCurrentDetailLevel].size || 
-        pixelSize > mShape->details[mCurrentDetailLevel-1].size) ) )
-   {
-      // scan shape for highest detail size smaller than us...
-      // shapes details are sorted from largest to smallest...
-      // a detail of size <= 0 means it isn't a renderable detail level (utility detail)
-      for (S32 i=0; i<mShape->details.size(); i++)
-      {
-         if ( pixelSize > mShape->details[i].size )
-         {
-            mCurrentDetailLevel = i;
-            break;
-         }
-         if ( i + 1 >= mShape->details.size() || mShape->details[i+1].size < 0 )
-         {
-            // We've run out of details and haven't found anything?
-            // Let's just grab this one.
-            mCurrentDetailLevel = i;
-            break;
-         }
-      }
-   }
+         mCurrentDetailLevel >= mShape->details.size() ||
+        (mCurrentDetailLevel == 0 && pixelSize <= mShape->details[0].size * lower) ||
+        (mCurrentDetailLevel>0  && (pixelSize <= mShape->details[mCurrentDetailLevel].size * lower || 
+        pixelSize > mShape->details[mCurrentDetailLevel-1].size * upper) ) )
+      mCurrentDetailLevel = mShape->findDetailBySize( pixelSize );
 
    F32 curSize = mShape->details[mCurrentDetailLevel].size;
    F32 nextSize = mCurrentDetailLevel == 0 ? 2.0f * curSize : mShape->details[mCurrentDetailLevel - 1].size;
@@ -648,6 +737,9 @@ S32 TSShapeInstance::setDetailFromPixelSize( F32 pixelSize )
    setCurrentDetail( mCurrentDetailLevel, 
                      nextSize-curSize>0.01f ? (pixelSize - curSize) / (nextSize - curSize) : 1.0f );
 
+   mCurrentPixelSize = pixelSize;
+   mLODPixelSize = pixelSize;
+
    return mCurrentDetailLevel;
 }
 
@@ -663,6 +755,9 @@ S32 TSShapeInstance::setDetailFromScreenError( F32 errorTolerance )
    // model (higher detail number) and a value of 1 is the higher poly model (lower
    // detail number).
 
+   mCurrentPixelSize = -1.0f;
+   mLODPixelSize = -1.0f;
+
    // deal with degenerate case first...
    // if smallest detail corresponds to less than half tolerable error, then don't even draw
    F32 prevErr;
@@ -214,19 +214,36 @@ class TSShapeInstance
 
    /// @name Workspace for Node Transforms
    /// @{
-   static Vector<QuatF>   smNodeCurrentRotations;
-   static Vector<Point3F> smNodeCurrentTranslations;
-   static Vector<F32>     smNodeCurrentUniformScales;
-   static Vector<Point3F> smNodeCurrentAlignedScales;
-   static Vector<TSScale> smNodeCurrentArbitraryScales;
-   /// @}
 
-   /// @name Threads
-   /// keep track of who controls what on currently animating shape
-   /// @{
-   static Vector<TSThread*> smRotationThreads;
-   static Vector<TSThread*> smTranslationThreads;
-   static Vector<TSThread*> smScaleThreads;
+   /// The temporary storage used while animating nodes.  Every
+   /// thread which animates shapes needs its own.
+   /// @see TSAnimateBatch
+   struct AnimateScratch
+   {
+      Vector<QuatF>   nodeCurrentRotations;
+      Vector<Point3F> nodeCurrentTranslations;
+      Vector<F32>     nodeCurrentUniformScales;
+      Vector<Point3F> nodeCurrentAlignedScales;
+      Vector<TSScale> nodeCurrentArbitraryScales;
+
+      /// keep track of who controls what on currently animating shape
+      Vector<TSThread*> rotationThreads;
+      Vector<TSThread*> translationThreads;
+      Vector<TSThread*> scaleThreads;
+
+      /// The tracks of the sequence being applied.
+      /// @see TSShape::sampleRotations
+      Vector<QuatF>   sampledRotations;
+      Vector<Point3F> sampledTranslations;
+   };
+
+   /// The workspace used on the main thread.
+   static AnimateScratch smScratch;
+
+   /// The workspace used by animateNodes(), this is smScratch
+   /// unless the shape is animated on a worker thread.
+   AnimateScratch *mScratch;
+
    /// @}
 	
 	TSMaterialList* mMaterialList;    ///< by default, points to hShape material list
@@ -246,6 +263,23 @@ protected:
 
    S32 mCurrentDetailLevel;
 
+   /// The pixel size the detail was selected with or -1.
+   F32 mCurrentPixelSize;
+
+   /// The pixel size the detail would have been selected with
+   /// without the LOD budget or -1.
+   /// @see TSLODManager
+   F32 mLODPixelSize;
+
+   /// @see setLODImportance
+   F32 mLODImportance;
+
+   /// The virtual time the nodes were last animated.
+   U32 mLastNodeAnimateTime;
+
+   /// @see throttleNextAnimate
+   bool mThrottleNextAnimate;
+
    /// 0-1, how far along from current to next (higher) detail level...
    ///
    /// 0=at this dl, 1=at higher detail level, where higher means bigger size on screen
@@ -418,6 +452,24 @@ protected:
    /// only way to get a visible detail)
    static S32 smNumSkipRenderDetails;
 
+   /// @name Animation LOD
+   /// Shapes which are small on screen update their node transforms 
+   /// less often and skip their blend threads.
+   /// @{
+
+   /// Shapes at least this many pixels in size have their
+   /// nodes animated every frame.
+   static F32 smAnimFullRatePixelSize;
+
+   /// The longest time in milliseconds the nodes of a shape 
+   /// go without being animated.  Zero disables the throttling.
+   static S32 smAnimMaxInterval;
+
+   /// Shapes smaller than this many pixels skip their blend threads.
+   static F32 smAnimBlendPixelSize;
+
+   /// @}
+
    /// Debugging
    /// @{
 
@@ -442,6 +494,70 @@ protected:
 
    void animate() { animate( mCurrentDetailLevel ); }
    void animate(S32 dl);
+
+   /// Animates the detail using the passed workspace, which
+   /// lets shapes be animated on more than one thread.
+   /// @see TSAnimateBatch
+   void animate(S32 dl, AnimateScratch *scratch);
+
+   /// Returns true if animate() has work to do for the detail.
+   bool needsAnimate(S32 dl) const;
+
+   /// Returns false if animating calls out to node callbacks,
+   /// which may not be called from a worker thread.
+   bool canAnimateOnWorker() const { return mNodeCallbacks.empty(); }
+
+   /// @name Animation LOD
+   /// @{
+
+   /// Returns the pixel size the current detail was selected with
+   /// or -1 if the detail was set directly with setCurrentDetail().
+   F32 getCurrentPixelSize() const { return mCurrentPixelSize; }
+
+   /// Returns the time in milliseconds animate() may keep the node
+   /// transforms for, which grows as the shape gets smaller on screen.
+   U32 getAnimateInterval() const;
+
+   /// Returns true if the nodes were animated less than
+   /// the animate interval ago.
+   bool isNodeAnimationThrottled() const;
+
+   /// Returns true if animate() will update the node transforms
+   /// of the detail rather than keep the current ones.
+   bool willAnimateNodes(S32 dl) const;
+
+   /// Makes the next animate() use the longest interval no matter the
+   /// pixel size.  This is used when over the animation budget.
+   void throttleNextAnimate() { mThrottleNextAnimate = true; }
+
+   /// Identifies the pose of a subshape.  Instances with equal keys
+   /// have the same node transforms for the subshape.
+   struct PoseKey
+   {
+      const TSShape *shape;
+      const TSShape::Sequence *sequence;
+      S32 ss;
+      S32 keyNum1;
+      S32 keyNum2;
+
+      /// The position between the keys in steps.
+      S32 keyStep;
+
+      U32 getHash() const;
+      bool operator ==( const PoseKey &key ) const;
+   };
+
+   /// Fills in the pose key of the detail with the key position rounded
+   /// to one of steps positions.  Returns false if the pose depends on 
+   /// more than a single sequence and cannot be shared.
+   bool getPoseKey( S32 dl, S32 steps, PoseKey *outKey ) const;
+
+   /// Animates the detail but takes the node transforms from an
+   /// instance of the same shape with an equal pose key.
+   void copyPose( const TSShapeInstance *src, S32 dl );
+
+   /// @}
+
    void animateNodes(S32 ss);
    void animateVisibility(S32 ss);
    void animateFrame(S32 ss);
@@ -516,6 +632,15 @@ protected:
    /// Sets the current detail level using a screen error metric.
    S32 setDetailFromScreenError( F32 errorTOL );
 
+   /// Sets how important the shape is when the LOD budget lowers
+   /// the detail of shapes.  The pixel size is scaled by it, so
+   /// a shape with an importance of 2 keeps its detail like a 
+   /// shape twice its size.  The default is 1.
+   /// @see TSLODManager
+   void setLODImportance( F32 importance ) { mLODImportance = importance; }
+
+   F32 getLODImportance() const { return mLODImportance; }
+
    enum
    {
       TransformDirty =  BIT(0),
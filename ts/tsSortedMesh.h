@@ -52,6 +52,8 @@ public:
 
    void assemble(bool skip);
    void disassemble();
+   void writeImage(TSShapeImageWriter &writer);
+   void readImage(TSShapeImageReader &reader);
 
    TSSortedMesh() {
       meshType = SortedMeshType;
@@ -635,9 +635,9 @@ void TSShapeInstance::updateTransitions()
    for (i=0; i<mShape->nodes.size(); i++)
    {
       if (mTransitionRotationNodes.test(i))
-         mNodeReferenceRotations[i].set(smNodeCurrentRotations[i]);
+         mNodeReferenceRotations[i].set(mScratch->nodeCurrentRotations[i]);
       if (mTransitionTranslationNodes.test(i))
-         mNodeReferenceTranslations[i] = smNodeCurrentTranslations[i];
+         mNodeReferenceTranslations[i] = mScratch->nodeCurrentTranslations[i];
    }
 
    if (animatesScale())
@@ -648,7 +648,7 @@ void TSShapeInstance::updateTransitions()
          for (i=0; i<mShape->nodes.size(); i++)
          {
             if (mTransitionScaleNodes.test(i))
-               mNodeReferenceUniformScales[i] = smNodeCurrentUniformScales[i];
+               mNodeReferenceUniformScales[i] = mScratch->nodeCurrentUniformScales[i];
          }
       }
       else if (animatesAlignedScale())
@@ -657,7 +657,7 @@ void TSShapeInstance::updateTransitions()
          for (i=0; i<mShape->nodes.size(); i++)
          {
             if (mTransitionScaleNodes.test(i))
-               mNodeReferenceScaleFactors[i] = smNodeCurrentAlignedScales[i];
+               mNodeReferenceScaleFactors[i] = mScratch->nodeCurrentAlignedScales[i];
          }
       }
       else
@@ -668,8 +668,8 @@ void TSShapeInstance::updateTransitions()
          {
             if (mTransitionScaleNodes.test(i))
             {
-               mNodeReferenceScaleFactors[i] = smNodeCurrentArbitraryScales[i].mScale;
-               mNodeReferenceArbitraryScaleRots[i].set(smNodeCurrentArbitraryScales[i].mRotate);
+               mNodeReferenceScaleFactors[i] = mScratch->nodeCurrentArbitraryScales[i].mScale;
+               mNodeReferenceArbitraryScaleRots[i].set(mScratch->nodeCurrentArbitraryScales[i].mRotate);
             }
          }
       }
@@ -0,0 +1,319 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "gfx/bitmap/gBitmap.h"
+#include "gfx/bitmap/bitmapUtils.h"
+#include "gfx/bitmap/ddsFile.h"
+#include "gfx/bitmap/ddsUtils.h"
+#include "core/stream/memStream.h"
+#include "math/mRandom.h"
+#include "console/console.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+/// Restores the installed bitmap functions when it goes out of scope.
+struct BitmapLibraryScope
+{
+   void (*mExtrudeRGBA)(const void *, void *, U32, U32);
+   void (*mExtrudeRGBAKaiser)(const void *, void *, U32, U32);
+   void (*mCompressDXTRow)(const U8 *, U32, U32, U8 *, bool);
+
+   BitmapLibraryScope()
+      : mExtrudeRGBA( bitmapExtrudeRGBA ),
+        mExtrudeRGBAKaiser( bitmapExtrudeRGBAKaiser ),
+        mCompressDXTRow( bitmapCompressDXTRow )
+   {
+   }
+
+   ~BitmapLibraryScope()
+   {
+      bitmapExtrudeRGBA = mExtrudeRGBA;
+      bitmapExtrudeRGBAKaiser = mExtrudeRGBAKaiser;
+      bitmapCompressDXTRow = mCompressDXTRow;
+   }
+};
+
+bool hasSSE2()
+{
+#if defined(TORQUE_CPU_X86)
+   return Platform::SystemInfo.processor.properties & CPU_PROP_SSE2;
+#else
+   return false;
+#endif
+}
+
+/// Fills an RGBA bitmap with smooth gradients and a little noise,
+/// which is closer to real textures than pure noise.
+void fillBitmap( GBitmap &bitmap, MRandomLCG &rand )
+{
+   const U32 width = bitmap.getWidth();
+   const U32 height = bitmap.getHeight();
+   const U32 bpp = bitmap.getBytesPerPixel();
+   U8 *bits = bitmap.getWritableBits();
+
+   for ( U32 y=0; y < height; y++ )
+   {
+      for ( U32 x=0; x < width; x++ )
+      {
+         U8 *pixel = bits + ( y * width + x ) * bpp;
+         pixel[0] = ( x * 255 ) / width;
+         pixel[1] = ( y * 255 ) / height;
+         pixel[2] = mClamp( S32( ( x + y ) * 127 / width ) + rand.randI( -8, 8 ), 0, 255 );
+         if ( bpp == 4 )
+            pixel[3] = ( ( x / 16 + y / 16 ) & 1 ) ? 255 : 64;
+      }
+   }
+}
+
+/// Returns the largest difference of any channel.
+U32 maxDifference( const U8 *a, const U8 *b, U32 size )
+{
+   U32 diff = 0;
+   for ( U32 i=0; i < size; i++ )
+      diff = getMax( diff, U32( mAbs( S32( a[i] ) - S32( b[i] ) ) ) );
+   return diff;
+}
+
+} // namespace {}
+
+CreateUnitTest( TestBitmapCodec, "GFX/Bitmap/Codec" )
+{
+   enum
+   {
+      Size = 128,
+      OddSize = 6,
+   };
+
+   void testMipFilters( MRandomLCG &rand )
+   {
+      BitmapLibraryScope scope;
+
+      GBitmap source( Size, Size, false, GFXFormatR8G8B8A8 );
+      fillBitmap( source, rand );
+
+      GBitmap box( source );
+      GBitmap kaiser( source );
+      bitmapInstallLibrary_C();
+      box.extrudeMipLevels();
+      kaiser.extrudeMipLevels( false, GBitmap::MipFilterKaiser );
+
+      test( box.getNumMipLevels() == kaiser.getNumMipLevels(), "The filters built different mip chains!" );
+      test( kaiser.getWidth( kaiser.getNumMipLevels() - 1 ) == 1, "The Kaiser filter didn't reach 1x1!" );
+
+      // The Kaiser mips are sharper, but still close to the box mips.
+      const U32 mipSize = box.getWidth( 1 ) * box.getHeight( 1 ) * 4;
+      test( maxDifference( box.getBits( 1 ), kaiser.getBits( 1 ), mipSize ) < 48, "The Kaiser mip is too far from the box mip!" );
+
+      if ( !hasSSE2() )
+      {
+         Con::printf( "GFX/Bitmap/Codec: skipped the SSE2 mip filters, not supported." );
+         return;
+      }
+
+      GBitmap boxSSE( source );
+      GBitmap kaiserSSE( source );
+      bitmapInstallLibrary_SSE2();
+      boxSSE.extrudeMipLevels();
+      kaiserSSE.extrudeMipLevels( false, GBitmap::MipFilterKaiser );
+
+      for ( U32 i=1; i < box.getNumMipLevels(); i++ )
+      {
+         const U32 size = box.getWidth( i ) * box.getHeight( i ) * 4;
+         test( dMemcmp( box.getBits( i ), boxSSE.getBits( i ), size ) == 0, "The SSE2 box filter doesn't match the C version!" );
+         test( maxDifference( kaiser.getBits( i ), kaiserSSE.getBits( i ), size ) <= 1, "The SSE2 Kaiser filter doesn't match the C version!" );
+      }
+   }
+
+   void testDXT( MRandomLCG &rand, GFXFormat format )
+   {
+      BitmapLibraryScope scope;
+
+      GBitmap source( Size, Size, false, GFXFormatR8G8B8A8 );
+      fillBitmap( source, rand );
+      source.extrudeMipLevels();
+
+      bitmapInstallLibrary_C();
+      DDSFile *dds = DDSFile::createDDSFileFromGBitmap( &source );
+      test( DDSUtil::compressDDS( dds, format ), "Failed to compress!" );
+      test( dds->mFormat == format, "Wrong compressed format!" );
+
+      if ( hasSSE2() )
+      {
+         bitmapInstallLibrary_SSE2();
+         DDSFile *ddsSSE = DDSFile::createDDSFileFromGBitmap( &source );
+         DDSUtil::compressDDS( ddsSSE, format );
+
+         bool same = true;
+         for ( U32 i=0; i < dds->mMipMapCount; i++ )
+            same &= dMemcmp( dds->mSurfaces[0]->mMips[i], ddsSSE->mSurfaces[0]->mMips[i], dds->getSurfaceSize( i ) ) == 0;
+         test( same, "The SSE2 compressor doesn't match the C version!" );
+         delete ddsSSE;
+      }
+
+      // Decompress and check the error, the gradients have to
+      // survive and DXT5 has to keep the alpha.
+      test( DDSUtil::decompressDDS( dds ), "Failed to decompress!" );
+      test( dds->mFormat == GFXFormatR8G8B8A8, "Wrong decompressed format!" );
+
+      F64 errorSq = 0.0;
+      U32 maxAlphaError = 0;
+      const U8 *original = source.getBits();
+      const U8 *decoded = dds->mSurfaces[0]->mMips[0];
+      for ( U32 i=0; i < Size * Size; i++ )
+      {
+         for ( U32 c=0; c < 3; c++ )
+         {
+            const F64 error = F64( original[ i * 4 + c ] ) - F64( decoded[ i * 4 + c ] );
+            errorSq += error * error;
+         }
+         maxAlphaError = getMax( maxAlphaError, U32( mAbs( S32( original[ i * 4 + 3 ] ) - S32( decoded[ i * 4 + 3 ] ) ) ) );
+      }
+
+      const F64 rmse = mSqrt( errorSq / ( Size * Size * 3 ) );
+      test( rmse < 8.0, "The DXT error is too large!" );
+      if ( format == GFXFormatDXT5 )
+         test( maxAlphaError < 4, "DXT5 lost the alpha!" );
+
+      delete dds;
+
+      // Mips which aren't a multiple of four get padded.
+      GBitmap odd( OddSize, OddSize, false, GFXFormatR8G8B8A8 );
+      fillBitmap( odd, rand );
+      DDSFile *oddDDS = DDSFile::createDDSFileFromGBitmap( &odd );
+      test( DDSUtil::compressDDS( oddDDS, format ), "Failed to compress the odd size!" );
+      test( DDSUtil::decompressDDS( oddDDS ), "Failed to decompress the odd size!" );
+      test( maxDifference( odd.getBits(), oddDDS->mSurfaces[0]->mMips[0], OddSize * OddSize * 4 ) < 64, "The odd size didn't survive!" );
+      delete oddDDS;
+   }
+
+   void run()
+   {
+      MRandomLCG rand( 4711 );
+      testMipFilters( rand );
+      testDXT( rand, GFXFormatDXT1 );
+      testDXT( rand, GFXFormatDXT5 );
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestBitmapBenchmark, "GFX/Bitmap/Benchmark" )
+{
+   enum
+   {
+      Size = 512,
+      NumRuns = 8,
+   };
+
+   /// Prints the throughput of a stage in megabytes of pixels per second.
+   void report( const char *stage, U32 bytes, U32 ms )
+   {
+      const F64 mbs = ms ? ( F64( bytes ) * NumRuns / ( 1024.0 * 1024.0 ) ) / ( ms / 1000.0 ) : 0.0;
+      Con::printf( "GFX/Bitmap/Benchmark: %-20s %8.1f MB/s", stage, mbs );
+   }
+
+   void benchDecode( const char *type, GBitmap &source )
+   {
+      MemStream stream( 4096 );
+      test( source.writeBitmap( type, stream ), "Failed to write the bitmap!" );
+      const U32 size = stream.getPosition();
+
+      const U32 start = Platform::getRealMilliseconds();
+      for ( U32 i=0; i < NumRuns; i++ )
+      {
+         MemStream readStream( size, stream.getBuffer(), true, false );
+         GBitmap bitmap;
+         test( bitmap.readBitmap( type, readStream ), "Failed to read the bitmap!" );
+      }
+
+      report( avar( "%s decode", type ), source.getWidth() * source.getHeight() * source.getBytesPerPixel(), Platform::getRealMilliseconds() - start );
+   }
+
+   void benchMips( const char *stage, GBitmap &source, GBitmap::MipFilter filter )
+   {
+      const U32 start = Platform::getRealMilliseconds();
+      for ( U32 i=0; i < NumRuns; i++ )
+      {
+         GBitmap bitmap( source );
+         bitmap.extrudeMipLevels( false, filter );
+      }
+
+      report( stage, Size * Size * 4, Platform::getRealMilliseconds() - start );
+   }
+
+   void benchDXT( const char *stage, GBitmap &source, GFXFormat format, bool squish )
+   {
+      U32 ms = 0;
+      for ( U32 i=0; i < NumRuns; i++ )
+      {
+         DDSFile *dds = DDSFile::createDDSFileFromGBitmap( &source );
+         const U32 start = Platform::getRealMilliseconds();
+         if ( squish )
+            DDSUtil::squishDDS( dds, format );
+         else
+            DDSUtil::compressDDS( dds, format );
+         ms += Platform::getRealMilliseconds() - start;
+         delete dds;
+      }
+
+      report( stage, Size * Size * 4, ms );
+   }
+
+   void benchDecompress( const char *stage, GBitmap &source, GFXFormat format )
+   {
+      U32 ms = 0;
+      for ( U32 i=0; i < NumRuns; i++ )
+      {
+         DDSFile *dds = DDSFile::createDDSFileFromGBitmap( &source );
+         DDSUtil::compressDDS( dds, format );
+         const U32 start = Platform::getRealMilliseconds();
+         DDSUtil::decompressDDS( dds );
+         ms += Platform::getRealMilliseconds() - start;
+         delete dds;
+      }
+
+      report( stage, Size * Size * 4, ms );
+   }
+
+   void run()
+   {
+      BitmapLibraryScope scope;
+      MRandomLCG rand( 1234 );
+
+      GBitmap rgba( Size, Size, false, GFXFormatR8G8B8A8 );
+      fillBitmap( rgba, rand );
+      GBitmap rgb( Size, Size, false, GFXFormatR8G8B8 );
+      fillBitmap( rgb, rand );
+
+      benchDecode( "png", rgba );
+      benchDecode( "jpg", rgb );
+
+      bitmapInstallLibrary_C();
+      benchMips( "box mips C", rgba, GBitmap::MipFilterBox );
+      benchMips( "kaiser mips C", rgba, GBitmap::MipFilterKaiser );
+      benchDXT( "dxt1 squish", rgba, GFXFormatDXT1, true );
+      benchDXT( "dxt5 squish", rgba, GFXFormatDXT5, true );
+      benchDXT( "dxt1 C", rgba, GFXFormatDXT1, false );
+      benchDXT( "dxt5 C", rgba, GFXFormatDXT5, false );
+      benchDecompress( "dxt1 decompress", rgba, GFXFormatDXT1 );
+      benchDecompress( "dxt5 decompress", rgba, GFXFormatDXT5 );
+
+      if ( !hasSSE2() )
+         return;
+
+      bitmapInstallLibrary_SSE2();
+      benchMips( "box mips SSE2", rgba, GBitmap::MipFilterBox );
+      benchMips( "kaiser mips SSE2", rgba, GBitmap::MipFilterKaiser );
+      benchDXT( "dxt1 SSE2", rgba, GFXFormatDXT1, false );
+      benchDXT( "dxt5 SSE2", rgba, GFXFormatDXT5, false );
+   }
+};
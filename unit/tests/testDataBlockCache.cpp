@@ -0,0 +1,158 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "core/stream/bitStream.h"
+#include "T3D/gameConnection.h"
+#include "T3D/gameConnectionEvents.h"
+#include "T3D/dataBlockCache.h"
+#include "console/simDatablock.h"
+#include "console/console.h"
+
+#ifdef AFX_CAP_DATABLOCK_CACHE
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+class DataBlockCacheTestData : public SimDataBlock
+{
+   typedef SimDataBlock Parent;
+
+public:
+   S32 mValue;
+
+   DataBlockCacheTestData() : mValue( 0 ) {}
+
+   virtual void packData( BitStream *stream )
+   {
+      Parent::packData( stream );
+      stream->write( mValue );
+   }
+
+   virtual void unpackData( BitStream *stream )
+   {
+      Parent::unpackData( stream );
+      stream->read( &mValue );
+   }
+
+   DECLARE_CONOBJECT( DataBlockCacheTestData );
+};
+
+IMPLEMENT_CO_DATABLOCK_V1( DataBlockCacheTestData );
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestDataBlockCache, "T3D/DataBlockCache" )
+{
+   DataBlockCacheTestData* createBlock( S32 value )
+   {
+      DataBlockCacheTestData *block = new DataBlockCacheTestData;
+      block->mValue = value;
+      block->assignId();
+      block->registerObject();
+      return block;
+   }
+
+   void run()
+   {
+      const char *cacheFile = "testDataBlockCache.dbc";
+      const String oldCacheFile = Con::getVariable( "$pref::Client::DatablockCacheFilename" );
+
+      DataBlockCacheTestData *cached = createBlock( 1 );
+      DataBlockCacheTestData *fresh = createBlock( 2 );
+      const U32 firstIndex = Sim::getDataBlockGroup()->size() - 2;
+      test( ( *Sim::getDataBlockGroup() )[ firstIndex ] == cached, "Blocks weren't added to the datablock group!" );
+
+      GameConnection *server = new GameConnection;
+      GameConnection *client = new GameConnection;
+
+      // The memoized hash matches the packed bits.
+      U32 cachedHash = 0, freshHash = 0;
+      test( DataBlockCache::getDataBlockHash( cached, server, cachedHash ), "Failed to hash a block!" );
+      test( DataBlockCache::getDataBlockHash( fresh, server, freshHash ), "Failed to hash a block!" );
+      test( cachedHash != freshHash, "Different blocks should hash differently!" );
+
+      U8 buffer[ 256 ];
+      dMemset( buffer, 0, sizeof( buffer ) );
+      BitStream packed( buffer, sizeof( buffer ) );
+      cached->packData( &packed );
+      const S32 classId = cached->getClassId( server->getNetClassGroup() );
+      test( DataBlockCache::computeHash( classId, buffer, packed.getCurPos() ) == cachedHash, "Hash doesn't match the packed bits!" );
+
+      U32 hash = 0;
+      test( DataBlockCache::getDataBlockHash( cached, server, hash ) && hash == cachedHash, "Memoized hash changed!" );
+
+      // Only the first block goes into the client's cache file.
+      {
+         DataBlockCache cache;
+         cache.record( cached->getId(), classId, buffer, packed.getCurPos() );
+         test( cache.isDirty(), "Recording didn't dirty the cache!" );
+         test( cache.save( cacheFile ), "Failed to save the cache!" );
+      }
+      {
+         DataBlockCache cache;
+         test( cache.load( cacheFile ), "Failed to load the cache!" );
+         const DataBlockCache::Entry *entry = cache.find( cached->getId() );
+         test( entry && entry->hash == cachedHash, "Cache miss on a recorded block!" );
+         test( cache.find( fresh->getId() ) == NULL, "Cache hit on a block that was never recorded!" );
+
+         SimDataBlock *copy = entry ? cache.createDataBlock( *entry, client ) : NULL;
+         test( copy && static_cast<DataBlockCacheTestData*>( copy )->mValue == 1, "Cached block unpacked wrong!" );
+         delete copy;
+      }
+
+      // The server only trusts a manifest entry with a matching hash.
+      server->setClientDataBlockHash( cached->getId(), cachedHash );
+      server->setClientDataBlockHash( fresh->getId(), freshHash + 1 );
+      if ( GameConnection::serverCacheEnabled() )
+      {
+         test( server->clientHasDataBlock( cached->getId(), cachedHash ), "Manifest hit was missed!" );
+         test( !server->clientHasDataBlock( fresh->getId(), freshHash ), "Stale manifest entry was a hit!" );
+         test( !server->clientHasDataBlock( cached->getId() + 1000, cachedHash ), "Unknown block was a hit!" );
+      }
+
+      // Send both blocks in one batch; the cached one must go out as a
+      // reference and be unpacked from the client's cache.
+      Con::setVariable( "$pref::Client::DatablockCacheFilename", cacheFile );
+      client->sendDataBlockManifest();
+      test( client->getDataBlockCache() && client->getDataBlockCache()->size() == 1, "Client didn't load its cache!" );
+
+      SimDataBlockBatchEvent *sent = new SimDataBlockBatchEvent( server, firstIndex, 0 );
+      test( !sent->isEmpty(), "Batch is empty!" );
+      test( sent->getNextIndex() == Sim::getDataBlockGroup()->size(), "Batch didn't take both blocks!" );
+
+      U8 packet[ 4096 ];
+      BitStream stream( packet, sizeof( packet ) );
+      sent->pack( server, &stream );
+      test( stream.isValid(), "Batch didn't fit the packet!" );
+      delete sent;
+
+      NetConnection::getErrorBuffer() = String();
+      stream.setPosition( 0 );
+      SimDataBlockBatchEvent *received = new SimDataBlockBatchEvent;
+      received->unpack( client, &stream );
+      test( NetConnection::getErrorBuffer().isEmpty(), "Batch failed to unpack!" );
+
+      const GameConnection::DataBlockLoadStats &stats = client->getDataBlockLoadStats();
+      if ( GameConnection::serverCacheEnabled() )
+      {
+         test( stats.numReceived == 2, "Wrong number of blocks received!" );
+         test( stats.numCached == 1, "Cached block was sent in full!" );
+      }
+      test( client->getDataBlockCache()->find( fresh->getId() ) != NULL, "Client didn't record the new block!" );
+      delete received;
+
+      delete client;
+      delete server;
+      cached->deleteObject();
+      fresh->deleteObject();
+
+      Con::setVariable( "$pref::Client::DatablockCacheFilename", oldCacheFile );
+   }
+};
+
+#endif // AFX_CAP_DATABLOCK_CACHE
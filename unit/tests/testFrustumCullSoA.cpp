@@ -0,0 +1,246 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "math/util/frustum.h"
+#include "math/mMathFn.h"
+#include "math/mRandom.h"
+#include "math/mSphere.h"
+#include "console/console.h"
+
+extern void m_planeF_cull_SoA_C(const F32 *planes, const U32 numFrustums, const F32 *const *bounds, const U32 count, U32 *outMasks);
+
+#if defined(TORQUE_CPU_X86)
+extern void SSE_PlaneF_Cull_SoA(const F32 *planes, const U32 numFrustums, const F32 *const *bounds, const U32 count, U32 *outMasks);
+#endif
+
+using namespace UnitTesting;
+
+namespace
+{
+   /// Random bounds in both the flat stream layout and as boxes.
+   struct CullTestBounds
+   {
+      enum { StreamCount = 10 };
+
+      U32 count;
+      F32 *data;
+      const F32 *streams[ StreamCount ];
+      Vector<Box3F> boxes;
+      Vector<SphereF> spheres;
+
+      CullTestBounds( U32 inCount, MRandomLCG &rand )
+      {
+         count = ( inCount + 3 ) & ~3;
+         data = (F32*)dAligned_malloc( count * StreamCount * sizeof( F32 ), 16 );
+         dMemset( data, 0, count * StreamCount * sizeof( F32 ) );
+
+         for ( U32 i=0; i < StreamCount; i++ )
+            streams[i] = data + i * count;
+
+         boxes.setSize( inCount );
+         spheres.setSize( inCount );
+
+         for ( U32 i=0; i < inCount; i++ )
+         {
+            Point3F center( rand.randF( -500.0f, 500.0f ), rand.randF( -500.0f, 500.0f ), rand.randF( -50.0f, 50.0f ) );
+            Point3F extents( rand.randF( 0.1f, 20.0f ), rand.randF( 0.1f, 20.0f ), rand.randF( 0.1f, 20.0f ) );
+
+            Box3F &box = boxes[i];
+            box.minExtents = center - extents;
+            box.maxExtents = center + extents;
+
+            SphereF &sphere = spheres[i];
+            sphere.center = center;
+            sphere.radius = extents.len();
+
+            F32 *out = data + i;
+            out[ count * 0 ] = box.minExtents.x;
+            out[ count * 1 ] = box.minExtents.y;
+            out[ count * 2 ] = box.minExtents.z;
+            out[ count * 3 ] = box.maxExtents.x;
+            out[ count * 4 ] = box.maxExtents.y;
+            out[ count * 5 ] = box.maxExtents.z;
+            out[ count * 6 ] = center.x;
+            out[ count * 7 ] = center.y;
+            out[ count * 8 ] = center.z;
+            out[ count * 9 ] = sphere.radius;
+         }
+      }
+
+      ~CullTestBounds()
+      {
+         dAligned_free( data );
+      }
+   };
+
+   void _copyPlanes( const Frustum &frustum, F32 *out )
+   {
+      const PlaneF *planes = frustum.getPlanes();
+      for ( U32 p=0; p < Frustum::PlaneCount; p++ )
+      {
+         out[ p * 4 + 0 ] = planes[p].x;
+         out[ p * 4 + 1 ] = planes[p].y;
+         out[ p * 4 + 2 ] = planes[p].z;
+         out[ p * 4 + 3 ] = planes[p].d;
+      }
+   }
+
+   /// A camera frustum followed by four shadow cascades looking
+   /// down from above the camera.
+   void _setupFrustums( Frustum *frustums )
+   {
+      MatrixF cam( EulerF( 0.0f, 0.0f, 0.6f ) );
+      cam.setPosition( Point3F( 10.0f, -20.0f, 5.0f ) );
+      frustums[0].set( false, M_PI_F * 0.5f, 4.0f / 3.0f, 0.1f, 400.0f, cam );
+
+      MatrixF light( EulerF( M_PI_F * 0.5f, 0.0f, 0.0f ) );
+      for ( U32 i=0; i < 4; i++ )
+      {
+         const F32 size = 25.0f * F32( 1 << ( i * 2 ) );
+         light.setPosition( Point3F( 10.0f, -20.0f + size, 300.0f ) );
+         frustums[ i + 1 ].set( true, -size, size, size, -size, 1.0f, 600.0f, light );
+      }
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestFrustumCullSoA, "Math/FrustumCullSoA" )
+{
+   void run()
+   {
+      MRandomLCG rand( 1234 );
+
+      // An odd count exercises the padding at the end of the streams.
+      CullTestBounds bounds( 1027, rand );
+
+      Frustum frustums[5];
+      _setupFrustums( frustums );
+
+      F32 planes[ 5 * Frustum::PlaneCount * 4 ];
+      for ( U32 f=0; f < 5; f++ )
+         _copyPlanes( frustums[f], planes + f * Frustum::PlaneCount * 4 );
+
+      Vector<U32> masks;
+      masks.setSize( bounds.count );
+      m_planeF_cull_SoA( planes, 5, bounds.streams, bounds.count, masks.address() );
+
+      U32 mismatches = 0;
+      U32 visible = 0;
+      for ( U32 i=0; i < bounds.boxes.size(); i++ )
+      {
+         for ( U32 f=0; f < 5; f++ )
+         {
+            const bool expected =   frustums[f].intersects( bounds.boxes[i] ) &&
+                                    frustums[f].sphereInFrustum( bounds.spheres[i].center, bounds.spheres[i].radius );
+            const bool result = ( masks[i] & ( 1 << f ) ) != 0;
+
+            if ( expected != result )
+               mismatches++;
+            if ( result )
+               visible++;
+         }
+      }
+
+      test( mismatches == 0, "SoA culling disagrees with Frustum::intersects!" );
+      test( visible > 0 && visible < bounds.boxes.size() * 5, "Test bounds should be partially visible!" );
+
+      // Zero sized padding entries at the origin are valid bounds
+      // so just make sure they don't spill into other bits.
+      for ( U32 i=bounds.boxes.size(); i < bounds.count; i++ )
+         test( ( masks[i] & ~0x1F ) == 0, "Padding entries set unused frustum bits!" );
+
+      // The installed function may be either version, so check
+      // the C and SSE versions against each other directly.
+      Vector<U32> masksC;
+      masksC.setSize( bounds.count );
+      m_planeF_cull_SoA_C( planes, 5, bounds.streams, bounds.count, masksC.address() );
+
+#if defined(TORQUE_CPU_X86)
+      if ( Platform::SystemInfo.processor.properties & CPU_PROP_SSE )
+      {
+         Vector<U32> masksSSE;
+         masksSSE.setSize( bounds.count );
+         SSE_PlaneF_Cull_SoA( planes, 5, bounds.streams, bounds.count, masksSSE.address() );
+
+         U32 differ = 0;
+         for ( U32 i=0; i < bounds.count; i++ )
+         {
+            if ( masksC[i] != masksSSE[i] )
+               differ++;
+         }
+
+         test( differ == 0, "SoA culling verification failed. (C vs. SSE)" );
+      }
+      else
+         warn( "Could not test SSE culling because CPU does not support SSE." );
+#endif
+
+      U32 differ = 0;
+      for ( U32 i=0; i < bounds.count; i++ )
+      {
+         if ( masksC[i] != masks[i] )
+            differ++;
+      }
+
+      test( differ == 0, "SoA culling verification failed. (C vs. installed)" );
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestFrustumCullSoAPerformance, "Math/FrustumCullSoAPerformance" )
+{
+   void run()
+   {
+      const U32 count = 50000;
+      const F64 toMs = 1000.0 / F64( Platform::getPerformanceCounterFrequency() );
+
+      MRandomLCG rand( 5678 );
+      CullTestBounds bounds( count, rand );
+
+      Frustum frustums[5];
+      _setupFrustums( frustums );
+
+      F32 planes[ 5 * Frustum::PlaneCount * 4 ];
+      for ( U32 f=0; f < 5; f++ )
+         _copyPlanes( frustums[f], planes + f * Frustum::PlaneCount * 4 );
+
+      Vector<U32> masks;
+      masks.setSize( bounds.count );
+
+      // The per-object box tests the traversal used to do.
+      U32 visible = 0;
+      U64 start = Platform::getPerformanceCounter();
+      for ( U32 i=0; i < count; i++ )
+      {
+         if ( frustums[0].intersects( bounds.boxes[i] ) )
+            visible++;
+      }
+      const F64 aosMs = F64( Platform::getPerformanceCounter() - start ) * toMs;
+
+      start = Platform::getPerformanceCounter();
+      m_planeF_cull_SoA( planes, 1, bounds.streams, bounds.count, masks.address() );
+      const F64 soaMs = F64( Platform::getPerformanceCounter() - start ) * toMs;
+
+      // The camera and cascades one frustum at a time...
+      start = Platform::getPerformanceCounter();
+      for ( U32 f=0; f < 5; f++ )
+         m_planeF_cull_SoA( planes + f * Frustum::PlaneCount * 4, 1, bounds.streams, bounds.count, masks.address() );
+      const F64 separateMs = F64( Platform::getPerformanceCounter() - start ) * toMs;
+
+      // ...and all of them in a single pass.
+      start = Platform::getPerformanceCounter();
+      m_planeF_cull_SoA( planes, 5, bounds.streams, bounds.count, masks.address() );
+      const F64 combinedMs = F64( Platform::getPerformanceCounter() - start ) * toMs;
+
+      Con::printf( "FrustumCullSoA: %d objects (%d visible) - per object %.3fms, SoA %.3fms",
+         count, visible, aosMs, soaMs );
+      Con::printf( "FrustumCullSoA: 1+4 cascades - separate passes %.3fms, single pass %.3fms",
+         separateMs, combinedMs );
+   }
+};
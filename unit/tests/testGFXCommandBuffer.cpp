@@ -0,0 +1,252 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "gfx/gfxCommandBuffer.h"
+#include "gfx/gfxDevice.h"
+#include "platform/threads/threadPool.h"
+#include "platform/threads/semaphore.h"
+#include "console/console.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+class CommandBufferTestHandle : public GFXShaderConstHandle
+{
+public:
+
+   String mName;
+
+   CommandBufferTestHandle( const String &name, bool valid ) : mName( name ) { mValid = valid; }
+
+   virtual const String& getName() const { return mName; }
+   virtual GFXShaderConstType getType() const { return GFXSCT_Float4; }
+   virtual U32 getArraySize() const { return 1; }
+   virtual S32 getSamplerRegister() const { return -1; }
+};
+
+/// Records what was set on it so the test can check the playback.
+class CommandBufferTestConsts : public GFXShaderConstBuffer
+{
+public:
+
+   U32 mSetCount;
+   Point4F mLastPoint4F;
+   F32 mLastF32;
+   F32 mArraySum;
+   U32 mMatrixCount;
+
+   CommandBufferTestConsts()
+      : mSetCount( 0 ),
+        mLastPoint4F( 0.0f, 0.0f, 0.0f, 0.0f ),
+        mLastF32( 0.0f ),
+        mArraySum( 0.0f ),
+        mMatrixCount( 0 )
+   {
+   }
+
+   virtual GFXShader* getShader() { return NULL; }
+
+   virtual void set( GFXShaderConstHandle* handle, const F32 f ) { mSetCount++; mLastF32 = f; }
+   virtual void set( GFXShaderConstHandle* handle, const Point2F& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const Point3F& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const Point4F& fv ) { mSetCount++; mLastPoint4F = fv; }
+   virtual void set( GFXShaderConstHandle* handle, const PlaneF& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const ColorF& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const S32 f ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const Point2I& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const Point3I& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const Point4I& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const AlignedArray<F32>& fv )
+   {
+      mSetCount++;
+      for ( U32 i=0; i < fv.size(); i++ )
+         mArraySum += fv[i];
+   }
+   virtual void set( GFXShaderConstHandle* handle, const AlignedArray<Point2F>& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const AlignedArray<Point3F>& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const AlignedArray<Point4F>& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const AlignedArray<S32>& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const AlignedArray<Point2I>& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const AlignedArray<Point3I>& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const AlignedArray<Point4I>& fv ) { mSetCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const MatrixF& mat, const GFXShaderConstType matrixType ) { mSetCount++; mMatrixCount++; }
+   virtual void set( GFXShaderConstHandle* handle, const MatrixF* mat, const U32 arraySize, const GFXShaderConstType matrixType ) { mSetCount++; mMatrixCount += arraySize; }
+
+   virtual const String describeSelf() const { return String(); }
+   virtual void zombify() {}
+   virtual void resurrect() {}
+   virtual void onShaderReload( GFXShader *shader ) {}
+};
+
+/// Records a run of draws into its own command buffer from a pool thread.
+struct CommandBufferTestItem : public ThreadPool::WorkItem
+{
+   GFXCommandBuffer *mCmds;
+   GFXShaderConstBuffer *mConsts;
+   GFXShaderConstHandle *mHandle;
+   U32 mFirst;
+   U32 mCount;
+   Semaphore *mDone;
+
+   CommandBufferTestItem( GFXCommandBuffer *cmds, GFXShaderConstBuffer *consts, GFXShaderConstHandle *handle, U32 first, U32 count, Semaphore *done )
+      : mCmds( cmds ), mConsts( consts ), mHandle( handle ), mFirst( first ), mCount( count ), mDone( done ) {}
+
+protected:
+   virtual void execute()
+   {
+      for ( U32 i=0; i < mCount; i++ )
+      {
+         mCmds->setShaderConst( mConsts, mHandle, F32( mFirst + i ) );
+         mCmds->drawPrimitive( GFXTriangleList, 0, 2 );
+      }
+
+      mDone->release();
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestGFXCommandBufferRecord, "GFX/CommandBuffer/Record" )
+{
+   void run()
+   {
+      CommandBufferTestHandle valid( "$valid", true );
+      CommandBufferTestHandle invalid( "$invalid", false );
+      CommandBufferTestConsts *consts = new CommandBufferTestConsts;
+      GFXShaderConstBufferRef constsRef( consts );
+
+      GFXCommandBuffer cmds;
+      test( cmds.isEmpty() && cmds.getSize() == 0, "New buffer should be empty!" );
+
+      cmds.setShaderConst( consts, &valid, Point4F( 1, 2, 3, 4 ) );
+      cmds.setShaderConst( consts, &invalid, Point4F( 5, 6, 7, 8 ) );
+      test( cmds.getCommandCount() == 1, "Invalid handles should not be recorded!" );
+
+      // Values are copied, so changing the source afterwards is fine.
+      F32 values[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+      cmds.setShaderConst( consts, &valid, AlignedArray<F32>( 4, sizeof( F32 ), (U8*)values, false ) );
+      values[0] = 100.0f;
+
+      MatrixF mats[3] = { MatrixF( true ), MatrixF( true ), MatrixF( true ) };
+      cmds.setShaderConst( consts, &valid, mats, 3 );
+      cmds.setShaderConst( consts, &valid, 0.5f );
+
+      cmds.drawPrimitive( GFXTriangleList, 0, 2 );
+      test( cmds.getDrawCount() == 1, "Draw was not counted!" );
+      test( cmds.getSize() % 16 == 0, "Commands should stay aligned!" );
+
+      GFXCommandBuffer other;
+      other.drawPrimitive( GFXTriangleStrip, 0, 4 );
+      other.drawIndexedPrimitive( GFXTriangleList, 0, 0, 4, 0, 2 );
+
+      const U32 size = cmds.getSize() + other.getSize();
+      cmds.append( other );
+      test( cmds.getCommandCount() == 7, "Append lost commands!" );
+      test( cmds.getDrawCount() == 3, "Append lost draws!" );
+      test( cmds.getSize() == size, "Append has the wrong size!" );
+
+      cmds.reset();
+      test( cmds.isEmpty() && cmds.getSize() == 0 && cmds.getDrawCount() == 0, "Reset should discard everything!" );
+
+      if ( !GFXDevice::devicePresent() )
+         return;
+
+      // Constants go straight to their buffer, so this plays
+      // back the same whatever the device is.
+      GFXCommandBuffer constCmds;
+      constCmds.setShaderConst( consts, &valid, Point4F( 1, 2, 3, 4 ) );
+      constCmds.setShaderConst( consts, &valid, AlignedArray<F32>( 4, sizeof( F32 ), (U8*)values, false ) );
+      constCmds.setShaderConst( consts, &valid, mats, 3 );
+      constCmds.setShaderConst( consts, &valid, 0.5f );
+
+      // The playback must use the values at record time.
+      values[0] = -1000.0f;
+      values[3] = -1000.0f;
+
+      constCmds.execute( GFX );
+
+      test( consts->mSetCount == 4, "Constants were lost in playback!" );
+      test( consts->mLastPoint4F.x == 1.0f && consts->mLastPoint4F.w == 4.0f, "Point4F constant has the wrong value!" );
+      test( consts->mArraySum == 109.0f, "Array constant wasn't copied at record time!" );
+      test( consts->mMatrixCount == 3, "Matrix array has the wrong size!" );
+      test( consts->mLastF32 == 0.5f, "Constants were played back out of order!" );
+
+      // A constant bigger than 64K still makes a single command.
+      const U32 numBigMats = 2048;
+      Vector<MatrixF> bigMats;
+      bigMats.setSize( numBigMats );
+      for ( U32 i=0; i < numBigMats; i++ )
+         bigMats[i].identity();
+
+      GFXCommandBuffer bigCmds;
+      bigCmds.setShaderConst( consts, &valid, bigMats.address(), numBigMats );
+      bigCmds.setShaderConst( consts, &valid, 0.25f );
+      test( bigCmds.getSize() > U16_MAX, "Matrix array should need more than 64K!" );
+
+      bigCmds.execute( GFX );
+      test( consts->mMatrixCount == 3 + numBigMats, "Large matrix array has the wrong size!" );
+      test( consts->mLastF32 == 0.25f, "Lost the command after the large constant!" );
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestGFXCommandBufferParallel, "GFX/CommandBuffer/Parallel" )
+{
+   enum
+   {
+      NumBuffers = 8,
+      NumPerBuffer = 500
+   };
+
+   void run()
+   {
+      if ( !GFXDevice::devicePresent() || GFX->getAdapterType() != NullDevice )
+      {
+         Con::printf( "CommandBuffer/Parallel: skipped, requires the null device." );
+         return;
+      }
+
+      CommandBufferTestHandle handle( "$index", true );
+      CommandBufferTestConsts *consts = new CommandBufferTestConsts;
+      GFXShaderConstBufferRef constsRef( consts );
+
+      GFXCommandBuffer buffers[NumBuffers];
+      Semaphore done( 0 );
+
+      for ( S32 i = NumBuffers - 1; i >= 0; i-- )
+         ThreadPool::GLOBAL().queueWorkItem( new CommandBufferTestItem( &buffers[i], consts, &handle, i * NumPerBuffer, NumPerBuffer, &done ) );
+
+      for ( U32 i=0; i < NumBuffers; i++ )
+         done.acquire();
+
+      // Merge in order so the playback matches a serial recording.
+      GFXCommandBuffer frame;
+      for ( U32 i=0; i < NumBuffers; i++ )
+         frame.append( buffers[i] );
+
+      test( frame.getDrawCount() == NumBuffers * NumPerBuffer, "Lost draws in the merge!" );
+
+      GFXDeviceStatistics stats;
+      stats.start( GFX->getDeviceStatistics() );
+
+      const U64 start = Platform::getPerformanceCounter();
+      frame.execute( GFX );
+      const F64 ms = F64( Platform::getPerformanceCounter() - start ) * 1000.0 / F64( Platform::getPerformanceCounterFrequency() );
+
+      stats.end( GFX->getDeviceStatistics() );
+
+      test( stats.mDrawCalls == NumBuffers * NumPerBuffer, "Device did not get every draw!" );
+      test( stats.mPolyCount == NumBuffers * NumPerBuffer * 2, "Device has the wrong poly count!" );
+      test( consts->mSetCount == NumBuffers * NumPerBuffer, "Lost constants in playback!" );
+      test( consts->mLastF32 == F32( NumBuffers * NumPerBuffer - 1 ), "Buffers were played back out of order!" );
+
+      Con::printf( "CommandBuffer/Parallel: %d draws, %d bytes, executed in %.3fms",
+         frame.getDrawCount(), frame.getSize(), ms );
+   }
+};
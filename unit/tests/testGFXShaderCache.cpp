@@ -0,0 +1,213 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "gfx/gfxShaderCache.h"
+#include "core/stream/fileStream.h"
+#include "core/volume.h"
+#include "console/console.h"
+#include "gfx/gfxDevice.h"
+#include "platform/platformIntrinsics.h"
+#include "platform/threads/threadPool.h"
+#include "platform/threads/thread.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+static void _writeTestFile( const Torque::Path &path, const char *text )
+{
+   FileStream stream;
+   if ( stream.open( path, Torque::FS::File::Write ) )
+      stream.write( dStrlen( text ), text );
+}
+
+CreateUnitTest( TestGFXShaderCache, "GFX/ShaderCache" )
+{
+   void run()
+   {
+      const String oldPath = Con::getVariable( "$pref::video::shaderCachePath" );
+      const bool oldEnabled = Con::getBoolVariable( "$pref::video::shaderCache" );
+      Con::setVariable( "$pref::video::shaderCachePath", "testShaderCache" );
+      Con::setBoolVariable( "$pref::video::shaderCache", true );
+
+      const Torque::Path includePath( "testShaderCache/testInclude.h" );
+      _writeTestFile( includePath, "float4 someFunc() { return 1; }" );
+
+      const char *source = "float4 main() : COLOR { return someFunc(); }";
+      const U64 key = GFXShaderCache::computeKey( "ps_3_0 0", source, dStrlen( source ) );
+      test( key != GFXShaderCache::computeKey( "ps_2_0 0", source, dStrlen( source ) ), "The target should change the key!" );
+
+      Vector<GFXShaderCache::Dependency> deps;
+      deps.increment();
+      deps.last().path = includePath;
+      deps.last().hash = GFXShaderCache::hashFile( includePath );
+      test( deps.last().hash != 0, "Failed to hash the include!" );
+
+      const U8 code[] = { 0x00, 0x03, 0xFF, 0xFF, 0x42, 0x00, 0x00, 0x01 };
+      test( GFXShaderCache::store( key, deps, code, sizeof( code ) ), "Failed to store the entry!" );
+
+      Vector<U8> loaded;
+      test( GFXShaderCache::load( key, loaded ), "Failed to load the entry!" );
+      test( loaded.size() == sizeof( code ) && dMemcmp( loaded.address(), code, sizeof( code ) ) == 0, "Loaded the wrong code!" );
+
+      // Changing an include has to invalidate the entry.
+      _writeTestFile( includePath, "float4 someFunc() { return 0; }" );
+      test( !GFXShaderCache::load( key, loaded ), "Entry with a changed include was loaded!" );
+
+      // So does a damaged entry.
+      deps.last().hash = GFXShaderCache::hashFile( includePath );
+      GFXShaderCache::store( key, deps, code, sizeof( code ) );
+      const Torque::Path entryPath( String::ToString( "testShaderCache/%08x%08x.tsc", (U32)( key >> 32 ), (U32)( key & 0xFFFFFFFF ) ) );
+      {
+         FileStream stream;
+         if ( stream.open( entryPath, Torque::FS::File::ReadWrite ) )
+         {
+            stream.setPosition( stream.getStreamSize() - 1 );
+            stream.write( (U8)0x55 );
+         }
+      }
+      test( !GFXShaderCache::load( key, loaded ), "Damaged entry was loaded!" );
+
+      // The entry is moved into place, replacing the old one, and
+      // no temporary file is left behind.
+      test( GFXShaderCache::store( key, deps, code, sizeof( code ) ), "Failed to replace the entry!" );
+      test( GFXShaderCache::load( key, loaded ), "Failed to load the replaced entry!" );
+      const Torque::Path tempPath( String::ToString( "testShaderCache/%08x%08x.%x.tmp",
+         (U32)( key >> 32 ), (U32)( key & 0xFFFFFFFF ), ThreadManager::getCurrentThreadId() ) );
+      test( !Torque::FS::IsFile( tempPath ), "Left the temporary entry behind!" );
+
+      // A truncated entry fails the size check.
+      {
+         void *data;
+         U32 size;
+         if ( Torque::FS::ReadFile( entryPath, data, size ) && data )
+         {
+            FileStream stream;
+            if ( stream.open( entryPath, Torque::FS::File::Write ) )
+               stream.write( size - 3, data );
+            delete [] (char*)data;
+         }
+      }
+      test( !GFXShaderCache::load( key, loaded ), "Truncated entry was loaded!" );
+
+      // The manifest survives a reload and the last entry wins.
+      GFXShaderCache::clearManifest();
+
+      GFXShaderCache::ManifestEntry entry;
+      entry.key = "abcd1234";
+      entry.vertFile = Torque::Path( "shadergen:/abcd1234_V.hlsl" );
+      entry.pixFile = Torque::Path( "shadergen:/abcd1234_P.hlsl" );
+      entry.pixVersion = 3.0f;
+      entry.vertHash = 1;
+      entry.pixHash = 2;
+      GFXShaderCache::addToManifest( entry );
+
+      entry.pixHash = 0x123456789ULL;
+      entry.macros.increment();
+      entry.macros.last().name = "USE_FOG";
+      entry.macros.last().value = "1";
+      entry.macros.increment();
+      entry.macros.last().name = "NO_VALUE";
+      GFXShaderCache::addToManifest( entry );
+
+      GFXShaderCache::loadManifest();
+      const GFXShaderCache::ManifestEntry *found = GFXShaderCache::findInManifest( "abcd1234" );
+      test( found != NULL, "Entry was not in the manifest!" );
+      if ( found )
+      {
+         test( found->pixHash == 0x123456789ULL, "The last entry should win!" );
+         test( found->pixVersion == 3.0f, "Wrong pixel version!" );
+         test( found->vertFile == entry.vertFile, "Wrong vertex file!" );
+         test( found->macros.size() == 2, "Lost the macros!" );
+         if ( found->macros.size() == 2 )
+         {
+            test( found->macros[0].name == String( "USE_FOG" ) && found->macros[0].value == String( "1" ), "Wrong macro!" );
+            test( found->macros[1].name == String( "NO_VALUE" ) && found->macros[1].value.isEmpty(), "Wrong empty macro!" );
+         }
+      }
+
+      GFXShaderCache::clearManifest();
+
+      Torque::FS::Remove( entryPath );
+      Torque::FS::Remove( includePath );
+      Torque::FS::Remove( "testShaderCache/shaderCache.manifest" );
+      Torque::FS::Remove( "testShaderCache" );
+
+      Con::setVariable( "$pref::video::shaderCachePath", oldPath );
+      Con::setBoolVariable( "$pref::video::shaderCache", oldEnabled );
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+static volatile U32 sAsyncVertCompiles = 0;
+static volatile U32 sAsyncPixCompiles = 0;
+
+static bool _countingPrecompiler( const Torque::Path &file, bool isVertex, F32 pixVersion, const Vector<GFXShaderMacro> &macros )
+{
+   dFetchAndAdd( isVertex ? sAsyncVertCompiles : sAsyncPixCompiles, 1 );
+   return true;
+}
+
+CreateUnitTest( TestGFXShaderCacheAsync, "GFX/ShaderCache/Async" )
+{
+   void run()
+   {
+      // The null device has no precompiler, so we can install our own.
+      if ( !GFXDevice::devicePresent() || GFX->getAdapterType() != NullDevice )
+      {
+         Con::printf( "ShaderCache/Async: skipped, requires the null device." );
+         return;
+      }
+
+      const bool oldEnabled = Con::getBoolVariable( "$pref::video::shaderCache" );
+      Con::setBoolVariable( "$pref::video::shaderCache", true );
+
+      const Torque::Path vertPath( "testShaderCache/async_V.hlsl" );
+      const Torque::Path pixPath( "testShaderCache/async_P.hlsl" );
+      _writeTestFile( vertPath, "vertex" );
+      _writeTestFile( pixPath, "pixel" );
+
+      GFXShaderCache::setPrecompiler( GFXShaderCache::PrecompileDelegate( &_countingPrecompiler ) );
+      test( GFXShaderCache::canCompileAsync(), "Async compiles should be available!" );
+
+      sAsyncVertCompiles = 0;
+      sAsyncPixCompiles = 0;
+      const U32 startCount = GFXShaderCache::getAsyncCompileCount();
+
+      GFXShaderCache::ManifestEntry entry;
+      entry.key = "async";
+      entry.vertFile = vertPath;
+      entry.pixFile = pixPath;
+      entry.pixVersion = 3.0f;
+      entry.vertHash = GFXShaderCache::hashFile( vertPath );
+      entry.pixHash = GFXShaderCache::hashFile( pixPath );
+
+      GFXShaderCache::AsyncCompileRef compile = GFXShaderCache::compileAsync( entry );
+      
+      // Changed source is skipped, but still finishes.
+      entry.pixHash++;
+      GFXShaderCache::AsyncCompileRef stale = GFXShaderCache::compileAsync( entry );
+
+      while ( !compile->isDone() || !stale->isDone() )
+      {
+         ThreadPool::processMainThreadWorkItems();
+         Platform::sleep( 1 );
+      }
+
+      test( sAsyncVertCompiles == 1 && sAsyncPixCompiles == 1, "Each stage should be compiled once!" );
+      test( GFXShaderCache::getAsyncCompileCount() - startCount == 2, "The compiles were not counted!" );
+
+      GFXShaderCache::setPrecompiler( GFXShaderCache::PrecompileDelegate() );
+
+      Torque::FS::Remove( vertPath );
+      Torque::FS::Remove( pixPath );
+      Torque::FS::Remove( "testShaderCache" );
+
+      Con::setBoolVariable( "$pref::video::shaderCache", oldEnabled );
+   }
+};
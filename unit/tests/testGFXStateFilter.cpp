@@ -0,0 +1,225 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "gfx/gfxDevice.h"
+#include "gfx/gfxStateBlock.h"
+#include "gfx/genericConstBuffer.h"
+#include "console/console.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+/// Constructs a default desc on top of memory filled with garbage, so
+/// that the padding between the members differs between descs.
+static void _initDesc( GFXStateBlockDesc &desc, U8 garbage )
+{
+   dMemset( &desc, garbage, sizeof( GFXStateBlockDesc ) );
+   constructInPlace( &desc );
+}
+
+/// Does what a device does when it activates a const buffer.
+static U32 _uploadConsts( GenericConstBuffer &buffer, GenericConstBufferShadow &shadow, bool switched )
+{
+   if ( switched )
+      buffer.setDirtyFromShadow( shadow );
+
+   U32 uploaded = 0;
+   if ( buffer.isDirty() )
+   {
+      uploaded = buffer.getDirtyFieldCount();
+
+      U32 start, size;
+      if ( buffer.getDirtyBuffer( start, size ) )
+         buffer.updateShadow( shadow, start, size );
+
+      buffer.setDirty( false );
+   }
+
+   return uploaded;
+}
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestStateBlockDescriptor, "GFX/StateBlockDescriptor" )
+{
+   void run()
+   {
+      GFXStateBlockDesc a, b;
+      _initDesc( a, 0x00 );
+      _initDesc( b, 0xCD );
+
+      GFXStateBlockDescriptor da, db;
+      da.set( a );
+      db.set( b );
+      test( da == db, "Padding should not change the descriptor!" );
+
+      b.setBlend( true );
+      db.set( b );
+      test( da.blend != db.blend, "Blend change not in the blend descriptor!" );
+      test( da.depthStencil == db.depthStencil, "Blend change leaked into the depth descriptor!" );
+      test( da != db, "Blend change not in the combined descriptor!" );
+
+      b = a;
+      b.samplers[3] = GFXSamplerStateDesc::getClampPoint();
+      db.set( b );
+      test( da.samplers[3] != db.samplers[3], "Sampler change not in its descriptor!" );
+      test( da.samplers[2] == db.samplers[2], "Sampler change leaked into another sampler!" );
+      test( da.blend == db.blend, "Sampler change leaked into the blend descriptor!" );
+      test( da != db, "Sampler change not in the combined descriptor!" );
+
+      b = a;
+      b.zBias = -0.0001f;
+      db.set( b );
+      test( da.depthStencil != db.depthStencil, "Depth bias not in the depth descriptor!" );
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestConstBufferShadow, "GFX/ConstBufferShadow" )
+{
+   void run()
+   {
+      GenericConstBufferLayout layout;
+      layout.addParameter( "$eyePos", GFXSCT_Float4, 0, sizeof( Point4F ), 1, sizeof( Point4F ) );
+      layout.addParameter( "$modelview", GFXSCT_Float4x4, 16, sizeof( MatrixF ), 1, sizeof( Point4F ) );
+      layout.addParameter( "$color", GFXSCT_Float4, 80, sizeof( Point4F ), 1, sizeof( Point4F ) );
+
+      GenericConstBufferLayout::ParamDesc eyePos, modelView, color;
+      layout.getDesc( "$eyePos", eyePos );
+      layout.getDesc( "$modelview", modelView );
+      layout.getDesc( "$color", color );
+
+      GenericConstBufferShadow shadow( 8 * sizeof( Point4F ) );
+      GenericConstBuffer a( &layout );
+      GenericConstBuffer b( &layout );
+
+      a.set( eyePos, Point4F( 1, 2, 3, 1 ) );
+      a.set( modelView, MatrixF( true ), GFXSCT_Float4x4 );
+      a.set( color, Point4F( 1, 0, 0, 1 ) );
+      test( _uploadConsts( a, shadow, true ) == 3, "First upload should send every field!" );
+
+      // Setting the same value again is filtered by the buffer itself.
+      a.popRedundantCount();
+      a.set( eyePos, Point4F( 1, 2, 3, 1 ) );
+      test( a.popRedundantCount() == 1, "Redundant set was not counted!" );
+      test( _uploadConsts( a, shadow, false ) == 0, "Unchanged field was uploaded!" );
+
+      // Another buffer only needs to send what differs from the device.
+      b.set( eyePos, Point4F( 1, 2, 3, 1 ) );
+      b.set( modelView, MatrixF( true ), GFXSCT_Float4x4 );
+      b.set( color, Point4F( 0, 1, 0, 1 ) );
+      b.popRedundantCount();
+      test( _uploadConsts( b, shadow, true ) == 1, "Switching buffers should only send the changed field!" );
+      test( b.popRedundantCount() == 2, "Fields already on the device were not counted!" );
+
+      // Switching back has to restore the field that b overwrote.
+      const Point4F red( 1, 0, 0, 1 );
+      test( _uploadConsts( a, shadow, true ) == 1, "Switching back should restore the overwritten field!" );
+      test( shadow.isEqual( color.offset, color.size, (const U8*)&red ), "Shadow is out of sync!" );
+
+      // After the device loses its registers everything goes up again.
+      shadow.invalidate();
+      test( _uploadConsts( a, shadow, true ) == 3, "Invalidated shadow should force a full upload!" );
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestStateFilterReplay, "GFX/StateFilterReplay" )
+{
+   enum
+   {
+      NumDraws = 10000,
+      NumMaterials = 64
+   };
+
+   void run()
+   {
+      // Only the null device gives us the submission cost without
+      // the driver and GPU in the measurement.
+      if ( !GFXDevice::devicePresent() || GFX->getAdapterType() != NullDevice )
+      {
+         Con::printf( "StateFilterReplay: skipped, requires the null device." );
+         return;
+      }
+
+      GenericConstBufferLayout layout;
+      layout.addParameter( "$modelview", GFXSCT_Float4x4, 0, sizeof( MatrixF ), 1, sizeof( Point4F ) );
+      layout.addParameter( "$eyePosWorld", GFXSCT_Float4, 64, sizeof( Point4F ), 1, sizeof( Point4F ) );
+      layout.addParameter( "$diffuseColor", GFXSCT_Float4, 80, sizeof( Point4F ), 1, sizeof( Point4F ) );
+
+      GenericConstBufferLayout::ParamDesc modelView, eyePos, diffuse;
+      layout.getDesc( "$modelview", modelView );
+      layout.getDesc( "$eyePosWorld", eyePos );
+      layout.getDesc( "$diffuseColor", diffuse );
+
+      GenericConstBufferShadow shadow( 256 * sizeof( Point4F ) );
+
+      // Materials share a handful of real states, but like descs built on
+      // the stack they end up as different blocks because of the padding.
+      Vector<GFXStateBlockRef> blocks;
+      Vector<GenericConstBuffer*> buffers;
+      for ( U32 i=0; i < NumMaterials; i++ )
+      {
+         GFXStateBlockDesc desc;
+         _initDesc( desc, i );
+         desc.setBlend( i % 4 == 0 );
+         desc.setCullMode( i % 8 == 0 ? GFXCullNone : GFXCullCCW );
+         blocks.push_back( GFX->createStateBlock( desc ) );
+
+         buffers.push_back( new GenericConstBuffer( &layout ) );
+      }
+
+      const Point4F eyePosWorld( 10.0f, 20.0f, 5.0f, 1.0f );
+      MatrixF mat( true );
+
+      GFXDeviceStatistics stats;
+      stats.start( GFX->getDeviceStatistics() );
+
+      U32 constsUploaded = 0;
+      U32 constsRedundant = 0;
+      GenericConstBuffer *lastBuffer = NULL;
+
+      const U64 start = Platform::getPerformanceCounter();
+
+      // Draws come in runs of the same material, like a sorted render bin.
+      for ( U32 i=0; i < NumDraws; i++ )
+      {
+         const U32 m = ( i / 8 ) % NumMaterials;
+         GFX->setStateBlock( blocks[m] );
+
+         GenericConstBuffer *buffer = buffers[m];
+         mat.setPosition( Point3F( F32( i % 8 ), 0.0f, 0.0f ) );
+         buffer->set( modelView, mat, GFXSCT_Float4x4 );
+         buffer->set( eyePos, eyePosWorld );
+         buffer->set( diffuse, Point4F( F32( m % 2 ), 1.0f, 1.0f, 1.0f ) );
+
+         constsUploaded += _uploadConsts( *buffer, shadow, buffer != lastBuffer );
+         constsRedundant += buffer->popRedundantCount();
+         lastBuffer = buffer;
+
+         GFX->drawPrimitive( GFXTriangleList, 0, 2 );
+      }
+
+      const F64 ms = F64( Platform::getPerformanceCounter() - start ) * 1000.0 / F64( Platform::getPerformanceCounterFrequency() );
+
+      stats.end( GFX->getDeviceStatistics() );
+
+      test( stats.mDrawCalls == NumDraws, "Lost some draws!" );
+      test( stats.mStateBlockChanges + stats.mRedundantStateBlocks >= NumDraws / 8, "State block switches were not counted!" );
+      test( stats.mRedundantStateBlocks > stats.mStateBlockChanges, "Identical blocks were not filtered!" );
+      test( constsRedundant > constsUploaded, "Unchanged constants were not filtered!" );
+
+      Con::printf( "StateFilterReplay: %d draws in %.3fms - state blocks %d sent, %d redundant - constants %d sent, %d redundant",
+         NumDraws, ms, stats.mStateBlockChanges, stats.mRedundantStateBlocks, constsUploaded, constsRedundant );
+
+      for ( U32 i=0; i < buffers.size(); i++ )
+         delete buffers[i];
+   }
+};
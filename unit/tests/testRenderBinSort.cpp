@@ -0,0 +1,231 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "renderInstance/renderBinManager.h"
+#include "math/mRandom.h"
+#include "console/console.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+/// Exposes the element list so the tests can fill and inspect it.
+class RenderBinSortTestBin : public RenderBinManager
+{
+public:
+
+   RenderBinSortTestBin()
+      : RenderBinManager( RenderPassManager::RIT_Mesh, 1.0f, 1.0f )
+   {
+   }
+
+   void fill( Vector<MeshRenderInst> &insts )
+   {
+      mElementList.clear();
+      for ( U32 i=0; i < insts.size(); i++ )
+         internalAddElement( &insts[i] );
+   }
+
+   Vector<MainSortElem>& getElements() { return mElementList; }
+
+   /// Sorts the elements like sort() does, but with a stable comparison
+   /// sort on the same keys.
+   void referenceSort()
+   {
+      for ( U32 i=0; i < mElementList.size(); i++ )
+         mElementList[i].sortKey = getSortKey( mElementList[i] );
+
+      dQsort( mElementList.address(), mElementList.size(), sizeof( MainSortElem ), _cmpSortKeyStable );
+   }
+
+protected:
+
+   /// Instances are added in array order, so their addresses
+   /// break ties in the order they were added.
+   static S32 FN_CDECL _cmpSortKeyStable( const void *p1, const void *p2 )
+   {
+      const MainSortElem *a = (const MainSortElem*)p1;
+      const MainSortElem *b = (const MainSortElem*)p2;
+
+      if ( a->sortKey != b->sortKey )
+         return a->sortKey < b->sortKey ? -1 : 1;
+
+      return a->inst < b->inst ? -1 : ( a->inst > b->inst ? 1 : 0 );
+   }
+};
+
+/// The legacy qsort comparison with ties broken in the order
+/// the instances were added.
+static S32 FN_CDECL _cmpKeyStable( const void *p1, const void *p2 )
+{
+   const S32 cmp = RenderBinManager::cmpKeyFunc( p1, p2 );
+   if ( cmp )
+      return cmp;
+
+   const RenderBinManager::MainSortElem *a = (const RenderBinManager::MainSortElem*)p1;
+   const RenderBinManager::MainSortElem *b = (const RenderBinManager::MainSortElem*)p2;
+   return a->inst < b->inst ? -1 : ( a->inst > b->inst ? 1 : 0 );
+}
+
+/// Returns true if both lists hold the same instances in the same order.
+static bool _sameOrder( const Vector<RenderBinManager::MainSortElem> &a, const Vector<RenderBinManager::MainSortElem> &b )
+{
+   if ( a.size() != b.size() )
+      return false;
+
+   for ( U32 i=0; i < a.size(); i++ )
+   {
+      if ( a[i].inst != b[i].inst )
+         return false;
+   }
+
+   return true;
+}
+
+/// Generates a bin worth of instances drawn from a limited set of 
+/// materials and meshes like a typical scene.
+static void _fillInstances( Vector<MeshRenderInst> &insts, U32 count, MRandomLCG &rand )
+{
+   insts.setSize( count );
+   for ( U32 i=0; i < count; i++ )
+   {
+      MeshRenderInst &ri = insts[i];
+      ri.clear();
+      ri.type = RenderPassManager::RIT_Mesh;
+      ri.defaultKey = 0x10000 + rand.randI( 0, 255 ) * 64;
+      ri.defaultKey2 = 0x20000 + rand.randI( 0, 1023 ) * 32;
+      ri.sortDistSq = rand.randF() * 10000.0f;
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestRenderBinSort, "RenderInstance/BinSort" )
+{
+   void run()
+   {
+      MRandomLCG rand( 1234 );
+      Vector<MeshRenderInst> insts;
+      _fillInstances( insts, 5000, rand );
+
+      RenderBinSortTestBin bin;
+
+      // The legacy order should match the qsort.
+      bin.setSortOrder( RenderBinManager::SortKeys );
+
+      Vector<RenderBinManager::MainSortElem> expected;
+      bin.fill( insts );
+      expected = bin.getElements();
+      dQsort( expected.address(), expected.size(), sizeof( RenderBinManager::MainSortElem ), RenderBinManager::cmpKeyFunc );
+
+      bin.fill( insts );
+      bin.sort();
+      Vector<RenderBinManager::MainSortElem> &elems = bin.getElements();
+      bool matches = elems.size() == expected.size();
+      for ( U32 i=0; matches && i < elems.size(); i++ )
+         matches = elems[i].key == expected[i].key && elems[i].key2 == expected[i].key2;
+      test( matches, "Radix sort of the keys doesn't match the qsort order!" );
+
+      // The packed orders should come out sorted and keep the
+      // instances of each material together.
+      const RenderBinManager::SortOrder orders[] = { RenderBinManager::SortMaterialMajor, RenderBinManager::SortFrontToBack };
+      for ( U32 o=0; o < 2; o++ )
+      {
+         bin.setSortOrder( orders[o] );
+         bin.fill( insts );
+         bin.sort();
+
+         bool sorted = true;
+         for ( U32 i=1; i < elems.size(); i++ )
+            sorted &= elems[i-1].sortKey <= elems[i].sortKey;
+         test( sorted, "The bin isn't sorted on the packed keys!" );
+         test( elems.size() == insts.size(), "The sort lost elements!" );
+      }
+
+      // Front to back must order by distance.
+      bool frontToBack = true;
+      for ( U32 i=1; i < elems.size(); i++ )
+         frontToBack &= ( elems[i-1].inst->sortDistSq <= elems[i].inst->sortDistSq * 1.01f );
+      test( frontToBack, "Front to back order is wrong!" );
+
+      // A sorted bin should be detected and left alone.
+      bin.setSortOrder( RenderBinManager::SortMaterialMajor );
+      bin.sort();
+      test( elems.size() == insts.size(), "Resorting lost elements!" );
+
+      // With only a handful of distinct keys most instances tie.  The
+      // radix sort has to keep tied instances in the order they were
+      // added, and so match a stable comparison sort exactly.
+      for ( U32 i=0; i < insts.size(); i++ )
+      {
+         insts[i].defaultKey = 0x10000 + ( ( i * 7 ) % 5 ) * 64;
+         insts[i].defaultKey2 = 0x20000 + ( ( i * 13 ) % 3 ) * 32;
+         insts[i].sortDistSq = F32( i % 4 );
+      }
+
+      bin.setSortOrder( RenderBinManager::SortKeys );
+      bin.fill( insts );
+      expected = bin.getElements();
+      dQsort( expected.address(), expected.size(), sizeof( RenderBinManager::MainSortElem ), _cmpKeyStable );
+      bin.sort();
+      test( _sameOrder( elems, expected ), "Radix sort of tied keys doesn't match the stable qsort!" );
+
+      const RenderBinManager::SortOrder allOrders[] = {  RenderBinManager::SortKeys, 
+                                                         RenderBinManager::SortMaterialMajor, 
+                                                         RenderBinManager::SortFrontToBack };
+      for ( U32 o=0; o < 3; o++ )
+      {
+         bin.setSortOrder( allOrders[o] );
+         bin.fill( insts );
+         bin.referenceSort();
+         expected = bin.getElements();
+
+         bin.fill( insts );
+         bin.sort();
+         test( _sameOrder( elems, expected ), "Radix sort isn't stable for equal keys!" );
+      }
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestRenderBinSortPerformance, "RenderInstance/BinSortPerformance" )
+{
+   void run()
+   {
+      const U32 counts[] = { 10000, 25000, 50000, 100000 };
+      const F64 toMs = 1000.0 / F64( Platform::getPerformanceCounterFrequency() );
+
+      MRandomLCG rand( 5678 );
+      Vector<MeshRenderInst> insts;
+      RenderBinSortTestBin bin;
+      bin.setSortOrder( RenderBinManager::SortMaterialMajor );
+
+      for ( U32 i=0; i < sizeof( counts ) / sizeof( counts[0] ); i++ )
+      {
+         _fillInstances( insts, counts[i], rand );
+
+         bin.fill( insts );
+         U64 start = Platform::getPerformanceCounter();
+         dQsort( bin.getElements().address(), bin.getElements().size(), sizeof( RenderBinManager::MainSortElem ), RenderBinManager::cmpKeyFunc );
+         const F64 qsortMs = F64( Platform::getPerformanceCounter() - start ) * toMs;
+
+         bin.fill( insts );
+         start = Platform::getPerformanceCounter();
+         bin.sort();
+         const F64 radixMs = F64( Platform::getPerformanceCounter() - start ) * toMs;
+
+         // Sorting an already sorted bin only generates the keys.
+         start = Platform::getPerformanceCounter();
+         bin.sort();
+         const F64 resortMs = F64( Platform::getPerformanceCounter() - start ) * toMs;
+
+         Con::printf( "RenderBinSort: %d instances - qsort %.3fms, radix %.3fms, presorted %.3fms",
+            counts[i], qsortMs, radixMs, resortMs );
+      }
+   }
+};
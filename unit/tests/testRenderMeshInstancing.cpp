@@ -0,0 +1,220 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "renderInstance/renderMeshMgr.h"
+#include "materials/baseMatInstance.h"
+#include "materials/materialFeatureTypes.h"
+#include "gfx/gfxDevice.h"
+#include "gfx/gfxVertexBuffer.h"
+#include "gfx/gfxPrimitiveBuffer.h"
+#include "console/console.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+/// A single pass material which keeps MFT_UseInstancing if it is requested
+/// and supported, like a shader material whose shader does the instancing.
+class InstancingTestMatInstance : public BaseMatInstance
+{
+public:
+
+   BaseMaterialDefinition *mMaterial;
+   bool mSupportsInstancing;
+   FeatureSet mFeatures;
+   GFXVertexFormat mVertexFormat;
+   U32 mCurPass;
+
+   InstancingTestMatInstance( BaseMaterialDefinition *material, bool supportsInstancing )
+      :  mMaterial( material ),
+         mSupportsInstancing( supportsInstancing ),
+         mCurPass( 0 )
+   {
+      mIsValid = false;
+   }
+
+   virtual bool init( const FeatureSet &features, const GFXVertexFormat *vertexFormat )
+   {
+      mFeatures = features;
+      if ( !mSupportsInstancing )
+         mFeatures.removeFeature( MFT_UseInstancing );
+
+      mVertexFormat = *vertexFormat;
+      mIsValid = true;
+      return true;
+   }
+
+   virtual bool setupPass( SceneState*, const SceneGraphData& )
+   {
+      if ( mCurPass > 0 )
+      {
+         mCurPass = 0;
+         return false;
+      }
+
+      mCurPass++;
+      return true;
+   }
+
+   virtual bool reInit() { return mIsValid; }
+   virtual void addStateBlockDesc( const GFXStateBlockDesc& ) {}
+   virtual void addShaderMacro( const String&, const String& ) {}
+   virtual MaterialParameters* allocMaterialParameters() { return NULL; }
+   virtual void setMaterialParameters( MaterialParameters* ) {}
+   virtual MaterialParameters* getMaterialParameters() { return NULL; }
+   virtual MaterialParameterHandle* getMaterialParameterHandle( const String& ) { return NULL; }
+   virtual void setTransforms( const MatrixSet&, SceneState* ) {}
+   virtual void setSceneInfo( SceneState*, const SceneGraphData& ) {}
+   virtual void setTextureStages( SceneState*, const SceneGraphData& ) {}
+   virtual void setBuffers( GFXVertexBufferHandleBase *vertBuffer, GFXPrimitiveBufferHandle *primBuffer )
+   {
+      GFX->setVertexBuffer( *vertBuffer );
+      GFX->setPrimitiveBuffer( *primBuffer );
+   }
+   virtual BaseMaterialDefinition* getMaterial() { return mMaterial; }
+   virtual bool hasGlow() { return false; }
+   virtual U32 getCurPass() { return mCurPass; }
+   virtual U32 getCurStageNum() { return 0; }
+   virtual RenderPassData* getPass( U32 ) { return NULL; }
+   virtual const FeatureSet& getFeatures() const { return mFeatures; }
+   virtual const FeatureSet& getRequestedFeatures() const { return mFeatures; }
+   virtual const GFXVertexFormat* getVertexFormat() const { return &mVertexFormat; }
+   virtual void dumpShaderInfo() const {}
+   virtual void requestTextureDetail( F32 ) {}
+};
+
+class InstancingTestMaterial : public BaseMaterialDefinition
+{
+public:
+
+   bool mSupportsInstancing;
+
+   InstancingTestMaterial( bool supportsInstancing ) : mSupportsInstancing( supportsInstancing ) {}
+
+   virtual BaseMatInstance* createMatInstance() { return new InstancingTestMatInstance( this, mSupportsInstancing ); }
+   virtual bool isIFL() const { return false; }
+   virtual bool isTranslucent() const { return false; }
+   virtual bool isDoubleSided() const { return false; }
+   virtual bool isLightmapped() const { return false; }
+   virtual bool castsShadows() const { return false; }
+};
+
+/// Lets the test switch instancing on and off.
+class InstancingTestMeshMgr : public RenderMeshMgr
+{
+public:
+
+   void setInstancing( bool enable ) { mEnableInstancing = enable; }
+};
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestRenderMeshInstancing, "RenderInstance/MeshInstancing" )
+{
+   enum
+   {
+      NumInstances = 32,
+   };
+
+   GFXVertexBufferHandle<GFXVertexPNT> mVB;
+   GFXPrimitiveBufferHandle mPB;
+   GFXPrimitive mPrim;
+
+   /// Renders NumInstances copies of a triangle and returns the draw calls.
+   S32 renderInstances( RenderPassManager *pass, InstancingTestMeshMgr *mgr, BaseMatInstance *matInst )
+   {
+      const MatrixF *view = pass->allocSharedXform( RenderPassManager::View );
+      const MatrixF *proj = pass->allocSharedXform( RenderPassManager::Projection );
+
+      for ( U32 i=0; i < NumInstances; i++ )
+      {
+         MatrixF xfm( true );
+         xfm.setPosition( Point3F( F32( i ), 0.0f, 0.0f ) );
+
+         MeshRenderInst *ri = pass->allocInst<MeshRenderInst>();
+         ri->type = RenderPassManager::RIT_Mesh;
+         ri->matInst = matInst;
+         ri->vertBuff = &mVB;
+         ri->primBuff = &mPB;
+         ri->prim = &mPrim;
+         ri->objectToWorld = pass->allocUniqueXform( xfm );
+         ri->worldToCamera = view;
+         ri->projection = proj;
+         ri->defaultKey = 1;
+         ri->defaultKey2 = 0;
+         mgr->addElement( ri );
+      }
+
+      GFXDeviceStatistics stats;
+      stats.start( GFX->getDeviceStatistics() );
+
+      mgr->sort();
+      mgr->render( NULL );
+      mgr->clear();
+
+      stats.end( GFX->getDeviceStatistics() );
+      return stats.mDrawCalls;
+   }
+
+   void run()
+   {
+      // The null device supports instancing and counts draw calls
+      // without needing a GPU.
+      if ( !GFXDevice::devicePresent() || GFX->getAdapterType() != NullDevice )
+      {
+         Con::printf( "MeshInstancing: skipped, requires the null device." );
+         return;
+      }
+
+      RenderPassManager *pass = new RenderPassManager;
+      if ( !pass->getSceneManager() )
+      {
+         Con::printf( "MeshInstancing: skipped, requires the client scene graph." );
+         delete pass;
+         return;
+      }
+      pass->registerObject();
+
+      mVB.set( GFX, 3, GFXBufferTypeStatic );
+      mPB.set( GFX, 3, 1, GFXBufferTypeStatic );
+      mPrim.type = GFXTriangleList;
+      mPrim.numPrimitives = 1;
+      mPrim.numVertices = 3;
+
+      InstancingTestMeshMgr *mgr = new InstancingTestMeshMgr;
+      pass->addManager( mgr );
+
+      InstancingTestMaterial instancedMat( true );
+      InstancingTestMaterial plainMat( false );
+
+      BaseMatInstance *instancedInst = instancedMat.createMatInstance();
+      instancedInst->init( FeatureSet(), getGFXVertexFormat<GFXVertexPNT>() );
+      BaseMatInstance *plainInst = plainMat.createMatInstance();
+      plainInst->init( FeatureSet(), getGFXVertexFormat<GFXVertexPNT>() );
+
+      mgr->setInstancing( false );
+      const S32 unbatched = renderInstances( pass, mgr, instancedInst );
+      test( unbatched == NumInstances, "Each instance should take a draw call!" );
+
+      mgr->setInstancing( true );
+      const S32 batched = renderInstances( pass, mgr, instancedInst );
+      test( batched == 1, "The run should take a single instanced draw call!" );
+
+      // A material whose shader can't do the instancing isn't batched.
+      const S32 plain = renderInstances( pass, mgr, plainInst );
+      test( plain == NumInstances, "Batched a material without MFT_UseInstancing!" );
+
+      Con::printf( "MeshInstancing: %d draw calls unbatched, %d instanced", unbatched, batched );
+
+      // Deletes the hooks and their instancing materials.
+      delete instancedInst;
+      delete plainInst;
+
+      pass->clear();
+      pass->deleteObject();
+   }
+};
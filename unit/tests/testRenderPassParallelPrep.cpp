@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "renderInstance/renderBinManager.h"
+#include "platform/threads/threadPool.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+/// Exposes the element list so the test can inspect it.
+class ParallelPrepTestBin : public RenderBinManager
+{
+public:
+
+   ParallelPrepTestBin()
+      : RenderBinManager( RenderPassManager::RIT_Mesh, 1.0f, 1.0f )
+   {
+   }
+
+   Vector<MainSortElem>& getElements() { return mElementList; }
+};
+
+/// Submits a slot worth of instances from a pool thread.
+struct ParallelPrepTestItem : public ThreadPool::WorkItem
+{
+   typedef ThreadPool::WorkItem Parent;
+
+   RenderPassManager *mPass;
+   U32 mSlot;
+   U32 mCount;
+   Semaphore *mDone;
+
+   ParallelPrepTestItem( RenderPassManager *pass, U32 slot, U32 count, Semaphore *done )
+      : mPass( pass ), mSlot( slot ), mCount( count ), mDone( done ) {}
+
+protected:
+   virtual void execute()
+   {
+      mPass->bindPrepSlot( mSlot );
+
+      for ( U32 i=0; i < mCount; i++ )
+      {
+         MeshRenderInst *ri = mPass->allocInst<MeshRenderInst>();
+         ri->type = RenderPassManager::RIT_Mesh;
+         ri->defaultKey = mSlot;
+         ri->defaultKey2 = i;
+         mPass->addInst( ri );
+      }
+
+      mPass->unbindPrepSlot( mSlot );
+      mDone->release();
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestRenderPassParallelPrep, "RenderInstance/ParallelPrep" )
+{
+   void run()
+   {
+      const U32 numSlots = 8;
+      const U32 numPerSlot = 500;
+
+      RenderPassManager *pass = new RenderPassManager;
+      pass->registerObject();
+
+      ParallelPrepTestBin *bin = new ParallelPrepTestBin;
+      pass->addManager( bin );
+
+      Semaphore done( 0 );
+      pass->beginParallelPrep( numSlots );
+
+      // Queue the slots in reverse so that they finish out of order.
+      for ( S32 i = numSlots - 1; i >= 0; i-- )
+         ThreadPool::GLOBAL().queueWorkItem( new ParallelPrepTestItem( pass, i, numPerSlot, &done ) );
+
+      for ( U32 i=0; i < numSlots; i++ )
+         done.acquire();
+
+      test( bin->getElements().empty(), "Slot instances should wait for endParallelPrep()!" );
+
+      // The main thread isn't bound to a slot so it adds directly.
+      MeshRenderInst *mainRI = pass->allocInst<MeshRenderInst>();
+      mainRI->type = RenderPassManager::RIT_Mesh;
+      mainRI->defaultKey = numSlots;
+      pass->addInst( mainRI );
+      test( bin->getElements().size() == 1, "Unbound threads should add directly!" );
+
+      pass->endParallelPrep();
+
+      Vector<RenderBinManager::MainSortElem> &elems = bin->getElements();
+      test( elems.size() == numSlots * numPerSlot + 1, "Lost instances in the merge!" );
+
+      // Slots are merged in slot order whatever the thread timing was.
+      bool ordered = true;
+      for ( U32 i=1; ordered && i < elems.size(); i++ )
+      {
+         const U32 slot = ( i - 1 ) / numPerSlot;
+         const U32 index = ( i - 1 ) % numPerSlot;
+         ordered = elems[i].key == slot && elems[i].key2 == index;
+      }
+      test( ordered, "Slot instances were not merged in slot order!" );
+
+      pass->clear();
+      pass->deleteObject();
+   }
+};
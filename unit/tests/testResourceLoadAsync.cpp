@@ -0,0 +1,155 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "core/resourceManager.h"
+#include "core/stream/fileStream.h"
+#include "core/util/fourcc.h"
+#include "core/volume.h"
+#include "console/console.h"
+#include "platform/threads/thread.h"
+#include "platform/threads/threadPool.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+/// A resource which remembers where it was created.
+struct AsyncTestResource
+{
+   U32 size;
+   bool createdOnMainThread;
+   bool finishedOnMainThread;
+};
+
+template<> void *Resource<AsyncTestResource>::create( const Torque::Path &path )
+{
+   FileStream stream;
+   if ( !stream.open( path.getFullPath(), Torque::FS::File::Read ) )
+      return NULL;
+
+   AsyncTestResource *res = new AsyncTestResource;
+   res->size = stream.getStreamSize();
+   res->createdOnMainThread = ThreadManager::isMainThread();
+   res->finishedOnMainThread = false;
+   return res;
+}
+
+template<> ResourceBase::Signature Resource<AsyncTestResource>::signature()
+{
+   return MakeFourCC( 't', 'a', 's', 'y' );
+}
+
+static bool _finishAsyncTestResource( const Torque::Path &path, AsyncTestResource *res )
+{
+   res->finishedOnMainThread = ThreadManager::isMainThread();
+   return true;
+}
+
+static ResourceRegisterAsyncCreate<AsyncTestResource> sgAsyncTestResources( &_finishAsyncTestResource );
+
+static void _writeAsyncTestFile( const Torque::Path &path, U32 size )
+{
+   FileStream stream;
+   if ( stream.open( path, Torque::FS::File::Write ) )
+   {
+      for ( U32 i=0; i < size; i++ )
+         stream.write( (U8)i );
+   }
+}
+
+static U32 sgAsyncTestDoneCount = 0;
+
+static void _onAsyncTestDone( ResourceLoadRequest *request )
+{
+   if ( request->isDone() && ThreadManager::isMainThread() )
+      sgAsyncTestDoneCount++;
+}
+
+CreateUnitTest( TestResourceLoadAsync, "Core/ResourceLoadAsync" )
+{
+   void waitFor( ResourceLoadRequest *request )
+   {
+      while ( !request->isDone() )
+      {
+         ThreadPool::processMainThreadWorkItems();
+         ResourceManager::get().processAsyncLoads();
+         Platform::sleep( 1 );
+      }
+   }
+
+   void run()
+   {
+      const Torque::Path placeholderPath( "testAsyncLoad/placeholder.bin" );
+      const Torque::Path firstPath( "testAsyncLoad/first.bin" );
+      const Torque::Path secondPath( "testAsyncLoad/second.bin" );
+      const Torque::Path missingPath( "testAsyncLoad/missing.bin" );
+      _writeAsyncTestFile( placeholderPath, 16 );
+      _writeAsyncTestFile( firstPath, 1000 );
+      _writeAsyncTestFile( secondPath, 2000 );
+
+      ResourceManager &resMgr = ResourceManager::get();
+
+      Resource<AsyncTestResource> placeholder = resMgr.load( placeholderPath );
+      test( placeholder != NULL && placeholder->size == 16, "Failed to load the placeholder!" );
+
+      ResourceLoadRequestRef first = resMgr.loadAsync<AsyncTestResource>( firstPath, 1.0f, placeholder );
+      test( first->isDone() || first->getResource().getPath() == placeholderPath, "The placeholder should stand in while loading!" );
+      test( resMgr.loadAsync<AsyncTestResource>( firstPath ) == first, "A pending load should be shared!" );
+
+      ResourceLoadRequestRef second = resMgr.loadAsync<AsyncTestResource>( secondPath );
+      second->setPriorityFromDistance( 100.0f );
+
+      sgAsyncTestDoneCount = 0;
+      const bool firstPending = !first->isDone();
+      if ( firstPending )
+         first->getDoneSignal().notify( &_onAsyncTestDone );
+
+      waitFor( first );
+      waitFor( second );
+      test( !firstPending || sgAsyncTestDoneCount == 1, "The done signal should be triggered once on the main thread!" );
+
+      test( first->getState() == ResourceLoadRequest::Loaded, "The first load failed!" );
+      test( second->getState() == ResourceLoadRequest::Loaded, "The second load failed!" );
+
+      Resource<AsyncTestResource> res = first->getResource();
+      test( res != NULL && res->size == 1000, "Loaded the wrong resource!" );
+      if ( res != NULL && !ThreadPool::getForceAllMainThread() )
+         test( !res->createdOnMainThread, "The resource should be created on a worker!" );
+      test( res != NULL && res->finishedOnMainThread, "The resource should be finished on the main thread!" );
+
+      // The request and a synchronous load share the resource.
+      Resource<AsyncTestResource> sync = resMgr.load( secondPath );
+      test( sync != NULL && sync->size == 2000, "The synchronous load didn't find the resource!" );
+      test( (AsyncTestResource*)sync == (AsyncTestResource*)Resource<AsyncTestResource>( second->getResource() ), "The resource was loaded twice!" );
+
+      // Loaded resources are done right away.
+      ResourceLoadRequestRef loaded = resMgr.loadAsync<AsyncTestResource>( placeholderPath );
+      test( loaded->getState() == ResourceLoadRequest::Loaded, "A loaded resource should be done right away!" );
+
+      // Waiting on a load finishes it, even when it fails.
+      ResourceLoadRequestRef missing = resMgr.loadAsync<AsyncTestResource>( missingPath );
+      sgAsyncTestDoneCount = 0;
+      missing->getDoneSignal().notify( &_onAsyncTestDone );
+      resMgr.finishAsyncLoad( missing );
+      test( missing->getState() == ResourceLoadRequest::Failed, "Loading a missing file should fail!" );
+      test( sgAsyncTestDoneCount == 1, "A failed load should trigger the done signal!" );
+      test( resMgr.getNumAsyncLoads() == 0, "Some loads are still pending!" );
+
+      first = NULL;
+      second = NULL;
+      loaded = NULL;
+      missing = NULL;
+      res = NULL;
+      sync = NULL;
+      placeholder = NULL;
+
+      Torque::FS::Remove( placeholderPath );
+      Torque::FS::Remove( firstPath );
+      Torque::FS::Remove( secondPath );
+      Torque::FS::Remove( "testAsyncLoad" );
+   }
+};
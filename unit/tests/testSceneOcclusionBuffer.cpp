@@ -0,0 +1,93 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "sceneGraph/sceneOcclusionBuffer.h"
+#include "math/util/frustum.h"
+
+using namespace UnitTesting;
+
+namespace
+{
+   /// Adds a two triangle quad to the mesh.
+   void _addQuad( OccluderMesh &mesh, const Point3F &a, const Point3F &b, const Point3F &c, const Point3F &d )
+   {
+      const U32 start = mesh.verts.size();
+      mesh.verts.push_back( a );
+      mesh.verts.push_back( b );
+      mesh.verts.push_back( c );
+      mesh.verts.push_back( d );
+
+      const U32 indices[] = { 0, 1, 2, 0, 2, 3 };
+      for ( U32 i=0; i < 6; i++ )
+         mesh.indices.push_back( start + indices[i] );
+   }
+}
+
+CreateUnitTest( TestSceneOcclusionBuffer, "SceneGraph/OcclusionBuffer" )
+{
+   void run()
+   {
+      // The camera sits at the origin looking down +Y.
+      Frustum frustum;
+      frustum.set( false, M_PI_F * 0.5f, 2.0f, 0.1f, 1000.0f );
+
+      SceneOcclusionBuffer buffer;
+      test( buffer.begin( frustum ), "Perspective frustums should be supported!" );
+
+      // A wall 10 units ahead which covers the middle of the view.
+      OccluderMesh wall;
+      _addQuad( wall,   Point3F( -5.0f, 10.0f, -5.0f ), Point3F( 5.0f, 10.0f, -5.0f ),
+                        Point3F( 5.0f, 10.0f, 5.0f ), Point3F( -5.0f, 10.0f, 5.0f ) );
+      buffer.addOccluder( wall );
+      buffer.rasterize();
+
+      test( buffer.getDepth( SceneOcclusionBuffer::Width / 2, SceneOcclusionBuffer::Height / 2 ) < 1.0f, "The wall wasn't rasterized!" );
+      test( buffer.getDepth( 0, 0 ) == 1.0f, "The corner of the view should be empty!" );
+
+      test( buffer.isOccluded( Box3F( Point3F( -1.0f, 20.0f, -1.0f ), Point3F( 1.0f, 22.0f, 1.0f ) ) ), "Box behind the wall should be occluded!" );
+      test( !buffer.isOccluded( Box3F( Point3F( -1.0f, 5.0f, -1.0f ), Point3F( 1.0f, 6.0f, 1.0f ) ) ), "Box in front of the wall is visible!" );
+      test( !buffer.isOccluded( Box3F( Point3F( 3.0f, 20.0f, -1.0f ), Point3F( 12.0f, 22.0f, 1.0f ) ) ), "Box sticking out from behind the wall is visible!" );
+      test( !buffer.isOccluded( Box3F( Point3F( 20.0f, 40.0f, -1.0f ), Point3F( 22.0f, 42.0f, 1.0f ) ) ), "Box off to the side is visible!" );
+      test( !buffer.isOccluded( Box3F( Point3F( -1.0f, -1.0f, -1.0f ), Point3F( 1.0f, 22.0f, 1.0f ) ) ), "Box around the camera is visible!" );
+
+      // The same wall wound the other way faces away from the
+      // camera, so it is culled and hides nothing.
+      test( buffer.begin( frustum ), "Failed to restart the buffer!" );
+      OccluderMesh flipped;
+      _addQuad( flipped,   Point3F( -5.0f, 10.0f, 5.0f ), Point3F( 5.0f, 10.0f, 5.0f ),
+                           Point3F( 5.0f, 10.0f, -5.0f ), Point3F( -5.0f, 10.0f, -5.0f ) );
+      buffer.addOccluder( flipped );
+      buffer.rasterize();
+      test( buffer.getDepth( SceneOcclusionBuffer::Width / 2, SceneOcclusionBuffer::Height / 2 ) == 1.0f, "The back face was rasterized!" );
+      test( !buffer.isOccluded( Box3F( Point3F( -1.0f, 20.0f, -1.0f ), Point3F( 1.0f, 22.0f, 1.0f ) ) ), "Back facing occluders should be culled!" );
+
+      // A floor which starts behind the camera has to be clipped
+      // against the near plane.
+      test( buffer.begin( frustum ), "Failed to restart the buffer!" );
+      OccluderMesh floor;
+      _addQuad( floor,  Point3F( -50.0f, -5.0f, -1.0f ), Point3F( 50.0f, -5.0f, -1.0f ),
+                        Point3F( 50.0f, 50.0f, -1.0f ), Point3F( -50.0f, 50.0f, -1.0f ) );
+      buffer.addOccluder( floor );
+      buffer.rasterize();
+      test( buffer.isOccluded( Box3F( Point3F( -1.0f, 20.0f, -4.0f ), Point3F( 1.0f, 22.0f, -3.0f ) ) ), "Box under the floor should be occluded!" );
+      test( !buffer.isOccluded( Box3F( Point3F( -1.0f, 20.0f, 0.0f ), Point3F( 1.0f, 22.0f, 1.0f ) ) ), "Box on top of the floor is visible!" );
+
+      // Nothing is added past the triangle budget.
+      const S32 maxTriangles = SceneOcclusionBuffer::smMaxTriangles;
+      SceneOcclusionBuffer::smMaxTriangles = 2;
+      test( buffer.begin( frustum ), "Failed to restart the buffer!" );
+      test( !buffer.addOccluder( wall ), "The budget should be used up by the wall!" );
+      test( !buffer.addOccluder( floor ), "Occluders past the budget should be rejected!" );
+      test( SceneOcclusionBuffer::smNumTriangles == 2, "Wrong triangle count!" );
+      SceneOcclusionBuffer::smMaxTriangles = maxTriangles;
+
+      // Orthographic views can't be tested.
+      Frustum ortho;
+      ortho.set( true, -10.0f, 10.0f, 10.0f, -10.0f, 0.1f, 100.0f );
+      test( !buffer.begin( ortho ), "Orthographic frustums aren't supported!" );
+   }
+};
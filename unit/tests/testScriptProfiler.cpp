@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "console/console.h"
+#include "console/scriptProfiler.h"
+
+#if !defined( TORQUE_SHIPPING ) && defined( TORQUE_ENABLE_PROFILER )
+
+using namespace UnitTesting;
+
+#define TEST( x ) test( ( x ), "FAIL: " #x )
+
+CreateUnitTest( TestScriptProfiler, "Console/ScriptProfiler" )
+{
+   const ScriptProfiler::CallNode* findChild( const ScriptProfiler::CallNode *parent, const char *fnName )
+   {
+      StringTableEntry name = StringTable->insert( fnName );
+      for( const ScriptProfiler::CallNode *walk = parent->mFirstChild; walk; walk = walk->mNextSibling )
+         if( walk->mFunction == name )
+            return walk;
+      return NULL;
+   }
+
+   void run()
+   {
+      const bool wasEnabled = ScriptProfiler::isEnabled();
+      const S32 oldInterval = ScriptProfiler::smLineSampleInterval;
+
+      Con::evaluate(
+         "function _utSPLeaf( %a ) { return %a + 1; }"
+         "function _utSPOuter() { %x = 0; for( %i = 0; %i < 10; %i ++ ) %x = _utSPLeaf( %x ); return %x; }" );
+
+      ScriptProfiler::smLineSampleInterval = 4;
+      ScriptProfiler::enable( true );
+      ScriptProfiler::reset();
+
+      for( U32 i = 0; i < 3; i ++ )
+         Con::evaluate( "_utSPOuter();" );
+
+      ScriptProfiler::enable( false );
+
+      // Calls are recorded along their call path.
+      const ScriptProfiler::CallNode *root = ScriptProfiler::getRoot();
+      TEST( root != NULL );
+      const ScriptProfiler::CallNode *outer = root ? findChild( root, "_utSPOuter" ) : NULL;
+      TEST( outer != NULL );
+      if( outer )
+      {
+         TEST( outer->mCallCount == 3 );
+         TEST( outer->mTotalTime >= outer->mSubTime );
+
+         const ScriptProfiler::CallNode *leaf = findChild( outer, "_utSPLeaf" );
+         TEST( leaf != NULL );
+         TEST( leaf && leaf->mCallCount == 30 );
+         TEST( leaf && leaf->mParent == outer );
+         TEST( findChild( root, "_utSPLeaf" ) == NULL );
+      }
+
+      // The sample countdown carries over between calls, so even short
+      // functions get their lines sampled.
+      TEST( ScriptProfiler::getNumLineSamples() > 0 );
+      TEST( ScriptProfiler::smLineSampleCountdown > 0 );
+      TEST( ScriptProfiler::smLineSampleCountdown <= ScriptProfiler::smLineSampleInterval );
+
+      // Nothing is recorded while disabled.
+      Con::evaluate( "_utSPOuter();" );
+      TEST( outer && outer->mCallCount == 3 );
+
+      ScriptProfiler::reset();
+      ScriptProfiler::smLineSampleInterval = oldInterval;
+      ScriptProfiler::enable( wasEnabled );
+   }
+};
+
+#endif // !TORQUE_SHIPPING && TORQUE_ENABLE_PROFILER
@@ -0,0 +1,99 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "console/simBase.h"
+#include "unit/test.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+class WheelTestEvent : public SimEvent
+{
+public:
+   WheelTestEvent( U32 seq, SimTime t, SimObject *obj = NULL )
+   {
+      sequenceCount = seq;
+      time = t;
+      startTime = 0;
+      destObject = obj;
+   }
+
+   void process( SimObject *object ) {}
+};
+
+CreateUnitTest( TestSimEventWheel, "Console/SimEventWheel" )
+{
+   void run()
+   {
+      SimEventWheel wheel;
+      wheel.reset( 100 );
+
+      // Spread events over every level of the wheel, plus a pair due at
+      // the same time to check posting order.
+      const SimTime times[] = { 100, 350, 100000, 99, 70000, 350, 20000000, 101 };
+      const U32 count = sizeof( times ) / sizeof( times[0] );
+      for ( U32 i = 0; i < count; i++ )
+         wheel.insert( new WheelTestEvent( i + 1, times[i] ) );
+
+      test( wheel.size() == count, "Wrong number of pending events." );
+      test( wheel.find( 4 ) && wheel.find( 4 )->time == 100, "Past events should be due now." );
+
+      // Cancel one of the far events.
+      SimEvent *cancelled = wheel.find( 3 );
+      test( cancelled != NULL, "Failed to find an event by id." );
+      wheel.remove( cancelled );
+      delete cancelled;
+      test( wheel.find( 3 ) == NULL, "Cancelled event is still pending." );
+
+      const U32 expected[] = { 1, 4, 8, 2, 6, 5, 7 };
+      U32 popped = 0;
+      SimTime lastTime = 0;
+      bool inOrder = true;
+
+      SimEvent *event;
+      while ( ( event = wheel.popDue( 30000000 ) ) != NULL )
+      {
+         inOrder = inOrder && popped < sizeof( expected ) / sizeof( expected[0] ) &&
+                   event->sequenceCount == expected[popped] &&
+                   event->time >= lastTime && wheel.getCurrentTime() == event->time;
+         lastTime = event->time;
+         popped++;
+         delete event;
+      }
+
+      test( inOrder && popped == 7, "Events were not dispatched in time and posting order." );
+      test( wheel.getCurrentTime() == 30000000 && wheel.size() == 0, "Wheel did not advance to the target time." );
+
+      // Events not yet due must stay put.
+      wheel.insert( new WheelTestEvent( 20, 30000500 ) );
+      test( wheel.popDue( 30000499 ) == NULL && wheel.size() == 1, "Event fired early." );
+
+      // Batch insert, enough to grow the id table, then drop them by object.
+      SimObject *owner = reinterpret_cast<SimObject*>( &wheel );
+      Vector<SimEvent*> batch;
+      for ( U32 i = 0; i < 1000; i++ )
+         batch.push_back( new WheelTestEvent( 100 + i, 0, i & 1 ? owner : NULL ) );
+
+      wheel.insert( batch.address(), batch.size(), 30001000 );
+      test( wheel.size() == 1001, "Batch insert lost events." );
+      test( wheel.find( 599 ) && wheel.find( 599 )->time == 30001000, "Batch event has the wrong time." );
+
+      Vector<SimEvent*> removed;
+      wheel.removeObjectEvents( owner, removed );
+      test( removed.size() == 500 && wheel.size() == 501, "Failed to remove the object's events." );
+      for ( U32 i = 0; i < removed.size(); i++ )
+         delete removed[i];
+
+      bool allFound = true;
+      for ( U32 i = 0; i < 1000; i += 2 )
+         allFound = allFound && wheel.find( 100 + i ) != NULL && wheel.find( 101 + i ) == NULL;
+      test( allFound, "Id lookups broke after removal." );
+
+      wheel.reset( 0 );
+      test( wheel.size() == 0 && wheel.find( 100 ) == NULL, "Reset left events behind." );
+   }
+};
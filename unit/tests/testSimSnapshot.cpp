@@ -0,0 +1,107 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "console/simBase.h"
+#include "console/consoleTypes.h"
+#include "math/mPoint3.h"
+#include "math/mathTypes.h"
+#include "unit/test.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+class SnapshotTestObject : public SimObject
+{
+   typedef SimObject Parent;
+
+public:
+   F32 mScalar;
+   Point3F mPoint[2];
+   StringTableEntry mLabel;
+   StringTableEntry mCaseLabel;
+   S32 mPreparedCount;
+
+   SnapshotTestObject()
+      : mScalar( 0.0f ),
+        mLabel( StringTable->insert( "" ) ),
+        mCaseLabel( StringTable->insert( "" ) ),
+        mPreparedCount( 0 )
+   {
+      mPoint[0].zero();
+      mPoint[1].zero();
+   }
+
+   bool isPrepareAddThreadSafe() const { return true; }
+   void prepareAdd() { mPreparedCount++; }
+
+   DECLARE_CONOBJECT( SnapshotTestObject );
+
+   static void initPersistFields()
+   {
+      Parent::initPersistFields();
+
+      addField( "scalar", TypeF32, Offset( mScalar, SnapshotTestObject ) );
+      addField( "point", TypePoint3F, Offset( mPoint, SnapshotTestObject ), 2 );
+      addField( "label", TypeString, Offset( mLabel, SnapshotTestObject ) );
+      addField( "caseLabel", TypeCaseString, Offset( mCaseLabel, SnapshotTestObject ) );
+   }
+};
+
+IMPLEMENT_CONOBJECT( SnapshotTestObject );
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestSimSnapshot, "Console/SimSnapshot" )
+{
+   void run()
+   {
+      SimGroup *group = new SimGroup;
+      group->registerObject( "_utSnapshotGroup" );
+
+      SimGroup *child = new SimGroup;
+      child->registerObject();
+      group->addObject( child );
+
+      SnapshotTestObject *obj = new SnapshotTestObject;
+      obj->mScalar = 2.5f;
+      obj->mPoint[1].set( 1.0f, 2.0f, 3.0f );
+      obj->mLabel = StringTable->insert( "someLabel" );
+      obj->mCaseLabel = StringTable->insert( "CaseLabel", true );
+      obj->registerObject( "_utSnapshotObject" );
+      obj->setDataField( StringTable->insert( "dynamicField" ), NULL, "dynamicValue" );
+      child->addObject( obj );
+
+      test( Sim::saveSnapshot( group, "testSnapshot.snap" ), "Failed to save the snapshot." );
+      group->deleteObject();
+
+      SimGroup *parent = new SimGroup;
+      parent->registerObject();
+
+      SimObject *root = Sim::loadSnapshot( "testSnapshot.snap", parent );
+      test( root != NULL, "Failed to load the snapshot." );
+
+      SimGroup *loadedGroup = dynamic_cast<SimGroup*>( root );
+      test( loadedGroup != NULL && loadedGroup->getGroup() == parent, "Root should be a SimGroup added to the parent." );
+      test( loadedGroup && dStrcmp( loadedGroup->getName(), "_utSnapshotGroup" ) == 0, "Root lost its name." );
+
+      SnapshotTestObject *loaded = dynamic_cast<SnapshotTestObject*>( Sim::findObject( "_utSnapshotObject" ) );
+      test( loaded != NULL, "Nested object was not restored." );
+      if ( loaded )
+      {
+         test( loaded->getGroup() && loaded->getGroup()->getGroup() == loadedGroup, "Nested object has the wrong parent." );
+         test( loaded->mScalar == 2.5f, "F32 field was not restored." );
+         test( loaded->mPoint[0].isZero() && loaded->mPoint[1] == Point3F( 1.0f, 2.0f, 3.0f ), "Point3F array was not restored." );
+         test( loaded->mLabel == StringTable->insert( "someLabel" ), "String field should be a StringTableEntry." );
+         test( loaded->mCaseLabel == StringTable->insert( "CaseLabel", true ), "Case string field should be a case sensitive entry." );
+         test( dStrcmp( loaded->getDataField( StringTable->insert( "dynamicField" ), NULL ), "dynamicValue" ) == 0, "Dynamic field was not restored." );
+         test( loaded->mPreparedCount == 1, "prepareAdd() should run once before registration." );
+      }
+
+      parent->deleteObject();
+      dFileDelete( "testSnapshot.snap" );
+   }
+};
@@ -0,0 +1,159 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "core/stringTable.h"
+#include "core/strings/stringFunctions.h"
+#include "platform/threads/thread.h"
+#include "platform/platformIntrinsics.h"
+#include "console/console.h"
+
+#ifndef TORQUE_SHIPPING
+
+using namespace UnitTesting;
+
+#define TEST( x ) test( ( x ), "FAIL: " #x )
+#define XTEST( t, x ) t->test( ( x ), "FAIL: " #x )
+
+CreateUnitTest( TestStringTableSerial, "Core/StringTable/Serial" )
+{
+   void run()
+   {
+      // Hashes must ignore case and agree between the n and non-n variants.
+      TEST( _StringTable::hashString( "SomeMixedCaseString" ) == _StringTable::hashString( "somemixedcasestring" ) );
+      TEST( _StringTable::hashString( "abc" ) == _StringTable::hashStringn( "abcdef", 3 ) );
+      TEST( _StringTable::hashString( "ab" ) == _StringTable::hashStringn( "ab", 10 ) );
+      TEST( _StringTable::hashString( "[\\]^_`@" ) != _StringTable::hashString( "{|}~\x7f`@" ) );
+
+      StringTableEntry a = StringTable->insert( "testStringTableEntry" );
+      TEST( StringTable->insert( "TESTSTRINGTABLEENTRY" ) == a );
+      TEST( StringTable->lookup( "testStringTableEntry" ) == a );
+      TEST( StringTable->lookupn( "testStringTableEntryXYZ", 20 ) == a );
+      TEST( StringTable->insertn( "testStringTableEntryXYZ", 20 ) == a );
+
+      // Case-sensitive entries live alongside the case-insensitive one.
+      StringTableEntry b = StringTable->insert( "TestStringTableEntry", true );
+      TEST( b != a );
+      TEST( dStrcmp( b, "TestStringTableEntry" ) == 0 );
+      TEST( StringTable->insert( "TestStringTableEntry" ) == a );
+      TEST( StringTable->lookup( "TestStringTableEntry", true ) == b );
+
+      TEST( StringTable->lookup( "testStringTableEntryThatIsNotThere" ) == NULL );
+
+      // Rebuilding the shards must keep every entry and recycle the nodes of
+      // the old chains rather than allocating a fresh set each time.
+      _StringTable::Stats before;
+      StringTable->getStats( before );
+      StringTable->resize( before.numBuckets * 2 );
+      _StringTable::Stats grown;
+      StringTable->getStats( grown );
+      StringTable->resize( before.numBuckets * 2 );
+      _StringTable::Stats again;
+      StringTable->getStats( again );
+      TEST( again.numItems == before.numItems );
+      TEST( again.memUsage == grown.memUsage );
+      TEST( StringTable->lookup( "testStringTableEntry" ) == a );
+      TEST( StringTable->lookup( "TestStringTableEntry", true ) == b );
+   }
+};
+
+// Intern a shared set of strings from several threads at once and make sure
+// everybody gets the same pointers.  Also serves as a throughput benchmark.
+
+CreateUnitTest( TestStringTableConcurrent, "Core/StringTable/Concurrent" )
+{
+public:
+   typedef TestStringTableConcurrent TestType;
+
+   enum
+   {
+      DEFAULT_NUM_STRINGS = 50000,
+      DEFAULT_NUM_THREADS = 8,
+      NUM_PASSES = 4
+   };
+
+   Vector< char* > mStrings;
+   Vector< StringTableEntry > mEntries;
+
+   struct InternThread : public Thread
+   {
+      U32 mIndex;
+
+      InternThread( TestType* test, U32 index )
+         : Thread( 0, test ), mIndex( index ) {}
+
+      virtual void run( void* arg )
+      {
+         _setName( "InternThread" );
+         TestType* t = ( TestType* ) arg;
+         const U32 numStrings = t->mStrings.size();
+
+         // Every thread walks the strings starting at a different offset so
+         // that inserts of new strings and lookups of existing ones interleave.
+         for( U32 pass = 0; pass < NUM_PASSES; ++ pass )
+            for( U32 i = 0; i < numStrings; ++ i )
+            {
+               const U32 n = ( i + mIndex * 7919 ) % numStrings;
+               StringTableEntry entry = StringTable->insert( t->mStrings[ n ] );
+               XTEST( t, entry != NULL && !dStricmp( entry, t->mStrings[ n ] ) );
+
+               StringTableEntry expected = t->mEntries[ n ];
+               if( !expected )
+                  dCompareAndSwap( t->mEntries[ n ], ( StringTableEntry ) NULL, entry );
+               else
+                  XTEST( t, expected == entry );
+            }
+      }
+   };
+
+   void run()
+   {
+      const U32 numStrings = Con::getIntVariable( "$testStringTable::numStrings", DEFAULT_NUM_STRINGS );
+      const U32 numThreads = Con::getIntVariable( "$testStringTable::numThreads", DEFAULT_NUM_THREADS );
+
+      mStrings.setSize( numStrings );
+      mEntries.setSize( numStrings );
+      for( U32 i = 0; i < numStrings; ++ i )
+      {
+         mStrings[ i ] = new char[ 64 ];
+         dSprintf( mStrings[ i ], 64, "stConcurrentTest_%08x_Name", i * 2654435761U );
+         mEntries[ i ] = NULL;
+      }
+
+      Vector< InternThread* > threads;
+      threads.setSize( numThreads );
+
+      const U32 startTime = Platform::getRealMilliseconds();
+
+      for( U32 i = 0; i < numThreads; ++ i )
+      {
+         threads[ i ] = new InternThread( this, i );
+         threads[ i ]->start();
+      }
+      for( U32 i = 0; i < numThreads; ++ i )
+      {
+         threads[ i ]->join();
+         delete threads[ i ];
+      }
+
+      const U32 elapsed = getMax( Platform::getRealMilliseconds() - startTime, U32( 1 ) );
+      const U32 numOps = numStrings * numThreads * NUM_PASSES;
+      Con::printf( "StringTable: %i interns on %i threads in %ims (%i ops/ms)",
+         numOps, numThreads, elapsed, numOps / elapsed );
+      StringTable->dumpStats();
+
+      for( U32 i = 0; i < numStrings; ++ i )
+      {
+         TEST( StringTable->lookup( mStrings[ i ] ) == mEntries[ i ] );
+         delete [] mStrings[ i ];
+      }
+
+      mStrings.clear();
+      mEntries.clear();
+   }
+};
+
+#endif // !TORQUE_SHIPPING
@@ -0,0 +1,330 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "ts/tsShape.h"
+#include "ts/tsShapeInstance.h"
+#include "ts/tsAnimateBatch.h"
+#include "math/mRandom.h"
+#include "console/console.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+enum
+{
+   NumNodes = 32,
+   NumKeyframes = 16,
+   NumSequences = 2,
+};
+
+/// Builds a chain of nodes with cyclic sequences
+/// which animate every node.
+static TSShape* _createAnimateTestShape( MRandomLCG &rand )
+{
+   TSShape *shape = new TSShape;
+   shape->subShapeFirstNode.push_back( 0 );
+   shape->subShapeNumNodes.push_back( 0 );
+   shape->subShapeFirstObject.push_back( 0 );
+   shape->subShapeNumObjects.push_back( 0 );
+   shape->subShapeFirstTranslucentObject.push_back( 0 );
+
+   for ( U32 i=0; i < NumNodes; i++ )
+   {
+      const String parent = i ? String::ToString( "node%d", i - 1 ) : String();
+      shape->addNode( String::ToString( "node%d", i ), parent, Point3F( 0.0f, 0.0f, 0.25f ), QuatF( EulerF( 0.0f, 0.0f, 0.1f ) ) );
+   }
+
+   shape->addDetail( "detail", 2, 0 );
+
+   for ( U32 s=0; s < NumSequences; s++ )
+   {
+      shape->sequences.increment();
+      TSShape::Sequence &seq = shape->sequences.last();
+      seq.nameIndex = shape->addName( String::ToString( "seq%d", s ) );
+      seq.numKeyframes = NumKeyframes;
+      seq.duration = 1.0f;
+      seq.baseRotation = shape->nodeRotations.size();
+      seq.baseTranslation = shape->nodeTranslations.size();
+      seq.baseScale = 0;
+      seq.baseObjectState = 0;
+      seq.baseDecalState = 0;
+      seq.firstGroundFrame = 0;
+      seq.numGroundFrames = 0;
+      seq.firstTrigger = 0;
+      seq.numTriggers = 0;
+      seq.toolBegin = 0.0f;
+      seq.priority = 0;
+      seq.flags = TSShape::Cyclic;
+      seq.dirtyFlags = TSShapeInstance::TransformDirty;
+
+      seq.rotationMatters.setAll( NumNodes );
+      seq.translationMatters.setAll( NumNodes );
+      seq.scaleMatters.clearAll();
+      seq.visMatters.clearAll();
+      seq.frameMatters.clearAll();
+      seq.matFrameMatters.clearAll();
+      seq.decalMatters.clearAll();
+      seq.iflMatters.clearAll();
+
+      for ( U32 i=0; i < NumNodes * NumKeyframes; i++ )
+      {
+         Quat16 rot;
+         rot.set( QuatF( EulerF( rand.randF() - 0.5f, rand.randF() - 0.5f, rand.randF() - 0.5f ) ) );
+         shape->nodeRotations.push_back( rot );
+         shape->nodeTranslations.push_back( Point3F( rand.randF(), rand.randF(), rand.randF() ) );
+      }
+   }
+
+   shape->init();
+   return shape;
+}
+
+CreateUnitTest( TestTSAnimateBatch, "TS/AnimateBatch" )
+{
+   /// Moves every thread and returns the 
+   /// time it takes to animate them.
+   U32 animate( Vector<TSShapeInstance*> &shapes, Vector<TSThread*> &threads, F32 pos, bool parallel )
+   {
+      for ( U32 i=0; i < shapes.size(); i++ )
+         shapes[i]->setPos( threads[i], mFmod( pos + i * 0.01f, 1.0f ) );
+
+      const U32 start = Platform::getRealMilliseconds();
+
+      if ( parallel )
+      {
+         TSAnimateBatch batch;
+         for ( U32 i=0; i < shapes.size(); i++ )
+            batch.add( shapes[i], 0 );
+         batch.run();
+      }
+      else
+      {
+         for ( U32 i=0; i < shapes.size(); i++ )
+            shapes[i]->animate( 0 );
+      }
+
+      return Platform::getRealMilliseconds() - start;
+   }
+
+   void run()
+   {
+      MRandomLCG rand( 4321 );
+      TSShape *shape = _createAnimateTestShape( rand );
+
+      const bool oldParallel = TSAnimateBatch::smParallel;
+      TSAnimateBatch::smParallel = true;
+
+      const U32 counts[] = { 50, 500 };
+      for ( U32 c=0; c < 2; c++ )
+      {
+         Vector<TSShapeInstance*> shapes;
+         Vector<TSThread*> threads;
+         for ( U32 i=0; i < counts[c]; i++ )
+         {
+            shapes.push_back( new TSShapeInstance( shape, false ) );
+            threads.push_back( shapes.last()->addThread() );
+            shapes.last()->setSequence( threads.last(), 0, 0.0f );
+
+            // Put some of them in a transition.
+            if ( i % 3 == 0 )
+               shapes.last()->transitionToSequence( threads.last(), 1, 0.0f, 0.5f, true );
+         }
+
+         animate( shapes, threads, 0.25f, false );
+         Vector<MatrixF> serial;
+         for ( U32 i=0; i < shapes.size(); i++ )
+            serial.merge( shapes[i]->mNodeTransforms );
+
+         animate( shapes, threads, 0.25f, true );
+         bool match = true;
+         for ( U32 i=0; i < shapes.size(); i++ )
+         {
+            for ( U32 j=0; j < NumNodes; j++ )
+               match &= dMemcmp( &serial[ i * NumNodes + j ], &shapes[i]->mNodeTransforms[j], sizeof( MatrixF ) ) == 0;
+         }
+         test( match, "The batch should give the same transforms as animating serially!" );
+         test( !shapes[0]->needsAnimate( 0 ), "The batch didn't clear the dirty flags!" );
+
+         // Time a few frames each way.
+         U32 serialTime = 0;
+         U32 parallelTime = 0;
+         for ( U32 f=0; f < 10; f++ )
+         {
+            serialTime += animate( shapes, threads, f * 0.1f, false );
+            parallelTime += animate( shapes, threads, f * 0.1f, true );
+         }
+
+         Con::printf( "TS/AnimateBatch: %d shapes, %d nodes - serial %dms, batched %dms for 10 frames", 
+            counts[c], NumNodes, serialTime, parallelTime );
+
+         for ( U32 i=0; i < shapes.size(); i++ )
+            delete shapes[i];
+      }
+
+      TSAnimateBatch::smParallel = oldParallel;
+      delete shape;
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+/// Lets the test control when the nodes were last animated.
+class AnimateLODTestShape : public TSShapeInstance
+{
+public:
+
+   AnimateLODTestShape( TSShape *shape ) : TSShapeInstance( shape, false ) {}
+
+   void setLastAnimateAge( U32 ms ) { mLastNodeAnimateTime = Platform::getVirtualMilliseconds() - ms; }
+};
+
+CreateUnitTest( TestTSAnimateBatchLOD, "TS/AnimateBatch/LOD" )
+{
+   enum
+   {
+      NumShapes = 8,
+   };
+
+   bool sameTransforms( const TSShapeInstance *a, const TSShapeInstance *b )
+   {
+      return dMemcmp( a->mNodeTransforms.address(), b->mNodeTransforms.address(), NumNodes * sizeof( MatrixF ) ) == 0;
+   }
+
+   void run()
+   {
+      MRandomLCG rand( 1234 );
+      TSShape *shape = _createAnimateTestShape( rand );
+
+      const F32 oldFullRateSize = TSShapeInstance::smAnimFullRatePixelSize;
+      const S32 oldMaxInterval = TSShapeInstance::smAnimMaxInterval;
+      const S32 oldBudget = TSAnimateBatch::smNodeBudget;
+      const S32 oldSteps = TSAnimateBatch::smPoseShareSteps;
+      TSShapeInstance::smAnimFullRatePixelSize = 150.0f;
+      TSShapeInstance::smAnimMaxInterval = 100000;
+      TSAnimateBatch::smNodeBudget = 0;
+      TSAnimateBatch::smPoseShareSteps = 8;
+
+      Vector<AnimateLODTestShape*> shapes;
+      Vector<TSThread*> threads;
+      for ( U32 i=0; i < NumShapes; i++ )
+      {
+         shapes.push_back( new AnimateLODTestShape( shape ) );
+         threads.push_back( shapes.last()->addThread() );
+         shapes.last()->setSequence( threads.last(), 0, 0.0f );
+         shapes.last()->animate( 0 );
+      }
+
+      // A small shape keeps its pose until the interval is up.
+      AnimateLODTestShape *small = shapes[0];
+      small->setDetailFromPixelSize( 10.0f );
+      test( small->getCurrentPixelSize() == 10.0f, "The pixel size wasn't kept!" );
+      test( small->getAnimateInterval() > 0, "A small shape should have an interval!" );
+
+      small->setLastAnimateAge( 200000 );
+      small->setPos( threads[0], 0.3f );
+      small->animate( 0 );
+      Vector<MatrixF> pose = small->mNodeTransforms;
+
+      small->setPos( threads[0], 0.6f );
+      test( small->isNodeAnimationThrottled(), "The shape should be throttled!" );
+      small->animate( 0 );
+      test( dMemcmp( pose.address(), small->mNodeTransforms.address(), pose.memSize() ) == 0, "A throttled shape changed its pose!" );
+      test( small->needsAnimate( 0 ), "A throttled shape should stay dirty!" );
+
+      // Setting the detail directly goes back to the full rate.
+      small->setCurrentDetail( 0 );
+      test( small->getAnimateInterval() == 0, "Forced detail should animate every time!" );
+      small->animate( 0 );
+      shapes[1]->setPos( threads[1], 0.6f );
+      shapes[1]->animate( 0 );
+      test( sameTransforms( small, shapes[1] ), "The shape didn't catch up with its thread!" );
+
+      // Half the shapes are at the same spot and share one pose.
+      TSAnimateBatch batch;
+      for ( U32 i=0; i < NumShapes; i++ )
+      {
+         shapes[i]->setDetailFromPixelSize( 10.0f );
+         shapes[i]->setLastAnimateAge( 200000 );
+         shapes[i]->setPos( threads[i], i < NumShapes / 2 ? 0.5f : 0.1f * i + 0.05f );
+         batch.add( shapes[i], 0 );
+      }
+      batch.run();
+
+      test( TSAnimateBatch::smNumShared == NumShapes / 2 - 1, "Wrong number of shared poses!" );
+      test( TSAnimateBatch::smNumAnimated == NumShapes / 2 + 1, "Wrong number of animated shapes!" );
+      bool shared = true;
+      for ( U32 i=1; i < NumShapes / 2; i++ )
+         shared &= sameTransforms( shapes[0], shapes[i] ) && !shapes[i]->needsAnimate( 0 );
+      test( shared, "The shared poses don't match!" );
+
+      // Only two shapes fit the node budget, the others wait 
+      // since they were just animated.
+      TSAnimateBatch::smNodeBudget = NumNodes * 2;
+      TSAnimateBatch::smPoseShareSteps = 0;
+      for ( U32 i=0; i < NumShapes; i++ )
+      {
+         shapes[i]->setCurrentDetail( 0 );
+         shapes[i]->setLastAnimateAge( 0 );
+         shapes[i]->setPos( threads[i], 0.05f * i );
+         batch.add( shapes[i], 0 );
+      }
+      batch.run();
+
+      test( TSAnimateBatch::smNumAnimated == 2, "The budget wasn't applied!" );
+      test( TSAnimateBatch::smNumThrottled == NumShapes - 2, "Wrong number of throttled shapes!" );
+      test( TSAnimateBatch::smNumNodes == NumNodes * 2, "Animated more nodes than the budget!" );
+
+      // With the budget and the pose sharing both on, two big shapes 
+      // and the two biggest of four small shapes in the same pose fit
+      // the budget.  The smallest two are throttled, so they must not
+      // lead the shared pose.
+      TSAnimateBatch::smNodeBudget = NumNodes * 4;
+      TSAnimateBatch::smPoseShareSteps = 8;
+
+      AnimateLODTestShape reference( shape );
+      TSThread *refThread = reference.addThread();
+      reference.setSequence( refThread, 0, 0.5f );
+      reference.animate( 0 );
+
+      Vector<MatrixF> oldPoses;
+      for ( U32 i=0; i < 6; i++ )
+      {
+         // The small shapes would animate now if not for the budget.
+         shapes[i]->setDetailFromPixelSize( i < 2 ? 1000.0f : 138.0f + i );
+         shapes[i]->setLastAnimateAge( TSShapeInstance::smAnimMaxInterval / 2 );
+         shapes[i]->setPos( threads[i], i < 2 ? 0.2f + 0.1f * i : 0.5f );
+         oldPoses.merge( shapes[i]->mNodeTransforms );
+         batch.add( shapes[i], 0 );
+      }
+      test( shapes[2]->willAnimateNodes( 0 ), "The small shapes should be due to animate!" );
+      batch.run();
+
+      test( TSAnimateBatch::smNumAnimated == 3, "Wrong number of animated shapes!" );
+      test( TSAnimateBatch::smNumThrottled == 2, "Wrong number of throttled shapes!" );
+      test( TSAnimateBatch::smNumShared == 1, "Wrong number of shared poses!" );
+
+      for ( U32 i=2; i < 4; i++ )
+      {
+         test( shapes[i]->needsAnimate( 0 ), "A throttled shape should stay dirty!" );
+         test( dMemcmp( &oldPoses[ i * NumNodes ], shapes[i]->mNodeTransforms.address(), NumNodes * sizeof( MatrixF ) ) == 0, 
+            "A throttled shape changed its pose!" );
+      }
+
+      for ( U32 i=4; i < 6; i++ )
+         test( !shapes[i]->needsAnimate( 0 ) && sameTransforms( shapes[i], &reference ), "A shape got a stale pose!" );
+
+      for ( U32 i=0; i < shapes.size(); i++ )
+         delete shapes[i];
+
+      TSShapeInstance::smAnimFullRatePixelSize = oldFullRateSize;
+      TSShapeInstance::smAnimMaxInterval = oldMaxInterval;
+      TSAnimateBatch::smNodeBudget = oldBudget;
+      TSAnimateBatch::smPoseShareSteps = oldSteps;
+      delete shape;
+   }
+};
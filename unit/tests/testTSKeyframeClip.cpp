@@ -0,0 +1,118 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "ts/tsShape.h"
+#include "math/mRandom.h"
+#include "console/console.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestTSKeyframeClip, "TS/KeyframeClip" )
+{
+   enum
+   {
+      NumTracks = 61,
+      NumKeyframes = 30,
+   };
+
+   void run()
+   {
+      MRandomLCG rand( 2468 );
+
+      // One sequence where every third track never changes, which
+      // is typical of the translations in character animation.
+      TSShape shape;
+      shape.sequences.increment();
+      TSShape::Sequence &seq = shape.sequences.last();
+      seq.numKeyframes = NumKeyframes;
+      seq.baseRotation = 0;
+      seq.baseTranslation = 0;
+      seq.rotationMatters.setAll( NumTracks );
+      seq.translationMatters.setAll( NumTracks );
+
+      for ( U32 i=0; i < NumTracks; i++ )
+      {
+         const QuatF constRot( EulerF( rand.randF(), rand.randF(), rand.randF() ) );
+         const Point3F constTrans( rand.randF(), rand.randF(), rand.randF() );
+
+         for ( U32 k=0; k < NumKeyframes; k++ )
+         {
+            Quat16 rot;
+            rot.set( i % 3 ? QuatF( EulerF( rand.randF() * M_2PI_F, rand.randF() * M_2PI_F, rand.randF() * M_2PI_F ) ) : constRot );
+            shape.nodeRotations.push_back( rot );
+            shape.nodeTranslations.push_back( i % 3 ? Point3F( rand.randF(), rand.randF(), rand.randF() ) : constTrans );
+         }
+      }
+
+      shape.initKeyframeClips();
+      test( shape.keyframeClips.size() == 1, "The clip wasn't built!" );
+      if ( shape.keyframeClips.empty() )
+         return;
+
+      const TSShape::KeyframeClip &clip = shape.keyframeClips[0];
+      test( clip.constRotTracks.size() == ( NumTracks + 2 ) / 3, "The constant rotations were not found!" );
+      test( clip.constTransTracks.size() == ( NumTracks + 2 ) / 3, "The constant translations were not found!" );
+      test( clip.numRotTracks % 4 == 0 && clip.numTransTracks % 4 == 0, "The clip isn't padded!" );
+
+      // The clip has to give exactly what interpolating 
+      // each track on its own gives.
+      TSShape::KeyframeClip saved = clip;
+      bool rotMatch = true;
+      bool transMatch = true;
+      for ( U32 k=0; k + 1 < NumKeyframes; k++ )
+      {
+         const F32 t = rand.randF();
+
+         QuatF clipRots[NumTracks], trackRots[NumTracks];
+         Point3F clipTrans[NumTracks], trackTrans[NumTracks];
+
+         shape.sampleRotations( seq, k, k + 1, t, clipRots );
+         shape.sampleTranslations( seq, k, k + 1, t, clipTrans );
+
+         shape.keyframeClips.clear();
+         shape.sampleRotations( seq, k, k + 1, t, trackRots );
+         shape.sampleTranslations( seq, k, k + 1, t, trackTrans );
+         shape.keyframeClips.push_back( saved );
+
+         rotMatch &= dMemcmp( clipRots, trackRots, sizeof( clipRots ) ) == 0;
+         transMatch &= dMemcmp( clipTrans, trackTrans, sizeof( clipTrans ) ) == 0;
+      }
+      test( rotMatch, "The clip rotations don't match the tracks!" );
+      test( transMatch, "The clip translations don't match the tracks!" );
+
+      // Time sampling the whole sequence both ways.
+      const U32 numSamples = 20000;
+      QuatF rots[NumTracks];
+      Point3F trans[NumTracks];
+
+      U32 start = Platform::getRealMilliseconds();
+      for ( U32 i=0; i < numSamples; i++ )
+      {
+         const S32 key = i % ( NumKeyframes - 1 );
+         shape.sampleRotations( seq, key, key + 1, 0.5f, rots );
+         shape.sampleTranslations( seq, key, key + 1, 0.5f, trans );
+      }
+      const U32 clipTime = Platform::getRealMilliseconds() - start;
+
+      shape.keyframeClips.clear();
+      start = Platform::getRealMilliseconds();
+      for ( U32 i=0; i < numSamples; i++ )
+      {
+         const S32 key = i % ( NumKeyframes - 1 );
+         shape.sampleRotations( seq, key, key + 1, 0.5f, rots );
+         shape.sampleTranslations( seq, key, key + 1, 0.5f, trans );
+      }
+      const U32 trackTime = Platform::getRealMilliseconds() - start;
+      shape.keyframeClips.push_back( saved );
+
+      Con::printf( "TS/KeyframeClip: %d samples of %d tracks - clip %dms, per track %dms", numSamples, NumTracks, clipTime, trackTime );
+      Con::printf( "TS/KeyframeClip: keyframes %d bytes, clip %d bytes", 
+         shape.nodeRotations.memSize() + shape.nodeTranslations.memSize(), shape.getKeyframeClipsSize() );
+   }
+};
@@ -0,0 +1,163 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "ts/tsLODManager.h"
+#include "ts/tsShape.h"
+#include "ts/tsShapeInstance.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestTSLODManager, "TS/LODManager" )
+{
+   enum
+   {
+      NumShapes = 20,
+      PolysPerShape = 1000,
+   };
+
+   /// Adds shapes from 10 to 200 pixels in size.
+   void addFrame()
+   {
+      for ( U32 i=0; i < NumShapes; i++ )
+         TSLODManager::addShape( ( i + 1 ) * 10.0f, PolysPerShape, 2 );
+   }
+
+   void testBudget()
+   {
+      const S32 oldPolyBudget = TSLODManager::smPolyBudget;
+      const S32 oldDrawCallBudget = TSLODManager::smDrawCallBudget;
+
+      // Start from a clean frame.
+      TSLODManager::smPolyBudget = 0;
+      TSLODManager::smDrawCallBudget = 0;
+      TSLODManager::smCutoff = 0.0f;
+      TSLODManager::beginFrame();
+      TSLODManager::smCutoff = 0.0f;
+
+      // Under the budget nothing changes.
+      TSLODManager::smPolyBudget = NumShapes * PolysPerShape;
+      addFrame();
+      TSLODManager::beginFrame();
+      test( TSLODManager::smNumShapes == NumShapes, "Wrong shape count!" );
+      test( TSLODManager::smNumPolys == NumShapes * PolysPerShape, "Wrong polygon count!" );
+      test( TSLODManager::smNumDrawCalls == NumShapes * 2, "Wrong draw call count!" );
+      test( TSLODManager::smCutoff == 0.0f, "Under the budget there should be no cutoff!" );
+      test( TSLODManager::getBudgetPixelSize( 10.0f, 1.0f ) == 10.0f, "Under the budget the size shouldn't change!" );
+
+      // Over the budget the small shapes lose detail.
+      TSLODManager::smPolyBudget = NumShapes * PolysPerShape / 2;
+      addFrame();
+      TSLODManager::beginFrame();
+      const F32 cutoff = TSLODManager::smCutoff;
+      test( cutoff > 10.0f && cutoff <= 200.0f, "Over the budget there should be a cutoff!" );
+      test( TSLODManager::getBudgetPixelSize( 200.0f, 1.0f ) == 200.0f, "The largest shape shouldn't lose detail!" );
+      test( TSLODManager::getBudgetPixelSize( 10.0f, 1.0f ) < 10.0f, "The smallest shape should lose detail!" );
+      test( TSLODManager::getBudgetPixelSize( 10.0f, 1.0f ) >= 10.0f * TSLODManager::smMinBudgetScale, "Reduced below the minimum scale!" );
+      test( TSLODManager::getBudgetPixelSize( 10.0f, cutoff ) == 10.0f, "An important shape shouldn't lose detail!" );
+
+      // The shapes above the cutoff fit the budget.
+      U32 keptPolys = 0;
+      for ( U32 i=0; i < NumShapes; i++ )
+         if ( ( i + 1 ) * 10.0f >= cutoff )
+            keptPolys += PolysPerShape;
+      test( keptPolys <= TSLODManager::smPolyBudget, "The shapes above the cutoff are over the budget!" );
+
+      // Once under the budget the cutoff comes down slowly.
+      TSLODManager::smPolyBudget = 0;
+      addFrame();
+      TSLODManager::beginFrame();
+      test( TSLODManager::smNumReduced > 0, "The small shapes should have been reduced!" );
+      test( TSLODManager::smCutoff > 0.0f && TSLODManager::smCutoff < cutoff, "The cutoff should fall slowly!" );
+
+      for ( U32 i=0; i < 100; i++ )
+         TSLODManager::beginFrame();
+      test( TSLODManager::smCutoff == 0.0f, "The cutoff should be gone!" );
+
+      // The draw call budget works the same way.
+      TSLODManager::smDrawCallBudget = NumShapes;
+      addFrame();
+      TSLODManager::beginFrame();
+      test( TSLODManager::smCutoff > 0.0f, "The draw call budget wasn't applied!" );
+
+      TSLODManager::smCutoff = 0.0f;
+      TSLODManager::smPolyBudget = oldPolyBudget;
+      TSLODManager::smDrawCallBudget = oldDrawCallBudget;
+   }
+
+   void testDetailBySize()
+   {
+      TSShape *shape = new TSShape;
+
+      const F32 sizes[] = { 100.0f, 50.0f, 10.0f, -1.0f };
+      for ( U32 i=0; i < 4; i++ )
+      {
+         shape->details.increment();
+         dMemset( &shape->details.last(), 0, sizeof( TSShape::Detail ) );
+         shape->details.last().size = sizes[i];
+      }
+      shape->mSmallestVisibleSize = 10.0f;
+      shape->mSmallestVisibleDL = 2;
+
+      test( shape->findDetailBySize( 200.0f ) == 0, "Wrong detail for a large size!" );
+      test( shape->findDetailBySize( 75.0f ) == 1, "Wrong detail for a medium size!" );
+      test( shape->findDetailBySize( 20.0f ) == 2, "Wrong detail for a small size!" );
+      test( shape->findDetailBySize( 5.0f ) == -1, "The shape should be hidden!" );
+
+      delete shape;
+   }
+
+   void testHysteresis()
+   {
+      const F32 oldHysteresis = TSLODManager::smHysteresis;
+      TSLODManager::smHysteresis = 0.1f;
+
+      TSShape *shape = new TSShape;
+      shape->subShapeFirstNode.push_back( 0 );
+      shape->subShapeNumNodes.push_back( 0 );
+      shape->subShapeFirstObject.push_back( 0 );
+      shape->subShapeNumObjects.push_back( 0 );
+      shape->subShapeFirstTranslucentObject.push_back( 0 );
+      shape->addNode( "root", String(), Point3F::Zero, QuatF( EulerF( 0.0f, 0.0f, 0.0f ) ) );
+      shape->addDetail( "detail", 100, 0 );
+      shape->addDetail( "detail", 50, 0 );
+      shape->addDetail( "detail", 10, 0 );
+      shape->init();
+
+      TSShapeInstance *inst = new TSShapeInstance( shape, false );
+
+      test( inst->setDetailFromPixelSize( 75.0f ) == 1, "Wrong detail for a medium size!" );
+
+      // Inside the band below the detail it holds...
+      test( inst->setDetailFromPixelSize( 47.0f ) == 1, "The detail should hold inside the hysteresis!" );
+
+      // ...and past it it switches.
+      test( inst->setDetailFromPixelSize( 44.0f ) == 2, "The detail should drop past the hysteresis!" );
+
+      // The same going back up.
+      test( inst->setDetailFromPixelSize( 53.0f ) == 2, "The detail should hold inside the hysteresis!" );
+      test( inst->setDetailFromPixelSize( 56.0f ) == 1, "The detail should rise past the hysteresis!" );
+
+      // Without it the detail follows the sizes exactly.
+      TSLODManager::smHysteresis = 0.0f;
+      test( inst->setDetailFromPixelSize( 49.0f ) == 2, "The detail should drop without hysteresis!" );
+      test( inst->setDetailFromPixelSize( 51.0f ) == 1, "The detail should rise without hysteresis!" );
+
+      delete inst;
+      delete shape;
+
+      TSLODManager::smHysteresis = oldHysteresis;
+   }
+
+   void run()
+   {
+      testBudget();
+      testDetailBySize();
+      testHysteresis();
+   }
+};
@@ -0,0 +1,132 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "ts/tsLastDetail.h"
+#include "gfx/bitmap/gBitmap.h"
+#include "gfx/bitmap/ddsFile.h"
+#include "core/stream/fileStream.h"
+#include "core/volume.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+/// Exposes the update job so the test can run
+/// the stages without a device.
+class LastDetailCacheTestAccess : public TSLastDetail
+{
+public:
+
+   typedef TSLastDetail::UpdateJob Job;
+};
+
+CreateUnitTest( TestTSLastDetailCache, "TS/LastDetail/Cache" )
+{
+   typedef LastDetailCacheTestAccess::Job Job;
+
+   enum
+   {
+      Dim = 64,
+      EquatorSteps = 4,
+      PolarSteps = 1,
+   };
+
+   void writeShape( const Torque::Path &path, U8 value )
+   {
+      U8 data[256];
+      dMemset( data, value, sizeof( data ) );
+
+      FileStream stream;
+      if ( stream.open( path, Torque::FS::File::Write ) )
+         stream.write( sizeof( data ), data );
+   }
+
+   Job* createJob( const String &shapePath, S32 dim )
+   {
+      Job *job = new Job;
+      job->mShapePath = shapePath;
+      job->mDl = 0;
+      job->mDim = dim;
+      job->mNumEquatorSteps = EquatorSteps;
+      job->mNumPolarSteps = PolarSteps;
+      job->mPolarAngle = 0.25f;
+      job->mIncludePoles = true;
+      return job;
+   }
+
+   /// Fills the job with images like the capture would.
+   void fakeCapture( Job *job )
+   {
+      const U32 count = ( 2 * PolarSteps + 1 ) * EquatorSteps + 2;
+      for ( U32 i=0; i < count; i++ )
+      {
+         GBitmap *bmp = new GBitmap( job->mDim, job->mDim, false, GFXFormatR8G8B8A8 );
+         dMemset( bmp->getWritableBits(), i * 16, job->mDim * job->mDim * 4 );
+         job->mBitmaps.push_back( bmp );
+
+         GBitmap *normal = new GBitmap( job->mDim, job->mDim, false, GFXFormatR8G8B8A8 );
+         dMemset( normal->getWritableBits(), 128, job->mDim * job->mDim * 4 );
+         job->mNormalMaps.push_back( normal );
+      }
+   }
+
+   void run()
+   {
+      const String shapePath( "testTSLastDetail/shape.dts" );
+      writeShape( shapePath, 1 );
+
+      // The first lookup misses and bakes the cache.
+      ThreadSafeRef< Job > job = createJob( shapePath, Dim );
+      job->lookup();
+      test( job->mStage == Job::Capture, "The cache should be empty!" );
+
+      fakeCapture( job );
+      job->bake();
+      test( job->mStage == Job::Done, "The bake didn't finish!" );
+      test( job->mImposterDDS && job->mNormalsDDS, "The bake didn't create the atlases!" );
+      test( Torque::FS::IsFile( job->mImposterPath ) && Torque::FS::IsFile( job->mNormalsPath ), "The bake didn't write the cache!" );
+
+      const String imposterPath = job->mImposterPath;
+      const String normalsPath = job->mNormalsPath;
+
+      // The same settings hit it.
+      ThreadSafeRef< Job > hit = createJob( shapePath, Dim );
+      hit->lookup();
+      test( hit->mStage == Job::Done, "The cache should have been hit!" );
+      test( hit->mImposterPath == imposterPath, "The same settings gave a different cache!" );
+      if ( hit->mImposterDDS && job->mImposterDDS )
+      {
+         test( hit->mImposterDDS->getWidth() == job->mImposterDDS->getWidth() &&
+               hit->mImposterDDS->getHeight() == job->mImposterDDS->getHeight(), "The cached atlas has the wrong size!" );
+         test( hit->mImposterDDS->mFormat == GFXFormatDXT5, "The cached atlas should be compressed!" );
+      }
+
+      // Unless the cache is ignored.
+      ThreadSafeRef< Job > forced = createJob( shapePath, Dim );
+      forced->mForceUpdate = true;
+      forced->lookup();
+      test( forced->mStage == Job::Capture, "A forced update shouldn't read the cache!" );
+
+      // A different setting misses.
+      ThreadSafeRef< Job > setting = createJob( shapePath, Dim / 2 );
+      setting->lookup();
+      test( setting->mStage == Job::Capture, "A different setting hit the cache!" );
+      test( setting->mImposterPath != imposterPath, "A different setting gave the same cache!" );
+
+      // So does a changed shape.
+      writeShape( shapePath, 2 );
+      ThreadSafeRef< Job > changed = createJob( shapePath, Dim );
+      changed->lookup();
+      test( changed->mStage == Job::Capture, "A changed shape hit the cache!" );
+      test( changed->mImposterPath != imposterPath, "A changed shape gave the same cache!" );
+
+      Torque::FS::Remove( imposterPath );
+      Torque::FS::Remove( normalsPath );
+      Torque::FS::Remove( shapePath );
+      Torque::FS::Remove( "testTSLastDetail" );
+   }
+};
@@ -0,0 +1,160 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "ts/tsLastDetail.h"
+#include "ts/tsShape.h"
+#include "gfx/gfxDevice.h"
+#include "gfx/bitmap/gBitmap.h"
+#include "core/stream/fileStream.h"
+#include "core/volume.h"
+#include "console/console.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+/// Fills in the images of the capture stage without
+/// rendering, and counts the captures.
+class LastDetailUpdateTestDetail : public TSLastDetail
+{
+public:
+
+   U32 mCaptures;
+
+   LastDetailUpdateTestDetail( TSShape *shape, const String &cachePath )
+      :  TSLastDetail( shape, cachePath, 4, 0, 0.0f, false, 0, 16 ),
+         mCaptures( 0 )
+   {
+   }
+
+   virtual void _capture( UpdateJob *job )
+   {
+      for ( U32 i=0; i < _getImageCount(); i++ )
+      {
+         GBitmap *bmp = new GBitmap( mDim, mDim, false, GFXFormatR8G8B8A8 );
+         dMemset( bmp->getWritableBits(), 255, mDim * mDim * 4 );
+         job->mBitmaps.push_back( bmp );
+
+         GBitmap *normal = new GBitmap( mDim, mDim, false, GFXFormatR8G8B8A8 );
+         dMemset( normal->getWritableBits(), 128, mDim * mDim * 4 );
+         job->mNormalMaps.push_back( normal );
+      }
+
+      mCaptures++;
+   }
+
+   /// Puts the update back to the lookup as if the
+   /// thread pool dropped its work item.
+   void dropWorkItem()
+   {
+      mUpdateJob->mStage = UpdateJob::Lookup;
+      mUpdateJob->mBusy = 0;
+   }
+
+   bool isLookingUp() const { return mUpdateJob && mUpdateJob->mStage == UpdateJob::Lookup; }
+   bool isUpdating() const { return mUpdateJob != NULL; }
+};
+
+CreateUnitTest( TestTSLastDetailUpdates, "TS/LastDetail/Updates" )
+{
+   enum
+   {
+      NumDetails = 3,
+   };
+
+   void run()
+   {
+      // The textures need a device.
+      if ( !GFXDevice::devicePresent() || GFX->getAdapterType() != NullDevice )
+      {
+         Con::printf( "TS/LastDetail/Updates: skipped, requires the null device." );
+         return;
+      }
+
+      const bool oldBakeInBackground = TSLastDetail::smBakeInBackground;
+      const S32 oldCapturesPerFrame = TSLastDetail::smCapturesPerFrame;
+      TSLastDetail::smBakeInBackground = false;
+      TSLastDetail::smCapturesPerFrame = 1;
+
+      TSShape *shape = new TSShape;
+      shape->radius = 1.0f;
+
+      // Shapes which are new to the cache, so that every update captures.
+      const U32 seed = Platform::getRealMilliseconds();
+      String shapePaths[ NumDetails ];
+      LastDetailUpdateTestDetail *details[ NumDetails ];
+      for ( U32 i=0; i < NumDetails; i++ )
+      {
+         shapePaths[i] = String::ToString( "testTSLastDetailUpdates/shape%d.dts", i );
+
+         FileStream stream;
+         if ( stream.open( shapePaths[i], Torque::FS::File::Write ) )
+         {
+            stream.write( seed );
+            stream.write( i );
+         }
+
+         details[i] = new LastDetailUpdateTestDetail( shape, shapePaths[i] );
+      }
+
+      // A work item which was dropped without
+      // running is queued again.
+      details[0]->requestUpdate();
+      test( details[0]->isUpdating() && !details[0]->isLookingUp(), "The lookup should have run!" );
+      details[0]->dropWorkItem();
+      TSLastDetail::processUpdates();
+      test( !details[0]->isLookingUp(), "The dropped lookup wasn't run again!" );
+      test( details[0]->mCaptures == 0, "The lookup and the capture ran in the same frame!" );
+
+      details[1]->requestUpdate();
+      details[2]->requestUpdate();
+
+      // Only one capture runs each frame and the detail
+      // is loaded in the frame after its capture.
+      for ( U32 frame=1; frame <= NumDetails; frame++ )
+      {
+         TSLastDetail::processUpdates();
+
+         U32 captures = 0, loaded = 0;
+         for ( U32 i=0; i < NumDetails; i++ )
+         {
+            captures += details[i]->mCaptures;
+            loaded += details[i]->isLoaded() ? 1 : 0;
+         }
+
+         test( captures == frame, "Captured more than the limit in a frame!" );
+         test( loaded == frame - 1, "A captured detail wasn't loaded the next frame!" );
+      }
+
+      TSLastDetail::processUpdates();
+      for ( U32 i=0; i < NumDetails; i++ )
+      {
+         test( details[i]->isLoaded() && !details[i]->isUpdating(), "The update didn't finish!" );
+         test( details[i]->mCaptures == 1, "The detail was captured more than once!" );
+      }
+
+      // Loaded details don't update again.
+      details[0]->requestUpdate();
+      test( !details[0]->isUpdating(), "A loaded detail started another update!" );
+
+      for ( U32 i=0; i < NumDetails; i++ )
+      {
+         delete details[i];
+
+         Vector<String> files;
+         Torque::FS::FindByPattern( "testTSLastDetailUpdates", String::ToString( "shape%d.*", i ), false, files );
+         for ( U32 j=0; j < files.size(); j++ )
+            Torque::FS::Remove( files[j] );
+      }
+      Torque::FS::Remove( "testTSLastDetailUpdates" );
+
+      delete shape;
+
+      TSLastDetail::smBakeInBackground = oldBakeInBackground;
+      TSLastDetail::smCapturesPerFrame = oldCapturesPerFrame;
+   }
+};
@@ -0,0 +1,214 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "ts/tsShape.h"
+#include "ts/tsMesh.h"
+#include "ts/tsShapeImage.h"
+#include "core/stream/memStream.h"
+#include "core/stream/fileStream.h"
+#include "core/volume.h"
+#include "math/mRandom.h"
+#include "console/console.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestTSShapeImage, "TS/ShapeImage" )
+{
+   enum
+   {
+      NumNodes = 16,
+      NumKeyframes = 8,
+      NumLoads = 50,
+   };
+
+   TSShape* createShape( MRandomLCG &rand )
+   {
+      TSShape *shape = new TSShape;
+      shape->subShapeFirstNode.push_back( 0 );
+      shape->subShapeNumNodes.push_back( 0 );
+      shape->subShapeFirstObject.push_back( 0 );
+      shape->subShapeNumObjects.push_back( 0 );
+      shape->subShapeFirstTranslucentObject.push_back( 0 );
+
+      for ( U32 i=0; i < NumNodes; i++ )
+      {
+         const String parent = i ? String::ToString( "node%d", i - 1 ) : String();
+         shape->addNode( String::ToString( "node%d", i ), parent, Point3F( 0.0f, 0.0f, 0.25f ), QuatF( EulerF( 0.0f, 0.0f, 0.1f ) ) );
+      }
+
+      shape->addMesh( TSShape::createMeshCube( Point3F( 0.0f, 0.0f, 0.0f ), Point3F( 1.0f, 2.0f, 3.0f ) ), "box2" );
+
+      shape->sequences.increment();
+      TSShape::Sequence &seq = shape->sequences.last();
+      dMemset( &seq, 0, sizeof( seq ) );
+      seq.nameIndex = shape->addName( "ambient" );
+      seq.numKeyframes = NumKeyframes;
+      seq.duration = 1.0f;
+      seq.flags = TSShape::Cyclic;
+      seq.rotationMatters.setAll( NumNodes );
+      seq.translationMatters.setAll( NumNodes );
+
+      for ( U32 i=0; i < NumNodes * NumKeyframes; i++ )
+      {
+         Quat16 rot;
+         rot.set( QuatF( EulerF( rand.randF() - 0.5f, rand.randF() - 0.5f, rand.randF() - 0.5f ) ) );
+         shape->nodeRotations.push_back( rot );
+         shape->nodeTranslations.push_back( Point3F( rand.randF(), rand.randF(), rand.randF() ) );
+      }
+
+      shape->materialList = new TSMaterialList;
+      shape->init();
+      return shape;
+   }
+
+   template<class T>
+   bool sameTable( const Vector<T> &a, const Vector<T> &b )
+   {
+      return a.size() == b.size() && ( a.empty() || dMemcmp( a.address(), b.address(), a.size() * sizeof( T ) ) == 0 );
+   }
+
+   void run()
+   {
+      MRandomLCG rand( 4321 );
+      TSShape *shape = createShape( rand );
+
+      MemStream imageStream( 4096 );
+      test( shape->writeImage( &imageStream ), "Failed to write the image!" );
+      const U32 imageSize = imageStream.getPosition();
+
+      TSShape *loaded = new TSShape;
+      test( loaded->readImage( imageStream.getBuffer(), imageSize ), "Failed to read the image!" );
+
+      test( loaded->names.size() == shape->names.size(), "Lost some names!" );
+      for ( U32 i=0; i < getMin( loaded->names.size(), shape->names.size() ); i++ )
+         test( loaded->names[i] == shape->names[i], "Wrong name!" );
+
+      test( loaded->nodes.size() == shape->nodes.size(), "Wrong node count!" );
+      test( loaded->findNode( "node7" ) == shape->findNode( "node7" ), "Wrong node lookup!" );
+      test( sameTable( loaded->nodeRotations, shape->nodeRotations ), "The rotations don't match!" );
+      test( sameTable( loaded->nodeTranslations, shape->nodeTranslations ), "The translations don't match!" );
+      test( sameTable( loaded->sequences, shape->sequences ), "The sequences don't match!" );
+      test( sameTable( loaded->details, shape->details ), "The details don't match!" );
+      test( loaded->bounds.minExtents == shape->bounds.minExtents && loaded->bounds.maxExtents == shape->bounds.maxExtents, "The bounds don't match!" );
+
+      test( loaded->meshes.size() == shape->meshes.size(), "Wrong mesh count!" );
+      for ( U32 i=0; i < getMin( loaded->meshes.size(), shape->meshes.size() ); i++ )
+      {
+         const TSMesh *a = shape->meshes[i];
+         const TSMesh *b = loaded->meshes[i];
+         test( ( a == NULL ) == ( b == NULL ), "Wrong NULL mesh!" );
+         if ( !a || !b )
+            continue;
+
+         test( a->getMeshType() == b->getMeshType(), "Wrong mesh type!" );
+         test( sameTable( a->primitives, b->primitives ), "The primitives don't match!" );
+         test( sameTable( a->indices, b->indices ), "The indices don't match!" );
+         test( a->mNumVerts == b->mNumVerts, "Wrong vertex count!" );
+         test( b->mVertexData.isReady(), "The vertices should be interleaved!" );
+         test( a->mVertexData.vertSize() == b->mVertexData.vertSize(), "Wrong vertex size!" );
+         if ( a->mNumVerts == b->mNumVerts && a->mVertexData.vertSize() == b->mVertexData.vertSize() )
+            test( dMemcmp( a->mVertexData.address(), b->mVertexData.address(), a->mNumVerts * a->mVertexData.vertSize() ) == 0, "The vertices don't match!" );
+      }
+      delete loaded;
+
+      // A damaged image is rejected.
+      TSShape *damaged = new TSShape;
+      test( !damaged->readImage( imageStream.getBuffer(), imageSize / 2 ), "Loaded a truncated image!" );
+      delete damaged;
+
+      // So is one written with other mesh options.
+      const bool oldUseTriangles = TSMesh::smUseTriangles;
+      TSMesh::smUseTriangles = !oldUseTriangles;
+      TSShape *stale = new TSShape;
+      test( !stale->readImage( imageStream.getBuffer(), imageSize ), "Loaded an image with different mesh options!" );
+      delete stale;
+      TSMesh::smUseTriangles = oldUseTriangles;
+
+      // Compare the load times against the DTS.
+      MemStream dtsStream( 4096 );
+      shape->write( &dtsStream );
+      const U32 dtsSize = dtsStream.getPosition();
+
+      U32 start = Platform::getRealMilliseconds();
+      for ( U32 i=0; i < NumLoads; i++ )
+      {
+         MemStream stream( dtsSize, dtsStream.getBuffer(), true, false );
+         TSShape *dts = new TSShape;
+         test( dts->read( &stream ), "Failed to read the DTS!" );
+         delete dts;
+      }
+      const U32 dtsTime = Platform::getRealMilliseconds() - start;
+
+      start = Platform::getRealMilliseconds();
+      for ( U32 i=0; i < NumLoads; i++ )
+      {
+         TSShape *image = new TSShape;
+         test( image->readImage( imageStream.getBuffer(), imageSize ), "Failed to read the image!" );
+         delete image;
+      }
+      const U32 imageTime = Platform::getRealMilliseconds() - start;
+
+      Con::printf( "TS/ShapeImage: %d loads, DTS %d bytes %dms, image %d bytes %dms", NumLoads, dtsSize, dtsTime, imageSize, imageTime );
+
+      testFiles( shape );
+
+      delete shape;
+   }
+
+   bool writeShape( TSShape *shape, const Torque::Path &path )
+   {
+      FileStream stream;
+      if ( !stream.open( path, Torque::FS::File::Write ) )
+         return false;
+
+      shape->write( &stream );
+      return stream.getStatus() == Stream::Ok;
+   }
+
+   /// Saves the image next to a DTS and checks that it is only
+   /// loaded while it is newer than the DTS.
+   void testFiles( TSShape *shape )
+   {
+      const bool oldUseImages = TSShape::smUseImages;
+      TSShape::smUseImages = true;
+
+      const Torque::Path shapePath( "testShapeImage.dts" );
+      const Torque::Path imagePath = TSShape::getImagePath( shapePath );
+      Torque::Path tempPath( imagePath );
+      tempPath.setExtension( imagePath.getExtension() + ".tmp" );
+
+      test( writeShape( shape, shapePath ), "Failed to write the DTS!" );
+      test( shape->saveImage( shapePath ), "Failed to save the image!" );
+      test( !Torque::FS::IsFile( tempPath ), "Left the temporary image behind!" );
+
+      // Saving again replaces the old image.
+      test( shape->saveImage( shapePath ), "Failed to replace the image!" );
+
+      TSShape *image = TSShape::loadImage( shapePath );
+      test( image != NULL, "Failed to load the saved image!" );
+      delete image;
+
+      // Touch the DTS until the file times show it is newer, the
+      // times may only have a resolution of a second or two.
+      for ( U32 i=0; i < 5 && Torque::FS::CompareModifiedTimes( imagePath, shapePath ) >= 0; i++ )
+      {
+         Platform::sleep( 1000 );
+         writeShape( shape, shapePath );
+      }
+      test( Torque::FS::CompareModifiedTimes( imagePath, shapePath ) < 0, "The DTS should be newer than the image!" );
+
+      image = TSShape::loadImage( shapePath );
+      test( image == NULL, "Loaded an image older than its shape!" );
+      delete image;
+
+      Torque::FS::Remove( imagePath );
+      Torque::FS::Remove( shapePath );
+      TSShape::smUseImages = oldUseImages;
+   }
+};
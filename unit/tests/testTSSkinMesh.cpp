@@ -0,0 +1,161 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "ts/tsMesh.h"
+#include "math/mMath.h"
+#include "math/mRandom.h"
+#include "gfx/gfxDevice.h"
+#include "console/console.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+/// Exposes the skin data so the test can see what the
+/// vertex shader would get.
+class SkinMeshTestMesh : public TSSkinMesh
+{
+public:
+
+   void setSkinData( bool bindBones ) { _setSkinData( bindBones ); }
+
+   bool hasSharedVB() const { return mVB.isValid(); }
+};
+
+CreateUnitTest( TestTSSkinMeshHardware, "TS/SkinMesh/Hardware" )
+{
+   enum
+   {
+      NumBones = 5,
+      NumVerts = 200,
+   };
+
+   void run()
+   {
+      MRandomLCG rand( 1234 );
+
+      GFXVertexFormat format;
+      format.addElement( GFXSemantic::POSITION, GFXDeclType_Float3 );
+      format.addElement( GFXSemantic::TANGENTW, GFXDeclType_Float, 3 );
+      format.addElement( GFXSemantic::NORMAL, GFXDeclType_Float3 );
+      format.addElement( GFXSemantic::TANGENT, GFXDeclType_Float3 );
+      format.addElement( GFXSemantic::TEXCOORD, GFXDeclType_Float2, 0 );
+      format.addElement( GFXSemantic::BLENDINDICES, GFXDeclType_Float4, 6 );
+      format.addElement( GFXSemantic::BLENDWEIGHT, GFXDeclType_Float4, 7 );
+      test( format.hasBlendIndices(), "The format should have the blend elements!" );
+
+      SkinMeshTestMesh mesh;
+      mesh.setVertexFormat( &format, sizeof( TSMesh::__TSMeshVertexBase ) + sizeof( TSMesh::__TSMeshVertexSkin ) );
+
+      // The bones map to nodes in reverse order to catch
+      // any mixup between the bone and node index.
+      for ( U32 i=0; i < NumBones; i++ )
+      {
+         mesh.batchData.nodeIndex.push_back( NumBones - 1 - i );
+
+         MatrixF bind( EulerF( rand.randF() * M_2PI_F, rand.randF() * M_2PI_F, 0.0f ), Point3F( i, -1.0f, 2.0f ) );
+         bind.inverse();
+         mesh.batchData.initialTransforms.push_back( bind );
+      }
+
+      // Give each vertex one to four weighted bones.
+      for ( U32 i=0; i < NumVerts; i++ )
+      {
+         mesh.batchData.initialVerts.push_back( Point3F( rand.randF() * 4.0f - 2.0f, rand.randF() * 4.0f - 2.0f, rand.randF() * 4.0f ) );
+
+         Point3F normal( rand.randF() - 0.5f, rand.randF() - 0.5f, rand.randF() + 0.1f );
+         normal.normalize();
+         mesh.batchData.initialNorms.push_back( normal );
+         mesh.tangents.push_back( Point4F( 1.0f, 0.0f, 0.0f, 1.0f ) );
+         mesh.tverts.push_back( Point2F( 0.0f, 0.0f ) );
+
+         const S32 count = rand.randI( 1, TSSkinMesh::MaxHardwareBonesPerVert );
+         const S32 firstBone = rand.randI( 0, NumBones - count );
+         for ( S32 j=0; j < count; j++ )
+         {
+            mesh.vertexIndex.push_back( i );
+            mesh.boneIndex.push_back( firstBone + j );
+            mesh.weight.push_back( 1.0f / count );
+         }
+      }
+
+      test( mesh.getMaxBonesPerVert() <= TSSkinMesh::MaxHardwareBonesPerVert, "Too many bones per vertex!" );
+      test( mesh.canSkinInHardware(), "The mesh should fit the hardware limits!" );
+
+      mesh.convertToAlignedMeshData();
+      mesh.createBatchData();
+
+      // Keep the indices and weights the vertex shader would get.
+      mesh.setSkinData( true );
+      Vector<TSMesh::__TSMeshVertexSkin> skinData;
+      for ( U32 i=0; i < NumVerts; i++ )
+         skinData.push_back( mesh.mVertexData.skin( i ) );
+
+      Vector<MatrixF> transforms;
+      for ( U32 i=0; i < NumBones; i++ )
+         transforms.push_back( MatrixF( EulerF( rand.randF(), rand.randF(), rand.randF() ), Point3F( rand.randF(), rand.randF(), rand.randF() ) ) );
+
+      TSVertexBufferHandle vb;
+      GFXPrimitiveBufferHandle pb;
+      mesh.updateSkin( transforms, vb, pb );
+
+      MatrixF palette[NumBones];
+      mesh.computeBoneTransforms( transforms, palette );
+
+      // Blend the palette like the vertex shader does.
+      F32 maxPosError = 0.0f;
+      F32 maxNormError = 0.0f;
+      for ( U32 i=0; i < NumVerts; i++ )
+      {
+         const F32 *indices = skinData[i]._indices;
+         const F32 *weights = skinData[i]._weights;
+
+         MatrixF skinTrans;
+         dMemset( (F32*)skinTrans, 0, sizeof( MatrixF ) );
+         for ( U32 j=0; j < TSSkinMesh::MaxHardwareBonesPerVert; j++ )
+         {
+            const F32 *bone = palette[ (S32)indices[j] ];
+            for ( U32 k=0; k < 16; k++ )
+               ((F32*)skinTrans)[k] += bone[k] * weights[j];
+         }
+
+         Point3F pos, norm;
+         skinTrans.mulP( mesh.batchData.initialVerts[i], &pos );
+         skinTrans.mulV( mesh.batchData.initialNorms[i], &norm );
+         norm.normalize();
+
+         Point3F cpuNorm = mesh.mVertexData[i].normal();
+         cpuNorm.normalize();
+
+         maxPosError = getMax( maxPosError, ( pos - mesh.mVertexData[i].vert() ).len() );
+         maxNormError = getMax( maxNormError, ( norm - cpuNorm ).len() );
+      }
+
+      test( maxPosError < 0.001f, "The hardware skin doesn't match the CPU skin positions!" );
+      test( maxNormError < 0.001f, "The hardware skin doesn't match the CPU skin normals!" );
+
+      // The rest needs a device for the shared buffer.
+      if ( !GFXDevice::devicePresent() || GFX->getAdapterType() != NullDevice )
+      {
+         Con::printf( "TS/SkinMesh/Hardware: skipped the shared buffer, requires the null device." );
+         return;
+      }
+
+      mesh.createHardwareSkinVBIB();
+      test( mesh.hasSharedVB(), "The shared buffer was not created!" );
+
+      // Afterwards the vertex data is bound to the identity
+      // bone for the instances which are skinned on the CPU.
+      bool identity = true;
+      for ( U32 i=0; i < NumVerts; i++ )
+      {
+         const TSMesh::__TSMeshVertexSkin &skin = mesh.mVertexData.skin( i );
+         identity &= skin._indices == Point4F( 0, 0, 0, 0 ) && skin._weights == Point4F( 1, 0, 0, 0 );
+      }
+      test( identity, "The CPU skinned vertices should be bound to the first bone!" );
+   }
+};
@@ -0,0 +1,151 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "gfx/gfxDevice.h"
+#include "gfx/gfxTextureManager.h"
+#include "gfx/bitmap/gBitmap.h"
+#include "gfx/bitmap/ddsFile.h"
+#include "core/stream/memStream.h"
+#include "core/stream/fileStream.h"
+#include "core/volume.h"
+#include "console/console.h"
+#include "platform/threads/threadPool.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+CreateUnitTest( TestTextureStreaming, "GFX/TextureStreaming" )
+{
+   enum
+   {
+      Size = 1024,
+      MinSize = 64,
+      DropMips = 2,
+   };
+
+   /// Returns a DDS with a full mip chain where every
+   /// mip is filled with its own level.
+   DDSFile* createDDS()
+   {
+      GBitmap bitmap( Size, Size, true, GFXFormatR8G8B8A8 );
+      for ( U32 i=0; i < bitmap.getNumMipLevels(); i++ )
+         dMemset( bitmap.getWritableBits( i ), i + 1, bitmap.getWidth( i ) * bitmap.getHeight( i ) * bitmap.getBytesPerPixel() );
+
+      return DDSFile::createDDSFileFromGBitmap( &bitmap );
+   }
+
+   void waitForLoads( GFXTextureObject *texture )
+   {
+      while ( texture->mStream->pending )
+      {
+         ThreadPool::processMainThreadWorkItems();
+         TEXMGR->updateStreaming();
+         Platform::sleep( 1 );
+      }
+   }
+
+   void run()
+   {
+      DDSFile *dds = createDDS();
+      const U32 numMips = dds->mMipMapCount;
+
+      MemStream ddsStream( 8 * Size * Size );
+      test( dds->write( ddsStream ), "Failed to write the DDS!" );
+      const U32 ddsSize = ddsStream.getPosition();
+
+      // Read it back without the top mips.
+      MemStream readStream( ddsSize, ddsStream.getBuffer(), true, false );
+      DDSFile *dropped = new DDSFile;
+      test( dropped->read( readStream, DropMips ), "Failed to read the DDS!" );
+      test( dropped->getWidth() == ( Size >> DropMips ) && dropped->getHeight() == ( Size >> DropMips ), "Wrong size after dropping the mips!" );
+      test( dropped->mMipMapCount == numMips - DropMips, "Wrong mip count after dropping the mips!" );
+
+      bool sameMips = dropped->mSurfaces.size() == 1 && dropped->mSurfaces[0]->mMips.size() == numMips - DropMips;
+      for ( U32 i=0; sameMips && i < numMips - DropMips; i++ )
+         sameMips = dMemcmp( dropped->mSurfaces[0]->mMips[i], dds->mSurfaces[0]->mMips[ i + DropMips ], dropped->getSurfaceSize( i ) ) == 0;
+      test( sameMips, "The mips read don't match the file!" );
+
+      delete dropped;
+      delete dds;
+
+      // The rest needs a device to create the textures on.
+      if ( !GFXDevice::devicePresent() || GFX->getAdapterType() != NullDevice )
+      {
+         Con::printf( "GFX/TextureStreaming: skipped the texture streaming, requires the null device." );
+         return;
+      }
+
+      const Torque::Path path( "testTextureStreaming/streamed.dds" );
+      {
+         FileStream stream;
+         if ( stream.open( path, Torque::FS::File::Write ) )
+            stream.write( ddsSize, ddsStream.getBuffer() );
+      }
+
+      const bool oldEnabled = GFXTextureManager::smStreamingEnabled;
+      const S32 oldBudget = GFXTextureManager::smStreamingBudget;
+      const S32 oldMinSize = GFXTextureManager::smStreamingMinSize;
+      GFXTextureManager::smStreamingEnabled = true;
+      GFXTextureManager::smStreamingBudget = 0;
+      GFXTextureManager::smStreamingMinSize = MinSize;
+
+      GFXTexHandle texture( path, &GFXDefaultStaticDiffuseProfile, "TestTextureStreaming" );
+      test( texture.isValid() && texture->isStreamed(), "The texture should stream its mips!" );
+      if ( texture.isValid() && texture->isStreamed() )
+      {
+         test( texture->getBitmapWidth() == MinSize, "The texture should start with its small mips!" );
+
+         // Fill the screen with it.
+         GFXTextureManager::requestTextureDetail( texture, Size );
+         TEXMGR->updateStreaming();
+         test( texture->mStream->pending, "The larger mips should be loading!" );
+         waitForLoads( texture );
+
+         test( texture->mStream->skipMips == 0, "The texture should be fully resident!" );
+         test( texture->getBitmapWidth() == Size, "The texture should have the full size!" );
+
+         GFXTextureManager::StreamingStats stats;
+         TEXMGR->getStreamingStats( &stats );
+         const U32 evictions = stats.numEvictions;
+
+         // Without any use it gets evicted down to the budget.
+         GFXTextureManager::smStreamingBudget = 1;
+         for ( U32 i=0; i < 10; i++ )
+         {
+            TEXMGR->updateStreaming();
+            waitForLoads( texture );
+         }
+
+         TEXMGR->getStreamingStats( &stats );
+         test( stats.residentBytes <= stats.budgetBytes, "The streamed textures should be within the budget!" );
+         test( stats.numEvictions > evictions, "The top mips should have been evicted!" );
+         test( texture->getBitmapWidth() < Size, "The texture should have dropped its top mips!" );
+         test( texture->mStream->skipMips <= texture->mStream->maxSkipMips, "Evicted past the initial mips!" );
+
+         // A small footprint doesn't hold back a bind which
+         // came without a request.
+         GFXTextureManager::smStreamingBudget = 0;
+         GFXTextureManager::requestTextureDetail( texture, 1.0f );
+         GFX->setTexture( 0, texture );
+         GFX->setTexture( 0, texture );
+         TEXMGR->updateStreaming();
+         waitForLoads( texture );
+         GFX->setTexture( 0, NULL );
+         test( texture->mStream->skipMips == 0, "A bind without a request should load the full detail!" );
+      }
+
+      texture = NULL;
+
+      GFXTextureManager::smStreamingEnabled = oldEnabled;
+      GFXTextureManager::smStreamingBudget = oldBudget;
+      GFXTextureManager::smStreamingMinSize = oldMinSize;
+
+      Torque::FS::Remove( path );
+      Torque::FS::Remove( "testTextureStreaming" );
+   }
+};
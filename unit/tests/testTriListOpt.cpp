@@ -0,0 +1,252 @@
+//-----------------------------------------------------------------------------
+// Torque 3D
+// Copyright (C) GarageGames.com, Inc.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "gfx/util/triListOpt.h"
+#include "ts/tsShape.h"
+#include "ts/tsMesh.h"
+#include "core/stream/memStream.h"
+#include "math/mMath.h"
+#include "math/mRandom.h"
+#include "console/console.h"
+
+using namespace UnitTesting;
+
+//-----------------------------------------------------------------------------
+
+/// Sums the centers and area weighted normals of the triangles, which
+/// doesn't depend on their order or the order of the vertices.
+static void sumTriangles( const Point3F *positions, const U32 *indices, U32 numIndices, Point3F *outCenter, Point3F *outNormal )
+{
+   outCenter->set( 0.0f, 0.0f, 0.0f );
+   outNormal->set( 0.0f, 0.0f, 0.0f );
+   for ( U32 i=0; i + 2 < numIndices; i += 3 )
+   {
+      const Point3F &p0 = positions[ indices[i] ];
+      const Point3F &p1 = positions[ indices[i+1] ];
+      const Point3F &p2 = positions[ indices[i+2] ];
+      *outCenter += p0 + p1 + p2;
+      *outNormal += mCross( p1 - p0, p2 - p0 );
+   }
+}
+
+/// Builds a sphere out of a grid of quads with the triangles in a
+/// random order, plus one vertex which isn't used.
+static void buildSphere( U32 gridSize, MRandomLCG &rand, Vector<Point3F> &outPositions, Vector<U32> &outIndices )
+{
+   for ( U32 y=0; y < gridSize; y++ )
+   {
+      for ( U32 x=0; x < gridSize; x++ )
+      {
+         const F32 theta = x * M_2PI_F / gridSize;
+         const F32 phi = y * M_PI_F / ( gridSize - 1 );
+         outPositions.push_back( Point3F( mCos( theta ) * mSin( phi ), mSin( theta ) * mSin( phi ), mCos( phi ) ) );
+      }
+   }
+   outPositions.push_back( Point3F( 0.0f, 0.0f, 0.0f ) );
+
+   for ( U32 y=0; y < gridSize - 1; y++ )
+   {
+      for ( U32 x=0; x < gridSize - 1; x++ )
+      {
+         const U32 i = y * gridSize + x;
+         outIndices.push_back( i );
+         outIndices.push_back( i + 1 );
+         outIndices.push_back( i + gridSize );
+         outIndices.push_back( i + 1 );
+         outIndices.push_back( i + gridSize + 1 );
+         outIndices.push_back( i + gridSize );
+      }
+   }
+
+   const U32 numTris = outIndices.size() / 3;
+   for ( U32 i = numTris - 1; i > 0; i-- )
+   {
+      const U32 j = rand.randI( 0, i );
+      for ( U32 k=0; k < 3; k++ )
+      {
+         const U32 tmp = outIndices[ i * 3 + k ];
+         outIndices[ i * 3 + k ] = outIndices[ j * 3 + k ];
+         outIndices[ j * 3 + k ] = tmp;
+      }
+   }
+}
+
+/// Returns the vertex positions of a mesh.
+static void getMeshPositions( const TSMesh *mesh, Vector<Point3F> &outPositions )
+{
+   if ( !mesh->mVertexData.isReady() )
+   {
+      outPositions = mesh->verts;
+      return;
+   }
+
+   for ( U32 i=0; i < mesh->mNumVerts; i++ )
+      outPositions.push_back( mesh->mVertexData[i].vert() );
+}
+
+CreateUnitTest( TestTriListOpt, "GFX/TriListOpt" )
+{
+   enum
+   {
+      GridSize = 32,
+   };
+
+   void run()
+   {
+      MRandomLCG rand( 5678 );
+      Vector<Point3F> positions;
+      Vector<U32> indices;
+      buildSphere( GridSize, rand, positions, indices );
+
+      const U32 numVerts = positions.size();
+      const U32 numTris = indices.size() / 3;
+
+      Point3F center, normal;
+      sumTriangles( positions.address(), indices.address(), indices.size(), &center, &normal );
+
+      TriListOpt::CacheStats before;
+      TriListOpt::CalcCacheStats( numVerts, indices.size(), indices.address(), &before );
+
+      Vector<U32> optimized;
+      optimized.setSize( indices.size() );
+      TriListOpt::OptimizeTriangleOrdering( numVerts, indices.size(), indices.address(), optimized.address() );
+      TriListOpt::OptimizeOverdraw( numVerts, optimized.size(), optimized.address(), positions.address() );
+
+      TriListOpt::CacheStats after;
+      TriListOpt::CalcCacheStats( numVerts, optimized.size(), optimized.address(), &after );
+      test( after.acmr < before.acmr * 0.5f, "The vertex cache efficiency didn't improve!" );
+      test( after.atvr >= 1.0f && after.acmr >= 0.5f, "Impossible vertex cache statistics!" );
+
+      Point3F optCenter, optNormal;
+      sumTriangles( positions.address(), optimized.address(), optimized.size(), &optCenter, &optNormal );
+      test( ( optCenter - center ).len() < 0.01f && ( optNormal - normal ).len() < 0.01f, "The triangles changed!" );
+
+      // Reorder the vertices to match the indices.
+      Vector<U32> remap;
+      remap.setSize( numVerts );
+      const U32 numUsed = TriListOpt::OptimizeVertexFetch( numVerts, optimized.size(), optimized.address(), remap.address() );
+      test( numUsed == numVerts - 1, "Wrong number of used vertices!" );
+      test( remap.last() == numVerts - 1, "The unused vertex should be last!" );
+
+      Vector<bool> seen;
+      seen.setSize( numVerts );
+      dMemset( seen.address(), 0, seen.size() * sizeof( bool ) );
+
+      Vector<Point3F> remapped;
+      remapped.setSize( numVerts );
+      bool permutation = true;
+      for ( U32 i=0; i < numVerts; i++ )
+      {
+         permutation &= remap[i] < numVerts && !seen[ remap[i] ];
+         if ( !permutation )
+            break;
+
+         seen[ remap[i] ] = true;
+         remapped[ remap[i] ] = positions[i];
+      }
+      test( permutation, "The remap isn't a permutation!" );
+
+      if ( permutation )
+      {
+         // The vertices are first used in order.
+         U32 nextVert = 0;
+         bool inOrder = true;
+         for ( U32 i=0; i < optimized.size(); i++ )
+         {
+            inOrder &= optimized[i] <= nextVert;
+            if ( optimized[i] == nextVert )
+               nextVert++;
+         }
+         test( inOrder, "The vertices aren't in the order of first use!" );
+
+         sumTriangles( remapped.address(), optimized.address(), optimized.size(), &optCenter, &optNormal );
+         test( ( optCenter - center ).len() < 0.01f && ( optNormal - normal ).len() < 0.01f, "The remapped triangles changed!" );
+      }
+
+      Con::printf( "GFX/TriListOpt: %d tris, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", 
+         numTris, before.acmr, after.acmr, before.atvr, after.atvr );
+   }
+};
+
+CreateUnitTest( TestTSMeshOptimizeOnWrite, "TS/Mesh/OptimizeOnWrite" )
+{
+   void run()
+   {
+      MRandomLCG rand( 8765 );
+      TSMesh *mesh = new TSMesh;
+      buildSphere( 16, rand, mesh->verts, mesh->indices );
+      for ( U32 i=0; i < mesh->verts.size(); i++ )
+      {
+         mesh->norms.push_back( mesh->verts[i] );
+         mesh->tverts.push_back( Point2F( mesh->verts[i].x, mesh->verts[i].y ) );
+      }
+
+      mesh->primitives.setSize( 1 );
+      mesh->primitives[0].start = 0;
+      mesh->primitives[0].numElements = mesh->indices.size();
+      mesh->primitives[0].matIndex = TSDrawPrimitive::Triangles | TSDrawPrimitive::Indexed | TSDrawPrimitive::NoMaterial;
+
+      mesh->setFlags( 0 );
+      mesh->computeBounds();
+      mesh->numFrames = 1;
+      mesh->numMatFrames = 1;
+      mesh->vertsPerFrame = mesh->verts.size();
+      mesh->createTangents( mesh->verts, mesh->norms );
+
+      TSShape *shape = new TSShape;
+      shape->subShapeFirstNode.push_back( 0 );
+      shape->subShapeNumNodes.push_back( 0 );
+      shape->subShapeFirstObject.push_back( 0 );
+      shape->subShapeNumObjects.push_back( 0 );
+      shape->subShapeFirstTranslucentObject.push_back( 0 );
+      shape->addNode( "root", String(), Point3F( 0.0f, 0.0f, 0.0f ), QuatF( 0.0f, 0.0f, 0.0f, 1.0f ) );
+      shape->addMesh( mesh, "sphere2" );
+      shape->materialList = new TSMaterialList;
+      shape->init();
+
+      const Vector<U32> oldIndices = mesh->indices;
+
+      const bool oldOptimize = TSMesh::smOptimizeOnWrite;
+      TSMesh::smOptimizeOnWrite = true;
+
+      MemStream stream( 4096 );
+      shape->write( &stream );
+      const U32 size = stream.getPosition();
+
+      TSMesh::smOptimizeOnWrite = oldOptimize;
+
+      test( mesh->indices.size() == oldIndices.size() && 
+         dMemcmp( mesh->indices.address(), oldIndices.address(), oldIndices.size() * sizeof( U32 ) ) == 0, 
+         "Writing changed the mesh!" );
+
+      const TSMesh::OptimizeStats &stats = mesh->getOptimizeStats();
+      test( stats.numTris == oldIndices.size() / 3, "The mesh wasn't optimized!" );
+      test( stats.acmrAfter < stats.acmrBefore, "The vertex cache efficiency didn't improve!" );
+      test( stats.remapped, "The vertices of the mesh weren't reordered!" );
+
+      MemStream readStream( size, stream.getBuffer(), true, false );
+      TSShape *loaded = new TSShape;
+      test( loaded->read( &readStream ), "Failed to read the shape!" );
+
+      const TSMesh *loadedMesh = loaded->meshes.size() ? loaded->meshes[0] : NULL;
+      test( loadedMesh != NULL, "Lost the mesh!" );
+      if ( loadedMesh )
+      {
+         Vector<Point3F> positions, loadedPositions;
+         getMeshPositions( mesh, positions );
+         getMeshPositions( loadedMesh, loadedPositions );
+
+         Point3F center, normal, loadedCenter, loadedNormal;
+         sumTriangles( positions.address(), mesh->indices.address(), mesh->indices.size(), &center, &normal );
+         sumTriangles( loadedPositions.address(), loadedMesh->indices.address(), loadedMesh->indices.size(), &loadedCenter, &loadedNormal );
+         test( ( loadedCenter - center ).len() < 0.01f && ( loadedNormal - normal ).len() < 0.01f, "The loaded triangles don't match!" );
+      }
+
+      delete loaded;
+      delete shape;
+   }
+};